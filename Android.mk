@@ -287,6 +287,7 @@ protobuf_cc_full_src_files := \
     src/google/protobuf/io/printer.cc                                \
     src/google/protobuf/io/tokenizer.cc                              \
     src/google/protobuf/io/zero_copy_stream_impl.cc                  \
+    src/google/protobuf/util/message_differencer.cc                  \
     src/google/protobuf/compiler/importer.cc                         \
     src/google/protobuf/compiler/parser.cc
 
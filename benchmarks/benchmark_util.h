@@ -0,0 +1,135 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Helpers shared by the C++ benchmarks in this directory.  See readme.txt.
+//
+// Like ProtoBench.java, a benchmark is an Action that is executed over and
+// over, doubling the number of iterations until they take long enough to
+// time reliably.
+
+#ifndef PROTOBUF_BENCHMARKS_BENCHMARK_UTIL_H__
+#define PROTOBUF_BENCHMARKS_BENCHMARK_UTIL_H__
+
+#include <time.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+
+namespace benchmarks {
+
+using google::protobuf::int64;
+using std::string;
+
+// Iterations are doubled until one round takes at least this long.
+static const double kMinSampleSeconds = 1.0;
+
+// One operation to time.
+class Action {
+ public:
+  virtual ~Action() {}
+  virtual void Execute() = 0;
+};
+
+inline double NowSeconds() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// Times |action| and prints the result as one line of the report.  Each
+// execution processes |bytes| bytes, which gives the throughput.  Returns
+// the mean time per execution in nanoseconds.
+inline double Benchmark(const string& name, int64 bytes, Action* action) {
+  action->Execute();  // Warm up.
+
+  int64 iterations = 1;
+  double elapsed;
+  while (true) {
+    double start = NowSeconds();
+    for (int64 i = 0; i < iterations; i++) {
+      action->Execute();
+    }
+    elapsed = NowSeconds() - start;
+    if (elapsed >= kMinSampleSeconds) break;
+    iterations *= 2;
+  }
+
+  double ns = elapsed * 1e9 / iterations;
+  std::cout << name << ": " << iterations << " iterations in " << elapsed
+            << "s; " << ns << " ns each; "
+            << bytes * iterations / (elapsed * 1024 * 1024) << " MB/s"
+            << std::endl;
+  return ns;
+}
+
+// Reads the whole of |filename| into *contents.
+inline bool ReadFile(const string& filename, string* contents) {
+  std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!in) {
+    std::cerr << "Cannot open " << filename << std::endl;
+    return false;
+  }
+  std::ostringstream buffer;
+  buffer << in.rdbuf();
+  *contents = buffer.str();
+  return true;
+}
+
+// Returns a new message of the generated type with the given full name,
+// parsed from |filename|, or NULL after printing an error.
+inline google::protobuf::Message* LoadMessage(const string& type,
+                                              const string& filename) {
+  const google::protobuf::Descriptor* descriptor =
+      google::protobuf::DescriptorPool::generated_pool()
+          ->FindMessageTypeByName(type);
+  if (descriptor == NULL) {
+    std::cerr << "Unknown message type: " << type << std::endl;
+    return NULL;
+  }
+  string data;
+  if (!ReadFile(filename, &data)) return NULL;
+  google::protobuf::Message* message =
+      google::protobuf::MessageFactory::generated_factory()
+          ->GetPrototype(descriptor)->New();
+  if (!message->ParseFromString(data)) {
+    std::cerr << "Cannot parse " << filename << " as " << type << std::endl;
+    delete message;
+    return NULL;
+  }
+  return message;
+}
+
+}  // namespace benchmarks
+
+#endif  // PROTOBUF_BENCHMARKS_BENCHMARK_UTIL_H__
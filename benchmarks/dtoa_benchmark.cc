@@ -0,0 +1,186 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Compares DoubleToBuffer() and FloatToBuffer(), which print the shortest
+// text that parses back to the same value, with the snprintf()-based
+// method they replaced: print 15 (float: 6) significant digits, parse the
+// result back, and print 17 (float: 8) digits if that did not round-trip.
+//
+// Usage:  dtoa_benchmark
+//
+// Each kind of value is timed separately, since how often the old method
+// needed its second attempt depends on the values.
+
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/strutil.h>
+#include "benchmark_util.h"
+
+namespace benchmarks {
+namespace {
+
+using google::protobuf::DoubleToBuffer;
+using google::protobuf::FloatToBuffer;
+using google::protobuf::kDoubleToBufferSize;
+using google::protobuf::kFloatToBufferSize;
+using google::protobuf::uint32;
+using google::protobuf::uint64;
+
+// Each value set has this many values, cycled through.
+const int kValueCount = 4096;
+
+// The method DoubleToBuffer() used before.  (It also special-cased infinity
+// and NaN and replaced a locale's radix character, which cost nothing for
+// the values here.)
+char* OldDoubleToBuffer(double value, char* buffer) {
+  snprintf(buffer, kDoubleToBufferSize, "%.*g", DBL_DIG, value);
+  volatile double parsed_value = strtod(buffer, NULL);
+  if (parsed_value != value) {
+    snprintf(buffer, kDoubleToBufferSize, "%.*g", DBL_DIG + 2, value);
+  }
+  return buffer;
+}
+
+char* OldFloatToBuffer(float value, char* buffer) {
+  snprintf(buffer, kFloatToBufferSize, "%.*g", FLT_DIG, value);
+  volatile float parsed_value = strtof(buffer, NULL);
+  if (parsed_value != value) {
+    snprintf(buffer, kFloatToBufferSize, "%.*g", FLT_DIG + 2, value);
+  }
+  return buffer;
+}
+
+typedef char* DoubleFormatter(double value, char* buffer);
+typedef char* FloatFormatter(float value, char* buffer);
+
+// Formats the next value of |values| each time.
+template <typename Value, typename Formatter>
+class FormatAction : public Action {
+ public:
+  FormatAction(const std::vector<Value>* values, Formatter* formatter)
+      : values_(values), formatter_(formatter), next_(0), checksum_(0) {}
+  virtual void Execute() {
+    char buffer[kDoubleToBufferSize];
+    checksum_ += formatter_((*values_)[next_], buffer)[0];
+    next_ = (next_ + 1) % values_->size();
+  }
+
+ private:
+  const std::vector<Value>* values_;
+  Formatter* formatter_;
+  int next_;
+  int checksum_;
+};
+
+// A deterministic stream of pseudo-random numbers, so that runs are
+// comparable.
+class Random {
+ public:
+  Random() : state_(88172645463325252ULL) {}
+  uint64 Next() {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 7;
+    state_ ^= state_ << 17;
+    return state_;
+  }
+
+ private:
+  uint64 state_;
+};
+
+template <typename Value, typename Formatter>
+void Compare(const string& name, const std::vector<Value>& values,
+             Formatter* formatter, Formatter* old_formatter) {
+  FormatAction<Value, Formatter> action(&values, formatter);
+  FormatAction<Value, Formatter> old_action(&values, old_formatter);
+  double ns = Benchmark(name + ", shortest", sizeof(Value), &action);
+  double old_ns = Benchmark(name + ", snprintf", sizeof(Value), &old_action);
+  std::cout << "  Speedup: " << old_ns / ns << std::endl << std::endl;
+}
+
+}  // namespace
+}  // namespace benchmarks
+
+int main(int argc, char* argv[]) {
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
+  using namespace benchmarks;
+
+  if (argc != 1) {
+    std::cerr << "Usage:  " << argv[0] << std::endl;
+    return 1;
+  }
+
+  Random random;
+  std::vector<double> random_doubles;
+  std::vector<double> short_doubles;
+  std::vector<float> random_floats;
+  std::vector<float> short_floats;
+  while (random_doubles.size() < kValueCount) {
+    // Any bit pattern that is a finite number.
+    uint64 bits = random.Next();
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    if (value == value && value - value == 0) random_doubles.push_back(value);
+  }
+  while (random_floats.size() < kValueCount) {
+    uint32 bits = random.Next();
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    if (value == value && value - value == 0) random_floats.push_back(value);
+  }
+  for (int i = 0; i < kValueCount; i++) {
+    // Values like those written in .proto defaults and configuration: a few
+    // decimal digits.
+    int digits = random.Next() % 100000;
+    int scale = random.Next() % 4;
+    double value = digits;
+    for (int j = 0; j < scale; j++) value /= 10;
+    short_doubles.push_back(value);
+    short_floats.push_back(value);
+  }
+
+  Compare("Random doubles", random_doubles, &DoubleToBuffer,
+          &OldDoubleToBuffer);
+  Compare("Short decimal doubles", short_doubles, &DoubleToBuffer,
+          &OldDoubleToBuffer);
+  Compare("Random floats", random_floats, &FloatToBuffer, &OldFloatToBuffer);
+  Compare("Short decimal floats", short_floats, &FloatToBuffer,
+          &OldFloatToBuffer);
+
+  google::protobuf::ShutdownProtobufLibrary();
+  return 0;
+}
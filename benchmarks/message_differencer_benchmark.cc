@@ -0,0 +1,140 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Compares util::MessageDifferencer::Equals() with serializing both
+// messages and comparing the bytes, for equal messages and for messages
+// that differ only in their last field.
+//
+// Usage:  message_differencer_benchmark TYPE FILE [TYPE FILE...]
+//   e.g.  message_differencer_benchmark
+//             benchmarks.SpeedMessage1 google_message1.dat
+//             benchmarks.SpeedMessage2 google_message2.dat
+
+#include <iostream>
+#include <string>
+
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/util/message_differencer.h>
+#include <google/protobuf/unknown_field_set.h>
+#include "benchmark_util.h"
+
+namespace benchmarks {
+namespace {
+
+using google::protobuf::Message;
+using google::protobuf::scoped_ptr;
+using google::protobuf::util::MessageDifferencer;
+
+class DifferencerAction : public Action {
+ public:
+  DifferencerAction(const Message* message1, const Message* message2)
+      : message1_(message1), message2_(message2), equal_count_(0) {}
+  virtual void Execute() {
+    if (MessageDifferencer::Equals(*message1_, *message2_)) equal_count_++;
+  }
+
+ private:
+  const Message* message1_;
+  const Message* message2_;
+  int64 equal_count_;
+};
+
+class SerializeAndCompareAction : public Action {
+ public:
+  SerializeAndCompareAction(const Message* message1, const Message* message2)
+      : message1_(message1), message2_(message2), equal_count_(0) {}
+  virtual void Execute() {
+    message1_->SerializeToString(&data1_);
+    message2_->SerializeToString(&data2_);
+    if (data1_ == data2_) equal_count_++;
+  }
+
+ private:
+  const Message* message1_;
+  const Message* message2_;
+  string data1_;
+  string data2_;
+  int64 equal_count_;
+};
+
+bool RunBenchmarks(const string& type, const string& filename) {
+  scoped_ptr<Message> message(LoadMessage(type, filename));
+  if (message == NULL) return false;
+  std::cout << "Benchmarking " << type << " with file " << filename
+            << std::endl;
+
+  scoped_ptr<Message> same(message->New());
+  same->CopyFrom(*message);
+  // An unknown field sorts after all the known ones, so finding this
+  // difference means walking the whole message.
+  scoped_ptr<Message> different(message->New());
+  different->CopyFrom(*message);
+  different->GetReflection()->MutableUnknownFields(different.get())
+      ->AddVarint(536870911, 1);
+
+  int64 bytes = message->ByteSize();
+  DifferencerAction differencer_equal(message.get(), same.get());
+  SerializeAndCompareAction serialize_equal(message.get(), same.get());
+  DifferencerAction differencer_different(message.get(), different.get());
+  SerializeAndCompareAction serialize_different(message.get(),
+                                                different.get());
+  double differencer_ns =
+      Benchmark("MessageDifferencer, equal", bytes, &differencer_equal);
+  double serialize_ns =
+      Benchmark("Serialize and compare, equal", bytes, &serialize_equal);
+  std::cout << "  Speedup: " << serialize_ns / differencer_ns << std::endl;
+  differencer_ns = Benchmark("MessageDifferencer, last field differs", bytes,
+                             &differencer_different);
+  serialize_ns = Benchmark("Serialize and compare, last field differs",
+                           bytes, &serialize_different);
+  std::cout << "  Speedup: " << serialize_ns / differencer_ns << std::endl
+            << std::endl;
+  return true;
+}
+
+}  // namespace
+}  // namespace benchmarks
+
+int main(int argc, char* argv[]) {
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+  if (argc < 3 || argc % 2 != 1) {
+    std::cerr << "Usage:  " << argv[0] << " TYPE FILE [TYPE FILE...]"
+              << std::endl;
+    return 1;
+  }
+  bool success = true;
+  for (int i = 1; i < argc; i += 2) {
+    success &= benchmarks::RunBenchmarks(argv[i], argv[i + 1]);
+  }
+
+  google::protobuf::ShutdownProtobufLibrary();
+  return success ? 0 : 1;
+}
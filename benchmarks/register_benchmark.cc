@@ -0,0 +1,171 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Compares the register encoding that --bsv_out=register generates code for
+// with the wire format, on RegisterAllTypes from the BSV generator's tests:
+// packing against SerializeToString(), and unpacking against
+// ParseFromString().  Before timing, checks that the message survives a
+// round trip through the register encoding.
+//
+// Usage:  register_benchmark
+
+#include <string.h>
+#include <iostream>
+#include <string>
+
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/compiler/bsv/bsv_register_unittest.pb.h>
+#include <google/protobuf/compiler/bsv/bsv_register_unittest.regs.h>
+#include "benchmark_util.h"
+
+namespace benchmarks {
+namespace {
+
+using google::protobuf::uint8;
+using protobuf_unittest::RegisterAllTypes;
+
+// The values the BSV generator's tests use.
+void SetAllFields(RegisterAllTypes* message) {
+  message->set_int32_value(-101);
+  message->set_int64_value(-102);
+  message->set_uint32_value(103);
+  message->set_uint64_value(GOOGLE_ULONGLONG(0xfedcba9876543210));
+  message->set_sint32_value(-105);
+  message->set_sint64_value(-106);
+  message->set_fixed32_value(107);
+  message->set_fixed64_value(108);
+  message->set_sfixed32_value(-109);
+  message->set_sfixed64_value(-110);
+  message->set_float_value(111.5);
+  message->set_double_value(-112.25);
+  message->set_bool_value(true);
+  message->set_color(protobuf_unittest::REGISTER_BLUE);
+  message->mutable_point()->set_x(-113);
+  message->mutable_point()->set_y(114);
+  message->mutable_empty();
+}
+
+class SerializeAction : public Action {
+ public:
+  explicit SerializeAction(const RegisterAllTypes* message)
+      : message_(message) {}
+  virtual void Execute() { message_->SerializeToString(&data_); }
+
+ private:
+  const RegisterAllTypes* message_;
+  string data_;
+};
+
+class PackAction : public Action {
+ public:
+  explicit PackAction(const RegisterAllTypes* message) : message_(message) {}
+  virtual void Execute() {
+    protobuf_unittest::PackRegisterAllTypes(*message_, buffer_);
+  }
+
+ private:
+  const RegisterAllTypes* message_;
+  uint8 buffer_[protobuf_unittest::kRegisterAllTypesPackedSize];
+};
+
+class ParseAction : public Action {
+ public:
+  explicit ParseAction(const string* data) : data_(data) {}
+  virtual void Execute() { message_.ParseFromString(*data_); }
+
+ private:
+  const string* data_;
+  RegisterAllTypes message_;
+};
+
+class UnpackAction : public Action {
+ public:
+  explicit UnpackAction(const uint8* buffer) : buffer_(buffer) {}
+  virtual void Execute() {
+    protobuf_unittest::UnpackRegisterAllTypes(buffer_, &message_);
+  }
+
+ private:
+  const uint8* buffer_;
+  RegisterAllTypes message_;
+};
+
+bool RunBenchmarks() {
+  RegisterAllTypes message;
+  SetAllFields(&message);
+
+  uint8 buffer[protobuf_unittest::kRegisterAllTypesPackedSize];
+  RegisterAllTypes unpacked;
+  if (protobuf_unittest::PackRegisterAllTypes(message, buffer) !=
+          buffer + sizeof(buffer) ||
+      protobuf_unittest::UnpackRegisterAllTypes(buffer, &unpacked) !=
+          buffer + sizeof(buffer) ||
+      unpacked.SerializeAsString() != message.SerializeAsString()) {
+    std::cerr << "RegisterAllTypes does not survive a round trip through "
+              << "the register encoding." << std::endl;
+    return false;
+  }
+
+  string data = message.SerializeAsString();
+  std::cout << "Benchmarking RegisterAllTypes: " << data.size()
+            << " bytes in the wire format, " << sizeof(buffer)
+            << " bytes in the register encoding" << std::endl;
+
+  SerializeAction serialize(&message);
+  PackAction pack(&message);
+  double serialize_ns = Benchmark("SerializeToString", data.size(),
+                                  &serialize);
+  double pack_ns = Benchmark("PackRegisterAllTypes", sizeof(buffer), &pack);
+  std::cout << "  Speedup: " << serialize_ns / pack_ns << std::endl;
+
+  ParseAction parse(&data);
+  UnpackAction unpack(buffer);
+  double parse_ns = Benchmark("ParseFromString", data.size(), &parse);
+  double unpack_ns = Benchmark("UnpackRegisterAllTypes", sizeof(buffer),
+                               &unpack);
+  std::cout << "  Speedup: " << parse_ns / unpack_ns << std::endl;
+  return true;
+}
+
+}  // namespace
+}  // namespace benchmarks
+
+int main(int argc, char* argv[]) {
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+  if (argc != 1) {
+    std::cerr << "Usage:  " << argv[0] << std::endl;
+    return 1;
+  }
+  bool success = benchmarks::RunBenchmarks();
+
+  google::protobuf::ShutdownProtobufLibrary();
+  return success ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Measures TextFormat printing and parsing throughput.  Each sample message
+// is timed as it is, and then merged into itself until its encoding reaches
+// MEGABYTES (default 100) if it has repeated fields to grow.
+//
+// Usage:  text_format_benchmark [--megabytes=N] TYPE FILE [TYPE FILE...]
+//   e.g.  text_format_benchmark
+//             benchmarks.SpeedMessage1 google_message1.dat
+//             benchmarks.SpeedMessage2 google_message2.dat
+//
+// Printing is timed with the built-in value printers, which write straight
+// to the output buffer, and with a custom FieldValuePrinter that prints the
+// same text through temporary strings, as every value was printed before.
+// Parsing is timed on the text the built-in printers produce.
+
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <string>
+
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/text_format.h>
+#include <google/protobuf/io/zero_copy_stream.h>
+#include "benchmark_util.h"
+
+namespace benchmarks {
+namespace {
+
+using google::protobuf::Message;
+using google::protobuf::TextFormat;
+using google::protobuf::scoped_ptr;
+
+// Discards everything written to it, so that only the printer is timed.
+class NullOutputStream : public google::protobuf::io::ZeroCopyOutputStream {
+ public:
+  NullOutputStream() : byte_count_(0) {}
+  virtual bool Next(void** data, int* size) {
+    *data = buffer_;
+    *size = sizeof(buffer_);
+    byte_count_ += sizeof(buffer_);
+    return true;
+  }
+  virtual void BackUp(int count) { byte_count_ -= count; }
+  virtual int64 ByteCount() const { return byte_count_; }
+
+ private:
+  char buffer_[8192];
+  int64 byte_count_;
+};
+
+class PrintAction : public Action {
+ public:
+  PrintAction(const TextFormat::Printer* printer, const Message* message)
+      : printer_(printer), message_(message) {}
+  virtual void Execute() {
+    NullOutputStream output;
+    printer_->Print(*message_, &output);
+  }
+
+ private:
+  const TextFormat::Printer* printer_;
+  const Message* message_;
+};
+
+class ParseAction : public Action {
+ public:
+  ParseAction(const string* text, Message* message)
+      : text_(text), message_(message), failures_(0) {}
+  virtual void Execute() {
+    if (!parser_.ParseFromString(*text_, message_)) failures_++;
+  }
+  int64 failures() const { return failures_; }
+
+ private:
+  TextFormat::Parser parser_;
+  const string* text_;
+  Message* message_;
+  int64 failures_;
+};
+
+// Times printing and parsing |message|.
+bool RunBenchmarks(const string& description, const Message& message) {
+  string text;
+  TextFormat::PrintToString(message, &text);
+  std::cout << "Benchmarking " << description << ": " << message.ByteSize()
+            << " bytes, " << text.size() << " bytes of text" << std::endl;
+
+  TextFormat::Printer built_in_printer;
+  TextFormat::Printer custom_printer;
+  custom_printer.SetDefaultFieldValuePrinter(
+      new TextFormat::FieldValuePrinter);
+
+  PrintAction print_built_in(&built_in_printer, &message);
+  PrintAction print_custom(&custom_printer, &message);
+  double built_in_ns =
+      Benchmark("Print, built-in printers", text.size(), &print_built_in);
+  double custom_ns =
+      Benchmark("Print, custom FieldValuePrinter", text.size(), &print_custom);
+  std::cout << "  Speedup: " << custom_ns / built_in_ns << std::endl;
+
+  scoped_ptr<Message> parsed(message.New());
+  ParseAction parse(&text, parsed.get());
+  Benchmark("Parse", text.size(), &parse);
+  if (parse.failures() > 0) {
+    std::cerr << "Parsing the printed text failed." << std::endl;
+    return false;
+  }
+  std::cout << std::endl;
+  return true;
+}
+
+bool RunBenchmarks(const string& type, const string& filename,
+                   int megabytes) {
+  scoped_ptr<Message> sample(LoadMessage(type, filename));
+  if (sample == NULL) return false;
+  if (!RunBenchmarks(type + " from " + filename, *sample)) return false;
+
+  // Each merge appends the sample's repeated fields, so the size grows by
+  // the same amount every time.  Measure it once rather than recomputing
+  // the size of the whole message after every merge.
+  scoped_ptr<Message> message(sample->New());
+  message->MergeFrom(*sample);
+  int64 first_size = message->ByteSize();
+  message->MergeFrom(*sample);
+  int64 growth = message->ByteSize() - first_size;
+  if (growth <= 0) {
+    std::cout << type << " has no repeated fields to grow." << std::endl
+              << std::endl;
+    return true;
+  }
+  for (int64 size = first_size + growth;
+       size < static_cast<int64>(megabytes) * 1024 * 1024; size += growth) {
+    message->MergeFrom(*sample);
+  }
+  return RunBenchmarks(type + " from " + filename + ", merged", *message);
+}
+
+}  // namespace
+}  // namespace benchmarks
+
+int main(int argc, char* argv[]) {
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+  int megabytes = 100;
+  int first = 1;
+  if (argc > 1 && strncmp(argv[1], "--megabytes=", 12) == 0) {
+    megabytes = atoi(argv[1] + 12);
+    first = 2;
+  }
+  if (argc - first < 2 || (argc - first) % 2 != 0 || megabytes <= 0) {
+    std::cerr << "Usage:  " << argv[0]
+              << " [--megabytes=N] TYPE FILE [TYPE FILE...]" << std::endl;
+    return 1;
+  }
+  bool success = true;
+  for (int i = first; i < argc; i += 2) {
+    success &= benchmarks::RunBenchmarks(argv[i], argv[i + 1], megabytes);
+  }
+
+  google::protobuf::ShutdownProtobufLibrary();
+  return success ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Measures io::Tokenizer throughput: the time to split the input into
+// tokens, which every parser built on it pays before it looks at them.
+//
+// Usage:  tokenizer_benchmark (TYPE FILE | PROTO_FILE)...
+//   e.g.  tokenizer_benchmark
+//             benchmarks.SpeedMessage2 google_message2.dat
+//             google_speed.proto
+//
+// A TYPE FILE pair tokenizes the TextFormat text of the sample message.  An
+// argument ending in ".proto" is tokenized as it is.  Each input is read
+// from one buffer, as TextFormat::Parser::ParseFromString() does, and from
+// 8 KB buffers, as protoc reads .proto files, so that some tokens span two
+// buffers.
+
+#include <iostream>
+#include <string>
+
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/strutil.h>
+#include <google/protobuf/text_format.h>
+#include <google/protobuf/io/tokenizer.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include "benchmark_util.h"
+
+namespace benchmarks {
+namespace {
+
+using google::protobuf::Message;
+using google::protobuf::TextFormat;
+using google::protobuf::scoped_ptr;
+using google::protobuf::io::ArrayInputStream;
+using google::protobuf::io::ErrorCollector;
+using google::protobuf::io::Tokenizer;
+
+// Counts errors instead of printing them.
+class CountingErrorCollector : public ErrorCollector {
+ public:
+  CountingErrorCollector() : count_(0) {}
+  virtual void AddError(int line, int column, const string& message) {
+    count_++;
+  }
+  int64 count() const { return count_; }
+
+ private:
+  int64 count_;
+};
+
+class TokenizeAction : public Action {
+ public:
+  TokenizeAction(const string* text, int block_size)
+      : text_(text), block_size_(block_size), tokens_(0) {}
+  virtual void Execute() {
+    ArrayInputStream input(text_->data(), text_->size(), block_size_);
+    Tokenizer tokenizer(&input, &errors_);
+    while (tokenizer.Next()) tokens_++;
+  }
+  int64 errors() const { return errors_.count(); }
+
+ private:
+  const string* text_;
+  int block_size_;
+  int64 tokens_;
+  CountingErrorCollector errors_;
+};
+
+bool RunBenchmarks(const string& description, const string& text) {
+  std::cout << "Benchmarking " << description << ": " << text.size()
+            << " bytes" << std::endl;
+  TokenizeAction one_buffer(&text, -1);
+  TokenizeAction small_buffers(&text, 8192);
+  Benchmark("Tokenize, one buffer", text.size(), &one_buffer);
+  Benchmark("Tokenize, 8 KB buffers", text.size(), &small_buffers);
+  std::cout << std::endl;
+  if (one_buffer.errors() > 0 || small_buffers.errors() > 0) {
+    std::cerr << "Tokenizing " << description << " reported errors."
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Tokenizes the .proto file |filename|.
+bool RunFileBenchmarks(const string& filename) {
+  string text;
+  if (!ReadFile(filename, &text)) return false;
+  return RunBenchmarks(filename, text);
+}
+
+// Tokenizes the TextFormat text of the sample message in |filename|.
+bool RunMessageBenchmarks(const string& type, const string& filename) {
+  scoped_ptr<Message> message(LoadMessage(type, filename));
+  if (message == NULL) return false;
+  string text;
+  TextFormat::PrintToString(*message, &text);
+  return RunBenchmarks(type + " from " + filename, text);
+}
+
+}  // namespace
+}  // namespace benchmarks
+
+int main(int argc, char* argv[]) {
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+  if (argc < 2) {
+    std::cerr << "Usage:  " << argv[0] << " (TYPE FILE | PROTO_FILE)..."
+              << std::endl;
+    return 1;
+  }
+  bool success = true;
+  for (int i = 1; i < argc; i++) {
+    if (google::protobuf::HasSuffixString(argv[i], ".proto")) {
+      success &= benchmarks::RunFileBenchmarks(argv[i]);
+    } else if (i + 1 < argc) {
+      success &= benchmarks::RunMessageBenchmarks(argv[i], argv[i + 1]);
+      i++;
+    } else {
+      std::cerr << "Missing the data file for " << argv[i] << std::endl;
+      success = false;
+    }
+  }
+
+  google::protobuf::ShutdownProtobufLibrary();
+  return success ? 0 : 1;
+}
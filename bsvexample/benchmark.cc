@@ -0,0 +1,233 @@
+// See README.txt for information and build instructions.
+//
+// Measures the host-side cost of encoding and decoding Person records in
+// the standard wire format and in the tagless fixed layouts written by
+// the BSV generator's "register" option (see addressbook_fixed.proto), to
+// inform the choice of encoding for the hardware (see questions.txt).
+//
+// Usage:  benchmark_cpp [RECORDS...]
+//
+// For each record count, default 1K to 10M, prints the mean time per
+// record to encode and to decode it, and the mean encoded size.
+
+#include <stdlib.h>
+#include <time.h>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "addressbook.pb.h"
+#include "addressbook_fixed.pb.h"
+#include "addressbook_fixed.regs.h"
+using namespace std;
+
+using google::protobuf::uint8;
+using google::protobuf::uint32;
+using google::protobuf::uint64;
+
+// Every record is generated afresh, but a batch of this many at a time is
+// generated, encoded and then decoded, so that memory use does not grow
+// with the record count.  Decoding a batch reads what encoding it just
+// wrote, so that data is in cache.
+static const int kBatchSize = 4096;
+
+static const int kDefaultRecordCounts[] = {
+  1000, 10000, 100000, 1000000, 10000000
+};
+
+// A deterministic stream of pseudo-random numbers, so that runs are
+// comparable.
+class Random {
+ public:
+  Random() : state_(88172645463325252ULL) {}
+
+  uint32 Next() {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 7;
+    state_ ^= state_ << 17;
+    return static_cast<uint32>(state_);
+  }
+
+ private:
+  uint64 state_;
+};
+
+static double Now() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+// Fills in a Person like the ones add_person writes: most have an e-mail
+// address and each has up to four phone numbers.
+static void GeneratePerson(Random* random, tutorial::Person* person) {
+  person->set_name(random->Next());
+  person->set_id(random->Next() % 1000000);
+  if (random->Next() % 4 != 0) {
+    person->set_email(random->Next());
+  }
+  int phones = random->Next() % 5;
+  for (int i = 0; i < phones; i++) {
+    tutorial::Person::PhoneNumber* phone = person->add_phone();
+    phone->set_number(random->Next());
+    phone->set_type(
+        static_cast<tutorial::Person::PhoneType>(random->Next() % 3));
+  }
+}
+
+// Copies |person| into the restricted message with the same contents.
+static void ToFixedPerson(const tutorial::Person& person,
+                          tutorial::FixedPerson* fixed) {
+  fixed->set_name(person.name());
+  fixed->set_id(person.id());
+  fixed->set_email(person.email());
+  for (int i = 0; i < person.phone_size(); i++) {
+    tutorial::FixedPerson::PhoneNumber* phone = fixed->add_phone();
+    phone->set_number(person.phone(i).number());
+    phone->set_type(person.phone(i).type());
+  }
+}
+
+// One line of the report.  A negative time means "not measured".
+static void Report(int records, const char* encoding, double encode_ns,
+                   double decode_ns, double bytes) {
+  cout.width(10);
+  cout << records << "  ";
+  cout.width(12);
+  cout << left << encoding << right;
+  cout.precision(1);
+  cout << fixed;
+  for (int i = 0; i < 2; i++) {
+    double ns = i == 0 ? encode_ns : decode_ns;
+    cout.width(15);
+    if (ns < 0) {
+      cout << "-";
+    } else {
+      cout << ns;
+    }
+  }
+  cout.width(11);
+  cout << bytes << endl;
+}
+
+int main(int argc, char* argv[]) {
+  // Verify that the version of the library that we linked against is
+  // compatible with the version of the headers we compiled against.
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+  vector<int> record_counts;
+  for (int i = 1; i < argc; i++) {
+    int records = atoi(argv[i]);
+    if (records <= 0) {
+      cerr << "Usage:  " << argv[0] << " [RECORDS...]" << endl;
+      return -1;
+    }
+    record_counts.push_back(records);
+  }
+  if (record_counts.empty()) {
+    record_counts.assign(
+        kDefaultRecordCounts,
+        kDefaultRecordCounts + sizeof(kDefaultRecordCounts) /
+                               sizeof(kDefaultRecordCounts[0]));
+  }
+
+  vector<tutorial::Person> people(kBatchSize);
+  vector<tutorial::FixedPerson> fixed_people(kBatchSize);
+  vector<string> encoded(kBatchSize);
+  vector<uint8> packed(kBatchSize * tutorial::kFixedPersonPackedSize);
+
+  cout << "   records  encoding      encode ns/msg  decode ns/msg  bytes/msg"
+       << endl;
+
+  // Keeps the compiler from discarding the work being measured.
+  uint64 checksum = 0;
+
+  for (int r = 0; r < record_counts.size(); r++) {
+    const int records = record_counts[r];
+    tutorial::Person person;
+    tutorial::FixedPerson fixed_person;
+    uint8 buffer[tutorial::kFixedPersonPackedSize];
+
+    // Each run sees the same records.
+    Random random;
+    uint64 wire_bytes = 0;
+    double wire_encode_ns = 0;
+    double wire_decode_ns = 0;
+    double register_encode_ns = 0;
+    double register_decode_ns = 0;
+    double packed_bits_encode_ns = 0;
+
+    for (int done = 0; done < records; done += kBatchSize) {
+      const int batch = min(kBatchSize, records - done);
+      for (int i = 0; i < batch; i++) {
+        people[i].Clear();
+        GeneratePerson(&random, &people[i]);
+        fixed_people[i].Clear();
+        ToFixedPerson(people[i], &fixed_people[i]);
+      }
+
+      // The standard wire format, through SerializeToString() and
+      // ParseFromString().
+      double start = Now();
+      for (int i = 0; i < batch; i++) {
+        people[i].SerializeToString(&encoded[i]);
+        wire_bytes += encoded[i].size();
+      }
+      wire_encode_ns += Now() - start;
+      start = Now();
+      for (int i = 0; i < batch; i++) {
+        if (!person.ParseFromString(encoded[i])) {
+          cerr << "Failed to parse record " << done + i << "." << endl;
+          return -1;
+        }
+        checksum += person.id();
+      }
+      wire_decode_ns += Now() - start;
+
+      // The register encoding: fields at fixed offsets, with no tags.
+      start = Now();
+      for (int i = 0; i < batch; i++) {
+        tutorial::PackFixedPerson(
+            fixed_people[i], &packed[i * tutorial::kFixedPersonPackedSize]);
+      }
+      register_encode_ns += Now() - start;
+      start = Now();
+      for (int i = 0; i < batch; i++) {
+        const uint8* record = &packed[i * tutorial::kFixedPersonPackedSize];
+        if (tutorial::UnpackFixedPerson(record, &fixed_person) == NULL) {
+          cerr << "Failed to unpack record " << done + i << "." << endl;
+          return -1;
+        }
+        checksum += fixed_person.id();
+      }
+      register_decode_ns += Now() - start;
+
+      // The packed bits of the BSV struct, as pack() would give them.  There
+      // is no decoder on the host side.
+      start = Now();
+      for (int i = 0; i < batch; i++) {
+        if (tutorial::SerializeToPackedBits(fixed_people[i], buffer) == NULL) {
+          cerr << "Failed to pack record " << done + i << "." << endl;
+          return -1;
+        }
+        checksum += buffer[0];
+      }
+      packed_bits_encode_ns += Now() - start;
+    }
+
+    Report(records, "wire", wire_encode_ns / records,
+           wire_decode_ns / records,
+           static_cast<double>(wire_bytes) / records);
+    Report(records, "register", register_encode_ns / records,
+           register_decode_ns / records, tutorial::kFixedPersonPackedSize);
+    Report(records, "packed-bits", packed_bits_encode_ns / records, -1,
+           tutorial::kFixedPersonPackedBitsSize);
+  }
+
+  cerr << "Checksum: " << checksum << endl;
+
+  // Optional:  Delete all global objects allocated by libprotobuf.
+  google::protobuf::ShutdownProtobufLibrary();
+
+  return 0;
+}
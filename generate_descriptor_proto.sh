@@ -35,10 +35,13 @@ do
   cp google/protobuf/descriptor.pb.cc google/protobuf/descriptor.pb.cc.tmp
   cp google/protobuf/compiler/plugin.pb.h google/protobuf/compiler/plugin.pb.h.tmp
   cp google/protobuf/compiler/plugin.pb.cc google/protobuf/compiler/plugin.pb.cc.tmp
+  cp google/protobuf/compiler/bsv/bsv_options.pb.h google/protobuf/compiler/bsv/bsv_options.pb.h.tmp
+  cp google/protobuf/compiler/bsv/bsv_options.pb.cc google/protobuf/compiler/bsv/bsv_options.pb.cc.tmp
 
   make $@ protoc &&
     ./protoc --cpp_out=dllexport_decl=LIBPROTOBUF_EXPORT:. google/protobuf/descriptor.proto && \
-    ./protoc --cpp_out=dllexport_decl=LIBPROTOC_EXPORT:. google/protobuf/compiler/plugin.proto
+    ./protoc --cpp_out=dllexport_decl=LIBPROTOC_EXPORT:. google/protobuf/compiler/plugin.proto && \
+    ./protoc --cpp_out=dllexport_decl=LIBPROTOC_EXPORT:. google/protobuf/compiler/bsv/bsv_options.proto
 
   diff google/protobuf/descriptor.pb.h google/protobuf/descriptor.pb.h.tmp > /dev/null
   if test $? -ne 0; then
@@ -56,10 +59,20 @@ do
   if test $? -ne 0; then
     CORE_PROTO_IS_CORRECT=0
   fi
+  diff google/protobuf/compiler/bsv/bsv_options.pb.h google/protobuf/compiler/bsv/bsv_options.pb.h.tmp > /dev/null
+  if test $? -ne 0; then
+    CORE_PROTO_IS_CORRECT=0
+  fi
+  diff google/protobuf/compiler/bsv/bsv_options.pb.cc google/protobuf/compiler/bsv/bsv_options.pb.cc.tmp > /dev/null
+  if test $? -ne 0; then
+    CORE_PROTO_IS_CORRECT=0
+  fi
 
   rm google/protobuf/descriptor.pb.h.tmp
   rm google/protobuf/descriptor.pb.cc.tmp
   rm google/protobuf/compiler/plugin.pb.h.tmp
   rm google/protobuf/compiler/plugin.pb.cc.tmp
+  rm google/protobuf/compiler/bsv/bsv_options.pb.h.tmp
+  rm google/protobuf/compiler/bsv/bsv_options.pb.cc.tmp
 done
 cd ..
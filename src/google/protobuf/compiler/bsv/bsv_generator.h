@@ -45,8 +45,8 @@ namespace protobuf {
 
 class Descriptor;
 class EnumDescriptor;
-class EnumValueDescriptor;
 class FieldDescriptor;
+class OneofDescriptor;
 class ServiceDescriptor;
 
 namespace io { class Printer; }
@@ -58,6 +58,18 @@ namespace bsv {
 // If you create your own protocol compiler binary and you want it to support
 // BSV output, you can do so by registering an instance of this
 // CodeGenerator with the CommandLineInterface in your main() function.
+//
+// For "foo.proto" the generator writes "foo_pb.json", which declares the
+// file's enums, messages and the tagged unions of their oneofs as BSV types
+// and its services as Connectal interfaces, and lists its extensions.
+//
+// With the "register" parameter, the generator also writes the fixed-layout
+// register encoding of each message as BSV structs and C++ pack/unpack
+// functions; see bsv_register.h.  The "wire" parameter implies "register"
+// and adds streaming codecs between that encoding and the wire format, with
+// cycle-level C++ models of them; their BSV is experimental, see bsv_wire.h.  The "proxy" parameter
+// also implies "register", and adds C++ stubs that batch calls to the
+// file's services and dispatch their responses; see bsv_proxy.h.
 class LIBPROTOC_EXPORT Generator : public CodeGenerator {
  public:
   Generator();
@@ -71,93 +83,19 @@ class LIBPROTOC_EXPORT Generator : public CodeGenerator {
 
  private:
   void PrintImports() const;
-  void PrintFileDescriptor() const;
-  void PrintTopLevelEnums() const;
-  void PrintAllNestedEnumsInFile() const;
-  void PrintNestedEnums(const Descriptor& descriptor) const;
-  void PrintEnum(const EnumDescriptor& enum_descriptor) const;
-
-  void PrintTopLevelExtensions() const;
-
-  void PrintFieldDescriptor(
-      const FieldDescriptor& field, bool is_extension) const;
-  void PrintFieldDescriptorsInDescriptor(
-      const Descriptor& message_descriptor,
-      bool is_extension,
-      const string& list_variable_name,
-      int (Descriptor::*CountFn)() const,
-      const FieldDescriptor* (Descriptor::*GetterFn)(int) const) const;
-  void PrintFieldsInDescriptor(const Descriptor& message_descriptor) const;
-  void PrintExtensionsInDescriptor(const Descriptor& message_descriptor) const;
-  void PrintMessageDescriptors() const;
-  void PrintDescriptor(const Descriptor& message_descriptor) const;
-  void PrintNestedDescriptors(const Descriptor& containing_descriptor) const;
-
-  void PrintMessages() const;
-  void PrintMessage(const Descriptor& message_descriptor, const string& prefix,
-                    vector<string>* to_register) const;
-  void PrintNestedMessages(const Descriptor& containing_descriptor,
-                           const string& prefix,
-                           vector<string>* to_register) const;
-
-  void FixForeignFieldsInDescriptors() const;
-  void FixForeignFieldsInDescriptor(
-      const Descriptor& descriptor,
-      const Descriptor* containing_descriptor) const;
-  void FixForeignFieldsInField(const Descriptor* containing_type,
-                               const FieldDescriptor& field,
-                               const string& bsv_dict_name) const;
-  void AddMessageToFileDescriptor(const Descriptor& descriptor) const;
-  void AddEnumToFileDescriptor(const EnumDescriptor& descriptor) const;
-  void AddExtensionToFileDescriptor(const FieldDescriptor& descriptor) const;
-  string FieldReferencingExpression(const Descriptor* containing_type,
-                                    const FieldDescriptor& field,
-                                    const string& bsv_dict_name) const;
-  template <typename DescriptorT>
-  void FixContainingTypeInDescriptor(
-      const DescriptorT& descriptor,
-      const Descriptor* containing_descriptor) const;
-
-  void FixForeignFieldsInExtensions() const;
-  void FixForeignFieldsInExtension(
-      const FieldDescriptor& extension_field) const;
-  void FixForeignFieldsInNestedExtensions(const Descriptor& descriptor) const;
-
-  void PrintServices() const;
-  void PrintServiceDescriptor(const ServiceDescriptor& descriptor) const;
-  void PrintServiceClass(const ServiceDescriptor& descriptor) const;
-  void PrintServiceStub(const ServiceDescriptor& descriptor) const;
-  void PrintDescriptorKeyAndModuleName(
-      const ServiceDescriptor& descriptor) const ;
-
-  void PrintEnumValueDescriptor(const EnumValueDescriptor& descriptor) const;
-  string OptionsValue(const string& class_name,
-                      const string& serialized_options) const;
-  bool GeneratingDescriptorProto() const;
-
-  template <typename DescriptorT>
-  string ModuleLevelDescriptorName(const DescriptorT& descriptor) const;
-  string ModuleLevelMessageName(const Descriptor& descriptor) const;
-  string ModuleLevelServiceDescriptorName(
-      const ServiceDescriptor& descriptor) const;
-
-  template <typename DescriptorT, typename DescriptorProtoT>
-  void PrintSerializedPbInterval(
-      const DescriptorT& descriptor, DescriptorProtoT& proto) const;
-
-  void FixAllDescriptorOptions() const;
-  void FixOptionsForField(const FieldDescriptor& field) const;
-  void FixOptionsForEnum(const EnumDescriptor& descriptor) const;
-  void FixOptionsForMessage(const Descriptor& descriptor) const;
-
-  void CopyPublicDependenciesAliases(
-      const string& copy_from, const FileDescriptor* file) const;
+  void PrintEnum(const EnumDescriptor& enum_descriptor, bool* first) const;
+  void PrintDescriptor(const Descriptor& message_descriptor,
+                       bool* first) const;
+  void PrintOneof(const OneofDescriptor& oneof, bool* first) const;
+  void PrintFieldDescriptor(const FieldDescriptor& field, bool* first) const;
+  void PrintExtensions() const;
+  void PrintServiceInterface(const ServiceDescriptor& descriptor,
+                             bool indication) const;
 
   // Very coarse-grained lock to ensure that Generate() is reentrant.
-  // Guards file_, printer_ and file_descriptor_serialized_.
+  // Guards file_ and printer_.
   mutable Mutex mutex_;
   mutable const FileDescriptor* file_;  // Set in Generate().  Under mutex_.
-  mutable string file_descriptor_serialized_;
   mutable io::Printer* printer_;  // Set in Generate().  Under mutex_.
 
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(Generator);
@@ -0,0 +1,116 @@
+// Generated by the protocol buffer compiler.  DO NOT EDIT!
+// source: google/protobuf/compiler/bsv/bsv_options.proto
+
+#define INTERNAL_SUPPRESS_PROTOBUF_FIELD_DEPRECATION
+#include "google/protobuf/compiler/bsv/bsv_options.pb.h"
+
+#include <algorithm>
+
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/once.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite_inl.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/generated_message_reflection.h>
+#include <google/protobuf/reflection_ops.h>
+#include <google/protobuf/wire_format.h>
+// @@protoc_insertion_point(includes)
+
+namespace google {
+namespace protobuf {
+namespace compiler {
+namespace bsv {
+
+namespace {
+
+
+}  // namespace
+
+
+void protobuf_AssignDesc_google_2fprotobuf_2fcompiler_2fbsv_2fbsv_5foptions_2eproto() {
+  protobuf_AddDesc_google_2fprotobuf_2fcompiler_2fbsv_2fbsv_5foptions_2eproto();
+  const ::google::protobuf::FileDescriptor* file =
+    ::google::protobuf::DescriptorPool::generated_pool()->FindFileByName(
+      "google/protobuf/compiler/bsv/bsv_options.proto");
+  GOOGLE_CHECK(file != NULL);
+}
+
+namespace {
+
+GOOGLE_PROTOBUF_DECLARE_ONCE(protobuf_AssignDescriptors_once_);
+inline void protobuf_AssignDescriptorsOnce() {
+  ::google::protobuf::GoogleOnceInit(&protobuf_AssignDescriptors_once_,
+                 &protobuf_AssignDesc_google_2fprotobuf_2fcompiler_2fbsv_2fbsv_5foptions_2eproto);
+}
+
+void protobuf_RegisterTypes(const ::std::string&) {
+  protobuf_AssignDescriptorsOnce();
+}
+
+}  // namespace
+
+void protobuf_ShutdownFile_google_2fprotobuf_2fcompiler_2fbsv_2fbsv_5foptions_2eproto() {
+}
+
+void protobuf_AddDesc_google_2fprotobuf_2fcompiler_2fbsv_2fbsv_5foptions_2eproto() {
+  static bool already_here = false;
+  if (already_here) return;
+  already_here = true;
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+  ::google::protobuf::protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  ::google::protobuf::DescriptorPool::InternalAddGeneratedFile(
+    "\n.google/protobuf/compiler/bsv/bsv_optio"
+    "ns.proto\022\034google.protobuf.compiler.bsv\032 "
+    "google/protobuf/descriptor.proto:2\n\tmax_"
+    "count\022\035.google.protobuf.FieldOptions\030\202\207\003"
+    " \001(\r:3\n\nmax_length\022\035.google.protobuf.Fie"
+    "ldOptions\030\203\207\003 \001(\r:2\n\tmin_value\022\035.google."
+    "protobuf.FieldOptions\030\204\207\003 \001(\003:2\n\tmax_val"
+    "ue\022\035.google.protobuf.FieldOptions\030\205\207\003 \001("
+    "\003B4\n com.google.protobuf.compiler.bsvB\020B"
+    "svOptionsProtos", 375);
+  ::google::protobuf::MessageFactory::InternalRegisterGeneratedFile(
+    "google/protobuf/compiler/bsv/bsv_options.proto", &protobuf_RegisterTypes);
+  ::google::protobuf::internal::ExtensionSet::RegisterExtension(
+    &::google::protobuf::FieldOptions::default_instance(),
+    50050, 13, false, false);
+  ::google::protobuf::internal::ExtensionSet::RegisterExtension(
+    &::google::protobuf::FieldOptions::default_instance(),
+    50051, 13, false, false);
+  ::google::protobuf::internal::ExtensionSet::RegisterExtension(
+    &::google::protobuf::FieldOptions::default_instance(),
+    50052, 3, false, false);
+  ::google::protobuf::internal::ExtensionSet::RegisterExtension(
+    &::google::protobuf::FieldOptions::default_instance(),
+    50053, 3, false, false);
+  ::google::protobuf::internal::OnShutdown(&protobuf_ShutdownFile_google_2fprotobuf_2fcompiler_2fbsv_2fbsv_5foptions_2eproto);
+}
+
+// Force AddDescriptors() to be called at static initialization time.
+struct StaticDescriptorInitializer_google_2fprotobuf_2fcompiler_2fbsv_2fbsv_5foptions_2eproto {
+  StaticDescriptorInitializer_google_2fprotobuf_2fcompiler_2fbsv_2fbsv_5foptions_2eproto() {
+    protobuf_AddDesc_google_2fprotobuf_2fcompiler_2fbsv_2fbsv_5foptions_2eproto();
+  }
+} static_descriptor_initializer_google_2fprotobuf_2fcompiler_2fbsv_2fbsv_5foptions_2eproto_;
+::google::protobuf::internal::ExtensionIdentifier< ::google::protobuf::FieldOptions,
+    ::google::protobuf::internal::PrimitiveTypeTraits< ::google::protobuf::uint32 >, 13, false >
+  max_count(kMaxCountFieldNumber, 0u);
+::google::protobuf::internal::ExtensionIdentifier< ::google::protobuf::FieldOptions,
+    ::google::protobuf::internal::PrimitiveTypeTraits< ::google::protobuf::uint32 >, 13, false >
+  max_length(kMaxLengthFieldNumber, 0u);
+::google::protobuf::internal::ExtensionIdentifier< ::google::protobuf::FieldOptions,
+    ::google::protobuf::internal::PrimitiveTypeTraits< ::google::protobuf::int64 >, 3, false >
+  min_value(kMinValueFieldNumber, GOOGLE_LONGLONG(0));
+::google::protobuf::internal::ExtensionIdentifier< ::google::protobuf::FieldOptions,
+    ::google::protobuf::internal::PrimitiveTypeTraits< ::google::protobuf::int64 >, 3, false >
+  max_value(kMaxValueFieldNumber, GOOGLE_LONGLONG(0));
+
+// @@protoc_insertion_point(namespace_scope)
+
+}  // namespace bsv
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
+
+// @@protoc_insertion_point(global_scope)
@@ -27,22 +27,19 @@
 // THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-
 // Author: kenton@google.com (Kenton Varda)
 //
 // TODO(kenton):  Share code with the versions of this test in other languages?
 //   It seemed like parameterizing it would add more complexity than it is
 //   worth.
 
-#include <memory>
-#ifndef _SHARED_PTR_H
-#include <google/protobuf/stubs/shared_ptr.h>
-#endif
+#include <string.h>
+#include <string>
+#include <vector>
 
 #include <google/protobuf/compiler/bsv/bsv_generator.h>
 #include <google/protobuf/compiler/command_line_interface.h>
-#include <google/protobuf/io/zero_copy_stream.h>
-#include <google/protobuf/io/printer.h>
+#include <google/protobuf/stubs/strutil.h>
 
 #include <google/protobuf/testing/googletest.h>
 #include <gtest/gtest.h>
@@ -54,64 +51,323 @@ namespace compiler {
 namespace bsv {
 namespace {
 
-class TestGenerator : public CodeGenerator {
+// A parsed JSON value.  Numbers keep their text.
+struct JsonValue {
+  enum Type { NULL_VALUE, BOOL, NUMBER, STRING, ARRAY, OBJECT };
+
+  JsonValue() : type(NULL_VALUE) {}
+
+  // Returns the member of an object named |key|, or NULL if there is none.
+  const JsonValue* Get(const string& key) const {
+    for (int i = 0; i < keys.size(); i++) {
+      if (keys[i] == key) return &values[i];
+    }
+    return NULL;
+  }
+
+  Type type;
+  string text;              // For BOOL, NUMBER and STRING.
+  vector<JsonValue> items;  // For ARRAY.
+  vector<string> keys;      // For OBJECT, parallel to values.
+  vector<JsonValue> values;
+};
+
+// A strict parser for the JSON grammar of RFC 7159.
+class JsonParser {
  public:
-  TestGenerator() {}
-  ~TestGenerator() {}
-
-  virtual bool Generate(const FileDescriptor* file,
-                        const string& parameter,
-                        GeneratorContext* context,
-                        string* error) const {
-    TryInsert("test_pb2.bsv", "imports", context);
-    TryInsert("test_pb2.bsv", "module_scope", context);
-    TryInsert("test_pb2.bsv", "class_scope:foo.Bar", context);
-    TryInsert("test_pb2.bsv", "class_scope:foo.Bar.Baz", context);
+  explicit JsonParser(const string& input) : input_(input), pos_(0) {}
+
+  // Parses the whole input as one value.  Returns false and sets *error if
+  // the input is not well-formed.
+  bool Parse(JsonValue* value, string* error) {
+    if (!ParseValue(value) || (SkipSpace(), pos_ != input_.size())) {
+      *error = "Malformed JSON at offset " + SimpleItoa(pos_) + ": " +
+          input_.substr(pos_, 40);
+      return false;
+    }
     return true;
   }
 
-  void TryInsert(const string& filename, const string& insertion_point,
-                 GeneratorContext* context) const {
-    google::protobuf::scoped_ptr<io::ZeroCopyOutputStream> output(
-        context->OpenForInsert(filename, insertion_point));
-    io::Printer printer(output.get(), '$');
-    printer.Print("// inserted $name$\n", "name", insertion_point);
+ private:
+  void SkipSpace() {
+    while (pos_ < input_.size() && strchr(" \t\r\n", input_[pos_]) != NULL &&
+           input_[pos_] != '\0') {
+      pos_++;
+    }
+  }
+
+  bool Consume(const char* text) {
+    SkipSpace();
+    int length = strlen(text);
+    if (input_.compare(pos_, length, text) != 0) return false;
+    pos_ += length;
+    return true;
   }
+
+  bool ConsumeDigits() {
+    int start = pos_;
+    while (pos_ < input_.size() && ascii_isdigit(input_[pos_])) pos_++;
+    return pos_ > start;
+  }
+
+  bool ParseValue(JsonValue* value) {
+    SkipSpace();
+    if (pos_ == input_.size()) return false;
+    char c = input_[pos_];
+    if (c == '{') return ParseObject(value);
+    if (c == '[') return ParseArray(value);
+    if (c == '"') {
+      value->type = JsonValue::STRING;
+      return ParseString(&value->text);
+    }
+    if (c == '-' || ascii_isdigit(c)) return ParseNumber(value);
+    value->type = JsonValue::BOOL;
+    if (Consume("true")) {
+      value->text = "true";
+    } else if (Consume("false")) {
+      value->text = "false";
+    } else {
+      value->type = JsonValue::NULL_VALUE;
+      return Consume("null");
+    }
+    return true;
+  }
+
+  bool ParseObject(JsonValue* value) {
+    value->type = JsonValue::OBJECT;
+    Consume("{");
+    if (Consume("}")) return true;
+    do {
+      string key;
+      SkipSpace();
+      if (!ParseString(&key) || !Consume(":")) return false;
+      value->keys.push_back(key);
+      value->values.push_back(JsonValue());
+      if (!ParseValue(&value->values.back())) return false;
+    } while (Consume(","));
+    return Consume("}");
+  }
+
+  bool ParseArray(JsonValue* value) {
+    value->type = JsonValue::ARRAY;
+    Consume("[");
+    if (Consume("]")) return true;
+    do {
+      value->items.push_back(JsonValue());
+      if (!ParseValue(&value->items.back())) return false;
+    } while (Consume(","));
+    return Consume("]");
+  }
+
+  // Only escapes are checked; the contents of strings are kept escaped.
+  bool ParseString(string* output) {
+    if (input_[pos_] != '"') return false;
+    int start = ++pos_;
+    while (pos_ < input_.size() && input_[pos_] != '"') {
+      if (static_cast<unsigned char>(input_[pos_]) < 0x20) return false;
+      if (input_[pos_] == '\\') {
+        pos_++;
+        if (pos_ == input_.size()) return false;
+        if (input_[pos_] == 'u') {
+          for (int i = 0; i < 4; i++) {
+            pos_++;
+            if (pos_ == input_.size() || input_[pos_] == '\0' ||
+                strchr("0123456789abcdefABCDEF", input_[pos_]) == NULL) {
+              return false;
+            }
+          }
+        } else if (strchr("\"\\/bfnrt", input_[pos_]) == NULL ||
+                   input_[pos_] == '\0') {
+          return false;
+        }
+      }
+      pos_++;
+    }
+    if (pos_ == input_.size()) return false;
+    output->assign(input_, start, pos_ - start);
+    pos_++;
+    return true;
+  }
+
+  bool ParseNumber(JsonValue* value) {
+    value->type = JsonValue::NUMBER;
+    int start = pos_;
+    if (input_[pos_] == '-') pos_++;
+    if (pos_ < input_.size() && input_[pos_] == '0') {
+      pos_++;
+    } else if (!ConsumeDigits()) {
+      return false;
+    }
+    if (pos_ < input_.size() && input_[pos_] == '.') {
+      pos_++;
+      if (!ConsumeDigits()) return false;
+    }
+    if (pos_ < input_.size() && (input_[pos_] == 'e' || input_[pos_] == 'E')) {
+      pos_++;
+      if (pos_ < input_.size() && (input_[pos_] == '+' || input_[pos_] == '-')) {
+        pos_++;
+      }
+      if (!ConsumeDigits()) return false;
+    }
+    value->text = input_.substr(start, pos_ - start);
+    return true;
+  }
+
+  const string& input_;
+  int pos_;
 };
 
-// This test verifies that all the expected insertion points exist.  It does
-// not verify that they are correctly-placed; that would require actually
-// compiling the output which is a bit more than I care to do for this test.
-TEST(BSVPluginTest, PluginTest) {
+// Runs the BSV generator on |proto_file|, found under |proto_path|, and
+// parses the JSON it writes.
+void GenerateJson(const string& proto_path, const string& proto_file,
+                  JsonValue* json) {
+  CommandLineInterface cli;
+  cli.SetInputsAreProtoPathRelative(true);
+  Generator bsv_generator;
+  cli.RegisterGenerator("--bsv_out", &bsv_generator, "");
+
+  string proto_path_flag = "-I" + proto_path;
+  string bsv_out = "--bsv_out=" + TestTempDir();
+  const char* argv[] = {
+    "protoc",
+    proto_path_flag.c_str(),
+    bsv_out.c_str(),
+    proto_file.c_str()
+  };
+  ASSERT_EQ(0, cli.Run(4, argv));
+
+  string json_file = StripSuffixString(proto_file, ".proto") + "_pb.json";
+  string contents;
+  GOOGLE_CHECK_OK(File::GetContents(TestTempDir() + "/" + json_file, &contents,
+                             true));
+  string error;
+  EXPECT_TRUE(JsonParser(contents).Parse(json, &error)) << error;
+}
+
+// Returns the global declaration named |name|, or NULL if there is none.
+const JsonValue* FindDecl(const JsonValue& json, const string& name) {
+  const JsonValue* decls = json.Get("globaldecls");
+  if (decls == NULL) return NULL;
+  for (int i = 0; i < decls->items.size(); i++) {
+    const JsonValue* tname = decls->items[i].Get("tname");
+    if (tname != NULL && tname->text == name) return &decls->items[i];
+  }
+  return NULL;
+}
+
+TEST(BSVPluginTest, UnittestProtosAreWellFormed) {
+  const char* kProtoFiles[] = {
+    "google/protobuf/unittest.proto",
+    "google/protobuf/unittest_arena.proto",
+    "google/protobuf/unittest_custom_options.proto",
+    "google/protobuf/unittest_drop_unknown_fields.proto",
+    "google/protobuf/unittest_embed_optimize_for.proto",
+    "google/protobuf/unittest_empty.proto",
+    "google/protobuf/unittest_enormous_descriptor.proto",
+    "google/protobuf/unittest_import.proto",
+    "google/protobuf/unittest_import_lite.proto",
+    "google/protobuf/unittest_import_public.proto",
+    "google/protobuf/unittest_import_public_lite.proto",
+    "google/protobuf/unittest_lite.proto",
+    "google/protobuf/unittest_lite_imports_nonlite.proto",
+    "google/protobuf/unittest_mset.proto",
+    "google/protobuf/unittest_no_arena.proto",
+    "google/protobuf/unittest_no_arena_import.proto",
+    "google/protobuf/unittest_no_field_presence.proto",
+    "google/protobuf/unittest_no_generic_services.proto",
+    "google/protobuf/unittest_optimize_for.proto",
+    "google/protobuf/unittest_preserve_unknown_enum.proto",
+    "google/protobuf/unittest_preserve_unknown_enum2.proto",
+    "google/protobuf/unittest_proto3_arena.proto",
+    "google/protobuf/compiler/bsv/bsv_register_unittest.proto",
+    "google/protobuf/compiler/bsv/bsv_wire_unittest.proto",
+  };
+  for (int i = 0; i < GOOGLE_ARRAYSIZE(kProtoFiles); i++) {
+    SCOPED_TRACE(kProtoFiles[i]);
+    JsonValue json;
+    GenerateJson(TestSourceDir(), kProtoFiles[i], &json);
+    ASSERT_EQ(JsonValue::OBJECT, json.type);
+    EXPECT_TRUE(json.Get("imports") != NULL);
+    EXPECT_TRUE(json.Get("globaldecls") != NULL);
+    EXPECT_TRUE(json.Get("extensions") != NULL);
+    EXPECT_TRUE(json.Get("interfaces") != NULL);
+  }
+}
+
+TEST(BSVPluginTest, DeclaresAllTypes) {
   GOOGLE_CHECK_OK(File::SetContents(TestTempDir() + "/test.proto",
                              "syntax = \"proto2\";\n"
                              "package foo;\n"
+                             "enum Color { RED = 3; BLUE = -1; }\n"
+                             "message Empty {}\n"
                              "message Bar {\n"
-                             "  message Baz {}\n"
-                             "}\n",
+                             "  message Baz { optional int32 x = 1; }\n"
+                             "  enum Kind { KIND_A = 0; KIND_B = 7; }\n"
+                             "  optional Kind kind = 1;\n"
+                             "  oneof choice {\n"
+                             "    Baz baz = 2;\n"
+                             "    Color color = 3;\n"
+                             "  }\n"
+                             "  optional Empty empty = 4;\n"
+                             "  extensions 100 to 199;\n"
+                             "}\n"
+                             "extend Bar { optional int32 size = 100; }\n",
                              true));
+  JsonValue json;
+  GenerateJson(TestTempDir(), "test.proto", &json);
 
-  google::protobuf::compiler::CommandLineInterface cli;
-  cli.SetInputsAreProtoPathRelative(true);
+  // Enums carry their numbers.
+  const JsonValue* color = FindDecl(json, "Color");
+  ASSERT_TRUE(color != NULL);
+  const JsonValue& color_type = *color->Get("tdtype");
+  EXPECT_EQ("Enum", color_type.Get("type")->text);
+  const JsonValue& colors = *color_type.Get("elements");
+  ASSERT_EQ(2, colors.items.size());
+  EXPECT_EQ("RED", colors.items[0].items[0].text);
+  EXPECT_EQ("3", colors.items[0].items[1].text);
+  EXPECT_EQ("BLUE", colors.items[1].items[0].text);
+  EXPECT_EQ("-1", colors.items[1].items[1].text);
 
-  bsv::Generator bsv_generator;
-  TestGenerator test_generator;
-  cli.RegisterGenerator("--bsv_out", &bsv_generator, "");
-  cli.RegisterGenerator("--test_out", &test_generator, "");
+  // Messages named Empty are declared too, and nested types are named
+  // after their containing types.
+  EXPECT_TRUE(FindDecl(json, "Empty") != NULL);
+  EXPECT_TRUE(FindDecl(json, "Bar_Baz") != NULL);
+  EXPECT_TRUE(FindDecl(json, "Bar_Kind") != NULL);
 
-  string proto_path = "-I" + TestTempDir();
-  string bsv_out = "--bsv_out=" + TestTempDir();
-  string test_out = "--test_out=" + TestTempDir();
+  // A oneof is one element of its message, holding a tagged union.
+  const JsonValue* choice = FindDecl(json, "Bar_Choice");
+  ASSERT_TRUE(choice != NULL);
+  const JsonValue& choice_type = *choice->Get("tdtype");
+  EXPECT_EQ("Union", choice_type.Get("type")->text);
+  const JsonValue& members = *choice_type.Get("elements");
+  ASSERT_EQ(3, members.items.size());
+  EXPECT_EQ("NotSet", members.items[0].Get("pname")->text);
+  EXPECT_EQ("Baz", members.items[1].Get("pname")->text);
+  EXPECT_EQ("Bar_Baz", members.items[1].Get("ptype")->Get("name")->text);
+  EXPECT_EQ("Color", members.items[2].Get("pname")->text);
 
-  const char* argv[] = {
-    "protoc",
-    proto_path.c_str(),
-    bsv_out.c_str(),
-    test_out.c_str(),
-    "test.proto"
-  };
+  const JsonValue* bar = FindDecl(json, "Bar");
+  ASSERT_TRUE(bar != NULL);
+  const JsonValue& fields = *bar->Get("tdtype")->Get("elements");
+  ASSERT_EQ(3, fields.items.size());
+  // Enum fields take as few bits as hold their numbers.
+  EXPECT_EQ("kind", fields.items[0].Get("pname")->text);
+  const JsonValue& kind_type = *fields.items[0].Get("ptype");
+  EXPECT_EQ("Bit", kind_type.Get("name")->text);
+  EXPECT_EQ("3", kind_type.Get("params")->items[0].Get("name")->text);
+  EXPECT_EQ("choice", fields.items[1].Get("pname")->text);
+  EXPECT_EQ("Bar_Choice", fields.items[1].Get("ptype")->Get("name")->text);
+  EXPECT_EQ("empty", fields.items[2].Get("pname")->text);
+  const JsonValue& ranges = *bar->Get("extension_ranges");
+  ASSERT_EQ(1, ranges.items.size());
+  EXPECT_EQ("100", ranges.items[0].items[0].text);
+  EXPECT_EQ("200", ranges.items[0].items[1].text);
 
-  EXPECT_EQ(0, cli.Run(5, argv));
+  const JsonValue& extensions = *json.Get("extensions");
+  ASSERT_EQ(1, extensions.items.size());
+  EXPECT_EQ("size", extensions.items[0].Get("ename")->text);
+  EXPECT_EQ("100", extensions.items[0].Get("number")->text);
+  EXPECT_EQ("Bar", extensions.items[0].Get("extendee")->text);
 }
 
 }  // namespace
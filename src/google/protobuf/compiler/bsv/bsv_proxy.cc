@@ -0,0 +1,459 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/compiler/bsv/bsv_proxy.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#ifndef _SHARED_PTR_H
+#include <google/protobuf/stubs/shared_ptr.h>
+#endif
+#include <set>
+#include <vector>
+
+#include <google/protobuf/compiler/bsv/bsv_register.h>
+#include <google/protobuf/compiler/code_generator.h>
+#include <google/protobuf/compiler/cpp/cpp_helpers.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/io/printer.h>
+#include <google/protobuf/io/zero_copy_stream.h>
+#include <google/protobuf/stubs/strutil.h>
+
+namespace google {
+namespace protobuf {
+namespace compiler {
+namespace bsv {
+
+namespace {
+
+// The size of the method index starting each entry of a batch.
+const int kMethodIndexSize = 4;
+
+string ProxyName(const ServiceDescriptor* service) {
+  return service->name() + "RequestProxy";
+}
+
+string WrapperName(const ServiceDescriptor* service) {
+  return service->name() + "IndicationWrapper";
+}
+
+string MethodEnumName(const MethodDescriptor* method) {
+  return "k" + cpp::UnderscoresToCamelCase(method->name(), true);
+}
+
+class ProxyFileGenerator {
+ public:
+  explicit ProxyFileGenerator(const FileDescriptor* file) : file_(file) {}
+
+  // Checks that every input and output type has a register encoding.
+  bool Init(string* error);
+
+  void GenerateHeader(io::Printer* printer);
+  void GenerateSource(io::Printer* printer);
+
+ private:
+  void GenerateProxyClass(const ServiceDescriptor* service,
+                          io::Printer* printer);
+  void GenerateWrapperClass(const ServiceDescriptor* service,
+                            io::Printer* printer);
+  void GenerateProxyMethods(const ServiceDescriptor* service,
+                            io::Printer* printer);
+  void GenerateWrapperMethods(const ServiceDescriptor* service,
+                              io::Printer* printer);
+  void GenerateNamespaceOpeners(io::Printer* printer);
+  void GenerateNamespaceClosers(io::Printer* printer);
+
+  // Returns the size of the largest entry a batch for |service| may hold.
+  int MaxEntrySize(const ServiceDescriptor* service, bool indication);
+
+  const FileDescriptor* file_;
+  RegisterLayoutSet layouts_;
+  map<const Descriptor*, const RegisterLayout*> layout_by_type_;
+  // The files other than file_ whose types are passed to methods.
+  vector<const FileDescriptor*> foreign_files_;
+};
+
+bool ProxyFileGenerator::Init(string* error) {
+  set<const FileDescriptor*> seen;
+  for (int i = 0; i < file_->service_count(); i++) {
+    const ServiceDescriptor* service = file_->service(i);
+    for (int j = 0; j < service->method_count(); j++) {
+      const Descriptor* types[] = {
+        service->method(j)->input_type(),
+        service->method(j)->output_type(),
+      };
+      for (int k = 0; k < GOOGLE_ARRAYSIZE(types); k++) {
+        const RegisterLayout* layout = layouts_.GetLayout(types[k], error);
+        if (layout == NULL) return false;
+        layout_by_type_[types[k]] = layout;
+        const FileDescriptor* file = types[k]->file();
+        if (file != file_ && seen.insert(file).second) {
+          foreign_files_.push_back(file);
+        }
+      }
+    }
+  }
+  return true;
+}
+
+int ProxyFileGenerator::MaxEntrySize(const ServiceDescriptor* service,
+                                     bool indication) {
+  int size = 0;
+  for (int i = 0; i < service->method_count(); i++) {
+    const MethodDescriptor* method = service->method(i);
+    const Descriptor* type =
+        indication ? method->output_type() : method->input_type();
+    size = std::max(size, layout_by_type_[type]->size);
+  }
+  return kMethodIndexSize + size;
+}
+
+void ProxyFileGenerator::GenerateNamespaceOpeners(io::Printer* printer) {
+  vector<string> parts;
+  SplitStringUsing(file_->package(), ".", &parts);
+  for (int i = 0; i < parts.size(); i++) {
+    printer->Print("namespace $part$ {\n", "part", parts[i]);
+  }
+  if (!parts.empty()) printer->Print("\n");
+}
+
+void ProxyFileGenerator::GenerateNamespaceClosers(io::Printer* printer) {
+  vector<string> parts;
+  SplitStringUsing(file_->package(), ".", &parts);
+  for (int i = parts.size() - 1; i >= 0; i--) {
+    printer->Print("}  // namespace $part$\n", "part", parts[i]);
+  }
+}
+
+void ProxyFileGenerator::GenerateHeader(io::Printer* printer) {
+  string filename_identifier = cpp::FilenameIdentifier(file_->name());
+  printer->Print(
+    "// Generated by the protocol buffer compiler.  DO NOT EDIT!\n"
+    "// source: $filename$\n"
+    "//\n"
+    "// Batching stubs for the services in the source file.  A batch is a\n"
+    "// sequence of entries, each a 4-byte little-endian method index followed\n"
+    "// by the register encoding of the method's request or response.\n"
+    "\n"
+    "#ifndef PROTOBUF_$filename_identifier$_2eproxy__INCLUDED\n"
+    "#define PROTOBUF_$filename_identifier$_2eproxy__INCLUDED\n"
+    "\n"
+    "#include \"$basename$.regs.h\"\n",
+    "filename", file_->name(),
+    "filename_identifier", filename_identifier,
+    "basename", cpp::StripProto(file_->name()));
+  for (int i = 0; i < foreign_files_.size(); i++) {
+    printer->Print("#include \"$basename$.regs.h\"\n",
+                   "basename", cpp::StripProto(foreign_files_[i]->name()));
+  }
+  printer->Print("\n");
+  GenerateNamespaceOpeners(printer);
+
+  for (int i = 0; i < file_->service_count(); i++) {
+    GenerateProxyClass(file_->service(i), printer);
+    GenerateWrapperClass(file_->service(i), printer);
+  }
+
+  GenerateNamespaceClosers(printer);
+  printer->Print(
+    "\n"
+    "#endif  // PROTOBUF_$filename_identifier$_2eproxy__INCLUDED\n",
+    "filename_identifier", filename_identifier);
+}
+
+void ProxyFileGenerator::GenerateProxyClass(const ServiceDescriptor* service,
+                                            io::Printer* printer) {
+  map<string, string> vars;
+  vars["full_name"] = service->full_name();
+  vars["proxy"] = ProxyName(service);
+  vars["max_entry_size"] = SimpleItoa(MaxEntrySize(service, false));
+  printer->Print(vars,
+    "// $full_name$: batches calls in a caller-owned buffer, so that\n"
+    "// the hardware is notified once per batch rather than once per call.\n"
+    "class $proxy$ {\n"
+    " public:\n"
+    "  // The index of each method in a batch.\n"
+    "  enum Method {\n");
+  for (int i = 0; i < service->method_count(); i++) {
+    printer->Print("    $enum_name$ = $index$,\n",
+                   "enum_name", MethodEnumName(service->method(i)),
+                   "index", SimpleItoa(i));
+  }
+  printer->Print(vars,
+    "  };\n"
+    "\n"
+    "  // The size of the largest call in a batch.\n"
+    "  static const int kMaxEntrySize = $max_entry_size$;\n"
+    "\n"
+    "  // Appends calls to the |capacity| bytes at |buffer|, which must outlive\n"
+    "  // the proxy.\n"
+    "  $proxy$(::google::protobuf::uint8* buffer, int capacity);\n"
+    "\n");
+
+  for (int i = 0; i < service->method_count(); i++) {
+    const MethodDescriptor* method = service->method(i);
+    printer->Print(
+      "  // Appends a call to $name$.  Returns false, leaving the batch as it\n"
+      "  // was, if the call does not fit in the buffer or |request| exceeds\n"
+      "  // the bounds of its register encoding.\n"
+      "  bool $name$(const $input_type$& request);\n"
+      "\n",
+      "name", method->name(),
+      "input_type", cpp::ClassName(method->input_type(), true));
+  }
+
+  printer->Print(vars,
+    "  // The batch so far: size() bytes holding count() calls.\n"
+    "  const ::google::protobuf::uint8* data() const { return buffer_; }\n"
+    "  int size() const { return size_; }\n"
+    "  int count() const { return count_; }\n"
+    "\n"
+    "  // Empties the batch, once the hardware has taken it.\n"
+    "  void Clear() {\n"
+    "    size_ = 0;\n"
+    "    count_ = 0;\n"
+    "  }\n"
+    "\n"
+    " private:\n"
+    "  ::google::protobuf::uint8* const buffer_;\n"
+    "  const int capacity_;\n"
+    "  int size_;\n"
+    "  int count_;\n"
+    "\n"
+    "  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS($proxy$);\n"
+    "};\n"
+    "\n");
+}
+
+void ProxyFileGenerator::GenerateWrapperClass(const ServiceDescriptor* service,
+                                              io::Printer* printer) {
+  map<string, string> vars;
+  vars["full_name"] = service->full_name();
+  vars["wrapper"] = WrapperName(service);
+  vars["max_entry_size"] = SimpleItoa(MaxEntrySize(service, true));
+  printer->Print(vars,
+    "// $full_name$: receives the responses to calls, in batches\n"
+    "// written by the hardware.\n"
+    "class $wrapper$ {\n"
+    " public:\n"
+    "  // The size of the largest response in a batch.\n"
+    "  static const int kMaxEntrySize = $max_entry_size$;\n"
+    "\n"
+    "  $wrapper$() {}\n"
+    "  virtual ~$wrapper$();\n"
+    "\n"
+    "  // Calls the method of each response in the |size| bytes at |data|, in\n"
+    "  // order.  Returns false if the batch is malformed, after calling the\n"
+    "  // methods of the responses before the malformed one.\n"
+    "  bool Dispatch(const ::google::protobuf::uint8* data, int size);\n"
+    "\n");
+
+  for (int i = 0; i < service->method_count(); i++) {
+    const MethodDescriptor* method = service->method(i);
+    printer->Print(
+      "  // Called with the response to a call to $name$.\n"
+      "  virtual void $name$(const $output_type$& response) = 0;\n"
+      "\n",
+      "name", method->name(),
+      "output_type", cpp::ClassName(method->output_type(), true));
+  }
+
+  printer->Print(vars,
+    " private:\n"
+    "  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS($wrapper$);\n"
+    "};\n"
+    "\n");
+}
+
+void ProxyFileGenerator::GenerateSource(io::Printer* printer) {
+  printer->Print(
+    "// Generated by the protocol buffer compiler.  DO NOT EDIT!\n"
+    "// source: $filename$\n"
+    "\n"
+    "#include \"$basename$.proxy.h\"\n"
+    "\n",
+    "filename", file_->name(),
+    "basename", cpp::StripProto(file_->name()));
+  if (file_->service_count() == 0) return;
+  GenerateNamespaceOpeners(printer);
+
+  printer->Print(
+    "namespace {\n"
+    "\n"
+    "void WriteMethodIndex(::google::protobuf::uint32 index,\n"
+    "                      ::google::protobuf::uint8* target) {\n"
+    "  for (int i = 0; i < $size$; i++) {\n"
+    "    target[i] = static_cast< ::google::protobuf::uint8>(index >> (8 * i));\n"
+    "  }\n"
+    "}\n"
+    "\n"
+    "::google::protobuf::uint32 ReadMethodIndex(\n"
+    "    const ::google::protobuf::uint8* buffer) {\n"
+    "  ::google::protobuf::uint32 index = 0;\n"
+    "  for (int i = 0; i < $size$; i++) {\n"
+    "    index |= static_cast< ::google::protobuf::uint32>(buffer[i]) << (8 * i);\n"
+    "  }\n"
+    "  return index;\n"
+    "}\n"
+    "\n"
+    "}  // namespace\n"
+    "\n",
+    "size", SimpleItoa(kMethodIndexSize));
+
+  for (int i = 0; i < file_->service_count(); i++) {
+    GenerateProxyMethods(file_->service(i), printer);
+    GenerateWrapperMethods(file_->service(i), printer);
+  }
+
+  GenerateNamespaceClosers(printer);
+}
+
+void ProxyFileGenerator::GenerateProxyMethods(const ServiceDescriptor* service,
+                                              io::Printer* printer) {
+  printer->Print(
+    "$proxy$::$proxy$(\n"
+    "    ::google::protobuf::uint8* buffer, int capacity)\n"
+    "    : buffer_(buffer), capacity_(capacity), size_(0), count_(0) {}\n"
+    "\n"
+    "#ifndef _MSC_VER\n"
+    "const int $proxy$::kMaxEntrySize;\n"
+    "#endif  // !_MSC_VER\n"
+    "\n",
+    "proxy", ProxyName(service));
+
+  for (int i = 0; i < service->method_count(); i++) {
+    const MethodDescriptor* method = service->method(i);
+    map<string, string> vars;
+    vars["proxy"] = ProxyName(service);
+    vars["name"] = method->name();
+    vars["enum_name"] = MethodEnumName(method);
+    vars["input_type"] = cpp::ClassName(method->input_type(), true);
+    vars["pack"] = PackFunctionName(method->input_type(), true);
+    vars["size_name"] = PackedSizeName(method->input_type(), true);
+    vars["index_size"] = SimpleItoa(kMethodIndexSize);
+    printer->Print(vars,
+      "bool $proxy$::$name$(const $input_type$& request) {\n"
+      "  if (capacity_ - size_ < $index_size$ + $size_name$) return false;\n"
+      "  ::google::protobuf::uint8* target = buffer_ + size_;\n"
+      "  if ($pack$(request, target + $index_size$) == NULL) return false;\n"
+      "  WriteMethodIndex($enum_name$, target);\n"
+      "  size_ += $index_size$ + $size_name$;\n"
+      "  count_++;\n"
+      "  return true;\n"
+      "}\n"
+      "\n");
+  }
+}
+
+void ProxyFileGenerator::GenerateWrapperMethods(
+    const ServiceDescriptor* service, io::Printer* printer) {
+  map<string, string> vars;
+  vars["proxy"] = ProxyName(service);
+  vars["wrapper"] = WrapperName(service);
+  vars["index_size"] = SimpleItoa(kMethodIndexSize);
+  printer->Print(vars,
+    "#ifndef _MSC_VER\n"
+    "const int $wrapper$::kMaxEntrySize;\n"
+    "#endif  // !_MSC_VER\n"
+    "\n"
+    "$wrapper$::~$wrapper$() {}\n"
+    "\n"
+    "bool $wrapper$::Dispatch(\n"
+    "    const ::google::protobuf::uint8* data, int size) {\n"
+    "  const ::google::protobuf::uint8* end = data + size;\n"
+    "  while (data != end) {\n"
+    "    if (end - data < $index_size$) return false;\n"
+    "    ::google::protobuf::uint32 index = ReadMethodIndex(data);\n"
+    "    data += $index_size$;\n"
+    "    switch (index) {\n");
+  printer->Indent();
+  printer->Indent();
+  printer->Indent();
+
+  for (int i = 0; i < service->method_count(); i++) {
+    const MethodDescriptor* method = service->method(i);
+    vars["name"] = method->name();
+    vars["enum_name"] = MethodEnumName(method);
+    vars["output_type"] = cpp::ClassName(method->output_type(), true);
+    vars["unpack"] = UnpackFunctionName(method->output_type(), true);
+    vars["size_name"] = PackedSizeName(method->output_type(), true);
+    printer->Print(vars,
+      "case $proxy$::$enum_name$: {\n"
+      "  if (end - data < $size_name$) return false;\n"
+      "  $output_type$ response;\n"
+      "  data = $unpack$(data, &response);\n"
+      "  if (data == NULL) return false;\n"
+      "  $name$(response);\n"
+      "  break;\n"
+      "}\n");
+  }
+
+  printer->Print(
+    "default:\n"
+    "  return false;\n");
+  printer->Outdent();
+  printer->Outdent();
+  printer->Outdent();
+  printer->Print(
+    "    }\n"
+    "  }\n"
+    "  return true;\n"
+    "}\n"
+    "\n");
+}
+
+}  // namespace
+
+bool GenerateProxyFiles(const FileDescriptor* file,
+                        GeneratorContext* context, string* error) {
+  ProxyFileGenerator generator(file);
+  if (!generator.Init(error)) return false;
+
+  string basename = cpp::StripProto(file->name());
+  {
+    google::protobuf::scoped_ptr<io::ZeroCopyOutputStream> output(
+        context->Open(basename + ".proxy.h"));
+    io::Printer printer(output.get(), '$');
+    generator.GenerateHeader(&printer);
+  }
+  {
+    google::protobuf::scoped_ptr<io::ZeroCopyOutputStream> output(
+        context->Open(basename + ".proxy.cc"));
+    io::Printer printer(output.get(), '$');
+    generator.GenerateSource(&printer);
+  }
+  return true;
+}
+
+}  // namespace bsv
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,76 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Generates C++ stubs for calling the services of a file in hardware, in the
+// style of Connectal's proxies and wrappers.  Calls and their responses move
+// in batches: a proxy appends calls to a caller-owned, DMA-able buffer, and
+// the hardware is notified once per batch rather than once per call; a
+// wrapper hands each response of a batch the hardware wrote to a virtual
+// method.
+//
+// A batch is a sequence of entries, each a 4-byte little-endian method index
+// followed by the register encoding (bsv_register.h) of the method's input
+// type, for calls, or output type, for responses.  The method indices are
+// those of the rpcs in the service, which the request and indication
+// interfaces of the generator's JSON output list in the same order.
+
+#ifndef GOOGLE_PROTOBUF_COMPILER_BSV_PROXY_H__
+#define GOOGLE_PROTOBUF_COMPILER_BSV_PROXY_H__
+
+#include <string>
+
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+
+class FileDescriptor;
+
+namespace compiler {
+
+class GeneratorContext;
+
+namespace bsv {
+
+// Writes a batching proxy and an indication wrapper for every service in
+// |file| to "foo.proxy.h" and "foo.proxy.cc".  They use the pack/unpack
+// functions written by GenerateRegisterFiles() for |file| and the files it
+// imports.  Returns false and sets *error if some input or output type has
+// no register encoding.
+bool GenerateProxyFiles(const FileDescriptor* file,
+                        GeneratorContext* context, string* error);
+
+}  // namespace bsv
+}  // namespace compiler
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_COMPILER_BSV_PROXY_H__
@@ -0,0 +1,288 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <string.h>
+#include <vector>
+
+#include <google/protobuf/compiler/bsv/bsv_generator.h>
+#include <google/protobuf/compiler/bsv/bsv_register_unittest.pb.h>
+#include <google/protobuf/compiler/bsv/bsv_register_unittest.proxy.h>
+#include <google/protobuf/compiler/bsv/bsv_register_unittest.regs.h>
+#include <google/protobuf/compiler/command_line_interface.h>
+#include <google/protobuf/util/message_differencer.h>
+
+#include <google/protobuf/stubs/stl_util.h>
+#include <google/protobuf/stubs/strutil.h>
+#include <google/protobuf/testing/file.h>
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace compiler {
+namespace bsv {
+namespace {
+
+using protobuf_unittest::RegisterAllTypes;
+using protobuf_unittest::RegisterBounded;
+using protobuf_unittest::RegisterPoint;
+using protobuf_unittest::RegisterServiceIndicationWrapper;
+using protobuf_unittest::RegisterServiceRequestProxy;
+
+typedef RegisterAllTypes::NestedEmpty NestedEmpty;
+
+RegisterPoint MakePoint(int x, int y) {
+  RegisterPoint point;
+  point.set_x(x);
+  point.set_y(y);
+  return point;
+}
+
+// Appends an entry for |method| holding |packed_size| bytes of |message|,
+// as the hardware would.
+template <typename Type>
+void AppendEntry(int method, const Type& message,
+                 uint8* (*pack)(const Type&, uint8*), int packed_size,
+                 string* batch) {
+  for (int i = 0; i < 4; i++) {
+    batch->push_back(static_cast<char>(method >> (8 * i)));
+  }
+  string packed(packed_size, '\0');
+  pack(message, reinterpret_cast<uint8*>(string_as_array(&packed)));
+  batch->append(packed);
+}
+
+// Records the responses it is given.
+class RecordingWrapper : public RegisterServiceIndicationWrapper {
+ public:
+  virtual void Measure(const RegisterPoint& response) {
+    calls_.push_back("Measure");
+    points_.push_back(response);
+  }
+  virtual void Paint(const RegisterAllTypes& response) {
+    calls_.push_back("Paint");
+    all_types_.push_back(response);
+  }
+  virtual void Ping(const NestedEmpty& response) {
+    calls_.push_back("Ping");
+  }
+
+  vector<string> calls_;
+  vector<RegisterPoint> points_;
+  vector<RegisterAllTypes> all_types_;
+};
+
+TEST(ProxyTest, BatchesCalls) {
+  EXPECT_EQ(4 + protobuf_unittest::kRegisterBoundedPackedSize,
+            RegisterServiceRequestProxy::kMaxEntrySize);
+  EXPECT_EQ(4 + protobuf_unittest::kRegisterAllTypesPackedSize,
+            RegisterServiceIndicationWrapper::kMaxEntrySize);
+
+  vector<uint8> buffer(1000, 0xff);
+  RegisterServiceRequestProxy proxy(&buffer[0], buffer.size());
+  RegisterPoint point = MakePoint(1, -2);
+  NestedEmpty empty;
+  EXPECT_TRUE(proxy.Paint(point));
+  EXPECT_TRUE(proxy.Ping(empty));
+  EXPECT_TRUE(proxy.Paint(MakePoint(3, 4)));
+  EXPECT_EQ(3, proxy.count());
+  EXPECT_EQ(3 * 4 + 2 * protobuf_unittest::kRegisterPointPackedSize,
+            proxy.size());
+  EXPECT_EQ(&buffer[0], proxy.data());
+
+  string expected;
+  AppendEntry(RegisterServiceRequestProxy::kPaint, point,
+              &protobuf_unittest::PackRegisterPoint,
+              protobuf_unittest::kRegisterPointPackedSize, &expected);
+  AppendEntry(RegisterServiceRequestProxy::kPing, empty,
+              &protobuf_unittest::PackRegisterAllTypes_NestedEmpty,
+              protobuf_unittest::kRegisterAllTypes_NestedEmptyPackedSize,
+              &expected);
+  AppendEntry(RegisterServiceRequestProxy::kPaint, MakePoint(3, 4),
+              &protobuf_unittest::PackRegisterPoint,
+              protobuf_unittest::kRegisterPointPackedSize, &expected);
+  EXPECT_EQ(expected,
+            string(reinterpret_cast<const char*>(proxy.data()), proxy.size()));
+
+  proxy.Clear();
+  EXPECT_EQ(0, proxy.count());
+  EXPECT_EQ(0, proxy.size());
+}
+
+TEST(ProxyTest, RejectsCallsThatDoNotFit) {
+  const int kEntrySize = 4 + protobuf_unittest::kRegisterPointPackedSize;
+  vector<uint8> buffer(2 * kEntrySize + 1);
+  RegisterServiceRequestProxy proxy(&buffer[0], buffer.size());
+  EXPECT_TRUE(proxy.Paint(MakePoint(1, 2)));
+  EXPECT_TRUE(proxy.Paint(MakePoint(3, 4)));
+  EXPECT_FALSE(proxy.Paint(MakePoint(5, 6)));
+  EXPECT_EQ(2, proxy.count());
+  EXPECT_EQ(2 * kEntrySize, proxy.size());
+
+  // Empty requests still take a method index.
+  EXPECT_FALSE(proxy.Ping(NestedEmpty()));
+
+  // Requests past the bounds of the register encoding are not appended.
+  vector<uint8> large(RegisterServiceRequestProxy::kMaxEntrySize);
+  RegisterServiceRequestProxy large_proxy(&large[0], large.size());
+  RegisterBounded request;
+  for (int i = 0; i < 5; i++) request.add_values(i);
+  EXPECT_FALSE(large_proxy.Measure(request));
+  EXPECT_EQ(0, large_proxy.size());
+  request.mutable_values()->RemoveLast();
+  EXPECT_TRUE(large_proxy.Measure(request));
+  EXPECT_EQ(RegisterServiceRequestProxy::kMaxEntrySize, large_proxy.size());
+}
+
+TEST(ProxyTest, DispatchesResponses) {
+  RegisterAllTypes all_types;
+  all_types.set_int32_value(-5);
+  all_types.mutable_point()->set_x(7);
+
+  string batch;
+  AppendEntry(RegisterServiceRequestProxy::kMeasure, MakePoint(1, 2),
+              &protobuf_unittest::PackRegisterPoint,
+              protobuf_unittest::kRegisterPointPackedSize, &batch);
+  AppendEntry(RegisterServiceRequestProxy::kPing, NestedEmpty(),
+              &protobuf_unittest::PackRegisterAllTypes_NestedEmpty,
+              protobuf_unittest::kRegisterAllTypes_NestedEmptyPackedSize,
+              &batch);
+  AppendEntry(RegisterServiceRequestProxy::kPaint, all_types,
+              &protobuf_unittest::PackRegisterAllTypes,
+              protobuf_unittest::kRegisterAllTypesPackedSize, &batch);
+
+  RecordingWrapper wrapper;
+  EXPECT_TRUE(wrapper.Dispatch(reinterpret_cast<const uint8*>(batch.data()),
+                               batch.size()));
+  ASSERT_EQ(3, wrapper.calls_.size());
+  EXPECT_EQ("Measure", wrapper.calls_[0]);
+  EXPECT_EQ("Ping", wrapper.calls_[1]);
+  EXPECT_EQ("Paint", wrapper.calls_[2]);
+  EXPECT_TRUE(util::MessageDifferencer::Equals(MakePoint(1, 2),
+                                               wrapper.points_[0]));
+  EXPECT_EQ(-5, wrapper.all_types_[0].int32_value());
+  EXPECT_EQ(7, wrapper.all_types_[0].point().x());
+
+  EXPECT_TRUE(wrapper.Dispatch(NULL, 0));
+  EXPECT_EQ(3, wrapper.calls_.size());
+}
+
+TEST(ProxyTest, RejectsMalformedBatches) {
+  string batch;
+  AppendEntry(RegisterServiceRequestProxy::kMeasure, MakePoint(1, 2),
+              &protobuf_unittest::PackRegisterPoint,
+              protobuf_unittest::kRegisterPointPackedSize, &batch);
+  const uint8* data = reinterpret_cast<const uint8*>(batch.data());
+
+  // A truncated response, after a whole one.
+  string truncated = batch + batch.substr(0, batch.size() - 1);
+  RecordingWrapper wrapper;
+  EXPECT_FALSE(wrapper.Dispatch(
+      reinterpret_cast<const uint8*>(truncated.data()), truncated.size()));
+  EXPECT_EQ(1, wrapper.calls_.size());
+
+  // A truncated method index.
+  EXPECT_FALSE(wrapper.Dispatch(data, 3));
+
+  // An unknown method.
+  string unknown = batch;
+  unknown[0] = 3;
+  EXPECT_FALSE(wrapper.Dispatch(
+      reinterpret_cast<const uint8*>(unknown.data()), unknown.size()));
+
+  // A response that does not decode: bools are 0 or 1.
+  RegisterAllTypes all_types;
+  string invalid;
+  AppendEntry(RegisterServiceRequestProxy::kPaint, all_types,
+              &protobuf_unittest::PackRegisterAllTypes,
+              protobuf_unittest::kRegisterAllTypesPackedSize, &invalid);
+  invalid[4 + 72] = 2;
+  EXPECT_FALSE(wrapper.Dispatch(
+      reinterpret_cast<const uint8*>(invalid.data()), invalid.size()));
+  EXPECT_EQ(1, wrapper.calls_.size());
+}
+
+// -------------------------------------------------------------------
+
+TEST(ProxyGeneratorTest, IndicationInterfaces) {
+  GOOGLE_CHECK_OK(File::SetContents(TestTempDir() + "/service.proto",
+                             "syntax = \"proto2\";\n"
+                             "message Request { required int32 x = 1; }\n"
+                             "message Response { required int32 y = 1; }\n"
+                             "service Echo {\n"
+                             "  rpc Say(Request) returns (Response);\n"
+                             "}\n",
+                             true));
+
+  CommandLineInterface cli;
+  cli.SetInputsAreProtoPathRelative(true);
+  Generator bsv_generator;
+  cli.RegisterGenerator("--bsv_out", &bsv_generator, "");
+
+  string proto_path = "-I" + TestTempDir();
+  string bsv_out = "--bsv_out=proxy:" + TestTempDir();
+  const char* argv[] = {
+    "protoc",
+    proto_path.c_str(),
+    bsv_out.c_str(),
+    "service.proto"
+  };
+  ASSERT_EQ(0, cli.Run(4, argv));
+
+  string json;
+  GOOGLE_CHECK_OK(File::GetContents(TestTempDir() + "/service_pb.json", &json,
+                             true));
+  EXPECT_TRUE(HasSuffixString(json,
+      "  \"interfaces\": [\n"
+      "    { \"cname\": \"Echo\", \"cdecls\": [\n"
+      "      { \"dname\": \"Say\", \"dparams\": [\n"
+      "          { \"pname\": \"v\", \"ptype\": { \"name\": \"Request\" } }\n"
+      "      ] }\n"
+      "    ] },\n"
+      "    { \"cname\": \"EchoIndication\", \"cdecls\": [\n"
+      "      { \"dname\": \"Say\", \"dparams\": [\n"
+      "          { \"pname\": \"v\", \"ptype\": { \"name\": \"Response\" } }\n"
+      "      ] }\n"
+      "    ] }\n"
+      "  ]\n"
+      "}\n")) << json;
+
+  // "proxy" implies "register".
+  EXPECT_TRUE(File::Exists(TestTempDir() + "/service.regs.h"));
+  EXPECT_TRUE(File::Exists(TestTempDir() + "/service.proxy.h"));
+  EXPECT_TRUE(File::Exists(TestTempDir() + "/service.proxy.cc"));
+}
+
+}  // namespace
+}  // namespace bsv
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
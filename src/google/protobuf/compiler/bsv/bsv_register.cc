@@ -0,0 +1,1339 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/compiler/bsv/bsv_register.h>
+
+#include <memory>
+#ifndef _SHARED_PTR_H
+#include <google/protobuf/stubs/shared_ptr.h>
+#endif
+#include <algorithm>
+#include <set>
+
+#include <google/protobuf/compiler/bsv/bsv_options.pb.h>
+#include <google/protobuf/compiler/code_generator.h>
+#include <google/protobuf/compiler/cpp/cpp_helpers.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/io/printer.h>
+#include <google/protobuf/io/zero_copy_stream.h>
+#include <google/protobuf/stubs/stl_util.h>
+#include <google/protobuf/stubs/stringprintf.h>
+#include <google/protobuf/stubs/strutil.h>
+
+namespace google {
+namespace protobuf {
+namespace compiler {
+namespace bsv {
+
+namespace {
+
+// Words which cannot be used as BSV identifiers.
+const char* const kBsvKeywords[] = {
+  "action", "actionvalue", "begin", "bit", "case", "default", "deriving",
+  "else", "end", "endaction", "endactionvalue", "endcase", "endfunction",
+  "endinterface", "endmethod", "endmodule", "endpackage", "endrule",
+  "endrules", "enum", "export", "for", "function", "if", "import",
+  "interface", "let", "match", "matches", "method", "module", "package",
+  "provisos", "return", "rule", "rules", "struct", "tagged", "type",
+  "typedef", "union", "void", "while",
+};
+
+bool IsBsvKeyword(const string& word) {
+  for (int i = 0; i < GOOGLE_ARRAYSIZE(kBsvKeywords); i++) {
+    if (word == kBsvKeywords[i]) return true;
+  }
+  return false;
+}
+
+// Returns true if |layout|, or the layout of any message it contains, has a
+// field with a count, which Pack refuses to write when it is over the bound.
+bool HasBoundedFields(const RegisterLayout* layout) {
+  for (int i = 0; i < layout->fields.size(); i++) {
+    const RegisterField& field = layout->fields[i];
+    if (field.count_size > 0) return true;
+    if (field.message != NULL && HasBoundedFields(field.message)) return true;
+  }
+  return false;
+}
+
+// Returns the name of the BSV struct member for |field|.  BSV member names
+// must start with a lower-case letter.
+string BsvMemberName(const FieldDescriptor* field) {
+  string name = field->name();
+  if ('A' <= name[0] && name[0] <= 'Z') name[0] += 'a' - 'A';
+  if (IsBsvKeyword(name)) name += "_";
+  return name;
+}
+
+// Returns the BSV type of one element of |field|.
+string BsvElementType(const RegisterField& field) {
+  switch (field.field->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_INT32:
+    case FieldDescriptor::CPPTYPE_ENUM:
+      return "Int#(32)";
+    case FieldDescriptor::CPPTYPE_INT64:
+      return "Int#(64)";
+    case FieldDescriptor::CPPTYPE_UINT32:
+      return "UInt#(32)";
+    case FieldDescriptor::CPPTYPE_UINT64:
+      return "UInt#(64)";
+    case FieldDescriptor::CPPTYPE_FLOAT:
+      return "Bit#(32)";
+    case FieldDescriptor::CPPTYPE_DOUBLE:
+      return "Bit#(64)";
+    case FieldDescriptor::CPPTYPE_BOOL:
+      return "UInt#(8)";
+    case FieldDescriptor::CPPTYPE_MESSAGE:
+      return BsvTypeName(field.field->message_type());
+    case FieldDescriptor::CPPTYPE_STRING:
+      return "Bit#(8)";
+  }
+  GOOGLE_LOG(FATAL) << "Can't get here.";
+  return "";
+}
+
+// Returns the width of the little-endian integer holding |field| in the
+// register encoding, or zero if it is a bool or message.
+int LittleEndianBits(const FieldDescriptor* field) {
+  switch (field->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_INT32:
+    case FieldDescriptor::CPPTYPE_UINT32:
+    case FieldDescriptor::CPPTYPE_FLOAT:
+    case FieldDescriptor::CPPTYPE_ENUM:
+      return 32;
+    case FieldDescriptor::CPPTYPE_INT64:
+    case FieldDescriptor::CPPTYPE_UINT64:
+    case FieldDescriptor::CPPTYPE_DOUBLE:
+      return 64;
+    default:
+      return 0;
+  }
+}
+
+// Sets *min and *max to the range that the enum values or the min_value
+// and max_value options of |field| give its elements.  Returns false if
+// they give none narrower than what its type can hold.
+bool InferredRange(const FieldDescriptor* field, int64* min, int64* max) {
+  if (field->cpp_type() == FieldDescriptor::CPPTYPE_ENUM) {
+    const EnumDescriptor* enum_type = field->enum_type();
+    *min = *max = enum_type->value(0)->number();
+    for (int i = 1; i < enum_type->value_count(); i++) {
+      *min = std::min<int64>(*min, enum_type->value(i)->number());
+      *max = std::max<int64>(*max, enum_type->value(i)->number());
+    }
+    return true;
+  }
+
+  const FieldOptions& options = field->options();
+  if (!options.HasExtension(min_value) && !options.HasExtension(max_value)) {
+    return false;
+  }
+  switch (field->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_INT32:
+      *min = kint32min;
+      *max = kint32max;
+      break;
+    case FieldDescriptor::CPPTYPE_UINT32:
+      *min = 0;
+      *max = kuint32max;
+      break;
+    case FieldDescriptor::CPPTYPE_INT64:
+      *min = kint64min;
+      *max = kint64max;
+      break;
+    case FieldDescriptor::CPPTYPE_UINT64:
+      // The greatest uint64 does not fit the options.
+      if (!options.HasExtension(max_value)) return false;
+      *min = 0;
+      break;
+    default:
+      return false;
+  }
+  if (options.HasExtension(min_value)) *min = options.GetExtension(min_value);
+  if (options.HasExtension(max_value)) *max = options.GetExtension(max_value);
+  return true;
+}
+
+// Returns the width in bits of one element of |field| in the packed bits
+// encoding, other than a message, before narrowing to its range.
+int NaturalBitWidth(const FieldDescriptor* field) {
+  switch (field->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_BOOL:
+      return 1;
+    case FieldDescriptor::CPPTYPE_STRING:
+      return 8;
+    default:
+      return LittleEndianBits(field);
+  }
+}
+
+// Returns an expression for |value| as a literal of the C++ type of
+// |field|.
+string IntegerLiteral(const FieldDescriptor* field, int64 value) {
+  switch (field->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_UINT32:
+      return SimpleItoa(value) + "u";
+    case FieldDescriptor::CPPTYPE_INT64:
+      return "GOOGLE_LONGLONG(" + SimpleItoa(value) + ")";
+    case FieldDescriptor::CPPTYPE_UINT64:
+      return "GOOGLE_ULONGLONG(" + SimpleItoa(value) + ")";
+    default:
+      return SimpleItoa(value);
+  }
+}
+
+class RegisterFileGenerator {
+ public:
+  explicit RegisterFileGenerator(const FileDescriptor* file) : file_(file) {
+    for (int i = 0; i < file->message_type_count(); i++) {
+      ListMessages(file->message_type(i), &messages_);
+    }
+  }
+
+  // Computes the layouts of all the messages in the file.
+  bool Init(string* error) {
+    for (int i = 0; i < messages_.size(); i++) {
+      const RegisterLayout* layout = layouts_.GetLayout(messages_[i], error);
+      if (layout == NULL) return false;
+      layout_by_type_[messages_[i]] = layout;
+    }
+    return true;
+  }
+
+  void GenerateBsv(io::Printer* printer);
+  void GenerateHeader(io::Printer* printer);
+  void GenerateSource(io::Printer* printer);
+
+ private:
+  // Prints the BSV struct for |descriptor| after those of the types of its
+  // fields, since BSV wants types declared before use.
+  void GenerateBsvStruct(const Descriptor* descriptor,
+                         set<const Descriptor*>* printed,
+                         io::Printer* printer);
+  void GeneratePackField(const RegisterField& field, io::Printer* printer);
+  void GenerateUnpackField(const RegisterField& field, io::Printer* printer);
+  void GenerateWriteBitsField(const RegisterField& field,
+                              io::Printer* printer);
+
+  // Print the code packing or unpacking one element of |field|.  vars["index"]
+  // is the element's offset; vars["value"] the element to pack, and
+  // vars["set"] and vars["mutable"] the accessors to unpack it with.
+  void GeneratePackValue(const RegisterField& field,
+                         const map<string, string>& vars,
+                         io::Printer* printer);
+  void GenerateUnpackValue(const RegisterField& field,
+                           const map<string, string>& vars,
+                           io::Printer* printer);
+  // Likewise for the packed bits encoding, where vars["index"] is the
+  // element's bit offset.
+  void GenerateWriteBitsValue(const RegisterField& field,
+                              const map<string, string>& vars,
+                              io::Printer* printer);
+  void GenerateNamespaceOpeners(io::Printer* printer);
+  void GenerateNamespaceClosers(io::Printer* printer);
+
+  // Returns the files, other than this one, that define message types used
+  // by fields in this one.
+  vector<const FileDescriptor*> ForeignFiles();
+
+  const FileDescriptor* file_;
+  vector<const Descriptor*> messages_;
+  RegisterLayoutSet layouts_;
+  map<const Descriptor*, const RegisterLayout*> layout_by_type_;
+};
+
+vector<const FileDescriptor*> RegisterFileGenerator::ForeignFiles() {
+  vector<const FileDescriptor*> result;
+  set<const FileDescriptor*> seen;
+  for (int i = 0; i < messages_.size(); i++) {
+    const RegisterLayout* layout = layout_by_type_[messages_[i]];
+    for (int j = 0; j < layout->fields.size(); j++) {
+      if (layout->fields[j].message == NULL) continue;
+      const FileDescriptor* file = layout->fields[j].message->descriptor->file();
+      if (file != file_ && seen.insert(file).second) result.push_back(file);
+    }
+  }
+  return result;
+}
+
+void RegisterFileGenerator::GenerateBsv(io::Printer* printer) {
+  printer->Print(
+    "// Generated by the protocol buffer compiler.  DO NOT EDIT!\n"
+    "// source: $filename$\n"
+    "//\n"
+    "// Register encodings of the messages in the source file.  pack() of each\n"
+    "// struct gives the little-endian register image, so members are declared\n"
+    "// from the last field to the first.\n"
+    "\n",
+    "filename", file_->name());
+
+  vector<const FileDescriptor*> foreign_files = ForeignFiles();
+  bool uses_vector = false;
+  for (int i = 0; i < messages_.size(); i++) {
+    const RegisterLayout* layout = layout_by_type_[messages_[i]];
+    for (int j = 0; j < layout->fields.size(); j++) {
+      if (layout->fields[j].count_size > 0) uses_vector = true;
+    }
+  }
+  if (uses_vector) printer->Print("import Vector::*;\n");
+  for (int i = 0; i < foreign_files.size(); i++) {
+    printer->Print("import $package$::*;\n",
+                   "package", BsvPackageName(foreign_files[i]));
+  }
+  if (uses_vector || !foreign_files.empty()) printer->Print("\n");
+
+  set<const Descriptor*> printed;
+  for (int i = 0; i < messages_.size(); i++) {
+    GenerateBsvStruct(messages_[i], &printed, printer);
+  }
+}
+
+void RegisterFileGenerator::GenerateBsvStruct(const Descriptor* descriptor,
+                                              set<const Descriptor*>* printed,
+                                              io::Printer* printer) {
+  if (descriptor->file() != file_ || !printed->insert(descriptor).second) {
+    return;
+  }
+  const RegisterLayout* layout = layout_by_type_[descriptor];
+  for (int i = 0; i < layout->fields.size(); i++) {
+    if (layout->fields[i].message != NULL) {
+      GenerateBsvStruct(layout->fields[i].message->descriptor, printed,
+                        printer);
+    }
+  }
+
+  if (layout->fields.empty()) {
+    printer->Print("typedef Bit#(0) $name$;\n\n",
+                   "name", BsvTypeName(descriptor));
+    return;
+  }
+  printer->Print("typedef struct {\n");
+  for (int i = layout->fields.size() - 1; i >= 0; i--) {
+    const RegisterField& field = layout->fields[i];
+    if (field.count_size == 0) {
+      printer->Print("    $type$ $name$;\n",
+                     "type", BsvElementType(field),
+                     "name", BsvMemberName(field.field));
+      continue;
+    }
+    // The count precedes the elements, so is declared after them.
+    map<string, string> vars;
+    vars["type"] = BsvElementType(field);
+    vars["name"] = BsvMemberName(field.field);
+    vars["max_count"] = SimpleItoa(field.max_count);
+    vars["count_bits"] = SimpleItoa(8 * field.count_size);
+    vars["count"] = field.field->is_repeated() ? "count" : "length";
+    printer->Print(vars,
+      "    Vector#($max_count$, $type$) $name$;\n"
+      "    UInt#($count_bits$) $name$_$count$;\n");
+  }
+  printer->Print("} $name$ deriving (Bits, Eq);\n\n",
+                 "name", BsvTypeName(descriptor));
+}
+
+void RegisterFileGenerator::GenerateNamespaceOpeners(io::Printer* printer) {
+  vector<string> parts;
+  SplitStringUsing(file_->package(), ".", &parts);
+  for (int i = 0; i < parts.size(); i++) {
+    printer->Print("namespace $part$ {\n", "part", parts[i]);
+  }
+  if (!parts.empty()) printer->Print("\n");
+}
+
+void RegisterFileGenerator::GenerateNamespaceClosers(io::Printer* printer) {
+  vector<string> parts;
+  SplitStringUsing(file_->package(), ".", &parts);
+  for (int i = parts.size() - 1; i >= 0; i--) {
+    printer->Print("}  // namespace $part$\n", "part", parts[i]);
+  }
+}
+
+void RegisterFileGenerator::GenerateHeader(io::Printer* printer) {
+  string filename_identifier = cpp::FilenameIdentifier(file_->name());
+  printer->Print(
+    "// Generated by the protocol buffer compiler.  DO NOT EDIT!\n"
+    "// source: $filename$\n"
+    "//\n"
+    "// Register encodings of the messages in the source file.  Each message\n"
+    "// packs into a fixed number of bytes, with its fields in declaration\n"
+    "// order, integers little-endian, bools as one byte and messages inline.\n"
+    "// Repeated fields and strings are a count followed by room for as many\n"
+    "// elements as their bound allows.\n"
+    "//\n"
+    "// Each message also serializes to packed bits: the image of its struct in\n"
+    "// the BSV generator's JSON output, with every field as narrow as its range\n"
+    "// allows and the last field in the least significant bits.\n"
+    "\n"
+    "#ifndef PROTOBUF_$filename_identifier$_2eregs__INCLUDED\n"
+    "#define PROTOBUF_$filename_identifier$_2eregs__INCLUDED\n"
+    "\n"
+    "#include \"$basename$.pb.h\"\n",
+    "filename", file_->name(),
+    "filename_identifier", filename_identifier,
+    "basename", cpp::StripProto(file_->name()));
+
+  vector<const FileDescriptor*> foreign_files = ForeignFiles();
+  for (int i = 0; i < foreign_files.size(); i++) {
+    printer->Print("#include \"$basename$.regs.h\"\n",
+                   "basename", cpp::StripProto(foreign_files[i]->name()));
+  }
+  printer->Print("\n");
+  GenerateNamespaceOpeners(printer);
+
+  for (int i = 0; i < messages_.size(); i++) {
+    const RegisterLayout* layout = layout_by_type_[messages_[i]];
+    map<string, string> vars;
+    vars["full_name"] = messages_[i]->full_name();
+    vars["classname"] = cpp::ClassName(messages_[i], false);
+    vars["size"] = SimpleItoa(layout->size);
+    vars["size_name"] = PackedSizeName(messages_[i], false);
+    vars["pack"] = PackFunctionName(messages_[i], false);
+    vars["unpack"] = UnpackFunctionName(messages_[i], false);
+    vars["bits"] = SimpleItoa(layout->bits);
+    vars["bits_size"] = SimpleItoa((layout->bits + 7) / 8);
+
+    printer->Print(vars,
+      "// $full_name$: $size$ bytes, or $bits$ bits packed.\n");
+    if (!layout->fields.empty()) {
+      printer->Print("//   offset  size  field\n");
+    }
+    for (int j = 0; j < layout->fields.size(); j++) {
+      const RegisterField& field = layout->fields[j];
+      printer->Print("//   $offset$  $size$  $name$\n",
+                     "offset", StringPrintf("%6d", field.offset),
+                     "size", StringPrintf("%4d", field.size),
+                     "name", field.field->name());
+    }
+    printer->Print(vars,
+      "const int $size_name$ = $size$;\n"
+      "\n");
+    if (HasBoundedFields(layout)) {
+      printer->Print(vars,
+        "// Writes the $size$ bytes encoding |message| to |target|, returning a\n"
+        "// pointer just past them, or NULL if a repeated field holds more\n"
+        "// elements than its max_count or a string more bytes than its\n"
+        "// max_length, here or in a nested message.  |target| may be partly\n"
+        "// written when NULL is returned.\n");
+    } else {
+      printer->Print(vars,
+        "// Writes the $size$ bytes encoding |message| to |target|, returning a\n"
+        "// pointer just past them.\n");
+    }
+    printer->Print(vars,
+      "::google::protobuf::uint8* $pack$(\n"
+      "    const $classname$& message, ::google::protobuf::uint8* target);\n"
+      "\n"
+      "// Reads |message| from the $size$ bytes at |buffer|, returning a pointer\n"
+      "// just past them, or NULL if they do not encode a valid message.\n"
+      "const ::google::protobuf::uint8* $unpack$(\n"
+      "    const ::google::protobuf::uint8* buffer, $classname$* message);\n"
+      "\n"
+      "const int k$classname$PackedBits = $bits$;\n"
+      "const int k$classname$PackedBitsSize = $bits_size$;\n"
+      "\n"
+      "// Writes the $bits_size$ bytes holding the packed bits of |message| to\n"
+      "// |target|, returning a pointer just past them, or NULL if a field holds\n"
+      "// more elements than its bound or a value outside its range.\n"
+      "::google::protobuf::uint8* SerializeToPackedBits(\n"
+      "    const $classname$& message, ::google::protobuf::uint8* target);\n"
+      "\n"
+      "// Sets the $bits$ bits of |target| from |bit_offset| on, which must be\n"
+      "// zero, to the packed bits of |message|.  Returns false as above.\n"
+      "bool WritePackedBits(const $classname$& message, int bit_offset,\n"
+      "                     ::google::protobuf::uint8* target);\n"
+      "\n");
+  }
+
+  GenerateNamespaceClosers(printer);
+  printer->Print(
+    "\n"
+    "#endif  // PROTOBUF_$filename_identifier$_2eregs__INCLUDED\n",
+    "filename_identifier", filename_identifier);
+}
+
+void RegisterFileGenerator::GenerateSource(io::Printer* printer) {
+  printer->Print(
+    "// Generated by the protocol buffer compiler.  DO NOT EDIT!\n"
+    "// source: $filename$\n"
+    "\n"
+    "#include \"$basename$.regs.h\"\n"
+    "\n"
+    "#include <string.h>\n"
+    "\n"
+    "#include <google/protobuf/io/coded_stream.h>\n"
+    "#include <google/protobuf/wire_format_lite.h>\n"
+    "\n",
+    "filename", file_->name(),
+    "basename", cpp::StripProto(file_->name()));
+  GenerateNamespaceOpeners(printer);
+
+  bool uses_write_bits = false;
+  for (int i = 0; i < messages_.size(); i++) {
+    const RegisterLayout* layout = layout_by_type_[messages_[i]];
+    for (int j = 0; j < layout->fields.size(); j++) {
+      if (layout->fields[j].message == NULL ||
+          layout->fields[j].count_bits > 0) {
+        uses_write_bits = true;
+      }
+    }
+  }
+  if (uses_write_bits) {
+    printer->Print(
+      "namespace {\n"
+      "\n"
+      "// ORs the low |width| bits of |value| into |target| from bit |offset| on.\n"
+      "inline void WriteBits(::google::protobuf::uint64 value, int width,\n"
+      "                      int offset, ::google::protobuf::uint8* target) {\n"
+      "  if (width < 64) {\n"
+      "    value &= (static_cast< ::google::protobuf::uint64>(1) << width) - 1;\n"
+      "  }\n"
+      "  target += offset >> 3;\n"
+      "  offset &= 7;\n"
+      "  *target++ |= static_cast< ::google::protobuf::uint8>(value << offset);\n"
+      "  value >>= 8 - offset;\n"
+      "  for (width -= 8 - offset; width > 0; width -= 8) {\n"
+      "    *target++ |= static_cast< ::google::protobuf::uint8>(value);\n"
+      "    value >>= 8;\n"
+      "  }\n"
+      "}\n"
+      "\n"
+      "}  // namespace\n"
+      "\n");
+  }
+
+  for (int i = 0; i < messages_.size(); i++) {
+    const RegisterLayout* layout = layout_by_type_[messages_[i]];
+    map<string, string> vars;
+    vars["classname"] = cpp::ClassName(messages_[i], false);
+    vars["size"] = SimpleItoa(layout->size);
+    vars["pack"] = PackFunctionName(messages_[i], false);
+    vars["unpack"] = UnpackFunctionName(messages_[i], false);
+    // Messages without fields don't use their argument.
+    vars["message"] = layout->fields.empty() ? "/* message */" : "message";
+
+    bool uses_count = false;
+    bool uses_value32 = false;
+    bool uses_value64 = false;
+    for (int j = 0; j < layout->fields.size(); j++) {
+      if (layout->fields[j].count_size > 0) uses_count = true;
+      switch (LittleEndianBits(layout->fields[j].field)) {
+        case 32: uses_value32 = true; break;
+        case 64: uses_value64 = true; break;
+      }
+    }
+
+    printer->Print(vars,
+      "::google::protobuf::uint8* $pack$(\n"
+      "    const $classname$& $message$, ::google::protobuf::uint8* target) {\n");
+    printer->Indent();
+    if (uses_count) printer->Print("::google::protobuf::uint32 count;\n");
+    for (int j = 0; j < layout->fields.size(); j++) {
+      GeneratePackField(layout->fields[j], printer);
+    }
+    printer->Print(vars, "return target + $size$;\n");
+    printer->Outdent();
+    printer->Print("}\n\n");
+
+    printer->Print(vars,
+      "const ::google::protobuf::uint8* $unpack$(\n"
+      "    const ::google::protobuf::uint8* buffer, $classname$* $message$) {\n");
+    printer->Indent();
+    if (uses_count) printer->Print("::google::protobuf::uint32 count;\n");
+    if (uses_value32) printer->Print("::google::protobuf::uint32 value32;\n");
+    if (uses_value64) printer->Print("::google::protobuf::uint64 value64;\n");
+    for (int j = 0; j < layout->fields.size(); j++) {
+      GenerateUnpackField(layout->fields[j], printer);
+    }
+    printer->Print(vars, "return buffer + $size$;\n");
+    printer->Outdent();
+    printer->Print("}\n\n");
+
+    // Messages without fields don't use the other arguments either.
+    vars["bit_offset"] =
+        layout->fields.empty() ? "/* bit_offset */" : "bit_offset";
+    vars["target"] = layout->fields.empty() ? "/* target */" : "target";
+    printer->Print(vars,
+      "bool WritePackedBits(const $classname$& $message$, int $bit_offset$,\n"
+      "                     ::google::protobuf::uint8* $target$) {\n");
+    printer->Indent();
+    if (uses_count) printer->Print("::google::protobuf::uint32 count;\n");
+    for (int j = 0; j < layout->fields.size(); j++) {
+      GenerateWriteBitsField(layout->fields[j], printer);
+    }
+    printer->Print("return true;\n");
+    printer->Outdent();
+    printer->Print("}\n\n");
+
+    printer->Print(vars,
+      "::google::protobuf::uint8* SerializeToPackedBits(\n"
+      "    const $classname$& message, ::google::protobuf::uint8* target) {\n"
+      "  memset(target, 0, k$classname$PackedBitsSize);\n"
+      "  if (!WritePackedBits(message, 0, target)) return NULL;\n"
+      "  return target + k$classname$PackedBitsSize;\n"
+      "}\n"
+      "\n");
+  }
+
+  GenerateNamespaceClosers(printer);
+}
+
+// Sets vars["elements"] to the offset of the first element of |field|, and
+// vars["index"] to an expression for the offset of element i.
+void SetElementVars(const RegisterField& field,
+                    map<string, string>* vars) {
+  int elements = field.offset + field.count_size;
+  (*vars)["elements"] = SimpleItoa(elements);
+  (*vars)["element_size"] = SimpleItoa(field.element_size);
+  (*vars)["max_count"] = SimpleItoa(field.max_count);
+  (*vars)["index"] = field.element_size == 1 ?
+      StrCat(elements, " + i") :
+      StrCat(elements, " + ", field.element_size, " * i");
+}
+
+void RegisterFileGenerator::GeneratePackField(const RegisterField& field,
+                                              io::Printer* printer) {
+  map<string, string> vars;
+  vars["name"] = cpp::FieldName(field.field);
+  vars["offset"] = SimpleItoa(field.offset);
+
+  if (field.count_size == 0) {
+    vars["value"] = "message." + vars["name"] + "()";
+    vars["index"] = vars["offset"];
+    GeneratePackValue(field, vars, printer);
+    return;
+  }
+
+  // Fields with a count: check it against the bound, write it, then write
+  // the elements and zero the room left over.
+  SetElementVars(field, &vars);
+  if (field.field->is_repeated()) {
+    printer->Print(vars, "count = message.$name$_size();\n");
+  } else {
+    printer->Print(vars, "count = message.$name$().size();\n");
+  }
+  printer->Print(vars, "if (count > $max_count$) return NULL;\n");
+  switch (field.count_size) {
+    case 1:
+      printer->Print(vars,
+        "target[$offset$] = static_cast< ::google::protobuf::uint8>(count);\n");
+      break;
+    case 2:
+      vars["offset1"] = SimpleItoa(field.offset + 1);
+      printer->Print(vars,
+        "target[$offset$] = static_cast< ::google::protobuf::uint8>(count);\n"
+        "target[$offset1$] = static_cast< ::google::protobuf::uint8>(count >> 8);\n");
+      break;
+    case 4:
+      printer->Print(vars,
+        "::google::protobuf::io::CodedOutputStream::WriteLittleEndian32ToArray(\n"
+        "    count, target + $offset$);\n");
+      break;
+  }
+
+  if (field.field->is_repeated()) {
+    vars["value"] = "message." + vars["name"] + "(i)";
+    printer->Print("for (::google::protobuf::uint32 i = 0; i < count; i++) {\n");
+    printer->Indent();
+    GeneratePackValue(field, vars, printer);
+    printer->Outdent();
+    printer->Print("}\n");
+  } else {
+    printer->Print(vars,
+      "memcpy(target + $elements$, message.$name$().data(), count);\n");
+  }
+  if (field.element_size == 1) {
+    printer->Print(vars,
+      "memset(target + $elements$ + count, 0, $max_count$ - count);\n");
+  } else {
+    printer->Print(vars,
+      "memset(target + $elements$ + $element_size$ * count, 0,\n"
+      "       $element_size$ * ($max_count$ - count));\n");
+  }
+}
+
+void RegisterFileGenerator::GeneratePackValue(
+    const RegisterField& field, const map<string, string>& vars,
+    io::Printer* printer) {
+  switch (field.field->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_INT32:
+    case FieldDescriptor::CPPTYPE_ENUM:
+      printer->Print(vars,
+        "::google::protobuf::io::CodedOutputStream::WriteLittleEndian32ToArray(\n"
+        "    static_cast< ::google::protobuf::uint32>($value$),"
+        " target + $index$);\n");
+      break;
+    case FieldDescriptor::CPPTYPE_UINT32:
+      printer->Print(vars,
+        "::google::protobuf::io::CodedOutputStream::WriteLittleEndian32ToArray(\n"
+        "    $value$, target + $index$);\n");
+      break;
+    case FieldDescriptor::CPPTYPE_FLOAT:
+      printer->Print(vars,
+        "::google::protobuf::io::CodedOutputStream::WriteLittleEndian32ToArray(\n"
+        "    ::google::protobuf::internal::WireFormatLite::EncodeFloat($value$),\n"
+        "    target + $index$);\n");
+      break;
+    case FieldDescriptor::CPPTYPE_INT64:
+      printer->Print(vars,
+        "::google::protobuf::io::CodedOutputStream::WriteLittleEndian64ToArray(\n"
+        "    static_cast< ::google::protobuf::uint64>($value$),"
+        " target + $index$);\n");
+      break;
+    case FieldDescriptor::CPPTYPE_UINT64:
+      printer->Print(vars,
+        "::google::protobuf::io::CodedOutputStream::WriteLittleEndian64ToArray(\n"
+        "    $value$, target + $index$);\n");
+      break;
+    case FieldDescriptor::CPPTYPE_DOUBLE:
+      printer->Print(vars,
+        "::google::protobuf::io::CodedOutputStream::WriteLittleEndian64ToArray(\n"
+        "    ::google::protobuf::internal::WireFormatLite::EncodeDouble($value$),\n"
+        "    target + $index$);\n");
+      break;
+    case FieldDescriptor::CPPTYPE_BOOL:
+      printer->Print(vars,
+        "target[$index$] = $value$ ? 1 : 0;\n");
+      break;
+    case FieldDescriptor::CPPTYPE_MESSAGE: {
+      map<string, string> message_vars(vars);
+      message_vars["pack"] = PackFunctionName(field.field->message_type(), true);
+      printer->Print(message_vars,
+        "if ($pack$($value$, target + $index$) == NULL) return NULL;\n");
+      break;
+    }
+    case FieldDescriptor::CPPTYPE_STRING:
+      GOOGLE_LOG(FATAL) << "Can't get here.";
+      break;
+  }
+}
+
+void RegisterFileGenerator::GenerateUnpackField(const RegisterField& field,
+                                                io::Printer* printer) {
+  map<string, string> vars;
+  vars["name"] = cpp::FieldName(field.field);
+  vars["offset"] = SimpleItoa(field.offset);
+
+  if (field.count_size == 0) {
+    vars["index"] = vars["offset"];
+    vars["set"] = "set_" + vars["name"];
+    vars["mutable"] = "mutable_" + vars["name"];
+    GenerateUnpackValue(field, vars, printer);
+    return;
+  }
+
+  SetElementVars(field, &vars);
+  switch (field.count_size) {
+    case 1:
+      printer->Print(vars, "count = buffer[$offset$];\n");
+      break;
+    case 2:
+      vars["offset1"] = SimpleItoa(field.offset + 1);
+      printer->Print(vars,
+        "count = buffer[$offset$] |\n"
+        "    static_cast< ::google::protobuf::uint32>(buffer[$offset1$]) << 8;\n");
+      break;
+    case 4:
+      printer->Print(vars,
+        "::google::protobuf::io::CodedInputStream::ReadLittleEndian32FromArray(\n"
+        "    buffer + $offset$, &count);\n");
+      break;
+  }
+  printer->Print(vars, "if (count > $max_count$) return NULL;\n");
+
+  if (field.field->is_repeated()) {
+    vars["set"] = "add_" + vars["name"];
+    vars["mutable"] = "add_" + vars["name"];
+    printer->Print(vars,
+      "message->clear_$name$();\n"
+      "for (::google::protobuf::uint32 i = 0; i < count; i++) {\n");
+    printer->Indent();
+    GenerateUnpackValue(field, vars, printer);
+    printer->Outdent();
+    printer->Print("}\n");
+  } else {
+    printer->Print(vars,
+      "message->set_$name$(\n"
+      "    reinterpret_cast<const char*>(buffer + $elements$), count);\n");
+  }
+}
+
+void RegisterFileGenerator::GenerateUnpackValue(
+    const RegisterField& field, const map<string, string>& vars,
+    io::Printer* printer) {
+  switch (LittleEndianBits(field.field)) {
+    case 32:
+      printer->Print(vars,
+        "::google::protobuf::io::CodedInputStream::ReadLittleEndian32FromArray(\n"
+        "    buffer + $index$, &value32);\n");
+      break;
+    case 64:
+      printer->Print(vars,
+        "::google::protobuf::io::CodedInputStream::ReadLittleEndian64FromArray(\n"
+        "    buffer + $index$, &value64);\n");
+      break;
+  }
+
+  switch (field.field->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_INT32:
+      printer->Print(vars,
+        "message->$set$(static_cast< ::google::protobuf::int32>(value32));\n");
+      break;
+    case FieldDescriptor::CPPTYPE_UINT32:
+      printer->Print(vars, "message->$set$(value32);\n");
+      break;
+    case FieldDescriptor::CPPTYPE_FLOAT:
+      printer->Print(vars,
+        "message->$set$(\n"
+        "    ::google::protobuf::internal::WireFormatLite::DecodeFloat(value32));\n");
+      break;
+    case FieldDescriptor::CPPTYPE_INT64:
+      printer->Print(vars,
+        "message->$set$(static_cast< ::google::protobuf::int64>(value64));\n");
+      break;
+    case FieldDescriptor::CPPTYPE_UINT64:
+      printer->Print(vars, "message->$set$(value64);\n");
+      break;
+    case FieldDescriptor::CPPTYPE_DOUBLE:
+      printer->Print(vars,
+        "message->$set$(\n"
+        "    ::google::protobuf::internal::WireFormatLite::DecodeDouble(value64));\n");
+      break;
+    case FieldDescriptor::CPPTYPE_ENUM: {
+      map<string, string> enum_vars(vars);
+      enum_vars["type"] = cpp::ClassName(field.field->enum_type(), true);
+      if (!cpp::HasPreservingUnknownEnumSemantics(field.field->file())) {
+        printer->Print(enum_vars,
+          "if (!$type$_IsValid(static_cast<int>(value32))) {\n"
+          "  return NULL;\n"
+          "}\n");
+      }
+      printer->Print(enum_vars,
+        "message->$set$(static_cast< $type$ >(value32));\n");
+      break;
+    }
+    case FieldDescriptor::CPPTYPE_BOOL:
+      printer->Print(vars,
+        "if (buffer[$index$] > 1) return NULL;\n"
+        "message->$set$(buffer[$index$] != 0);\n");
+      break;
+    case FieldDescriptor::CPPTYPE_MESSAGE: {
+      map<string, string> message_vars(vars);
+      message_vars["unpack"] =
+          UnpackFunctionName(field.field->message_type(), true);
+      printer->Print(message_vars,
+        "if ($unpack$(buffer + $index$, message->$mutable$()) == NULL) {\n"
+        "  return NULL;\n"
+        "}\n");
+      break;
+    }
+    case FieldDescriptor::CPPTYPE_STRING:
+      GOOGLE_LOG(FATAL) << "Can't get here.";
+      break;
+  }
+}
+
+// Returns an expression for the bit offset |offset| past the start of the
+// message being written.
+string BitIndex(int offset) {
+  return offset == 0 ? "bit_offset" : StrCat("bit_offset + ", offset);
+}
+
+void RegisterFileGenerator::GenerateWriteBitsField(const RegisterField& field,
+                                                   io::Printer* printer) {
+  map<string, string> vars;
+  vars["name"] = cpp::FieldName(field.field);
+
+  if (field.count_bits == 0) {
+    vars["value"] = "message." + vars["name"] + "()";
+    vars["index"] = BitIndex(field.bit_offset);
+    GenerateWriteBitsValue(field, vars, printer);
+    return;
+  }
+
+  // The elements are below the count, the first least significant, and
+  // the room past the count is left zero.
+  vars["max_count"] = SimpleItoa(field.max_count);
+  vars["element_bits"] = SimpleItoa(field.element_bits);
+  vars["count_bits"] = SimpleItoa(field.count_bits);
+  vars["count_index"] =
+      BitIndex(field.bit_offset + field.max_count * field.element_bits);
+  vars["index"] = field.element_bits == 1 ?
+      BitIndex(field.bit_offset) + " + i" :
+      BitIndex(field.bit_offset) + " + " + vars["element_bits"] + " * i";
+  if (field.field->is_repeated()) {
+    printer->Print(vars, "count = message.$name$_size();\n");
+  } else {
+    printer->Print(vars, "count = message.$name$().size();\n");
+  }
+  printer->Print(vars,
+    "if (count > $max_count$) return false;\n"
+    "WriteBits(count, $count_bits$, $count_index$, target);\n");
+  if (field.field->is_repeated()) {
+    vars["value"] = "message." + vars["name"] + "(i)";
+    printer->Print("for (::google::protobuf::uint32 i = 0; i < count; i++) {\n");
+    printer->Indent();
+    GenerateWriteBitsValue(field, vars, printer);
+    printer->Outdent();
+    printer->Print("}\n");
+  } else {
+    printer->Print(vars,
+      "for (::google::protobuf::uint32 i = 0; i < count; i++) {\n"
+      "  WriteBits(static_cast< ::google::protobuf::uint8>(message.$name$()[i]),"
+      " 8,\n"
+      "            $index$, target);\n"
+      "}\n");
+  }
+}
+
+void RegisterFileGenerator::GenerateWriteBitsValue(
+    const RegisterField& field, const map<string, string>& vars,
+    io::Printer* printer) {
+  map<string, string> value_vars(vars);
+  value_vars["width"] = SimpleItoa(field.element_bits);
+
+  // Values are checked against the min_value and max_value options whether
+  // or not these narrow the field, and enum values against the range of the
+  // enum if that narrows it.  The bounds of the type itself need no check.
+  int64 min = 0;
+  int64 max = 0;
+  bool check_min = false;
+  bool check_max = false;
+  if (field.field->cpp_type() == FieldDescriptor::CPPTYPE_ENUM) {
+    check_min = check_max = InferredBitWidth(field.field) > 0 &&
+                            InferredRange(field.field, &min, &max);
+  } else {
+    int64 type_min = 0;
+    int64 type_max = kint64max;
+    switch (field.field->cpp_type()) {
+      case FieldDescriptor::CPPTYPE_INT32:
+        type_min = kint32min;
+        type_max = kint32max;
+        break;
+      case FieldDescriptor::CPPTYPE_UINT32:
+        type_max = kuint32max;
+        break;
+      case FieldDescriptor::CPPTYPE_INT64:
+        type_min = kint64min;
+        break;
+      default:
+        // A uint64 goes past any max_value the options can hold.
+        break;
+    }
+    const FieldOptions& options = field.field->options();
+    if (options.HasExtension(min_value)) {
+      min = options.GetExtension(min_value);
+      check_min = min > type_min;
+    }
+    if (options.HasExtension(max_value)) {
+      max = options.GetExtension(max_value);
+      check_max = max < type_max ||
+                  field.field->cpp_type() == FieldDescriptor::CPPTYPE_UINT64;
+    }
+  }
+
+  vector<string> checks;
+  if (check_min) {
+    checks.push_back(vars.find("value")->second + " < " +
+                     IntegerLiteral(field.field, min));
+  }
+  if (check_max) {
+    checks.push_back(vars.find("value")->second + " > " +
+                     IntegerLiteral(field.field, max));
+  }
+  if (checks.size() == 1) {
+    printer->Print("if ($check$) return false;\n", "check", checks[0]);
+  } else if (checks.size() == 2) {
+    printer->Print("if ($check$ ||\n"
+                   "    $check2$) {\n"
+                   "  return false;\n"
+                   "}\n",
+                   "check", checks[0], "check2", checks[1]);
+  }
+
+  switch (field.field->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_INT32:
+    case FieldDescriptor::CPPTYPE_INT64:
+    case FieldDescriptor::CPPTYPE_ENUM:
+      printer->Print(value_vars,
+        "WriteBits(static_cast< ::google::protobuf::uint64>($value$), $width$,\n"
+        "          $index$, target);\n");
+      break;
+    case FieldDescriptor::CPPTYPE_UINT32:
+    case FieldDescriptor::CPPTYPE_UINT64:
+      printer->Print(value_vars,
+        "WriteBits($value$, $width$, $index$, target);\n");
+      break;
+    case FieldDescriptor::CPPTYPE_FLOAT:
+      printer->Print(value_vars,
+        "WriteBits(::google::protobuf::internal::WireFormatLite::EncodeFloat(\n"
+        "              $value$),\n"
+        "          32, $index$, target);\n");
+      break;
+    case FieldDescriptor::CPPTYPE_DOUBLE:
+      printer->Print(value_vars,
+        "WriteBits(::google::protobuf::internal::WireFormatLite::EncodeDouble(\n"
+        "              $value$),\n"
+        "          64, $index$, target);\n");
+      break;
+    case FieldDescriptor::CPPTYPE_BOOL:
+      printer->Print(value_vars,
+        "WriteBits($value$ ? 1 : 0, 1, $index$, target);\n");
+      break;
+    case FieldDescriptor::CPPTYPE_MESSAGE:
+      value_vars["write"] = cpp::QualifiedFileLevelSymbol(
+          field.field->message_type()->file()->package(), "WritePackedBits");
+      printer->Print(value_vars,
+        "if (!$write$($value$, $index$, target)) return false;\n");
+      break;
+    case FieldDescriptor::CPPTYPE_STRING:
+      GOOGLE_LOG(FATAL) << "Can't get here.";
+      break;
+  }
+}
+
+}  // namespace
+
+string BsvTypeName(const Descriptor* descriptor) {
+  string name = cpp::ClassName(descriptor, false);
+  if ('a' <= name[0] && name[0] <= 'z') name[0] += 'A' - 'a';
+  return name;
+}
+
+string BsvPackageName(const FileDescriptor* file) {
+  string name = cpp::StripProto(file->name());
+  StripString(&name, "-", '_');
+  StripString(&name, ".", '/');
+  return name.substr(name.rfind('/') + 1) + "_pb";
+}
+
+void ListMessages(const Descriptor* descriptor,
+                  vector<const Descriptor*>* output) {
+  output->push_back(descriptor);
+  for (int i = 0; i < descriptor->nested_type_count(); i++) {
+    ListMessages(descriptor->nested_type(i), output);
+  }
+}
+
+string PackFunctionName(const Descriptor* descriptor, bool qualified) {
+  string name = "Pack" + cpp::ClassName(descriptor, false);
+  return qualified ?
+      cpp::QualifiedFileLevelSymbol(descriptor->file()->package(), name) :
+      name;
+}
+
+string UnpackFunctionName(const Descriptor* descriptor, bool qualified) {
+  string name = "Unpack" + cpp::ClassName(descriptor, false);
+  return qualified ?
+      cpp::QualifiedFileLevelSymbol(descriptor->file()->package(), name) :
+      name;
+}
+
+string PackedSizeName(const Descriptor* descriptor, bool qualified) {
+  string name = "k" + cpp::ClassName(descriptor, false) + "PackedSize";
+  return qualified ?
+      cpp::QualifiedFileLevelSymbol(descriptor->file()->package(), name) :
+      name;
+}
+
+uint32 FieldSizeBound(const FieldDescriptor* field) {
+  if (field->is_repeated()) {
+    return field->options().GetExtension(max_count);
+  } else if (field->cpp_type() == FieldDescriptor::CPPTYPE_STRING) {
+    return field->options().GetExtension(max_length);
+  } else {
+    return 0;
+  }
+}
+
+int CountSize(int bound) {
+  if (bound <= 0xff) {
+    return 1;
+  } else if (bound <= 0xffff) {
+    return 2;
+  } else {
+    return 4;
+  }
+}
+
+int CountBitWidth(int64 bound) {
+  return RangeBitWidth(0, bound);
+}
+
+int RangeBitWidth(int64 min, int64 max) {
+  int width = 1;
+  if (min >= 0) {
+    while (width < 64 && (static_cast<uint64>(max) >> width) != 0) width++;
+  } else {
+    while (width < 64 && (min < -(GOOGLE_LONGLONG(1) << (width - 1)) ||
+                          max > (GOOGLE_LONGLONG(1) << (width - 1)) - 1)) {
+      width++;
+    }
+  }
+  return width;
+}
+
+int InferredBitWidth(const FieldDescriptor* field) {
+  int64 min, max;
+  if (!InferredRange(field, &min, &max)) return 0;
+  int width = RangeBitWidth(min, max);
+  return width < NaturalBitWidth(field) ? width : 0;
+}
+
+RegisterLayoutSet::RegisterLayoutSet() {}
+
+RegisterLayoutSet::~RegisterLayoutSet() {
+  STLDeleteValues(&layouts_);
+}
+
+const RegisterLayout* RegisterLayoutSet::GetLayout(const Descriptor* descriptor,
+                                                   string* error) {
+  map<const Descriptor*, RegisterLayout*>::iterator iter =
+      layouts_.find(descriptor);
+  if (iter != layouts_.end()) {
+    if (iter->second == NULL) {
+      *error = descriptor->full_name() +
+               ": Recursive messages have no register encoding.";
+    }
+    return iter->second;
+  }
+
+  layouts_[descriptor] = NULL;
+  google::protobuf::scoped_ptr<RegisterLayout> layout(new RegisterLayout);
+  layout->descriptor = descriptor;
+  layout->size = 0;
+  layout->bits = 0;
+
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    const FieldDescriptor* field = descriptor->field(i);
+    RegisterField entry;
+    entry.field = field;
+    entry.offset = layout->size;
+    entry.max_count = 0;
+    entry.count_size = 0;
+    entry.message = NULL;
+    entry.bit_offset = 0;
+    entry.count_bits = 0;
+    if (!GetFieldLayout(field, &entry, error)) {
+      layouts_.erase(descriptor);
+      return NULL;
+    }
+    if (entry.size > kint32max - layout->size ||
+        entry.bits > kint32max - layout->bits) {
+      *error = descriptor->full_name() +
+               ": Message is too large for a register encoding.";
+      layouts_.erase(descriptor);
+      return NULL;
+    }
+    layout->fields.push_back(entry);
+    layout->size += entry.size;
+    layout->bits += entry.bits;
+  }
+
+  // In the packed bits encoding the last field is the least significant.
+  int bit_offset = 0;
+  for (int i = layout->fields.size() - 1; i >= 0; i--) {
+    layout->fields[i].bit_offset = bit_offset;
+    bit_offset += layout->fields[i].bits;
+  }
+
+  return layouts_[descriptor] = layout.release();
+}
+
+bool RegisterLayoutSet::GetFieldLayout(const FieldDescriptor* field,
+                                       RegisterField* entry, string* error) {
+  const FieldOptions& options = field->options();
+  if (options.HasExtension(max_count) && !field->is_repeated()) {
+    *error = field->full_name() +
+             ": max_count only applies to repeated fields.";
+    return false;
+  }
+  if (options.HasExtension(max_length) &&
+      field->cpp_type() != FieldDescriptor::CPPTYPE_STRING) {
+    *error = field->full_name() +
+             ": max_length only applies to string and bytes fields.";
+    return false;
+  }
+
+  if (options.HasExtension(min_value) || options.HasExtension(max_value)) {
+    int64 type_min, type_max;
+    switch (field->cpp_type()) {
+      case FieldDescriptor::CPPTYPE_INT32:
+        type_min = kint32min;
+        type_max = kint32max;
+        break;
+      case FieldDescriptor::CPPTYPE_UINT32:
+        type_min = 0;
+        type_max = kuint32max;
+        break;
+      case FieldDescriptor::CPPTYPE_INT64:
+        type_min = kint64min;
+        type_max = kint64max;
+        break;
+      case FieldDescriptor::CPPTYPE_UINT64:
+        type_min = 0;
+        type_max = kint64max;
+        break;
+      default:
+        *error = field->full_name() +
+                 ": min_value and max_value only apply to integer fields.";
+        return false;
+    }
+    int64 min = options.HasExtension(min_value) ?
+        options.GetExtension(min_value) : type_min;
+    int64 max = options.HasExtension(max_value) ?
+        options.GetExtension(max_value) : type_max;
+    if (min < type_min || min > type_max || max < type_min ||
+        max > type_max) {
+      *error = field->full_name() +
+               ": min_value and max_value must be values of the field's type.";
+      return false;
+    }
+    if (min > max) {
+      *error = field->full_name() + ": min_value is greater than max_value.";
+      return false;
+    }
+  }
+
+  // Proto3 fields outside of oneofs are always present, as far as the
+  // encoding is concerned; missing proto2 fields could not be represented.
+  if (!field->is_repeated() && !field->is_required() &&
+      (cpp::HasFieldPresence(field->file()) ||
+       field->containing_oneof() != NULL)) {
+    *error = field->full_name() +
+             ": Only required fields have a register encoding.";
+    return false;
+  }
+
+  switch (field->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_INT32:
+    case FieldDescriptor::CPPTYPE_UINT32:
+    case FieldDescriptor::CPPTYPE_FLOAT:
+    case FieldDescriptor::CPPTYPE_ENUM:
+      entry->element_size = 4;
+      break;
+    case FieldDescriptor::CPPTYPE_INT64:
+    case FieldDescriptor::CPPTYPE_UINT64:
+    case FieldDescriptor::CPPTYPE_DOUBLE:
+      entry->element_size = 8;
+      break;
+    case FieldDescriptor::CPPTYPE_BOOL:
+      entry->element_size = 1;
+      break;
+    case FieldDescriptor::CPPTYPE_STRING:
+      if (field->is_repeated()) {
+        *error = field->full_name() +
+                 ": Repeated strings and bytes have no register encoding.";
+        return false;
+      }
+      entry->element_size = 1;
+      break;
+    case FieldDescriptor::CPPTYPE_MESSAGE:
+      entry->message = GetLayout(field->message_type(), error);
+      if (entry->message == NULL) return false;
+      entry->element_size = entry->message->size;
+      break;
+  }
+  if (entry->message != NULL) {
+    entry->element_bits = entry->message->bits;
+  } else {
+    entry->element_bits = InferredBitWidth(field);
+    if (entry->element_bits == 0) entry->element_bits = NaturalBitWidth(field);
+  }
+
+  if (!field->is_repeated() &&
+      field->cpp_type() != FieldDescriptor::CPPTYPE_STRING) {
+    entry->size = entry->element_size;
+    entry->bits = entry->element_bits;
+    return true;
+  }
+
+  int64 bound = FieldSizeBound(field);
+  if (bound == 0) {
+    *error = field->full_name() +
+             (field->is_repeated() ?
+              ": Repeated fields need a max_count to have a register "
+              "encoding." :
+              ": Strings and bytes need a max_length to have a register "
+              "encoding.");
+    return false;
+  }
+  if (bound > kint32max) {
+    *error = field->full_name() +
+             (field->is_repeated() ? ": max_count" : ": max_length") +
+             " must be at most " + SimpleItoa(kint32max) + ".";
+    return false;
+  }
+  int64 size = CountSize(bound) + bound * entry->element_size;
+  int64 bits = CountBitWidth(bound) + bound * entry->element_bits;
+  if (size > kint32max || bits > kint32max) {
+    *error = field->full_name() +
+             ": Field is too large for a register encoding.";
+    return false;
+  }
+  entry->max_count = bound;
+  entry->count_size = CountSize(bound);
+  entry->size = size;
+  entry->count_bits = CountBitWidth(bound);
+  entry->bits = bits;
+  return true;
+}
+
+bool GenerateRegisterFiles(const FileDescriptor* file,
+                           const string& bsv_filename,
+                           GeneratorContext* context, string* error) {
+  RegisterFileGenerator generator(file);
+  if (!generator.Init(error)) return false;
+
+  string basename = cpp::StripProto(file->name());
+  {
+    google::protobuf::scoped_ptr<io::ZeroCopyOutputStream> output(
+        context->Open(bsv_filename));
+    io::Printer printer(output.get(), '$');
+    generator.GenerateBsv(&printer);
+  }
+  {
+    google::protobuf::scoped_ptr<io::ZeroCopyOutputStream> output(
+        context->Open(basename + ".regs.h"));
+    io::Printer printer(output.get(), '$');
+    generator.GenerateHeader(&printer);
+  }
+  {
+    google::protobuf::scoped_ptr<io::ZeroCopyOutputStream> output(
+        context->Open(basename + ".regs.cc"));
+    io::Printer printer(output.get(), '$');
+    generator.GenerateSource(&printer);
+  }
+  return true;
+}
+
+}  // namespace bsv
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
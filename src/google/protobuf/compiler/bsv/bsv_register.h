@@ -0,0 +1,190 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Computes the "register" encoding of messages for software-to-hardware
+// links, and generates the BSV structs and C++ pack/unpack functions that
+// implement it.
+//
+// The register encoding of a message is a fixed number of bytes with no tags:
+// fields appear in declaration order, integers are little-endian and as wide
+// as their protobuf type, bools take one byte and message fields are packed
+// inline.  Repeated fields and strings need a size bound, given by the options
+// in bsv_options.proto; they are encoded as a count followed by room for as
+// many elements as the bound allows, zeroed past the count.  The count takes
+// the fewest of one, two or four bytes that can hold the bound.  Only
+// messages whose every field is always present or bounded can be encoded
+// this way.
+//
+// The same messages also have a "packed bits" encoding, which is the image
+// BSV's pack() gives of the message's struct in the generator's JSON output,
+// as little-endian bytes.  Each field is as narrow as its values allow:
+// enums take the fewest bits holding all their numbers, integers with the
+// min_value and max_value options the fewest holding that range (in two's
+// complement if it includes negative numbers), bools one bit, and counts the
+// fewest bits holding their bound.  The last field is the least significant
+// and the elements of a bounded field are stored from the least significant
+// up, below its count.
+
+#ifndef GOOGLE_PROTOBUF_COMPILER_BSV_REGISTER_H__
+#define GOOGLE_PROTOBUF_COMPILER_BSV_REGISTER_H__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+
+class Descriptor;
+class FieldDescriptor;
+class FileDescriptor;
+
+namespace compiler {
+
+class GeneratorContext;
+
+namespace bsv {
+
+struct RegisterLayout;
+
+// The position of one field within a RegisterLayout.
+struct RegisterField {
+  const FieldDescriptor* field;
+  int offset;  // In bytes, from the start of the containing message.
+  int size;    // In bytes, including any count.
+
+  // For repeated fields, the most elements the field may hold, and for
+  // strings and bytes, the most bytes.  Zero for other fields.
+  int max_count;
+  // The size of the count preceding the elements, or zero if there is none.
+  int count_size;
+  // The size of one element, or of the whole field if it has no count.
+  int element_size;
+
+  // The layout of the field's type, if it is a message; otherwise NULL.
+  const RegisterLayout* message;
+
+  // The same for the packed bits encoding, in bits: the offset of the
+  // field from the least significant bit of the containing message, the
+  // width of the whole field, of its count and of one element.
+  int bit_offset;
+  int bits;
+  int count_bits;
+  int element_bits;
+};
+
+// The register encoding of one message type.
+struct RegisterLayout {
+  const Descriptor* descriptor;
+  int size;  // In bytes.
+  int bits;  // In the packed bits encoding.
+  vector<RegisterField> fields;
+};
+
+// Computes and owns the layouts of message types.
+class RegisterLayoutSet {
+ public:
+  RegisterLayoutSet();
+  ~RegisterLayoutSet();
+
+  // Returns the layout of |descriptor|, computing it and the layouts of any
+  // message types it contains as necessary.  Returns NULL and sets *error
+  // if |descriptor| cannot be given a register encoding.
+  const RegisterLayout* GetLayout(const Descriptor* descriptor, string* error);
+
+ private:
+  // Fills in the size fields of |entry| for |field|.
+  bool GetFieldLayout(const FieldDescriptor* field, RegisterField* entry,
+                      string* error);
+
+  // Layouts by type.  A NULL value marks a type whose layout is being
+  // computed, which catches recursive types.
+  map<const Descriptor*, RegisterLayout*> layouts_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(RegisterLayoutSet);
+};
+
+// Return the names of the pack and unpack functions and the packed size
+// constant that "foo.regs.h" declares for |descriptor|, qualified with the
+// namespace of its package if |qualified|.
+string PackFunctionName(const Descriptor* descriptor, bool qualified);
+string UnpackFunctionName(const Descriptor* descriptor, bool qualified);
+string PackedSizeName(const Descriptor* descriptor, bool qualified);
+
+// Returns the size bound given to |field| by the max_count or max_length
+// option, whichever applies to its type, or zero if it has none.  The
+// register encoding only allows bounds up to kint32max.
+uint32 FieldSizeBound(const FieldDescriptor* field);
+
+// Returns the size in bytes of the count of a field bounded by |bound|.
+int CountSize(int bound);
+
+// Returns the width in bits of the count of a field bounded by |bound| in
+// the packed bits encoding.
+int CountBitWidth(int64 bound);
+
+// Returns the fewest bits, and at least one, that hold every number from
+// |min| to |max|, in two's complement if |min| is negative.
+int RangeBitWidth(int64 min, int64 max);
+
+// Returns the width in bits that the enum values or the min_value and
+// max_value options of |field| allow one of its elements, if that is
+// narrower than its type; otherwise zero.
+int InferredBitWidth(const FieldDescriptor* field);
+
+// Returns the name of the BSV struct for |descriptor|.  BSV type names must
+// start with an upper-case letter.
+string BsvTypeName(const Descriptor* descriptor);
+
+// Returns the name of the BSV package holding the register structs of
+// |file|.  Matches the name the generator gives its output files.
+string BsvPackageName(const FileDescriptor* file);
+
+// Appends |descriptor| and all types nested in it to |output|.
+void ListMessages(const Descriptor* descriptor,
+                  vector<const Descriptor*>* output);
+
+// Writes the register encoding of every message in |file|: a BSV package of
+// struct declarations, named like the generator's JSON output but ending in
+// ".bsv", and C++ pack/unpack functions in "foo.regs.h" and "foo.regs.cc"
+// next to the C++ generator's "foo.pb.h".  Returns false and sets *error if
+// some message in |file| cannot be given a register encoding.
+bool GenerateRegisterFiles(const FileDescriptor* file,
+                           const string& bsv_filename,
+                           GeneratorContext* context, string* error);
+
+}  // namespace bsv
+}  // namespace compiler
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_COMPILER_BSV_REGISTER_H__
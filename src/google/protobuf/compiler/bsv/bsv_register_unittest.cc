@@ -0,0 +1,809 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <memory>
+#ifndef _SHARED_PTR_H
+#include <google/protobuf/stubs/shared_ptr.h>
+#endif
+#include <string.h>
+
+#include <google/protobuf/compiler/bsv/bsv_generator.h>
+#include <google/protobuf/compiler/bsv/bsv_register.h>
+#include <google/protobuf/compiler/bsv/bsv_register_unittest.pb.h>
+#include <google/protobuf/compiler/bsv/bsv_register_unittest.regs.h>
+#include <google/protobuf/compiler/command_line_interface.h>
+#include <google/protobuf/compiler/parser.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/io/tokenizer.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/util/message_differencer.h>
+#include <google/protobuf/wire_format_lite.h>
+
+#include <google/protobuf/stubs/strutil.h>
+#include <google/protobuf/testing/file.h>
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace compiler {
+namespace bsv {
+namespace {
+
+using internal::WireFormatLite;
+
+void SetAllFields(protobuf_unittest::RegisterAllTypes* message) {
+  message->set_int32_value(-101);
+  message->set_int64_value(-102);
+  message->set_uint32_value(103);
+  message->set_uint64_value(GOOGLE_ULONGLONG(0xfedcba9876543210));
+  message->set_sint32_value(-105);
+  message->set_sint64_value(-106);
+  message->set_fixed32_value(107);
+  message->set_fixed64_value(108);
+  message->set_sfixed32_value(-109);
+  message->set_sfixed64_value(-110);
+  message->set_float_value(111.5);
+  message->set_double_value(-112.25);
+  message->set_bool_value(true);
+  message->set_color(protobuf_unittest::REGISTER_BLUE);
+  message->mutable_point()->set_x(-113);
+  message->mutable_point()->set_y(114);
+  message->mutable_empty();
+}
+
+// Writes |value| to |target| as |size| little-endian bytes.
+void PutLittleEndian(uint64 value, int size, string* target, int offset) {
+  for (int i = 0; i < size; i++) {
+    (*target)[offset + i] = static_cast<char>(value >> (8 * i));
+  }
+}
+
+TEST(RegisterEncodingTest, PackedSizes) {
+  EXPECT_EQ(8, protobuf_unittest::kRegisterPointPackedSize);
+  EXPECT_EQ(0, protobuf_unittest::kRegisterAllTypes_NestedEmptyPackedSize);
+  EXPECT_EQ(85, protobuf_unittest::kRegisterAllTypesPackedSize);
+}
+
+TEST(RegisterEncodingTest, PackMatchesLayout) {
+  protobuf_unittest::RegisterAllTypes message;
+  SetAllFields(&message);
+
+  // The layout documented in bsv_register.h: fields in declaration order, no
+  // padding, integers little-endian.
+  string expected(85, '\0');
+  PutLittleEndian(static_cast<uint32>(-101), 4, &expected, 0);
+  PutLittleEndian(static_cast<uint64>(-102), 8, &expected, 4);
+  PutLittleEndian(103, 4, &expected, 12);
+  PutLittleEndian(GOOGLE_ULONGLONG(0xfedcba9876543210), 8, &expected, 16);
+  PutLittleEndian(static_cast<uint32>(-105), 4, &expected, 24);
+  PutLittleEndian(static_cast<uint64>(-106), 8, &expected, 28);
+  PutLittleEndian(107, 4, &expected, 36);
+  PutLittleEndian(108, 8, &expected, 40);
+  PutLittleEndian(static_cast<uint32>(-109), 4, &expected, 48);
+  PutLittleEndian(static_cast<uint64>(-110), 8, &expected, 52);
+  PutLittleEndian(WireFormatLite::EncodeFloat(111.5), 4, &expected, 60);
+  PutLittleEndian(WireFormatLite::EncodeDouble(-112.25), 8, &expected, 64);
+  PutLittleEndian(1, 1, &expected, 72);
+  PutLittleEndian(2, 4, &expected, 73);
+  PutLittleEndian(static_cast<uint32>(-113), 4, &expected, 77);
+  PutLittleEndian(114, 4, &expected, 81);
+
+  uint8 buffer[86];
+  buffer[85] = 0xaa;
+  EXPECT_EQ(buffer + 85,
+            protobuf_unittest::PackRegisterAllTypes(message, buffer));
+  EXPECT_EQ(expected, string(reinterpret_cast<char*>(buffer), 85));
+  EXPECT_EQ(0xaa, buffer[85]);
+}
+
+TEST(RegisterEncodingTest, RoundTrip) {
+  protobuf_unittest::RegisterAllTypes message;
+  SetAllFields(&message);
+  uint8 buffer[85];
+  protobuf_unittest::PackRegisterAllTypes(message, buffer);
+
+  protobuf_unittest::RegisterAllTypes unpacked;
+  EXPECT_EQ(buffer + 85,
+            protobuf_unittest::UnpackRegisterAllTypes(buffer, &unpacked));
+  EXPECT_TRUE(util::MessageDifferencer::Equals(message, unpacked));
+  EXPECT_TRUE(unpacked.IsInitialized());
+
+  // Unset fields pack as their defaults.
+  protobuf_unittest::RegisterAllTypes empty;
+  protobuf_unittest::PackRegisterAllTypes(empty, buffer);
+  EXPECT_TRUE(protobuf_unittest::UnpackRegisterAllTypes(buffer, &unpacked));
+  EXPECT_EQ(0, unpacked.int32_value());
+  EXPECT_FALSE(unpacked.bool_value());
+  EXPECT_EQ(0, unpacked.point().x());
+}
+
+TEST(RegisterEncodingTest, Bounded) {
+  // values: 1 + 4 * 4, name: 1 + 6, points: 2 + 300 * 8, flags: 1 + 2,
+  // data: 1 + 3, colors: 1 + 4.
+  EXPECT_EQ(2438, protobuf_unittest::kRegisterBoundedPackedSize);
+
+  protobuf_unittest::RegisterBounded message;
+  message.add_values(1);
+  message.add_values(-2);
+  message.set_name("abc");
+  message.add_points()->set_x(3);
+  message.mutable_points(0)->set_y(-4);
+  message.add_flags(true);
+  message.add_flags(false);
+  message.set_data(string("\0\1\2", 3));
+
+  string expected(2438, '\0');
+  PutLittleEndian(2, 1, &expected, 0);
+  PutLittleEndian(1, 4, &expected, 1);
+  PutLittleEndian(static_cast<uint32>(-2), 4, &expected, 5);
+  PutLittleEndian(3, 1, &expected, 17);
+  expected.replace(18, 3, "abc");
+  PutLittleEndian(1, 2, &expected, 24);
+  PutLittleEndian(3, 4, &expected, 26);
+  PutLittleEndian(static_cast<uint32>(-4), 4, &expected, 30);
+  PutLittleEndian(2, 1, &expected, 2426);
+  PutLittleEndian(1, 1, &expected, 2427);
+  PutLittleEndian(3, 1, &expected, 2429);
+  expected.replace(2430, 3, string("\0\1\2", 3));
+
+  // Room past each count is zeroed even if the buffer was not.
+  uint8 buffer[2438];
+  memset(buffer, 0xff, sizeof(buffer));
+  EXPECT_EQ(buffer + 2438,
+            protobuf_unittest::PackRegisterBounded(message, buffer));
+  EXPECT_EQ(expected, string(reinterpret_cast<char*>(buffer), 2438));
+
+  protobuf_unittest::RegisterBounded unpacked;
+  unpacked.add_values(5);
+  EXPECT_EQ(buffer + 2438,
+            protobuf_unittest::UnpackRegisterBounded(buffer, &unpacked));
+  EXPECT_TRUE(util::MessageDifferencer::Equals(message, unpacked));
+}
+
+TEST(RegisterEncodingTest, PackRejectsUnboundedValues) {
+  protobuf_unittest::RegisterBounded message;
+  uint8 buffer[2438];
+
+  for (int i = 0; i < 4; i++) message.add_values(i);
+  EXPECT_TRUE(protobuf_unittest::PackRegisterBounded(message, buffer) != NULL);
+  message.add_values(4);
+  EXPECT_TRUE(protobuf_unittest::PackRegisterBounded(message, buffer) == NULL);
+
+  message.clear_values();
+  message.set_name("abcdefg");
+  EXPECT_TRUE(protobuf_unittest::PackRegisterBounded(message, buffer) == NULL);
+}
+
+TEST(RegisterEncodingTest, UnpackRejectsUnboundedValues) {
+  protobuf_unittest::RegisterBounded message;
+  uint8 buffer[2438];
+  protobuf_unittest::PackRegisterBounded(message, buffer);
+  protobuf_unittest::RegisterBounded unpacked;
+
+  buffer[0] = 5;  // values count
+  EXPECT_TRUE(
+      protobuf_unittest::UnpackRegisterBounded(buffer, &unpacked) == NULL);
+  buffer[0] = 0;
+
+  buffer[24] = 0x2d;  // points count: 301
+  buffer[25] = 0x01;
+  EXPECT_TRUE(
+      protobuf_unittest::UnpackRegisterBounded(buffer, &unpacked) == NULL);
+}
+
+TEST(RegisterEncodingTest, UnpackRejectsInvalidValues) {
+  protobuf_unittest::RegisterAllTypes message;
+  SetAllFields(&message);
+  uint8 buffer[85];
+  protobuf_unittest::RegisterAllTypes unpacked;
+
+  protobuf_unittest::PackRegisterAllTypes(message, buffer);
+  buffer[72] = 2;  // bool_value
+  EXPECT_TRUE(
+      protobuf_unittest::UnpackRegisterAllTypes(buffer, &unpacked) == NULL);
+
+  protobuf_unittest::PackRegisterAllTypes(message, buffer);
+  buffer[73] = 3;  // color
+  EXPECT_TRUE(
+      protobuf_unittest::UnpackRegisterAllTypes(buffer, &unpacked) == NULL);
+}
+
+// -------------------------------------------------------------------
+
+// Sets |width| bits of |target| from bit |offset| on to the low bits of
+// |value|.
+void PutBits(uint64 value, int width, int offset, string* target) {
+  for (int i = 0; i < width; i++) {
+    char mask = static_cast<char>(1 << ((offset + i) % 8));
+    if ((value >> i) & 1) {
+      (*target)[(offset + i) / 8] |= mask;
+    } else {
+      (*target)[(offset + i) / 8] &= ~mask;
+    }
+  }
+}
+
+void SetNarrowFields(protobuf_unittest::RegisterNarrow* message) {
+  message->set_color(protobuf_unittest::REGISTER_BLUE);
+  message->set_sign(protobuf_unittest::REGISTER_NEGATIVE);
+  message->set_level(-3);
+  message->set_percent(99);
+  message->set_flag(true);
+  message->add_nibbles(1);
+  message->add_nibbles(15);
+  message->mutable_point()->set_x(-5);
+  message->mutable_point()->set_y(6);
+}
+
+TEST(PackedBitsTest, Sizes) {
+  // The fields of RegisterAllTypes are as wide as their types, but for the
+  // bool and the enum.
+  EXPECT_EQ(5 * 32 + 5 * 64 + 32 + 64 + 1 + 2 + 64,
+            protobuf_unittest::kRegisterAllTypesPackedBits);
+  EXPECT_EQ(81, protobuf_unittest::kRegisterAllTypesPackedBitsSize);
+  EXPECT_EQ(0, protobuf_unittest::kRegisterAllTypes_NestedEmptyPackedBits);
+  EXPECT_EQ(0, protobuf_unittest::kRegisterAllTypes_NestedEmptyPackedBitsSize);
+  EXPECT_EQ(94, protobuf_unittest::kRegisterNarrowPackedBits);
+  EXPECT_EQ(12, protobuf_unittest::kRegisterNarrowPackedBitsSize);
+}
+
+TEST(PackedBitsTest, MatchesLayout) {
+  protobuf_unittest::RegisterNarrow message;
+  SetNarrowFields(&message);
+
+  // The last field is the least significant; the elements of nibbles are
+  // below its count.
+  string expected(12, '\0');
+  PutBits(6, 32, 0, &expected);                       // point.y
+  PutBits(static_cast<uint32>(-5), 32, 32, &expected);  // point.x
+  PutBits(1, 4, 64, &expected);                       // nibbles
+  PutBits(15, 4, 68, &expected);
+  PutBits(2, 2, 76, &expected);                       // nibbles count
+  PutBits(1, 1, 78, &expected);                       // flag
+  PutBits(99, 7, 79, &expected);                      // percent
+  PutBits(static_cast<uint64>(-3), 4, 86, &expected);   // level
+  PutBits(static_cast<uint64>(-1), 2, 90, &expected);   // sign
+  PutBits(2, 2, 92, &expected);                       // color
+
+  // The buffer is cleared first, and nothing past it is written.
+  uint8 buffer[13];
+  memset(buffer, 0xff, sizeof(buffer));
+  EXPECT_EQ(buffer + 12,
+            protobuf_unittest::SerializeToPackedBits(message, buffer));
+  EXPECT_EQ(expected, string(reinterpret_cast<char*>(buffer), 12));
+  EXPECT_EQ(0xff, buffer[12]);
+}
+
+TEST(PackedBitsTest, Bounded) {
+  // values: 3 + 4 * 32, name: 3 + 6 * 8, points: 9 + 300 * 64, flags: 2 + 2,
+  // data: 2 + 3 * 8, colors: 1 + 2.
+  EXPECT_EQ(19424, protobuf_unittest::kRegisterBoundedPackedBits);
+
+  protobuf_unittest::RegisterBounded message;
+  message.add_flags(true);
+  message.set_data("\x81");
+  message.add_colors(protobuf_unittest::REGISTER_GREEN);
+
+  string expected(2428, '\0');
+  PutBits(1, 2, 0, &expected);     // colors
+  PutBits(1, 1, 2, &expected);     // colors count
+  PutBits(0x81, 8, 3, &expected);  // data
+  PutBits(1, 2, 27, &expected);    // data length
+  PutBits(1, 1, 29, &expected);    // flags
+  PutBits(1, 2, 31, &expected);    // flags count
+
+  uint8 buffer[2428];
+  EXPECT_EQ(buffer + 2428,
+            protobuf_unittest::SerializeToPackedBits(message, buffer));
+  EXPECT_EQ(expected, string(reinterpret_cast<char*>(buffer), 2428));
+
+  message.add_colors(protobuf_unittest::REGISTER_RED);
+  EXPECT_TRUE(
+      protobuf_unittest::SerializeToPackedBits(message, buffer) == NULL);
+}
+
+TEST(PackedBitsTest, RejectsValuesOutOfRange) {
+  protobuf_unittest::RegisterNarrow message;
+  uint8 buffer[12];
+  SetNarrowFields(&message);
+  ASSERT_TRUE(
+      protobuf_unittest::SerializeToPackedBits(message, buffer) != NULL);
+
+  message.set_level(8);
+  EXPECT_TRUE(
+      protobuf_unittest::SerializeToPackedBits(message, buffer) == NULL);
+  message.set_level(-9);
+  EXPECT_TRUE(
+      protobuf_unittest::SerializeToPackedBits(message, buffer) == NULL);
+  message.set_level(-8);
+  EXPECT_TRUE(
+      protobuf_unittest::SerializeToPackedBits(message, buffer) != NULL);
+
+  message.set_percent(101);
+  EXPECT_TRUE(
+      protobuf_unittest::SerializeToPackedBits(message, buffer) == NULL);
+  message.set_percent(100);
+
+  message.set_nibbles(0, 0);
+  EXPECT_TRUE(
+      protobuf_unittest::SerializeToPackedBits(message, buffer) == NULL);
+  message.set_nibbles(0, 16);
+  EXPECT_TRUE(
+      protobuf_unittest::SerializeToPackedBits(message, buffer) == NULL);
+  message.set_nibbles(0, 1);
+
+  message.add_nibbles(2);
+  message.add_nibbles(3);
+  EXPECT_TRUE(
+      protobuf_unittest::SerializeToPackedBits(message, buffer) == NULL);
+}
+
+TEST(PackedBitsTest, RejectsValuesOutOfUnnarrowedRange) {
+  EXPECT_EQ(32 + 32 + 64, protobuf_unittest::kRegisterRangedPackedBits);
+
+  protobuf_unittest::RegisterRanged message;
+  uint8 buffer[16];
+  message.set_below(kint32min);
+  message.set_above(kuint32max);
+  message.set_large(kuint64max);
+  ASSERT_TRUE(
+      protobuf_unittest::SerializeToPackedBits(message, buffer) != NULL);
+
+  message.set_below(101);
+  EXPECT_TRUE(
+      protobuf_unittest::SerializeToPackedBits(message, buffer) == NULL);
+  message.set_below(100);
+
+  message.set_above(4);
+  EXPECT_TRUE(
+      protobuf_unittest::SerializeToPackedBits(message, buffer) == NULL);
+  message.set_above(5);
+
+  message.set_large(999);
+  EXPECT_TRUE(
+      protobuf_unittest::SerializeToPackedBits(message, buffer) == NULL);
+  message.set_large(1000);
+  EXPECT_TRUE(
+      protobuf_unittest::SerializeToPackedBits(message, buffer) != NULL);
+}
+
+TEST(PackedBitsTest, RangeBitWidth) {
+  EXPECT_EQ(1, RangeBitWidth(0, 0));
+  EXPECT_EQ(1, RangeBitWidth(0, 1));
+  EXPECT_EQ(2, RangeBitWidth(0, 2));
+  EXPECT_EQ(8, RangeBitWidth(0, 255));
+  EXPECT_EQ(9, RangeBitWidth(0, 256));
+  EXPECT_EQ(1, RangeBitWidth(-1, 0));
+  EXPECT_EQ(2, RangeBitWidth(-2, 1));
+  EXPECT_EQ(3, RangeBitWidth(-2, 2));
+  EXPECT_EQ(8, RangeBitWidth(-128, 127));
+  EXPECT_EQ(64, RangeBitWidth(kint64min, kint64max));
+  EXPECT_EQ(63, RangeBitWidth(0, kint64max));
+}
+
+// -------------------------------------------------------------------
+
+class RegisterLayoutTest : public testing::Test {
+ protected:
+  // foo.proto may import bsv_options.proto from the generated pool.
+  RegisterLayoutTest() : pool_(DescriptorPool::generated_pool()) {}
+
+  // Parses |text| as foo.proto and returns the layout of message Foo, or
+  // NULL with the error in error_.
+  const RegisterLayout* GetLayout(const char* text) {
+    io::ArrayInputStream input(text, strlen(text));
+    io::Tokenizer tokenizer(&input, NULL);
+    Parser parser;
+    FileDescriptorProto proto;
+    GOOGLE_CHECK(parser.Parse(&tokenizer, &proto));
+    proto.set_name("foo.proto");
+    const FileDescriptor* file = pool_.BuildFile(proto);
+    GOOGLE_CHECK(file != NULL);
+    return layouts_.GetLayout(file->FindMessageTypeByName("Foo"), &error_);
+  }
+
+  DescriptorPool pool_;
+  RegisterLayoutSet layouts_;
+  string error_;
+};
+
+TEST_F(RegisterLayoutTest, Offsets) {
+  const RegisterLayout* layout = GetLayout(
+      "syntax = \"proto2\";"
+      "message Bar { required bool a = 1; required double b = 2; }"
+      "message Foo { required Bar bar = 1; required int32 c = 2; }");
+  ASSERT_TRUE(layout != NULL) << error_;
+  EXPECT_EQ(13, layout->size);
+  ASSERT_EQ(2, layout->fields.size());
+  EXPECT_EQ(0, layout->fields[0].offset);
+  EXPECT_EQ(9, layout->fields[0].size);
+  ASSERT_TRUE(layout->fields[0].message != NULL);
+  EXPECT_EQ("Bar", layout->fields[0].message->descriptor->name());
+  EXPECT_EQ(9, layout->fields[1].offset);
+  EXPECT_EQ(4, layout->fields[1].size);
+  EXPECT_TRUE(layout->fields[1].message == NULL);
+}
+
+TEST_F(RegisterLayoutTest, Proto3FieldsAreAlwaysPresent) {
+  const RegisterLayout* layout = GetLayout(
+      "syntax = \"proto3\";"
+      "message Foo { int64 a = 1; uint32 b = 2; }");
+  ASSERT_TRUE(layout != NULL) << error_;
+  EXPECT_EQ(12, layout->size);
+}
+
+TEST_F(RegisterLayoutTest, OptionalField) {
+  EXPECT_TRUE(GetLayout(
+      "syntax = \"proto2\";"
+      "message Foo { optional int32 a = 1; }") == NULL);
+  EXPECT_EQ("Foo.a: Only required fields have a register encoding.", error_);
+}
+
+TEST_F(RegisterLayoutTest, Oneof) {
+  EXPECT_TRUE(GetLayout(
+      "syntax = \"proto3\";"
+      "message Foo { oneof o { int32 a = 1; } }") == NULL);
+  EXPECT_EQ("Foo.a: Only required fields have a register encoding.", error_);
+}
+
+TEST_F(RegisterLayoutTest, RepeatedField) {
+  EXPECT_TRUE(GetLayout(
+      "syntax = \"proto2\";"
+      "message Foo { repeated int32 a = 1; }") == NULL);
+  EXPECT_EQ("Foo.a: Repeated fields need a max_count to have a register "
+            "encoding.", error_);
+}
+
+TEST_F(RegisterLayoutTest, StringField) {
+  EXPECT_TRUE(GetLayout(
+      "syntax = \"proto2\";"
+      "message Foo { required bytes a = 1; }") == NULL);
+  EXPECT_EQ("Foo.a: Strings and bytes need a max_length to have a register "
+            "encoding.", error_);
+}
+
+TEST_F(RegisterLayoutTest, BoundedFields) {
+  const RegisterLayout* layout = GetLayout(
+      "syntax = \"proto2\";"
+      "import \"google/protobuf/compiler/bsv/bsv_options.proto\";"
+      "message Foo {"
+      "  repeated double a = 1 [(google.protobuf.compiler.bsv.max_count) = 255];"
+      "  required string b = 2"
+      "      [(google.protobuf.compiler.bsv.max_length) = 256];"
+      "  repeated bool c = 3"
+      "      [(google.protobuf.compiler.bsv.max_count) = 65536];"
+      "}");
+  ASSERT_TRUE(layout != NULL) << error_;
+  ASSERT_EQ(3, layout->fields.size());
+  EXPECT_EQ(1, layout->fields[0].count_size);
+  EXPECT_EQ(255, layout->fields[0].max_count);
+  EXPECT_EQ(8, layout->fields[0].element_size);
+  EXPECT_EQ(1 + 255 * 8, layout->fields[0].size);
+  EXPECT_EQ(2, layout->fields[1].count_size);
+  EXPECT_EQ(1, layout->fields[1].element_size);
+  EXPECT_EQ(2 + 256, layout->fields[1].size);
+  EXPECT_EQ(4, layout->fields[2].count_size);
+  EXPECT_EQ(4 + 65536, layout->fields[2].size);
+  EXPECT_EQ(1 + 255 * 8 + 2 + 256 + 4 + 65536, layout->size);
+}
+
+TEST_F(RegisterLayoutTest, CountTooLarge) {
+  // The options are uint32, but counts and sizes are ints.
+  EXPECT_TRUE(GetLayout(
+      "syntax = \"proto2\";"
+      "import \"google/protobuf/compiler/bsv/bsv_options.proto\";"
+      "message Foo {"
+      "  repeated bool a = 1"
+      "      [(google.protobuf.compiler.bsv.max_count) = 2147483648];"
+      "}") == NULL);
+  EXPECT_EQ("Foo.a: max_count must be at most 2147483647.", error_);
+}
+
+TEST_F(RegisterLayoutTest, LengthTooLarge) {
+  EXPECT_TRUE(GetLayout(
+      "syntax = \"proto2\";"
+      "import \"google/protobuf/compiler/bsv/bsv_options.proto\";"
+      "message Foo {"
+      "  required bytes a = 1"
+      "      [(google.protobuf.compiler.bsv.max_length) = 4294967295];"
+      "}") == NULL);
+  EXPECT_EQ("Foo.a: max_length must be at most 2147483647.", error_);
+}
+
+TEST_F(RegisterLayoutTest, MisplacedCount) {
+  EXPECT_TRUE(GetLayout(
+      "syntax = \"proto2\";"
+      "import \"google/protobuf/compiler/bsv/bsv_options.proto\";"
+      "message Foo {"
+      "  required string a = 1 [(google.protobuf.compiler.bsv.max_count) = 2];"
+      "}") == NULL);
+  EXPECT_EQ("Foo.a: max_count only applies to repeated fields.", error_);
+}
+
+TEST_F(RegisterLayoutTest, MisplacedLength) {
+  EXPECT_TRUE(GetLayout(
+      "syntax = \"proto2\";"
+      "import \"google/protobuf/compiler/bsv/bsv_options.proto\";"
+      "message Foo {"
+      "  repeated int32 a = 1 [(google.protobuf.compiler.bsv.max_length) = 2];"
+      "}") == NULL);
+  EXPECT_EQ("Foo.a: max_length only applies to string and bytes fields.",
+            error_);
+}
+
+TEST_F(RegisterLayoutTest, RepeatedString) {
+  EXPECT_TRUE(GetLayout(
+      "syntax = \"proto2\";"
+      "import \"google/protobuf/compiler/bsv/bsv_options.proto\";"
+      "message Foo {"
+      "  repeated string a = 1 [(google.protobuf.compiler.bsv.max_count) = 2,"
+      "                         (google.protobuf.compiler.bsv.max_length) = 2];"
+      "}") == NULL);
+  EXPECT_EQ("Foo.a: Repeated strings and bytes have no register encoding.",
+            error_);
+}
+
+TEST_F(RegisterLayoutTest, RecursiveMessage) {
+  EXPECT_TRUE(GetLayout(
+      "syntax = \"proto2\";"
+      "message Foo { required Bar bar = 1; }"
+      "message Bar { required Foo foo = 1; }") == NULL);
+  EXPECT_EQ("Foo: Recursive messages have no register encoding.", error_);
+}
+
+TEST_F(RegisterLayoutTest, BitWidths) {
+  const RegisterLayout* layout = GetLayout(
+      "syntax = \"proto2\";"
+      "import \"google/protobuf/compiler/bsv/bsv_options.proto\";"
+      "enum Big { SMALL = 0; LARGE = 2147483647; }"
+      "message Foo {"
+      "  required uint64 a = 1 [(google.protobuf.compiler.bsv.max_value) = 1000];"
+      "  required int32 b = 2 [(google.protobuf.compiler.bsv.min_value) = 0];"
+      "  required sint64 c = 3 [(google.protobuf.compiler.bsv.min_value) = -5,"
+      "                         (google.protobuf.compiler.bsv.max_value) = 5];"
+      "  required Big d = 4;"
+      "  repeated bool e = 5 [(google.protobuf.compiler.bsv.max_count) = 7];"
+      "}");
+  ASSERT_TRUE(layout != NULL) << error_;
+  ASSERT_EQ(5, layout->fields.size());
+  EXPECT_EQ(10, layout->fields[0].bits);
+  EXPECT_EQ(31, layout->fields[1].bits);
+  EXPECT_EQ(4, layout->fields[2].bits);
+  EXPECT_EQ(31, layout->fields[3].bits);
+  EXPECT_EQ(3, layout->fields[4].count_bits);
+  EXPECT_EQ(1, layout->fields[4].element_bits);
+  EXPECT_EQ(3 + 7, layout->fields[4].bits);
+  EXPECT_EQ(10 + 31 + 4 + 31 + 10, layout->bits);
+
+  // The last field is the least significant.
+  EXPECT_EQ(0, layout->fields[4].bit_offset);
+  EXPECT_EQ(10, layout->fields[3].bit_offset);
+  EXPECT_EQ(10 + 31 + 4 + 31, layout->fields[0].bit_offset);
+
+  // The register encoding keeps the full widths.
+  EXPECT_EQ(8 + 4 + 8 + 4 + 1 + 7, layout->size);
+}
+
+TEST_F(RegisterLayoutTest, MisplacedRange) {
+  EXPECT_TRUE(GetLayout(
+      "syntax = \"proto2\";"
+      "import \"google/protobuf/compiler/bsv/bsv_options.proto\";"
+      "message Foo {"
+      "  required float a = 1 [(google.protobuf.compiler.bsv.max_value) = 2];"
+      "}") == NULL);
+  EXPECT_EQ("Foo.a: min_value and max_value only apply to integer fields.",
+            error_);
+}
+
+TEST_F(RegisterLayoutTest, RangeOutsideType) {
+  EXPECT_TRUE(GetLayout(
+      "syntax = \"proto2\";"
+      "import \"google/protobuf/compiler/bsv/bsv_options.proto\";"
+      "message Foo {"
+      "  required uint32 a = 1 [(google.protobuf.compiler.bsv.min_value) = -1];"
+      "}") == NULL);
+  EXPECT_EQ("Foo.a: min_value and max_value must be values of the field's "
+            "type.", error_);
+}
+
+TEST_F(RegisterLayoutTest, EmptyRange) {
+  EXPECT_TRUE(GetLayout(
+      "syntax = \"proto2\";"
+      "import \"google/protobuf/compiler/bsv/bsv_options.proto\";"
+      "message Foo {"
+      "  required int32 a = 1 [(google.protobuf.compiler.bsv.min_value) = 3,"
+      "                        (google.protobuf.compiler.bsv.max_value) = 2];"
+      "}") == NULL);
+  EXPECT_EQ("Foo.a: min_value is greater than max_value.", error_);
+}
+
+// -------------------------------------------------------------------
+
+TEST(RegisterGeneratorTest, BsvStructs) {
+  GOOGLE_CHECK_OK(File::SetContents(TestTempDir() + "/register.proto",
+                             "syntax = \"proto2\";\n"
+                             "message Point {\n"
+                             "  required int32 x = 1;\n"
+                             "  required bool type = 2;\n"
+                             "}\n"
+                             "message Line {\n"
+                             "  message Empty {}\n"
+                             "  required Point start = 1;\n"
+                             "  required double Length = 2;\n"
+                             "  required Empty end = 3;\n"
+                             "}\n",
+                             true));
+
+  CommandLineInterface cli;
+  cli.SetInputsAreProtoPathRelative(true);
+  Generator bsv_generator;
+  cli.RegisterGenerator("--bsv_out", &bsv_generator, "");
+
+  string proto_path = "-I" + TestTempDir();
+  string bsv_out = "--bsv_out=register:" + TestTempDir();
+  const char* argv[] = {
+    "protoc",
+    proto_path.c_str(),
+    bsv_out.c_str(),
+    "register.proto"
+  };
+  ASSERT_EQ(0, cli.Run(4, argv));
+
+  string bsv;
+  GOOGLE_CHECK_OK(File::GetContents(TestTempDir() + "/register_pb.bsv", &bsv,
+                             true));
+  EXPECT_TRUE(HasSuffixString(bsv,
+      "typedef struct {\n"
+      "    UInt#(8) type_;\n"
+      "    Int#(32) x;\n"
+      "} Point deriving (Bits, Eq);\n"
+      "\n"
+      "typedef Bit#(0) Line_Empty;\n"
+      "\n"
+      "typedef struct {\n"
+      "    Line_Empty end_;\n"
+      "    Bit#(64) length;\n"
+      "    Point start;\n"
+      "} Line deriving (Bits, Eq);\n"
+      "\n")) << bsv;
+  EXPECT_TRUE(File::Exists(TestTempDir() + "/register.regs.h"));
+  EXPECT_TRUE(File::Exists(TestTempDir() + "/register.regs.cc"));
+}
+
+TEST(RegisterGeneratorTest, PackDocumentsBoundFailures) {
+  GOOGLE_CHECK_OK(File::SetContents(TestTempDir() + "/bounded.proto",
+      "syntax = \"proto2\";\n"
+      "import \"google/protobuf/compiler/bsv/bsv_options.proto\";\n"
+      "message Plain {\n"
+      "  required int32 x = 1;\n"
+      "}\n"
+      "message Inner {\n"
+      "  repeated int32 v = 1 [(google.protobuf.compiler.bsv.max_count) = 2];\n"
+      "}\n"
+      "message Outer {\n"
+      "  required Inner inner = 1;\n"
+      "}\n",
+      true));
+
+  CommandLineInterface cli;
+  cli.SetInputsAreProtoPathRelative(true);
+  Generator bsv_generator;
+  cli.RegisterGenerator("--bsv_out", &bsv_generator, "");
+
+  string proto_path = "-I" + TestTempDir();
+  string source_path = "-I" + TestSourceDir();
+  string bsv_out = "--bsv_out=register:" + TestTempDir();
+  const char* argv[] = {
+    "protoc",
+    proto_path.c_str(),
+    source_path.c_str(),
+    bsv_out.c_str(),
+    "bounded.proto"
+  };
+  ASSERT_EQ(0, cli.Run(5, argv));
+
+  string header;
+  GOOGLE_CHECK_OK(File::GetContents(TestTempDir() + "/bounded.regs.h",
+                             &header, true));
+  const char kPlain[] =
+      "// Writes the 4 bytes encoding |message| to |target|, returning a\n"
+      "// pointer just past them.\n"
+      "::google::protobuf::uint8* PackPlain(";
+  const char kBounded[] =
+      "// pointer just past them, or NULL if a repeated field holds more\n";
+  EXPECT_TRUE(header.find(kPlain) != string::npos) << header;
+  string::size_type inner = header.find("PackInner(");
+  string::size_type outer = header.find("PackOuter(");
+  ASSERT_NE(string::npos, inner) << header;
+  ASSERT_NE(string::npos, outer) << header;
+  // Both Inner and its container Outer can fail.
+  string::size_type first = header.find(kBounded);
+  ASSERT_NE(string::npos, first) << header;
+  EXPECT_LT(first, inner);
+  string::size_type second = header.find(kBounded, first + 1);
+  ASSERT_NE(string::npos, second) << header;
+  EXPECT_LT(inner, second);
+  EXPECT_LT(second, outer);
+}
+
+TEST(RegisterGeneratorTest, JsonBitWidths) {
+  GOOGLE_CHECK_OK(File::SetContents(TestTempDir() + "/narrow.proto",
+      "syntax = \"proto2\";\n"
+      "import \"google/protobuf/compiler/bsv/bsv_options.proto\";\n"
+      "enum Sign { NEGATIVE = -1; POSITIVE = 1; }\n"
+      "message Narrow {\n"
+      "  required Sign sign = 1;\n"
+      "  required int32 level = 2 [(google.protobuf.compiler.bsv.min_value) = -8,\n"
+      "                            (google.protobuf.compiler.bsv.max_value) = 7];\n"
+      "  repeated uint32 words = 3 [(google.protobuf.compiler.bsv.max_count) = 5];\n"
+      "}\n",
+      true));
+
+  CommandLineInterface cli;
+  cli.SetInputsAreProtoPathRelative(true);
+  Generator bsv_generator;
+  cli.RegisterGenerator("--bsv_out", &bsv_generator, "");
+
+  string proto_path = "-I" + TestTempDir();
+  string source_path = "-I" + TestSourceDir();
+  string bsv_out = "--bsv_out=" + TestTempDir();
+  const char* argv[] = {
+    "protoc",
+    proto_path.c_str(),
+    source_path.c_str(),
+    bsv_out.c_str(),
+    "narrow.proto"
+  };
+  ASSERT_EQ(0, cli.Run(5, argv));
+
+  string json;
+  GOOGLE_CHECK_OK(File::GetContents(TestTempDir() + "/narrow_pb.json", &json,
+                             true));
+  EXPECT_TRUE(json.find(
+      "{ \"pname\": \"sign\", \"ptype\": "
+      "{ \"name\": \"Bit\", \"params\": [ { \"name\": \"2\" } ] } }") !=
+      string::npos) << json;
+  EXPECT_TRUE(json.find(
+      "{ \"pname\": \"level\", \"ptype\": "
+      "{ \"name\": \"Bit\", \"params\": [ { \"name\": \"4\" } ] } }") !=
+      string::npos) << json;
+  EXPECT_TRUE(json.find(
+      "{ \"pname\": \"words_count\", \"ptype\": "
+      "{ \"name\": \"Bit\", \"params\": [ { \"name\": \"3\" } ] } }") !=
+      string::npos) << json;
+}
+
+}  // namespace
+}  // namespace bsv
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,989 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/compiler/bsv/bsv_wire.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#ifndef _SHARED_PTR_H
+#include <google/protobuf/stubs/shared_ptr.h>
+#endif
+#include <set>
+#include <vector>
+
+#include <google/protobuf/compiler/bsv/bsv_register.h>
+#include <google/protobuf/compiler/code_generator.h>
+#include <google/protobuf/compiler/cpp/cpp_helpers.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/io/printer.h>
+#include <google/protobuf/io/zero_copy_stream.h>
+#include <google/protobuf/wire_format.h>
+#include <google/protobuf/stubs/strutil.h>
+
+namespace google {
+namespace protobuf {
+namespace compiler {
+namespace bsv {
+
+namespace {
+
+// How the codecs move a field's elements, in the order of WireField::Kind
+// and of WireKind in ProtobufWire.bsv.
+enum Kind {
+  KIND_VARINT,
+  KIND_SIGNED_VARINT,
+  KIND_ZIGZAG,
+  KIND_BOOL,
+  KIND_FIXED,
+  KIND_BYTES,
+  KIND_MESSAGE
+};
+
+const char* const kCppKindNames[] = {
+  "WireField::KIND_VARINT", "WireField::KIND_SIGNED_VARINT",
+  "WireField::KIND_ZIGZAG", "WireField::KIND_BOOL", "WireField::KIND_FIXED",
+  "WireField::KIND_BYTES", "WireField::KIND_MESSAGE",
+};
+
+const char* const kBsvKindNames[] = {
+  "KindVarint", "KindSignedVarint", "KindZigZag", "KindBool", "KindFixed",
+  "KindBytes", "KindMessage",
+};
+
+Kind FieldKind(const FieldDescriptor* field) {
+  switch (field->type()) {
+    case FieldDescriptor::TYPE_INT32:
+    case FieldDescriptor::TYPE_INT64:
+    case FieldDescriptor::TYPE_ENUM:
+      return KIND_SIGNED_VARINT;
+    case FieldDescriptor::TYPE_UINT32:
+    case FieldDescriptor::TYPE_UINT64:
+      return KIND_VARINT;
+    case FieldDescriptor::TYPE_SINT32:
+    case FieldDescriptor::TYPE_SINT64:
+      return KIND_ZIGZAG;
+    case FieldDescriptor::TYPE_BOOL:
+      return KIND_BOOL;
+    case FieldDescriptor::TYPE_FIXED32:
+    case FieldDescriptor::TYPE_FIXED64:
+    case FieldDescriptor::TYPE_SFIXED32:
+    case FieldDescriptor::TYPE_SFIXED64:
+    case FieldDescriptor::TYPE_FLOAT:
+    case FieldDescriptor::TYPE_DOUBLE:
+      return KIND_FIXED;
+    case FieldDescriptor::TYPE_STRING:
+    case FieldDescriptor::TYPE_BYTES:
+      return KIND_BYTES;
+    case FieldDescriptor::TYPE_MESSAGE:
+    case FieldDescriptor::TYPE_GROUP:
+      return KIND_MESSAGE;
+  }
+  GOOGLE_LOG(FATAL) << "Can't get here.";
+  return KIND_VARINT;
+}
+
+// One field of a type in the codecs' tables.
+struct WireFieldEntry {
+  const RegisterField* layout;
+  Kind kind;
+  int type;          // The containing type.
+  int message_type;  // The field's type, if a message; otherwise -1.
+  bool packed;
+  bool omit_zero;
+  // The declared values of a closed enum, sorted; empty for other fields.
+  vector<int> enum_values;
+};
+
+// One message type in the codecs' tables.
+struct WireTypeEntry {
+  const RegisterLayout* layout;
+  int first_field;
+  int end_field;
+  int depth;  // Frames needed to decode the type, counting its own.
+};
+
+// The names of WireFormatLite::WireType values, indexed by value.
+const char* const kCppWireTypeNames[] = {
+  "WireFormatLite::WIRETYPE_VARINT",
+  "WireFormatLite::WIRETYPE_FIXED64",
+  "WireFormatLite::WIRETYPE_LENGTH_DELIMITED",
+  "WireFormatLite::WIRETYPE_START_GROUP",
+  "WireFormatLite::WIRETYPE_END_GROUP",
+  "WireFormatLite::WIRETYPE_FIXED32",
+};
+
+bool CompareFieldNumbers(const RegisterField* a, const RegisterField* b) {
+  return a->field->number() < b->field->number();
+}
+
+string WirePackageName(const FileDescriptor* file) {
+  return StripSuffixString(BsvPackageName(file), "_pb") + "_wire";
+}
+
+string DecoderName(const Descriptor* descriptor) {
+  return cpp::ClassName(descriptor, false) + "WireDecoder";
+}
+
+string EncoderName(const Descriptor* descriptor) {
+  return cpp::ClassName(descriptor, false) + "WireEncoder";
+}
+
+class WireFileGenerator {
+ public:
+  explicit WireFileGenerator(const FileDescriptor* file) : file_(file) {
+    for (int i = 0; i < file->message_type_count(); i++) {
+      ListMessages(file->message_type(i), &messages_);
+    }
+  }
+
+  // Computes the tables of every type the file's codecs meet.
+  bool Init(string* error);
+
+  void GenerateBsv(io::Printer* printer);
+  void GenerateHeader(io::Printer* printer);
+  void GenerateSource(io::Printer* printer);
+
+ private:
+  // Gives |layout|, and the types of its fields, indices in types_.
+  int AddType(const RegisterLayout* layout);
+  int Depth(int type);
+
+  // Prints the BSV function computing the encoded size of |type| after
+  // those of the types of its fields, which it calls.
+  void GenerateBsvSize(int type, set<int>* printed, io::Printer* printer);
+  void GenerateBsvFieldSize(int index, io::Printer* printer);
+  void GenerateBsvModules(const Descriptor* descriptor, io::Printer* printer);
+  void GenerateCppTables(io::Printer* printer);
+  void GenerateCppClasses(const Descriptor* descriptor, io::Printer* printer);
+  void GenerateNamespaceOpeners(io::Printer* printer);
+  void GenerateNamespaceClosers(io::Printer* printer);
+
+  const FileDescriptor* file_;
+  vector<const Descriptor*> messages_;
+  RegisterLayoutSet layouts_;
+  vector<WireTypeEntry> types_;
+  vector<WireFieldEntry> fields_;
+  map<const Descriptor*, int> type_index_;
+};
+
+bool WireFileGenerator::Init(string* error) {
+  for (int i = 0; i < messages_.size(); i++) {
+    const RegisterLayout* layout = layouts_.GetLayout(messages_[i], error);
+    if (layout == NULL) return false;
+    AddType(layout);
+  }
+
+  // The fields of each type are listed together, sorted by number.
+  for (int i = 0; i < types_.size(); i++) {
+    const RegisterLayout* layout = types_[i].layout;
+    vector<const RegisterField*> sorted;
+    for (int j = 0; j < layout->fields.size(); j++) {
+      sorted.push_back(&layout->fields[j]);
+    }
+    std::sort(sorted.begin(), sorted.end(), CompareFieldNumbers);
+
+    types_[i].first_field = fields_.size();
+    for (int j = 0; j < sorted.size(); j++) {
+      const FieldDescriptor* field = sorted[j]->field;
+      if (field->type() == FieldDescriptor::TYPE_GROUP) {
+        *error = field->full_name() + ": Groups have no wire codec.";
+        return false;
+      }
+      WireFieldEntry entry;
+      entry.layout = sorted[j];
+      entry.kind = FieldKind(field);
+      entry.type = i;
+      entry.message_type = sorted[j]->message == NULL ?
+          -1 : type_index_[sorted[j]->message->descriptor];
+      entry.packed = field->is_packed();
+      entry.omit_zero = !field->is_repeated() &&
+                        entry.kind != KIND_MESSAGE &&
+                        !cpp::HasFieldPresence(field->file());
+      if (field->cpp_type() == FieldDescriptor::CPPTYPE_ENUM &&
+          !cpp::HasPreservingUnknownEnumSemantics(field->file())) {
+        const EnumDescriptor* enum_type = field->enum_type();
+        for (int k = 0; k < enum_type->value_count(); k++) {
+          entry.enum_values.push_back(enum_type->value(k)->number());
+        }
+        std::sort(entry.enum_values.begin(), entry.enum_values.end());
+        entry.enum_values.erase(
+            std::unique(entry.enum_values.begin(), entry.enum_values.end()),
+            entry.enum_values.end());
+      }
+      fields_.push_back(entry);
+    }
+    types_[i].end_field = fields_.size();
+  }
+
+  for (int i = 0; i < types_.size(); i++) {
+    types_[i].depth = 0;
+  }
+  for (int i = 0; i < types_.size(); i++) {
+    Depth(i);
+  }
+  return true;
+}
+
+int WireFileGenerator::AddType(const RegisterLayout* layout) {
+  map<const Descriptor*, int>::iterator iter =
+      type_index_.find(layout->descriptor);
+  if (iter != type_index_.end()) return iter->second;
+
+  int index = types_.size();
+  type_index_[layout->descriptor] = index;
+  WireTypeEntry entry;
+  entry.layout = layout;
+  types_.push_back(entry);
+  for (int i = 0; i < layout->fields.size(); i++) {
+    if (layout->fields[i].message != NULL) {
+      AddType(layout->fields[i].message);
+    }
+  }
+  return index;
+}
+
+int WireFileGenerator::Depth(int type) {
+  // Register layouts are never recursive, so this terminates.
+  if (types_[type].depth == 0) {
+    int depth = 0;
+    for (int i = types_[type].first_field; i < types_[type].end_field; i++) {
+      if (fields_[i].message_type >= 0) {
+        depth = std::max(depth, Depth(fields_[i].message_type));
+      }
+    }
+    types_[type].depth = depth + 1;
+  }
+  return types_[type].depth;
+}
+
+void WireFileGenerator::GenerateBsv(io::Printer* printer) {
+  printer->Print(
+    "// Generated by the protocol buffer compiler.  DO NOT EDIT!\n"
+    "// source: $filename$\n"
+    "//\n"
+    "// Streaming codecs between the wire format and the register structs of\n"
+    "// the messages in the source file.  The decoders and encoders step one\n"
+    "// byte at a time, taking n steps per cycle.\n"
+    "//\n"
+    "// EXPERIMENTAL: this code has not been run through a BSV compiler.\n"
+    "\n"
+    "package $package$;\n"
+    "\n"
+    "import Vector::*;\n"
+    "import ProtobufWire::*;\n"
+    "import $register_package$::*;\n"
+    "\n",
+    "filename", file_->name(),
+    "package", WirePackageName(file_),
+    "register_package", BsvPackageName(file_));
+
+  for (int i = 0; i < messages_.size(); i++) {
+    printer->Print(
+      "export $name$WireDecoder(..);\n"
+      "export mk$name$WireDecoder;\n"
+      "export $name$WireEncoder(..);\n"
+      "export mk$name$WireEncoder;\n",
+      "name", BsvTypeName(messages_[i]));
+  }
+  if (messages_.empty()) {
+    printer->Print("endpackage\n");
+    return;
+  }
+  printer->Print("\n");
+
+  printer->Print(
+    "typedef $count$ NumWireFields;\n"
+    "\n"
+    "function WireField wireField(UInt#(16) index);\n"
+    "    WireField field = ?;\n",
+    "count", SimpleItoa(fields_.size()));
+  if (!fields_.empty()) {
+    printer->Print("    case (index)\n");
+    for (int i = 0; i < fields_.size(); i++) {
+      const WireFieldEntry& entry = fields_[i];
+      const RegisterField& layout = *entry.layout;
+      map<string, string> vars;
+      vars["index"] = SimpleItoa(i);
+      vars["full_name"] = layout.field->full_name();
+      vars["type"] = SimpleItoa(entry.type);
+      vars["number"] = SimpleItoa(layout.field->number());
+      vars["kind"] = kBsvKindNames[entry.kind];
+      vars["wire_type"] = SimpleItoa(
+          internal::WireFormat::WireTypeForFieldType(layout.field->type()));
+      vars["offset"] = SimpleItoa(layout.offset);
+      vars["element_size"] = SimpleItoa(layout.element_size);
+      vars["count_size"] = SimpleItoa(layout.count_size);
+      vars["max_count"] = SimpleItoa(layout.max_count);
+      vars["repeated"] = layout.field->is_repeated() ? "True" : "False";
+      vars["packed"] = entry.packed ? "True" : "False";
+      vars["omit_zero"] = entry.omit_zero ? "True" : "False";
+      vars["message_type"] = SimpleItoa(std::max(entry.message_type, 0));
+      printer->Print(vars,
+        "        // $full_name$\n"
+        "        $index$: field = WireField { type_: $type$, number: $number$,\n"
+        "            kind: $kind$, wireType: $wire_type$, offset: $offset$,\n"
+        "            elementSize: $element_size$, countSize: $count_size$,\n"
+        "            maxCount: $max_count$, repeated: $repeated$,\n"
+        "            isPacked: $packed$, omitZero: $omit_zero$,\n"
+        "            messageType: $message_type$ };\n");
+    }
+    printer->Print("    endcase\n");
+  }
+  printer->Print(
+    "    return field;\n"
+    "endfunction\n"
+    "\n"
+    "function WireType wireType(UInt#(16) type_);\n"
+    "    WireType result = ?;\n"
+    "    case (type_)\n");
+  for (int i = 0; i < types_.size(); i++) {
+    printer->Print(
+      "        // $full_name$\n"
+      "        $index$: result = WireType { firstField: $first$, endField: $end$ };\n",
+      "full_name", types_[i].layout->descriptor->full_name(),
+      "index", SimpleItoa(i),
+      "first", SimpleItoa(types_[i].first_field),
+      "end", SimpleItoa(types_[i].end_field));
+  }
+  printer->Print(
+    "    endcase\n"
+    "    return result;\n"
+    "endfunction\n"
+    "\n"
+    "// Whether |value| may be decoded into field |index|: false only for the\n"
+    "// undeclared values of closed enums.\n"
+    "function Bool validEnumValue(UInt#(16) index, Int#(32) value);\n"
+    "    Bool valid = True;\n");
+  bool has_closed_enums = false;
+  for (int i = 0; i < fields_.size(); i++) {
+    if (fields_[i].enum_values.empty()) continue;
+    if (!has_closed_enums) printer->Print("    case (index)\n");
+    has_closed_enums = true;
+    vector<string> tests;
+    for (int j = 0; j < fields_[i].enum_values.size(); j++) {
+      tests.push_back("value == " + SimpleItoa(fields_[i].enum_values[j]));
+    }
+    printer->Print("        $index$: valid = $tests$;\n",
+                   "index", SimpleItoa(i),
+                   "tests", JoinStrings(tests, " || "));
+  }
+  if (has_closed_enums) printer->Print("    endcase\n");
+  printer->Print(
+    "    return valid;\n"
+    "endfunction\n"
+    "\n");
+
+  set<int> printed;
+  for (int i = 0; i < types_.size(); i++) {
+    GenerateBsvSize(i, &printed, printer);
+  }
+
+  printer->Print(
+    "function UInt#(32) wireMessageSize(UInt#(16) type_,\n"
+    "                                   Vector#(nbytes, Bit#(8)) image,\n"
+    "                                   UInt#(32) base);\n"
+    "    UInt#(32) size = 0;\n"
+    "    case (type_)\n");
+  for (int i = 0; i < types_.size(); i++) {
+    printer->Print("        $index$: size = wireSize$index$(image, base);\n",
+                   "index", SimpleItoa(i));
+  }
+  printer->Print(
+    "    endcase\n"
+    "    return size;\n"
+    "endfunction\n"
+    "\n"
+    "// Returns the size of the values of the packed field |index| at\n"
+    "// |address|.\n"
+    "function UInt#(32) wirePackedSize(UInt#(16) index,\n"
+    "                                  Vector#(nbytes, Bit#(8)) image,\n"
+    "                                  UInt#(32) address);\n"
+    "    UInt#(32) size = 0;\n");
+  bool has_packed = false;
+  for (int i = 0; i < fields_.size(); i++) {
+    if (!fields_[i].packed) continue;
+    if (!has_packed) printer->Print("    case (index)\n");
+    has_packed = true;
+    const RegisterField& layout = *fields_[i].layout;
+    printer->Print(
+      "        $index$: begin\n"
+      "            UInt#(32) count = readCount(image, wireField($index$), address);\n"
+      "            for (Integer i = 0; i < $max_count$; i = i + 1)\n"
+      "                if (fromInteger(i) < count)\n"
+      "                    size = size + valueSize(wireField($index$),\n"
+      "                        elementValue(wireField($index$), image,\n"
+      "                            address + $count_size$ + fromInteger($element_size$ * i)));\n"
+      "        end\n",
+      "index", SimpleItoa(i),
+      "max_count", SimpleItoa(layout.max_count),
+      "count_size", SimpleItoa(layout.count_size),
+      "element_size", SimpleItoa(layout.element_size));
+  }
+  if (has_packed) printer->Print("    endcase\n");
+  printer->Print(
+    "    return size;\n"
+    "endfunction\n"
+    "\n"
+    "function WireSchema#(NumWireFields, nbytes) wireSchema();\n"
+    "    return (interface WireSchema;\n"
+    "        method WireField field(UInt#(16) index) = wireField(index);\n"
+    "        method WireType messageType(UInt#(16) type_) = wireType(type_);\n"
+    "        method Bool enumValueValid(UInt#(16) index, Int#(32) value) =\n"
+    "            validEnumValue(index, value);\n"
+    "        method UInt#(32) messageSize(UInt#(16) type_,\n"
+    "                                     Vector#(nbytes, Bit#(8)) image,\n"
+    "                                     UInt#(32) base) =\n"
+    "            wireMessageSize(type_, image, base);\n"
+    "        method UInt#(32) packedSize(UInt#(16) index,\n"
+    "                                    Vector#(nbytes, Bit#(8)) image,\n"
+    "                                    UInt#(32) address) =\n"
+    "            wirePackedSize(index, image, address);\n"
+    "    endinterface);\n"
+    "endfunction\n"
+    "\n");
+
+  for (int i = 0; i < messages_.size(); i++) {
+    GenerateBsvModules(messages_[i], printer);
+  }
+  printer->Print("endpackage\n");
+}
+
+void WireFileGenerator::GenerateBsvSize(int type, set<int>* printed,
+                                        io::Printer* printer) {
+  if (!printed->insert(type).second) return;
+  for (int i = types_[type].first_field; i < types_[type].end_field; i++) {
+    if (fields_[i].message_type >= 0) {
+      GenerateBsvSize(fields_[i].message_type, printed, printer);
+    }
+  }
+
+  printer->Print(
+    "// The encoded size of $full_name$.\n"
+    "function UInt#(32) wireSize$index$(Vector#(nbytes, Bit#(8)) image,\n"
+    "                                   UInt#(32) base);\n"
+    "    UInt#(32) size = 0;\n",
+    "full_name", types_[type].layout->descriptor->full_name(),
+    "index", SimpleItoa(type));
+  printer->Indent();
+  printer->Indent();
+  for (int i = types_[type].first_field; i < types_[type].end_field; i++) {
+    GenerateBsvFieldSize(i, printer);
+  }
+  printer->Outdent();
+  printer->Outdent();
+  printer->Print(
+    "    return size;\n"
+    "endfunction\n"
+    "\n");
+}
+
+void WireFileGenerator::GenerateBsvFieldSize(int index,
+                                             io::Printer* printer) {
+  const WireFieldEntry& entry = fields_[index];
+  const RegisterField& layout = *entry.layout;
+  map<string, string> vars;
+  vars["name"] = layout.field->name();
+  vars["index"] = SimpleItoa(index);
+  vars["offset"] = SimpleItoa(layout.offset);
+  vars["elements"] = SimpleItoa(layout.offset + layout.count_size);
+  vars["element_size"] = SimpleItoa(layout.element_size);
+  vars["max_count"] = SimpleItoa(layout.max_count);
+  vars["tag_size"] = SimpleItoa(internal::WireFormat::TagSize(
+      layout.field->number(), layout.field->type()));
+  vars["message_size"] = "wireSize" + SimpleItoa(entry.message_type);
+
+  printer->Print(vars, "// $name$\n");
+  if (layout.field->is_repeated()) {
+    printer->Print(vars,
+      "begin\n"
+      "    UInt#(32) count = readCount(image, wireField($index$), base + $offset$);\n");
+    if (entry.packed) printer->Print("    UInt#(32) packedSize = 0;\n");
+    printer->Print(vars,
+      "    for (Integer i = 0; i < $max_count$; i = i + 1)\n"
+      "        if (fromInteger(i) < count) begin\n"
+      "            UInt#(32) element = base + $elements$ + fromInteger($element_size$ * i);\n");
+    if (entry.kind == KIND_MESSAGE) {
+      printer->Print(vars,
+        "            UInt#(32) length = $message_size$(image, element);\n"
+        "            size = size + $tag_size$ + varintSize(zeroExtend(pack(length))) +\n"
+        "                   length;\n");
+    } else if (entry.packed) {
+      printer->Print(vars,
+        "            packedSize = packedSize + valueSize(wireField($index$),\n"
+        "                elementValue(wireField($index$), image, element));\n");
+    } else {
+      printer->Print(vars,
+        "            size = size + $tag_size$ + valueSize(wireField($index$),\n"
+        "                elementValue(wireField($index$), image, element));\n");
+    }
+    printer->Print("        end\n");
+    if (entry.packed) {
+      printer->Print(vars,
+        "    if (count != 0)\n"
+        "        size = size + $tag_size$ +\n"
+        "               varintSize(zeroExtend(pack(packedSize))) + packedSize;\n");
+    }
+    printer->Print("end\n");
+  } else if (entry.kind == KIND_BYTES) {
+    printer->Print(vars,
+      "begin\n"
+      "    UInt#(32) length = readCount(image, wireField($index$), base + $offset$);\n");
+    if (entry.omit_zero) printer->Print("    if (length != 0)\n    ");
+    printer->Print(vars,
+      "    size = size + $tag_size$ + varintSize(zeroExtend(pack(length))) + length;\n"
+      "end\n");
+  } else if (entry.kind == KIND_MESSAGE) {
+    printer->Print(vars,
+      "begin\n"
+      "    UInt#(32) length = $message_size$(image, base + $offset$);\n"
+      "    size = size + $tag_size$ + varintSize(zeroExtend(pack(length))) + length;\n"
+      "end\n");
+  } else {
+    printer->Print(vars,
+      "begin\n"
+      "    Bit#(64) value = elementValue(wireField($index$), image, base + $offset$);\n");
+    if (entry.omit_zero) printer->Print("    if (value != 0)\n    ");
+    printer->Print(vars,
+      "    size = size + $tag_size$ + valueSize(wireField($index$), value);\n"
+      "end\n");
+  }
+}
+
+void WireFileGenerator::GenerateBsvModules(const Descriptor* descriptor,
+                                           io::Printer* printer) {
+  int type = type_index_[descriptor];
+  map<string, string> vars;
+  vars["full_name"] = descriptor->full_name();
+  vars["name"] = BsvTypeName(descriptor);
+  vars["type"] = SimpleItoa(type);
+  vars["size"] = SimpleItoa(types_[type].layout->size);
+  vars["depth"] = SimpleItoa(types_[type].depth);
+  printer->Print(vars,
+    "// Decodes $full_name$ from the first |count| of |bytes| each\n"
+    "// cycle, until the |length| bytes given to start() have been consumed.\n"
+    "interface $name$WireDecoder#(numeric type n);\n"
+    "    method Action start(UInt#(32) length);\n"
+    "    method Action put(Vector#(n, Bit#(8)) bytes, UInt#(32) count);\n"
+    "    method Bool done;\n"
+    "    method Bool failed;\n"
+    "    method $name$ value;\n"
+    "endinterface\n"
+    "\n"
+    "module mk$name$WireDecoder($name$WireDecoder#(n));\n"
+    "    Reg#(WireDecoderState#($size$, $depth$)) state <-\n"
+    "        mkReg(wireDecoderStart($type$, 0));\n"
+    "\n"
+    "    method Action start(UInt#(32) length);\n"
+    "        state <= wireDecoderStart($type$, length);\n"
+    "    endmethod\n"
+    "\n"
+    "    method Action put(Vector#(n, Bit#(8)) bytes, UInt#(32) count);\n"
+    "        WireDecoderState#($size$, $depth$) s = state;\n"
+    "        for (Integer i = 0; i < valueOf(n); i = i + 1)\n"
+    "            if (fromInteger(i) < count && s.position < s.frames[0].end_ &&\n"
+    "                s.mode != StateFailed)\n"
+    "                s = decodeByte(wireSchema(), s, bytes[i]);\n"
+    "        state <= s;\n"
+    "    endmethod\n"
+    "\n"
+    "    method Bool done = wireDecoderDone(state);\n"
+    "    method Bool failed = state.mode == StateFailed;\n"
+    "    method $name$ value = unpack(pack(state.image));\n"
+    "endmodule\n"
+    "\n"
+    "// Encodes the $full_name$ given to start(), returning up to n\n"
+    "// bytes each cycle, of which the first |count| are valid.\n"
+    "interface $name$WireEncoder#(numeric type n);\n"
+    "    method Action start($name$ value);\n"
+    "    method UInt#(32) byteSize;\n"
+    "    method ActionValue#(Tuple2#(Vector#(n, Bit#(8)), UInt#(32))) get;\n"
+    "    method Bool done;\n"
+    "endinterface\n"
+    "\n"
+    "module mk$name$WireEncoder($name$WireEncoder#(n));\n"
+    "    Reg#(WireEncoderState#($size$, $depth$)) state <-\n"
+    "        mkReg(wireEncoderStart(wireSchema(), $type$, replicate(0)));\n"
+    "\n"
+    "    method Action start($name$ value);\n"
+    "        state <= wireEncoderStart(wireSchema(), $type$, unpack(pack(value)));\n"
+    "    endmethod\n"
+    "\n"
+    "    method UInt#(32) byteSize = wireSize$type$(state.image, 0);\n"
+    "\n"
+    "    method ActionValue#(Tuple2#(Vector#(n, Bit#(8)), UInt#(32))) get;\n"
+    "        WireEncoderState#($size$, $depth$) s = state;\n"
+    "        Vector#(n, Bit#(8)) bytes = replicate(0);\n"
+    "        UInt#(32) count = 0;\n"
+    "        for (Integer i = 0; i < valueOf(n); i = i + 1)\n"
+    "            if (!s.done) begin\n"
+    "                match {.stepped, .out} = encodeStep(wireSchema(), s);\n"
+    "                s = stepped;\n"
+    "                if (out matches tagged Valid .b) begin\n"
+    "                    bytes[count] = b;\n"
+    "                    count = count + 1;\n"
+    "                end\n"
+    "            end\n"
+    "        state <= s;\n"
+    "        return tuple2(bytes, count);\n"
+    "    endmethod\n"
+    "\n"
+    "    method Bool done = state.done;\n"
+    "endmodule\n"
+    "\n");
+}
+
+void WireFileGenerator::GenerateNamespaceOpeners(io::Printer* printer) {
+  vector<string> parts;
+  SplitStringUsing(file_->package(), ".", &parts);
+  for (int i = 0; i < parts.size(); i++) {
+    printer->Print("namespace $part$ {\n", "part", parts[i]);
+  }
+  if (!parts.empty()) printer->Print("\n");
+}
+
+void WireFileGenerator::GenerateNamespaceClosers(io::Printer* printer) {
+  vector<string> parts;
+  SplitStringUsing(file_->package(), ".", &parts);
+  for (int i = parts.size() - 1; i >= 0; i--) {
+    printer->Print("}  // namespace $part$\n", "part", parts[i]);
+  }
+}
+
+void WireFileGenerator::GenerateHeader(io::Printer* printer) {
+  string filename_identifier = cpp::FilenameIdentifier(file_->name());
+  printer->Print(
+    "// Generated by the protocol buffer compiler.  DO NOT EDIT!\n"
+    "// source: $filename$\n"
+    "//\n"
+    "// Cycle-level models of the streaming codecs in $package$.bsv.\n"
+    "// Each cycle, a decoder consumes up to bytes_per_cycle bytes of wire\n"
+    "// format into the register encoding of the messages, and an encoder\n"
+    "// produces up to bytes_per_cycle bytes of wire format from it.\n"
+    "\n"
+    "#ifndef PROTOBUF_$filename_identifier$_2ewire__INCLUDED\n"
+    "#define PROTOBUF_$filename_identifier$_2ewire__INCLUDED\n"
+    "\n"
+    "#include \"$basename$.regs.h\"\n"
+    "\n",
+    "filename", file_->name(),
+    "package", WirePackageName(file_),
+    "filename_identifier", filename_identifier,
+    "basename", cpp::StripProto(file_->name()));
+  GenerateNamespaceOpeners(printer);
+
+  for (int i = 0; i < messages_.size(); i++) {
+    map<string, string> vars;
+    vars["full_name"] = messages_[i]->full_name();
+    vars["decoder"] = DecoderName(messages_[i]);
+    vars["encoder"] = EncoderName(messages_[i]);
+    vars["size_name"] = "k" + cpp::ClassName(messages_[i], false) +
+                        "PackedSize";
+    printer->Print(vars,
+      "// Decodes $full_name$ from the wire format.\n"
+      "class $decoder$ {\n"
+      " public:\n"
+      "  explicit $decoder$(int bytes_per_cycle);\n"
+      "  ~$decoder$();\n"
+      "\n"
+      "  // Starts decoding a message of |length| bytes.\n"
+      "  void Reset(::google::protobuf::uint32 length);\n"
+      "\n"
+      "  // Runs a cycle, consuming up to bytes_per_cycle of the |size| bytes at\n"
+      "  // |data|.  Returns the number of bytes consumed.\n"
+      "  int Cycle(const ::google::protobuf::uint8* data, int size);\n"
+      "\n"
+      "  // Whether all |length| bytes have been decoded.\n"
+      "  bool done() const;\n"
+      "  // Whether the bytes were not a valid message, or did not fit the\n"
+      "  // bounds of the register encoding.\n"
+      "  bool failed() const;\n"
+      "  // The number of cycles run since Reset().\n"
+      "  int cycles() const;\n"
+      "  // The $size_name$ bytes decoded.\n"
+      "  const ::google::protobuf::uint8* registers() const;\n"
+      "\n"
+      " private:\n"
+      "  class Model;\n"
+      "  Model* model_;\n"
+      "\n"
+      "  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS($decoder$);\n"
+      "};\n"
+      "\n"
+      "// Encodes $full_name$ to the wire format.\n"
+      "class $encoder$ {\n"
+      " public:\n"
+      "  explicit $encoder$(int bytes_per_cycle);\n"
+      "  ~$encoder$();\n"
+      "\n"
+      "  // Starts encoding the message whose encoding is the $size_name$\n"
+      "  // bytes at |registers|.\n"
+      "  void Reset(const ::google::protobuf::uint8* registers);\n"
+      "\n"
+      "  // The number of bytes the message encodes to.\n"
+      "  ::google::protobuf::uint32 ByteSize() const;\n"
+      "\n"
+      "  // Runs a cycle, writing up to bytes_per_cycle bytes to |target|.\n"
+      "  // Returns the number of bytes written.\n"
+      "  int Cycle(::google::protobuf::uint8* target);\n"
+      "\n"
+      "  // Whether the whole message has been written.\n"
+      "  bool done() const;\n"
+      "  // The number of cycles run since Reset().\n"
+      "  int cycles() const;\n"
+      "\n"
+      " private:\n"
+      "  class Model;\n"
+      "  Model* model_;\n"
+      "\n"
+      "  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS($encoder$);\n"
+      "};\n"
+      "\n");
+  }
+
+  GenerateNamespaceClosers(printer);
+  printer->Print(
+    "\n"
+    "#endif  // PROTOBUF_$filename_identifier$_2ewire__INCLUDED\n",
+    "filename_identifier", filename_identifier);
+}
+
+void WireFileGenerator::GenerateSource(io::Printer* printer) {
+  printer->Print(
+    "// Generated by the protocol buffer compiler.  DO NOT EDIT!\n"
+    "// source: $filename$\n"
+    "\n"
+    "#include \"$basename$.wire.h\"\n"
+    "\n"
+    "#include <google/protobuf/compiler/bsv/bsv_wire_model.h>\n"
+    "#include <google/protobuf/wire_format_lite.h>\n"
+    "\n",
+    "filename", file_->name(),
+    "basename", cpp::StripProto(file_->name()));
+  if (messages_.empty()) return;
+
+  printer->Print(
+    "namespace {\n"
+    "\n"
+    "using ::google::protobuf::int32;\n"
+    "using ::google::protobuf::compiler::bsv::WireDecoderModel;\n"
+    "using ::google::protobuf::compiler::bsv::WireEncoderModel;\n"
+    "using ::google::protobuf::compiler::bsv::WireField;\n"
+    "using ::google::protobuf::compiler::bsv::WireType;\n"
+    "using ::google::protobuf::internal::WireFormatLite;\n"
+    "\n");
+  GenerateCppTables(printer);
+  printer->Print(
+    "}  // namespace\n"
+    "\n");
+
+  GenerateNamespaceOpeners(printer);
+  for (int i = 0; i < messages_.size(); i++) {
+    GenerateCppClasses(messages_[i], printer);
+  }
+  GenerateNamespaceClosers(printer);
+}
+
+void WireFileGenerator::GenerateCppTables(io::Printer* printer) {
+  for (int i = 0; i < fields_.size(); i++) {
+    if (fields_[i].enum_values.empty()) continue;
+    vector<string> values;
+    for (int j = 0; j < fields_[i].enum_values.size(); j++) {
+      values.push_back(SimpleItoa(fields_[i].enum_values[j]));
+    }
+    printer->Print("const int32 kWireEnumValues$index$[] = { $values$ };\n",
+                   "index", SimpleItoa(i),
+                   "values", JoinStrings(values, ", "));
+  }
+
+  if (fields_.empty()) {
+    printer->Print("const WireField* const kWireFields = NULL;\n\n");
+  } else {
+    printer->Print("const WireField kWireFields[] = {\n");
+    for (int i = 0; i < fields_.size(); i++) {
+      const WireFieldEntry& entry = fields_[i];
+      const RegisterField& layout = *entry.layout;
+      map<string, string> vars;
+      vars["full_name"] = layout.field->full_name();
+      vars["number"] = SimpleItoa(layout.field->number());
+      vars["kind"] = kCppKindNames[entry.kind];
+      vars["wire_type"] = kCppWireTypeNames[
+          internal::WireFormat::WireTypeForFieldType(layout.field->type())];
+      vars["offset"] = SimpleItoa(layout.offset);
+      vars["element_size"] = SimpleItoa(layout.element_size);
+      vars["count_size"] = SimpleItoa(layout.count_size);
+      vars["max_count"] = SimpleItoa(layout.max_count);
+      vars["repeated"] = layout.field->is_repeated() ? "true" : "false";
+      vars["packed"] = entry.packed ? "true" : "false";
+      vars["omit_zero"] = entry.omit_zero ? "true" : "false";
+      vars["message_type"] = SimpleItoa(entry.message_type);
+      if (entry.enum_values.empty()) {
+        vars["enum_values"] = "NULL, 0";
+      } else {
+        vars["enum_values"] = StrCat("kWireEnumValues", i, ", ",
+                                     entry.enum_values.size());
+      }
+      printer->Print(vars,
+        "  // $full_name$\n"
+        "  { $number$, $kind$, $wire_type$,\n"
+        "    $offset$, $element_size$, $count_size$, $max_count$, $repeated$, $packed$, $omit_zero$,\n"
+        "    $message_type$, $enum_values$ },\n");
+    }
+    printer->Print("};\n\n");
+  }
+
+  printer->Print("const WireType kWireTypes[] = {\n");
+  for (int i = 0; i < types_.size(); i++) {
+    printer->Print("  { $first$, $end$ },  // $full_name$\n",
+                   "first", SimpleItoa(types_[i].first_field),
+                   "end", SimpleItoa(types_[i].end_field),
+                   "full_name", types_[i].layout->descriptor->full_name());
+  }
+  printer->Print("};\n\n");
+}
+
+void WireFileGenerator::GenerateCppClasses(const Descriptor* descriptor,
+                                           io::Printer* printer) {
+  int type = type_index_[descriptor];
+  map<string, string> vars;
+  vars["decoder"] = DecoderName(descriptor);
+  vars["encoder"] = EncoderName(descriptor);
+  vars["type"] = SimpleItoa(type);
+  vars["size_name"] = "k" + cpp::ClassName(descriptor, false) + "PackedSize";
+  vars["depth"] = SimpleItoa(types_[type].depth);
+  printer->Print(vars,
+    "class $decoder$::Model : public WireDecoderModel {\n"
+    " public:\n"
+    "  explicit Model(int bytes_per_cycle)\n"
+    "      : WireDecoderModel(kWireFields, kWireTypes, $type$, $size_name$,\n"
+    "                         $depth$, bytes_per_cycle) {}\n"
+    "};\n"
+    "\n"
+    "$decoder$::$decoder$(int bytes_per_cycle)\n"
+    "    : model_(new Model(bytes_per_cycle)) {}\n"
+    "\n"
+    "$decoder$::~$decoder$() {\n"
+    "  delete model_;\n"
+    "}\n"
+    "\n"
+    "void $decoder$::Reset(::google::protobuf::uint32 length) {\n"
+    "  model_->Reset(length);\n"
+    "}\n"
+    "\n"
+    "int $decoder$::Cycle(const ::google::protobuf::uint8* data, int size) {\n"
+    "  return model_->Cycle(data, size);\n"
+    "}\n"
+    "\n"
+    "bool $decoder$::done() const {\n"
+    "  return model_->done();\n"
+    "}\n"
+    "\n"
+    "bool $decoder$::failed() const {\n"
+    "  return model_->failed();\n"
+    "}\n"
+    "\n"
+    "int $decoder$::cycles() const {\n"
+    "  return model_->cycles();\n"
+    "}\n"
+    "\n"
+    "const ::google::protobuf::uint8* $decoder$::registers() const {\n"
+    "  return model_->registers();\n"
+    "}\n"
+    "\n"
+    "class $encoder$::Model : public WireEncoderModel {\n"
+    " public:\n"
+    "  explicit Model(int bytes_per_cycle)\n"
+    "      : WireEncoderModel(kWireFields, kWireTypes, $type$, $size_name$,\n"
+    "                         $depth$, bytes_per_cycle) {}\n"
+    "};\n"
+    "\n"
+    "$encoder$::$encoder$(int bytes_per_cycle)\n"
+    "    : model_(new Model(bytes_per_cycle)) {}\n"
+    "\n"
+    "$encoder$::~$encoder$() {\n"
+    "  delete model_;\n"
+    "}\n"
+    "\n"
+    "void $encoder$::Reset(const ::google::protobuf::uint8* registers) {\n"
+    "  model_->Reset(registers);\n"
+    "}\n"
+    "\n"
+    "::google::protobuf::uint32 $encoder$::ByteSize() const {\n"
+    "  return model_->ByteSize();\n"
+    "}\n"
+    "\n"
+    "int $encoder$::Cycle(::google::protobuf::uint8* target) {\n"
+    "  return model_->Cycle(target);\n"
+    "}\n"
+    "\n"
+    "bool $encoder$::done() const {\n"
+    "  return model_->done();\n"
+    "}\n"
+    "\n"
+    "int $encoder$::cycles() const {\n"
+    "  return model_->cycles();\n"
+    "}\n"
+    "\n");
+}
+
+}  // namespace
+
+bool GenerateWireFiles(const FileDescriptor* file, const string& bsv_filename,
+                       GeneratorContext* context, string* error) {
+  WireFileGenerator generator(file);
+  if (!generator.Init(error)) return false;
+
+  string basename = cpp::StripProto(file->name());
+  {
+    google::protobuf::scoped_ptr<io::ZeroCopyOutputStream> output(
+        context->Open(StripSuffixString(bsv_filename, "_pb.bsv") +
+                      "_wire.bsv"));
+    io::Printer printer(output.get(), '$');
+    generator.GenerateBsv(&printer);
+  }
+  {
+    google::protobuf::scoped_ptr<io::ZeroCopyOutputStream> output(
+        context->Open(basename + ".wire.h"));
+    io::Printer printer(output.get(), '$');
+    generator.GenerateHeader(&printer);
+  }
+  {
+    google::protobuf::scoped_ptr<io::ZeroCopyOutputStream> output(
+        context->Open(basename + ".wire.cc"));
+    io::Printer printer(output.get(), '$');
+    generator.GenerateSource(&printer);
+  }
+  return true;
+}
+
+}  // namespace bsv
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,97 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Generates streaming codecs between the protobuf wire format and the
+// register encoding of bsv_register.h, for moving messages across a
+// software-to-hardware link without changing their wire format.
+//
+// For each message, the BSV package "foo_wire" gets a decoder module, which
+// consumes the wire format a few bytes per cycle and writes the message's
+// register struct, and an encoder module, which reads a register struct and
+// produces the wire format a few bytes per cycle.  Both are driven by a
+// table of the fields of every message type they may meet, and step one
+// byte at a time; a cycle takes as many steps as there are bytes per cycle.
+//
+// The machines themselves live in the BSV package ProtobufWire, which is
+// installed as google/protobuf/compiler/bsv/ProtobufWire.bsv and which every
+// "foo_wire" package imports; "foo_wire" holds only the tables and modules.
+//
+// "foo.wire.h" and "foo.wire.cc" hold a C++ model of the same machines,
+// which agrees with the BSV cycle for cycle, so that software can check
+// hardware traces against it.  Likewise the models are shared, in
+// bsv_wire_model.h, and "foo.wire.cc" holds only the tables:
+//
+// - The decoder consumes one byte per step.  It skips unknown fields and
+//   fields of the wrong wire type, accepts repeated scalars both packed and
+//   unpacked, and, like the parser, drops values of closed enums that are not
+//   declared.  It fails on groups, on overlong varints, on lengths that
+//   overrun their message, and on fields that exceed their bounds.
+// - The encoder either emits one byte or moves on to the next value to emit
+//   in each step, writing fields in number order as the serializer does.
+//   Proto3 scalars and strings are skipped when zero or empty; message
+//   fields, which the register encoding cannot leave out, are always
+//   written.  It packs the fields marked [packed = true].
+//
+// The BSV output is experimental: it has not been run through a BSV
+// compiler, and only the C++ models are tested.
+
+#ifndef GOOGLE_PROTOBUF_COMPILER_BSV_WIRE_H__
+#define GOOGLE_PROTOBUF_COMPILER_BSV_WIRE_H__
+
+#include <string>
+
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+
+class FileDescriptor;
+
+namespace compiler {
+
+class GeneratorContext;
+
+namespace bsv {
+
+// Writes the streaming codecs for every message in |file|: a BSV package
+// named like |bsv_filename|, the register package of the file, but ending
+// in "_wire" instead of "_pb", and their C++ models in "foo.wire.h" and
+// "foo.wire.cc".  The models build on the register files written by
+// GenerateRegisterFiles().  Returns false and sets *error if some message in
+// |file| cannot be given a codec.
+bool GenerateWireFiles(const FileDescriptor* file, const string& bsv_filename,
+                       GeneratorContext* context, string* error);
+
+}  // namespace bsv
+}  // namespace compiler
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_COMPILER_BSV_WIRE_H__
@@ -0,0 +1,672 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// The cycle-level C++ models of the streaming codecs that --bsv_out=wire
+// writes in BSV; see bsv_wire.h.  The "foo.wire.cc" generated for each
+// .proto file holds only the tables of the message types its codecs meet,
+// and wraps these models around them.
+//
+// This header is included by generated code, and is kept free of anything
+// outside libprotobuf so that such code links against libprotobuf alone.
+
+#ifndef GOOGLE_PROTOBUF_COMPILER_BSV_WIRE_MODEL_H__
+#define GOOGLE_PROTOBUF_COMPILER_BSV_WIRE_MODEL_H__
+
+#include <algorithm>
+#include <vector>
+
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/wire_format_lite.h>
+
+namespace google {
+namespace protobuf {
+namespace compiler {
+namespace bsv {
+
+// A field of one of the message types in a table of WireTypes.
+struct WireField {
+  // How the elements of a field are held in registers and on the wire.
+  enum Kind {
+    KIND_VARINT,         // A varint, zero-extended from the registers.
+    KIND_SIGNED_VARINT,  // A varint, sign-extended from the registers.
+    KIND_ZIGZAG,         // A ZigZag-encoded varint.
+    KIND_BOOL,           // A varint, held as 0 or 1.
+    KIND_FIXED,          // Copied between registers and wire as is.
+    KIND_BYTES,          // A string or bytes field.
+    KIND_MESSAGE
+  };
+
+  uint32 number;
+  Kind kind;
+  internal::WireFormatLite::WireType wire_type;
+  uint32 offset;      // From the start of the containing message.
+  uint32 element_size;
+  uint32 count_size;  // Zero if the field has no count.
+  uint32 max_count;
+  bool repeated;
+  bool packed;        // Whether the encoder packs the field.
+  bool omit_zero;     // Whether the encoder skips the field when zero.
+  int message_type;   // The field's index among the WireTypes, if a message.
+  const int32* enum_values;  // Sorted values of a closed enum, or NULL.
+  int enum_value_count;
+};
+
+// A message type, whose fields are [first_field, end_field) in the table of
+// WireFields, sorted by number.
+struct WireType {
+  int first_field;
+  int end_field;
+};
+
+// Reads the little-endian value of |size| bytes at |registers|.
+inline uint64 ReadRegisters(const uint8* registers, uint32 size) {
+  uint64 value = 0;
+  for (uint32 i = size; i > 0; i--) {
+    value = (value << 8) | registers[i - 1];
+  }
+  return value;
+}
+
+// Writes the low |size| bytes of |value| to |registers|, little-endian.
+inline void WriteRegisters(uint64 value, uint32 size, uint8* registers) {
+  for (uint32 i = 0; i < size; i++) {
+    registers[i] = static_cast<uint8>(value >> (8 * i));
+  }
+}
+
+// Models a decoder, which consumes one byte per step and writes the values
+// it decodes to their registers.  A frame is pushed for each nested message.
+//
+// The decoder decodes message |type| of |types| into |size| bytes of
+// registers, nesting at most |depth| messages deep.  |fields| and |types|
+// must outlive it.
+class WireDecoderModel {
+ public:
+  WireDecoderModel(const WireField* fields, const WireType* types, int type,
+                   uint32 size, int depth, int bytes_per_cycle)
+      : fields_(fields), types_(types), type_(type),
+        bytes_per_cycle_(bytes_per_cycle), registers_(size), frames_(depth) {
+    Reset(0);
+  }
+
+  void Reset(uint32 length) {
+    std::fill(registers_.begin(), registers_.end(), 0);
+    frames_[0].type = type_;
+    frames_[0].base = 0;
+    frames_[0].end = length;
+    depth_ = 0;
+    position_ = 0;
+    packed_end_ = 0;
+    cycles_ = 0;
+    state_ = STATE_TAG;
+    value_ = 0;
+    shift_ = 0;
+  }
+
+  int Cycle(const uint8* data, int size) {
+    uint32 steps = std::min(size, bytes_per_cycle_);
+    steps = std::min(steps, frames_[0].end - position_);
+    uint32 i = 0;
+    while (i < steps && state_ != STATE_FAILED) Step(data[i++]);
+    cycles_++;
+    return i;
+  }
+
+  bool done() const {
+    return state_ == STATE_TAG && shift_ == 0 && position_ == frames_[0].end;
+  }
+  bool failed() const { return state_ == STATE_FAILED; }
+  int cycles() const { return cycles_; }
+  const uint8* registers() const {
+    return registers_.empty() ? NULL : &registers_[0];
+  }
+
+ private:
+  enum State {
+    STATE_TAG,     // Reading a tag.
+    STATE_VARINT,  // Reading a varint value.
+    STATE_LENGTH,  // Reading the length of a length-delimited value.
+    STATE_FIXED,   // Reading a fixed-width value.
+    STATE_BYTES,   // Copying the bytes of a string.
+    STATE_SKIP,    // Skipping the bytes of an unknown field.
+    STATE_FAILED
+  };
+
+  struct Frame {
+    int type;
+    uint32 base;  // Where the message's registers start.
+    uint32 end;   // The position just past the message.
+  };
+
+  void Step(uint8 byte) {
+    position_++;
+    switch (state_) {
+      case STATE_TAG:
+      case STATE_VARINT:
+      case STATE_LENGTH:
+        if (shift_ >= 64) {
+          state_ = STATE_FAILED;
+          return;
+        }
+        value_ |= static_cast<uint64>(byte & 0x7f) << shift_;
+        shift_ += 7;
+        if (byte & 0x80) break;
+        if (state_ == STATE_TAG) {
+          EndTag();
+        } else if (state_ == STATE_VARINT) {
+          EndValue();
+        } else {
+          EndLength();
+        }
+        break;
+      case STATE_FIXED:
+        value_ |= static_cast<uint64>(byte) << shift_;
+        shift_ += 8;
+        if (--remaining_ == 0) EndValue();
+        break;
+      case STATE_BYTES:
+        registers_[target_++] = byte;
+        if (--remaining_ == 0) NextValue();
+        break;
+      case STATE_SKIP:
+        if (--remaining_ == 0) NextValue();
+        break;
+      case STATE_FAILED:
+        return;
+    }
+
+    if (state_ == STATE_TAG && shift_ == 0) {
+      // Close the messages that end here.
+      while (depth_ > 0 && position_ == frames_[depth_].end) depth_--;
+    } else if (state_ != STATE_FAILED &&
+               position_ == (packed_end_ != 0 ? packed_end_
+                                              : frames_[depth_].end)) {
+      // Nothing else may end here.
+      state_ = STATE_FAILED;
+    }
+  }
+
+  // Returns the index in fields_ of field |number| of |type|, or -1.
+  int FindWireField(int type, uint32 number) const {
+    int begin = types_[type].first_field;
+    int end = types_[type].end_field;
+    while (begin < end) {
+      int middle = begin + (end - begin) / 2;
+      if (fields_[middle].number < number) {
+        begin = middle + 1;
+      } else {
+        end = middle;
+      }
+    }
+    if (begin < types_[type].end_field &&
+        fields_[begin].number == number) {
+      return begin;
+    }
+    return -1;
+  }
+
+  void EndTag() {
+    uint32 number = static_cast<uint32>(value_ >> 3);
+    int wire_type = static_cast<int>(value_ & 7);
+    if (number == 0 || value_ > 0xffffffffu) {
+      state_ = STATE_FAILED;
+      return;
+    }
+    field_ = FindWireField(frames_[depth_].type, number);
+    if (field_ >= 0) {
+      // Fields of the wrong wire type are skipped, as the parser does.
+      const WireField& field = fields_[field_];
+      bool packed = field.repeated && field.kind != WireField::KIND_MESSAGE &&
+          wire_type == internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED;
+      if (wire_type != field.wire_type && !packed) field_ = -1;
+    }
+    StartValue(wire_type);
+  }
+
+  void StartValue(int wire_type) {
+    value_ = 0;
+    shift_ = 0;
+    switch (wire_type) {
+      case internal::WireFormatLite::WIRETYPE_VARINT:
+        state_ = STATE_VARINT;
+        break;
+      case internal::WireFormatLite::WIRETYPE_FIXED64:
+        state_ = STATE_FIXED;
+        remaining_ = 8;
+        break;
+      case internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED:
+        state_ = STATE_LENGTH;
+        break;
+      case internal::WireFormatLite::WIRETYPE_FIXED32:
+        state_ = STATE_FIXED;
+        remaining_ = 4;
+        break;
+      default:
+        // Groups are not supported.
+        state_ = STATE_FAILED;
+        break;
+    }
+  }
+
+  // Moves on to the next element of a packed field, or to the next tag.
+  void NextValue() {
+    if (packed_end_ != 0 && position_ < packed_end_) {
+      StartValue(fields_[field_].wire_type);
+      return;
+    }
+    packed_end_ = 0;
+    state_ = STATE_TAG;
+    value_ = 0;
+    shift_ = 0;
+  }
+
+  // Counts another element of |field|, whose count is at *address, and
+  // points *address at the element.  Fails if the field is full.
+  bool AddElement(const WireField& field, uint32* address) {
+    uint32 count = static_cast<uint32>(
+        ReadRegisters(&registers_[*address], field.count_size));
+    if (count == field.max_count) {
+      state_ = STATE_FAILED;
+      return false;
+    }
+    WriteRegisters(count + 1, field.count_size, &registers_[*address]);
+    *address += field.count_size + count * field.element_size;
+    return true;
+  }
+
+  void EndLength() {
+    const Frame& frame = frames_[depth_];
+    if (value_ > frame.end - position_) {
+      state_ = STATE_FAILED;
+      return;
+    }
+    uint32 length = static_cast<uint32>(value_);
+    if (field_ < 0) {
+      remaining_ = length;
+      state_ = STATE_SKIP;
+      if (length == 0) NextValue();
+      return;
+    }
+
+    const WireField& field = fields_[field_];
+    uint32 address = frame.base + field.offset;
+    switch (field.kind) {
+      case WireField::KIND_BYTES:
+        if (length > field.max_count) {
+          state_ = STATE_FAILED;
+          return;
+        }
+        WriteRegisters(length, field.count_size, &registers_[address]);
+        target_ = address + field.count_size;
+        std::fill(registers_.begin() + target_,
+                  registers_.begin() + target_ + field.max_count, 0);
+        remaining_ = length;
+        state_ = STATE_BYTES;
+        if (length == 0) NextValue();
+        break;
+      case WireField::KIND_MESSAGE:
+        if (field.repeated && !AddElement(field, &address)) return;
+        depth_++;
+        frames_[depth_].type = field.message_type;
+        frames_[depth_].base = address;
+        frames_[depth_].end = position_ + length;
+        NextValue();
+        break;
+      default:
+        // A packed repeated field.
+        if (length == 0) {
+          NextValue();
+        } else {
+          packed_end_ = position_ + length;
+          StartValue(field.wire_type);
+        }
+        break;
+    }
+  }
+
+  void EndValue() {
+    if (field_ < 0) {
+      NextValue();
+      return;
+    }
+    const WireField& field = fields_[field_];
+    uint64 value = value_;
+    if (field.kind == WireField::KIND_ZIGZAG) {
+      value = (value >> 1) ^ (0 - (value & 1));
+    } else if (field.kind == WireField::KIND_BOOL) {
+      value = value != 0;
+    }
+    // Undeclared values of closed enums are dropped, as the parser does.
+    if (field.enum_values == NULL ||
+        std::binary_search(field.enum_values,
+                           field.enum_values + field.enum_value_count,
+                           static_cast<int32>(value))) {
+      uint32 address = frames_[depth_].base + field.offset;
+      if (field.repeated && !AddElement(field, &address)) return;
+      WriteRegisters(value, field.element_size, &registers_[address]);
+    }
+    NextValue();
+  }
+
+  const WireField* const fields_;
+  const WireType* const types_;
+  const int type_;
+  const int bytes_per_cycle_;
+  std::vector<uint8> registers_;
+  std::vector<Frame> frames_;
+  int depth_;
+  uint32 position_;
+  uint32 packed_end_;  // The end of the packed field being read, or zero.
+  int cycles_;
+
+  State state_;
+  int field_;  // The field being read in fields_, or -1 if skipping.
+  uint64 value_;
+  int shift_;
+  uint32 remaining_;
+  uint32 target_;
+};
+
+// Models an encoder.  Each step either emits a byte or moves on to the next
+// value to emit, queueing its tag and any length or varint.  Its arguments
+// are those of WireDecoderModel.
+class WireEncoderModel {
+ public:
+  WireEncoderModel(const WireField* fields, const WireType* types, int type,
+                   uint32 size, int depth, int bytes_per_cycle)
+      : fields_(fields), types_(types), type_(type),
+        bytes_per_cycle_(bytes_per_cycle), registers_(size), frames_(depth) {
+    Start();
+  }
+
+  void Reset(const uint8* registers) {
+    std::copy(registers, registers + registers_.size(), registers_.begin());
+    Start();
+  }
+
+  uint32 ByteSize() const { return MessageSize(type_, 0); }
+
+  int Cycle(uint8* target) {
+    int size = 0;
+    for (int i = 0; i < bytes_per_cycle_ && !done_; i++) {
+      if (Step(target + size)) size++;
+    }
+    cycles_++;
+    return size;
+  }
+
+  bool done() const { return done_; }
+  int cycles() const { return cycles_; }
+
+ private:
+  struct Frame {
+    int type;
+    uint32 base;     // Where the message's registers start.
+    int field;       // The next field to emit, in fields_.
+    uint32 element;  // The next element of the field to emit.
+  };
+
+  void Start() {
+    depth_ = 0;
+    Push(type_, 0);
+    queued_ = 0;
+    queue_position_ = 0;
+    copy_remaining_ = 0;
+    done_ = false;
+    cycles_ = 0;
+  }
+
+  void Push(int type, uint32 base) {
+    Frame& frame = frames_[depth_];
+    frame.type = type;
+    frame.base = base;
+    frame.field = types_[type].first_field;
+    frame.element = 0;
+  }
+
+  // Emits the next byte to *byte and returns true, or moves on and returns
+  // false.
+  bool Step(uint8* byte) {
+    if (queue_position_ < queued_) {
+      *byte = queue_[queue_position_++];
+      return true;
+    }
+    if (copy_remaining_ > 0) {
+      *byte = registers_[copy_address_++];
+      copy_remaining_--;
+      return true;
+    }
+    Advance();
+    return false;
+  }
+
+  void Advance() {
+    queued_ = 0;
+    queue_position_ = 0;
+    Frame& frame = frames_[depth_];
+    if (frame.field == types_[frame.type].end_field) {
+      if (depth_ == 0) {
+        done_ = true;
+      } else {
+        depth_--;
+      }
+      return;
+    }
+
+    const WireField& field = fields_[frame.field];
+    uint32 address = frame.base + field.offset;
+    if (!field.repeated) {
+      frame.field++;
+      if (field.kind == WireField::KIND_BYTES) {
+        uint32 length = static_cast<uint32>(
+            ReadRegisters(&registers_[address], field.count_size));
+        if (length == 0 && field.omit_zero) return;
+        QueueTag(field.number, internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+        QueueVarint(length);
+        copy_address_ = address + field.count_size;
+        copy_remaining_ = length;
+      } else if (field.kind == WireField::KIND_MESSAGE) {
+        QueueTag(field.number, internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+        QueueVarint(MessageSize(field.message_type, address));
+        depth_++;
+        Push(field.message_type, address);
+      } else {
+        uint64 value = ElementValue(field, address);
+        if (value == 0 && field.omit_zero) return;
+        QueueTag(field.number, field.wire_type);
+        QueueValue(field, value);
+      }
+      return;
+    }
+
+    uint32 count = static_cast<uint32>(
+        ReadRegisters(&registers_[address], field.count_size));
+    if (frame.element == count) {
+      frame.field++;
+      frame.element = 0;
+      return;
+    }
+    uint32 element =
+        address + field.count_size + frame.element * field.element_size;
+    frame.element++;
+    if (field.packed) {
+      if (frame.element == 1) {
+        QueueTag(field.number, internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+        QueueVarint(PackedSize(field, address));
+      }
+      QueueValue(field, ElementValue(field, element));
+    } else if (field.kind == WireField::KIND_MESSAGE) {
+      QueueTag(field.number, internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+      QueueVarint(MessageSize(field.message_type, element));
+      depth_++;
+      Push(field.message_type, element);
+    } else {
+      QueueTag(field.number, field.wire_type);
+      QueueValue(field, ElementValue(field, element));
+    }
+  }
+
+  void QueueVarint(uint64 value) {
+    while (value >= 0x80) {
+      queue_[queued_++] = static_cast<uint8>(value | 0x80);
+      value >>= 7;
+    }
+    queue_[queued_++] = static_cast<uint8>(value);
+  }
+
+  void QueueTag(uint32 number, int wire_type) {
+    QueueVarint((static_cast<uint64>(number) << 3) | wire_type);
+  }
+
+  void QueueValue(const WireField& field, uint64 value) {
+    if (field.wire_type == internal::WireFormatLite::WIRETYPE_VARINT) {
+      QueueVarint(value);
+    } else {
+      WriteRegisters(value, field.element_size, queue_ + queued_);
+      queued_ += field.element_size;
+    }
+  }
+
+  // Returns the element of |field| at |address| as it goes on the wire.
+  uint64 ElementValue(const WireField& field, uint32 address) const {
+    uint64 value = ReadRegisters(&registers_[address], field.element_size);
+    if (field.element_size == 4) {
+      uint32 low = static_cast<uint32>(value);
+      if (field.kind == WireField::KIND_SIGNED_VARINT) {
+        value = static_cast<uint64>(static_cast<int32>(low));
+      } else if (field.kind == WireField::KIND_ZIGZAG) {
+        value = (low << 1) ^ (0 - (low >> 31));
+      }
+    } else if (field.kind == WireField::KIND_ZIGZAG) {
+      value = (value << 1) ^ (0 - (value >> 63));
+    }
+    return value;
+  }
+
+  static uint32 VarintSize(uint64 value) {
+    uint32 size = 1;
+    while (value >= 0x80) {
+      value >>= 7;
+      size++;
+    }
+    return size;
+  }
+
+  static uint32 TagSize(const WireField& field) {
+    return VarintSize(static_cast<uint64>(field.number) << 3);
+  }
+
+  static uint32 ValueSize(const WireField& field, uint64 value) {
+    return field.wire_type == internal::WireFormatLite::WIRETYPE_VARINT ?
+        VarintSize(value) : field.element_size;
+  }
+
+  // Returns the size of the values of the packed |field| at |address|.
+  uint32 PackedSize(const WireField& field, uint32 address) const {
+    uint32 count = static_cast<uint32>(
+        ReadRegisters(&registers_[address], field.count_size));
+    uint32 size = 0;
+    for (uint32 i = 0; i < count; i++) {
+      uint32 element = address + field.count_size + i * field.element_size;
+      size += ValueSize(field, ElementValue(field, element));
+    }
+    return size;
+  }
+
+  uint32 MessageSize(int type, uint32 base) const {
+    uint32 size = 0;
+    for (int i = types_[type].first_field;
+         i < types_[type].end_field; i++) {
+      const WireField& field = fields_[i];
+      uint32 address = base + field.offset;
+      if (!field.repeated) {
+        if (field.kind == WireField::KIND_BYTES) {
+          uint32 length = static_cast<uint32>(
+              ReadRegisters(&registers_[address], field.count_size));
+          if (length == 0 && field.omit_zero) continue;
+          size += TagSize(field) + VarintSize(length) + length;
+        } else if (field.kind == WireField::KIND_MESSAGE) {
+          uint32 message_size = MessageSize(field.message_type, address);
+          size += TagSize(field) + VarintSize(message_size) + message_size;
+        } else {
+          uint64 value = ElementValue(field, address);
+          if (value == 0 && field.omit_zero) continue;
+          size += TagSize(field) + ValueSize(field, value);
+        }
+        continue;
+      }
+
+      uint32 count = static_cast<uint32>(
+          ReadRegisters(&registers_[address], field.count_size));
+      if (count == 0) continue;
+      if (field.packed) {
+        uint32 packed_size = PackedSize(field, address);
+        size += TagSize(field) + VarintSize(packed_size) + packed_size;
+        continue;
+      }
+      for (uint32 j = 0; j < count; j++) {
+        uint32 element = address + field.count_size + j * field.element_size;
+        size += TagSize(field);
+        if (field.kind == WireField::KIND_MESSAGE) {
+          uint32 message_size = MessageSize(field.message_type, element);
+          size += VarintSize(message_size) + message_size;
+        } else {
+          size += ValueSize(field, ElementValue(field, element));
+        }
+      }
+    }
+    return size;
+  }
+
+  const WireField* const fields_;
+  const WireType* const types_;
+  const int type_;
+  const int bytes_per_cycle_;
+  std::vector<uint8> registers_;
+  std::vector<Frame> frames_;
+  int depth_;
+  bool done_;
+  int cycles_;
+
+  // A tag with a length or value takes at most 20 bytes.
+  uint8 queue_[20];
+  int queued_;
+  int queue_position_;
+  uint32 copy_address_;  // The next byte of a string to emit.
+  uint32 copy_remaining_;
+};
+
+}  // namespace bsv
+}  // namespace compiler
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_COMPILER_BSV_WIRE_MODEL_H__
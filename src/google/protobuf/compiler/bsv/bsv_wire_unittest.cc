@@ -0,0 +1,578 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <memory>
+#ifndef _SHARED_PTR_H
+#include <google/protobuf/stubs/shared_ptr.h>
+#endif
+#include <vector>
+
+#include <google/protobuf/compiler/bsv/bsv_generator.h>
+#include <google/protobuf/compiler/bsv/bsv_register.h>
+#include <google/protobuf/compiler/bsv/bsv_register_unittest.pb.h>
+#include <google/protobuf/compiler/bsv/bsv_register_unittest.regs.h>
+#include <google/protobuf/compiler/bsv/bsv_register_unittest.wire.h>
+#include <google/protobuf/compiler/bsv/bsv_wire_unittest.pb.h>
+#include <google/protobuf/compiler/bsv/bsv_wire_unittest.regs.h>
+#include <google/protobuf/compiler/bsv/bsv_wire_unittest.wire.h>
+#include <google/protobuf/compiler/command_line_interface.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/util/message_differencer.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <google/protobuf/wire_format_lite_inl.h>
+
+#include <google/protobuf/stubs/stl_util.h>
+#include <google/protobuf/stubs/strutil.h>
+#include <google/protobuf/testing/file.h>
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace compiler {
+namespace bsv {
+namespace {
+
+using internal::WireFormatLite;
+using protobuf_unittest::RegisterAllTypes;
+using protobuf_unittest::RegisterBounded;
+using protobuf_unittest::WireSample;
+using protobuf_unittest::WireTrace;
+
+// A small deterministic generator, so that failures are reproducible.
+class Random {
+ public:
+  explicit Random(uint32 seed) : state_(seed) {}
+
+  uint32 Next() {
+    state_ = state_ * 1103515245 + 12345;
+    return state_ >> 8;
+  }
+  uint32 Uniform(uint32 n) { return Next() % n; }
+  uint64 Next64() { return (static_cast<uint64>(Next()) << 40) ^ Next(); }
+
+ private:
+  uint32 state_;
+};
+
+// Returns a random value for a scalar, biased towards zero and small values
+// so that proto3's omission of zeros and short varints are exercised.
+uint64 RandomBits(Random* random) {
+  switch (random->Uniform(4)) {
+    case 0: return 0;
+    case 1: return random->Uniform(200);
+    case 2: return -static_cast<int64>(random->Uniform(200));
+    default: return random->Next64();
+  }
+}
+
+// Sets every field of |message|, and of the messages it holds, to random
+// values within the bounds of the register encoding.
+void FillRandomly(Message* message, Random* random) {
+  const Descriptor* descriptor = message->GetDescriptor();
+  const Reflection* reflection = message->GetReflection();
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    const FieldDescriptor* field = descriptor->field(i);
+    int count = 1;
+    if (field->is_repeated()) {
+      count = random->Uniform(FieldSizeBound(field) + 1);
+    }
+    for (int j = 0; j < count; j++) {
+      uint64 bits = RandomBits(random);
+      switch (field->cpp_type()) {
+#define HANDLE_TYPE(CPPTYPE, TYPE, METHOD, VALUE)                   \
+        case FieldDescriptor::CPPTYPE_##CPPTYPE:                    \
+          if (field->is_repeated()) {                               \
+            reflection->Add##METHOD(message, field, (VALUE));       \
+          } else {                                                  \
+            reflection->Set##METHOD(message, field, (VALUE));       \
+          }                                                         \
+          break;
+
+        HANDLE_TYPE(INT32, int32, Int32, static_cast<int32>(bits));
+        HANDLE_TYPE(INT64, int64, Int64, static_cast<int64>(bits));
+        HANDLE_TYPE(UINT32, uint32, UInt32, static_cast<uint32>(bits));
+        HANDLE_TYPE(UINT64, uint64, UInt64, bits);
+        HANDLE_TYPE(BOOL, bool, Bool, (bits & 1) != 0);
+        // Quarters are exact, and avoid NaNs and negative zeros.
+        HANDLE_TYPE(FLOAT, float, Float,
+                    (static_cast<int32>(bits % 4001) - 2000) / 4.0f);
+        HANDLE_TYPE(DOUBLE, double, Double,
+                    (static_cast<int64>(bits % 40001) - 20000) / 4.0);
+#undef HANDLE_TYPE
+
+        case FieldDescriptor::CPPTYPE_ENUM: {
+          const EnumDescriptor* type = field->enum_type();
+          int value = type->value(random->Uniform(type->value_count()))
+                          ->number();
+          // Open enums may hold any value.
+          if (field->file()->syntax() == FileDescriptor::SYNTAX_PROTO3 &&
+              random->Uniform(4) == 0) {
+            value = static_cast<int32>(bits);
+          }
+          if (field->is_repeated()) {
+            reflection->AddEnumValue(message, field, value);
+          } else {
+            reflection->SetEnumValue(message, field, value);
+          }
+          break;
+        }
+        case FieldDescriptor::CPPTYPE_STRING: {
+          string value;
+          int length = random->Uniform(FieldSizeBound(field) + 1);
+          for (int k = 0; k < length; k++) {
+            // Strings must be UTF-8.
+            value.push_back(field->type() == FieldDescriptor::TYPE_STRING ?
+                            'a' + random->Uniform(26) :
+                            static_cast<char>(random->Next()));
+          }
+          if (field->is_repeated()) {
+            reflection->AddString(message, field, value);
+          } else {
+            reflection->SetString(message, field, value);
+          }
+          break;
+        }
+        case FieldDescriptor::CPPTYPE_MESSAGE:
+          // Message fields are always present in the register encoding.
+          FillRandomly(field->is_repeated() ?
+                           reflection->AddMessage(message, field) :
+                           reflection->MutableMessage(message, field),
+                       random);
+          break;
+      }
+    }
+  }
+}
+
+// Decodes |data| with |bytes_per_cycle|, feeding the decoder all the bytes it
+// will take each cycle.  Returns whether decoding succeeded, with the
+// registers in |registers| and the cycles taken in |cycles|.
+template <typename Decoder>
+bool Decode(const string& data, int bytes_per_cycle, int size,
+            string* registers, int* cycles) {
+  Decoder decoder(bytes_per_cycle);
+  decoder.Reset(data.size());
+  const uint8* bytes = reinterpret_cast<const uint8*>(data.data());
+  int position = 0;
+  while (!decoder.done() && !decoder.failed()) {
+    int consumed = decoder.Cycle(bytes + position, data.size() - position);
+    EXPECT_LE(consumed, bytes_per_cycle);
+    position += consumed;
+  }
+  *cycles = decoder.cycles();
+  if (decoder.failed()) return false;
+  EXPECT_EQ(static_cast<int>(data.size()), position);
+  registers->assign(reinterpret_cast<const char*>(decoder.registers()), size);
+  return true;
+}
+
+// Encodes the |registers| with |bytes_per_cycle|, returning the wire format.
+template <typename Encoder>
+string Encode(const string& registers, int bytes_per_cycle) {
+  Encoder encoder(bytes_per_cycle);
+  encoder.Reset(reinterpret_cast<const uint8*>(registers.data()));
+  vector<uint8> buffer(encoder.ByteSize() + bytes_per_cycle);
+  int position = 0;
+  while (!encoder.done()) {
+    position += encoder.Cycle(&buffer[position]);
+    GOOGLE_CHECK_LE(position, static_cast<int>(encoder.ByteSize()));
+  }
+  EXPECT_EQ(encoder.ByteSize(), static_cast<uint32>(position));
+  return string(reinterpret_cast<char*>(&buffer[0]), position);
+}
+
+string PackTrace(const WireTrace& message) {
+  string registers(protobuf_unittest::kWireTracePackedSize, '\0');
+  GOOGLE_CHECK(protobuf_unittest::PackWireTrace(
+      message, reinterpret_cast<uint8*>(string_as_array(&registers))));
+  return registers;
+}
+
+// Decodes |data| as a WireTrace one byte per cycle, returning false if the
+// decoder fails.
+bool DecodeTrace(const string& data, string* registers) {
+  int cycles;
+  return Decode<protobuf_unittest::WireTraceWireDecoder>(
+      data, 1, protobuf_unittest::kWireTracePackedSize, registers, &cycles);
+}
+
+// Checks that the codecs for Type agree with the C++ parser and serializer
+// on random messages, at several widths.
+template <typename Type, typename Decoder, typename Encoder>
+void TestRandomMessages(uint8* (*pack)(const Type&, uint8*), int size) {
+  const int kBytesPerCycle[] = { 1, 3, 8 };
+  Random random(301);
+  for (int i = 0; i < 50; i++) {
+    Type message;
+    FillRandomly(&message, &random);
+    string data = message.SerializeAsString();
+    string expected(size, '\0');
+    ASSERT_TRUE(pack(message, reinterpret_cast<uint8*>(
+        string_as_array(&expected))) != NULL);
+
+    for (int j = 0; j < GOOGLE_ARRAYSIZE(kBytesPerCycle); j++) {
+      int bytes_per_cycle = kBytesPerCycle[j];
+      SCOPED_TRACE(StrCat("message ", i, ", ", bytes_per_cycle,
+                          " bytes per cycle"));
+
+      // The decoder takes every byte it is offered.
+      string registers;
+      int cycles;
+      ASSERT_TRUE(Decode<Decoder>(data, bytes_per_cycle, size, &registers,
+                                  &cycles));
+      EXPECT_EQ(expected, registers);
+      EXPECT_EQ((static_cast<int>(data.size()) + bytes_per_cycle - 1) /
+                    bytes_per_cycle,
+                cycles);
+
+      // The encoder writes the fields in number order, as the serializer
+      // does, so the bytes match exactly.
+      string encoded = Encode<Encoder>(expected, bytes_per_cycle);
+      EXPECT_EQ(data, encoded);
+      Type parsed;
+      EXPECT_TRUE(parsed.ParseFromString(encoded));
+      EXPECT_TRUE(util::MessageDifferencer::Equals(message, parsed));
+    }
+  }
+}
+
+TEST(WireCodecTest, RandomAllTypes) {
+  TestRandomMessages<RegisterAllTypes,
+                     protobuf_unittest::RegisterAllTypesWireDecoder,
+                     protobuf_unittest::RegisterAllTypesWireEncoder>(
+      &protobuf_unittest::PackRegisterAllTypes,
+      protobuf_unittest::kRegisterAllTypesPackedSize);
+}
+
+TEST(WireCodecTest, RandomBounded) {
+  TestRandomMessages<RegisterBounded,
+                     protobuf_unittest::RegisterBoundedWireDecoder,
+                     protobuf_unittest::RegisterBoundedWireEncoder>(
+      &protobuf_unittest::PackRegisterBounded,
+      protobuf_unittest::kRegisterBoundedPackedSize);
+}
+
+TEST(WireCodecTest, RandomProto3) {
+  TestRandomMessages<WireTrace,
+                     protobuf_unittest::WireTraceWireDecoder,
+                     protobuf_unittest::WireTraceWireEncoder>(
+      &protobuf_unittest::PackWireTrace,
+      protobuf_unittest::kWireTracePackedSize);
+}
+
+TEST(WireCodecTest, EmptyMessage) {
+  WireTrace message;
+  message.mutable_head();
+  string registers;
+  EXPECT_TRUE(DecodeTrace("", &registers));
+  EXPECT_EQ(PackTrace(message), registers);
+
+  // Zeros are omitted, but message fields are always written.
+  EXPECT_EQ(string("\x62\x00", 2),
+            Encode<protobuf_unittest::WireTraceWireEncoder>(registers, 4));
+}
+
+TEST(WireCodecTest, DecoderStallsWithoutData) {
+  WireSample message;
+  message.set_x(-3);
+  string data = message.SerializeAsString();
+
+  protobuf_unittest::WireSampleWireDecoder decoder(4);
+  decoder.Reset(data.size());
+  const uint8* bytes = reinterpret_cast<const uint8*>(data.data());
+  EXPECT_EQ(1, decoder.Cycle(bytes, 1));
+  EXPECT_EQ(0, decoder.Cycle(bytes + 1, 0));
+  EXPECT_FALSE(decoder.done());
+  EXPECT_EQ(1, decoder.Cycle(bytes + 1, 1));
+  EXPECT_TRUE(decoder.done());
+  EXPECT_FALSE(decoder.failed());
+  EXPECT_EQ(3, decoder.cycles());
+}
+
+TEST(WireCodecTest, UnknownFieldsAreSkipped) {
+  WireTrace message;
+  message.set_id(7);
+  message.mutable_head()->set_x(-1);
+  string data = message.SerializeAsString();
+
+  {
+    io::StringOutputStream output(&data);
+    io::CodedOutputStream coded(&output);
+    WireFormatLite::WriteUInt64(99, 12345678901ULL, &coded);
+    WireFormatLite::WriteString(100, "unknown", &coded);
+    WireFormatLite::WriteFixed32(101, 5, &coded);
+    WireFormatLite::WriteFixed64(102, 6, &coded);
+    WireFormatLite::WriteBytes(103, "", &coded);
+  }
+
+  string registers;
+  ASSERT_TRUE(DecodeTrace(data, &registers));
+  EXPECT_EQ(PackTrace(message), registers);
+}
+
+TEST(WireCodecTest, WrongWireTypesAreSkipped) {
+  string data;
+  {
+    io::StringOutputStream output(&data);
+    io::CodedOutputStream coded(&output);
+    WireFormatLite::WriteFixed32(1, 5, &coded);    // id is a varint.
+    WireFormatLite::WriteInt32(2, 5, &coded);      // label is a string.
+    WireFormatLite::WriteString(4, "abcd", &coded);  // ratio is a float.
+    WireFormatLite::WriteInt32(12, 5, &coded);     // head is a message.
+    WireFormatLite::WriteInt32(5, 1, &coded);
+  }
+
+  WireTrace expected;
+  ASSERT_TRUE(expected.ParseFromString(data));
+  EXPECT_TRUE(expected.enabled());
+  expected.mutable_head();
+
+  string registers;
+  ASSERT_TRUE(DecodeTrace(data, &registers));
+  EXPECT_EQ(PackTrace(expected), registers);
+}
+
+TEST(WireCodecTest, PackedAndUnpackedAreAccepted) {
+  string data;
+  {
+    io::StringOutputStream output(&data);
+    io::CodedOutputStream coded(&output);
+    // values is declared packed, and unpacked is not; each is written both
+    // ways, interleaved.
+    WireFormatLite::WriteTag(8, WireFormatLite::WIRETYPE_LENGTH_DELIMITED,
+                             &coded);
+    coded.WriteVarint32(3);
+    coded.WriteVarint32(2);
+    coded.WriteVarint32(300);
+    WireFormatLite::WriteTag(11, WireFormatLite::WIRETYPE_LENGTH_DELIMITED,
+                             &coded);
+    coded.WriteVarint32(2);
+    coded.WriteVarint32(4);
+    coded.WriteVarint32(5);
+    WireFormatLite::WriteInt32(8, 1, &coded);
+    WireFormatLite::WriteTag(8, WireFormatLite::WIRETYPE_LENGTH_DELIMITED,
+                             &coded);
+    coded.WriteVarint32(0);
+    WireFormatLite::WriteInt64(11, -6, &coded);
+  }
+
+  WireTrace expected;
+  expected.add_values(2);
+  expected.add_values(300);
+  expected.add_values(1);
+  expected.add_unpacked(4);
+  expected.add_unpacked(5);
+  expected.add_unpacked(-6);
+
+  string registers;
+  ASSERT_TRUE(DecodeTrace(data, &registers));
+  EXPECT_EQ(PackTrace(expected), registers);
+}
+
+TEST(WireCodecTest, UndeclaredClosedEnumValuesAreDropped) {
+  string data;
+  {
+    io::StringOutputStream output(&data);
+    io::CodedOutputStream coded(&output);
+    WireFormatLite::WriteEnum(6, 5, &coded);
+    WireFormatLite::WriteEnum(6, 2, &coded);
+  }
+
+  // Only the declared value counts against the bound of one.
+  string registers;
+  int cycles;
+  ASSERT_TRUE(Decode<protobuf_unittest::RegisterBoundedWireDecoder>(
+      data, 2, protobuf_unittest::kRegisterBoundedPackedSize, &registers,
+      &cycles));
+
+  RegisterBounded expected;
+  expected.add_colors(protobuf_unittest::REGISTER_BLUE);
+  string packed(protobuf_unittest::kRegisterBoundedPackedSize, '\0');
+  protobuf_unittest::PackRegisterBounded(
+      expected, reinterpret_cast<uint8*>(string_as_array(&packed)));
+  EXPECT_EQ(packed, registers);
+
+  // Open enums keep them.
+  data.clear();
+  {
+    io::StringOutputStream output(&data);
+    io::CodedOutputStream coded(&output);
+    WireFormatLite::WriteEnum(6, 5, &coded);
+  }
+  WireTrace trace;
+  trace.set_shape(static_cast<protobuf_unittest::WireShape>(5));
+  trace.mutable_head();
+  ASSERT_TRUE(DecodeTrace(data, &registers));
+  EXPECT_EQ(PackTrace(trace), registers);
+}
+
+TEST(WireCodecTest, BoundsAreEnforced) {
+  WireTrace message;
+  for (int i = 0; i < 6; i++) message.add_values(i);
+  message.set_label("0123456789");
+  string registers;
+  EXPECT_TRUE(DecodeTrace(message.SerializeAsString(), &registers));
+
+  message.add_values(6);
+  EXPECT_FALSE(DecodeTrace(message.SerializeAsString(), &registers));
+
+  message.mutable_values()->RemoveLast();
+  message.set_label("0123456789a");
+  EXPECT_FALSE(DecodeTrace(message.SerializeAsString(), &registers));
+
+  message.clear_label();
+  for (int i = 0; i < 3; i++) message.add_segments();
+  EXPECT_FALSE(DecodeTrace(message.SerializeAsString(), &registers));
+}
+
+TEST(WireCodecTest, MalformedInputFails) {
+  string registers;
+  // A group.
+  EXPECT_FALSE(DecodeTrace(string("\x0b\x0c", 2), &registers));
+  // Field number zero.
+  EXPECT_FALSE(DecodeTrace(string("\x00\x00", 2), &registers));
+  // A varint cut short by the end of the message.
+  EXPECT_FALSE(DecodeTrace(string("\x08\x80", 2), &registers));
+  // A length running past the end of the message.
+  EXPECT_FALSE(DecodeTrace(string("\x12\x05" "abc", 5), &registers));
+  // A value running past the end of the message holding it.
+  EXPECT_FALSE(DecodeTrace(string("\x62\x01\x08\x05", 4), &registers));
+  // A packed value running past the end of the field.
+  EXPECT_FALSE(DecodeTrace(string("\x42\x01\x80\x01", 4), &registers));
+  // A varint of more than ten bytes.
+  EXPECT_FALSE(DecodeTrace(string("\x08") + string(10, '\x80') + "\x01",
+                           &registers));
+}
+
+// -------------------------------------------------------------------
+
+TEST(WireGeneratorTest, GroupsAreRejected) {
+  GOOGLE_CHECK_OK(File::SetContents(TestTempDir() + "/wire_group.proto",
+                             "syntax = \"proto2\";\n"
+                             "message Foo {\n"
+                             "  required group Bar = 1 {\n"
+                             "    required int32 x = 2;\n"
+                             "  }\n"
+                             "}\n",
+                             true));
+
+  CommandLineInterface cli;
+  cli.SetInputsAreProtoPathRelative(true);
+  Generator bsv_generator;
+  cli.RegisterGenerator("--bsv_out", &bsv_generator, "");
+
+  string proto_path = "-I" + TestTempDir();
+  string bsv_out = "--bsv_out=wire:" + TestTempDir();
+  const char* argv[] = {
+    "protoc",
+    proto_path.c_str(),
+    bsv_out.c_str(),
+    "wire_group.proto"
+  };
+  EXPECT_NE(0, cli.Run(4, argv));
+  EXPECT_FALSE(File::Exists(TestTempDir() + "/wire_group.wire.h"));
+}
+
+TEST(WireGeneratorTest, Outputs) {
+  GOOGLE_CHECK_OK(File::SetContents(TestTempDir() + "/wire.proto",
+                             "syntax = \"proto3\";\n"
+                             "package foo.bar;\n"
+                             "message Point {\n"
+                             "  sint32 x = 1;\n"
+                             "}\n",
+                             true));
+
+  CommandLineInterface cli;
+  cli.SetInputsAreProtoPathRelative(true);
+  Generator bsv_generator;
+  cli.RegisterGenerator("--bsv_out", &bsv_generator, "");
+
+  string proto_path = "-I" + TestTempDir();
+  string bsv_out = "--bsv_out=wire:" + TestTempDir();
+  const char* argv[] = {
+    "protoc",
+    proto_path.c_str(),
+    bsv_out.c_str(),
+    "wire.proto"
+  };
+  ASSERT_EQ(0, cli.Run(4, argv));
+
+  // "wire" implies "register".
+  EXPECT_TRUE(File::Exists(TestTempDir() + "/wire.regs.h"));
+  EXPECT_TRUE(File::Exists(TestTempDir() + "/wire.wire.h"));
+  EXPECT_TRUE(File::Exists(TestTempDir() + "/wire.wire.cc"));
+
+  string bsv;
+  GOOGLE_CHECK_OK(File::GetContents(TestTempDir() + "/wire_wire.bsv", &bsv,
+                             true));
+  EXPECT_TRUE(HasPrefixString(bsv,
+      "// Generated by the protocol buffer compiler.  DO NOT EDIT!\n"
+      "// source: wire.proto\n")) << bsv;
+  EXPECT_NE(string::npos, bsv.find("package wire_wire;\n")) << bsv;
+  EXPECT_NE(string::npos, bsv.find("import wire_pb::*;\n")) << bsv;
+  EXPECT_NE(string::npos, bsv.find("module mkPointWireDecoder(")) << bsv;
+  EXPECT_NE(string::npos, bsv.find("module mkPointWireEncoder(")) << bsv;
+
+  // The machines and models are shared, not written into every file.
+  EXPECT_NE(string::npos, bsv.find("import ProtobufWire::*;\n")) << bsv;
+  EXPECT_NE(string::npos, bsv.find("wireSchema()")) << bsv;
+  EXPECT_EQ(string::npos, bsv.find("function WireDecoderState")) << bsv;
+  string source;
+  GOOGLE_CHECK_OK(File::GetContents(TestTempDir() + "/wire.wire.cc", &source,
+                             true));
+  EXPECT_NE(string::npos, source.find(
+      "#include <google/protobuf/compiler/bsv/bsv_wire_model.h>\n"))
+      << source;
+  EXPECT_EQ(string::npos, source.find("class WireDecoderModel")) << source;
+}
+
+TEST(WireGeneratorTest, SharedPackage) {
+  // The package the generated BSV imports defines what it uses.
+  string package;
+  GOOGLE_CHECK_OK(File::GetContents(
+      TestSourceDir() + "/google/protobuf/compiler/bsv/ProtobufWire.bsv",
+      &package, true));
+  EXPECT_NE(string::npos, package.find("package ProtobufWire;\n"));
+  EXPECT_NE(string::npos, package.find("interface WireSchema#("));
+  EXPECT_NE(string::npos, package.find(") decodeByte(\n"));
+  EXPECT_NE(string::npos, package.find(") encodeStep(\n"));
+  EXPECT_NE(string::npos, package.find(") wireDecoderStart("));
+  EXPECT_NE(string::npos, package.find(") wireEncoderStart(\n"));
+}
+
+}  // namespace
+}  // namespace bsv
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
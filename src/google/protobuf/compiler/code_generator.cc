@@ -44,6 +44,10 @@ namespace compiler {
 CodeGenerator::~CodeGenerator() {}
 GeneratorContext::~GeneratorContext() {}
 
+bool CodeGenerator::IsThreadSafe() const {
+  return false;
+}
+
 io::ZeroCopyOutputStream*
 GeneratorContext::OpenForAppend(const string& filename) {
   return NULL;
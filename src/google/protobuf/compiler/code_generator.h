@@ -79,6 +79,12 @@ class LIBPROTOC_EXPORT CodeGenerator {
                         GeneratorContext* generator_context,
                         string* error) const = 0;
 
+  // Returns true if Generate() may be called from several threads at once,
+  // for different files.  When protoc is run with -j, generators which
+  // return false here still run in parallel with other generators, but
+  // every call to a given generator is made from the same thread, in order.
+  virtual bool IsThreadSafe() const;
+
  private:
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(CodeGenerator);
 };
@@ -47,6 +47,12 @@
 #include <errno.h>
 #include <iostream>
 #include <ctype.h>
+#include <limits.h>
+#ifndef _WIN32
+#include <pthread.h>  // On Windows, subprocess.h brings in windows.h.
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
 
 #include <memory>
 #ifndef _SHARED_PTR_H
@@ -61,6 +67,7 @@
 #include <google/protobuf/compiler/subprocess.h>
 #include <google/protobuf/compiler/zip_writer.h>
 #include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor_database.h>
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/dynamic_message.h>
 #include <google/protobuf/io/coded_stream.h>
@@ -121,6 +128,53 @@ static bool IsWindowsAbsolutePath(const string& text) {
 #endif
 }
 
+#ifdef _WIN32
+DWORD WINAPI RunClosureThread(LPVOID closure) {
+  reinterpret_cast<Closure*>(closure)->Run();
+  return 0;
+}
+#else
+void* RunClosureThread(void* closure) {
+  reinterpret_cast<Closure*>(closure)->Run();
+  return NULL;
+}
+#endif
+
+// Runs the given permanent callback on num_threads threads, one of which is
+// the calling thread, and waits for all of them to return.
+void RunOnThreads(int num_threads, Closure* callback) {
+#ifdef _WIN32
+  vector<HANDLE> threads;
+  for (int i = 1; i < num_threads; i++) {
+    HANDLE thread = CreateThread(NULL, 0, &RunClosureThread, callback, 0, NULL);
+    if (thread == NULL) {
+      // Out of threads; the ones we already have will pick up the slack.
+      break;
+    }
+    threads.push_back(thread);
+  }
+  callback->Run();
+  for (int i = 0; i < threads.size(); i++) {
+    WaitForSingleObject(threads[i], INFINITE);
+    CloseHandle(threads[i]);
+  }
+#else
+  vector<pthread_t> threads;
+  for (int i = 1; i < num_threads; i++) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, &RunClosureThread, callback) != 0) {
+      // Out of threads; the ones we already have will pick up the slack.
+      break;
+    }
+    threads.push_back(thread);
+  }
+  callback->Run();
+  for (int i = 0; i < threads.size(); i++) {
+    pthread_join(threads[i], NULL);
+  }
+#endif
+}
+
 void SetFdToTextMode(int fd) {
 #ifdef _WIN32
   if (_setmode(fd, _O_TEXT) == -1) {
@@ -181,6 +235,103 @@ bool TryCreateParentDirectory(const string& prefix, const string& filename) {
   return true;
 }
 
+#ifndef _WIN32
+// Sends |request| to the plugin server listening on |socket_path| and reads
+// its response.  See plugin.h for the protocol.
+bool CallPluginServer(const string& socket_path, const Message& request,
+                      Message* response, string* error) {
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(address.sun_path)) {
+    *error = "Socket path is too long: " + socket_path;
+    return false;
+  }
+  memcpy(address.sun_path, socket_path.data(), socket_path.size());
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd == -1) {
+    *error = strerror(errno);
+    return false;
+  }
+#ifdef SO_NOSIGPIPE
+  int on = 1;
+  setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+  int send_flags = 0;
+#ifdef MSG_NOSIGNAL
+  send_flags = MSG_NOSIGNAL;
+#endif
+
+  if (connect(fd, reinterpret_cast<struct sockaddr*>(&address),
+              sizeof(address)) == -1) {
+    *error = socket_path + ": " + strerror(errno);
+    close(fd);
+    return false;
+  }
+
+  string request_data;
+  request.SerializeToString(&request_data);
+  const char* data = request_data.data();
+  int remaining = request_data.size();
+  while (remaining > 0) {
+    int n = send(fd, data, remaining, send_flags);
+    if (n == -1) {
+      if (errno == EINTR) continue;
+      *error = "Error sending request to plugin server: " +
+               string(strerror(errno));
+      close(fd);
+      return false;
+    }
+    data += n;
+    remaining -= n;
+  }
+  shutdown(fd, SHUT_WR);
+
+  string response_data;
+  char buffer[4096];
+  while (true) {
+    int n = read(fd, buffer, sizeof(buffer));
+    if (n == 0) break;
+    if (n == -1) {
+      if (errno == EINTR) continue;
+      *error = "Error reading response from plugin server: " +
+               string(strerror(errno));
+      close(fd);
+      return false;
+    }
+    response_data.append(buffer, n);
+  }
+  close(fd);
+
+  // The response is prefixed with its size.  Anything shorter means the
+  // server went away before finishing it.
+  io::CodedInputStream input(
+      reinterpret_cast<const uint8*>(response_data.data()),
+      response_data.size());
+  uint32 size;
+  if (!input.ReadVarint32(&size) ||
+      response_data.size() - input.CurrentPosition() != size) {
+    *error = "Plugin server closed the connection without a complete "
+             "response.";
+    return false;
+  }
+  if (!response->ParseFromArray(
+          response_data.data() + input.CurrentPosition(), size)) {
+    *error = "Plugin server's response could not be parsed.";
+    return false;
+  }
+  return true;
+}
+#else  // _WIN32
+// --plugin_server is rejected on Windows, so this is never called.
+bool CallPluginServer(const string& socket_path, const Message& request,
+                      Message* response, string* error) {
+  *error = "Plugin servers are not supported on Windows.";
+  return false;
+}
+#endif  // _WIN32
+
 }  // namespace
 
 // A MultiFileErrorCollector that prints errors to stderr.
@@ -594,6 +745,205 @@ CommandLineInterface::MemoryOutputStream::~MemoryOutputStream() {
   }
 }
 
+// -------------------------------------------------------------------
+
+// A GeneratorContext which just remembers everything written to it.  Used by
+// -j so that generators can run on worker threads without touching the
+// shared GeneratorContextImpl; the recorded files are replayed into it
+// afterwards.
+class CommandLineInterface::RecordingGeneratorContext
+    : public GeneratorContext {
+ public:
+  RecordingGeneratorContext(const vector<const FileDescriptor*>& parsed_files);
+  ~RecordingGeneratorContext();
+
+  // Write every recorded file to target, in the order in which the streams
+  // returned by Open() etc. were closed.
+  void Replay(GeneratorContext* target);
+
+  // Save or restore the recorded files, for --cache_dir.  ParseFromString()
+  // returns false if data is corrupt.
+  void SerializeToString(string* output) const;
+  bool ParseFromString(const string& data);
+
+  // implements GeneratorContext --------------------------------------
+  io::ZeroCopyOutputStream* Open(const string& filename);
+  io::ZeroCopyOutputStream* OpenForAppend(const string& filename);
+  io::ZeroCopyOutputStream* OpenForInsert(
+      const string& filename, const string& insertion_point);
+  void ListParsedFiles(vector<const FileDescriptor*>* output) {
+    *output = parsed_files_;
+  }
+
+ private:
+  class RecordingOutputStream;
+
+  struct RecordedFile {
+    string filename;
+    string insertion_point;  // Empty unless opened with OpenForInsert().
+    bool append_mode;
+    string data;
+  };
+
+  const vector<const FileDescriptor*>& parsed_files_;
+  vector<RecordedFile*> files_;
+};
+
+class CommandLineInterface::RecordingGeneratorContext::RecordingOutputStream
+    : public io::ZeroCopyOutputStream {
+ public:
+  RecordingOutputStream(RecordingGeneratorContext* context,
+                        RecordedFile* file)
+      : context_(context),
+        file_(file),
+        inner_(new io::StringOutputStream(&file->data)) {}
+  virtual ~RecordingOutputStream() {
+    inner_.reset();
+    context_->files_.push_back(file_);
+  }
+
+  // implements ZeroCopyOutputStream ---------------------------------
+  virtual bool Next(void** data, int* size) { return inner_->Next(data, size); }
+  virtual void BackUp(int count)            {        inner_->BackUp(count);    }
+  virtual int64 ByteCount() const           { return inner_->ByteCount();      }
+
+ private:
+  RecordingGeneratorContext* context_;
+  RecordedFile* file_;
+  google::protobuf::scoped_ptr<io::StringOutputStream> inner_;
+};
+
+CommandLineInterface::RecordingGeneratorContext::RecordingGeneratorContext(
+    const vector<const FileDescriptor*>& parsed_files)
+    : parsed_files_(parsed_files) {
+}
+
+CommandLineInterface::RecordingGeneratorContext::~RecordingGeneratorContext() {
+  STLDeleteElements(&files_);
+}
+
+void CommandLineInterface::RecordingGeneratorContext::Replay(
+    GeneratorContext* target) {
+  for (int i = 0; i < files_.size(); i++) {
+    const RecordedFile& file = *files_[i];
+    google::protobuf::scoped_ptr<io::ZeroCopyOutputStream> output;
+    if (!file.insertion_point.empty()) {
+      output.reset(target->OpenForInsert(file.filename, file.insertion_point));
+    } else if (file.append_mode) {
+      output.reset(target->OpenForAppend(file.filename));
+    } else {
+      output.reset(target->Open(file.filename));
+    }
+
+    // The CodedOutputStream must be destroyed before output is closed.
+    io::CodedOutputStream writer(output.get());
+    writer.WriteString(file.data);
+  }
+}
+
+void CommandLineInterface::RecordingGeneratorContext::SerializeToString(
+    string* output) const {
+  output->clear();
+  io::StringOutputStream output_stream(output);
+  io::CodedOutputStream coded_output(&output_stream);
+  coded_output.WriteVarint32(files_.size());
+  for (int i = 0; i < files_.size(); i++) {
+    const RecordedFile& file = *files_[i];
+    coded_output.WriteVarint32(file.filename.size());
+    coded_output.WriteString(file.filename);
+    coded_output.WriteVarint32(file.insertion_point.size());
+    coded_output.WriteString(file.insertion_point);
+    coded_output.WriteVarint32(file.append_mode);
+    coded_output.WriteVarint32(file.data.size());
+    coded_output.WriteString(file.data);
+  }
+}
+
+bool CommandLineInterface::RecordingGeneratorContext::ParseFromString(
+    const string& data) {
+  STLDeleteElements(&files_);
+  io::CodedInputStream input(reinterpret_cast<const uint8*>(data.data()),
+                             data.size());
+  input.SetTotalBytesLimit(INT_MAX, -1);
+
+  uint32 count;
+  if (!input.ReadVarint32(&count)) return false;
+  for (int i = 0; i < count; i++) {
+    RecordedFile* file = new RecordedFile;
+    files_.push_back(file);
+    uint32 size, append_mode;
+    if (!input.ReadVarint32(&size) ||
+        !input.ReadString(&file->filename, size) ||
+        !input.ReadVarint32(&size) ||
+        !input.ReadString(&file->insertion_point, size) ||
+        !input.ReadVarint32(&append_mode) ||
+        !input.ReadVarint32(&size) ||
+        !input.ReadString(&file->data, size)) {
+      STLDeleteElements(&files_);
+      return false;
+    }
+    file->append_mode = append_mode != 0;
+  }
+  return input.ExpectAtEnd();
+}
+
+io::ZeroCopyOutputStream*
+CommandLineInterface::RecordingGeneratorContext::Open(const string& filename) {
+  RecordedFile* file = new RecordedFile;
+  file->filename = filename;
+  file->append_mode = false;
+  return new RecordingOutputStream(this, file);
+}
+
+io::ZeroCopyOutputStream*
+CommandLineInterface::RecordingGeneratorContext::OpenForAppend(
+    const string& filename) {
+  RecordedFile* file = new RecordedFile;
+  file->filename = filename;
+  file->append_mode = true;
+  return new RecordingOutputStream(this, file);
+}
+
+io::ZeroCopyOutputStream*
+CommandLineInterface::RecordingGeneratorContext::OpenForInsert(
+    const string& filename, const string& insertion_point) {
+  RecordedFile* file = new RecordedFile;
+  file->filename = filename;
+  file->insertion_point = insertion_point;
+  file->append_mode = false;
+  return new RecordingOutputStream(this, file);
+}
+
+// -------------------------------------------------------------------
+
+// One call to GenerateOutputForFiles() made by GenerateOutputInParallel().
+struct CommandLineInterface::GenerationJob {
+  GenerationJob(const vector<const FileDescriptor*>& parsed_files)
+      : directive(NULL), output_directory(NULL), context(parsed_files),
+        success(false) {}
+
+  const OutputDirective* directive;
+  vector<const FileDescriptor*> files;
+  string parameters;
+  GeneratorContextImpl* output_directory;
+  RecordingGeneratorContext context;
+  string error;
+  bool success;
+
+  // Key under which the output is stored in the --cache_dir cache, or empty
+  // if the output should not be cached.
+  string cache_key;
+};
+
+// Work shared between the threads started by GenerateOutputInParallel().
+// Each lane is a list of jobs which must run in order on a single thread.
+struct CommandLineInterface::GenerationQueue {
+  vector<vector<GenerationJob*> > lanes;
+  ContentCache* cache;  // NULL unless --cache_dir was given.
+  Mutex mutex;
+  int next_lane;  // Under mutex.
+};
+
 // ===================================================================
 
 CommandLineInterface::CommandLineInterface()
@@ -603,7 +953,8 @@ CommandLineInterface::CommandLineInterface()
     imports_in_descriptor_set_(false),
     source_info_in_descriptor_set_(false),
     disallow_services_(false),
-    inputs_are_proto_path_relative_(false) {}
+    inputs_are_proto_path_relative_(false),
+    jobs_(1) {}
 CommandLineInterface::~CommandLineInterface() {}
 
 void CommandLineInterface::RegisterGenerator(const string& flag_name,
@@ -657,9 +1008,21 @@ int CommandLineInterface::Run(int argc, const char* const argv[]) {
     }
   }
 
+  // Set up the cache.
+  google::protobuf::scoped_ptr<DiskContentCache> cache;
+  if (!cache_dir_.empty()) {
+    string cache_dir = cache_dir_;
+    AddTrailingSlash(&cache_dir);
+    if (!VerifyDirectoryExists(cache_dir)) {
+      return 1;
+    }
+    cache.reset(new DiskContentCache(cache_dir));
+  }
+
   // Allocate the Importer.
   ErrorPrinter error_collector(error_format_, &source_tree);
   Importer importer(&source_tree, &error_collector);
+  importer.UseCache(cache.get());
 
   vector<const FileDescriptor*> parsed_files;
 
@@ -687,6 +1050,9 @@ int CommandLineInterface::Run(int argc, const char* const argv[]) {
 
   // Generate output.
   if (mode_ == MODE_COMPILE) {
+    // Output location of each directive, for GenerateOutputInParallel().
+    vector<GeneratorContextImpl*> directive_directories;
+
     for (int i = 0; i < output_directives_.size(); i++) {
       string output_location = output_directives_[i].output_location;
       if (!HasSuffixString(output_location, ".zip") &&
@@ -700,11 +1066,21 @@ int CommandLineInterface::Run(int argc, const char* const argv[]) {
         *map_slot = new GeneratorContextImpl(parsed_files);
       }
 
-      if (!GenerateOutput(parsed_files, output_directives_[i], *map_slot)) {
+      if (jobs_ > 1 || cache != NULL) {
+        directive_directories.push_back(*map_slot);
+      } else if (!GenerateOutput(parsed_files, output_directives_[i],
+                                 *map_slot)) {
         STLDeleteValues(&output_directories);
         return 1;
       }
     }
+
+    if ((jobs_ > 1 || cache != NULL) &&
+        !GenerateOutputInParallel(parsed_files, directive_directories,
+                                  cache.get())) {
+      STLDeleteValues(&output_directories);
+      return 1;
+    }
   }
 
   // Write all output to disk.
@@ -744,6 +1120,12 @@ int CommandLineInterface::Run(int argc, const char* const argv[]) {
     }
   }
 
+  if (!descriptor_image_name_.empty()) {
+    if (!WriteDescriptorImage(parsed_files)) {
+      return 1;
+    }
+  }
+
   if (mode_ == MODE_ENCODE || mode_ == MODE_DECODE) {
     if (codec_type_.empty()) {
       // HACK:  Define an EmptyMessage type to use for decoding.
@@ -794,6 +1176,7 @@ void CommandLineInterface::Clear() {
   output_directives_.clear();
   codec_type_.clear();
   descriptor_set_name_.clear();
+  descriptor_image_name_.clear();
   dependency_out_name_.clear();
 
   mode_ = MODE_COMPILE;
@@ -801,6 +1184,8 @@ void CommandLineInterface::Clear() {
   imports_in_descriptor_set_ = false;
   source_info_in_descriptor_set_ = false;
   disallow_services_ = false;
+  jobs_ = 1;
+  cache_dir_.clear();
 }
 
 bool CommandLineInterface::MakeInputsBeProtoPathRelative(
@@ -893,7 +1278,7 @@ CommandLineInterface::ParseArguments(int argc, const char* const argv[]) {
     return PARSE_ARGUMENT_FAIL;
   }
   if (mode_ == MODE_COMPILE && output_directives_.empty() &&
-      descriptor_set_name_.empty()) {
+      descriptor_set_name_.empty() && descriptor_image_name_.empty()) {
     std::cerr << "Missing output directives." << std::endl;
     return PARSE_ARGUMENT_FAIL;
   }
@@ -1052,6 +1437,23 @@ CommandLineInterface::InterpretArgument(const string& name,
     }
     descriptor_set_name_ = value;
 
+  } else if (name == "--descriptor_image_out") {
+    if (!descriptor_image_name_.empty()) {
+      std::cerr << name << " may only be passed once." << std::endl;
+      return PARSE_ARGUMENT_FAIL;
+    }
+    if (value.empty()) {
+      std::cerr << name << " requires a non-empty value." << std::endl;
+      return PARSE_ARGUMENT_FAIL;
+    }
+    if (mode_ != MODE_COMPILE) {
+      std::cerr
+          << "Cannot use --encode or --decode and generate descriptors at the "
+             "same time." << std::endl;
+      return PARSE_ARGUMENT_FAIL;
+    }
+    descriptor_image_name_ = value;
+
   } else if (name == "--dependency_out") {
     if (!dependency_out_name_.empty()) {
       cerr << name << " may only be passed once." << endl;
@@ -1100,7 +1502,8 @@ CommandLineInterface::InterpretArgument(const string& name,
                 << std::endl;
       return PARSE_ARGUMENT_FAIL;
     }
-    if (!output_directives_.empty() || !descriptor_set_name_.empty()) {
+    if (!output_directives_.empty() || !descriptor_set_name_.empty() ||
+        !descriptor_image_name_.empty()) {
       std::cerr << "Cannot use " << name
                 << " and generate code or descriptors at the same time."
                 << std::endl;
@@ -1123,6 +1526,20 @@ CommandLineInterface::InterpretArgument(const string& name,
 
     codec_type_ = value;
 
+  } else if (name == "-j" || name == "--jobs") {
+    if (!safe_strto32(value, &jobs_) || jobs_ < 1) {
+      std::cerr << name << " requires a positive number of threads."
+                << std::endl;
+      return PARSE_ARGUMENT_FAIL;
+    }
+
+  } else if (name == "--cache_dir") {
+    if (value.empty()) {
+      std::cerr << name << " requires a non-empty value." << std::endl;
+      return PARSE_ARGUMENT_FAIL;
+    }
+    cache_dir_ = value;
+
   } else if (name == "--error_format") {
     if (value == "gcc") {
       error_format_ = ERROR_FORMAT_GCC;
@@ -1159,6 +1576,25 @@ CommandLineInterface::InterpretArgument(const string& name,
 
     plugins_[plugin_name] = path;
 
+  } else if (name == "--plugin_server") {
+    if (plugin_prefix_.empty()) {
+      std::cerr << "This compiler does not support plugins." << std::endl;
+      return PARSE_ARGUMENT_FAIL;
+    }
+#ifdef _WIN32
+    std::cerr << name << " is not supported on Windows." << std::endl;
+    return PARSE_ARGUMENT_FAIL;
+#else
+    string::size_type equals_pos = value.find_first_of('=');
+    if (equals_pos == string::npos) {
+      std::cerr << name << " requires a value of the form NAME=SOCKET."
+                << std::endl;
+      return PARSE_ARGUMENT_FAIL;
+    }
+    plugin_servers_[value.substr(0, equals_pos)] =
+        value.substr(equals_pos + 1);
+#endif
+
   } else if (name == "--print_free_field_numbers") {
     if (mode_ != MODE_COMPILE) {
       std::cerr << "Cannot use " << name
@@ -1166,7 +1602,8 @@ CommandLineInterface::InterpretArgument(const string& name,
                 << "other info at the same time." << std::endl;
       return PARSE_ARGUMENT_FAIL;
     }
-    if (!output_directives_.empty() || !descriptor_set_name_.empty()) {
+    if (!output_directives_.empty() || !descriptor_set_name_.empty() ||
+        !descriptor_image_name_.empty()) {
       std::cerr << "Cannot use " << name
                 << " and generate code or descriptors at the same time."
                 << std::endl;
@@ -1262,9 +1699,19 @@ void CommandLineInterface::PrintHelpText() {
 "                              include information about the original\n"
 "                              location of each decl in the source file as\n"
 "                              well as surrounding comments.\n"
+"  --descriptor_image_out=FILE Writes a descriptor image containing all of\n"
+"                              the input files and their dependencies to\n"
+"                              FILE.  Images can be memory-mapped and used\n"
+"                              directly by DescriptorImageDatabase.\n"
 "  --dependency_out=FILE       Write a dependency output file in the format\n"
 "                              expected by make. This writes the transitive\n"
 "                              set of input file paths to FILE\n"
+"  -jN, --jobs=N               Run code generators on N threads.  Output is\n"
+"                              identical to a single-threaded run.\n"
+"  --cache_dir=DIR             Remember parsed .proto files and generated\n"
+"                              code in DIR, and reuse them when the same\n"
+"                              inputs are seen again.  Plugin output is not\n"
+"                              cached.  DIR may be shared between runs.\n"
 "  --error_format=FORMAT       Set the format in which to print errors.\n"
 "                              FORMAT may be 'gcc' (the default) or 'msvs'\n"
 "                              (Microsoft Visual Studio format).\n"
@@ -1282,7 +1729,12 @@ void CommandLineInterface::PrintHelpText() {
 "                              Additionally, EXECUTABLE may be of the form\n"
 "                              NAME=PATH, in which case the given plugin name\n"
 "                              is mapped to the given executable even if\n"
-"                              the executable's own name differs." << std::endl;
+"                              the executable's own name differs.\n"
+"  --plugin_server=NAME=SOCKET Sends the requests for plugin NAME to a\n"
+"                              plugin server listening on the Unix domain\n"
+"                              socket SOCKET, rather than running the plugin.\n"
+"                              A plugin built on PluginMain() becomes such a\n"
+"                              server when run with --server=SOCKET." << std::endl;
   }
 
   for (GeneratorMap::iterator iter = generators_by_flag_name_.begin();
@@ -1300,8 +1752,37 @@ bool CommandLineInterface::GenerateOutput(
     const vector<const FileDescriptor*>& parsed_files,
     const OutputDirective& output_directive,
     GeneratorContext* generator_context) {
-  // Call the generator.
   string error;
+  if (!GenerateOutputForFiles(parsed_files, output_directive,
+                              GetGeneratorParameters(output_directive),
+                              generator_context, &error)) {
+    std::cerr << error << std::endl;
+    return false;
+  }
+  return true;
+}
+
+string CommandLineInterface::GetGeneratorParameters(
+    const OutputDirective& output_directive) {
+  string parameters = output_directive.parameter;
+  const string& options = FindWithDefault(
+      generator_parameters_, output_directive.name, string());
+  if (!options.empty()) {
+    if (!parameters.empty()) {
+      parameters.append(",");
+    }
+    parameters.append(options);
+  }
+  return parameters;
+}
+
+bool CommandLineInterface::GenerateOutputForFiles(
+    const vector<const FileDescriptor*>& files,
+    const OutputDirective& output_directive,
+    const string& parameters,
+    GeneratorContext* generator_context,
+    string* error) {
+  // Call the generator.
   if (output_directive.generator == NULL) {
     // This is a plugin.
     GOOGLE_CHECK(HasPrefixString(output_directive.name, "--") &&
@@ -1312,27 +1793,19 @@ bool CommandLineInterface::GenerateOutput(
     string plugin_name = plugin_prefix_ + "gen-" +
         output_directive.name.substr(2, output_directive.name.size() - 6);
 
-    if (!GeneratePluginOutput(parsed_files, plugin_name,
-                              output_directive.parameter,
-                              generator_context, &error)) {
-      std::cerr << output_directive.name << ": " << error << std::endl;
+    if (!GeneratePluginOutput(files, plugin_name, parameters,
+                              generator_context, error)) {
+      *error = output_directive.name + ": " + *error;
       return false;
     }
   } else {
     // Regular generator.
-    string parameters = output_directive.parameter;
-    if (!generator_parameters_[output_directive.name].empty()) {
-      if (!parameters.empty()) {
-        parameters.append(",");
-      }
-      parameters.append(generator_parameters_[output_directive.name]);
-    }
-    for (int i = 0; i < parsed_files.size(); i++) {
-      if (!output_directive.generator->Generate(parsed_files[i], parameters,
-                                                generator_context, &error)) {
+    for (int i = 0; i < files.size(); i++) {
+      if (!output_directive.generator->Generate(files[i], parameters,
+                                                generator_context, error)) {
         // Generator returned an error.
-        std::cerr << output_directive.name << ": " << parsed_files[i]->name()
-                  << ": " << error << std::endl;
+        *error = strings::Substitute("$0: $1: $2", output_directive.name,
+                                     files[i]->name(), *error);
         return false;
       }
     }
@@ -1341,6 +1814,161 @@ bool CommandLineInterface::GenerateOutput(
   return true;
 }
 
+bool CommandLineInterface::GenerateOutputInParallel(
+    const vector<const FileDescriptor*>& parsed_files,
+    const vector<GeneratorContextImpl*>& output_directories,
+    ContentCache* cache) {
+  // Jobs in the order a sequential run would have executed them.
+  vector<GenerationJob*> jobs;
+  GenerationQueue queue;
+  queue.cache = cache;
+  queue.next_lane = 0;
+
+  // Thread-safe generators get one lane per file.  Other generators get one
+  // lane per generator, covering all of its directives.  Each plugin
+  // directive gets a lane of its own, except on Windows, where Subprocess
+  // must run one plugin at a time and all plugins share a single lane.
+  map<const CodeGenerator*, int> serial_lanes;
+
+  for (int i = 0; i < output_directives_.size(); i++) {
+    const OutputDirective& directive = output_directives_[i];
+    string parameters = GetGeneratorParameters(directive);
+
+    if (directive.generator != NULL && directive.generator->IsThreadSafe()) {
+      for (int j = 0; j < parsed_files.size(); j++) {
+        GenerationJob* job = new GenerationJob(parsed_files);
+        job->directive = &directive;
+        job->files.push_back(parsed_files[j]);
+        job->parameters = parameters;
+        job->output_directory = output_directories[i];
+        jobs.push_back(job);
+        queue.lanes.push_back(vector<GenerationJob*>(1, job));
+      }
+    } else {
+      GenerationJob* job = new GenerationJob(parsed_files);
+      job->directive = &directive;
+      job->files = parsed_files;
+      job->parameters = parameters;
+      job->output_directory = output_directories[i];
+      jobs.push_back(job);
+
+#ifndef _WIN32
+      if (directive.generator == NULL) {
+        queue.lanes.push_back(vector<GenerationJob*>(1, job));
+        continue;
+      }
+#endif
+
+      map<const CodeGenerator*, int>::iterator lane =
+          serial_lanes.find(directive.generator);
+      if (lane == serial_lanes.end()) {
+        lane = serial_lanes.insert(
+            make_pair(directive.generator, queue.lanes.size())).first;
+        queue.lanes.push_back(vector<GenerationJob*>());
+      }
+      queue.lanes[lane->second].push_back(job);
+    }
+  }
+
+  // Plugins are not cached, since the plugin executable may change without
+  // us noticing.
+  if (cache != NULL) {
+    string parsed_files_key = GetParsedFilesCacheKey(parsed_files);
+    for (int i = 0; i < jobs.size(); i++) {
+      if (jobs[i]->directive->generator != NULL) {
+        jobs[i]->cache_key = GetOutputCacheKey(parsed_files_key, *jobs[i]);
+      }
+    }
+  }
+
+  google::protobuf::scoped_ptr<Closure> worker(NewPermanentCallback(
+      this, &CommandLineInterface::RunGenerationJobs, &queue));
+  RunOnThreads(min<int>(jobs_, queue.lanes.size()), worker.get());
+
+  // Copy the output into place in directive order, so that insertion points
+  // and errors behave exactly as they would have sequentially.
+  bool success = true;
+  for (int i = 0; i < jobs.size(); i++) {
+    if (!jobs[i]->success) {
+      std::cerr << jobs[i]->error << std::endl;
+      success = false;
+      break;
+    }
+    jobs[i]->context.Replay(jobs[i]->output_directory);
+  }
+
+  STLDeleteElements(&jobs);
+  return success;
+}
+
+void CommandLineInterface::RunGenerationJobs(GenerationQueue* queue) {
+  while (true) {
+    int lane;
+    {
+      MutexLock lock(&queue->mutex);
+      if (queue->next_lane == queue->lanes.size()) return;
+      lane = queue->next_lane++;
+    }
+
+    const vector<GenerationJob*>& lane_jobs = queue->lanes[lane];
+    for (int i = 0; i < lane_jobs.size(); i++) {
+      GenerationJob* job = lane_jobs[i];
+      string cached_output;
+      if (!job->cache_key.empty() &&
+          queue->cache->Lookup(job->cache_key, &cached_output) &&
+          job->context.ParseFromString(cached_output)) {
+        job->success = true;
+        continue;
+      }
+
+      job->success = GenerateOutputForFiles(job->files, *job->directive,
+                                            job->parameters, &job->context,
+                                            &job->error);
+      if (job->success && !job->cache_key.empty()) {
+        job->context.SerializeToString(&cached_output);
+        queue->cache->Insert(job->cache_key, cached_output);
+      }
+    }
+  }
+}
+
+string CommandLineInterface::GetParsedFilesCacheKey(
+    const vector<const FileDescriptor*>& parsed_files) {
+  // A generator sees the files it is run on, and through
+  // GeneratorContext::ListParsedFiles() all the other files being compiled,
+  // so the contents of all of them count.
+  string key;
+  FileDescriptorSet file_set;
+  set<const FileDescriptor*> already_seen;
+  for (int i = 0; i < parsed_files.size(); i++) {
+    key.append(parsed_files[i]->name());
+    key.push_back('\n');
+    GetTransitiveDependencies(parsed_files[i],
+                              true,  // Include source code info.
+                              &already_seen, file_set.mutable_file());
+  }
+  key.push_back('\n');
+  file_set.AppendToString(&key);
+  return key;
+}
+
+string CommandLineInterface::GetOutputCacheKey(const string& parsed_files_key,
+                                               const GenerationJob& job) {
+  // Everything the generator can see: its flag, parameters, the files it is
+  // run on, and the files being compiled with their imports.
+  string key = strings::Substitute(
+      "CommandLineInterface $0\n$1\n$2\n$3\n",
+      internal::VersionString(GOOGLE_PROTOBUF_VERSION), version_info_,
+      job.directive->name, job.parameters);
+  for (int i = 0; i < job.files.size(); i++) {
+    key.append(job.files[i]->name());
+    key.push_back('\n');
+  }
+  key.push_back('\n');
+  key.append(parsed_files_key);
+  return key;
+}
+
 bool CommandLineInterface::GenerateDependencyManifestFile(
     const vector<const FileDescriptor*>& parsed_files,
     const GeneratorContextMap& output_directories,
@@ -1420,9 +2048,24 @@ bool CommandLineInterface::GeneratePluginOutput(
   CodeGeneratorRequest request;
   CodeGeneratorResponse response;
 
+  // The "shared_memory" parameter is for us rather than the plugin.
+  bool shared_memory = false;
+  vector<string> parts;
+  SplitStringUsing(parameter, ",", &parts);
+  vector<string> plugin_parts;
+  for (int i = 0; i < parts.size(); i++) {
+    if (parts[i] == "shared_memory") {
+      shared_memory = true;
+    } else {
+      plugin_parts.push_back(parts[i]);
+    }
+  }
+  string plugin_parameter =
+      shared_memory ? JoinStrings(plugin_parts, ",") : parameter;
+
   // Build the request.
-  if (!parameter.empty()) {
-    request.set_parameter(parameter);
+  if (!plugin_parameter.empty()) {
+    request.set_parameter(plugin_parameter);
   }
 
   set<const FileDescriptor*> already_seen;
@@ -1433,17 +2076,32 @@ bool CommandLineInterface::GeneratePluginOutput(
                               &already_seen, request.mutable_proto_file());
   }
 
-  // Invoke the plugin.
-  Subprocess subprocess;
-
-  if (plugins_.count(plugin_name) > 0) {
-    subprocess.Start(plugins_[plugin_name], Subprocess::EXACT_NAME);
+  // Invoke the plugin, or send the request to its server.
+  string communicate_error;
+  bool communicated;
+  const string* server = FindOrNull(plugin_servers_, plugin_name);
+  if (server != NULL) {
+    communicated = CallPluginServer(*server, request, &response,
+                                    &communicate_error);
   } else {
-    subprocess.Start(plugin_name, Subprocess::SEARCH_PATH);
-  }
+    Subprocess subprocess;
 
-  string communicate_error;
-  if (!subprocess.Communicate(request, &response, &communicate_error)) {
+    string program = plugin_name;
+    Subprocess::SearchMode search_mode = Subprocess::SEARCH_PATH;
+    if (plugins_.count(plugin_name) > 0) {
+      program = plugins_[plugin_name];
+      search_mode = Subprocess::EXACT_NAME;
+    }
+    if (shared_memory) {
+      subprocess.StartWithSharedMemory(program, search_mode);
+    } else {
+      subprocess.Start(program, search_mode);
+    }
+
+    communicated = subprocess.Communicate(request, &response,
+                                          &communicate_error);
+  }
+  if (!communicated) {
     *error = strings::Substitute("$0: $1", plugin_name, communicate_error);
     return false;
   }
@@ -1601,6 +2259,53 @@ bool CommandLineInterface::WriteDescriptorSet(
   return true;
 }
 
+bool CommandLineInterface::WriteDescriptorImage(
+    const vector<const FileDescriptor*>& parsed_files) {
+  // An image is only useful if it is self-contained, so it always includes
+  // imports.
+  FileDescriptorSet file_set;
+  set<const FileDescriptor*> already_seen;
+  for (int i = 0; i < parsed_files.size(); i++) {
+    GetTransitiveDependencies(parsed_files[i], false,
+                              &already_seen, file_set.mutable_file());
+  }
+
+  vector<const FileDescriptorProto*> files;
+  for (int i = 0; i < file_set.file_size(); i++) {
+    files.push_back(&file_set.file(i));
+  }
+  string image;
+  if (!DescriptorImageDatabase::BuildImage(files, &image)) {
+    std::cerr << descriptor_image_name_
+              << ": Input files define conflicting symbols." << std::endl;
+    return false;
+  }
+
+  int fd;
+  do {
+    fd = open(descriptor_image_name_.c_str(),
+              O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0666);
+  } while (fd < 0 && errno == EINTR);
+
+  if (fd < 0) {
+    perror(descriptor_image_name_.c_str());
+    return false;
+  }
+
+  io::FileOutputStream out(fd);
+  {
+    io::CodedOutputStream coded_out(&out);
+    coded_out.WriteRaw(image.data(), image.size());
+  }
+  if (!out.Close()) {
+    std::cerr << descriptor_image_name_ << ": " << strerror(out.GetErrno())
+              << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
 void CommandLineInterface::GetTransitiveDependencies(
     const FileDescriptor* file, bool include_source_code_info,
     set<const FileDescriptor*>* already_seen,
@@ -60,6 +60,7 @@ namespace compiler {
 class CodeGenerator;        // code_generator.h
 class GeneratorContext;      // code_generator.h
 class DiskSourceTree;       // importer.h
+class ContentCache;         // importer.h
 
 // This class implements the command-line interface to the protocol compiler.
 // It is designed to make it very easy to create a custom protocol compiler
@@ -191,6 +192,9 @@ class LIBPROTOC_EXPORT CommandLineInterface {
   class ErrorPrinter;
   class GeneratorContextImpl;
   class MemoryOutputStream;
+  class RecordingGeneratorContext;
+  struct GenerationJob;
+  struct GenerationQueue;
   typedef hash_map<string, GeneratorContextImpl*> GeneratorContextMap;
 
   // Clear state from previous Run().
@@ -243,12 +247,50 @@ class LIBPROTOC_EXPORT CommandLineInterface {
                             GeneratorContext* generator_context,
                             string* error);
 
+  // Returns the parameter string for the given output directive, including
+  // any options passed using the generator's option flag.
+  string GetGeneratorParameters(const OutputDirective& output_directive);
+
+  // Runs the generator (or plugin) for output_directive over the given files.
+  // On failure, sets *error to a message suitable for printing as-is.
+  bool GenerateOutputForFiles(const vector<const FileDescriptor*>& files,
+                              const OutputDirective& output_directive,
+                              const string& parameters,
+                              GeneratorContext* generator_context,
+                              string* error);
+
+  // Implements -j and --cache_dir.  Runs every output directive on a pool of
+  // threads, then copies the results into output_directories (which has one
+  // entry per directive) in the same order as a sequential run would have.
+  // If cache is not NULL, generator output is looked up there first, and
+  // added to it afterwards.
+  bool GenerateOutputInParallel(
+      const vector<const FileDescriptor*>& parsed_files,
+      const vector<GeneratorContextImpl*>& output_directories,
+      ContentCache* cache);
+
+  // Body of each worker thread started by GenerateOutputInParallel().
+  void RunGenerationJobs(GenerationQueue* queue);
+
+  // Returns the part of the output cache key that is the same for every
+  // job: the names and full contents of the files being compiled and of
+  // their imports.
+  string GetParsedFilesCacheKey(
+      const vector<const FileDescriptor*>& parsed_files);
+
+  // Returns the key under which the output of the given job is cached.
+  string GetOutputCacheKey(const string& parsed_files_key,
+                           const GenerationJob& job);
+
   // Implements --encode and --decode.
   bool EncodeOrDecode(const DescriptorPool* pool);
 
   // Implements the --descriptor_set_out option.
   bool WriteDescriptorSet(const vector<const FileDescriptor*> parsed_files);
 
+  // Implements the --descriptor_image_out option.
+  bool WriteDescriptorImage(const vector<const FileDescriptor*>& parsed_files);
+
   // Implements the --dependency_out option
   bool GenerateDependencyManifestFile(
       const vector<const FileDescriptor*>& parsed_files,
@@ -316,6 +358,11 @@ class LIBPROTOC_EXPORT CommandLineInterface {
   // PATH (or other OS-specific search strategy) is searched.
   map<string, string> plugins_;
 
+  // Maps plugin names to the sockets of plugin servers given with
+  // --plugin_server (see plugin.h).  A plugin listed here is sent its
+  // request over the socket instead of being executed.
+  map<string, string> plugin_servers_;
+
   // Stuff parsed from command line.
   enum Mode {
     MODE_COMPILE,  // Normal mode:  parse .proto files and compile them.
@@ -361,6 +408,11 @@ class LIBPROTOC_EXPORT CommandLineInterface {
   // FileDescriptorSet should be written.  Otherwise, empty.
   string descriptor_set_name_;
 
+  // If --descriptor_image_out was given, this is the filename to which the
+  // descriptor image (see DescriptorImageDatabase) should be written.
+  // Otherwise, empty.
+  string descriptor_image_name_;
+
   // If --dependency_out was given, this is the path to the file where the
   // dependency file will be written. Otherwise, empty.
   string dependency_out_name_;
@@ -380,6 +432,14 @@ class LIBPROTOC_EXPORT CommandLineInterface {
   // See SetInputsAreProtoPathRelative().
   bool inputs_are_proto_path_relative_;
 
+  // Number of threads to generate code on, set with -j.  1 means generate
+  // everything on the calling thread.
+  int jobs_;
+
+  // If --cache_dir was given, the directory in which to cache parsed files
+  // and generated code.  Otherwise, empty.
+  string cache_dir_;
+
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(CommandLineInterface);
 };
 
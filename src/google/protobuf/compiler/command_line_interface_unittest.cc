@@ -39,6 +39,11 @@
 #include <io.h>
 #else
 #include <unistd.h>
+#include <dirent.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
 #endif
 #include <memory>
 #ifndef _SHARED_PTR_H
@@ -48,6 +53,7 @@
 
 #include <google/protobuf/descriptor.pb.h>
 #include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor_database.h>
 #include <google/protobuf/io/zero_copy_stream.h>
 #include <google/protobuf/compiler/command_line_interface.h>
 #include <google/protobuf/compiler/code_generator.h>
@@ -89,6 +95,35 @@ bool FileExists(const string& path) {
   return File::Exists(path);
 }
 
+// Returns the path of the test_plugin executable, or an empty string if it
+// can't be found.
+string FindTestPlugin() {
+  const char* possible_paths[] = {
+    // When building with shared libraries, libtool hides the real executable
+    // in .libs and puts a fake wrapper in the current directory.
+    // Unfortunately, due to an apparent bug on Cygwin/MinGW, if one program
+    // wrapped in this way (e.g. protobuf-tests.exe) tries to execute another
+    // program wrapped in this way (e.g. test_plugin.exe), the latter fails
+    // with error code 127 and no explanation message.  Presumably the problem
+    // is that the wrapper for protobuf-tests.exe set some environment
+    // variables that confuse the wrapper for test_plugin.exe.  Luckily, it
+    // turns out that if we simply invoke the wrapped test_plugin.exe
+    // directly, it works -- I guess the environment variables set by the
+    // protobuf-tests.exe wrapper happen to be correct for it too.  So we do
+    // that.
+    ".libs/test_plugin.exe",  // Win32 w/autotool (Cygwin / MinGW)
+    "test_plugin.exe",        // Other Win32 (MSVC)
+    "test_plugin",            // Unix
+  };
+
+  for (int i = 0; i < GOOGLE_ARRAYSIZE(possible_paths); i++) {
+    if (access(possible_paths[i], F_OK) == 0) {
+      return possible_paths[i];
+    }
+  }
+  return "";
+}
+
 class CommandLineInterfaceTest : public testing::Test {
  protected:
   virtual void SetUp();
@@ -115,6 +150,11 @@ class CommandLineInterfaceTest : public testing::Test {
   // Create a subdirectory within temp_directory_.
   void CreateTempDir(const string& name);
 
+#ifndef _WIN32
+  // Returns the number of entries in a subdirectory of temp_directory_.
+  int CountTempDirEntries(const string& name);
+#endif
+
   // Change working directory to temp directory.
   void SwitchToTempDirectory() {
     File::ChangeWorkingDirectory(temp_directory_);
@@ -181,9 +221,19 @@ class CommandLineInterfaceTest : public testing::Test {
 
   void ExpectNullCodeGeneratorCalled(const string& parameter);
 
+  // Forgets any previous call to the NullCodeGenerator.
+  void ResetNullCodeGenerator();
+
+  // Checks that the null output generator was not called since the last
+  // ResetNullCodeGenerator().
+  void ExpectNullCodeGeneratorNotCalled();
+
   void ReadDescriptorSet(const string& filename,
                          FileDescriptorSet* descriptor_set);
 
+  // Reads a descriptor image written by --descriptor_image_out.
+  void ReadDescriptorImage(const string& filename, string* image);
+
   void ExpectFileContent(const string& filename,
                          const string& content);
 
@@ -288,32 +338,7 @@ void CommandLineInterfaceTest::Run(const string& command) {
 
   if (!disallow_plugins_) {
     cli_.AllowPlugins("prefix-");
-    const char* possible_paths[] = {
-      // When building with shared libraries, libtool hides the real executable
-      // in .libs and puts a fake wrapper in the current directory.
-      // Unfortunately, due to an apparent bug on Cygwin/MinGW, if one program
-      // wrapped in this way (e.g. protobuf-tests.exe) tries to execute another
-      // program wrapped in this way (e.g. test_plugin.exe), the latter fails
-      // with error code 127 and no explanation message.  Presumably the problem
-      // is that the wrapper for protobuf-tests.exe set some environment
-      // variables that confuse the wrapper for test_plugin.exe.  Luckily, it
-      // turns out that if we simply invoke the wrapped test_plugin.exe
-      // directly, it works -- I guess the environment variables set by the
-      // protobuf-tests.exe wrapper happen to be correct for it too.  So we do
-      // that.
-      ".libs/test_plugin.exe",  // Win32 w/autotool (Cygwin / MinGW)
-      "test_plugin.exe",        // Other Win32 (MSVC)
-      "test_plugin",            // Unix
-    };
-
-    string plugin_path;
-
-    for (int i = 0; i < GOOGLE_ARRAYSIZE(possible_paths); i++) {
-      if (access(possible_paths[i], F_OK) == 0) {
-        plugin_path = possible_paths[i];
-        break;
-      }
-    }
+    string plugin_path = FindTestPlugin();
 
     if (plugin_path.empty()) {
       GOOGLE_LOG(ERROR)
@@ -371,6 +396,21 @@ void CommandLineInterfaceTest::CreateTempDir(const string& name) {
                                       0777));
 }
 
+#ifndef _WIN32
+int CommandLineInterfaceTest::CountTempDirEntries(const string& name) {
+  DIR* dir = opendir((temp_directory_ + "/" + name).c_str());
+  if (dir == NULL) return -1;
+  int count = 0;
+  while (struct dirent* entry = readdir(dir)) {
+    if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+      ++count;
+    }
+  }
+  closedir(dir);
+  return count;
+}
+#endif
+
 // -------------------------------------------------------------------
 
 void CommandLineInterfaceTest::ExpectNoErrors() {
@@ -451,6 +491,14 @@ void CommandLineInterfaceTest::ExpectNullCodeGeneratorCalled(
   EXPECT_EQ(parameter, null_generator_->parameter_);
 }
 
+void CommandLineInterfaceTest::ResetNullCodeGenerator() {
+  null_generator_->called_ = false;
+}
+
+void CommandLineInterfaceTest::ExpectNullCodeGeneratorNotCalled() {
+  EXPECT_FALSE(null_generator_->called_);
+}
+
 void CommandLineInterfaceTest::ReadDescriptorSet(
     const string& filename, FileDescriptorSet* descriptor_set) {
   string path = temp_directory_ + "/" + filename;
@@ -462,6 +510,12 @@ void CommandLineInterfaceTest::ReadDescriptorSet(
   }
 }
 
+void CommandLineInterfaceTest::ReadDescriptorImage(
+    const string& filename, string* image) {
+  string path = temp_directory_ + "/" + filename;
+  GOOGLE_CHECK_OK(File::GetContents(path, image, true));
+}
+
 void CommandLineInterfaceTest::ExpectCapturedStdout(
     const string& expected_text) {
   EXPECT_EQ(expected_text, captured_stdout_);
@@ -659,6 +713,184 @@ TEST_F(CommandLineInterfaceTest, Insert) {
       "foo.proto", "Foo");
 }
 
+TEST_F(CommandLineInterfaceTest, ParallelOutput) {
+  // Test generating several files with several generators using -j.
+
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+  CreateTempFile("bar.proto",
+    "syntax = \"proto2\";\n"
+    "message Bar {}\n");
+
+  Run("protocol_compiler -j4 --test_out=$tmpdir --plug_out=$tmpdir "
+      "--null_out=$tmpdir --proto_path=$tmpdir foo.proto bar.proto");
+
+  ExpectNoErrors();
+  ExpectGeneratedWithMultipleInputs("test_generator", "foo.proto,bar.proto",
+                                    "foo.proto", "Foo");
+  ExpectGeneratedWithMultipleInputs("test_generator", "foo.proto,bar.proto",
+                                    "bar.proto", "Bar");
+  ExpectGeneratedWithMultipleInputs("test_plugin", "foo.proto,bar.proto",
+                                    "foo.proto", "Foo");
+  ExpectGeneratedWithMultipleInputs("test_plugin", "foo.proto,bar.proto",
+                                    "bar.proto", "Bar");
+  ExpectNullCodeGeneratorCalled("");
+}
+
+TEST_F(CommandLineInterfaceTest, ParallelInsert) {
+  // Insertions depend on the order in which generators run, which -j must
+  // preserve.
+
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+
+  Run("protocol_compiler --jobs=4 "
+      "--test_out=TestParameter:$tmpdir "
+      "--plug_out=TestPluginParameter:$tmpdir "
+      "--test_out=insert=test_generator,test_plugin:$tmpdir "
+      "--plug_out=insert=test_generator,test_plugin:$tmpdir "
+      "--proto_path=$tmpdir foo.proto");
+
+  ExpectNoErrors();
+  ExpectGeneratedWithInsertions(
+      "test_generator", "TestParameter", "test_generator,test_plugin",
+      "foo.proto", "Foo");
+  ExpectGeneratedWithInsertions(
+      "test_plugin", "TestPluginParameter", "test_generator,test_plugin",
+      "foo.proto", "Foo");
+}
+
+TEST_F(CommandLineInterfaceTest, ParallelPlugins) {
+  // Plugins run at the same time, with either transport, and their output
+  // still lands in directive order.
+
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+  CreateTempDir("b");
+
+  Run("protocol_compiler --jobs=4 "
+      "--plug_out=TestPluginParameter:$tmpdir "
+      "--plug_out=shared_memory,insert=test_plugin:$tmpdir "
+      "--plug_out=shared_memory,TestPluginParameter:$tmpdir/b "
+      "--proto_path=$tmpdir foo.proto");
+
+  ExpectNoErrors();
+  ExpectGeneratedWithInsertions(
+      "test_plugin", "TestPluginParameter", "test_plugin", "foo.proto", "Foo");
+  ExpectGenerated("test_plugin", "TestPluginParameter", "foo.proto", "Foo",
+                  "b");
+}
+
+TEST_F(CommandLineInterfaceTest, ParallelGeneratorError) {
+  // Only the first error in directive order is reported.
+
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message MockCodeGenerator_Error {}\n");
+  CreateTempFile("bar.proto",
+    "syntax = \"proto2\";\n"
+    "package bar;\n"
+    "message MockCodeGenerator_Error {}\n");
+
+  Run("protocol_compiler -j2 --test_out=$tmpdir "
+      "--proto_path=$tmpdir foo.proto bar.proto");
+
+  ExpectErrorText(
+      "--test_out: foo.proto: Saw message type MockCodeGenerator_Error.\n");
+}
+
+TEST_F(CommandLineInterfaceTest, CacheDir) {
+  // Test that a second run with the same inputs reuses the generated code
+  // instead of calling the generators again.
+
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+  CreateTempDir("cache");
+  CreateTempDir("a");
+  CreateTempDir("b");
+
+  Run("protocol_compiler --cache_dir=$tmpdir/cache --test_out=$tmpdir/a "
+      "--null_out=$tmpdir/a --proto_path=$tmpdir foo.proto");
+  ExpectNoErrors();
+  ExpectGenerated("test_generator", "", "foo.proto", "Foo", "a");
+  ExpectNullCodeGeneratorCalled("");
+
+  ResetNullCodeGenerator();
+  Run("protocol_compiler --cache_dir=$tmpdir/cache --test_out=$tmpdir/b "
+      "--null_out=$tmpdir/b --proto_path=$tmpdir foo.proto");
+  ExpectNoErrors();
+  ExpectGenerated("test_generator", "", "foo.proto", "Foo", "b");
+  ExpectNullCodeGeneratorNotCalled();
+
+  // Different parameters are a cache miss.
+  Run("protocol_compiler --cache_dir=$tmpdir/cache --test_out=$tmpdir/b "
+      "--null_out=TestParameter:$tmpdir/b --proto_path=$tmpdir foo.proto");
+  ExpectNoErrors();
+  ExpectNullCodeGeneratorCalled("TestParameter");
+}
+
+#ifndef _WIN32
+TEST_F(CommandLineInterfaceTest, CacheDirOtherFileChanged) {
+  // Test that changing one of the files being compiled is a cache miss for
+  // the generator run on another, which can see it through
+  // GeneratorContext::ListParsedFiles().
+
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+  CreateTempFile("bar.proto",
+    "syntax = \"proto2\";\n"
+    "message Bar {}\n");
+  CreateTempDir("cache");
+
+  // One entry for each parsed file, and one for each file's output.
+  Run("protocol_compiler --cache_dir=$tmpdir/cache --test_out=$tmpdir "
+      "--proto_path=$tmpdir foo.proto bar.proto");
+  ExpectNoErrors();
+  EXPECT_EQ(4, CountTempDirEntries("cache"));
+
+  // The new bar.proto adds its parsed file and its output, and foo.proto's
+  // output must be generated again.
+  CreateTempFile("bar.proto",
+    "syntax = \"proto2\";\n"
+    "message Bar { optional int32 i = 1; }\n");
+  Run("protocol_compiler --cache_dir=$tmpdir/cache --test_out=$tmpdir "
+      "--proto_path=$tmpdir foo.proto bar.proto");
+  ExpectNoErrors();
+  ExpectGeneratedWithMultipleInputs("test_generator", "foo.proto,bar.proto",
+                                    "foo.proto", "Foo");
+  ExpectGeneratedWithMultipleInputs("test_generator", "foo.proto,bar.proto",
+                                    "bar.proto", "Bar");
+  EXPECT_EQ(7, CountTempDirEntries("cache"));
+}
+#endif  // !_WIN32
+
+TEST_F(CommandLineInterfaceTest, CacheDirNotFound) {
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+
+  Run("protocol_compiler --cache_dir=$tmpdir/nosuchdir --test_out=$tmpdir "
+      "--proto_path=$tmpdir foo.proto");
+
+  ExpectErrorSubstring("nosuchdir/: No such file or directory");
+}
+
+TEST_F(CommandLineInterfaceTest, BadJobs) {
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+
+  Run("protocol_compiler -j0 --test_out=$tmpdir "
+      "--proto_path=$tmpdir foo.proto");
+
+  ExpectErrorText("-j requires a positive number of threads.\n");
+}
+
 #if defined(_WIN32)
 
 TEST_F(CommandLineInterfaceTest, WindowsOutputPath) {
@@ -962,6 +1194,37 @@ TEST_F(CommandLineInterfaceTest, WriteTransitiveDescriptorSetWithSourceInfo) {
   EXPECT_TRUE(descriptor_set.file(1).has_source_code_info());
 }
 
+TEST_F(CommandLineInterfaceTest, WriteDescriptorImage) {
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "package foo;\n"
+    "message Foo {}\n");
+  CreateTempFile("bar.proto",
+    "syntax = \"proto2\";\n"
+    "import \"foo.proto\";\n"
+    "message Bar {\n"
+    "  optional foo.Foo foo = 1;\n"
+    "}\n");
+
+  Run("protocol_compiler --descriptor_image_out=$tmpdir/descriptor_image "
+      "--proto_path=$tmpdir bar.proto");
+
+  ExpectNoErrors();
+
+  string image;
+  ReadDescriptorImage("descriptor_image", &image);
+  DescriptorImageDatabase database;
+  ASSERT_TRUE(database.Init(image.data(), image.size()));
+
+  // Imports are always included.
+  FileDescriptorProto file;
+  EXPECT_TRUE(database.FindFileByName("bar.proto", &file));
+  EXPECT_EQ("bar.proto", file.name());
+  EXPECT_TRUE(database.FindFileContainingSymbol("foo.Foo", &file));
+  EXPECT_EQ("foo.proto", file.name());
+  EXPECT_FALSE(file.has_source_code_info());
+}
+
 TEST_F(CommandLineInterfaceTest, WriteDependencyManifestFileGivenTwoInputs) {
   CreateTempFile("foo.proto",
     "syntax = \"proto2\";\n"
@@ -1308,6 +1571,217 @@ TEST_F(CommandLineInterfaceTest, GeneratorPluginError) {
       "--plug_out: foo.proto: Saw message type MockCodeGenerator_Error.");
 }
 
+TEST_F(CommandLineInterfaceTest, PluginSharedMemory) {
+  // The plugin does not see the "shared_memory" parameter.
+
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+
+  Run("protocol_compiler --plug_out=TestParameter,shared_memory:$tmpdir "
+      "--proto_path=$tmpdir foo.proto");
+
+  ExpectNoErrors();
+  ExpectGenerated("test_plugin", "TestParameter", "foo.proto", "Foo");
+}
+
+TEST_F(CommandLineInterfaceTest, GeneratorPluginErrorSharedMemory) {
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message MockCodeGenerator_Error {}\n");
+
+  Run("protocol_compiler --plug_out=shared_memory:$tmpdir "
+      "--proto_path=$tmpdir foo.proto");
+
+  ExpectErrorSubstring(
+      "--plug_out: foo.proto: Saw message type MockCodeGenerator_Error.");
+}
+
+#ifndef _WIN32
+
+TEST_F(CommandLineInterfaceTest, PluginIgnoresSharedMemory) {
+  // A plugin not built on PluginMain() may ignore --shared_memory_fd and
+  // answer on stdout, leaving the request in the shared memory file.
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+  string plugin_path = TestTempDir() + "/old_plugin";
+  GOOGLE_CHECK_OK(File::SetContents(plugin_path, "#!/bin/sh\ncat > /dev/null\n",
+                             true));
+  ASSERT_EQ(0, chmod(plugin_path.c_str(), 0755));
+
+  Run("protocol_compiler --plugin=prefix-gen-old=" + plugin_path +
+      " --old_out=shared_memory:$tmpdir --proto_path=$tmpdir foo.proto");
+
+  ExpectErrorSubstring(
+      "--old_out: prefix-gen-old: Plugin does not support shared_memory");
+}
+
+// Starts test_plugin as a server listening on |socket_path| and waits for
+// the socket to appear.  Returns the server's process ID.
+static pid_t StartPluginServer(const string& socket_path) {
+  string plugin_path = FindTestPlugin();
+  EXPECT_FALSE(plugin_path.empty());
+  unlink(socket_path.c_str());
+
+  string server_flag = "--server=" + socket_path;
+  pid_t pid = fork();
+  EXPECT_NE(-1, pid);
+  if (pid == 0) {
+    execl(plugin_path.c_str(), plugin_path.c_str(), server_flag.c_str(),
+          static_cast<char*>(NULL));
+    _exit(1);
+  }
+
+  // The socket appears once the server is listening.
+  for (int i = 0; i < 1000 && !FileExists(socket_path); i++) {
+    usleep(10000);
+  }
+  EXPECT_TRUE(FileExists(socket_path));
+  return pid;
+}
+
+static void StopPluginServer(pid_t pid, const string& socket_path) {
+  kill(pid, SIGTERM);
+  waitpid(pid, NULL, 0);
+  unlink(socket_path.c_str());
+}
+
+TEST_F(CommandLineInterfaceTest, PluginServer) {
+  // Successive runs are served by one plugin server, which must notice that
+  // foo.proto changed between them.
+
+  string socket_path = TestTempDir() + "/plug.sock";
+  pid_t pid = StartPluginServer(socket_path);
+  ASSERT_NE(-1, pid);
+
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+  Run("protocol_compiler --plug_out=TestParameter:$tmpdir "
+      "--plugin_server=prefix-gen-plug=" + socket_path +
+      " --proto_path=$tmpdir foo.proto");
+  ExpectNoErrors();
+  ExpectGenerated("test_plugin", "TestParameter", "foo.proto", "Foo");
+
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Bar {}\n");
+  Run("protocol_compiler --plug_out=TestParameter:$tmpdir "
+      "--plugin_server=prefix-gen-plug=" + socket_path +
+      " --proto_path=$tmpdir foo.proto");
+  ExpectNoErrors();
+  ExpectGenerated("test_plugin", "TestParameter", "foo.proto", "Bar");
+
+  StopPluginServer(pid, socket_path);
+}
+
+TEST_F(CommandLineInterfaceTest, PluginServerMessageMoved) {
+  // The server still holds foo.proto from the first run when the second
+  // defines the same message in bar.proto instead.  Both runs must succeed,
+  // and so must a third that goes back to foo.proto.
+
+  string socket_path = TestTempDir() + "/plug.sock";
+  pid_t pid = StartPluginServer(socket_path);
+  ASSERT_NE(-1, pid);
+
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+  CreateTempFile("bar.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+
+  Run("protocol_compiler --plug_out=TestParameter:$tmpdir "
+      "--plugin_server=prefix-gen-plug=" + socket_path +
+      " --proto_path=$tmpdir foo.proto");
+  ExpectNoErrors();
+  ExpectGenerated("test_plugin", "TestParameter", "foo.proto", "Foo");
+
+  Run("protocol_compiler --plug_out=TestParameter:$tmpdir "
+      "--plugin_server=prefix-gen-plug=" + socket_path +
+      " --proto_path=$tmpdir bar.proto");
+  ExpectNoErrors();
+  ExpectGenerated("test_plugin", "TestParameter", "bar.proto", "Foo");
+
+  Run("protocol_compiler --plug_out=TestParameter:$tmpdir "
+      "--plugin_server=prefix-gen-plug=" + socket_path +
+      " --proto_path=$tmpdir foo.proto");
+  ExpectNoErrors();
+  ExpectGenerated("test_plugin", "TestParameter", "foo.proto", "Foo");
+
+  StopPluginServer(pid, socket_path);
+}
+
+TEST_F(CommandLineInterfaceTest, PluginServerClosesEarly) {
+  // A server that dies before finishing its response must make protoc fail,
+  // not write nothing and succeed.  The fake server here reads each request,
+  // then answers the first with nothing and the second with part of a framed
+  // response: a size of 100 followed by only three bytes.
+
+  string socket_path = TestTempDir() + "/early.sock";
+  unlink(socket_path.c_str());
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  ASSERT_LT(socket_path.size(), sizeof(address.sun_path));
+  memcpy(address.sun_path, socket_path.data(), socket_path.size());
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  ASSERT_NE(-1, listener);
+  ASSERT_EQ(0, bind(listener, reinterpret_cast<struct sockaddr*>(&address),
+                    sizeof(address)));
+  ASSERT_EQ(0, listen(listener, 1));
+
+  pid_t pid = fork();
+  ASSERT_NE(-1, pid);
+  if (pid == 0) {
+    static const char kPartial[] = {100, 1, 2, 3};
+    for (int i = 0; i < 2; i++) {
+      int connection = accept(listener, NULL, NULL);
+      if (connection == -1) _exit(1);
+      char buffer[4096];
+      while (read(connection, buffer, sizeof(buffer)) > 0) {}
+      if (i == 1 && write(connection, kPartial, sizeof(kPartial)) == -1) {
+        _exit(1);
+      }
+      close(connection);
+    }
+    _exit(0);
+  }
+  close(listener);
+
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+  for (int i = 0; i < 2; i++) {
+    Run("protocol_compiler --plug_out=$tmpdir "
+        "--plugin_server=prefix-gen-plug=" + socket_path +
+        " --proto_path=$tmpdir foo.proto");
+    ExpectErrorSubstring(
+        "--plug_out: prefix-gen-plug: Plugin server closed the connection "
+        "without a complete response.");
+  }
+
+  int status;
+  ASSERT_EQ(pid, waitpid(pid, &status, 0));
+  EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  unlink(socket_path.c_str());
+}
+
+TEST_F(CommandLineInterfaceTest, PluginServerNotRunning) {
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+
+  Run("protocol_compiler --plug_out=$tmpdir "
+      "--plugin_server=prefix-gen-plug=$tmpdir/no_such.sock "
+      "--proto_path=$tmpdir foo.proto");
+
+  ExpectErrorSubstring("--plug_out: prefix-gen-plug: ");
+}
+
+#endif  // !_WIN32
+
 TEST_F(CommandLineInterfaceTest, GeneratorPluginFail) {
   // Test a generator plugin that exits with an error code.
 
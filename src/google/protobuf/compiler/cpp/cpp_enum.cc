@@ -81,6 +81,7 @@ void EnumGenerator::GenerateDefinition(io::Printer* printer) {
   const EnumValueDescriptor* min_value = descriptor_->value(0);
   const EnumValueDescriptor* max_value = descriptor_->value(0);
 
+  const io::PrinterTemplate value_definition("$prefix$$name$ = $number$", '$');
   for (int i = 0; i < descriptor_->value_count(); i++) {
     vars["name"] = EnumValueName(descriptor_->value(i));
     // In C++, an value of -2147483648 gets interpreted as the negative of
@@ -92,7 +93,7 @@ void EnumGenerator::GenerateDefinition(io::Printer* printer) {
 
 
     if (i > 0) printer->Print(",\n");
-    printer->Print(vars, "$prefix$$name$ = $number$");
+    printer->Print(vars, value_definition);
 
     if (descriptor_->value(i)->number() < min_value->number()) {
       min_value = descriptor_->value(i);
@@ -70,14 +70,16 @@ EnumFieldGenerator::~EnumFieldGenerator() {}
 
 void EnumFieldGenerator::
 GeneratePrivateMembers(io::Printer* printer) const {
-  printer->Print(variables_, "int $name$_;\n");
+  static io::LazyPrinterTemplate private_members = { "int $name$_;\n", '$' };
+  printer->Print(variables_, private_members.Get());
 }
 
 void EnumFieldGenerator::
 GenerateAccessorDeclarations(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate accessor_declarations = {
     "$type$ $name$() const$deprecation$;\n"
-    "void set_$name$($type$ value)$deprecation$;\n");
+    "void set_$name$($type$ value)$deprecation$;\n", '$' };
+  printer->Print(variables_, accessor_declarations.Get());
 }
 
 void EnumFieldGenerator::
@@ -85,41 +87,52 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
                                   bool is_inline) const {
   map<string, string> variables(variables_);
   variables["inline"] = is_inline ? "inline" : "";
-  printer->Print(variables,
+  static io::LazyPrinterTemplate getter_and_setter_start = {
     "$inline$ $type$ $classname$::$name$() const {\n"
     "  // @@protoc_insertion_point(field_get:$full_name$)\n"
     "  return static_cast< $type$ >($name$_);\n"
     "}\n"
-    "$inline$ void $classname$::set_$name$($type$ value) {\n");
+    "$inline$ void $classname$::set_$name$($type$ value) {\n", '$' };
+  printer->Print(variables, getter_and_setter_start.Get());
   if (!HasPreservingUnknownEnumSemantics(descriptor_->file())) {
-    printer->Print(variables,
-    "  assert($type$_IsValid(value));\n");
+    static io::LazyPrinterTemplate setter_assert = {
+      "  assert($type$_IsValid(value));\n", '$' };
+    printer->Print(variables, setter_assert.Get());
   }
-  printer->Print(variables,
+  static io::LazyPrinterTemplate setter_end = {
     "  $set_hasbit$\n"
     "  $name$_ = value;\n"
     "  // @@protoc_insertion_point(field_set:$full_name$)\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables, setter_end.Get());
 }
 
 void EnumFieldGenerator::
 GenerateClearingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_ = $default$;\n");
+  static io::LazyPrinterTemplate clearing_code = {
+    "$name$_ = $default$;\n", '$' };
+  printer->Print(variables_, clearing_code.Get());
 }
 
 void EnumFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
-  printer->Print(variables_, "set_$name$(from.$name$());\n");
+  static io::LazyPrinterTemplate merging_code = {
+    "set_$name$(from.$name$());\n", '$' };
+  printer->Print(variables_, merging_code.Get());
 }
 
 void EnumFieldGenerator::
 GenerateSwappingCode(io::Printer* printer) const {
-  printer->Print(variables_, "std::swap($name$_, other->$name$_);\n");
+  static io::LazyPrinterTemplate swapping_code = {
+    "std::swap($name$_, other->$name$_);\n", '$' };
+  printer->Print(variables_, swapping_code.Get());
 }
 
 void EnumFieldGenerator::
 GenerateConstructorCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_ = $default$;\n");
+  static io::LazyPrinterTemplate constructor_code = {
+    "$name$_ = $default$;\n", '$' };
+  printer->Print(variables_, constructor_code.Get());
 }
 
 void EnumFieldGenerator::
@@ -130,16 +143,19 @@ GenerateMergeFromCodedStream(io::Printer* printer) const {
     "         int, ::google::protobuf::internal::WireFormatLite::TYPE_ENUM>(\n"
     "       input, &value)));\n");
   if (HasPreservingUnknownEnumSemantics(descriptor_->file())) {
-    printer->Print(variables_,
-      "set_$name$(static_cast< $type$ >(value));\n");
+    static io::LazyPrinterTemplate set_value = {
+      "set_$name$(static_cast< $type$ >(value));\n", '$' };
+    printer->Print(variables_, set_value.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate set_valid_value = {
       "if ($type$_IsValid(value)) {\n"
-      "  set_$name$(static_cast< $type$ >(value));\n");
+      "  set_$name$(static_cast< $type$ >(value));\n", '$' };
+    printer->Print(variables_, set_valid_value.Get());
     if (UseUnknownFieldSet(descriptor_->file())) {
-      printer->Print(variables_,
+      static io::LazyPrinterTemplate keep_unknown_value = {
         "} else {\n"
-        "  mutable_unknown_fields()->AddVarint($number$, value);\n");
+        "  mutable_unknown_fields()->AddVarint($number$, value);\n", '$' };
+      printer->Print(variables_, keep_unknown_value.Get());
     } else {
       printer->Print(
         "} else {\n"
@@ -153,23 +169,27 @@ GenerateMergeFromCodedStream(io::Printer* printer) const {
 
 void EnumFieldGenerator::
 GenerateSerializeWithCachedSizes(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialize_with_cached_sizes = {
     "::google::protobuf::internal::WireFormatLite::WriteEnum(\n"
-    "  $number$, this->$name$(), output);\n");
+    "  $number$, this->$name$(), output);\n", '$' };
+  printer->Print(variables_, serialize_with_cached_sizes.Get());
 }
 
 void EnumFieldGenerator::
 GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialize_with_cached_sizes_to_array = {
     "target = ::google::protobuf::internal::WireFormatLite::WriteEnumToArray(\n"
-    "  $number$, this->$name$(), target);\n");
+    "  $number$, this->$name$(), target);\n", '$' };
+  printer->Print(variables_, serialize_with_cached_sizes_to_array.Get());
 }
 
 void EnumFieldGenerator::
 GenerateByteSize(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate byte_size = {
     "total_size += $tag_size$ +\n"
-    "  ::google::protobuf::internal::WireFormatLite::EnumSize(this->$name$());\n");
+    "  ::google::protobuf::internal::WireFormatLite::EnumSize(this->$name$());\n",
+    '$' };
+  printer->Print(variables_, byte_size.Get());
 }
 
 // ===================================================================
@@ -188,7 +208,7 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
                                   bool is_inline) const {
   map<string, string> variables(variables_);
   variables["inline"] = is_inline ? "inline" : "";
-  printer->Print(variables,
+  static io::LazyPrinterTemplate getter_and_setter_start = {
     "$inline$ $type$ $classname$::$name$() const {\n"
     "  // @@protoc_insertion_point(field_get:$full_name$)\n"
     "  if (has_$name$()) {\n"
@@ -196,24 +216,29 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
     "  }\n"
     "  return static_cast< $type$ >($default$);\n"
     "}\n"
-    "$inline$ void $classname$::set_$name$($type$ value) {\n");
+    "$inline$ void $classname$::set_$name$($type$ value) {\n", '$' };
+  printer->Print(variables, getter_and_setter_start.Get());
   if (!HasPreservingUnknownEnumSemantics(descriptor_->file())) {
-    printer->Print(variables,
-    "  assert($type$_IsValid(value));\n");
+    static io::LazyPrinterTemplate setter_assert = {
+      "  assert($type$_IsValid(value));\n", '$' };
+    printer->Print(variables, setter_assert.Get());
   }
-  printer->Print(variables,
+  static io::LazyPrinterTemplate setter_end = {
     "  if (!has_$name$()) {\n"
     "    clear_$oneof_name$();\n"
     "    set_has_$name$();\n"
     "  }\n"
     "  $oneof_prefix$$name$_ = value;\n"
     "  // @@protoc_insertion_point(field_set:$full_name$)\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables, setter_end.Get());
 }
 
 void EnumOneofFieldGenerator::
 GenerateClearingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$oneof_prefix$$name$_ = $default$;\n");
+  static io::LazyPrinterTemplate clearing_code = {
+    "$oneof_prefix$$name$_ = $default$;\n", '$' };
+  printer->Print(variables_, clearing_code.Get());
 }
 
 void EnumOneofFieldGenerator::
@@ -223,8 +248,9 @@ GenerateSwappingCode(io::Printer* printer) const {
 
 void EnumOneofFieldGenerator::
 GenerateConstructorCode(io::Printer* printer) const {
-  printer->Print(variables_,
-    "  $classname$_default_oneof_instance_->$name$_ = $default$;\n");
+  static io::LazyPrinterTemplate constructor_code = {
+    "  $classname$_default_oneof_instance_->$name$_ = $default$;\n", '$' };
+  printer->Print(variables_, constructor_code.Get());
 }
 
 // ===================================================================
@@ -240,24 +266,29 @@ RepeatedEnumFieldGenerator::~RepeatedEnumFieldGenerator() {}
 
 void RepeatedEnumFieldGenerator::
 GeneratePrivateMembers(io::Printer* printer) const {
-  printer->Print(variables_,
-    "::google::protobuf::RepeatedField<int> $name$_;\n");
+  static io::LazyPrinterTemplate field_member = {
+    "::google::protobuf::RepeatedField<int> $name$_;\n", '$' };
+  printer->Print(variables_, field_member.Get());
   if (descriptor_->options().packed()
       && HasGeneratedMethods(descriptor_->file())) {
-    printer->Print(variables_,
-      "mutable int _$name$_cached_byte_size_;\n");
+    static io::LazyPrinterTemplate cached_byte_size_member = {
+      "mutable int _$name$_cached_byte_size_;\n", '$' };
+    printer->Print(variables_, cached_byte_size_member.Get());
   }
 }
 
 void RepeatedEnumFieldGenerator::
 GenerateAccessorDeclarations(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate element_accessor_declarations = {
     "$type$ $name$(int index) const$deprecation$;\n"
     "void set_$name$(int index, $type$ value)$deprecation$;\n"
-    "void add_$name$($type$ value)$deprecation$;\n");
-  printer->Print(variables_,
+    "void add_$name$($type$ value)$deprecation$;\n", '$' };
+  printer->Print(variables_, element_accessor_declarations.Get());
+  static io::LazyPrinterTemplate list_accessor_declarations = {
     "const ::google::protobuf::RepeatedField<int>& $name$() const$deprecation$;\n"
-    "::google::protobuf::RepeatedField<int>* mutable_$name$()$deprecation$;\n");
+    "::google::protobuf::RepeatedField<int>* mutable_$name$()$deprecation$;\n",
+    '$' };
+  printer->Print(variables_, list_accessor_declarations.Get());
 }
 
 void RepeatedEnumFieldGenerator::
@@ -265,30 +296,35 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
                                   bool is_inline) const {
   map<string, string> variables(variables_);
   variables["inline"] = is_inline ? "inline" : "";
-  printer->Print(variables,
+  static io::LazyPrinterTemplate getter_and_setter_start = {
     "$inline$ $type$ $classname$::$name$(int index) const {\n"
     "  // @@protoc_insertion_point(field_get:$full_name$)\n"
     "  return static_cast< $type$ >($name$_.Get(index));\n"
     "}\n"
-    "$inline$ void $classname$::set_$name$(int index, $type$ value) {\n");
+    "$inline$ void $classname$::set_$name$(int index, $type$ value) {\n", '$' };
+  printer->Print(variables, getter_and_setter_start.Get());
   if (!HasPreservingUnknownEnumSemantics(descriptor_->file())) {
-    printer->Print(variables,
-    "  assert($type$_IsValid(value));\n");
+    static io::LazyPrinterTemplate setter_assert = {
+      "  assert($type$_IsValid(value));\n", '$' };
+    printer->Print(variables, setter_assert.Get());
   }
-  printer->Print(variables,
+  static io::LazyPrinterTemplate setter_end_and_adder_start = {
     "  $name$_.Set(index, value);\n"
     "  // @@protoc_insertion_point(field_set:$full_name$)\n"
     "}\n"
-    "$inline$ void $classname$::add_$name$($type$ value) {\n");
+    "$inline$ void $classname$::add_$name$($type$ value) {\n", '$' };
+  printer->Print(variables, setter_end_and_adder_start.Get());
   if (!HasPreservingUnknownEnumSemantics(descriptor_->file())) {
-    printer->Print(variables,
-    "  assert($type$_IsValid(value));\n");
+    static io::LazyPrinterTemplate adder_assert = {
+      "  assert($type$_IsValid(value));\n", '$' };
+    printer->Print(variables, adder_assert.Get());
   }
-  printer->Print(variables,
+  static io::LazyPrinterTemplate adder_end = {
     "  $name$_.Add(value);\n"
     "  // @@protoc_insertion_point(field_add:$full_name$)\n"
-    "}\n");
-  printer->Print(variables,
+    "}\n", '$' };
+  printer->Print(variables, adder_end.Get());
+  static io::LazyPrinterTemplate list_accessor_definitions = {
     "$inline$ const ::google::protobuf::RepeatedField<int>&\n"
     "$classname$::$name$() const {\n"
     "  // @@protoc_insertion_point(field_list:$full_name$)\n"
@@ -298,22 +334,28 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
     "$classname$::mutable_$name$() {\n"
     "  // @@protoc_insertion_point(field_mutable_list:$full_name$)\n"
     "  return &$name$_;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables, list_accessor_definitions.Get());
 }
 
 void RepeatedEnumFieldGenerator::
 GenerateClearingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.Clear();\n");
+  static io::LazyPrinterTemplate clearing_code = { "$name$_.Clear();\n", '$' };
+  printer->Print(variables_, clearing_code.Get());
 }
 
 void RepeatedEnumFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.MergeFrom(from.$name$_);\n");
+  static io::LazyPrinterTemplate merging_code = {
+    "$name$_.MergeFrom(from.$name$_);\n", '$' };
+  printer->Print(variables_, merging_code.Get());
 }
 
 void RepeatedEnumFieldGenerator::
 GenerateSwappingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.UnsafeArenaSwap(&other->$name$_);\n");
+  static io::LazyPrinterTemplate swapping_code = {
+    "$name$_.UnsafeArenaSwap(&other->$name$_);\n", '$' };
+  printer->Print(variables_, swapping_code.Get());
 }
 
 void RepeatedEnumFieldGenerator::
@@ -330,16 +372,19 @@ GenerateMergeFromCodedStream(io::Printer* printer) const {
     "         int, ::google::protobuf::internal::WireFormatLite::TYPE_ENUM>(\n"
     "       input, &value)));\n");
   if (HasPreservingUnknownEnumSemantics(descriptor_->file())) {
-    printer->Print(variables_,
-      "add_$name$(static_cast< $type$ >(value));\n");
+    static io::LazyPrinterTemplate add_value = {
+      "add_$name$(static_cast< $type$ >(value));\n", '$' };
+    printer->Print(variables_, add_value.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate add_valid_value = {
       "if ($type$_IsValid(value)) {\n"
-      "  add_$name$(static_cast< $type$ >(value));\n");
+      "  add_$name$(static_cast< $type$ >(value));\n", '$' };
+    printer->Print(variables_, add_valid_value.Get());
     if (UseUnknownFieldSet(descriptor_->file())) {
-      printer->Print(variables_,
+      static io::LazyPrinterTemplate keep_unknown_value = {
         "} else {\n"
-        "  mutable_unknown_fields()->AddVarint($number$, value);\n");
+        "  mutable_unknown_fields()->AddVarint($number$, value);\n", '$' };
+      printer->Print(variables_, keep_unknown_value.Get());
     } else {
       printer->Print(
         "} else {\n"
@@ -355,31 +400,34 @@ GenerateMergeFromCodedStreamWithPacking(io::Printer* printer) const {
   if (!descriptor_->options().packed()) {
       // This path is rarely executed, so we use a non-inlined implementation.
     if (HasPreservingUnknownEnumSemantics(descriptor_->file())) {
-      printer->Print(variables_,
+      static io::LazyPrinterTemplate read_packed = {
         "DO_((::google::protobuf::internal::"
                     "WireFormatLite::ReadPackedEnumPreserveUnknowns(\n"
         "       input,\n"
         "       $number$,\n"
         "       NULL,\n"
         "       NULL,\n"
-        "       this->mutable_$name$())));\n");
+        "       this->mutable_$name$())));\n", '$' };
+      printer->Print(variables_, read_packed.Get());
     } else if (UseUnknownFieldSet(descriptor_->file())) {
-      printer->Print(variables_,
+      static io::LazyPrinterTemplate read_packed_to_unknown_fields = {
         "DO_((::google::protobuf::internal::WireFormat::ReadPackedEnumPreserveUnknowns(\n"
         "       input,\n"
         "       $number$,\n"
         "       $type$_IsValid,\n"
         "       mutable_unknown_fields(),\n"
-        "       this->mutable_$name$())));\n");
+        "       this->mutable_$name$())));\n", '$' };
+      printer->Print(variables_, read_packed_to_unknown_fields.Get());
     } else {
-      printer->Print(variables_,
+      static io::LazyPrinterTemplate read_packed_to_unknown_stream = {
         "DO_((::google::protobuf::internal::"
                      "WireFormatLite::ReadPackedEnumPreserveUnknowns(\n"
         "       input,\n"
         "       $number$,\n"
         "       $type$_IsValid,\n"
         "       &unknown_fields_stream,\n"
-        "       this->mutable_$name$())));\n");
+        "       this->mutable_$name$())));\n", '$' };
+      printer->Print(variables_, read_packed_to_unknown_stream.Get());
     }
   } else {
     printer->Print(variables_,
@@ -393,16 +441,19 @@ GenerateMergeFromCodedStreamWithPacking(io::Printer* printer) const {
       "         int, ::google::protobuf::internal::WireFormatLite::TYPE_ENUM>(\n"
       "       input, &value)));\n");
     if (HasPreservingUnknownEnumSemantics(descriptor_->file())) {
-      printer->Print(variables_,
-      "  add_$name$(static_cast< $type$ >(value));\n");
+      static io::LazyPrinterTemplate add_value = {
+        "  add_$name$(static_cast< $type$ >(value));\n", '$' };
+      printer->Print(variables_, add_value.Get());
     } else {
-      printer->Print(variables_,
-      "  if ($type$_IsValid(value)) {\n"
-      "    add_$name$(static_cast< $type$ >(value));\n"
-      "  } else {\n");
+      static io::LazyPrinterTemplate add_valid_value = {
+        "  if ($type$_IsValid(value)) {\n"
+        "    add_$name$(static_cast< $type$ >(value));\n"
+        "  } else {\n", '$' };
+      printer->Print(variables_, add_valid_value.Get());
       if (UseUnknownFieldSet(descriptor_->file())) {
-        printer->Print(variables_,
-        "    mutable_unknown_fields()->AddVarint($number$, value);\n");
+        static io::LazyPrinterTemplate keep_unknown_value = {
+          "    mutable_unknown_fields()->AddVarint($number$, value);\n", '$' };
+        printer->Print(variables_, keep_unknown_value.Get());
       } else {
         printer->Print(variables_,
         "    unknown_fields_stream.WriteVarint32(tag);\n"
@@ -421,25 +472,29 @@ void RepeatedEnumFieldGenerator::
 GenerateSerializeWithCachedSizes(io::Printer* printer) const {
   if (descriptor_->options().packed()) {
     // Write the tag and the size.
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate packed_header = {
       "if (this->$name$_size() > 0) {\n"
       "  ::google::protobuf::internal::WireFormatLite::WriteTag(\n"
       "    $number$,\n"
       "    ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED,\n"
       "    output);\n"
       "  output->WriteVarint32(_$name$_cached_byte_size_);\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, packed_header.Get());
   }
-  printer->Print(variables_,
-      "for (int i = 0; i < this->$name$_size(); i++) {\n");
+  static io::LazyPrinterTemplate loop_start = {
+    "for (int i = 0; i < this->$name$_size(); i++) {\n", '$' };
+  printer->Print(variables_, loop_start.Get());
   if (descriptor_->options().packed()) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate packed_element = {
       "  ::google::protobuf::internal::WireFormatLite::WriteEnumNoTag(\n"
-      "    this->$name$(i), output);\n");
+      "    this->$name$(i), output);\n", '$' };
+    printer->Print(variables_, packed_element.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate element = {
       "  ::google::protobuf::internal::WireFormatLite::WriteEnum(\n"
-      "    $number$, this->$name$(i), output);\n");
+      "    $number$, this->$name$(i), output);\n", '$' };
+    printer->Print(variables_, element.Get());
   }
   printer->Print("}\n");
 }
@@ -448,7 +503,7 @@ void RepeatedEnumFieldGenerator::
 GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const {
   if (descriptor_->options().packed()) {
     // Write the tag and the size.
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate packed_header = {
       "if (this->$name$_size() > 0) {\n"
       "  target = ::google::protobuf::internal::WireFormatLite::WriteTagToArray(\n"
       "    $number$,\n"
@@ -456,18 +511,22 @@ GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const {
       "    target);\n"
       "  target = ::google::protobuf::io::CodedOutputStream::WriteVarint32ToArray("
       "    _$name$_cached_byte_size_, target);\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, packed_header.Get());
   }
-  printer->Print(variables_,
-      "for (int i = 0; i < this->$name$_size(); i++) {\n");
+  static io::LazyPrinterTemplate loop_start = {
+    "for (int i = 0; i < this->$name$_size(); i++) {\n", '$' };
+  printer->Print(variables_, loop_start.Get());
   if (descriptor_->options().packed()) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate packed_element = {
       "  target = ::google::protobuf::internal::WireFormatLite::WriteEnumNoTagToArray(\n"
-      "    this->$name$(i), target);\n");
+      "    this->$name$(i), target);\n", '$' };
+    printer->Print(variables_, packed_element.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate element = {
       "  target = ::google::protobuf::internal::WireFormatLite::WriteEnumToArray(\n"
-      "    $number$, this->$name$(i), target);\n");
+      "    $number$, this->$name$(i), target);\n", '$' };
+    printer->Print(variables_, element.Get());
   }
   printer->Print("}\n");
 }
@@ -478,14 +537,15 @@ GenerateByteSize(io::Printer* printer) const {
     "{\n"
     "  int data_size = 0;\n");
   printer->Indent();
-  printer->Print(variables_,
-      "for (int i = 0; i < this->$name$_size(); i++) {\n"
-      "  data_size += ::google::protobuf::internal::WireFormatLite::EnumSize(\n"
-      "    this->$name$(i));\n"
-      "}\n");
+  static io::LazyPrinterTemplate data_size_loop = {
+    "for (int i = 0; i < this->$name$_size(); i++) {\n"
+    "  data_size += ::google::protobuf::internal::WireFormatLite::EnumSize(\n"
+    "    this->$name$(i));\n"
+    "}\n", '$' };
+  printer->Print(variables_, data_size_loop.Get());
 
   if (descriptor_->options().packed()) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate packed_total_size = {
       "if (data_size > 0) {\n"
       "  total_size += $tag_size$ +\n"
       "    ::google::protobuf::internal::WireFormatLite::Int32Size(data_size);\n"
@@ -493,10 +553,12 @@ GenerateByteSize(io::Printer* printer) const {
       "GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();\n"
       "_$name$_cached_byte_size_ = data_size;\n"
       "GOOGLE_SAFE_CONCURRENT_WRITES_END();\n"
-      "total_size += data_size;\n");
+      "total_size += data_size;\n", '$' };
+    printer->Print(variables_, packed_total_size.Get());
   } else {
-    printer->Print(variables_,
-      "total_size += $tag_size$ * this->$name$_size() + data_size;\n");
+    static io::LazyPrinterTemplate unpacked_total_size = {
+      "total_size += $tag_size$ * this->$name$_size() + data_size;\n", '$' };
+    printer->Print(variables_, unpacked_total_size.Get());
   }
   printer->Outdent();
   printer->Print("}\n");
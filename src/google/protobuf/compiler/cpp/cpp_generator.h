@@ -59,6 +59,7 @@ class LIBPROTOC_EXPORT CppGenerator : public CodeGenerator {
                 const string& parameter,
                 GeneratorContext* generator_context,
                 string* error) const;
+  bool IsThreadSafe() const { return true; }
 
  private:
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(CppGenerator);
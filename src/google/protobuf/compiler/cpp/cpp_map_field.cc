@@ -109,27 +109,29 @@ MapFieldGenerator::~MapFieldGenerator() {}
 
 void MapFieldGenerator::
 GeneratePrivateMembers(io::Printer* printer) const {
-  printer->Print(variables_,
-      "typedef ::google::protobuf::internal::MapEntryLite<\n"
-      "    $key_cpp$, $val_cpp$,\n"
-      "    $key_wire_type$,\n"
-      "    $val_wire_type$,\n"
-      "    $default_enum_value$ >\n"
-      "    $map_classname$;\n"
-      "::google::protobuf::internal::MapField$lite$<\n"
-      "    $key_cpp$, $val_cpp$,\n"
-      "    $key_wire_type$,\n"
-      "    $val_wire_type$,\n"
-      "    $default_enum_value$ > $name$_;\n");
+  static io::LazyPrinterTemplate private_members = {
+    "typedef ::google::protobuf::internal::MapEntryLite<\n"
+    "    $key_cpp$, $val_cpp$,\n"
+    "    $key_wire_type$,\n"
+    "    $val_wire_type$,\n"
+    "    $default_enum_value$ >\n"
+    "    $map_classname$;\n"
+    "::google::protobuf::internal::MapField$lite$<\n"
+    "    $key_cpp$, $val_cpp$,\n"
+    "    $key_wire_type$,\n"
+    "    $val_wire_type$,\n"
+    "    $default_enum_value$ > $name$_;\n", '$' };
+  printer->Print(variables_, private_members.Get());
 }
 
 void MapFieldGenerator::
 GenerateAccessorDeclarations(io::Printer* printer) const {
-  printer->Print(variables_,
-      "const ::google::protobuf::Map< $key_cpp$, $val_cpp$ >&\n"
-      "    $name$() const$deprecation$;\n"
-      "::google::protobuf::Map< $key_cpp$, $val_cpp$ >*\n"
-      "    mutable_$name$()$deprecation$;\n");
+  static io::LazyPrinterTemplate accessor_declarations = {
+    "const ::google::protobuf::Map< $key_cpp$, $val_cpp$ >&\n"
+    "    $name$() const$deprecation$;\n"
+    "::google::protobuf::Map< $key_cpp$, $val_cpp$ >*\n"
+    "    mutable_$name$()$deprecation$;\n", '$' };
+  printer->Print(variables_, accessor_declarations.Get());
 }
 
 void MapFieldGenerator::
@@ -137,42 +139,49 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
                                   bool is_inline) const {
   map<string, string> variables(variables_);
   variables["inline"] = is_inline ? "inline" : "";
-  printer->Print(variables,
-      "$inline$ const ::google::protobuf::Map< $key_cpp$, $val_cpp$ >&\n"
-      "$classname$::$name$() const {\n"
-      "  // @@protoc_insertion_point(field_map:$full_name$)\n"
-      "  return $name$_.GetMap();\n"
-      "}\n"
-      "$inline$ ::google::protobuf::Map< $key_cpp$, $val_cpp$ >*\n"
-      "$classname$::mutable_$name$() {\n"
-      "  // @@protoc_insertion_point(field_mutable_map:$full_name$)\n"
-      "  return $name$_.MutableMap();\n"
-      "}\n");
+  static io::LazyPrinterTemplate inline_accessor_definitions = {
+    "$inline$ const ::google::protobuf::Map< $key_cpp$, $val_cpp$ >&\n"
+    "$classname$::$name$() const {\n"
+    "  // @@protoc_insertion_point(field_map:$full_name$)\n"
+    "  return $name$_.GetMap();\n"
+    "}\n"
+    "$inline$ ::google::protobuf::Map< $key_cpp$, $val_cpp$ >*\n"
+    "$classname$::mutable_$name$() {\n"
+    "  // @@protoc_insertion_point(field_mutable_map:$full_name$)\n"
+    "  return $name$_.MutableMap();\n"
+    "}\n", '$' };
+  printer->Print(variables, inline_accessor_definitions.Get());
 }
 
 void MapFieldGenerator::
 GenerateClearingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.Clear();\n");
+  static io::LazyPrinterTemplate clearing_code = { "$name$_.Clear();\n", '$' };
+  printer->Print(variables_, clearing_code.Get());
 }
 
 void MapFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.MergeFrom(from.$name$_);\n");
+  static io::LazyPrinterTemplate merging_code = {
+    "$name$_.MergeFrom(from.$name$_);\n", '$' };
+  printer->Print(variables_, merging_code.Get());
 }
 
 void MapFieldGenerator::
 GenerateSwappingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.Swap(&other->$name$_);\n");
+  static io::LazyPrinterTemplate swapping_code = {
+    "$name$_.Swap(&other->$name$_);\n", '$' };
+  printer->Print(variables_, swapping_code.Get());
 }
 
 void MapFieldGenerator::
 GenerateConstructorCode(io::Printer* printer) const {
   if (HasDescriptorMethods(descriptor_->file())) {
-    printer->Print(variables_,
-        "$name$_.SetAssignDescriptorCallback(\n"
-        "    protobuf_AssignDescriptorsOnce);\n"
-        "$name$_.SetEntryDescriptor(\n"
-        "    &$type$_descriptor_);\n");
+    static io::LazyPrinterTemplate constructor_code = {
+      "$name$_.SetAssignDescriptorCallback(\n"
+      "    protobuf_AssignDescriptorsOnce);\n"
+      "$name$_.SetEntryDescriptor(\n"
+      "    &$type$_descriptor_);\n", '$' };
+    printer->Print(variables_, constructor_code.Get());
   }
 }
 
@@ -180,8 +189,10 @@ void MapFieldGenerator::
 GenerateMergeFromCodedStream(io::Printer* printer) const {
   const FieldDescriptor* value_field =
       descriptor_->message_type()->FindFieldByName("value");
-  printer->Print(variables_,
-      "::google::protobuf::scoped_ptr<$map_classname$> entry($name$_.NewEntry());\n");
+  static io::LazyPrinterTemplate new_entry = {
+    "::google::protobuf::scoped_ptr<$map_classname$> entry($name$_.NewEntry());\n",
+    '$' };
+  printer->Print(variables_, new_entry.Get());
 
   if (IsProto3Field(descriptor_) ||
       value_field->type() != FieldDescriptor::TYPE_ENUM) {
@@ -189,40 +200,50 @@ GenerateMergeFromCodedStream(io::Printer* printer) const {
         "DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(\n"
         "    input, entry.get()));\n");
     switch (value_field->cpp_type()) {
-      case FieldDescriptor::CPPTYPE_MESSAGE:
-        printer->Print(variables_,
-            "(*mutable_$name$())[entry->key()].Swap("
-            "entry->mutable_value());\n");
+      case FieldDescriptor::CPPTYPE_MESSAGE: {
+        static io::LazyPrinterTemplate swap_message_value = {
+          "(*mutable_$name$())[entry->key()].Swap("
+          "entry->mutable_value());\n", '$' };
+        printer->Print(variables_, swap_message_value.Get());
         break;
-      case FieldDescriptor::CPPTYPE_ENUM:
-        printer->Print(variables_,
-            "(*mutable_$name$())[entry->key()] =\n"
-            "    static_cast<$val_cpp$>(*entry->mutable_value());\n");
+      }
+      case FieldDescriptor::CPPTYPE_ENUM: {
+        static io::LazyPrinterTemplate set_enum_value = {
+          "(*mutable_$name$())[entry->key()] =\n"
+          "    static_cast<$val_cpp$>(*entry->mutable_value());\n", '$' };
+        printer->Print(variables_, set_enum_value.Get());
         break;
-      default:
-        printer->Print(variables_,
-            "(*mutable_$name$())[entry->key()] = *entry->mutable_value();\n");
+      }
+      default: {
+        static io::LazyPrinterTemplate set_value = {
+          "(*mutable_$name$())[entry->key()] = *entry->mutable_value();\n",
+          '$' };
+        printer->Print(variables_, set_value.Get());
         break;
+      }
     }
   } else {
-    printer->Print(variables_,
-        "{\n"
-        "  ::std::string data;\n"
-        "  DO_(::google::protobuf::internal::WireFormatLite::ReadString(input, &data));\n"
-        "  DO_(entry->ParseFromString(data));\n"
-        "  if ($val_cpp$_IsValid(*entry->mutable_value())) {\n"
-        "    (*mutable_$name$())[entry->key()] =\n"
-        "        static_cast<$val_cpp$>(*entry->mutable_value());\n"
-        "  } else {\n");
+    static io::LazyPrinterTemplate parse_closed_enum_entry = {
+      "{\n"
+      "  ::std::string data;\n"
+      "  DO_(::google::protobuf::internal::WireFormatLite::ReadString(input, &data));\n"
+      "  DO_(entry->ParseFromString(data));\n"
+      "  if ($val_cpp$_IsValid(*entry->mutable_value())) {\n"
+      "    (*mutable_$name$())[entry->key()] =\n"
+      "        static_cast<$val_cpp$>(*entry->mutable_value());\n"
+      "  } else {\n", '$' };
+    printer->Print(variables_, parse_closed_enum_entry.Get());
     if (HasDescriptorMethods(descriptor_->file())) {
-      printer->Print(variables_,
-          "    mutable_unknown_fields()"
-          "->AddLengthDelimited($number$, data);\n");
+      static io::LazyPrinterTemplate keep_unknown_entry = {
+        "    mutable_unknown_fields()"
+        "->AddLengthDelimited($number$, data);\n", '$' };
+      printer->Print(variables_, keep_unknown_entry.Get());
     } else {
-      printer->Print(variables_,
-          "    unknown_fields_stream.WriteVarint32($tag$);\n"
-          "    unknown_fields_stream.WriteVarint32(data.size());\n"
-          "    unknown_fields_stream.WriteString(data);\n");
+      static io::LazyPrinterTemplate write_unknown_entry = {
+        "    unknown_fields_stream.WriteVarint32($tag$);\n"
+        "    unknown_fields_stream.WriteVarint32(data.size());\n"
+        "    unknown_fields_stream.WriteString(data);\n", '$' };
+      printer->Print(variables_, write_unknown_entry.Get());
     }
 
 
@@ -240,11 +261,12 @@ GenerateMergeFromCodedStream(io::Printer* printer) const {
 
 void MapFieldGenerator::
 GenerateSerializeWithCachedSizes(io::Printer* printer) const {
-  printer->Print(variables_,
-      "{\n"
-      "  ::google::protobuf::scoped_ptr<$map_classname$> entry;\n"
-      "  for (::google::protobuf::Map< $key_cpp$, $val_cpp$ >::const_iterator\n"
-      "      it = $name$().begin(); it != $name$().end(); ++it) {\n");
+  static io::LazyPrinterTemplate loop_start = {
+    "{\n"
+    "  ::google::protobuf::scoped_ptr<$map_classname$> entry;\n"
+    "  for (::google::protobuf::Map< $key_cpp$, $val_cpp$ >::const_iterator\n"
+    "      it = $name$().begin(); it != $name$().end(); ++it) {\n", '$' };
+  printer->Print(variables_, loop_start.Get());
 
   // If entry is allocated by arena, its desctructor should be avoided.
   if (SupportsArenas(descriptor_)) {
@@ -254,11 +276,12 @@ GenerateSerializeWithCachedSizes(io::Printer* printer) const {
         "    }\n");
   }
 
-  printer->Print(variables_,
-      "    entry.reset($name$_.New$wrapper$(it->first, it->second));\n"
-      "    ::google::protobuf::internal::WireFormatLite::Write$stream_writer$(\n"
-      "        $number$, *entry, output);\n"
-      "  }\n");
+  static io::LazyPrinterTemplate write_entry = {
+    "    entry.reset($name$_.New$wrapper$(it->first, it->second));\n"
+    "    ::google::protobuf::internal::WireFormatLite::Write$stream_writer$(\n"
+    "        $number$, *entry, output);\n"
+    "  }\n", '$' };
+  printer->Print(variables_, write_entry.Get());
 
   // If entry is allocated by arena, its desctructor should be avoided.
   if (SupportsArenas(descriptor_)) {
@@ -273,11 +296,12 @@ GenerateSerializeWithCachedSizes(io::Printer* printer) const {
 
 void MapFieldGenerator::
 GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const {
-  printer->Print(variables_,
-      "{\n"
-      "  ::google::protobuf::scoped_ptr<$map_classname$> entry;\n"
-      "  for (::google::protobuf::Map< $key_cpp$, $val_cpp$ >::const_iterator\n"
-      "      it = $name$().begin(); it != $name$().end(); ++it) {\n");
+  static io::LazyPrinterTemplate loop_start = {
+    "{\n"
+    "  ::google::protobuf::scoped_ptr<$map_classname$> entry;\n"
+    "  for (::google::protobuf::Map< $key_cpp$, $val_cpp$ >::const_iterator\n"
+    "      it = $name$().begin(); it != $name$().end(); ++it) {\n", '$' };
+  printer->Print(variables_, loop_start.Get());
 
   // If entry is allocated by arena, its desctructor should be avoided.
   if (SupportsArenas(descriptor_)) {
@@ -287,12 +311,13 @@ GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const {
         "    }\n");
   }
 
-  printer->Print(variables_,
-      "    entry.reset($name$_.New$wrapper$(it->first, it->second));\n"
-      "    target = ::google::protobuf::internal::WireFormatLite::\n"
-      "        Write$declared_type$NoVirtualToArray(\n"
-      "            $number$, *entry, target);\n"
-      "  }\n");
+  static io::LazyPrinterTemplate write_entry = {
+    "    entry.reset($name$_.New$wrapper$(it->first, it->second));\n"
+    "    target = ::google::protobuf::internal::WireFormatLite::\n"
+    "        Write$declared_type$NoVirtualToArray(\n"
+    "            $number$, *entry, target);\n"
+    "  }\n", '$' };
+  printer->Print(variables_, write_entry.Get());
 
   // If entry is allocated by arena, its desctructor should be avoided.
   if (SupportsArenas(descriptor_)) {
@@ -307,12 +332,13 @@ GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const {
 
 void MapFieldGenerator::
 GenerateByteSize(io::Printer* printer) const {
-  printer->Print(variables_,
-      "total_size += $tag_size$ * this->$name$_size();\n"
-      "{\n"
-      "  ::google::protobuf::scoped_ptr<$map_classname$> entry;\n"
-      "  for (::google::protobuf::Map< $key_cpp$, $val_cpp$ >::const_iterator\n"
-      "      it = $name$().begin(); it != $name$().end(); ++it) {\n");
+  static io::LazyPrinterTemplate loop_start = {
+    "total_size += $tag_size$ * this->$name$_size();\n"
+    "{\n"
+    "  ::google::protobuf::scoped_ptr<$map_classname$> entry;\n"
+    "  for (::google::protobuf::Map< $key_cpp$, $val_cpp$ >::const_iterator\n"
+    "      it = $name$().begin(); it != $name$().end(); ++it) {\n", '$' };
+  printer->Print(variables_, loop_start.Get());
 
   // If entry is allocated by arena, its desctructor should be avoided.
   if (SupportsArenas(descriptor_)) {
@@ -322,11 +348,12 @@ GenerateByteSize(io::Printer* printer) const {
         "    }\n");
   }
 
-  printer->Print(variables_,
-      "    entry.reset($name$_.New$wrapper$(it->first, it->second));\n"
-      "    total_size += ::google::protobuf::internal::WireFormatLite::\n"
-      "        $declared_type$SizeNoVirtual(*entry);\n"
-      "  }\n");
+  static io::LazyPrinterTemplate entry_size = {
+    "    entry.reset($name$_.New$wrapper$(it->first, it->second));\n"
+    "    total_size += ::google::protobuf::internal::WireFormatLite::\n"
+    "        $declared_type$SizeNoVirtual(*entry);\n"
+    "  }\n", '$' };
+  printer->Print(variables_, entry_size.Get());
 
   // If entry is allocated by arena, its desctructor should be avoided.
   if (SupportsArenas(descriptor_)) {
@@ -68,8 +68,8 @@ void PrintFieldComment(io::Printer* printer, const FieldDescriptor* field) {
   // Print the field's proto-syntax definition as a comment.  We don't want to
   // print group bodies so we cut off after the first line.
   string def = field->DebugString();
-  printer->Print("// $def$\n",
-    "def", def.substr(0, def.find_first_of('\n')));
+  static io::LazyPrinterTemplate comment = { "// $def$\n", '$' };
+  printer->Print(comment.Get(), "def", def.substr(0, def.find_first_of('\n')));
 }
 
 struct FieldOrderingByNumber {
@@ -291,28 +291,31 @@ bool EmitFieldNonDefaultCondition(io::Printer* printer,
   // if non-zero (numeric) or non-empty (string).
   if (!field->is_repeated() && !field->containing_oneof()) {
     if (field->cpp_type() == FieldDescriptor::CPPTYPE_STRING) {
-      printer->Print(
-          "if ($prefix$$name$().size() > 0) {\n",
+      static io::LazyPrinterTemplate non_empty = {
+          "if ($prefix$$name$().size() > 0) {\n", '$' };
+      printer->Print(non_empty.Get(),
           "prefix", prefix,
           "name", FieldName(field));
     } else if (field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
       // Message fields still have has_$name$() methods.
-      printer->Print(
-          "if ($prefix$has_$name$()) {\n",
+      static io::LazyPrinterTemplate has = {
+          "if ($prefix$has_$name$()) {\n", '$' };
+      printer->Print(has.Get(),
           "prefix", prefix,
           "name", FieldName(field));
     } else {
-      printer->Print(
-          "if ($prefix$$name$() != 0) {\n",
+      static io::LazyPrinterTemplate non_zero = {
+          "if ($prefix$$name$() != 0) {\n", '$' };
+      printer->Print(non_zero.Get(),
           "prefix", prefix,
           "name", FieldName(field));
     }
     printer->Indent();
     return true;
   } else if (field->containing_oneof()) {
-    printer->Print(
-        "if (has_$name$()) {\n",
-        "name", FieldName(field));
+    static io::LazyPrinterTemplate oneof_has = {
+        "if (has_$name$()) {\n", '$' };
+    printer->Print(oneof_has.Get(), "name", FieldName(field));
     printer->Indent();
     return true;
   }
@@ -443,6 +446,17 @@ GenerateGetEnumDescriptorSpecializations(io::Printer* printer) {
 
 void MessageGenerator::
 GenerateFieldAccessorDeclarations(io::Printer* printer) {
+  const io::PrinterTemplate size_decl(
+      "int $name$_size() const$deprecation$;\n", '$');
+  const io::PrinterTemplate has_decl(
+      "bool has_$name$() const$deprecation$;\n", '$');
+  const io::PrinterTemplate private_has_decl(
+      "private:\n"
+      "bool has_$name$() const$deprecation$;\n"
+      "public:\n", '$');
+  const io::PrinterTemplate clear_decl(
+      "void clear_$name$()$deprecation$;\n"
+      "static const int $constant_name$ = $number$;\n", '$');
   for (int i = 0; i < descriptor_->field_count(); i++) {
     const FieldDescriptor* field = descriptor_->field(i);
 
@@ -453,18 +467,14 @@ GenerateFieldAccessorDeclarations(io::Printer* printer) {
     vars["constant_name"] = FieldConstantName(field);
 
     if (field->is_repeated()) {
-      printer->Print(vars, "int $name$_size() const$deprecation$;\n");
+      printer->Print(vars, size_decl);
     } else if (HasHasMethod(field)) {
-      printer->Print(vars, "bool has_$name$() const$deprecation$;\n");
+      printer->Print(vars, has_decl);
     } else if (HasPrivateHasMethod(field)) {
-      printer->Print(vars,
-          "private:\n"
-          "bool has_$name$() const$deprecation$;\n"
-          "public:\n");
+      printer->Print(vars, private_has_decl);
     }
 
-    printer->Print(vars, "void clear_$name$()$deprecation$;\n");
-    printer->Print(vars, "static const int $constant_name$ = $number$;\n");
+    printer->Print(vars, clear_decl);
 
     // Generate type-specific accessor declarations.
     field_generators_.get(field).GenerateAccessorDeclarations(printer);
@@ -493,6 +503,23 @@ void MessageGenerator::
 GenerateFieldAccessorDefinitions(io::Printer* printer, bool is_inline) {
   printer->Print("// $classname$\n\n", "classname", classname_);
 
+  const io::PrinterTemplate size_definition(
+      "$inline$ int $classname$::$name$_size() const {\n"
+      "  return $name$_.size();\n"
+      "}\n", '$');
+  const io::PrinterTemplate has_bit_definitions(
+      "$inline$ bool $classname$::has_$name$() const {\n"
+      "  return (_has_bits_[$has_array_index$] & 0x$has_mask$u) != 0;\n"
+      "}\n"
+      "$inline$ void $classname$::set_has_$name$() {\n"
+      "  _has_bits_[$has_array_index$] |= 0x$has_mask$u;\n"
+      "}\n"
+      "$inline$ void $classname$::clear_has_$name$() {\n"
+      "  _has_bits_[$has_array_index$] &= ~0x$has_mask$u;\n"
+      "}\n", '$');
+  const io::PrinterTemplate clear_definition_start(
+      "$inline$ void $classname$::clear_$name$() {\n", '$');
+  const io::PrinterTemplate clear_has_call("clear_has_$name$();\n", '$');
   for (int i = 0; i < descriptor_->field_count(); i++) {
     const FieldDescriptor* field = descriptor_->field(i);
 
@@ -504,10 +531,7 @@ GenerateFieldAccessorDefinitions(io::Printer* printer, bool is_inline) {
 
     // Generate has_$name$() or $name$_size().
     if (field->is_repeated()) {
-      printer->Print(vars,
-        "$inline$ int $classname$::$name$_size() const {\n"
-        "  return $name$_.size();\n"
-        "}\n");
+      printer->Print(vars, size_definition);
     } else if (field->containing_oneof()) {
       // Singular field in a oneof
       // N.B.: Without field presence, we do not use has-bits or generate
@@ -535,17 +559,7 @@ GenerateFieldAccessorDefinitions(io::Printer* printer, bool is_inline) {
         vars["has_array_index"] = SimpleItoa(field->index() / 32);
         vars["has_mask"] = FastHex32ToBuffer(1u << (field->index() % 32),
                                              buffer);
-        printer->Print(vars,
-          "$inline$ bool $classname$::has_$name$() const {\n"
-          "  return (_has_bits_[$has_array_index$] & 0x$has_mask$u) != 0;\n"
-          "}\n"
-          "$inline$ void $classname$::set_has_$name$() {\n"
-          "  _has_bits_[$has_array_index$] |= 0x$has_mask$u;\n"
-          "}\n"
-          "$inline$ void $classname$::clear_has_$name$() {\n"
-          "  _has_bits_[$has_array_index$] &= ~0x$has_mask$u;\n"
-          "}\n"
-          );
+        printer->Print(vars, has_bit_definitions);
       } else {
         // Message fields have a has_$name$() method.
         if (field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
@@ -566,8 +580,7 @@ GenerateFieldAccessorDefinitions(io::Printer* printer, bool is_inline) {
     }
 
     // Generate clear_$name$()
-    printer->Print(vars,
-      "$inline$ void $classname$::clear_$name$() {\n");
+    printer->Print(vars, clear_definition_start);
 
     printer->Indent();
 
@@ -586,8 +599,7 @@ GenerateFieldAccessorDefinitions(io::Printer* printer, bool is_inline) {
       field_generators_.get(field).GenerateClearingCode(printer);
       if (HasFieldPresence(descriptor_->file())) {
         if (!field->is_repeated()) {
-          printer->Print(vars,
-                         "clear_has_$name$();\n");
+          printer->Print(vars, clear_has_call);
         }
       }
     }
@@ -949,35 +961,37 @@ GenerateClassDefinition(io::Printer* printer) {
   printer->Indent();
 
 
+  const io::PrinterTemplate set_has_decl(
+      "inline void set_has_$name$();\n", '$');
+  const io::PrinterTemplate clear_has_decl(
+      "inline void clear_has_$name$();\n", '$');
   for (int i = 0; i < descriptor_->field_count(); i++) {
     if (!descriptor_->field(i)->is_repeated()) {
+      const string name = FieldName(descriptor_->field(i));
       // set_has_***() generated in all proto1/2 code and in oneofs (only) for
       // messages without true field presence.
       if (HasFieldPresence(descriptor_->file()) ||
           descriptor_->field(i)->containing_oneof()) {
-        printer->Print(
-          "inline void set_has_$name$();\n",
-          "name", FieldName(descriptor_->field(i)));
+        printer->Print(set_has_decl, "name", name);
       }
       // clear_has_***() generated only for non-oneof fields
       // in proto1/2.
       if (!descriptor_->field(i)->containing_oneof() &&
           HasFieldPresence(descriptor_->file())) {
-        printer->Print(
-          "inline void clear_has_$name$();\n",
-          "name", FieldName(descriptor_->field(i)));
+        printer->Print(clear_has_decl, "name", name);
       }
     }
   }
   printer->Print("\n");
 
   // Generate oneof function declarations
+  const io::PrinterTemplate oneof_decls(
+      "inline bool has_$oneof_name$() const;\n"
+      "void clear_$oneof_name$();\n"
+      "inline void clear_has_$oneof_name$();\n\n", '$');
   for (int i = 0; i < descriptor_->oneof_decl_count(); i++) {
-    printer->Print(
-        "inline bool has_$oneof_name$() const;\n"
-        "void clear_$oneof_name$();\n"
-        "inline void clear_has_$oneof_name$();\n\n",
-        "oneof_name", descriptor_->oneof_decl(i)->name());
+    printer->Print(oneof_decls,
+                   "oneof_name", descriptor_->oneof_decl(i)->name());
   }
 
   if (HasGeneratedMethods(descriptor_->file()) &&
@@ -1604,29 +1618,30 @@ GenerateOffsets(io::Printer* printer) {
         1, descriptor_->field_count() + descriptor_->oneof_decl_count())));
   printer->Indent();
 
+  const io::PrinterTemplate oneof_field_offset(
+      "PROTO2_GENERATED_DEFAULT_ONEOF_FIELD_OFFSET("
+      "$classname$_default_oneof_instance_, $name$_),\n", '$');
+  const io::PrinterTemplate field_offset(
+      "GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET($classname$, "
+                                             "$name$_),\n", '$');
   for (int i = 0; i < descriptor_->field_count(); i++) {
     const FieldDescriptor* field = descriptor_->field(i);
     if (field->containing_oneof()) {
-      printer->Print(
-          "PROTO2_GENERATED_DEFAULT_ONEOF_FIELD_OFFSET("
-          "$classname$_default_oneof_instance_, $name$_),\n",
-          "classname", classname_,
-          "name", FieldName(field));
+      printer->Print(oneof_field_offset,
+                     "classname", classname_,
+                     "name", FieldName(field));
     } else {
-      printer->Print(
-          "GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET($classname$, "
-                                                 "$name$_),\n",
-          "classname", classname_,
-          "name", FieldName(field));
+      printer->Print(field_offset,
+                     "classname", classname_,
+                     "name", FieldName(field));
     }
   }
 
   for (int i = 0; i < descriptor_->oneof_decl_count(); i++) {
     const OneofDescriptor* oneof = descriptor_->oneof_decl(i);
-    printer->Print(
-      "GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET($classname$, $name$_),\n",
-      "classname", classname_,
-      "name", oneof->name());
+    printer->Print(field_offset,
+                   "classname", classname_,
+                   "name", oneof->name());
   }
 
   printer->Outdent();
@@ -2406,6 +2421,7 @@ GenerateMergeFrom(io::Printer* printer) {
   // Merge Optional and Required fields (after a _has_bit check).
   int last_index = -1;
 
+  const io::PrinterTemplate from_has("if (from.has_$name$()) {\n", '$');
   for (int i = 0; i < descriptor_->field_count(); ++i) {
     const FieldDescriptor* field = descriptor_->field(i);
 
@@ -2429,9 +2445,7 @@ GenerateMergeFrom(io::Printer* printer) {
 
       bool have_enclosing_if = false;
       if (HasFieldPresence(descriptor_->file())) {
-        printer->Print(
-          "if (from.has_$name$()) {\n",
-          "name", FieldName(field));
+        printer->Print(from_has, "name", FieldName(field));
         printer->Indent();
         have_enclosing_if = true;
       } else {
@@ -2585,25 +2599,30 @@ GenerateMergeFromCodedStream(io::Printer* printer) {
 
     printer->Indent();
 
+    const io::PrinterTemplate case_start("case $number$: {\n", '$');
+    const io::PrinterTemplate common_tag("if (tag == $commontag$) {\n", '$');
+    const io::PrinterTemplate parse_label(" parse_$name$:\n", '$');
+    const io::PrinterTemplate uncommon_tag(
+        "} else if (tag == $uncommontag$) {\n", '$');
+    const io::PrinterTemplate expect_repeat(
+        "if (input->ExpectTag($tag$)) goto parse_$name$;\n", '$');
+    const io::PrinterTemplate expect_next(
+        "if (input->ExpectTag($next_tag$)) goto parse_$next_name$;\n", '$');
     for (int i = 0; i < descriptor_->field_count(); i++) {
       const FieldDescriptor* field = ordered_fields[i];
 
       PrintFieldComment(printer, field);
 
-      printer->Print(
-        "case $number$: {\n",
-        "number", SimpleItoa(field->number()));
+      printer->Print(case_start, "number", SimpleItoa(field->number()));
       printer->Indent();
       const FieldGenerator& field_generator = field_generators_.get(field);
 
       // Emit code to parse the common, expected case.
-      printer->Print("if (tag == $commontag$) {\n",
+      printer->Print(common_tag,
                      "commontag", SimpleItoa(WireFormat::MakeTag(field)));
 
       if (i > 0 || (field->is_repeated() && !field->options().packed())) {
-        printer->Print(
-          " parse_$name$:\n",
-          "name", field->name());
+        printer->Print(parse_label, "name", field->name());
       }
 
       printer->Indent();
@@ -2618,7 +2637,7 @@ GenerateMergeFromCodedStream(io::Printer* printer) {
       if (field->is_packable() && field->options().packed()) {
         internal::WireFormatLite::WireType wiretype =
             WireFormat::WireTypeForFieldType(field->type());
-        printer->Print("} else if (tag == $uncommontag$) {\n",
+        printer->Print(uncommon_tag,
                        "uncommontag", SimpleItoa(
                            internal::WireFormatLite::MakeTag(
                                field->number(), wiretype)));
@@ -2628,7 +2647,7 @@ GenerateMergeFromCodedStream(io::Printer* printer) {
       } else if (field->is_packable() && !field->options().packed()) {
         internal::WireFormatLite::WireType wiretype =
             internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED;
-        printer->Print("} else if (tag == $uncommontag$) {\n",
+        printer->Print(uncommon_tag,
                        "uncommontag", SimpleItoa(
                            internal::WireFormatLite::MakeTag(
                                field->number(), wiretype)));
@@ -2647,7 +2666,7 @@ GenerateMergeFromCodedStream(io::Printer* printer) {
       if (field->is_repeated() && !field->options().packed()) {
         // Expect repeats of this field.
         printer->Print(
-          "if (input->ExpectTag($tag$)) goto parse_$name$;\n",
+          expect_repeat,
           "tag", SimpleItoa(WireFormat::MakeTag(field)),
           "name", field->name());
       }
@@ -2656,7 +2675,7 @@ GenerateMergeFromCodedStream(io::Printer* printer) {
         // Expect the next field in order.
         const FieldDescriptor* next_field = ordered_fields[i + 1];
         printer->Print(
-          "if (input->ExpectTag($next_tag$)) goto parse_$next_name$;\n",
+          expect_next,
           "next_tag", SimpleItoa(WireFormat::MakeTag(next_field)),
           "next_name", next_field->name());
       } else {
@@ -2791,9 +2810,8 @@ void MessageGenerator::GenerateSerializeOneField(
 
   bool have_enclosing_if = false;
   if (!field->is_repeated() && HasFieldPresence(descriptor_->file())) {
-    printer->Print(
-      "if (has_$name$()) {\n",
-      "name", FieldName(field));
+    static io::LazyPrinterTemplate has = { "if (has_$name$()) {\n", '$' };
+    printer->Print(has.Get(), "name", FieldName(field));
     printer->Indent();
     have_enclosing_if = true;
   } else if (!HasFieldPresence(descriptor_->file())) {
@@ -3124,6 +3142,7 @@ GenerateByteSize(io::Printer* printer) {
 
   int last_index = -1;
   bool chunk_block_in_progress = false;
+  const io::PrinterTemplate has("if (has_$name$()) {\n", '$');
   for (int i = 0; i < descriptor_->field_count(); i++) {
     const FieldDescriptor* field = descriptor_->field(i);
     if (!field->is_required() && !field->is_repeated() &&
@@ -3161,9 +3180,7 @@ GenerateByteSize(io::Printer* printer) {
 
       bool have_enclosing_if = false;
       if (HasFieldPresence(descriptor_->file())) {
-        printer->Print(
-          "if (has_$name$()) {\n",
-          "name", FieldName(field));
+        printer->Print(has, "name", FieldName(field));
         printer->Indent();
         have_enclosing_if = true;
       } else {
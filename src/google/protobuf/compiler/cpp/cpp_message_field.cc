@@ -80,52 +80,63 @@ MessageFieldGenerator::~MessageFieldGenerator() {}
 
 void MessageFieldGenerator::
 GeneratePrivateMembers(io::Printer* printer) const {
-  printer->Print(variables_, "$type$* $name$_;\n");
+  static io::LazyPrinterTemplate private_members = {
+    "$type$* $name$_;\n", '$' };
+  printer->Print(variables_, private_members.Get());
 }
 
 void MessageFieldGenerator::
 GenerateAccessorDeclarations(io::Printer* printer) const {
   if (SupportsArenas(descriptor_)) {
-    printer->Print(variables_,
-       "private:\n"
-       "void _slow_mutable_$name$()$deprecation$;\n");
+    static io::LazyPrinterTemplate slow_mutable_declaration = {
+      "private:\n"
+      "void _slow_mutable_$name$()$deprecation$;\n", '$' };
+    printer->Print(variables_, slow_mutable_declaration.Get());
     if (SupportsArenas(descriptor_->message_type())) {
-      printer->Print(variables_,
-       "void _slow_set_allocated_$name$(\n"
-       "    ::google::protobuf::Arena* message_arena, $type$** $name$)$deprecation$;\n");
+      static io::LazyPrinterTemplate slow_set_allocated_declaration = {
+        "void _slow_set_allocated_$name$(\n"
+        "    ::google::protobuf::Arena* message_arena, $type$** $name$)$deprecation$;\n",
+        '$' };
+      printer->Print(variables_, slow_set_allocated_declaration.Get());
     }
-    printer->Print(variables_,
-       "$type$* _slow_$release_name$()$deprecation$;\n"
-       "public:\n");
+    static io::LazyPrinterTemplate slow_release_declaration = {
+      "$type$* _slow_$release_name$()$deprecation$;\n"
+      "public:\n", '$' };
+    printer->Print(variables_, slow_release_declaration.Get());
   }
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate accessor_declarations = {
     "const $type$& $name$() const$deprecation$;\n"
     "$type$* mutable_$name$()$deprecation$;\n"
     "$type$* $release_name$()$deprecation$;\n"
-    "void set_allocated_$name$($type$* $name$)$deprecation$;\n");
+    "void set_allocated_$name$($type$* $name$)$deprecation$;\n", '$' };
+  printer->Print(variables_, accessor_declarations.Get());
   if (SupportsArenas(descriptor_)) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate unsafe_arena_accessor_declarations = {
       "$type$* unsafe_arena_release_$name$()$deprecation$;\n"
       "void unsafe_arena_set_allocated_$name$(\n"
-      "    $type$* $name$)$deprecation$;\n");
+      "    $type$* $name$)$deprecation$;\n", '$' };
+    printer->Print(variables_, unsafe_arena_accessor_declarations.Get());
   }
 }
 
 void MessageFieldGenerator::GenerateNonInlineAccessorDefinitions(
     io::Printer* printer) const {
   if (SupportsArenas(descriptor_)) {
-    printer->Print(variables_,
-      "void $classname$::_slow_mutable_$name$() {\n");
+    static io::LazyPrinterTemplate slow_mutable_start = {
+      "void $classname$::_slow_mutable_$name$() {\n", '$' };
+    printer->Print(variables_, slow_mutable_start.Get());
       if (SupportsArenas(descriptor_->message_type())) {
-        printer->Print(variables_,
-        "  $name$_ = ::google::protobuf::Arena::CreateMessage< $type$ >(\n"
-      "        GetArenaNoVirtual());\n");
+        static io::LazyPrinterTemplate create_message = {
+          "  $name$_ = ::google::protobuf::Arena::CreateMessage< $type$ >(\n"
+          "        GetArenaNoVirtual());\n", '$' };
+        printer->Print(variables_, create_message.Get());
       } else {
-        printer->Print(variables_,
-         "  $name$_ = ::google::protobuf::Arena::Create< $type$ >(\n"
-         "     GetArenaNoVirtual());\n");
+        static io::LazyPrinterTemplate create_object = {
+          "  $name$_ = ::google::protobuf::Arena::Create< $type$ >(\n"
+          "     GetArenaNoVirtual());\n", '$' };
+        printer->Print(variables_, create_object.Get());
       }
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate slow_mutable_end_and_releases = {
       "}\n"
       "$type$* $classname$::_slow_$release_name$() {\n"
       "  if ($name$_ == NULL) {\n"
@@ -142,9 +153,10 @@ void MessageFieldGenerator::GenerateNonInlineAccessorDefinitions(
       "  $type$* temp = $name$_;\n"
       "  $name$_ = NULL;\n"
       "  return temp;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, slow_mutable_end_and_releases.Get());
     if (SupportsArenas(descriptor_->message_type())) {
-        printer->Print(variables_,
+        static io::LazyPrinterTemplate slow_set_allocated_definition = {
           "void $classname$::_slow_set_allocated_$name$(\n"
           "    ::google::protobuf::Arena* message_arena, $type$** $name$) {\n"
           "    if (message_arena != NULL && \n"
@@ -158,13 +170,14 @@ void MessageFieldGenerator::GenerateNonInlineAccessorDefinitions(
           "      new_$name$->CopyFrom(**$name$);\n"
           "      *$name$ = new_$name$;\n"
           "    }\n"
-          "}\n");
+          "}\n", '$' };
+        printer->Print(variables_, slow_set_allocated_definition.Get());
     }
-    printer->Print(variables_,
+    // If we're not on an arena, free whatever we were holding before.
+    // (If we are on arena, we can just forget the earlier pointer.)
+    static io::LazyPrinterTemplate unsafe_arena_set_allocated_definition = {
       "void $classname$::unsafe_arena_set_allocated_$name$(\n"
       "    $type$* $name$) {\n"
-      // If we're not on an arena, free whatever we were holding before.
-      // (If we are on arena, we can just forget the earlier pointer.)
       "  if (GetArenaNoVirtual() == NULL) {\n"
       "    delete $name$_;\n"
       "  }\n"
@@ -176,7 +189,8 @@ void MessageFieldGenerator::GenerateNonInlineAccessorDefinitions(
       "  }\n"
       "  // @@protoc_insertion_point(field_unsafe_arena_set_allocated"
       ":$full_name$)\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, unsafe_arena_set_allocated_definition.Get());
   }
 }
 
@@ -185,9 +199,10 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
                                   bool is_inline) const {
   map<string, string> variables(variables_);
   variables["inline"] = is_inline ? "inline" : "";
-  printer->Print(variables,
+  static io::LazyPrinterTemplate getter_start = {
     "$inline$ const $type$& $classname$::$name$() const {\n"
-    "  // @@protoc_insertion_point(field_get:$full_name$)\n");
+    "  // @@protoc_insertion_point(field_get:$full_name$)\n", '$' };
+  printer->Print(variables, getter_start.Get());
 
   PrintHandlingOptionalStaticInitializers(
     variables, descriptor_->file(), printer,
@@ -197,7 +212,7 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
     "  return $name$_ != NULL ? *$name$_ : *default_instance().$name$_;\n");
 
   if (SupportsArenas(descriptor_)) {
-    printer->Print(variables,
+    static io::LazyPrinterTemplate arena_accessors_start = {
       "}\n"
       "$inline$ $type$* $classname$::mutable_$name$() {\n"
       "  $set_hasbit$\n"
@@ -222,22 +237,25 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
       "  if (message_arena == NULL) {\n"
       "    delete $name$_;\n"
       "  }\n"
-      "  if ($name$ != NULL) {\n");
+      "  if ($name$ != NULL) {\n", '$' };
+    printer->Print(variables, arena_accessors_start.Get());
     if (SupportsArenas(descriptor_->message_type())) {
       // If we're on an arena and the incoming message is not, simply Own() it
       // rather than copy to the arena -- either way we need a heap dealloc,
       // so we might as well defer it. Otherwise, if incoming message is on a
       // different ownership domain (specific arena, or the heap) than we are,
       // copy to our arena (or heap, as the case may be).
-      printer->Print(variables,
-        "    _slow_set_allocated_$name$(message_arena, &$name$);\n");
+      static io::LazyPrinterTemplate slow_set_allocated_call = {
+        "    _slow_set_allocated_$name$(message_arena, &$name$);\n", '$' };
+      printer->Print(variables, slow_set_allocated_call.Get());
     } else {
-      printer->Print(variables,
+      static io::LazyPrinterTemplate own_message = {
         "    if (message_arena != NULL) {\n"
         "      message_arena->Own($name$);\n"
-        "    }\n");
+        "    }\n", '$' };
+      printer->Print(variables, own_message.Get());
     }
-    printer->Print(variables,
+    static io::LazyPrinterTemplate set_allocated_end = {
       "  }\n"
       "  $name$_ = $name$;\n"
       "  if ($name$) {\n"
@@ -246,9 +264,10 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
       "    $clear_hasbit$\n"
       "  }\n"
       "  // @@protoc_insertion_point(field_set_allocated:$full_name$)\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables, set_allocated_end.Get());
   } else {
-    printer->Print(variables,
+    static io::LazyPrinterTemplate heap_accessors_start = {
       "}\n"
       "$inline$ $type$* $classname$::mutable_$name$() {\n"
       "  $set_hasbit$\n"
@@ -265,18 +284,20 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
       "  return temp;\n"
       "}\n"
       "$inline$ void $classname$::set_allocated_$name$($type$* $name$) {\n"
-      "  delete $name$_;\n");
+      "  delete $name$_;\n", '$' };
+    printer->Print(variables, heap_accessors_start.Get());
 
     if (SupportsArenas(descriptor_->message_type())) {
-      printer->Print(variables,
-      "  if ($name$ != NULL && $name$->GetArena() != NULL) {\n"
-      "    $type$* new_$name$ = new $type$;\n"
-      "    new_$name$->CopyFrom(*$name$);\n"
-      "    $name$ = new_$name$;\n"
-      "  }\n");
+      static io::LazyPrinterTemplate copy_arena_message = {
+        "  if ($name$ != NULL && $name$->GetArena() != NULL) {\n"
+        "    $type$* new_$name$ = new $type$;\n"
+        "    new_$name$->CopyFrom(*$name$);\n"
+        "    $name$ = new_$name$;\n"
+        "  }\n", '$' };
+      printer->Print(variables, copy_arena_message.Get());
     }
 
-    printer->Print(variables,
+    static io::LazyPrinterTemplate heap_set_allocated_end = {
       "  $name$_ = $name$;\n"
       "  if ($name$) {\n"
       "    $set_hasbit$\n"
@@ -284,7 +305,8 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
       "    $clear_hasbit$\n"
       "  }\n"
       "  // @@protoc_insertion_point(field_set_allocated:$full_name$)\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables, heap_set_allocated_end.Get());
   }
 }
 
@@ -293,65 +315,77 @@ GenerateClearingCode(io::Printer* printer) const {
   if (!HasFieldPresence(descriptor_->file())) {
     // If we don't have has-bits, message presence is indicated only by ptr !=
     // NULL. Thus on clear, we need to delete the object.
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate delete_message = {
       "if ($name$_ != NULL) delete $name$_;\n"
-      "$name$_ = NULL;\n");
+      "$name$_ = NULL;\n", '$' };
+    printer->Print(variables_, delete_message.Get());
   } else {
-    printer->Print(variables_,
-      "if ($name$_ != NULL) $name$_->$type$::Clear();\n");
+    static io::LazyPrinterTemplate clear_message = {
+      "if ($name$_ != NULL) $name$_->$type$::Clear();\n", '$' };
+    printer->Print(variables_, clear_message.Get());
   }
 }
 
 void MessageFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
-  printer->Print(variables_,
-    "mutable_$name$()->$type$::MergeFrom(from.$name$());\n");
+  static io::LazyPrinterTemplate merging_code = {
+    "mutable_$name$()->$type$::MergeFrom(from.$name$());\n", '$' };
+  printer->Print(variables_, merging_code.Get());
 }
 
 void MessageFieldGenerator::
 GenerateSwappingCode(io::Printer* printer) const {
-  printer->Print(variables_, "std::swap($name$_, other->$name$_);\n");
+  static io::LazyPrinterTemplate swapping_code = {
+    "std::swap($name$_, other->$name$_);\n", '$' };
+  printer->Print(variables_, swapping_code.Get());
 }
 
 void MessageFieldGenerator::
 GenerateConstructorCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_ = NULL;\n");
+  static io::LazyPrinterTemplate constructor_code = {
+    "$name$_ = NULL;\n", '$' };
+  printer->Print(variables_, constructor_code.Get());
 }
 
 void MessageFieldGenerator::
 GenerateMergeFromCodedStream(io::Printer* printer) const {
   if (descriptor_->type() == FieldDescriptor::TYPE_MESSAGE) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate read_message = {
       "DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(\n"
-      "     input, mutable_$name$()));\n");
+      "     input, mutable_$name$()));\n", '$' };
+    printer->Print(variables_, read_message.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate read_group = {
       "DO_(::google::protobuf::internal::WireFormatLite::ReadGroupNoVirtual(\n"
-      "      $number$, input, mutable_$name$()));\n");
+      "      $number$, input, mutable_$name$()));\n", '$' };
+    printer->Print(variables_, read_group.Get());
   }
 }
 
 void MessageFieldGenerator::
 GenerateSerializeWithCachedSizes(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialize_with_cached_sizes = {
     "::google::protobuf::internal::WireFormatLite::Write$stream_writer$(\n"
-    "  $number$, *$non_null_ptr_to_name$, output);\n");
+    "  $number$, *$non_null_ptr_to_name$, output);\n", '$' };
+  printer->Print(variables_, serialize_with_cached_sizes.Get());
 }
 
 void MessageFieldGenerator::
 GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialize_with_cached_sizes_to_array = {
     "target = ::google::protobuf::internal::WireFormatLite::\n"
     "  Write$declared_type$NoVirtualToArray(\n"
-    "    $number$, *$non_null_ptr_to_name$, target);\n");
+    "    $number$, *$non_null_ptr_to_name$, target);\n", '$' };
+  printer->Print(variables_, serialize_with_cached_sizes_to_array.Get());
 }
 
 void MessageFieldGenerator::
 GenerateByteSize(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate byte_size = {
     "total_size += $tag_size$ +\n"
     "  ::google::protobuf::internal::WireFormatLite::$declared_type$SizeNoVirtual(\n"
-    "    *$non_null_ptr_to_name$);\n");
+    "    *$non_null_ptr_to_name$);\n", '$' };
+  printer->Print(variables_, byte_size.Get());
 }
 
 // ===================================================================
@@ -371,7 +405,7 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
   map<string, string> variables(variables_);
   variables["inline"] = is_inline ? "inline" : "";
   if (SupportsArenas(descriptor_)) {
-    printer->Print(variables,
+    static io::LazyPrinterTemplate arena_accessors_start = {
       "$inline$ const $type$& $classname$::$name$() const {\n"
       "  // @@protoc_insertion_point(field_get:$full_name$)\n"
       "  return has_$name$() ? *$oneof_prefix$$name$_\n"
@@ -380,19 +414,25 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
       "$inline$ $type$* $classname$::mutable_$name$() {\n"
       "  if (!has_$name$()) {\n"
       "    clear_$oneof_name$();\n"
-      "    set_has_$name$();\n");
+      "    set_has_$name$();\n", '$' };
+    printer->Print(variables, arena_accessors_start.Get());
     if (SupportsArenas(descriptor_->message_type())) {
-      printer->Print(variables,
-         "    $oneof_prefix$$name$_ = \n"
-         "      ::google::protobuf::Arena::CreateMessage< $type$ >(\n"
-         "      GetArenaNoVirtual());\n");
+      static io::LazyPrinterTemplate create_message = {
+        "    $oneof_prefix$$name$_ = \n"
+        "      ::google::protobuf::Arena::CreateMessage< $type$ >(\n"
+        "      GetArenaNoVirtual());\n", '$' };
+      printer->Print(variables, create_message.Get());
     } else {
-      printer->Print(variables,
-         "    $oneof_prefix$$name$_ = \n"
-         "      ::google::protobuf::Arena::Create< $type$ >(\n"
-         "      GetArenaNoVirtual());\n");
+      static io::LazyPrinterTemplate create_object = {
+        "    $oneof_prefix$$name$_ = \n"
+        "      ::google::protobuf::Arena::Create< $type$ >(\n"
+        "      GetArenaNoVirtual());\n", '$' };
+      printer->Print(variables, create_object.Get());
     }
-    printer->Print(variables,
+    // N.B.: in the release method it is safe to use the underlying field
+    // pointer because we are sure that it is non-NULL (because has_$name$()
+    // returned true).
+    static io::LazyPrinterTemplate releases_and_set_allocated_start = {
       "  }\n"
       "  // @@protoc_insertion_point(field_mutable:$full_name$)\n"
       "  return $oneof_prefix$$name$_;\n"
@@ -401,8 +441,6 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
       "  if (has_$name$()) {\n"
       "    clear_has_$oneof_name$();\n"
       "    if (GetArenaNoVirtual() != NULL) {\n"
-      // N.B.: safe to use the underlying field pointer here because we are sure
-      // that it is non-NULL (because has_$name$() returned true).
       "      $type$* temp = new $type$;\n"
       "      temp->MergeFrom(*$oneof_prefix$$name$_);\n"
       "      $oneof_prefix$$name$_ = NULL;\n"
@@ -428,13 +466,14 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
       "}\n"
       "$inline$ void $classname$::set_allocated_$name$($type$* $name$) {\n"
       "  clear_$oneof_name$();\n"
-      "  if ($name$) {\n");
+      "  if ($name$) {\n", '$' };
+    printer->Print(variables, releases_and_set_allocated_start.Get());
 
     if (SupportsArenas(descriptor_->message_type())) {
-      printer->Print(variables,
-        // If incoming message is on the heap and we are on an arena, just Own()
-        // it (see above). If it's on a different arena than we are or one of us
-        // is on the heap, we make a copy to our arena/heap.
+      // If incoming message is on the heap and we are on an arena, just Own()
+      // it (see above). If it's on a different arena than we are or one of us
+      // is on the heap, we make a copy to our arena/heap.
+      static io::LazyPrinterTemplate own_or_copy_message = {
         "    if (GetArenaNoVirtual() != NULL &&\n"
         "        ::google::protobuf::Arena::GetArena($name$) == NULL) {\n"
         "      GetArenaNoVirtual()->Own($name$);\n"
@@ -445,15 +484,20 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
         "          GetArenaNoVirtual());\n"
         "      new_$name$->CopyFrom(*$name$);\n"
         "      $name$ = new_$name$;\n"
-        "    }\n");
+        "    }\n", '$' };
+      printer->Print(variables, own_or_copy_message.Get());
     } else {
-      printer->Print(variables,
+      static io::LazyPrinterTemplate own_message = {
         "    if (GetArenaNoVirtual() != NULL) {\n"
         "      GetArenaNoVirtual()->Own($name$);\n"
-        "    }\n");
+        "    }\n", '$' };
+      printer->Print(variables, own_message.Get());
     }
 
-    printer->Print(variables,
+    // In unsafe_arena_set_allocated_$name$(), we rely on the oneof clear
+    // method to free the earlier contents of this oneof. We can directly use
+    // the pointer we're given to set the new value.
+    static io::LazyPrinterTemplate set_allocated_end = {
       "    set_has_$name$();\n"
       "    $oneof_prefix$$name$_ = $name$;\n"
       "  }\n"
@@ -461,9 +505,6 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
       "}\n"
       "$inline$ void $classname$::unsafe_arena_set_allocated_$name$("
       "$type$* $name$) {\n"
-      // We rely on the oneof clear method to free the earlier contents of this
-      // oneof. We can directly use the pointer we're given to set the new
-      // value.
       "  clear_$oneof_name$();\n"
       "  if ($name$) {\n"
       "    set_has_$name$();\n"
@@ -471,9 +512,10 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
       "  }\n"
       "  // @@protoc_insertion_point(field_unsafe_arena_set_allocated:"
       "$full_name$)\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables, set_allocated_end.Get());
   } else {
-    printer->Print(variables,
+    static io::LazyPrinterTemplate heap_accessors_start = {
       "$inline$ const $type$& $classname$::$name$() const {\n"
       "  // @@protoc_insertion_point(field_get:$full_name$)\n"
       "  return has_$name$() ? *$oneof_prefix$$name$_\n"
@@ -500,34 +542,39 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
       "}\n"
       "$inline$ void $classname$::set_allocated_$name$($type$* $name$) {\n"
       "  clear_$oneof_name$();\n"
-      "  if ($name$) {\n");
+      "  if ($name$) {\n", '$' };
+    printer->Print(variables, heap_accessors_start.Get());
     if (SupportsArenas(descriptor_->message_type())) {
-      printer->Print(variables,
+      static io::LazyPrinterTemplate copy_arena_message = {
         "    if ($name$->GetArena() != NULL) {\n"
         "      $type$* new_$name$ = new $type$;\n"
         "      new_$name$->CopyFrom(*$name$);\n"
         "      $name$ = new_$name$;\n"
-        "    }\n");
+        "    }\n", '$' };
+      printer->Print(variables, copy_arena_message.Get());
     }
-    printer->Print(variables,
+    static io::LazyPrinterTemplate heap_set_allocated_end = {
       "    set_has_$name$();\n"
       "    $oneof_prefix$$name$_ = $name$;\n"
       "  }\n"
       "  // @@protoc_insertion_point(field_set_allocated:$full_name$)\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables, heap_set_allocated_end.Get());
   }
 }
 
 void MessageOneofFieldGenerator::
 GenerateClearingCode(io::Printer* printer) const {
   if (SupportsArenas(descriptor_)) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate arena_delete_message = {
       "if (GetArenaNoVirtual() == NULL) {\n"
       "  delete $oneof_prefix$$name$_;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, arena_delete_message.Get());
   } else {
-    printer->Print(variables_,
-      "delete $oneof_prefix$$name$_;\n");
+    static io::LazyPrinterTemplate delete_message = {
+      "delete $oneof_prefix$$name$_;\n", '$' };
+    printer->Print(variables_, delete_message.Get());
   }
 }
 
@@ -555,21 +602,24 @@ RepeatedMessageFieldGenerator::~RepeatedMessageFieldGenerator() {}
 
 void RepeatedMessageFieldGenerator::
 GeneratePrivateMembers(io::Printer* printer) const {
-  printer->Print(variables_,
-    "::google::protobuf::RepeatedPtrField< $type$ > $name$_;\n");
+  static io::LazyPrinterTemplate private_members = {
+    "::google::protobuf::RepeatedPtrField< $type$ > $name$_;\n", '$' };
+  printer->Print(variables_, private_members.Get());
 }
 
 void RepeatedMessageFieldGenerator::
 GenerateAccessorDeclarations(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate element_accessor_declarations = {
     "const $type$& $name$(int index) const$deprecation$;\n"
     "$type$* mutable_$name$(int index)$deprecation$;\n"
-    "$type$* add_$name$()$deprecation$;\n");
-  printer->Print(variables_,
+    "$type$* add_$name$()$deprecation$;\n", '$' };
+  printer->Print(variables_, element_accessor_declarations.Get());
+  static io::LazyPrinterTemplate list_accessor_declarations = {
     "const ::google::protobuf::RepeatedPtrField< $type$ >&\n"
     "    $name$() const$deprecation$;\n"
     "::google::protobuf::RepeatedPtrField< $type$ >*\n"
-    "    mutable_$name$()$deprecation$;\n");
+    "    mutable_$name$()$deprecation$;\n", '$' };
+  printer->Print(variables_, list_accessor_declarations.Get());
 }
 
 void RepeatedMessageFieldGenerator::
@@ -577,7 +627,7 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
                                   bool is_inline) const {
   map<string, string> variables(variables_);
   variables["inline"] = is_inline ? "inline" : "";
-  printer->Print(variables,
+  static io::LazyPrinterTemplate element_accessor_definitions = {
     "$inline$ const $type$& $classname$::$name$(int index) const {\n"
     "  // @@protoc_insertion_point(field_get:$full_name$)\n"
     "  return $name$_.$cppget$(index);\n"
@@ -589,8 +639,9 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
     "$inline$ $type$* $classname$::add_$name$() {\n"
     "  // @@protoc_insertion_point(field_add:$full_name$)\n"
     "  return $name$_.Add();\n"
-    "}\n");
-  printer->Print(variables,
+    "}\n", '$' };
+  printer->Print(variables, element_accessor_definitions.Get());
+  static io::LazyPrinterTemplate list_accessor_definitions = {
     "$inline$ const ::google::protobuf::RepeatedPtrField< $type$ >&\n"
     "$classname$::$name$() const {\n"
     "  // @@protoc_insertion_point(field_list:$full_name$)\n"
@@ -600,22 +651,28 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
     "$classname$::mutable_$name$() {\n"
     "  // @@protoc_insertion_point(field_mutable_list:$full_name$)\n"
     "  return &$name$_;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables, list_accessor_definitions.Get());
 }
 
 void RepeatedMessageFieldGenerator::
 GenerateClearingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.Clear();\n");
+  static io::LazyPrinterTemplate clearing_code = { "$name$_.Clear();\n", '$' };
+  printer->Print(variables_, clearing_code.Get());
 }
 
 void RepeatedMessageFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.MergeFrom(from.$name$_);\n");
+  static io::LazyPrinterTemplate merging_code = {
+    "$name$_.MergeFrom(from.$name$_);\n", '$' };
+  printer->Print(variables_, merging_code.Get());
 }
 
 void RepeatedMessageFieldGenerator::
 GenerateSwappingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.UnsafeArenaSwap(&other->$name$_);\n");
+  static io::LazyPrinterTemplate swapping_code = {
+    "$name$_.UnsafeArenaSwap(&other->$name$_);\n", '$' };
+  printer->Print(variables_, swapping_code.Get());
 }
 
 void RepeatedMessageFieldGenerator::
@@ -626,44 +683,49 @@ GenerateConstructorCode(io::Printer* printer) const {
 void RepeatedMessageFieldGenerator::
 GenerateMergeFromCodedStream(io::Printer* printer) const {
   if (descriptor_->type() == FieldDescriptor::TYPE_MESSAGE) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate read_message = {
       "DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(\n"
-      "      input, add_$name$()));\n");
+      "      input, add_$name$()));\n", '$' };
+    printer->Print(variables_, read_message.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate read_group = {
       "DO_(::google::protobuf::internal::WireFormatLite::ReadGroupNoVirtual(\n"
-      "      $number$, input, add_$name$()));\n");
+      "      $number$, input, add_$name$()));\n", '$' };
+    printer->Print(variables_, read_group.Get());
   }
 }
 
 void RepeatedMessageFieldGenerator::
 GenerateSerializeWithCachedSizes(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialize_with_cached_sizes = {
     "for (unsigned int i = 0, n = this->$name$_size(); i < n; i++) {\n"
     "  ::google::protobuf::internal::WireFormatLite::Write$stream_writer$(\n"
     "    $number$, this->$name$(i), output);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialize_with_cached_sizes.Get());
 }
 
 void RepeatedMessageFieldGenerator::
 GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialize_with_cached_sizes_to_array = {
     "for (unsigned int i = 0, n = this->$name$_size(); i < n; i++) {\n"
     "  target = ::google::protobuf::internal::WireFormatLite::\n"
     "    Write$declared_type$NoVirtualToArray(\n"
     "      $number$, this->$name$(i), target);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialize_with_cached_sizes_to_array.Get());
 }
 
 void RepeatedMessageFieldGenerator::
 GenerateByteSize(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate byte_size = {
     "total_size += $tag_size$ * this->$name$_size();\n"
     "for (int i = 0; i < this->$name$_size(); i++) {\n"
     "  total_size +=\n"
     "    ::google::protobuf::internal::WireFormatLite::$declared_type$SizeNoVirtual(\n"
     "      this->$name$(i));\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, byte_size.Get());
 }
 
 }  // namespace cpp
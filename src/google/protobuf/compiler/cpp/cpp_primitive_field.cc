@@ -111,21 +111,23 @@ PrimitiveFieldGenerator::~PrimitiveFieldGenerator() {}
 
 void PrimitiveFieldGenerator::
 GeneratePrivateMembers(io::Printer* printer) const {
-  printer->Print(variables_, "$type$ $name$_;\n");
+  static io::LazyPrinterTemplate private_members = { "$type$ $name$_;\n", '$' };
+  printer->Print(variables_, private_members.Get());
 }
 
 void PrimitiveFieldGenerator::
 GenerateAccessorDeclarations(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate accessor_declarations = {
     "$type$ $name$() const$deprecation$;\n"
-    "void set_$name$($type$ value)$deprecation$;\n");
+    "void set_$name$($type$ value)$deprecation$;\n", '$' };
+  printer->Print(variables_, accessor_declarations.Get());
 }
 
 void PrimitiveFieldGenerator::
 GenerateInlineAccessorDefinitions(io::Printer* printer, bool is_inline) const {
   map<string, string> variables(variables_);
   variables["inline"] = is_inline ? "inline" : "";
-  printer->Print(variables,
+  static io::LazyPrinterTemplate inline_accessor_definitions = {
     "$inline$ $type$ $classname$::$name$() const {\n"
     "  // @@protoc_insertion_point(field_get:$full_name$)\n"
     "  return $name$_;\n"
@@ -134,63 +136,77 @@ GenerateInlineAccessorDefinitions(io::Printer* printer, bool is_inline) const {
     "  $set_hasbit$\n"
     "  $name$_ = value;\n"
     "  // @@protoc_insertion_point(field_set:$full_name$)\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables, inline_accessor_definitions.Get());
 }
 
 void PrimitiveFieldGenerator::
 GenerateClearingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_ = $default$;\n");
+  static io::LazyPrinterTemplate clearing_code = {
+    "$name$_ = $default$;\n", '$' };
+  printer->Print(variables_, clearing_code.Get());
 }
 
 void PrimitiveFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
-  printer->Print(variables_, "set_$name$(from.$name$());\n");
+  static io::LazyPrinterTemplate merging_code = {
+    "set_$name$(from.$name$());\n", '$' };
+  printer->Print(variables_, merging_code.Get());
 }
 
 void PrimitiveFieldGenerator::
 GenerateSwappingCode(io::Printer* printer) const {
-  printer->Print(variables_, "std::swap($name$_, other->$name$_);\n");
+  static io::LazyPrinterTemplate swapping_code = {
+    "std::swap($name$_, other->$name$_);\n", '$' };
+  printer->Print(variables_, swapping_code.Get());
 }
 
 void PrimitiveFieldGenerator::
 GenerateConstructorCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_ = $default$;\n");
+  static io::LazyPrinterTemplate constructor_code = {
+    "$name$_ = $default$;\n", '$' };
+  printer->Print(variables_, constructor_code.Get());
 }
 
 void PrimitiveFieldGenerator::
 GenerateMergeFromCodedStream(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate merge_from_coded_stream = {
     "DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<\n"
     "         $type$, $wire_format_field_type$>(\n"
     "       input, &$name$_)));\n"
-    "$set_hasbit$\n");
+    "$set_hasbit$\n", '$' };
+  printer->Print(variables_, merge_from_coded_stream.Get());
 }
 
 void PrimitiveFieldGenerator::
 GenerateSerializeWithCachedSizes(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialize_with_cached_sizes = {
     "::google::protobuf::internal::WireFormatLite::Write$declared_type$("
-      "$number$, this->$name$(), output);\n");
+      "$number$, this->$name$(), output);\n", '$' };
+  printer->Print(variables_, serialize_with_cached_sizes.Get());
 }
 
 void PrimitiveFieldGenerator::
 GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialize_with_cached_sizes_to_array = {
     "target = ::google::protobuf::internal::WireFormatLite::Write$declared_type$ToArray("
-      "$number$, this->$name$(), target);\n");
+      "$number$, this->$name$(), target);\n", '$' };
+  printer->Print(variables_, serialize_with_cached_sizes_to_array.Get());
 }
 
 void PrimitiveFieldGenerator::
 GenerateByteSize(io::Printer* printer) const {
   int fixed_size = FixedSize(descriptor_->type());
   if (fixed_size == -1) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate varint_byte_size = {
       "total_size += $tag_size$ +\n"
       "  ::google::protobuf::internal::WireFormatLite::$declared_type$Size(\n"
-      "    this->$name$());\n");
+      "    this->$name$());\n", '$' };
+    printer->Print(variables_, varint_byte_size.Get());
   } else {
-    printer->Print(variables_,
-      "total_size += $tag_size$ + $fixed_size$;\n");
+    static io::LazyPrinterTemplate fixed_byte_size = {
+      "total_size += $tag_size$ + $fixed_size$;\n", '$' };
+    printer->Print(variables_, fixed_byte_size.Get());
   }
 }
 
@@ -209,7 +225,7 @@ void PrimitiveOneofFieldGenerator::
 GenerateInlineAccessorDefinitions(io::Printer* printer, bool is_inline) const {
   map<string, string> variables(variables_);
   variables["inline"] = is_inline ? "inline" : "";
-  printer->Print(variables,
+  static io::LazyPrinterTemplate inline_accessor_definitions = {
     "$inline$ $type$ $classname$::$name$() const {\n"
     "  // @@protoc_insertion_point(field_get:$full_name$)\n"
     "  if (has_$name$()) {\n"
@@ -224,12 +240,15 @@ GenerateInlineAccessorDefinitions(io::Printer* printer, bool is_inline) const {
     "  }\n"
     "  $oneof_prefix$$name$_ = value;\n"
     "  // @@protoc_insertion_point(field_set:$full_name$)\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables, inline_accessor_definitions.Get());
 }
 
 void PrimitiveOneofFieldGenerator::
 GenerateClearingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$oneof_prefix$$name$_ = $default$;\n");
+  static io::LazyPrinterTemplate clearing_code = {
+    "$oneof_prefix$$name$_ = $default$;\n", '$' };
+  printer->Print(variables_, clearing_code.Get());
 }
 
 void PrimitiveOneofFieldGenerator::
@@ -239,19 +258,20 @@ GenerateSwappingCode(io::Printer* printer) const {
 
 void PrimitiveOneofFieldGenerator::
 GenerateConstructorCode(io::Printer* printer) const {
-  printer->Print(
-      variables_,
-      "  $classname$_default_oneof_instance_->$name$_ = $default$;\n");
+  static io::LazyPrinterTemplate constructor_code = {
+    "  $classname$_default_oneof_instance_->$name$_ = $default$;\n", '$' };
+  printer->Print(variables_, constructor_code.Get());
 }
 
 void PrimitiveOneofFieldGenerator::
 GenerateMergeFromCodedStream(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate merge_from_coded_stream = {
     "clear_$oneof_name$();\n"
     "DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<\n"
     "         $type$, $wire_format_field_type$>(\n"
     "       input, &$oneof_prefix$$name$_)));\n"
-    "set_has_$name$();\n");
+    "set_has_$name$();\n", '$' };
+  printer->Print(variables_, merge_from_coded_stream.Get());
 }
 
 // ===================================================================
@@ -275,32 +295,36 @@ RepeatedPrimitiveFieldGenerator::~RepeatedPrimitiveFieldGenerator() {}
 
 void RepeatedPrimitiveFieldGenerator::
 GeneratePrivateMembers(io::Printer* printer) const {
-  printer->Print(variables_,
-    "::google::protobuf::RepeatedField< $type$ > $name$_;\n");
+  static io::LazyPrinterTemplate field_member = {
+    "::google::protobuf::RepeatedField< $type$ > $name$_;\n", '$' };
+  printer->Print(variables_, field_member.Get());
   if (descriptor_->options().packed() && HasGeneratedMethods(descriptor_->file())) {
-    printer->Print(variables_,
-      "mutable int _$name$_cached_byte_size_;\n");
+    static io::LazyPrinterTemplate cached_byte_size_member = {
+      "mutable int _$name$_cached_byte_size_;\n", '$' };
+    printer->Print(variables_, cached_byte_size_member.Get());
   }
 }
 
 void RepeatedPrimitiveFieldGenerator::
 GenerateAccessorDeclarations(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate element_accessor_declarations = {
     "$type$ $name$(int index) const$deprecation$;\n"
     "void set_$name$(int index, $type$ value)$deprecation$;\n"
-    "void add_$name$($type$ value)$deprecation$;\n");
-  printer->Print(variables_,
+    "void add_$name$($type$ value)$deprecation$;\n", '$' };
+  printer->Print(variables_, element_accessor_declarations.Get());
+  static io::LazyPrinterTemplate list_accessor_declarations = {
     "const ::google::protobuf::RepeatedField< $type$ >&\n"
     "    $name$() const$deprecation$;\n"
     "::google::protobuf::RepeatedField< $type$ >*\n"
-    "    mutable_$name$()$deprecation$;\n");
+    "    mutable_$name$()$deprecation$;\n", '$' };
+  printer->Print(variables_, list_accessor_declarations.Get());
 }
 
 void RepeatedPrimitiveFieldGenerator::
 GenerateInlineAccessorDefinitions(io::Printer* printer, bool is_inline) const {
   map<string, string> variables(variables_);
   variables["inline"] = is_inline ? "inline" : "";
-  printer->Print(variables,
+  static io::LazyPrinterTemplate element_accessor_definitions = {
     "$inline$ $type$ $classname$::$name$(int index) const {\n"
     "  // @@protoc_insertion_point(field_get:$full_name$)\n"
     "  return $name$_.Get(index);\n"
@@ -312,8 +336,9 @@ GenerateInlineAccessorDefinitions(io::Printer* printer, bool is_inline) const {
     "$inline$ void $classname$::add_$name$($type$ value) {\n"
     "  $name$_.Add(value);\n"
     "  // @@protoc_insertion_point(field_add:$full_name$)\n"
-    "}\n");
-  printer->Print(variables,
+    "}\n", '$' };
+  printer->Print(variables, element_accessor_definitions.Get());
+  static io::LazyPrinterTemplate list_accessor_definitions = {
     "$inline$ const ::google::protobuf::RepeatedField< $type$ >&\n"
     "$classname$::$name$() const {\n"
     "  // @@protoc_insertion_point(field_list:$full_name$)\n"
@@ -323,22 +348,28 @@ GenerateInlineAccessorDefinitions(io::Printer* printer, bool is_inline) const {
     "$classname$::mutable_$name$() {\n"
     "  // @@protoc_insertion_point(field_mutable_list:$full_name$)\n"
     "  return &$name$_;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables, list_accessor_definitions.Get());
 }
 
 void RepeatedPrimitiveFieldGenerator::
 GenerateClearingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.Clear();\n");
+  static io::LazyPrinterTemplate clearing_code = { "$name$_.Clear();\n", '$' };
+  printer->Print(variables_, clearing_code.Get());
 }
 
 void RepeatedPrimitiveFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.MergeFrom(from.$name$_);\n");
+  static io::LazyPrinterTemplate merging_code = {
+    "$name$_.MergeFrom(from.$name$_);\n", '$' };
+  printer->Print(variables_, merging_code.Get());
 }
 
 void RepeatedPrimitiveFieldGenerator::
 GenerateSwappingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.UnsafeArenaSwap(&other->$name$_);\n");
+  static io::LazyPrinterTemplate swapping_code = {
+    "$name$_.UnsafeArenaSwap(&other->$name$_);\n", '$' };
+  printer->Print(variables_, swapping_code.Get());
 }
 
 void RepeatedPrimitiveFieldGenerator::
@@ -348,43 +379,49 @@ GenerateConstructorCode(io::Printer* printer) const {
 
 void RepeatedPrimitiveFieldGenerator::
 GenerateMergeFromCodedStream(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate merge_from_coded_stream = {
     "DO_((::google::protobuf::internal::WireFormatLite::$repeated_reader$<\n"
     "         $type$, $wire_format_field_type$>(\n"
-    "       $tag_size$, $tag$, input, this->mutable_$name$())));\n");
+    "       $tag_size$, $tag$, input, this->mutable_$name$())));\n", '$' };
+  printer->Print(variables_, merge_from_coded_stream.Get());
 }
 
 void RepeatedPrimitiveFieldGenerator::
 GenerateMergeFromCodedStreamWithPacking(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate merge_from_coded_stream_with_packing = {
     "DO_((::google::protobuf::internal::WireFormatLite::$packed_reader$<\n"
     "         $type$, $wire_format_field_type$>(\n"
-    "       input, this->mutable_$name$())));\n");
+    "       input, this->mutable_$name$())));\n", '$' };
+  printer->Print(variables_, merge_from_coded_stream_with_packing.Get());
 }
 
 void RepeatedPrimitiveFieldGenerator::
 GenerateSerializeWithCachedSizes(io::Printer* printer) const {
   if (descriptor_->options().packed()) {
     // Write the tag and the size.
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate packed_header = {
       "if (this->$name$_size() > 0) {\n"
       "  ::google::protobuf::internal::WireFormatLite::WriteTag("
           "$number$, "
           "::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED, "
           "output);\n"
       "  output->WriteVarint32(_$name$_cached_byte_size_);\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, packed_header.Get());
   }
-  printer->Print(variables_,
-      "for (int i = 0; i < this->$name$_size(); i++) {\n");
+  static io::LazyPrinterTemplate loop_start = {
+    "for (int i = 0; i < this->$name$_size(); i++) {\n", '$' };
+  printer->Print(variables_, loop_start.Get());
   if (descriptor_->options().packed()) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate packed_element = {
       "  ::google::protobuf::internal::WireFormatLite::Write$declared_type$NoTag(\n"
-      "    this->$name$(i), output);\n");
+      "    this->$name$(i), output);\n", '$' };
+    printer->Print(variables_, packed_element.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate element = {
       "  ::google::protobuf::internal::WireFormatLite::Write$declared_type$(\n"
-      "    $number$, this->$name$(i), output);\n");
+      "    $number$, this->$name$(i), output);\n", '$' };
+    printer->Print(variables_, element.Get());
   }
   printer->Print("}\n");
 }
@@ -393,7 +430,7 @@ void RepeatedPrimitiveFieldGenerator::
 GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const {
   if (descriptor_->options().packed()) {
     // Write the tag and the size.
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate packed_header = {
       "if (this->$name$_size() > 0) {\n"
       "  target = ::google::protobuf::internal::WireFormatLite::WriteTagToArray(\n"
       "    $number$,\n"
@@ -401,42 +438,50 @@ GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const {
       "    target);\n"
       "  target = ::google::protobuf::io::CodedOutputStream::WriteVarint32ToArray(\n"
       "    _$name$_cached_byte_size_, target);\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, packed_header.Get());
   }
-  printer->Print(variables_,
-      "for (int i = 0; i < this->$name$_size(); i++) {\n");
+  static io::LazyPrinterTemplate loop_start = {
+    "for (int i = 0; i < this->$name$_size(); i++) {\n", '$' };
+  printer->Print(variables_, loop_start.Get());
   if (descriptor_->options().packed()) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate packed_element = {
       "  target = ::google::protobuf::internal::WireFormatLite::\n"
-      "    Write$declared_type$NoTagToArray(this->$name$(i), target);\n");
+      "    Write$declared_type$NoTagToArray(this->$name$(i), target);\n", '$' };
+    printer->Print(variables_, packed_element.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate element = {
       "  target = ::google::protobuf::internal::WireFormatLite::\n"
-      "    Write$declared_type$ToArray($number$, this->$name$(i), target);\n");
+      "    Write$declared_type$ToArray($number$, this->$name$(i), target);\n",
+      '$' };
+    printer->Print(variables_, element.Get());
   }
   printer->Print("}\n");
 }
 
 void RepeatedPrimitiveFieldGenerator::
 GenerateByteSize(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate block_start = {
     "{\n"
-    "  int data_size = 0;\n");
+    "  int data_size = 0;\n", '$' };
+  printer->Print(variables_, block_start.Get());
   printer->Indent();
   int fixed_size = FixedSize(descriptor_->type());
   if (fixed_size == -1) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate varint_data_size = {
       "for (int i = 0; i < this->$name$_size(); i++) {\n"
       "  data_size += ::google::protobuf::internal::WireFormatLite::\n"
       "    $declared_type$Size(this->$name$(i));\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, varint_data_size.Get());
   } else {
-    printer->Print(variables_,
-      "data_size = $fixed_size$ * this->$name$_size();\n");
+    static io::LazyPrinterTemplate fixed_data_size = {
+      "data_size = $fixed_size$ * this->$name$_size();\n", '$' };
+    printer->Print(variables_, fixed_data_size.Get());
   }
 
   if (descriptor_->options().packed()) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate packed_total_size = {
       "if (data_size > 0) {\n"
       "  total_size += $tag_size$ +\n"
       "    ::google::protobuf::internal::WireFormatLite::Int32Size(data_size);\n"
@@ -444,10 +489,12 @@ GenerateByteSize(io::Printer* printer) const {
       "GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();\n"
       "_$name$_cached_byte_size_ = data_size;\n"
       "GOOGLE_SAFE_CONCURRENT_WRITES_END();\n"
-      "total_size += data_size;\n");
+      "total_size += data_size;\n", '$' };
+    printer->Print(variables_, packed_total_size.Get());
   } else {
-    printer->Print(variables_,
-      "total_size += $tag_size$ * this->$name$_size() + data_size;\n");
+    static io::LazyPrinterTemplate unpacked_total_size = {
+      "total_size += $tag_size$ * this->$name$_size() + data_size;\n", '$' };
+    printer->Print(variables_, unpacked_total_size.Get());
   }
   printer->Outdent();
   printer->Print("}\n");
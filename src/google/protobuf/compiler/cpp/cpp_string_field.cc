@@ -99,13 +99,17 @@ GeneratePrivateMembers(io::Printer* printer) const {
   // stick with this but use lightweight accessors that assume arena == NULL.
   // There should be very little overhead anyway because it's just a tagged
   // pointer in-memory.
-  printer->Print(variables_, "::google::protobuf::internal::ArenaStringPtr $name$_;\n");
+  static io::LazyPrinterTemplate private_members = {
+    "::google::protobuf::internal::ArenaStringPtr $name$_;\n", '$' };
+  printer->Print(variables_, private_members.Get());
 }
 
 void StringFieldGenerator::
 GenerateStaticMembers(io::Printer* printer) const {
   if (!descriptor_->default_value_string().empty()) {
-    printer->Print(variables_, "static ::std::string* $default_variable$;\n");
+    static io::LazyPrinterTemplate static_members = {
+      "static ::std::string* $default_variable$;\n", '$' };
+    printer->Print(variables_, static_members.Get());
   }
 }
 
@@ -139,7 +143,7 @@ GenerateAccessorDeclarations(io::Printer* printer) const {
     printer->Indent();
   }
 
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate accessor_declarations = {
     "const ::std::string& $name$() const$deprecation$;\n"
     "void set_$name$(const ::std::string& value)$deprecation$;\n"
     "void set_$name$(const char* value)$deprecation$;\n"
@@ -147,12 +151,14 @@ GenerateAccessorDeclarations(io::Printer* printer) const {
                  "$deprecation$;\n"
     "::std::string* mutable_$name$()$deprecation$;\n"
     "::std::string* $release_name$()$deprecation$;\n"
-    "void set_allocated_$name$(::std::string* $name$)$deprecation$;\n");
+    "void set_allocated_$name$(::std::string* $name$)$deprecation$;\n", '$' };
+  printer->Print(variables_, accessor_declarations.Get());
   if (SupportsArenas(descriptor_)) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate unsafe_arena_accessor_declarations = {
       "::std::string* unsafe_arena_release_$name$()$deprecation$;\n"
       "void unsafe_arena_set_allocated_$name$(\n"
-      "    ::std::string* $name$)$deprecation$;\n");
+      "    ::std::string* $name$)$deprecation$;\n", '$' };
+    printer->Print(variables_, unsafe_arena_accessor_declarations.Get());
   }
 
 
@@ -169,7 +175,7 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
   map<string, string> variables(variables_);
   variables["inline"] = is_inline ? "inline" : "";
   if (SupportsArenas(descriptor_)) {
-    printer->Print(variables,
+    static io::LazyPrinterTemplate arena_accessor_definitions = {
       "$inline$ const ::std::string& $classname$::$name$() const {\n"
       "  // @@protoc_insertion_point(field_get:$full_name$)\n"
       "  return $name$_.Get($default_variable$);\n"
@@ -230,10 +236,11 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
       "  $name$_.UnsafeArenaSetAllocated($default_variable$,\n"
       "      $name$, GetArenaNoVirtual());\n"
       "  // @@protoc_insertion_point(field_set_allocated:$full_name$)\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables, arena_accessor_definitions.Get());
   } else {
     // No-arena case.
-    printer->Print(variables,
+    static io::LazyPrinterTemplate heap_accessor_definitions = {
       "$inline$ const ::std::string& $classname$::$name$() const {\n"
       "  // @@protoc_insertion_point(field_get:$full_name$)\n"
       "  return $name$_.GetNoArena($default_variable$);\n"
@@ -273,7 +280,8 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
       "  }\n"
       "  $name$_.SetAllocatedNoArena($default_variable$, $name$);\n"
       "  // @@protoc_insertion_point(field_set_allocated:$full_name$)\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables, heap_accessor_definitions.Get());
   }
 }
 
@@ -281,8 +289,9 @@ void StringFieldGenerator::
 GenerateNonInlineAccessorDefinitions(io::Printer* printer) const {
   if (!descriptor_->default_value_string().empty()) {
     // Initialized in GenerateDefaultInstanceAllocator.
-    printer->Print(variables_,
-      "::std::string* $classname$::$default_variable$ = NULL;\n");
+    static io::LazyPrinterTemplate non_inline_accessor_definitions = {
+      "::std::string* $classname$::$default_variable$ = NULL;\n", '$' };
+    printer->Print(variables_, non_inline_accessor_definitions.Get());
   }
 }
 
@@ -294,19 +303,25 @@ GenerateClearingCode(io::Printer* printer) const {
   // below methods are inlined one-liners)!
   if (SupportsArenas(descriptor_)) {
     if (descriptor_->default_value_string().empty()) {
-      printer->Print(variables_,
-        "$name$_.ClearToEmpty($default_variable$, GetArenaNoVirtual());\n");
+      static io::LazyPrinterTemplate clear_to_empty = {
+        "$name$_.ClearToEmpty($default_variable$, GetArenaNoVirtual());\n",
+        '$' };
+      printer->Print(variables_, clear_to_empty.Get());
     } else {
-      printer->Print(variables_,
-        "$name$_.ClearToDefault($default_variable$, GetArenaNoVirtual());\n");
+      static io::LazyPrinterTemplate clear_to_default = {
+        "$name$_.ClearToDefault($default_variable$, GetArenaNoVirtual());\n",
+        '$' };
+      printer->Print(variables_, clear_to_default.Get());
     }
   } else {
     if (descriptor_->default_value_string().empty()) {
-      printer->Print(variables_,
-        "$name$_.ClearToEmptyNoArena($default_variable$);\n");
+      static io::LazyPrinterTemplate clear_to_empty_no_arena = {
+        "$name$_.ClearToEmptyNoArena($default_variable$);\n", '$' };
+      printer->Print(variables_, clear_to_empty_no_arena.Get());
     } else {
-      printer->Print(variables_,
-        "$name$_.ClearToDefaultNoArena($default_variable$);\n");
+      static io::LazyPrinterTemplate clear_to_default_no_arena = {
+        "$name$_.ClearToDefaultNoArena($default_variable$);\n", '$' };
+      printer->Print(variables_, clear_to_default_no_arena.Get());
     }
   }
 }
@@ -315,66 +330,78 @@ void StringFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
   if (SupportsArenas(descriptor_) || descriptor_->containing_oneof() != NULL) {
     // TODO(gpike): improve this
-    printer->Print(variables_, "set_$name$(from.$name$());\n");
+    static io::LazyPrinterTemplate set_from = {
+      "set_$name$(from.$name$());\n", '$' };
+    printer->Print(variables_, set_from.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate set_from_no_arena = {
       "$set_hasbit$\n"
-      "$name$_.AssignWithDefault($default_variable$, from.$name$_);\n");
+      "$name$_.AssignWithDefault($default_variable$, from.$name$_);\n", '$' };
+    printer->Print(variables_, set_from_no_arena.Get());
   }
 }
 
 void StringFieldGenerator::
 GenerateSwappingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.Swap(&other->$name$_);\n");
+  static io::LazyPrinterTemplate swapping_code = {
+    "$name$_.Swap(&other->$name$_);\n", '$' };
+  printer->Print(variables_, swapping_code.Get());
 }
 
 void StringFieldGenerator::
 GenerateConstructorCode(io::Printer* printer) const {
-  printer->Print(variables_,
-      "$name$_.UnsafeSetDefault($default_variable$);\n");
+  static io::LazyPrinterTemplate constructor_code = {
+    "$name$_.UnsafeSetDefault($default_variable$);\n", '$' };
+  printer->Print(variables_, constructor_code.Get());
 }
 
 void StringFieldGenerator::
 GenerateDestructorCode(io::Printer* printer) const {
   if (SupportsArenas(descriptor_)) {
-    printer->Print(variables_,
-      "$name$_.Destroy($default_variable$, GetArenaNoVirtual());\n");
+    static io::LazyPrinterTemplate destroy = {
+      "$name$_.Destroy($default_variable$, GetArenaNoVirtual());\n", '$' };
+    printer->Print(variables_, destroy.Get());
   } else {
-    printer->Print(variables_,
-      "$name$_.DestroyNoArena($default_variable$);\n");
+    static io::LazyPrinterTemplate destroy_no_arena = {
+      "$name$_.DestroyNoArena($default_variable$);\n", '$' };
+    printer->Print(variables_, destroy_no_arena.Get());
   }
 }
 
 void StringFieldGenerator::
 GenerateDefaultInstanceAllocator(io::Printer* printer) const {
   if (!descriptor_->default_value_string().empty()) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate default_instance_allocator = {
       "$classname$::$default_variable$ =\n"
-      "    new ::std::string($default$, $default_length$);\n");
+      "    new ::std::string($default$, $default_length$);\n", '$' };
+    printer->Print(variables_, default_instance_allocator.Get());
   }
 }
 
 void StringFieldGenerator::
 GenerateShutdownCode(io::Printer* printer) const {
   if (!descriptor_->default_value_string().empty()) {
-    printer->Print(variables_,
-      "delete $classname$::$default_variable$;\n");
+    static io::LazyPrinterTemplate shutdown_code = {
+      "delete $classname$::$default_variable$;\n", '$' };
+    printer->Print(variables_, shutdown_code.Get());
   }
 }
 
 void StringFieldGenerator::
 GenerateMergeFromCodedStream(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate read_string = {
     "DO_(::google::protobuf::internal::WireFormatLite::Read$declared_type$(\n"
-    "      input, this->mutable_$name$()));\n");
+    "      input, this->mutable_$name$()));\n", '$' };
+  printer->Print(variables_, read_string.Get());
 
   if (HasUtf8Verification(descriptor_->file()) &&
       descriptor_->type() == FieldDescriptor::TYPE_STRING) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate verify_parsed_utf8 = {
       "::google::protobuf::internal::WireFormat::VerifyUTF8StringNamedField(\n"
       "  this->$name$().data(), this->$name$().length(),\n"
       "  ::google::protobuf::internal::WireFormat::PARSE,\n"
-      "  \"$full_name$\");\n");
+      "  \"$full_name$\");\n", '$' };
+    printer->Print(variables_, verify_parsed_utf8.Get());
   }
 }
 
@@ -382,39 +409,44 @@ void StringFieldGenerator::
 GenerateSerializeWithCachedSizes(io::Printer* printer) const {
   if (HasUtf8Verification(descriptor_->file()) &&
       descriptor_->type() == FieldDescriptor::TYPE_STRING) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate verify_utf8 = {
       "::google::protobuf::internal::WireFormat::VerifyUTF8StringNamedField(\n"
       "  this->$name$().data(), this->$name$().length(),\n"
       "  ::google::protobuf::internal::WireFormat::SERIALIZE,\n"
-      "  \"$full_name$\");\n");
+      "  \"$full_name$\");\n", '$' };
+    printer->Print(variables_, verify_utf8.Get());
   }
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate write_string = {
     "::google::protobuf::internal::WireFormatLite::Write$declared_type$MaybeAliased(\n"
-    "  $number$, this->$name$(), output);\n");
+    "  $number$, this->$name$(), output);\n", '$' };
+  printer->Print(variables_, write_string.Get());
 }
 
 void StringFieldGenerator::
 GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const {
   if (HasUtf8Verification(descriptor_->file()) &&
       descriptor_->type() == FieldDescriptor::TYPE_STRING) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate verify_utf8 = {
       "::google::protobuf::internal::WireFormat::VerifyUTF8StringNamedField(\n"
       "  this->$name$().data(), this->$name$().length(),\n"
       "  ::google::protobuf::internal::WireFormat::SERIALIZE,\n"
-      "  \"$full_name$\");\n");
+      "  \"$full_name$\");\n", '$' };
+    printer->Print(variables_, verify_utf8.Get());
   }
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate write_string = {
     "target =\n"
     "  ::google::protobuf::internal::WireFormatLite::Write$declared_type$ToArray(\n"
-    "    $number$, this->$name$(), target);\n");
+    "    $number$, this->$name$(), target);\n", '$' };
+  printer->Print(variables_, write_string.Get());
 }
 
 void StringFieldGenerator::
 GenerateByteSize(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate byte_size = {
     "total_size += $tag_size$ +\n"
     "  ::google::protobuf::internal::WireFormatLite::$declared_type$Size(\n"
-    "    this->$name$());\n");
+    "    this->$name$());\n", '$' };
+  printer->Print(variables_, byte_size.Get());
 }
 
 // ===================================================================
@@ -434,7 +466,7 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
   map<string, string> variables(variables_);
   variables["inline"] = is_inline ? "inline" : "";
   if (SupportsArenas(descriptor_)) {
-    printer->Print(variables,
+    static io::LazyPrinterTemplate arena_accessor_definitions = {
       "$inline$ const ::std::string& $classname$::$name$() const {\n"
       "  // @@protoc_insertion_point(field_get:$full_name$)\n"
       "  if (has_$name$()) {\n"
@@ -529,10 +561,11 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
       "$name$, GetArenaNoVirtual());\n"
       "  }\n"
       "  // @@protoc_insertion_point(field_set_allocated:$full_name$)\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables, arena_accessor_definitions.Get());
   } else {
     // No-arena case.
-    printer->Print(variables,
+    static io::LazyPrinterTemplate heap_accessor_definitions = {
       "$inline$ const ::std::string& $classname$::$name$() const {\n"
       "  // @@protoc_insertion_point(field_get:$full_name$)\n"
       "  if (has_$name$()) {\n"
@@ -599,19 +632,22 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
       "        $name$);\n"
       "  }\n"
       "  // @@protoc_insertion_point(field_set_allocated:$full_name$)\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables, heap_accessor_definitions.Get());
   }
 }
 
 void StringOneofFieldGenerator::
 GenerateClearingCode(io::Printer* printer) const {
   if (SupportsArenas(descriptor_)) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate destroy = {
       "$oneof_prefix$$name$_.Destroy($default_variable$,\n"
-      "    GetArenaNoVirtual());\n");
+      "    GetArenaNoVirtual());\n", '$' };
+    printer->Print(variables_, destroy.Get());
   } else {
-    printer->Print(variables_,
-      "$oneof_prefix$$name$_.DestroyNoArena($default_variable$);\n");
+    static io::LazyPrinterTemplate destroy_no_arena = {
+      "$oneof_prefix$$name$_.DestroyNoArena($default_variable$);\n", '$' };
+    printer->Print(variables_, destroy_no_arena.Get());
   }
 }
 
@@ -622,40 +658,45 @@ GenerateSwappingCode(io::Printer* printer) const {
 
 void StringOneofFieldGenerator::
 GenerateConstructorCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate constructor_code = {
     "  $classname$_default_oneof_instance_->$name$_.UnsafeSetDefault("
-    "$default_variable$);\n");
+    "$default_variable$);\n", '$' };
+  printer->Print(variables_, constructor_code.Get());
 }
 
 void StringOneofFieldGenerator::
 GenerateDestructorCode(io::Printer* printer) const {
   if (SupportsArenas(descriptor_)) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate destroy = {
       "if (has_$name$()) {\n"
       "  $oneof_prefix$$name$_.Destroy($default_variable$,\n"
       "      GetArenaNoVirtual());\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, destroy.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate destroy_no_arena = {
       "if (has_$name$()) {\n"
       "  $oneof_prefix$$name$_.DestroyNoArena($default_variable$);\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, destroy_no_arena.Get());
   }
 }
 
 void StringOneofFieldGenerator::
 GenerateMergeFromCodedStream(io::Printer* printer) const {
-    printer->Print(variables_,
-      "DO_(::google::protobuf::internal::WireFormatLite::Read$declared_type$(\n"
-      "      input, this->mutable_$name$()));\n");
+  static io::LazyPrinterTemplate read_string = {
+    "DO_(::google::protobuf::internal::WireFormatLite::Read$declared_type$(\n"
+    "      input, this->mutable_$name$()));\n", '$' };
+  printer->Print(variables_, read_string.Get());
 
   if (HasUtf8Verification(descriptor_->file()) &&
       descriptor_->type() == FieldDescriptor::TYPE_STRING) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate verify_parsed_utf8 = {
       "::google::protobuf::internal::WireFormat::VerifyUTF8StringNamedField(\n"
       "  this->$name$().data(), this->$name$().length(),\n"
       "  ::google::protobuf::internal::WireFormat::PARSE,\n"
-      "  \"$full_name$\");\n");
+      "  \"$full_name$\");\n", '$' };
+    printer->Print(variables_, verify_parsed_utf8.Get());
   }
 }
 
@@ -673,8 +714,9 @@ RepeatedStringFieldGenerator::~RepeatedStringFieldGenerator() {}
 
 void RepeatedStringFieldGenerator::
 GeneratePrivateMembers(io::Printer* printer) const {
-  printer->Print(variables_,
-    "::google::protobuf::RepeatedPtrField< ::std::string> $name$_;\n");
+  static io::LazyPrinterTemplate private_members = {
+    "::google::protobuf::RepeatedPtrField< ::std::string> $name$_;\n", '$' };
+  printer->Print(variables_, private_members.Get());
 }
 
 void RepeatedStringFieldGenerator::
@@ -691,7 +733,7 @@ GenerateAccessorDeclarations(io::Printer* printer) const {
     printer->Indent();
   }
 
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate element_accessor_declarations = {
     "const ::std::string& $name$(int index) const$deprecation$;\n"
     "::std::string* mutable_$name$(int index)$deprecation$;\n"
     "void set_$name$(int index, const ::std::string& value)$deprecation$;\n"
@@ -703,13 +745,15 @@ GenerateAccessorDeclarations(io::Printer* printer) const {
     "void add_$name$(const ::std::string& value)$deprecation$;\n"
     "void add_$name$(const char* value)$deprecation$;\n"
     "void add_$name$(const $pointer_type$* value, size_t size)"
-                 "$deprecation$;\n");
+                 "$deprecation$;\n", '$' };
+  printer->Print(variables_, element_accessor_declarations.Get());
 
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate list_accessor_declarations = {
     "const ::google::protobuf::RepeatedPtrField< ::std::string>& $name$() const"
                  "$deprecation$;\n"
     "::google::protobuf::RepeatedPtrField< ::std::string>* mutable_$name$()"
-                 "$deprecation$;\n");
+                 "$deprecation$;\n", '$' };
+  printer->Print(variables_, list_accessor_declarations.Get());
 
   if (unknown_ctype) {
     printer->Outdent();
@@ -723,7 +767,7 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
                                   bool is_inline) const {
   map<string, string> variables(variables_);
   variables["inline"] = is_inline ? "inline" : "";
-  printer->Print(variables,
+  static io::LazyPrinterTemplate element_accessor_definitions = {
     "$inline$ const ::std::string& $classname$::$name$(int index) const {\n"
     "  // @@protoc_insertion_point(field_get:$full_name$)\n"
     "  return $name$_.$cppget$(index);\n"
@@ -762,8 +806,9 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
     "$classname$::add_$name$(const $pointer_type$* value, size_t size) {\n"
     "  $name$_.Add()->assign(reinterpret_cast<const char*>(value), size);\n"
     "  // @@protoc_insertion_point(field_add_pointer:$full_name$)\n"
-    "}\n");
-  printer->Print(variables,
+    "}\n", '$' };
+  printer->Print(variables, element_accessor_definitions.Get());
+  static io::LazyPrinterTemplate list_accessor_definitions = {
     "$inline$ const ::google::protobuf::RepeatedPtrField< ::std::string>&\n"
     "$classname$::$name$() const {\n"
     "  // @@protoc_insertion_point(field_list:$full_name$)\n"
@@ -773,22 +818,28 @@ GenerateInlineAccessorDefinitions(io::Printer* printer,
     "$classname$::mutable_$name$() {\n"
     "  // @@protoc_insertion_point(field_mutable_list:$full_name$)\n"
     "  return &$name$_;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables, list_accessor_definitions.Get());
 }
 
 void RepeatedStringFieldGenerator::
 GenerateClearingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.Clear();\n");
+  static io::LazyPrinterTemplate clearing_code = { "$name$_.Clear();\n", '$' };
+  printer->Print(variables_, clearing_code.Get());
 }
 
 void RepeatedStringFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.MergeFrom(from.$name$_);\n");
+  static io::LazyPrinterTemplate merging_code = {
+    "$name$_.MergeFrom(from.$name$_);\n", '$' };
+  printer->Print(variables_, merging_code.Get());
 }
 
 void RepeatedStringFieldGenerator::
 GenerateSwappingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.UnsafeArenaSwap(&other->$name$_);\n");
+  static io::LazyPrinterTemplate swapping_code = {
+    "$name$_.UnsafeArenaSwap(&other->$name$_);\n", '$' };
+  printer->Print(variables_, swapping_code.Get());
 }
 
 void RepeatedStringFieldGenerator::
@@ -798,64 +849,73 @@ GenerateConstructorCode(io::Printer* printer) const {
 
 void RepeatedStringFieldGenerator::
 GenerateMergeFromCodedStream(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate read_string = {
     "DO_(::google::protobuf::internal::WireFormatLite::Read$declared_type$(\n"
-    "      input, this->add_$name$()));\n");
+    "      input, this->add_$name$()));\n", '$' };
+  printer->Print(variables_, read_string.Get());
   if (HasUtf8Verification(descriptor_->file()) &&
       descriptor_->type() == FieldDescriptor::TYPE_STRING) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate verify_parsed_utf8 = {
       "::google::protobuf::internal::WireFormat::VerifyUTF8StringNamedField(\n"
       "  this->$name$(this->$name$_size() - 1).data(),\n"
       "  this->$name$(this->$name$_size() - 1).length(),\n"
       "  ::google::protobuf::internal::WireFormat::PARSE,\n"
-      "  \"$full_name$\");\n");
+      "  \"$full_name$\");\n", '$' };
+    printer->Print(variables_, verify_parsed_utf8.Get());
   }
 }
 
 void RepeatedStringFieldGenerator::
 GenerateSerializeWithCachedSizes(io::Printer* printer) const {
-  printer->Print(variables_,
-    "for (int i = 0; i < this->$name$_size(); i++) {\n");
+  static io::LazyPrinterTemplate loop_start = {
+    "for (int i = 0; i < this->$name$_size(); i++) {\n", '$' };
+  printer->Print(variables_, loop_start.Get());
   if (HasUtf8Verification(descriptor_->file()) &&
       descriptor_->type() == FieldDescriptor::TYPE_STRING) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate verify_utf8 = {
       "::google::protobuf::internal::WireFormat::VerifyUTF8StringNamedField(\n"
       "  this->$name$(i).data(), this->$name$(i).length(),\n"
       "  ::google::protobuf::internal::WireFormat::SERIALIZE,\n"
-      "  \"$full_name$\");\n");
+      "  \"$full_name$\");\n", '$' };
+    printer->Print(variables_, verify_utf8.Get());
   }
-  printer->Print(variables_,
-    "  ::google::protobuf::internal::WireFormatLite::Write$declared_type$(\n"
+  static io::LazyPrinterTemplate write_element = {
+    "  ::google::protobuf::internal::WireFormatLite::Write$declared_type$MaybeAliased(\n"
     "    $number$, this->$name$(i), output);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, write_element.Get());
 }
 
 void RepeatedStringFieldGenerator::
 GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const {
-  printer->Print(variables_,
-    "for (int i = 0; i < this->$name$_size(); i++) {\n");
+  static io::LazyPrinterTemplate loop_start = {
+    "for (int i = 0; i < this->$name$_size(); i++) {\n", '$' };
+  printer->Print(variables_, loop_start.Get());
   if (HasUtf8Verification(descriptor_->file()) &&
       descriptor_->type() == FieldDescriptor::TYPE_STRING) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate verify_utf8 = {
       "  ::google::protobuf::internal::WireFormat::VerifyUTF8StringNamedField(\n"
       "    this->$name$(i).data(), this->$name$(i).length(),\n"
       "    ::google::protobuf::internal::WireFormat::SERIALIZE,\n"
-      "    \"$full_name$\");\n");
+      "    \"$full_name$\");\n", '$' };
+    printer->Print(variables_, verify_utf8.Get());
   }
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate write_element = {
     "  target = ::google::protobuf::internal::WireFormatLite::\n"
     "    Write$declared_type$ToArray($number$, this->$name$(i), target);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, write_element.Get());
 }
 
 void RepeatedStringFieldGenerator::
 GenerateByteSize(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate byte_size = {
     "total_size += $tag_size$ * this->$name$_size();\n"
     "for (int i = 0; i < this->$name$_size(); i++) {\n"
     "  total_size += ::google::protobuf::internal::WireFormatLite::$declared_type$Size(\n"
     "    this->$name$(i));\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, byte_size.Get());
 }
 
 }  // namespace cpp
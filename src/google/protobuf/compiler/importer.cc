@@ -34,13 +34,16 @@
 
 #ifdef _MSC_VER
 #include <io.h>
+#include <process.h>
 #else
 #include <unistd.h>
 #endif
+#include <stdio.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <limits.h>
 
 #include <algorithm>
 #include <memory>
@@ -51,9 +54,11 @@
 #include <google/protobuf/compiler/importer.h>
 
 #include <google/protobuf/compiler/parser.h>
+#include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/tokenizer.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 #include <google/protobuf/stubs/strutil.h>
+#include <google/protobuf/stubs/substitute.h>
 
 namespace google {
 namespace protobuf {
@@ -66,6 +71,18 @@ namespace compiler {
 #include <ctype.h>
 #endif
 
+#ifdef _MSC_VER
+#define getpid _getpid
+#endif
+
+#ifndef O_BINARY
+#ifdef _O_BINARY
+#define O_BINARY _O_BINARY
+#else
+#define O_BINARY 0     // If this isn't defined, the platform doesn't need it.
+#endif
+#endif
+
 // Returns true if the text looks like a Windows-style absolute path, starting
 // with a drive letter.  Example:  "C:\foo".  TODO(kenton):  Share this with
 // copy in command_line_interface.cc?
@@ -82,6 +99,103 @@ static bool IsWindowsAbsolutePath(const string& text) {
 
 MultiFileErrorCollector::~MultiFileErrorCollector() {}
 
+namespace {
+
+// Appends message and all messages nested within it to *output, in a fixed
+// pre-order which is the same for any two equal messages.
+void ListMessages(const Message& message, vector<const Message*>* output) {
+  output->push_back(&message);
+
+  const Reflection* reflection = message.GetReflection();
+  vector<const FieldDescriptor*> fields;
+  reflection->ListFields(message, &fields);
+  for (int i = 0; i < fields.size(); i++) {
+    const FieldDescriptor* field = fields[i];
+    if (field->cpp_type() != FieldDescriptor::CPPTYPE_MESSAGE) continue;
+    if (field->is_repeated()) {
+      int size = reflection->FieldSize(message, field);
+      for (int j = 0; j < size; j++) {
+        ListMessages(reflection->GetRepeatedMessage(message, field, j), output);
+      }
+    } else {
+      ListMessages(reflection->GetMessage(message, field), output);
+    }
+  }
+}
+
+const int kErrorLocationCount =
+    DescriptorPool::ErrorCollector::OTHER + 1;
+
+// Serializes a parsed file, and the parts of locations which refer to it,
+// for SourceTreeDescriptorDatabase::UseCache().  Locations are keyed by the
+// index of the message in ListMessages() order, since pointers do not
+// survive the trip.
+void EncodeParsedFile(const FileDescriptorProto& file,
+                      const SourceLocationTable* locations,
+                      string* output) {
+  output->clear();
+  io::StringOutputStream output_stream(output);
+  io::CodedOutputStream coded_output(&output_stream);
+
+  string serialized;
+  file.SerializeToString(&serialized);
+  coded_output.WriteVarint32(serialized.size());
+  coded_output.WriteString(serialized);
+
+  vector<const Message*> messages;
+  ListMessages(file, &messages);
+  for (int i = 0; i < messages.size(); i++) {
+    for (int j = 0; j < kErrorLocationCount; j++) {
+      int line, column;
+      if (locations->Find(
+              messages[i],
+              static_cast<DescriptorPool::ErrorCollector::ErrorLocation>(j),
+              &line, &column)) {
+        coded_output.WriteVarint32(i);
+        coded_output.WriteVarint32(j);
+        coded_output.WriteVarint32(line);
+        coded_output.WriteVarint32(column);
+      }
+    }
+  }
+}
+
+// Reverses EncodeParsedFile(), adding the recorded locations to *locations.
+// Returns false if data is corrupt.
+bool DecodeParsedFile(const string& data, FileDescriptorProto* file,
+                      SourceLocationTable* locations) {
+  io::CodedInputStream input(reinterpret_cast<const uint8*>(data.data()),
+                             data.size());
+  input.SetTotalBytesLimit(INT_MAX, -1);
+
+  uint32 size;
+  if (!input.ReadVarint32(&size)) return false;
+  io::CodedInputStream::Limit limit = input.PushLimit(size);
+  if (!file->ParseFromCodedStream(&input) ||
+      !input.ConsumedEntireMessage()) {
+    return false;
+  }
+  input.PopLimit(limit);
+
+  vector<const Message*> messages;
+  ListMessages(*file, &messages);
+  while (!input.ExpectAtEnd()) {
+    uint32 index, location, line, column;
+    if (!input.ReadVarint32(&index) || index >= messages.size() ||
+        !input.ReadVarint32(&location) || location >= kErrorLocationCount ||
+        !input.ReadVarint32(&line) || !input.ReadVarint32(&column)) {
+      return false;
+    }
+    locations->Add(
+        messages[index],
+        static_cast<DescriptorPool::ErrorCollector::ErrorLocation>(location),
+        line, column);
+  }
+  return true;
+}
+
+}  // namespace
+
 // This class serves two purposes:
 // - It implements the ErrorCollector interface (used by Tokenizer and Parser)
 //   in terms of MultiFileErrorCollector, using a particular filename.
@@ -118,6 +232,7 @@ SourceTreeDescriptorDatabase::SourceTreeDescriptorDatabase(
     SourceTree* source_tree)
   : source_tree_(source_tree),
     error_collector_(NULL),
+    cache_(NULL),
     using_validation_error_collector_(false),
     validation_error_collector_(this) {}
 
@@ -134,15 +249,59 @@ bool SourceTreeDescriptorDatabase::FindFileByName(
     return false;
   }
 
+  if (cache_ == NULL) {
+    return Parse(filename, input.get(), output);
+  }
+
+  // The key is the file's name followed by its contents, which we need to
+  // read in full anyway.
+  string key = strings::Substitute(
+      "SourceTreeDescriptorDatabase $0\n$1\n",
+      internal::VersionString(GOOGLE_PROTOBUF_VERSION), filename);
+  int header_size = key.size();
+  const void* data;
+  int size;
+  while (input->Next(&data, &size)) {
+    key.append(reinterpret_cast<const char*>(data), size);
+  }
+
+  // Locations are always cached, since a later user of the cache may want
+  // them even if we don't.
+  string value;
+  if (cache_->Lookup(key, &value)) {
+    if (DecodeParsedFile(value, output, &source_locations_)) {
+      return true;
+    }
+    output->Clear();
+  }
+
+  io::ArrayInputStream contents(key.data() + header_size,
+                                key.size() - header_size);
+  if (!Parse(filename, &contents, output)) {
+    return false;
+  }
+  // A file without a syntax statement makes the parser log a warning, which
+  // a cache hit would skip; leave such files out so the warning is always
+  // shown.
+  if (output->has_syntax()) {
+    EncodeParsedFile(*output, &source_locations_, &value);
+    cache_->Insert(key, value);
+  }
+  return true;
+}
+
+bool SourceTreeDescriptorDatabase::Parse(const string& filename,
+                                         io::ZeroCopyInputStream* input,
+                                         FileDescriptorProto* output) {
   // Set up the tokenizer and parser.
   SingleFileErrorCollector file_error_collector(filename, error_collector_);
-  io::Tokenizer tokenizer(input.get(), &file_error_collector);
+  io::Tokenizer tokenizer(input, &file_error_collector);
 
   Parser parser;
   if (error_collector_ != NULL) {
     parser.RecordErrorsTo(&file_error_collector);
   }
-  if (using_validation_error_collector_) {
+  if (using_validation_error_collector_ || cache_ != NULL) {
     parser.RecordSourceLocationsTo(&source_locations_);
   }
 
@@ -478,6 +637,101 @@ io::ZeroCopyInputStream* DiskSourceTree::OpenDiskFile(
   }
 }
 
+// ===================================================================
+
+ContentCache::~ContentCache() {}
+
+DiskContentCache::DiskContentCache(const string& directory)
+  : directory_(directory),
+    next_temp_file_id_(0) {
+  if (!directory_.empty() && directory_[directory_.size() - 1] != '/') {
+    directory_.push_back('/');
+  }
+}
+
+DiskContentCache::~DiskContentCache() {}
+
+string DiskContentCache::GetEntryPath(const string& key) const {
+  // 64-bit FNV-1a.  Collisions are harmless, since Lookup() compares the
+  // full key.
+  uint64 hash = GOOGLE_ULONGLONG(14695981039346656037);
+  for (int i = 0; i < key.size(); i++) {
+    hash ^= static_cast<uint8>(key[i]);
+    hash *= GOOGLE_ULONGLONG(1099511628211);
+  }
+
+  char buffer[kFastToBufferSize];
+  return directory_ + FastHex64ToBuffer(hash, buffer);
+}
+
+bool DiskContentCache::Lookup(const string& key, string* value) {
+  string path = GetEntryPath(key);
+  int file_descriptor;
+  do {
+    file_descriptor = open(path.c_str(), O_RDONLY | O_BINARY);
+  } while (file_descriptor < 0 && errno == EINTR);
+  if (file_descriptor < 0) {
+    return false;
+  }
+
+  io::FileInputStream file(file_descriptor);
+  file.SetCloseOnDelete(true);
+  io::CodedInputStream input(&file);
+  input.SetTotalBytesLimit(INT_MAX, -1);
+
+  // An entry is the key and the value, each preceded by its size.
+  uint32 size;
+  string stored_key;
+  if (!input.ReadVarint32(&size) || size != key.size() ||
+      !input.ReadString(&stored_key, size) || stored_key != key ||
+      !input.ReadVarint32(&size) || !input.ReadString(value, size)) {
+    return false;
+  }
+  return true;
+}
+
+void DiskContentCache::Insert(const string& key, const string& value) {
+  string path = GetEntryPath(key);
+
+  // Write to a file no one else could be writing to, then rename it into
+  // place, so that readers never see a partial entry.
+  int temp_file_id;
+  {
+    MutexLock lock(&mutex_);
+    temp_file_id = next_temp_file_id_++;
+  }
+  string temp_path = strings::Substitute("$0.$1.$2.tmp", path, getpid(),
+                                         temp_file_id);
+
+  int file_descriptor;
+  do {
+    file_descriptor = open(temp_path.c_str(),
+                           O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0666);
+  } while (file_descriptor < 0 && errno == EINTR);
+  if (file_descriptor < 0) {
+    return;
+  }
+
+  io::FileOutputStream file(file_descriptor);
+  {
+    io::CodedOutputStream output(&file);
+    output.WriteVarint32(key.size());
+    output.WriteString(key);
+    output.WriteVarint32(value.size());
+    output.WriteString(value);
+  }
+  if (!file.Close()) {
+    remove(temp_path.c_str());
+    return;
+  }
+
+  if (rename(temp_path.c_str(), path.c_str()) != 0) {
+    // Windows refuses to rename over an existing file.  Some other process
+    // must have just written the same entry, so ours isn't needed.
+    remove(temp_path.c_str());
+  }
+}
+
 }  // namespace compiler
 }  // namespace protobuf
 }  // namespace google
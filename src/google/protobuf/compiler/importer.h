@@ -57,6 +57,8 @@ class Importer;
 class MultiFileErrorCollector;
 class SourceTree;
 class DiskSourceTree;
+class ContentCache;
+class DiskContentCache;
 
 // TODO(kenton):  Move all SourceTree stuff to a separate file?
 
@@ -95,6 +97,17 @@ class LIBPROTOBUF_EXPORT SourceTreeDescriptorDatabase : public DescriptorDatabas
     return &validation_error_collector_;
   }
 
+  // Instructs the SourceTreeDescriptorDatabase to look up each file in the
+  // given cache before parsing it, keyed by the file's name and exact
+  // contents, and to add every file it parses without warnings to the
+  // cache.  A cache hit skips tokenizing and parsing entirely; error
+  // locations reported through GetValidationErrorCollector() are preserved.
+  // cache must remain valid until either this method is called again or the
+  // SourceTreeDescriptorDatabase is destroyed.  NULL disables caching.
+  void UseCache(ContentCache* cache) {
+    cache_ = cache;
+  }
+
   // implements DescriptorDatabase -----------------------------------
   bool FindFileByName(const string& filename, FileDescriptorProto* output);
   bool FindFileContainingSymbol(const string& symbol_name,
@@ -106,8 +119,13 @@ class LIBPROTOBUF_EXPORT SourceTreeDescriptorDatabase : public DescriptorDatabas
  private:
   class SingleFileErrorCollector;
 
+  // Tokenizes and parses the given input.
+  bool Parse(const string& filename, io::ZeroCopyInputStream* input,
+             FileDescriptorProto* output);
+
   SourceTree* source_tree_;
   MultiFileErrorCollector* error_collector_;
+  ContentCache* cache_;
 
   class LIBPROTOBUF_EXPORT ValidationErrorCollector : public DescriptorPool::ErrorCollector {
    public:
@@ -169,6 +187,11 @@ class LIBPROTOBUF_EXPORT Importer {
   void AddUnusedImportTrackFile(const string& file_name);
   void ClearUnusedImportTrackFiles();
 
+  // See SourceTreeDescriptorDatabase::UseCache().
+  void UseCache(ContentCache* cache) {
+    database_.UseCache(cache);
+  }
+
  private:
   SourceTreeDescriptorDatabase database_;
   DescriptorPool pool_;
@@ -310,6 +333,55 @@ class LIBPROTOBUF_EXPORT DiskSourceTree : public SourceTree {
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(DiskSourceTree);
 };
 
+// A persistent map from byte strings to byte strings, used to remember the
+// results of expensive work (such as parsing a .proto file) from one run of
+// the compiler to the next.  Implementations must be safe to call from
+// multiple threads.
+class LIBPROTOBUF_EXPORT ContentCache {
+ public:
+  inline ContentCache() {}
+  virtual ~ContentCache();
+
+  // If a value was previously inserted under exactly this key, copies it to
+  // *value and returns true.  Otherwise returns false.
+  virtual bool Lookup(const string& key, string* value) = 0;
+
+  // Stores value under key, replacing any previous value.  Failures are
+  // silently ignored; the next Lookup() will simply miss.
+  virtual void Insert(const string& key, const string& value) = 0;
+
+ private:
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(ContentCache);
+};
+
+// An implementation of ContentCache which stores each entry as a file in a
+// directory on disk.  Files are named by a hash of the key; the full key is
+// stored in the file and compared on lookup, so hash collisions only cost a
+// cache miss.  Entries are written to a temporary file and then renamed into
+// place, so several processes may share the same directory.  Nothing is ever
+// deleted; it is up to the user to clean out the directory.
+class LIBPROTOBUF_EXPORT DiskContentCache : public ContentCache {
+ public:
+  // directory must exist.
+  explicit DiskContentCache(const string& directory);
+  ~DiskContentCache();
+
+  // implements ContentCache -----------------------------------------
+  bool Lookup(const string& key, string* value);
+  void Insert(const string& key, const string& value);
+
+ private:
+  // Returns the path of the file which holds the entry for key.
+  string GetEntryPath(const string& key) const;
+
+  string directory_;
+
+  Mutex mutex_;
+  int next_temp_file_id_;  // Under mutex_.
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(DiskContentCache);
+};
+
 }  // namespace compiler
 }  // namespace protobuf
 
@@ -109,6 +109,30 @@ class MockSourceTree : public SourceTree {
   hash_map<string, const char*> files_;
 };
 
+// -------------------------------------------------------------------
+
+// A ContentCache backed by a map, which counts hits.
+class MockContentCache : public ContentCache {
+ public:
+  MockContentCache() : hits_(0) {}
+  ~MockContentCache() {}
+
+  map<string, string> entries_;
+  int hits_;
+
+  // implements ContentCache -----------------------------------------
+  bool Lookup(const string& key, string* value) {
+    const string* entry = FindOrNull(entries_, key);
+    if (entry == NULL) return false;
+    ++hits_;
+    *value = *entry;
+    return true;
+  }
+  void Insert(const string& key, const string& value) {
+    entries_[key] = value;
+  }
+};
+
 // ===================================================================
 
 class ImporterTest : public testing::Test {
@@ -224,6 +248,98 @@ TEST_F(ImporterTest, RecursiveImport) {
 }
 
 
+TEST_F(ImporterTest, Cache) {
+  // Test that a cached file is not parsed again, and that validation errors
+  // in it are still reported at the right place.
+  AddFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {\n"
+    "  optional Bar bar = 1;\n"
+    "}\n");
+  MockContentCache cache;
+  importer_.UseCache(&cache);
+
+  EXPECT_TRUE(importer_.Import("foo.proto") == NULL);
+  EXPECT_EQ("foo.proto:2:11: \"Bar\" is not defined.\n", error());
+  EXPECT_EQ(1, cache.entries_.size());
+  EXPECT_EQ(0, cache.hits_);
+
+  MockErrorCollector error_collector;
+  Importer importer(&source_tree_, &error_collector);
+  importer.UseCache(&cache);
+  EXPECT_TRUE(importer.Import("foo.proto") == NULL);
+  EXPECT_EQ("foo.proto:2:11: \"Bar\" is not defined.\n",
+            error_collector.text_);
+  EXPECT_EQ(1, cache.hits_);
+}
+
+TEST_F(ImporterTest, CacheMiss) {
+  // Test that changing a file invalidates its cache entry.
+  AddFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+  MockContentCache cache;
+  importer_.UseCache(&cache);
+  ASSERT_TRUE(importer_.Import("foo.proto") != NULL);
+
+  MockErrorCollector error_collector;
+  MockSourceTree source_tree;
+  source_tree.AddFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Bar {}\n");
+  Importer importer(&source_tree, &error_collector);
+  importer.UseCache(&cache);
+  const FileDescriptor* file = importer.Import("foo.proto");
+  EXPECT_EQ("", error_collector.text_);
+  ASSERT_TRUE(file != NULL);
+  ASSERT_EQ(1, file->message_type_count());
+  EXPECT_EQ("Bar", file->message_type(0)->name());
+  EXPECT_EQ(0, cache.hits_);
+  EXPECT_EQ(2, cache.entries_.size());
+}
+
+TEST_F(ImporterTest, CacheSkipsFileWithoutSyntax) {
+  // Test that a file the parser warns about is not cached, so that the
+  // warning is not lost on later runs.
+  AddFile("foo.proto",
+    "message Foo {}\n");
+  MockContentCache cache;
+  importer_.UseCache(&cache);
+  ASSERT_TRUE(importer_.Import("foo.proto") != NULL);
+  EXPECT_EQ(0, cache.entries_.size());
+}
+
+// ===================================================================
+
+TEST(DiskContentCacheTest, LookupAndInsert) {
+  string directory = TestTempDir() + "/test_proto2_content_cache";
+  if (FileExists(directory)) {
+    File::DeleteRecursively(directory, NULL, NULL);
+  }
+  GOOGLE_CHECK_OK(File::CreateDir(directory, 0777));
+
+  DiskContentCache cache(directory);
+  string value;
+  EXPECT_FALSE(cache.Lookup("foo", &value));
+
+  cache.Insert("foo", string("bar\0baz", 7));
+  cache.Insert("qux", "");
+  ASSERT_TRUE(cache.Lookup("foo", &value));
+  EXPECT_EQ(string("bar\0baz", 7), value);
+  ASSERT_TRUE(cache.Lookup("qux", &value));
+  EXPECT_EQ("", value);
+
+  // Entries survive the cache object, and may be replaced.
+  DiskContentCache other_cache(directory);
+  ASSERT_TRUE(other_cache.Lookup("foo", &value));
+  EXPECT_EQ(string("bar\0baz", 7), value);
+  other_cache.Insert("foo", "corge");
+  ASSERT_TRUE(cache.Lookup("foo", &value));
+  EXPECT_EQ("corge", value);
+
+  File::DeleteRecursively(directory, NULL, NULL);
+}
+
 // ===================================================================
 
 class DiskSourceTreeTest : public testing::Test {
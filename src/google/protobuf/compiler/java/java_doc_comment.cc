@@ -123,14 +123,16 @@ static void WriteDocCommentBodyForLocation(
     printer->Print(
         " *\n"
         " * <pre>\n");
+    static io::LazyPrinterTemplate spaced_line = { " * $line$\n", '$' };
+    static io::LazyPrinterTemplate line = { " *$line$\n", '$' };
     for (int i = 0; i < lines.size(); i++) {
       // Most lines should start with a space.  Watch out for lines that start
       // with a /, since putting that right after the leading asterisk will
       // close the comment.
       if (!lines[i].empty() && lines[i][0] == '/') {
-        printer->Print(" * $line$\n", "line", lines[i]);
+        printer->Print(spaced_line.Get(), "line", lines[i]);
       } else {
-        printer->Print(" *$line$\n", "line", lines[i]);
+        printer->Print(line.Get(), "line", lines[i]);
       }
     }
     printer->Print(" * </pre>\n");
@@ -180,10 +182,11 @@ void WriteFieldDocComment(io::Printer* printer, const FieldDescriptor* field) {
   //   optional string foo = 5;
   // This communicates a lot of information about the field in a small space.
   // If the field is a group, the debug string might end with {.
-  printer->Print(
+  static io::LazyPrinterTemplate start = {
     "/**\n"
-    " * <code>$def$</code>\n",
-    "def", EscapeJavadoc(FirstLineOf(field->DebugString())));
+    " * <code>$def$</code>\n", '$' };
+  printer->Print(start.Get(),
+                 "def", EscapeJavadoc(FirstLineOf(field->DebugString())));
   WriteDocCommentBody(printer, field);
   printer->Print(" */\n");
 }
@@ -199,10 +202,11 @@ void WriteEnumDocComment(io::Printer* printer, const EnumDescriptor* enum_) {
 
 void WriteEnumValueDocComment(io::Printer* printer,
                               const EnumValueDescriptor* value) {
-  printer->Print(
+  static io::LazyPrinterTemplate start = {
     "/**\n"
-    " * <code>$def$</code>\n",
-    "def", EscapeJavadoc(FirstLineOf(value->DebugString())));
+    " * <code>$def$</code>\n", '$' };
+  printer->Print(start.Get(),
+                 "def", EscapeJavadoc(FirstLineOf(value->DebugString())));
   WriteDocCommentBody(printer, value);
   printer->Print(" */\n");
 }
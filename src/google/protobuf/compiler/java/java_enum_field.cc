@@ -156,79 +156,90 @@ void ImmutableEnumFieldGenerator::
 GenerateInterfaceMembers(io::Printer* printer) const {
   if (SupportFieldPresence(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
-      "$deprecation$boolean has$capitalized_name$();\n");
+    static io::LazyPrinterTemplate has_declaration = {
+      "$deprecation$boolean has$capitalized_name$();\n", '$' };
+    printer->Print(variables_, has_declaration.Get());
   }
   if (SupportUnknownEnumValue(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
-      "$deprecation$int get$capitalized_name$Value();\n");
+    static io::LazyPrinterTemplate get_value_declaration = {
+      "$deprecation$int get$capitalized_name$Value();\n", '$' };
+    printer->Print(variables_, get_value_declaration.Get());
   }
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
-    "$deprecation$$type$ get$capitalized_name$();\n");
+  static io::LazyPrinterTemplate get_declaration = {
+    "$deprecation$$type$ get$capitalized_name$();\n", '$' };
+  printer->Print(variables_, get_declaration.Get());
 }
 
 void ImmutableEnumFieldGenerator::
 GenerateMembers(io::Printer* printer) const {
-  printer->Print(variables_,
-    "private int $name$_;\n");
+  static io::LazyPrinterTemplate field = { "private int $name$_;\n", '$' };
+  printer->Print(variables_, field.Get());
   PrintExtraFieldInfo(variables_, printer);
   if (SupportFieldPresence(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate has_method = {
       "$deprecation$public boolean has$capitalized_name$() {\n"
       "  return $get_has_field_bit_message$;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, has_method.Get());
   }
   if (SupportUnknownEnumValue(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_value_method = {
       "$deprecation$public int get$capitalized_name$Value() {\n"
       "  return $name$_;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_value_method.Get());
   }
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method = {
     "$deprecation$public $type$ get$capitalized_name$() {\n"
     "  $type$ result = $type$.valueOf($name$_);\n"
     "  return result == null ? $unknown$ : result;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
 }
 
 void ImmutableEnumFieldGenerator::
 GenerateBuilderMembers(io::Printer* printer) const {
-  printer->Print(variables_,
-    "private int $name$_ = $default_number$;\n");
+  static io::LazyPrinterTemplate field = {
+    "private int $name$_ = $default_number$;\n", '$' };
+  printer->Print(variables_, field.Get());
   if (SupportFieldPresence(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate has_method = {
       "$deprecation$public boolean has$capitalized_name$() {\n"
       "  return $get_has_field_bit_builder$;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, has_method.Get());
   }
   if (SupportUnknownEnumValue(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_value_method = {
       "$deprecation$public int get$capitalized_name$Value() {\n"
       "  return $name$_;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_value_method.Get());
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate set_value_method = {
       "$deprecation$public Builder set$capitalized_name$Value(int value) {\n"
       "  $name$_ = value;\n"
       "  $on_changed$\n"
       "  return this;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, set_value_method.Get());
   }
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method = {
     "$deprecation$public $type$ get$capitalized_name$() {\n"
     "  $type$ result = $type$.valueOf($name$_);\n"
     "  return result == null ? $unknown$ : result;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate set_method = {
     "$deprecation$public Builder set$capitalized_name$($type$ value) {\n"
     "  if (value == null) {\n"
     "    throw new NullPointerException();\n"
@@ -237,15 +248,17 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "  $name$_ = value.getNumber();\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, set_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate clear_method = {
     "$deprecation$public Builder clear$capitalized_name$() {\n"
     "  $clear_has_field_bit_builder$\n"
     "  $name$_ = $default_number$;\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, clear_method.Get());
 }
 
 void ImmutableEnumFieldGenerator::
@@ -255,28 +268,33 @@ GenerateFieldBuilderInitializationCode(io::Printer* printer)  const {
 
 void ImmutableEnumFieldGenerator::
 GenerateInitializationCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_ = $default_number$;\n");
+  static io::LazyPrinterTemplate initialization_code = {
+    "$name$_ = $default_number$;\n", '$' };
+  printer->Print(variables_, initialization_code.Get());
 }
 
 void ImmutableEnumFieldGenerator::
 GenerateBuilderClearCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate builder_clear_code = {
     "$name$_ = $default_number$;\n"
-    "$clear_has_field_bit_builder$\n");
+    "$clear_has_field_bit_builder$\n", '$' };
+  printer->Print(variables_, builder_clear_code.Get());
 }
 
 void ImmutableEnumFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
   if (SupportFieldPresence(descriptor_->file())) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate merge_if_has = {
       "if (other.has$capitalized_name$()) {\n"
       "  set$capitalized_name$(other.get$capitalized_name$());\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, merge_if_has.Get());
   } else if (SupportUnknownEnumValue(descriptor_->file())) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate merge_if_not_default = {
       "if (other.$name$_ != $default_number$) {\n"
       "  set$capitalized_name$Value(other.get$capitalized_name$Value());\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, merge_if_not_default.Get());
   } else {
     GOOGLE_LOG(FATAL) << "Can't reach here.";
   }
@@ -285,36 +303,42 @@ GenerateMergingCode(io::Printer* printer) const {
 void ImmutableEnumFieldGenerator::
 GenerateBuildingCode(io::Printer* printer) const {
   if (SupportFieldPresence(descriptor_->file())) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate copy_has_bit = {
       "if ($get_has_field_bit_from_local$) {\n"
       "  $set_has_field_bit_to_local$;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, copy_has_bit.Get());
   }
-  printer->Print(variables_,
-    "result.$name$_ = $name$_;\n");
+  static io::LazyPrinterTemplate copy_value = {
+    "result.$name$_ = $name$_;\n", '$' };
+  printer->Print(variables_, copy_value.Get());
 }
 
 void ImmutableEnumFieldGenerator::
 GenerateParsingCode(io::Printer* printer) const {
   if (SupportUnknownEnumValue(descriptor_->file())) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate read_raw_value = {
       "int rawValue = input.readEnum();\n"
       "$set_has_field_bit_message$\n"
-      "$name$_ = rawValue;\n");
+      "$name$_ = rawValue;\n", '$' };
+    printer->Print(variables_, read_raw_value.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate read_known_value = {
       "int rawValue = input.readEnum();\n"
       "$type$ value = $type$.valueOf(rawValue);\n"
-      "if (value == null) {\n");
+      "if (value == null) {\n", '$' };
+    printer->Print(variables_, read_known_value.Get());
     if (PreserveUnknownFields(descriptor_->containing_type())) {
-      printer->Print(variables_,
-        "  unknownFields.mergeVarintField($number$, rawValue);\n");
+      static io::LazyPrinterTemplate keep_unknown_value = {
+        "  unknownFields.mergeVarintField($number$, rawValue);\n", '$' };
+      printer->Print(variables_, keep_unknown_value.Get());
     }
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate set_known_value = {
       "} else {\n"
       "  $set_has_field_bit_message$\n"
       "  $name$_ = rawValue;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, set_known_value.Get());
   }
 }
 
@@ -325,32 +349,36 @@ GenerateParsingDoneCode(io::Printer* printer) const {
 
 void ImmutableEnumFieldGenerator::
 GenerateSerializationCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialization_code = {
     "if ($is_field_present_message$) {\n"
     "  output.writeEnum($number$, $name$_);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialization_code.Get());
 }
 
 void ImmutableEnumFieldGenerator::
 GenerateSerializedSizeCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialized_size_code = {
     "if ($is_field_present_message$) {\n"
     "  size += com.google.protobuf.CodedOutputStream\n"
     "    .computeEnumSize($number$, $name$_);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialized_size_code.Get());
 }
 
 void ImmutableEnumFieldGenerator::
 GenerateEqualsCode(io::Printer* printer) const {
-  printer->Print(variables_,
-    "result = result && $name$_ == other.$name$_;\n");
+  static io::LazyPrinterTemplate equals_code = {
+    "result = result && $name$_ == other.$name$_;\n", '$' };
+  printer->Print(variables_, equals_code.Get());
 }
 
 void ImmutableEnumFieldGenerator::
 GenerateHashCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate hash_code = {
     "hash = (37 * hash) + $constant_name$;\n"
-    "hash = (53 * hash) + $name$_;\n");
+    "hash = (53 * hash) + $name$_;\n", '$' };
+  printer->Print(variables_, hash_code.Get());
 }
 
 string ImmutableEnumFieldGenerator::GetBoxedType() const {
@@ -379,70 +407,77 @@ GenerateMembers(io::Printer* printer) const {
   PrintExtraFieldInfo(variables_, printer);
   if (SupportFieldPresence(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate has_method = {
       "$deprecation$public boolean has$capitalized_name$() {\n"
       "  return $has_oneof_case_message$;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, has_method.Get());
   }
   if (SupportUnknownEnumValue(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_value_method = {
       "$deprecation$public int get$capitalized_name$Value() {\n"
       "  if ($has_oneof_case_message$) {\n"
       "    return (java.lang.Integer) $oneof_name$_;\n"
       "  }\n"
       "  return $default_number$;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_value_method.Get());
   }
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method = {
     "$deprecation$public $type$ get$capitalized_name$() {\n"
     "  if ($has_oneof_case_message$) {\n"
     "    $type$ result =  $type$.valueOf((java.lang.Integer) $oneof_name$_);\n"
     "    return result == null ? $unknown$ : result;\n"
     "  }\n"
     "  return $default$;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
 }
 
 void ImmutableEnumOneofFieldGenerator::
 GenerateBuilderMembers(io::Printer* printer) const {
   if (SupportFieldPresence(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate has_method = {
       "$deprecation$public boolean has$capitalized_name$() {\n"
       "  return $has_oneof_case_message$;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, has_method.Get());
   }
   if (SupportUnknownEnumValue(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_value_method = {
       "$deprecation$public int get$capitalized_name$Value() {\n"
       "  if ($has_oneof_case_message$) {\n"
       "    return ((java.lang.Integer) $oneof_name$_).intValue();\n"
       "  }\n"
       "  return $default_number$;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_value_method.Get());
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate set_value_method = {
       "$deprecation$public Builder set$capitalized_name$Value(int value) {\n"
       "  $set_oneof_case_message$;\n"
       "  $oneof_name$_ = value;\n"
       "  $on_changed$\n"
       "  return this;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, set_value_method.Get());
   }
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method = {
     "$deprecation$public $type$ get$capitalized_name$() {\n"
     "  if ($has_oneof_case_message$) {\n"
     "    $type$ result =  $type$.valueOf((java.lang.Integer) $oneof_name$_);\n"
     "    return result == null ? $unknown$ : result;\n"
     "  }\n"
     "  return $default$;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate set_method = {
     "$deprecation$public Builder set$capitalized_name$($type$ value) {\n"
     "  if (value == null) {\n"
     "    throw new NullPointerException();\n"
@@ -451,9 +486,10 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "  $oneof_name$_ = value.getNumber();\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, set_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate clear_method = {
     "$deprecation$public Builder clear$capitalized_name$() {\n"
     "  if ($has_oneof_case_message$) {\n"
     "    $clear_oneof_case_message$;\n"
@@ -461,92 +497,107 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "    $on_changed$\n"
     "  }\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, clear_method.Get());
 }
 
 void ImmutableEnumOneofFieldGenerator::
 GenerateBuildingCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate building_code = {
     "if ($has_oneof_case_message$) {\n"
     "  result.$oneof_name$_ = $oneof_name$_;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, building_code.Get());
 }
 
 void ImmutableEnumOneofFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
   if (SupportUnknownEnumValue(descriptor_->file())) {
-    printer->Print(variables_,
-      "set$capitalized_name$Value(other.get$capitalized_name$Value());\n");
+    static io::LazyPrinterTemplate set_value_declaration = {
+      "set$capitalized_name$Value(other.get$capitalized_name$Value());\n",
+      '$' };
+    printer->Print(variables_, set_value_declaration.Get());
   } else {
-    printer->Print(variables_,
-      "set$capitalized_name$(other.get$capitalized_name$());\n");
+    static io::LazyPrinterTemplate set_declaration = {
+      "set$capitalized_name$(other.get$capitalized_name$());\n", '$' };
+    printer->Print(variables_, set_declaration.Get());
   }
 }
 
 void ImmutableEnumOneofFieldGenerator::
 GenerateParsingCode(io::Printer* printer) const {
   if (SupportUnknownEnumValue(descriptor_->file())) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate read_raw_value = {
       "int rawValue = input.readEnum();\n"
       "$set_oneof_case_message$;\n"
-      "$oneof_name$_ = rawValue;\n");
+      "$oneof_name$_ = rawValue;\n", '$' };
+    printer->Print(variables_, read_raw_value.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate read_known_value = {
       "int rawValue = input.readEnum();\n"
       "$type$ value = $type$.valueOf(rawValue);\n"
-      "if (value == null) {\n");
+      "if (value == null) {\n", '$' };
+    printer->Print(variables_, read_known_value.Get());
     if (PreserveUnknownFields(descriptor_->containing_type())) {
-      printer->Print(variables_,
-        "  unknownFields.mergeVarintField($number$, rawValue);\n");
+      static io::LazyPrinterTemplate keep_unknown_value = {
+        "  unknownFields.mergeVarintField($number$, rawValue);\n", '$' };
+      printer->Print(variables_, keep_unknown_value.Get());
     }
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate set_known_value = {
       "} else {\n"
       "  $set_oneof_case_message$;\n"
       "  $oneof_name$_ = rawValue;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, set_known_value.Get());
   }
 }
 
 void ImmutableEnumOneofFieldGenerator::
 GenerateSerializationCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialization_code = {
     "if ($has_oneof_case_message$) {\n"
     "  output.writeEnum($number$, ((java.lang.Integer) $oneof_name$_));\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialization_code.Get());
 }
 
 void ImmutableEnumOneofFieldGenerator::
 GenerateSerializedSizeCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialized_size_code = {
     "if ($has_oneof_case_message$) {\n"
     "  size += com.google.protobuf.CodedOutputStream\n"
     "    .computeEnumSize($number$, ((java.lang.Integer) $oneof_name$_));\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialized_size_code.Get());
 }
 
 void ImmutableEnumOneofFieldGenerator::
 GenerateEqualsCode(io::Printer* printer) const {
   if (SupportUnknownEnumValue(descriptor_->file())) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate equals_value = {
       "result = result && get$capitalized_name$Value()\n"
-      "    == other.get$capitalized_name$Value();\n");
+      "    == other.get$capitalized_name$Value();\n", '$' };
+    printer->Print(variables_, equals_value.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate equals_enum = {
       "result = result && get$capitalized_name$()\n"
-      "    .equals(other.get$capitalized_name$());\n");
+      "    .equals(other.get$capitalized_name$());\n", '$' };
+    printer->Print(variables_, equals_enum.Get());
   }
 }
 
 void ImmutableEnumOneofFieldGenerator::
 GenerateHashCode(io::Printer* printer) const {
   if (SupportUnknownEnumValue(descriptor_->file())) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate hash_value = {
       "hash = (37 * hash) + $constant_name$;\n"
-      "hash = (53 * hash) + get$capitalized_name$Value();\n");
+      "hash = (53 * hash) + get$capitalized_name$Value();\n", '$' };
+    printer->Print(variables_, hash_value.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate hash_enum = {
       "hash = (37 * hash) + $constant_name$;\n"
-      "hash = (53 * hash) + get$capitalized_name$().getNumber();\n");
+      "hash = (53 * hash) + get$capitalized_name$().getNumber();\n", '$' };
+    printer->Print(variables_, hash_enum.Get());
   }
 }
 
@@ -578,28 +629,33 @@ int RepeatedImmutableEnumFieldGenerator::GetNumBitsForBuilder() const {
 void RepeatedImmutableEnumFieldGenerator::
 GenerateInterfaceMembers(io::Printer* printer) const {
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
-    "$deprecation$java.util.List<$type$> get$capitalized_name$List();\n");
+  static io::LazyPrinterTemplate get_list_declaration = {
+    "$deprecation$java.util.List<$type$> get$capitalized_name$List();\n", '$' };
+  printer->Print(variables_, get_list_declaration.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
-    "$deprecation$int get$capitalized_name$Count();\n");
+  static io::LazyPrinterTemplate get_count_declaration = {
+    "$deprecation$int get$capitalized_name$Count();\n", '$' };
+  printer->Print(variables_, get_count_declaration.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
-    "$deprecation$$type$ get$capitalized_name$(int index);\n");
+  static io::LazyPrinterTemplate get_declaration = {
+    "$deprecation$$type$ get$capitalized_name$(int index);\n", '$' };
+  printer->Print(variables_, get_declaration.Get());
   if (SupportUnknownEnumValue(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_value_list_declaration = {
       "$deprecation$java.util.List<java.lang.Integer>\n"
-      "get$capitalized_name$ValueList();\n");
+      "get$capitalized_name$ValueList();\n", '$' };
+    printer->Print(variables_, get_value_list_declaration.Get());
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
-      "$deprecation$int get$capitalized_name$Value(int index);\n");
+    static io::LazyPrinterTemplate get_value_declaration = {
+      "$deprecation$int get$capitalized_name$Value(int index);\n", '$' };
+    printer->Print(variables_, get_value_declaration.Get());
   }
 }
 
 void RepeatedImmutableEnumFieldGenerator::
 GenerateMembers(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate field = {
     "private java.util.List<java.lang.Integer> $name$_;\n"
     "private static final com.google.protobuf.Internal.ListAdapter.Converter<\n"
     "    java.lang.Integer, $type$> $name$_converter_ =\n"
@@ -609,42 +665,49 @@ GenerateMembers(io::Printer* printer) const {
     "            $type$ result = $type$.valueOf(from);\n"
     "            return result == null ? $unknown$ : result;\n"
     "          }\n"
-    "        };\n");
+    "        };\n", '$' };
+  printer->Print(variables_, field.Get());
   PrintExtraFieldInfo(variables_, printer);
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_list_method = {
     "$deprecation$public java.util.List<$type$> get$capitalized_name$List() {\n"
     "  return new com.google.protobuf.Internal.ListAdapter<\n"
     "      java.lang.Integer, $type$>($name$_, $name$_converter_);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_list_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_count_method = {
     "$deprecation$public int get$capitalized_name$Count() {\n"
     "  return $name$_.size();\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_count_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method = {
     "$deprecation$public $type$ get$capitalized_name$(int index) {\n"
     "  return $name$_converter_.convert($name$_.get(index));\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
   if (SupportUnknownEnumValue(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_value_list_method = {
       "$deprecation$public java.util.List<java.lang.Integer>\n"
       "get$capitalized_name$ValueList() {\n"
       "  return $name$_;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_value_list_method.Get());
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_value_method = {
       "$deprecation$public int get$capitalized_name$Value(int index) {\n"
       "  return $name$_.get(index);\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_value_method.Get());
   }
 
   if (descriptor_->options().packed() &&
       HasGeneratedMethods(descriptor_->containing_type())) {
-    printer->Print(variables_,
-      "private int $name$MemoizedSerializedSize;\n");
+    static io::LazyPrinterTemplate memoized_size_field = {
+      "private int $name$MemoizedSerializedSize;\n", '$' };
+    printer->Print(variables_, memoized_size_field.Get());
   }
 }
 
@@ -681,17 +744,19 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "      java.lang.Integer, $type$>($name$_, $name$_converter_);\n"
     "}\n");
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_count_method = {
     "$deprecation$public int get$capitalized_name$Count() {\n"
     "  return $name$_.size();\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_count_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method = {
     "$deprecation$public $type$ get$capitalized_name$(int index) {\n"
     "  return $name$_converter_.convert($name$_.get(index));\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate set_method = {
     "$deprecation$public Builder set$capitalized_name$(\n"
     "    int index, $type$ value) {\n"
     "  if (value == null) {\n"
@@ -701,9 +766,10 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "  $name$_.set(index, value.getNumber());\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, set_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate add_method = {
     "$deprecation$public Builder add$capitalized_name$($type$ value) {\n"
     "  if (value == null) {\n"
     "    throw new NullPointerException();\n"
@@ -712,9 +778,10 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "  $name$_.add(value.getNumber());\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, add_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate add_all_method = {
     "$deprecation$public Builder addAll$capitalized_name$(\n"
     "    java.lang.Iterable<? extends $type$> values) {\n"
     "  ensure$capitalized_name$IsMutable();\n"
@@ -723,47 +790,53 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "  }\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, add_all_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate clear_method = {
     "$deprecation$public Builder clear$capitalized_name$() {\n"
     "  $name$_ = java.util.Collections.emptyList();\n"
     "  $clear_mutable_bit_builder$;\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, clear_method.Get());
 
   if (SupportUnknownEnumValue(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_value_list_method = {
       "$deprecation$public java.util.List<java.lang.Integer>\n"
       "get$capitalized_name$ValueList() {\n"
       "  return java.util.Collections.unmodifiableList($name$_);\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_value_list_method.Get());
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_value_method = {
       "$deprecation$public int get$capitalized_name$Value(int index) {\n"
       "  return $name$_.get(index);\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_value_method.Get());
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate set_value_method = {
       "$deprecation$public Builder set$capitalized_name$Value(\n"
       "    int index, int value) {\n"
       "  ensure$capitalized_name$IsMutable();\n"
       "  $name$_.set(index, value);\n"
       "  $on_changed$\n"
       "  return this;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, set_value_method.Get());
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate add_value_method = {
       "$deprecation$public Builder add$capitalized_name$Value(int value) {\n"
       "  ensure$capitalized_name$IsMutable();\n"
       "  $name$_.add(value);\n"
       "  $on_changed$\n"
       "  return this;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, add_value_method.Get());
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate add_all_value_method = {
       "$deprecation$public Builder addAll$capitalized_name$Value(\n"
       "    java.lang.Iterable<java.lang.Integer> values) {\n"
       "  ensure$capitalized_name$IsMutable();\n"
@@ -772,7 +845,8 @@ GenerateBuilderMembers(io::Printer* printer) const {
       "  }\n"
       "  $on_changed$\n"
       "  return this;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, add_all_value_method.Get());
   }
 }
 
@@ -783,14 +857,17 @@ GenerateFieldBuilderInitializationCode(io::Printer* printer)  const {
 
 void RepeatedImmutableEnumFieldGenerator::
 GenerateInitializationCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_ = java.util.Collections.emptyList();\n");
+  static io::LazyPrinterTemplate initialization_code = {
+    "$name$_ = java.util.Collections.emptyList();\n", '$' };
+  printer->Print(variables_, initialization_code.Get());
 }
 
 void RepeatedImmutableEnumFieldGenerator::
 GenerateBuilderClearCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate builder_clear_code = {
     "$name$_ = java.util.Collections.emptyList();\n"
-    "$clear_mutable_bit_builder$;\n");
+    "$clear_mutable_bit_builder$;\n", '$' };
+  printer->Print(variables_, builder_clear_code.Get());
 }
 
 void RepeatedImmutableEnumFieldGenerator::
@@ -800,7 +877,7 @@ GenerateMergingCode(io::Printer* printer) const {
   //      don't allocate a new array if we already have an immutable one.
   //   2. If the other list is non-empty and our current list is empty, we can
   //      reuse the other list which is guaranteed to be immutable.
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate merging_code = {
     "if (!other.$name$_.isEmpty()) {\n"
     "  if ($name$_.isEmpty()) {\n"
     "    $name$_ = other.$name$_;\n"
@@ -810,49 +887,55 @@ GenerateMergingCode(io::Printer* printer) const {
     "    $name$_.addAll(other.$name$_);\n"
     "  }\n"
     "  $on_changed$\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, merging_code.Get());
 }
 
 void RepeatedImmutableEnumFieldGenerator::
 GenerateBuildingCode(io::Printer* printer) const {
   // The code below ensures that the result has an immutable list. If our
   // list is immutable, we can just reuse it. If not, we make it immutable.
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate building_code = {
     "if ($get_mutable_bit_builder$) {\n"
     "  $name$_ = java.util.Collections.unmodifiableList($name$_);\n"
     "  $clear_mutable_bit_builder$;\n"
     "}\n"
-    "result.$name$_ = $name$_;\n");
+    "result.$name$_ = $name$_;\n", '$' };
+  printer->Print(variables_, building_code.Get());
 }
 
 void RepeatedImmutableEnumFieldGenerator::
 GenerateParsingCode(io::Printer* printer) const {
   // Read and store the enum
   if (SupportUnknownEnumValue(descriptor_->file())) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate read_raw_value = {
       "int rawValue = input.readEnum();\n"
       "if (!$get_mutable_bit_parser$) {\n"
       "  $name$_ = new java.util.ArrayList<java.lang.Integer>();\n"
       "  $set_mutable_bit_parser$;\n"
       "}\n"
-      "$name$_.add(rawValue);\n");
+      "$name$_.add(rawValue);\n", '$' };
+    printer->Print(variables_, read_raw_value.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate read_known_value = {
       "int rawValue = input.readEnum();\n"
       "$type$ value = $type$.valueOf(rawValue);\n"
-        "if (value == null) {\n");
+      "if (value == null) {\n", '$' };
+    printer->Print(variables_, read_known_value.Get());
     if (PreserveUnknownFields(descriptor_->containing_type())) {
-      printer->Print(variables_,
-        "  unknownFields.mergeVarintField($number$, rawValue);\n");
+      static io::LazyPrinterTemplate keep_unknown_value = {
+        "  unknownFields.mergeVarintField($number$, rawValue);\n", '$' };
+      printer->Print(variables_, keep_unknown_value.Get());
     }
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate add_known_value = {
       "} else {\n"
       "  if (!$get_mutable_bit_parser$) {\n"
       "    $name$_ = new java.util.ArrayList<java.lang.Integer>();\n"
       "    $set_mutable_bit_parser$;\n"
       "  }\n"
       "  $name$_.add(rawValue);\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, add_known_value.Get());
   }
 }
 
@@ -876,28 +959,31 @@ GenerateParsingCodeFromPacked(io::Printer* printer) const {
 
 void RepeatedImmutableEnumFieldGenerator::
 GenerateParsingDoneCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate parsing_done_code = {
     "if ($get_mutable_bit_parser$) {\n"
     "  $name$_ = java.util.Collections.unmodifiableList($name$_);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, parsing_done_code.Get());
 }
 
 void RepeatedImmutableEnumFieldGenerator::
 GenerateSerializationCode(io::Printer* printer) const {
   if (descriptor_->options().packed()) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate write_packed = {
       "if (get$capitalized_name$List().size() > 0) {\n"
       "  output.writeRawVarint32($tag$);\n"
       "  output.writeRawVarint32($name$MemoizedSerializedSize);\n"
       "}\n"
       "for (int i = 0; i < $name$_.size(); i++) {\n"
       "  output.writeEnumNoTag($name$_.get(i));\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, write_packed.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate write_unpacked = {
       "for (int i = 0; i < $name$_.size(); i++) {\n"
       "  output.writeEnum($number$, $name$_.get(i));\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, write_unpacked.Get());
   }
 }
 
@@ -908,29 +994,33 @@ GenerateSerializedSizeCode(io::Printer* printer) const {
     "  int dataSize = 0;\n");
   printer->Indent();
 
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate data_size = {
     "for (int i = 0; i < $name$_.size(); i++) {\n"
     "  dataSize += com.google.protobuf.CodedOutputStream\n"
     "    .computeEnumSizeNoTag($name$_.get(i));\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, data_size.Get());
   printer->Print(
     "size += dataSize;\n");
   if (descriptor_->options().packed()) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate packed_tag_size = {
       "if (!get$capitalized_name$List().isEmpty()) {"
       "  size += $tag_size$;\n"
       "  size += com.google.protobuf.CodedOutputStream\n"
       "    .computeRawVarint32Size(dataSize);\n"
-      "}");
+      "}", '$' };
+    printer->Print(variables_, packed_tag_size.Get());
   } else {
-    printer->Print(variables_,
-      "size += $tag_size$ * $name$_.size();\n");
+    static io::LazyPrinterTemplate unpacked_tag_size = {
+      "size += $tag_size$ * $name$_.size();\n", '$' };
+    printer->Print(variables_, unpacked_tag_size.Get());
   }
 
   // cache the data size for packed fields.
   if (descriptor_->options().packed()) {
-    printer->Print(variables_,
-      "$name$MemoizedSerializedSize = dataSize;\n");
+    static io::LazyPrinterTemplate memoize_data_size = {
+      "$name$MemoizedSerializedSize = dataSize;\n", '$' };
+    printer->Print(variables_, memoize_data_size.Get());
   }
 
   printer->Outdent();
@@ -939,17 +1029,19 @@ GenerateSerializedSizeCode(io::Printer* printer) const {
 
 void RepeatedImmutableEnumFieldGenerator::
 GenerateEqualsCode(io::Printer* printer) const {
-  printer->Print(variables_,
-    "result = result && $name$_.equals(other.$name$_);\n");
+  static io::LazyPrinterTemplate equals_code = {
+    "result = result && $name$_.equals(other.$name$_);\n", '$' };
+  printer->Print(variables_, equals_code.Get());
 }
 
 void RepeatedImmutableEnumFieldGenerator::
 GenerateHashCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate hash_code = {
     "if (get$capitalized_name$Count() > 0) {\n"
     "  hash = (37 * hash) + $constant_name$;\n"
     "  hash = (53 * hash) + $name$_.hashCode();\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, hash_code.Get());
 }
 
 string RepeatedImmutableEnumFieldGenerator::GetBoxedType() const {
@@ -57,28 +57,32 @@ ImmutableLazyMessageFieldGenerator::~ImmutableLazyMessageFieldGenerator() {}
 
 void ImmutableLazyMessageFieldGenerator::
 GenerateMembers(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate field = {
     "private com.google.protobuf.LazyFieldLite $name$_ =\n"
-    "    new com.google.protobuf.LazyFieldLite();\n");
+    "    new com.google.protobuf.LazyFieldLite();\n", '$' };
+  printer->Print(variables_, field.Get());
 
   PrintExtraFieldInfo(variables_, printer);
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate has_method = {
     "$deprecation$public boolean has$capitalized_name$() {\n"
     "  return $get_has_field_bit_message$;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, has_method.Get());
   WriteFieldDocComment(printer, descriptor_);
 
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method = {
     "$deprecation$public $type$ get$capitalized_name$() {\n"
     "  return ($type$) $name$_.getValue($type$.getDefaultInstance());\n"
-   "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
   if (HasNestedBuilders(descriptor_->containing_type())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_or_builder_method = {
       "$deprecation$public $type$OrBuilder get$capitalized_name$OrBuilder() {\n"
       "  return $name$_;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_or_builder_method.Get());
   }
 }
 
@@ -88,9 +92,10 @@ GenerateBuilderMembers(io::Printer* printer) const {
   // non-nested builder case. It only creates a nested builder lazily on
   // demand and then forever delegates to it after creation.
 
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate field = {
     "private com.google.protobuf.LazyFieldLite $name$_ =\n"
-    "    new com.google.protobuf.LazyFieldLite();\n");
+    "    new com.google.protobuf.LazyFieldLite();\n", '$' };
+  printer->Print(variables_, field.Get());
 
   if (HasNestedBuilders(descriptor_->containing_type())) {
     printer->Print(variables_,
@@ -106,15 +111,17 @@ GenerateBuilderMembers(io::Printer* printer) const {
 
   // boolean hasField()
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate has_method = {
     "$deprecation$public boolean has$capitalized_name$() {\n"
     "  return $get_has_field_bit_builder$;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, has_method.Get());
 
-    printer->Print(variables_,
-      "$deprecation$public $type$ get$capitalized_name$() {\n"
-      "  return ($type$) $name$_.getValue($type$.getDefaultInstance());\n"
-      "}\n");
+  static io::LazyPrinterTemplate get_method = {
+    "$deprecation$public $type$ get$capitalized_name$() {\n"
+    "  return ($type$) $name$_.getValue($type$.getDefaultInstance());\n"
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
 
   // Field.Builder setField(Field value)
   WriteFieldDocComment(printer, descriptor_);
@@ -181,23 +188,25 @@ GenerateBuilderMembers(io::Printer* printer) const {
 
   if (HasNestedBuilders(descriptor_->containing_type())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_builder_method = {
       "$deprecation$public $type$.Builder get$capitalized_name$Builder() {\n"
       "  $set_has_field_bit_builder$;\n"
       "  $on_changed$\n"
       "  return get$capitalized_name$FieldBuilder().getBuilder();\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_builder_method.Get());
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_or_builder_method = {
       "$deprecation$public $type$OrBuilder get$capitalized_name$OrBuilder() {\n"
       "  if ($name$Builder_ != null) {\n"
       "    return $name$Builder_.getMessageOrBuilder();\n"
       "  } else {\n"
       "    return $name$_;\n"
       "  }\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_or_builder_method.Get());
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_field_builder_method = {
       "private com.google.protobuf.SingleFieldBuilder<\n"
       "    $type$, $type$.Builder, $type$OrBuilder> \n"
       "    get$capitalized_name$FieldBuilder() {\n"
@@ -210,67 +219,81 @@ GenerateBuilderMembers(io::Printer* printer) const {
       "    $name$_ = null;\n"
       "  }\n"
       "  return $name$Builder_;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_field_builder_method.Get());
   }
 }
 
 
 void ImmutableLazyMessageFieldGenerator::
 GenerateInitializationCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.clear();\n");
+  static io::LazyPrinterTemplate initialization_code = {
+    "$name$_.clear();\n", '$' };
+  printer->Print(variables_, initialization_code.Get());
 }
 
 void ImmutableLazyMessageFieldGenerator::
 GenerateBuilderClearCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.clear();\n");
-  printer->Print(variables_, "$clear_has_field_bit_builder$;\n");
+  static io::LazyPrinterTemplate clear_value = {
+    "$name$_.clear();\n", '$' };
+  printer->Print(variables_, clear_value.Get());
+  static io::LazyPrinterTemplate clear_has_bit = {
+    "$clear_has_field_bit_builder$;\n", '$' };
+  printer->Print(variables_, clear_has_bit.Get());
 }
 
 void ImmutableLazyMessageFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate merging_code = {
     "if (other.has$capitalized_name$()) {\n"
     "  $name$_.merge(other.$name$_);\n"
     "  $set_has_field_bit_builder$;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, merging_code.Get());
 }
 
 void ImmutableLazyMessageFieldGenerator::
 GenerateBuildingCode(io::Printer* printer) const {
-  printer->Print(variables_,
-      "if ($get_has_field_bit_from_local$) {\n"
-      "  $set_has_field_bit_to_local$;\n"
-      "}\n");
-
-  printer->Print(variables_,
-      "result.$name$_.set(\n"
-      "    $name$_);\n");
+  static io::LazyPrinterTemplate copy_has_bit = {
+    "if ($get_has_field_bit_from_local$) {\n"
+    "  $set_has_field_bit_to_local$;\n"
+    "}\n", '$' };
+  printer->Print(variables_, copy_has_bit.Get());
+
+  static io::LazyPrinterTemplate copy_value = {
+    "result.$name$_.set(\n"
+    "    $name$_);\n", '$' };
+  printer->Print(variables_, copy_value.Get());
 }
 
 void ImmutableLazyMessageFieldGenerator::
 GenerateParsingCode(io::Printer* printer) const {
-  printer->Print(variables_,
-    "$name$_.setByteString(input.readBytes(), extensionRegistry);\n");
-  printer->Print(variables_,
-    "$set_has_field_bit_message$;\n");
+  static io::LazyPrinterTemplate read_bytes = {
+    "$name$_.setByteString(input.readBytes(), extensionRegistry);\n", '$' };
+  printer->Print(variables_, read_bytes.Get());
+  static io::LazyPrinterTemplate set_has_bit = {
+    "$set_has_field_bit_message$;\n", '$' };
+  printer->Print(variables_, set_has_bit.Get());
 }
 
 void ImmutableLazyMessageFieldGenerator::
 GenerateSerializationCode(io::Printer* printer) const {
   // Do not de-serialize lazy fields.
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialization_code = {
     "if ($get_has_field_bit_message$) {\n"
     "  output.writeBytes($number$, $name$_.toByteString());\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialization_code.Get());
 }
 
 void ImmutableLazyMessageFieldGenerator::
 GenerateSerializedSizeCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialized_size_code = {
     "if ($get_has_field_bit_message$) {\n"
     "  size += com.google.protobuf.CodedOutputStream\n"
     "    .computeLazyFieldSize($number$, $name$_);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialized_size_code.Get());
 }
 
 // ===================================================================
@@ -296,39 +319,43 @@ GenerateMembers(io::Printer* printer) const {
   PrintExtraFieldInfo(variables_, printer);
   WriteFieldDocComment(printer, descriptor_);
 
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate has_method = {
     "$deprecation$public boolean has$capitalized_name$() {\n"
     "  return $has_oneof_case_message$;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, has_method.Get());
   WriteFieldDocComment(printer, descriptor_);
 
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method = {
     "$deprecation$public $type$ get$capitalized_name$() {\n"
     "  if ($has_oneof_case_message$) {\n"
     "    return ($type$) (($lazy_type$) $oneof_name$_).getValue(\n"
     "        $type$.getDefaultInstance());\n"
     "  }\n"
     "  return $type$.getDefaultInstance();\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
 }
 
 void ImmutableLazyMessageOneofFieldGenerator::
 GenerateBuilderMembers(io::Printer* printer) const {
   // boolean hasField()
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate has_method = {
     "$deprecation$public boolean has$capitalized_name$() {\n"
     "  return $has_oneof_case_message$;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, has_method.Get());
 
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method = {
     "$deprecation$public $type$ get$capitalized_name$() {\n"
     "  if ($has_oneof_case_message$) {\n"
     "    return ($type$) (($lazy_type$) $oneof_name$_).getValue(\n"
     "        $type$.getDefaultInstance());\n"
     "  }\n"
     "  return $type$.getDefaultInstance();\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
 
   // Field.Builder setField(Field value)
   WriteFieldDocComment(printer, descriptor_);
@@ -407,57 +434,63 @@ GenerateBuilderMembers(io::Printer* printer) const {
 
 void ImmutableLazyMessageOneofFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate merging_code = {
     "if (!($has_oneof_case_message$)) {\n"
     "  $oneof_name$_ = new $lazy_type$();\n"
     "}\n"
     "(($lazy_type$) $oneof_name$_).merge(\n"
     "    ($lazy_type$) other.$oneof_name$_);\n"
-    "$set_oneof_case_message$;\n");
+    "$set_oneof_case_message$;\n", '$' };
+  printer->Print(variables_, merging_code.Get());
 }
 
 void ImmutableLazyMessageOneofFieldGenerator::
 GenerateBuildingCode(io::Printer* printer) const {
-  printer->Print(variables_,
-                 "if ($has_oneof_case_message$) {\n");
+  static io::LazyPrinterTemplate start_if_case = {
+    "if ($has_oneof_case_message$) {\n", '$' };
+  printer->Print(variables_, start_if_case.Get());
   printer->Indent();
 
-  printer->Print(variables_,
-      "result.$oneof_name$_ = new $lazy_type$();\n"
-      "(($lazy_type$) result.$oneof_name$_).set(\n"
-      "    (($lazy_type$) $oneof_name$_));\n");
+  static io::LazyPrinterTemplate copy_value = {
+    "result.$oneof_name$_ = new $lazy_type$();\n"
+    "(($lazy_type$) result.$oneof_name$_).set(\n"
+    "    (($lazy_type$) $oneof_name$_));\n", '$' };
+  printer->Print(variables_, copy_value.Get());
   printer->Outdent();
   printer->Print("}\n");
 }
 
 void ImmutableLazyMessageOneofFieldGenerator::
 GenerateParsingCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate parsing_code = {
     "if (!($has_oneof_case_message$)) {\n"
     "  $oneof_name$_ = new $lazy_type$();\n"
     "}\n"
     "(($lazy_type$) $oneof_name$_).setByteString(\n"
     "    input.readBytes(), extensionRegistry);\n"
-    "$set_oneof_case_message$;\n");
+    "$set_oneof_case_message$;\n", '$' };
+  printer->Print(variables_, parsing_code.Get());
 }
 
 void ImmutableLazyMessageOneofFieldGenerator::
 GenerateSerializationCode(io::Printer* printer) const {
   // Do not de-serialize lazy fields.
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialization_code = {
     "if ($has_oneof_case_message$) {\n"
     "  output.writeBytes(\n"
     "      $number$, (($lazy_type$) $oneof_name$_).toByteString());\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialization_code.Get());
 }
 
 void ImmutableLazyMessageOneofFieldGenerator::
 GenerateSerializedSizeCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialized_size_code = {
     "if ($has_oneof_case_message$) {\n"
     "  size += com.google.protobuf.CodedOutputStream\n"
     "    .computeLazyFieldSize($number$, ($lazy_type$) $oneof_name$_);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialized_size_code.Get());
 }
 
 // ===================================================================
@@ -478,11 +511,13 @@ RepeatedImmutableLazyMessageFieldGenerator::
 
 void RepeatedImmutableLazyMessageFieldGenerator::
 GenerateMembers(io::Printer* printer) const {
-  printer->Print(variables_,
-    "private java.util.List<com.google.protobuf.LazyFieldLite> $name$_;\n");
+  static io::LazyPrinterTemplate field = {
+    "private java.util.List<com.google.protobuf.LazyFieldLite> $name$_;\n",
+    '$' };
+  printer->Print(variables_, field.Get());
   PrintExtraFieldInfo(variables_, printer);
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_list_method = {
     "$deprecation$public java.util.List<$type$>\n"
     "    get$capitalized_name$List() {\n"
     "  java.util.List<$type$> list =\n"
@@ -491,31 +526,36 @@ GenerateMembers(io::Printer* printer) const {
     "    list.add(($type$) lf.getValue($type$.getDefaultInstance()));\n"
     "  }\n"
     "  return list;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_list_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_or_builder_list_method = {
     "$deprecation$public java.util.List<? extends $type$OrBuilder>\n"
     "    get$capitalized_name$OrBuilderList() {\n"
     "  return get$capitalized_name$List();\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_or_builder_list_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_count_method = {
     "$deprecation$public int get$capitalized_name$Count() {\n"
     "  return $name$_.size();\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_count_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method = {
     "$deprecation$public $type$ get$capitalized_name$(int index) {\n"
     "  return ($type$)\n"
     "      $name$_.get(index).getValue($type$.getDefaultInstance());\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_or_builder_method = {
     "$deprecation$public $type$OrBuilder get$capitalized_name$OrBuilder(\n"
     "    int index) {\n"
     "  return ($type$OrBuilder)\n"
     "      $name$_.get(index).getValue($type$.getDefaultInstance());\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_or_builder_method.Get());
 }
 
 void RepeatedImmutableLazyMessageFieldGenerator::
@@ -524,10 +564,10 @@ GenerateBuilderMembers(io::Printer* printer) const {
   // non-nested builder case. It only creates a nested builder lazily on
   // demand and then forever delegates to it after creation.
 
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate field = {
     "private java.util.List<com.google.protobuf.LazyFieldLite> $name$_ =\n"
     "  java.util.Collections.emptyList();\n"
-
+    
     "private void ensure$capitalized_name$IsMutable() {\n"
     "  if (!$get_mutable_bit_builder$) {\n"
     "    $name$_ =\n"
@@ -536,7 +576,8 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "    $set_mutable_bit_builder$;\n"
     "   }\n"
     "}\n"
-    "\n");
+    "\n", '$' };
+  printer->Print(variables_, field.Get());
 
   if (HasNestedBuilders(descriptor_->containing_type())) {
     printer->Print(variables_,
@@ -725,14 +766,15 @@ GenerateBuilderMembers(io::Printer* printer) const {
 
   if (HasNestedBuilders(descriptor_->containing_type())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_builder_method = {
       "$deprecation$public $type$.Builder get$capitalized_name$Builder(\n"
       "    int index) {\n"
       "  return get$capitalized_name$FieldBuilder().getBuilder(index);\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_builder_method.Get());
 
     WriteFieldDocComment(printer, descriptor_);
-        printer->Print(variables_,
+    static io::LazyPrinterTemplate get_or_builder_method = {
       "$deprecation$public $type$OrBuilder get$capitalized_name$OrBuilder(\n"
       "    int index) {\n"
       "  if ($name$Builder_ == null) {\n"
@@ -740,10 +782,11 @@ GenerateBuilderMembers(io::Printer* printer) const {
       "  } else {\n"
       "    return $name$Builder_.getMessageOrBuilder(index);\n"
       "  }\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_or_builder_method.Get());
 
     WriteFieldDocComment(printer, descriptor_);
-        printer->Print(variables_,
+    static io::LazyPrinterTemplate get_or_builder_list_method = {
       "$deprecation$public java.util.List<? extends $type$OrBuilder> \n"
       "     get$capitalized_name$OrBuilderList() {\n"
       "  if ($name$Builder_ != null) {\n"
@@ -751,23 +794,26 @@ GenerateBuilderMembers(io::Printer* printer) const {
       "  } else {\n"
       "    return java.util.Collections.unmodifiableList($name$_);\n"
       "  }\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_or_builder_list_method.Get());
 
     WriteFieldDocComment(printer, descriptor_);
-        printer->Print(variables_,
+    static io::LazyPrinterTemplate add_builder_method = {
       "$deprecation$public $type$.Builder add$capitalized_name$Builder() {\n"
       "  return get$capitalized_name$FieldBuilder().addBuilder(\n"
       "      $type$.getDefaultInstance());\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, add_builder_method.Get());
     WriteFieldDocComment(printer, descriptor_);
-        printer->Print(variables_,
+    static io::LazyPrinterTemplate add_builder_at_method = {
       "$deprecation$public $type$.Builder add$capitalized_name$Builder(\n"
       "    int index) {\n"
       "  return get$capitalized_name$FieldBuilder().addBuilder(\n"
       "      index, $type$.getDefaultInstance());\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, add_builder_at_method.Get());
     WriteFieldDocComment(printer, descriptor_);
-        printer->Print(variables_,
+    static io::LazyPrinterTemplate get_builder_list_method = {
       "$deprecation$public java.util.List<$type$.Builder> \n"
       "     get$capitalized_name$BuilderList() {\n"
       "  return get$capitalized_name$FieldBuilder().getBuilderList();\n"
@@ -785,37 +831,41 @@ GenerateBuilderMembers(io::Printer* printer) const {
       "    $name$_ = null;\n"
       "  }\n"
       "  return $name$Builder_;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_builder_list_method.Get());
   }
 }
 
 void RepeatedImmutableLazyMessageFieldGenerator::
 GenerateParsingCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate parsing_code = {
     "if (!$get_mutable_bit_parser$) {\n"
     "  $name$_ =\n"
     "      new java.util.ArrayList<com.google.protobuf.LazyFieldLite>();\n"
     "  $set_mutable_bit_parser$;\n"
     "}\n"
     "$name$_.add(new com.google.protobuf.LazyFieldLite(\n"
-    "    extensionRegistry, input.readBytes()));\n");
+    "    extensionRegistry, input.readBytes()));\n", '$' };
+  printer->Print(variables_, parsing_code.Get());
 }
 
 void RepeatedImmutableLazyMessageFieldGenerator::
 GenerateSerializationCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialization_code = {
     "for (int i = 0; i < $name$_.size(); i++) {\n"
     "  output.writeBytes($number$, $name$_.get(i).toByteString());\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialization_code.Get());
 }
 
 void RepeatedImmutableLazyMessageFieldGenerator::
 GenerateSerializedSizeCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialized_size_code = {
     "for (int i = 0; i < $name$_.size(); i++) {\n"
     "  size += com.google.protobuf.CodedOutputStream\n"
     "    .computeLazyFieldSize($number$, $name$_.get(i));\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialized_size_code.Get());
 }
 
 }  // namespace java
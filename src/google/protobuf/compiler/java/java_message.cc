@@ -471,8 +471,10 @@ void ImmutableMessageGenerator::Generate(io::Printer* printer) {
   }
 
   // Fields
+  const io::PrinterTemplate constant(
+      "public static final int $constant_name$ = $number$;\n", '$');
   for (int i = 0; i < descriptor_->field_count(); i++) {
-    printer->Print("public static final int $constant_name$ = $number$;\n",
+    printer->Print(constant,
       "constant_name", FieldConstantName(descriptor_->field(i)),
       "number", SimpleItoa(descriptor_->field(i)->number()));
     field_generators_.get(descriptor_->field(i)).GenerateMembers(printer);
@@ -1542,15 +1544,15 @@ GenerateEqualsAndHashCode(io::Printer* printer) {
     "classname", name_resolver_->GetImmutableClassName(descriptor_));
 
   printer->Print("boolean result = true;\n");
+  const io::PrinterTemplate equals_has(
+      "result = result && (has$name$() == other.has$name$());\n"
+      "if (has$name$()) {\n", '$');
   for (int i = 0; i < descriptor_->field_count(); i++) {
     const FieldDescriptor* field = descriptor_->field(i);
     const FieldGeneratorInfo* info = context_->GetFieldGeneratorInfo(field);
     bool check_has_bits = CheckHasBitsForEqualsAndHashCode(field);
     if (check_has_bits) {
-      printer->Print(
-        "result = result && (has$name$() == other.has$name$());\n"
-        "if (has$name$()) {\n",
-        "name", info->capitalized_name);
+      printer->Print(equals_has, "name", info->capitalized_name);
       printer->Indent();
     }
     field_generators_.get(field).GenerateEqualsCode(printer);
@@ -1604,14 +1606,13 @@ GenerateEqualsAndHashCode(io::Printer* printer) {
       "classname", name_resolver_->GetImmutableClassName(descriptor_));
   }
 
+  const io::PrinterTemplate hash_has("if (has$name$()) {\n", '$');
   for (int i = 0; i < descriptor_->field_count(); i++) {
     const FieldDescriptor* field = descriptor_->field(i);
     const FieldGeneratorInfo* info = context_->GetFieldGeneratorInfo(field);
     bool check_has_bits = CheckHasBitsForEqualsAndHashCode(field);
     if (check_has_bits) {
-      printer->Print(
-        "if (has$name$()) {\n",
-        "name", info->capitalized_name);
+      printer->Print(hash_has, "name", info->capitalized_name);
       printer->Indent();
     }
     field_generators_.get(field).GenerateHashCode(printer);
@@ -1753,14 +1754,13 @@ GenerateParsingConstructor(io::Printer* printer) {
       "}\n");
   }
 
+  const io::PrinterTemplate case_start("case $tag$: {\n", '$');
   for (int i = 0; i < descriptor_->field_count(); i++) {
     const FieldDescriptor* field = sorted_fields[i];
     uint32 tag = WireFormatLite::MakeTag(field->number(),
       WireFormat::WireTypeForFieldType(field->type()));
 
-    printer->Print(
-      "case $tag$: {\n",
-      "tag", SimpleItoa(tag));
+    printer->Print(case_start, "tag", SimpleItoa(tag));
     printer->Indent();
 
     field_generators_.get(field).GenerateParsingCode(printer);
@@ -1775,9 +1775,7 @@ GenerateParsingConstructor(io::Printer* printer) {
       // packed version of this field regardless of field->options().packed().
       uint32 packed_tag = WireFormatLite::MakeTag(field->number(),
         WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
-      printer->Print(
-        "case $tag$: {\n",
-        "tag", SimpleItoa(packed_tag));
+      printer->Print(case_start, "tag", SimpleItoa(packed_tag));
       printer->Indent();
 
       field_generators_.get(field).GenerateParsingCodeFromPacked(printer);
@@ -150,65 +150,74 @@ GenerateInterfaceMembers(io::Printer* printer) const {
   if (SupportFieldPresence(descriptor_->file()) ||
       descriptor_->containing_oneof() == NULL) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
-      "$deprecation$boolean has$capitalized_name$();\n");
+    static io::LazyPrinterTemplate has_declaration = {
+      "$deprecation$boolean has$capitalized_name$();\n", '$' };
+    printer->Print(variables_, has_declaration.Get());
   }
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
-    "$deprecation$$type$ get$capitalized_name$();\n");
+  static io::LazyPrinterTemplate get_declaration = {
+    "$deprecation$$type$ get$capitalized_name$();\n", '$' };
+  printer->Print(variables_, get_declaration.Get());
 
   if (HasNestedBuilders(descriptor_->containing_type())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
-      "$deprecation$$type$OrBuilder get$capitalized_name$OrBuilder();\n");
+    static io::LazyPrinterTemplate get_or_builder_declaration = {
+      "$deprecation$$type$OrBuilder get$capitalized_name$OrBuilder();\n", '$' };
+    printer->Print(variables_, get_or_builder_declaration.Get());
   }
 }
 
 void ImmutableMessageFieldGenerator::
 GenerateMembers(io::Printer* printer) const {
-  printer->Print(variables_,
-    "private $type$ $name$_;\n");
+  static io::LazyPrinterTemplate field = { "private $type$ $name$_;\n", '$' };
+  printer->Print(variables_, field.Get());
   PrintExtraFieldInfo(variables_, printer);
 
   if (SupportFieldPresence(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate has_method = {
       "$deprecation$public boolean has$capitalized_name$() {\n"
       "  return $get_has_field_bit_message$;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, has_method.Get());
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_method = {
       "$deprecation$public $type$ get$capitalized_name$() {\n"
       "  return $name$_ == null ? $type$.getDefaultInstance() : $name$_;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_method.Get());
 
     if (HasNestedBuilders(descriptor_->containing_type())) {
       WriteFieldDocComment(printer, descriptor_);
-      printer->Print(variables_,
+      static io::LazyPrinterTemplate get_or_builder_method = {
         "$deprecation$public $type$OrBuilder "
         "get$capitalized_name$OrBuilder() {\n"
         "  return $name$_ == null ? $type$.getDefaultInstance() : $name$_;\n"
-        "}\n");
+        "}\n", '$' };
+      printer->Print(variables_, get_or_builder_method.Get());
     }
   } else {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate has_method_no_presence = {
       "$deprecation$public boolean has$capitalized_name$() {\n"
       "  return $name$_ != null;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, has_method_no_presence.Get());
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_method_no_presence = {
       "$deprecation$public $type$ get$capitalized_name$() {\n"
       "  return $name$_ == null ? $type$.getDefaultInstance() : $name$_;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_method_no_presence.Get());
 
     if (HasNestedBuilders(descriptor_->containing_type())) {
       WriteFieldDocComment(printer, descriptor_);
-      printer->Print(variables_,
+      static io::LazyPrinterTemplate get_or_builder_method_no_presence = {
         "$deprecation$public $type$OrBuilder "
         "get$capitalized_name$OrBuilder() {\n"
         "  return get$capitalized_name$();\n"
-        "}\n");
+        "}\n", '$' };
+      printer->Print(variables_, get_or_builder_method_no_presence.Get());
     }
   }
 }
@@ -218,7 +227,9 @@ void ImmutableMessageFieldGenerator::PrintNestedBuilderCondition(
     const char* regular_case,
     const char* nested_builder_case) const {
   if (HasNestedBuilders(descriptor_->containing_type())) {
-     printer->Print(variables_, "if ($name$Builder_ == null) {\n");
+     static io::LazyPrinterTemplate print_nested_builder_condition = {
+       "if ($name$Builder_ == null) {\n", '$' };
+     printer->Print(variables_, print_nested_builder_condition.Get());
      printer->Indent();
      printer->Print(variables_, regular_case);
      printer->Outdent();
@@ -257,8 +268,9 @@ GenerateBuilderMembers(io::Printer* printer) const {
 
   bool support_field_presence = SupportFieldPresence(descriptor_->file());
 
-  printer->Print(variables_,
-    "private $type$ $name$_ = null;\n");
+  static io::LazyPrinterTemplate field = {
+    "private $type$ $name$_ = null;\n", '$' };
+  printer->Print(variables_, field.Get());
 
   if (HasNestedBuilders(descriptor_->containing_type())) {
     printer->Print(variables_,
@@ -275,15 +287,17 @@ GenerateBuilderMembers(io::Printer* printer) const {
   // boolean hasField()
   WriteFieldDocComment(printer, descriptor_);
   if (support_field_presence) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate has_method = {
       "$deprecation$public boolean has$capitalized_name$() {\n"
       "  return $get_has_field_bit_builder$;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, has_method.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate has_method_no_presence = {
       "$deprecation$public boolean has$capitalized_name$() {\n"
       "  return $name$Builder_ != null || $name$_ != null;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, has_method_no_presence.Get());
   }
 
   // Field getField()
@@ -370,14 +384,15 @@ GenerateBuilderMembers(io::Printer* printer) const {
 
   if (HasNestedBuilders(descriptor_->containing_type())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_builder_method = {
       "$deprecation$public $type$.Builder get$capitalized_name$Builder() {\n"
       "  $set_has_field_bit_builder$\n"
       "  $on_changed$\n"
       "  return get$capitalized_name$FieldBuilder().getBuilder();\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_builder_method.Get());
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_or_builder_method = {
       "$deprecation$public $type$OrBuilder get$capitalized_name$OrBuilder() {\n"
       "  if ($name$Builder_ != null) {\n"
       "    return $name$Builder_.getMessageOrBuilder();\n"
@@ -385,9 +400,10 @@ GenerateBuilderMembers(io::Printer* printer) const {
       "    return $name$_ == null ?\n"
       "        $type$.getDefaultInstance() : $name$_;\n"
       "  }\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_or_builder_method.Get());
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_field_builder_method = {
       "private com.google.protobuf.SingleFieldBuilder<\n"
       "    $type$, $type$.Builder, $type$OrBuilder> \n"
       "    get$capitalized_name$FieldBuilder() {\n"
@@ -400,15 +416,17 @@ GenerateBuilderMembers(io::Printer* printer) const {
       "    $name$_ = null;\n"
       "  }\n"
       "  return $name$Builder_;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_field_builder_method.Get());
   }
 }
 
 void ImmutableMessageFieldGenerator::
 GenerateFieldBuilderInitializationCode(io::Printer* printer)  const {
   if (SupportFieldPresence(descriptor_->file())) {
-    printer->Print(variables_,
-      "get$capitalized_name$FieldBuilder();\n");
+    static io::LazyPrinterTemplate get_field_builder_declaration = {
+      "get$capitalized_name$FieldBuilder();\n", '$' };
+    printer->Print(variables_, get_field_builder_declaration.Get());
   }
 }
 
@@ -423,7 +441,9 @@ GenerateBuilderClearCode(io::Printer* printer) const {
       "$name$_ = null;\n",
 
       "$name$Builder_.clear();\n");
-    printer->Print(variables_, "$clear_has_field_bit_builder$\n");
+    static io::LazyPrinterTemplate builder_clear_code = {
+      "$clear_has_field_bit_builder$\n", '$' };
+    printer->Print(variables_, builder_clear_code.Get());
   } else {
     PrintNestedBuilderCondition(printer,
       "$name$_ = null;\n",
@@ -435,19 +455,21 @@ GenerateBuilderClearCode(io::Printer* printer) const {
 
 void ImmutableMessageFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate merging_code = {
     "if (other.has$capitalized_name$()) {\n"
     "  merge$capitalized_name$(other.get$capitalized_name$());\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, merging_code.Get());
 }
 
 void ImmutableMessageFieldGenerator::
 GenerateBuildingCode(io::Printer* printer) const {
   if (SupportFieldPresence(descriptor_->file())) {
-    printer->Print(variables_,
-        "if ($get_has_field_bit_from_local$) {\n"
-        "  $set_has_field_bit_to_local$;\n"
-        "}\n");
+    static io::LazyPrinterTemplate building_code = {
+      "if ($get_has_field_bit_from_local$) {\n"
+      "  $set_has_field_bit_to_local$;\n"
+      "}\n", '$' };
+    printer->Print(variables_, building_code.Get());
   }
 
   PrintNestedBuilderCondition(printer,
@@ -458,27 +480,31 @@ GenerateBuildingCode(io::Printer* printer) const {
 
 void ImmutableMessageFieldGenerator::
 GenerateParsingCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate init_sub_builder = {
     "$type$.Builder subBuilder = null;\n"
     "if ($is_field_present_message$) {\n"
     "  subBuilder = $name$_.toBuilder();\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, init_sub_builder.Get());
 
   if (GetType(descriptor_) == FieldDescriptor::TYPE_GROUP) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate read_group = {
       "$name$_ = input.readGroup($number$, $type$.PARSER,\n"
-      "    extensionRegistry);\n");
+      "    extensionRegistry);\n", '$' };
+    printer->Print(variables_, read_group.Get());
   } else {
-    printer->Print(variables_,
-      "$name$_ = input.readMessage($type$.PARSER, extensionRegistry);\n");
+    static io::LazyPrinterTemplate read_message = {
+      "$name$_ = input.readMessage($type$.PARSER, extensionRegistry);\n", '$' };
+    printer->Print(variables_, read_message.Get());
   }
 
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate merge_sub_builder = {
     "if (subBuilder != null) {\n"
     "  subBuilder.mergeFrom($name$_);\n"
     "  $name$_ = subBuilder.buildPartial();\n"
     "}\n"
-    "$set_has_field_bit_message$\n");
+    "$set_has_field_bit_message$\n", '$' };
+  printer->Print(variables_, merge_sub_builder.Get());
 }
 
 void ImmutableMessageFieldGenerator::
@@ -488,33 +514,37 @@ GenerateParsingDoneCode(io::Printer* printer) const {
 
 void ImmutableMessageFieldGenerator::
 GenerateSerializationCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialization_code = {
     "if ($is_field_present_message$) {\n"
     "  output.write$group_or_message$($number$, get$capitalized_name$());\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialization_code.Get());
 }
 
 void ImmutableMessageFieldGenerator::
 GenerateSerializedSizeCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialized_size_code = {
     "if ($is_field_present_message$) {\n"
     "  size += com.google.protobuf.CodedOutputStream\n"
     "    .compute$group_or_message$Size($number$, get$capitalized_name$());\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialized_size_code.Get());
 }
 
 void ImmutableMessageFieldGenerator::
 GenerateEqualsCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate equals_code = {
     "result = result && get$capitalized_name$()\n"
-    "    .equals(other.get$capitalized_name$());\n");
+    "    .equals(other.get$capitalized_name$());\n", '$' };
+  printer->Print(variables_, equals_code.Get());
 }
 
 void ImmutableMessageFieldGenerator::
 GenerateHashCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate hash_code = {
     "hash = (37 * hash) + $constant_name$;\n"
-    "hash = (53 * hash) + get$capitalized_name$().hashCode();\n");
+    "hash = (53 * hash) + get$capitalized_name$().hashCode();\n", '$' };
+  printer->Print(variables_, hash_code.Get());
 }
 
 string ImmutableMessageFieldGenerator::GetBoxedType() const {
@@ -543,29 +573,32 @@ GenerateMembers(io::Printer* printer) const {
   PrintExtraFieldInfo(variables_, printer);
   if (SupportFieldPresence(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate has_method = {
       "$deprecation$public boolean has$capitalized_name$() {\n"
       "  return $has_oneof_case_message$;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, has_method.Get());
   }
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method = {
     "$deprecation$public $type$ get$capitalized_name$() {\n"
     "  if ($has_oneof_case_message$) {\n"
     "     return ($type$) $oneof_name$_;\n"
     "  }\n"
     "  return $type$.getDefaultInstance();\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
 
   if (HasNestedBuilders(descriptor_->containing_type())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_or_builder_method = {
       "$deprecation$public $type$OrBuilder get$capitalized_name$OrBuilder() {\n"
       "  if ($has_oneof_case_message$) {\n"
       "     return ($type$) $oneof_name$_;\n"
       "  }\n"
       "  return $type$.getDefaultInstance();\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_or_builder_method.Get());
   }
 }
 
@@ -589,10 +622,11 @@ GenerateBuilderMembers(io::Printer* printer) const {
   if (SupportFieldPresence(descriptor_->file())) {
     // boolean hasField()
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate has_method = {
       "$deprecation$public boolean has$capitalized_name$() {\n"
       "  return $has_oneof_case_message$;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, has_method.Get());
   }
 
   // Field getField()
@@ -685,12 +719,13 @@ GenerateBuilderMembers(io::Printer* printer) const {
 
   if (HasNestedBuilders(descriptor_->containing_type())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_builder_method = {
       "$deprecation$public $type$.Builder get$capitalized_name$Builder() {\n"
       "  return get$capitalized_name$FieldBuilder().getBuilder();\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_builder_method.Get());
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_or_builder_method = {
       "$deprecation$public $type$OrBuilder get$capitalized_name$OrBuilder() {\n"
       "  if (($has_oneof_case_message$) && ($name$Builder_ != null)) {\n"
       "    return $name$Builder_.getMessageOrBuilder();\n"
@@ -700,9 +735,10 @@ GenerateBuilderMembers(io::Printer* printer) const {
       "    }\n"
       "    return $type$.getDefaultInstance();\n"
       "  }\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_or_builder_method.Get());
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_field_builder_method = {
       "private com.google.protobuf.SingleFieldBuilder<\n"
       "    $type$, $type$.Builder, $type$OrBuilder> \n"
       "    get$capitalized_name$FieldBuilder() {\n"
@@ -720,15 +756,17 @@ GenerateBuilderMembers(io::Printer* printer) const {
       "  $set_oneof_case_message$;\n"
       "  $on_changed$;\n"
       "  return $name$Builder_;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_field_builder_method.Get());
   }
 }
 
 void ImmutableMessageOneofFieldGenerator::
 GenerateBuildingCode(io::Printer* printer) const {
 
-  printer->Print(variables_,
-                 "if ($has_oneof_case_message$) {\n");
+  static io::LazyPrinterTemplate building_code = {
+    "if ($has_oneof_case_message$) {\n", '$' };
+  printer->Print(variables_, building_code.Get());
   printer->Indent();
 
   PrintNestedBuilderCondition(printer,
@@ -742,51 +780,60 @@ GenerateBuildingCode(io::Printer* printer) const {
 
 void ImmutableMessageOneofFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
-  printer->Print(variables_,
-    "merge$capitalized_name$(other.get$capitalized_name$());\n");
+  static io::LazyPrinterTemplate merge_declaration = {
+    "merge$capitalized_name$(other.get$capitalized_name$());\n", '$' };
+  printer->Print(variables_, merge_declaration.Get());
 }
 
 void ImmutableMessageOneofFieldGenerator::
 GenerateParsingCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate init_sub_builder = {
     "$type$.Builder subBuilder = null;\n"
     "if ($has_oneof_case_message$) {\n"
     "  subBuilder = (($type$) $oneof_name$_).toBuilder();\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, init_sub_builder.Get());
 
   if (GetType(descriptor_) == FieldDescriptor::TYPE_GROUP) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate read_group = {
       "$oneof_name$_ = input.readGroup($number$, $type$.PARSER,\n"
-      "    extensionRegistry);\n");
+      "    extensionRegistry);\n", '$' };
+    printer->Print(variables_, read_group.Get());
   } else {
-    printer->Print(variables_,
-      "$oneof_name$_ = input.readMessage($type$.PARSER, extensionRegistry);\n");
+    static io::LazyPrinterTemplate read_message = {
+      "$oneof_name$_ = input.readMessage($type$.PARSER, extensionRegistry);\n",
+      '$' };
+    printer->Print(variables_, read_message.Get());
   }
 
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate merge_sub_builder = {
     "if (subBuilder != null) {\n"
     "  subBuilder.mergeFrom(($type$) $oneof_name$_);\n"
     "  $oneof_name$_ = subBuilder.buildPartial();\n"
-    "}\n");
-  printer->Print(variables_,
-    "$set_oneof_case_message$;\n");
+    "}\n", '$' };
+  printer->Print(variables_, merge_sub_builder.Get());
+  static io::LazyPrinterTemplate set_oneof_case = {
+    "$set_oneof_case_message$;\n", '$' };
+  printer->Print(variables_, set_oneof_case.Get());
 }
 
 void ImmutableMessageOneofFieldGenerator::
 GenerateSerializationCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialization_code = {
     "if ($has_oneof_case_message$) {\n"
     "  output.write$group_or_message$($number$, ($type$) $oneof_name$_);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialization_code.Get());
 }
 
 void ImmutableMessageOneofFieldGenerator::
 GenerateSerializedSizeCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialized_size_code = {
     "if ($has_oneof_case_message$) {\n"
     "  size += com.google.protobuf.CodedOutputStream\n"
     "    .compute$group_or_message$Size($number$, ($type$) $oneof_name$_);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialized_size_code.Get());
 }
 
 // ===================================================================
@@ -822,31 +869,37 @@ GenerateInterfaceMembers(io::Printer* printer) const {
   // message or a nested builder, so that asking for the interface doesn't
   // cause a message to ever be built.
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_list_declaration = {
     "$deprecation$java.util.List<$type$> \n"
-    "    get$capitalized_name$List();\n");
+    "    get$capitalized_name$List();\n", '$' };
+  printer->Print(variables_, get_list_declaration.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
-    "$deprecation$$type$ get$capitalized_name$(int index);\n");
+  static io::LazyPrinterTemplate get_declaration = {
+    "$deprecation$$type$ get$capitalized_name$(int index);\n", '$' };
+  printer->Print(variables_, get_declaration.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
-    "$deprecation$int get$capitalized_name$Count();\n");
+  static io::LazyPrinterTemplate get_count_declaration = {
+    "$deprecation$int get$capitalized_name$Count();\n", '$' };
+  printer->Print(variables_, get_count_declaration.Get());
   if (HasNestedBuilders(descriptor_->containing_type())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_or_builder_list_declaration = {
       "$deprecation$java.util.List<? extends $type$OrBuilder> \n"
-      "    get$capitalized_name$OrBuilderList();\n");
+      "    get$capitalized_name$OrBuilderList();\n", '$' };
+    printer->Print(variables_, get_or_builder_list_declaration.Get());
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_or_builder_declaration = {
       "$deprecation$$type$OrBuilder get$capitalized_name$OrBuilder(\n"
-      "    int index);\n");
+      "    int index);\n", '$' };
+    printer->Print(variables_, get_or_builder_declaration.Get());
   }
 }
 
 void RepeatedImmutableMessageFieldGenerator::
 GenerateMembers(io::Printer* printer) const {
-  printer->Print(variables_,
-    "private java.util.List<$type$> $name$_;\n");
+  static io::LazyPrinterTemplate field = {
+    "private java.util.List<$type$> $name$_;\n", '$' };
+  printer->Print(variables_, field.Get());
   PrintExtraFieldInfo(variables_, printer);
   WriteFieldDocComment(printer, descriptor_);
   printer->Print(variables_,
@@ -854,27 +907,31 @@ GenerateMembers(io::Printer* printer) const {
     "  return $name$_;\n"   // note:  unmodifiable list
     "}\n");
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_or_builder_list_method = {
     "$deprecation$public java.util.List<? extends $type$OrBuilder> \n"
     "    get$capitalized_name$OrBuilderList() {\n"
     "  return $name$_;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_or_builder_list_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_count_method = {
     "$deprecation$public int get$capitalized_name$Count() {\n"
     "  return $name$_.size();\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_count_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method = {
     "$deprecation$public $type$ get$capitalized_name$(int index) {\n"
     "  return $name$_.get(index);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_or_builder_method = {
     "$deprecation$public $type$OrBuilder get$capitalized_name$OrBuilder(\n"
     "    int index) {\n"
     "  return $name$_.get(index);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_or_builder_method.Get());
 
 }
 
@@ -883,7 +940,9 @@ void RepeatedImmutableMessageFieldGenerator::PrintNestedBuilderCondition(
     const char* regular_case,
     const char* nested_builder_case) const {
   if (HasNestedBuilders(descriptor_->containing_type())) {
-     printer->Print(variables_, "if ($name$Builder_ == null) {\n");
+     static io::LazyPrinterTemplate print_nested_builder_condition = {
+       "if ($name$Builder_ == null) {\n", '$' };
+     printer->Print(variables_, print_nested_builder_condition.Get());
      printer->Indent();
      printer->Print(variables_, regular_case);
      printer->Outdent();
@@ -1118,14 +1177,15 @@ GenerateBuilderMembers(io::Printer* printer) const {
 
   if (HasNestedBuilders(descriptor_->containing_type())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate get_builder_method = {
       "$deprecation$public $type$.Builder get$capitalized_name$Builder(\n"
       "    int index) {\n"
       "  return get$capitalized_name$FieldBuilder().getBuilder(index);\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_builder_method.Get());
 
     WriteFieldDocComment(printer, descriptor_);
-        printer->Print(variables_,
+    static io::LazyPrinterTemplate get_or_builder_method = {
       "$deprecation$public $type$OrBuilder get$capitalized_name$OrBuilder(\n"
       "    int index) {\n"
       "  if ($name$Builder_ == null) {\n"
@@ -1133,10 +1193,11 @@ GenerateBuilderMembers(io::Printer* printer) const {
       "  } else {\n"
       "    return $name$Builder_.getMessageOrBuilder(index);\n"
       "  }\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_or_builder_method.Get());
 
     WriteFieldDocComment(printer, descriptor_);
-        printer->Print(variables_,
+    static io::LazyPrinterTemplate get_or_builder_list_method = {
       "$deprecation$public java.util.List<? extends $type$OrBuilder> \n"
       "     get$capitalized_name$OrBuilderList() {\n"
       "  if ($name$Builder_ != null) {\n"
@@ -1144,23 +1205,26 @@ GenerateBuilderMembers(io::Printer* printer) const {
       "  } else {\n"
       "    return java.util.Collections.unmodifiableList($name$_);\n"
       "  }\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_or_builder_list_method.Get());
 
     WriteFieldDocComment(printer, descriptor_);
-        printer->Print(variables_,
+    static io::LazyPrinterTemplate add_builder_method = {
       "$deprecation$public $type$.Builder add$capitalized_name$Builder() {\n"
       "  return get$capitalized_name$FieldBuilder().addBuilder(\n"
       "      $type$.getDefaultInstance());\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, add_builder_method.Get());
     WriteFieldDocComment(printer, descriptor_);
-        printer->Print(variables_,
+    static io::LazyPrinterTemplate add_builder_at_method = {
       "$deprecation$public $type$.Builder add$capitalized_name$Builder(\n"
       "    int index) {\n"
       "  return get$capitalized_name$FieldBuilder().addBuilder(\n"
       "      index, $type$.getDefaultInstance());\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, add_builder_at_method.Get());
     WriteFieldDocComment(printer, descriptor_);
-        printer->Print(variables_,
+    static io::LazyPrinterTemplate get_builder_list_method = {
       "$deprecation$public java.util.List<$type$.Builder> \n"
       "     get$capitalized_name$BuilderList() {\n"
       "  return get$capitalized_name$FieldBuilder().getBuilderList();\n"
@@ -1178,19 +1242,23 @@ GenerateBuilderMembers(io::Printer* printer) const {
       "    $name$_ = null;\n"
       "  }\n"
       "  return $name$Builder_;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, get_builder_list_method.Get());
   }
 }
 
 void RepeatedImmutableMessageFieldGenerator::
 GenerateFieldBuilderInitializationCode(io::Printer* printer)  const {
-  printer->Print(variables_,
-    "get$capitalized_name$FieldBuilder();\n");
+  static io::LazyPrinterTemplate get_field_builder_declaration = {
+    "get$capitalized_name$FieldBuilder();\n", '$' };
+  printer->Print(variables_, get_field_builder_declaration.Get());
 }
 
 void RepeatedImmutableMessageFieldGenerator::
 GenerateInitializationCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_ = java.util.Collections.emptyList();\n");
+  static io::LazyPrinterTemplate initialization_code = {
+    "$name$_ = java.util.Collections.emptyList();\n", '$' };
+  printer->Print(variables_, initialization_code.Get());
 }
 
 void RepeatedImmutableMessageFieldGenerator::
@@ -1253,61 +1321,70 @@ GenerateBuildingCode(io::Printer* printer) const {
 
 void RepeatedImmutableMessageFieldGenerator::
 GenerateParsingCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate ensure_mutable = {
     "if (!$get_mutable_bit_parser$) {\n"
     "  $name$_ = new java.util.ArrayList<$type$>();\n"
     "  $set_mutable_bit_parser$;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, ensure_mutable.Get());
 
   if (GetType(descriptor_) == FieldDescriptor::TYPE_GROUP) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate add_group = {
       "$name$_.add(input.readGroup($number$, $type$.PARSER,\n"
-      "    extensionRegistry));\n");
+      "    extensionRegistry));\n", '$' };
+    printer->Print(variables_, add_group.Get());
   } else {
-    printer->Print(variables_,
-      "$name$_.add(input.readMessage($type$.PARSER, extensionRegistry));\n");
+    static io::LazyPrinterTemplate add_message = {
+      "$name$_.add(input.readMessage($type$.PARSER, extensionRegistry));\n",
+      '$' };
+    printer->Print(variables_, add_message.Get());
   }
 }
 
 void RepeatedImmutableMessageFieldGenerator::
 GenerateParsingDoneCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate parsing_done_code = {
     "if ($get_mutable_bit_parser$) {\n"
     "  $name$_ = java.util.Collections.unmodifiableList($name$_);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, parsing_done_code.Get());
 }
 
 void RepeatedImmutableMessageFieldGenerator::
 GenerateSerializationCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialization_code = {
     "for (int i = 0; i < $name$_.size(); i++) {\n"
     "  output.write$group_or_message$($number$, $name$_.get(i));\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialization_code.Get());
 }
 
 void RepeatedImmutableMessageFieldGenerator::
 GenerateSerializedSizeCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialized_size_code = {
     "for (int i = 0; i < $name$_.size(); i++) {\n"
     "  size += com.google.protobuf.CodedOutputStream\n"
     "    .compute$group_or_message$Size($number$, $name$_.get(i));\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialized_size_code.Get());
 }
 
 void RepeatedImmutableMessageFieldGenerator::
 GenerateEqualsCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate equals_code = {
     "result = result && get$capitalized_name$List()\n"
-    "    .equals(other.get$capitalized_name$List());\n");
+    "    .equals(other.get$capitalized_name$List());\n", '$' };
+  printer->Print(variables_, equals_code.Get());
 }
 
 void RepeatedImmutableMessageFieldGenerator::
 GenerateHashCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate hash_code = {
     "if (get$capitalized_name$Count() > 0) {\n"
     "  hash = (37 * hash) + $constant_name$;\n"
     "  hash = (53 * hash) + get$capitalized_name$List().hashCode();\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, hash_code.Get());
 }
 
 string RepeatedImmutableMessageFieldGenerator::GetBoxedType() const {
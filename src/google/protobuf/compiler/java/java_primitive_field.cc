@@ -173,81 +173,94 @@ void ImmutablePrimitiveFieldGenerator::
 GenerateInterfaceMembers(io::Printer* printer) const {
   if (SupportFieldPresence(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
-      "$deprecation$boolean has$capitalized_name$();\n");
+    static io::LazyPrinterTemplate has_declaration = {
+      "$deprecation$boolean has$capitalized_name$();\n", '$' };
+    printer->Print(variables_, has_declaration.Get());
   }
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
-    "$deprecation$$type$ get$capitalized_name$();\n");
+  static io::LazyPrinterTemplate get_declaration = {
+    "$deprecation$$type$ get$capitalized_name$();\n", '$' };
+  printer->Print(variables_, get_declaration.Get());
 }
 
 void ImmutablePrimitiveFieldGenerator::
 GenerateMembers(io::Printer* printer) const {
-  printer->Print(variables_,
-    "private $field_type$ $name$_;\n");
+  static io::LazyPrinterTemplate field = {
+    "private $field_type$ $name$_;\n", '$' };
+  printer->Print(variables_, field.Get());
   PrintExtraFieldInfo(variables_, printer);
   if (SupportFieldPresence(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate has_method = {
       "$deprecation$public boolean has$capitalized_name$() {\n"
       "  return $get_has_field_bit_message$;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, has_method.Get());
   }
 
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method = {
     "$deprecation$public $type$ get$capitalized_name$() {\n"
     "  return $name$_;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
 }
 
 void ImmutablePrimitiveFieldGenerator::
 GenerateBuilderMembers(io::Printer* printer) const {
-  printer->Print(variables_,
-    "private $field_type$ $name$_ $default_init$;\n");
+  static io::LazyPrinterTemplate field = {
+    "private $field_type$ $name$_ $default_init$;\n", '$' };
+  printer->Print(variables_, field.Get());
 
   if (SupportFieldPresence(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate has_method = {
       "$deprecation$public boolean has$capitalized_name$() {\n"
       "  return $get_has_field_bit_builder$;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, has_method.Get());
   }
 
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method = {
     "$deprecation$public $type$ get$capitalized_name$() {\n"
     "  return $name$_;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
 
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate set_method = {
     "$deprecation$public Builder set$capitalized_name$($type$ value) {\n"
     "$null_check$"
     "  $set_has_field_bit_builder$\n"
     "  $name$_ = value;\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, set_method.Get());
 
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate clear_method_start = {
     "$deprecation$public Builder clear$capitalized_name$() {\n"
-    "  $clear_has_field_bit_builder$\n");
+    "  $clear_has_field_bit_builder$\n", '$' };
+  printer->Print(variables_, clear_method_start.Get());
   JavaType type = GetJavaType(descriptor_);
   if (type == JAVATYPE_STRING || type == JAVATYPE_BYTES) {
     // The default value is not a simple literal so we want to avoid executing
     // it multiple times.  Instead, get the default out of the default instance.
-    printer->Print(variables_,
-      "  $name$_ = getDefaultInstance().get$capitalized_name$();\n");
+    static io::LazyPrinterTemplate clear_to_default_instance = {
+      "  $name$_ = getDefaultInstance().get$capitalized_name$();\n", '$' };
+    printer->Print(variables_, clear_to_default_instance.Get());
   } else {
-    printer->Print(variables_,
-      "  $name$_ = $default$;\n");
+    static io::LazyPrinterTemplate clear_to_default = {
+      "  $name$_ = $default$;\n", '$' };
+    printer->Print(variables_, clear_to_default.Get());
   }
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate clear_method_end = {
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, clear_method_end.Get());
 }
 
 void ImmutablePrimitiveFieldGenerator::
@@ -257,48 +270,56 @@ GenerateFieldBuilderInitializationCode(io::Printer* printer)  const {
 
 void ImmutablePrimitiveFieldGenerator::
 GenerateInitializationCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_ = $default$;\n");
+  static io::LazyPrinterTemplate initialization_code = {
+    "$name$_ = $default$;\n", '$' };
+  printer->Print(variables_, initialization_code.Get());
 }
 
 void ImmutablePrimitiveFieldGenerator::
 GenerateBuilderClearCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate builder_clear_code = {
     "$name$_ = $default$;\n"
-    "$clear_has_field_bit_builder$\n");
+    "$clear_has_field_bit_builder$\n", '$' };
+  printer->Print(variables_, builder_clear_code.Get());
 }
 
 void ImmutablePrimitiveFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
   if (SupportFieldPresence(descriptor_->file())) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate merge_if_has = {
       "if (other.has$capitalized_name$()) {\n"
       "  set$capitalized_name$(other.get$capitalized_name$());\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, merge_if_has.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate merge_if_not_default = {
       "if (other.get$capitalized_name$() != $default$) {\n"
       "  set$capitalized_name$(other.get$capitalized_name$());\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, merge_if_not_default.Get());
   }
 }
 
 void ImmutablePrimitiveFieldGenerator::
 GenerateBuildingCode(io::Printer* printer) const {
   if (SupportFieldPresence(descriptor_->file())) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate copy_has_bit = {
       "if ($get_has_field_bit_from_local$) {\n"
       "  $set_has_field_bit_to_local$;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, copy_has_bit.Get());
   }
-  printer->Print(variables_,
-    "result.$name$_ = $name$_;\n");
+  static io::LazyPrinterTemplate copy_value = {
+    "result.$name$_ = $name$_;\n", '$' };
+  printer->Print(variables_, copy_value.Get());
 }
 
 void ImmutablePrimitiveFieldGenerator::
 GenerateParsingCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate parsing_code = {
     "$set_has_field_bit_message$\n"
-    "$name$_ = input.read$capitalized_type$();\n");
+    "$name$_ = input.read$capitalized_type$();\n", '$' };
+  printer->Print(variables_, parsing_code.Get());
 }
 
 void ImmutablePrimitiveFieldGenerator::
@@ -308,19 +329,21 @@ GenerateParsingDoneCode(io::Printer* printer) const {
 
 void ImmutablePrimitiveFieldGenerator::
 GenerateSerializationCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialization_code = {
     "if ($is_field_present_message$) {\n"
     "  output.write$capitalized_type$($number$, $name$_);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialization_code.Get());
 }
 
 void ImmutablePrimitiveFieldGenerator::
 GenerateSerializedSizeCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialized_size_code = {
     "if ($is_field_present_message$) {\n"
     "  size += com.google.protobuf.CodedOutputStream\n"
     "    .compute$capitalized_type$Size($number$, $name$_);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialized_size_code.Get());
 }
 
 void ImmutablePrimitiveFieldGenerator::
@@ -328,34 +351,42 @@ GenerateEqualsCode(io::Printer* printer) const {
   switch (GetJavaType(descriptor_)) {
     case JAVATYPE_INT:
     case JAVATYPE_LONG:
-    case JAVATYPE_BOOLEAN:
-      printer->Print(variables_,
+    case JAVATYPE_BOOLEAN: {
+      static io::LazyPrinterTemplate equals_integral = {
         "result = result && (get$capitalized_name$()\n"
-        "    == other.get$capitalized_name$());\n");
+        "    == other.get$capitalized_name$());\n", '$' };
+      printer->Print(variables_, equals_integral.Get());
       break;
+    }
 
-    case JAVATYPE_FLOAT:
-      printer->Print(variables_,
+    case JAVATYPE_FLOAT: {
+      static io::LazyPrinterTemplate equals_float = {
         "result = result && (\n"
         "    java.lang.Float.floatToIntBits(get$capitalized_name$())\n"
         "    == java.lang.Float.floatToIntBits(\n"
-        "        other.get$capitalized_name$()));\n");
+        "        other.get$capitalized_name$()));\n", '$' };
+      printer->Print(variables_, equals_float.Get());
       break;
+    }
 
-    case JAVATYPE_DOUBLE:
-      printer->Print(variables_,
+    case JAVATYPE_DOUBLE: {
+      static io::LazyPrinterTemplate equals_double = {
         "result = result && (\n"
         "    java.lang.Double.doubleToLongBits(get$capitalized_name$())\n"
         "    == java.lang.Double.doubleToLongBits(\n"
-        "        other.get$capitalized_name$()));\n");
+        "        other.get$capitalized_name$()));\n", '$' };
+      printer->Print(variables_, equals_double.Get());
       break;
+    }
 
     case JAVATYPE_STRING:
-    case JAVATYPE_BYTES:
-      printer->Print(variables_,
+    case JAVATYPE_BYTES: {
+      static io::LazyPrinterTemplate equals_object = {
         "result = result && get$capitalized_name$()\n"
-        "    .equals(other.get$capitalized_name$());\n");
+        "    .equals(other.get$capitalized_name$());\n", '$' };
+      printer->Print(variables_, equals_object.Get());
       break;
+    }
 
     case JAVATYPE_ENUM:
     case JAVATYPE_MESSAGE:
@@ -367,43 +398,57 @@ GenerateEqualsCode(io::Printer* printer) const {
 
 void ImmutablePrimitiveFieldGenerator::
 GenerateHashCode(io::Printer* printer) const {
-  printer->Print(variables_,
-    "hash = (37 * hash) + $constant_name$;\n");
+  static io::LazyPrinterTemplate hash_field_number = {
+    "hash = (37 * hash) + $constant_name$;\n", '$' };
+  printer->Print(variables_, hash_field_number.Get());
   switch (GetJavaType(descriptor_)) {
-    case JAVATYPE_INT:
-      printer->Print(variables_,
-        "hash = (53 * hash) + get$capitalized_name$();\n");
+    case JAVATYPE_INT: {
+      static io::LazyPrinterTemplate hash_int = {
+        "hash = (53 * hash) + get$capitalized_name$();\n", '$' };
+      printer->Print(variables_, hash_int.Get());
       break;
+    }
 
-    case JAVATYPE_LONG:
-      printer->Print(variables_,
+    case JAVATYPE_LONG: {
+      static io::LazyPrinterTemplate hash_long = {
         "hash = (53 * hash) + com.google.protobuf.Internal.hashLong(\n"
-        "    get$capitalized_name$());\n");
+        "    get$capitalized_name$());\n", '$' };
+      printer->Print(variables_, hash_long.Get());
       break;
+    }
 
-    case JAVATYPE_BOOLEAN:
-      printer->Print(variables_,
+    case JAVATYPE_BOOLEAN: {
+      static io::LazyPrinterTemplate hash_boolean = {
         "hash = (53 * hash) + com.google.protobuf.Internal.hashBoolean(\n"
-        "    get$capitalized_name$());\n");
+        "    get$capitalized_name$());\n", '$' };
+      printer->Print(variables_, hash_boolean.Get());
       break;
+    }
 
-    case JAVATYPE_FLOAT:
-      printer->Print(variables_,
+    case JAVATYPE_FLOAT: {
+      static io::LazyPrinterTemplate hash_float = {
         "hash = (53 * hash) + java.lang.Float.floatToIntBits(\n"
-        "    get$capitalized_name$());\n");
+        "    get$capitalized_name$());\n", '$' };
+      printer->Print(variables_, hash_float.Get());
       break;
+    }
 
-    case JAVATYPE_DOUBLE:
-      printer->Print(variables_,
+    case JAVATYPE_DOUBLE: {
+      static io::LazyPrinterTemplate hash_double = {
         "hash = (53 * hash) + com.google.protobuf.Internal.hashLong(\n"
-        "    java.lang.Double.doubleToLongBits(get$capitalized_name$()));\n");
+        "    java.lang.Double.doubleToLongBits(get$capitalized_name$()));\n",
+        '$' };
+      printer->Print(variables_, hash_double.Get());
       break;
+    }
 
     case JAVATYPE_STRING:
-    case JAVATYPE_BYTES:
-      printer->Print(variables_,
-        "hash = (53 * hash) + get$capitalized_name$().hashCode();\n");
+    case JAVATYPE_BYTES: {
+      static io::LazyPrinterTemplate hash_object = {
+        "hash = (53 * hash) + get$capitalized_name$().hashCode();\n", '$' };
+      printer->Print(variables_, hash_object.Get());
       break;
+    }
 
     case JAVATYPE_ENUM:
     case JAVATYPE_MESSAGE:
@@ -439,20 +484,22 @@ GenerateMembers(io::Printer* printer) const {
   PrintExtraFieldInfo(variables_, printer);
   if (SupportFieldPresence(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate has_method = {
       "$deprecation$public boolean has$capitalized_name$() {\n"
       "  return $has_oneof_case_message$;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, has_method.Get());
   }
 
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method = {
     "$deprecation$public $type$ get$capitalized_name$() {\n"
     "  if ($has_oneof_case_message$) {\n"
     "    return ($boxed_type$) $oneof_name$_;\n"
     "  }\n"
     "  return $default$;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
 }
 
 
@@ -460,33 +507,36 @@ void ImmutablePrimitiveOneofFieldGenerator::
 GenerateBuilderMembers(io::Printer* printer) const {
   if (SupportFieldPresence(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate has_method = {
       "$deprecation$public boolean has$capitalized_name$() {\n"
       "  return $has_oneof_case_message$;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, has_method.Get());
   }
 
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method = {
     "$deprecation$public $type$ get$capitalized_name$() {\n"
     "  if ($has_oneof_case_message$) {\n"
     "    return ($boxed_type$) $oneof_name$_;\n"
     "  }\n"
     "  return $default$;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
 
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate set_method = {
     "$deprecation$public Builder set$capitalized_name$($type$ value) {\n"
     "$null_check$"
     "  $set_oneof_case_message$;\n"
     "  $oneof_name$_ = value;\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, set_method.Get());
 
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate clear_method = {
     "$deprecation$public Builder clear$capitalized_name$() {\n"
     "  if ($has_oneof_case_message$) {\n"
     "    $clear_oneof_case_message$;\n"
@@ -494,47 +544,53 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "    $on_changed$\n"
     "  }\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, clear_method.Get());
 }
 
 void ImmutablePrimitiveOneofFieldGenerator::
 GenerateBuildingCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate building_code = {
     "if ($has_oneof_case_message$) {\n"
     "  result.$oneof_name$_ = $oneof_name$_;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, building_code.Get());
 }
 
 void ImmutablePrimitiveOneofFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
-  printer->Print(variables_,
-    "set$capitalized_name$(other.get$capitalized_name$());\n");
+  static io::LazyPrinterTemplate set_declaration = {
+    "set$capitalized_name$(other.get$capitalized_name$());\n", '$' };
+  printer->Print(variables_, set_declaration.Get());
 }
 
 void ImmutablePrimitiveOneofFieldGenerator::
 GenerateParsingCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate parsing_code = {
     "$set_oneof_case_message$;\n"
-    "$oneof_name$_ = input.read$capitalized_type$();\n");
+    "$oneof_name$_ = input.read$capitalized_type$();\n", '$' };
+  printer->Print(variables_, parsing_code.Get());
 }
 
 void ImmutablePrimitiveOneofFieldGenerator::
 GenerateSerializationCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialization_code = {
     "if ($has_oneof_case_message$) {\n"
     "  output.write$capitalized_type$(\n"
     "      $number$, ($type$)(($boxed_type$) $oneof_name$_));\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialization_code.Get());
 }
 
 void ImmutablePrimitiveOneofFieldGenerator::
 GenerateSerializedSizeCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialized_size_code = {
     "if ($has_oneof_case_message$) {\n"
     "  size += com.google.protobuf.CodedOutputStream\n"
     "    .compute$capitalized_type$Size(\n"
     "        $number$, ($type$)(($boxed_type$) $oneof_name$_));\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialized_size_code.Get());
 }
 
 // ===================================================================
@@ -566,21 +622,26 @@ int RepeatedImmutablePrimitiveFieldGenerator::GetNumBitsForBuilder() const {
 void RepeatedImmutablePrimitiveFieldGenerator::
 GenerateInterfaceMembers(io::Printer* printer) const {
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
-    "$deprecation$java.util.List<$boxed_type$> get$capitalized_name$List();\n");
+  static io::LazyPrinterTemplate get_list_declaration = {
+    "$deprecation$java.util.List<$boxed_type$> get$capitalized_name$List();\n",
+    '$' };
+  printer->Print(variables_, get_list_declaration.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
-    "$deprecation$int get$capitalized_name$Count();\n");
+  static io::LazyPrinterTemplate get_count_declaration = {
+    "$deprecation$int get$capitalized_name$Count();\n", '$' };
+  printer->Print(variables_, get_count_declaration.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
-    "$deprecation$$type$ get$capitalized_name$(int index);\n");
+  static io::LazyPrinterTemplate get_declaration = {
+    "$deprecation$$type$ get$capitalized_name$(int index);\n", '$' };
+  printer->Print(variables_, get_declaration.Get());
 }
 
 
 void RepeatedImmutablePrimitiveFieldGenerator::
 GenerateMembers(io::Printer* printer) const {
-  printer->Print(variables_,
-    "private $field_list_type$ $name$_;\n");
+  static io::LazyPrinterTemplate field = {
+    "private $field_list_type$ $name$_;\n", '$' };
+  printer->Print(variables_, field.Get());
   PrintExtraFieldInfo(variables_, printer);
   WriteFieldDocComment(printer, descriptor_);
   printer->Print(variables_,
@@ -589,20 +650,23 @@ GenerateMembers(io::Printer* printer) const {
     "  return $name$_;\n"   // note:  unmodifiable list
     "}\n");
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_count_method = {
     "$deprecation$public int get$capitalized_name$Count() {\n"
     "  return $name$_.size();\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_count_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method = {
     "$deprecation$public $type$ get$capitalized_name$(int index) {\n"
     "  return $name$_.get(index);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
 
   if (descriptor_->options().packed() &&
       HasGeneratedMethods(descriptor_->containing_type())) {
-    printer->Print(variables_,
-      "private int $name$MemoizedSerializedSize = -1;\n");
+    static io::LazyPrinterTemplate memoized_size_field = {
+      "private int $name$MemoizedSerializedSize = -1;\n", '$' };
+    printer->Print(variables_, memoized_size_field.Get());
   }
 }
 
@@ -617,39 +681,44 @@ GenerateBuilderMembers(io::Printer* printer) const {
   // memory allocations. Note, immutable is a strong guarantee here -- not
   // just that the list cannot be modified via the reference but that the
   // list can never be modified.
-  printer->Print(variables_,
-    "private $field_list_type$ $name$_ = $empty_list$;\n");
+  static io::LazyPrinterTemplate field = {
+    "private $field_list_type$ $name$_ = $empty_list$;\n", '$' };
+  printer->Print(variables_, field.Get());
 
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate ensure_is_mutable_method = {
     "private void ensure$capitalized_name$IsMutable() {\n"
     "  if (!$get_mutable_bit_builder$) {\n"
     "    $name$_ = new java.util.ArrayList<$boxed_type$>($name$_);\n"
     "    $set_mutable_bit_builder$;\n"
     "   }\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, ensure_is_mutable_method.Get());
 
     // Note:  We return an unmodifiable list because otherwise the caller
     //   could hold on to the returned list and modify it after the message
     //   has been built, thus mutating the message which is supposed to be
     //   immutable.
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_list_method = {
     "$deprecation$public java.util.List<$boxed_type$>\n"
     "    get$capitalized_name$List() {\n"
     "  return java.util.Collections.unmodifiableList($name$_);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_list_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_count_method = {
     "$deprecation$public int get$capitalized_name$Count() {\n"
     "  return $name$_.size();\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_count_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method = {
     "$deprecation$public $type$ get$capitalized_name$(int index) {\n"
     "  return $name$_.get(index);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate set_method = {
     "$deprecation$public Builder set$capitalized_name$(\n"
     "    int index, $type$ value) {\n"
     "$null_check$"
@@ -657,18 +726,20 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "  $name$_.set(index, value);\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, set_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate add_method = {
     "$deprecation$public Builder add$capitalized_name$($type$ value) {\n"
     "$null_check$"
     "  ensure$capitalized_name$IsMutable();\n"
     "  $name$_.add(value);\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, add_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate add_all_method = {
     "$deprecation$public Builder addAll$capitalized_name$(\n"
     "    java.lang.Iterable<? extends $boxed_type$> values) {\n"
     "  ensure$capitalized_name$IsMutable();\n"
@@ -676,15 +747,17 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "      values, $name$_);\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, add_all_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate clear_method = {
     "$deprecation$public Builder clear$capitalized_name$() {\n"
     "  $name$_ = $empty_list$;\n"
     "  $clear_mutable_bit_builder$;\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, clear_method.Get());
 }
 
 void RepeatedImmutablePrimitiveFieldGenerator::
@@ -694,14 +767,17 @@ GenerateFieldBuilderInitializationCode(io::Printer* printer)  const {
 
 void RepeatedImmutablePrimitiveFieldGenerator::
 GenerateInitializationCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_ = $empty_list$;\n");
+  static io::LazyPrinterTemplate initialization_code = {
+    "$name$_ = $empty_list$;\n", '$' };
+  printer->Print(variables_, initialization_code.Get());
 }
 
 void RepeatedImmutablePrimitiveFieldGenerator::
 GenerateBuilderClearCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate builder_clear_code = {
     "$name$_ = $empty_list$;\n"
-    "$clear_mutable_bit_builder$;\n");
+    "$clear_mutable_bit_builder$;\n", '$' };
+  printer->Print(variables_, builder_clear_code.Get());
 }
 
 void RepeatedImmutablePrimitiveFieldGenerator::
@@ -711,7 +787,7 @@ GenerateMergingCode(io::Printer* printer) const {
   //      don't allocate a new array if we already have an immutable one.
   //   2. If the other list is non-empty and our current list is empty, we can
   //      reuse the other list which is guaranteed to be immutable.
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate merging_code = {
     "if (!other.$name$_.isEmpty()) {\n"
     "  if ($name$_.isEmpty()) {\n"
     "    $name$_ = other.$name$_;\n"
@@ -721,34 +797,37 @@ GenerateMergingCode(io::Printer* printer) const {
     "    $name$_.addAll(other.$name$_);\n"
     "  }\n"
     "  $on_changed$\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, merging_code.Get());
 }
 
 void RepeatedImmutablePrimitiveFieldGenerator::
 GenerateBuildingCode(io::Printer* printer) const {
   // The code below ensures that the result has an immutable list. If our
   // list is immutable, we can just reuse it. If not, we make it immutable.
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate building_code = {
     "if ($get_mutable_bit_builder$) {\n"
     "  $name$_ = java.util.Collections.unmodifiableList($name$_);\n"
     "  $clear_mutable_bit_builder$;\n"
     "}\n"
-    "result.$name$_ = $name$_;\n");
+    "result.$name$_ = $name$_;\n", '$' };
+  printer->Print(variables_, building_code.Get());
 }
 
 void RepeatedImmutablePrimitiveFieldGenerator::
 GenerateParsingCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate parsing_code = {
     "if (!$get_mutable_bit_parser$) {\n"
     "  $name$_ = new java.util.ArrayList<$boxed_type$>();\n"
     "  $set_mutable_bit_parser$;\n"
     "}\n"
-    "$name$_.add(input.read$capitalized_type$());\n");
+    "$name$_.add(input.read$capitalized_type$());\n", '$' };
+  printer->Print(variables_, parsing_code.Get());
 }
 
 void RepeatedImmutablePrimitiveFieldGenerator::
 GenerateParsingCodeFromPacked(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate parsing_code_from_packed = {
     "int length = input.readRawVarint32();\n"
     "int limit = input.pushLimit(length);\n"
     "if (!$get_mutable_bit_parser$ && input.getBytesUntilLimit() > 0) {\n"
@@ -758,15 +837,17 @@ GenerateParsingCodeFromPacked(io::Printer* printer) const {
     "while (input.getBytesUntilLimit() > 0) {\n"
     "  $name$_.add(input.read$capitalized_type$());\n"
     "}\n"
-    "input.popLimit(limit);\n");
+    "input.popLimit(limit);\n", '$' };
+  printer->Print(variables_, parsing_code_from_packed.Get());
 }
 
 void RepeatedImmutablePrimitiveFieldGenerator::
 GenerateParsingDoneCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate parsing_done_code = {
     "if ($get_mutable_bit_parser$) {\n"
     "  $name$_ = java.util.Collections.unmodifiableList($name$_);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, parsing_done_code.Get());
 }
 
 void RepeatedImmutablePrimitiveFieldGenerator::
@@ -775,19 +856,21 @@ GenerateSerializationCode(io::Printer* printer) const {
     // We invoke getSerializedSize in writeTo for messages that have packed
     // fields in ImmutableMessageGenerator::GenerateMessageSerializationMethods.
     // That makes it safe to rely on the memoized size here.
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate write_packed = {
       "if (get$capitalized_name$List().size() > 0) {\n"
       "  output.writeRawVarint32($tag$);\n"
       "  output.writeRawVarint32($name$MemoizedSerializedSize);\n"
       "}\n"
       "for (int i = 0; i < $name$_.size(); i++) {\n"
       "  output.write$capitalized_type$NoTag($name$_.get(i));\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, write_packed.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate write_unpacked = {
       "for (int i = 0; i < $name$_.size(); i++) {\n"
       "  output.write$capitalized_type$($number$, $name$_.get(i));\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, write_unpacked.Get());
   }
 }
 
@@ -799,35 +882,40 @@ GenerateSerializedSizeCode(io::Printer* printer) const {
   printer->Indent();
 
   if (FixedSize(GetType(descriptor_)) == -1) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate varint_data_size = {
       "for (int i = 0; i < $name$_.size(); i++) {\n"
       "  dataSize += com.google.protobuf.CodedOutputStream\n"
       "    .compute$capitalized_type$SizeNoTag($name$_.get(i));\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, varint_data_size.Get());
   } else {
-    printer->Print(variables_,
-      "dataSize = $fixed_size$ * get$capitalized_name$List().size();\n");
+    static io::LazyPrinterTemplate fixed_data_size = {
+      "dataSize = $fixed_size$ * get$capitalized_name$List().size();\n", '$' };
+    printer->Print(variables_, fixed_data_size.Get());
   }
 
   printer->Print(
       "size += dataSize;\n");
 
   if (descriptor_->options().packed()) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate packed_tag_size = {
       "if (!get$capitalized_name$List().isEmpty()) {\n"
       "  size += $tag_size$;\n"
       "  size += com.google.protobuf.CodedOutputStream\n"
       "      .computeInt32SizeNoTag(dataSize);\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, packed_tag_size.Get());
   } else {
-    printer->Print(variables_,
-      "size += $tag_size$ * get$capitalized_name$List().size();\n");
+    static io::LazyPrinterTemplate unpacked_tag_size = {
+      "size += $tag_size$ * get$capitalized_name$List().size();\n", '$' };
+    printer->Print(variables_, unpacked_tag_size.Get());
   }
 
   // cache the data size for packed fields.
   if (descriptor_->options().packed()) {
-    printer->Print(variables_,
-      "$name$MemoizedSerializedSize = dataSize;\n");
+    static io::LazyPrinterTemplate memoize_data_size = {
+      "$name$MemoizedSerializedSize = dataSize;\n", '$' };
+    printer->Print(variables_, memoize_data_size.Get());
   }
 
   printer->Outdent();
@@ -836,18 +924,20 @@ GenerateSerializedSizeCode(io::Printer* printer) const {
 
 void RepeatedImmutablePrimitiveFieldGenerator::
 GenerateEqualsCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate equals_code = {
     "result = result && get$capitalized_name$List()\n"
-    "    .equals(other.get$capitalized_name$List());\n");
+    "    .equals(other.get$capitalized_name$List());\n", '$' };
+  printer->Print(variables_, equals_code.Get());
 }
 
 void RepeatedImmutablePrimitiveFieldGenerator::
 GenerateHashCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate hash_code = {
     "if (get$capitalized_name$Count() > 0) {\n"
     "  hash = (37 * hash) + $constant_name$;\n"
     "  hash = (53 * hash) + get$capitalized_name$List().hashCode();\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, hash_code.Get());
 }
 
 string RepeatedImmutablePrimitiveFieldGenerator::GetBoxedType() const {
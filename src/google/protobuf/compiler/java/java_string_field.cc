@@ -193,34 +193,39 @@ void ImmutableStringFieldGenerator::
 GenerateInterfaceMembers(io::Printer* printer) const {
   if (SupportFieldPresence(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
-      "$deprecation$boolean has$capitalized_name$();\n");
+    static io::LazyPrinterTemplate has_declaration = {
+      "$deprecation$boolean has$capitalized_name$();\n", '$' };
+    printer->Print(variables_, has_declaration.Get());
   }
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
-    "$deprecation$java.lang.String get$capitalized_name$();\n");
+  static io::LazyPrinterTemplate get_declaration = {
+    "$deprecation$java.lang.String get$capitalized_name$();\n", '$' };
+  printer->Print(variables_, get_declaration.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_bytes_declaration = {
     "$deprecation$com.google.protobuf.ByteString\n"
-    "    get$capitalized_name$Bytes();\n");
+    "    get$capitalized_name$Bytes();\n", '$' };
+  printer->Print(variables_, get_bytes_declaration.Get());
 }
 
 void ImmutableStringFieldGenerator::
 GenerateMembers(io::Printer* printer) const {
-  printer->Print(variables_,
-    "private java.lang.Object $name$_;\n");
+  static io::LazyPrinterTemplate field = {
+    "private java.lang.Object $name$_;\n", '$' };
+  printer->Print(variables_, field.Get());
   PrintExtraFieldInfo(variables_, printer);
 
   if (SupportFieldPresence(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate has_method = {
       "$deprecation$public boolean has$capitalized_name$() {\n"
       "  return $get_has_field_bit_message$;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, has_method.Get());
   }
 
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method_start = {
     "$deprecation$public java.lang.String get$capitalized_name$() {\n"
     "  java.lang.Object ref = $name$_;\n"
     "  if (ref instanceof java.lang.String) {\n"
@@ -228,22 +233,24 @@ GenerateMembers(io::Printer* printer) const {
     "  } else {\n"
     "    com.google.protobuf.ByteString bs = \n"
     "        (com.google.protobuf.ByteString) ref;\n"
-      "    java.lang.String s = bs.toStringUtf8();\n");
+    "    java.lang.String s = bs.toStringUtf8();\n", '$' };
+  printer->Print(variables_, get_method_start.Get());
   if (CheckUtf8(descriptor_)) {
-    printer->Print(variables_,
-      "    $name$_ = s;\n");
+    static io::LazyPrinterTemplate cache_string = { "    $name$_ = s;\n", '$' };
+    printer->Print(variables_, cache_string.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate cache_valid_string = {
       "    if (bs.isValidUtf8()) {\n"
       "      $name$_ = s;\n"
-      "    }\n");
+      "    }\n", '$' };
+    printer->Print(variables_, cache_valid_string.Get());
   }
   printer->Print(variables_,
     "    return s;\n"
     "  }\n"
     "}\n");
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_bytes_method = {
     "$deprecation$public com.google.protobuf.ByteString\n"
     "    get$capitalized_name$Bytes() {\n"
     "  java.lang.Object ref = $name$_;\n"
@@ -256,37 +263,43 @@ GenerateMembers(io::Printer* printer) const {
     "  } else {\n"
     "    return (com.google.protobuf.ByteString) ref;\n"
     "  }\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_bytes_method.Get());
 }
 
 void ImmutableStringFieldGenerator::
 GenerateBuilderMembers(io::Printer* printer) const {
-  printer->Print(variables_,
-    "private java.lang.Object $name$_ $default_init$;\n");
+  static io::LazyPrinterTemplate field = {
+    "private java.lang.Object $name$_ $default_init$;\n", '$' };
+  printer->Print(variables_, field.Get());
   if (SupportFieldPresence(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate has_method = {
       "$deprecation$public boolean has$capitalized_name$() {\n"
       "  return $get_has_field_bit_builder$;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, has_method.Get());
   }
 
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method_start = {
     "$deprecation$public java.lang.String get$capitalized_name$() {\n"
     "  java.lang.Object ref = $name$_;\n"
     "  if (!(ref instanceof java.lang.String)) {\n"
     "    com.google.protobuf.ByteString bs =\n"
     "        (com.google.protobuf.ByteString) ref;\n"
-    "    java.lang.String s = bs.toStringUtf8();\n");
+    "    java.lang.String s = bs.toStringUtf8();\n", '$' };
+  printer->Print(variables_, get_method_start.Get());
   if (CheckUtf8(descriptor_)) {
-    printer->Print(variables_,
-      "    $name$_ = s;\n");
+    static io::LazyPrinterTemplate cache_string = {
+      "    $name$_ = s;\n", '$' };
+    printer->Print(variables_, cache_string.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate cache_valid_string = {
       "    if (bs.isValidUtf8()) {\n"
       "      $name$_ = s;\n"
-      "    }\n");
+      "    }\n", '$' };
+    printer->Print(variables_, cache_valid_string.Get());
   }
   printer->Print(variables_,
     "    return s;\n"
@@ -296,7 +309,7 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "}\n");
 
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_bytes_method = {
     "$deprecation$public com.google.protobuf.ByteString\n"
     "    get$capitalized_name$Bytes() {\n"
     "  java.lang.Object ref = $name$_;\n"
@@ -309,10 +322,11 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "  } else {\n"
     "    return (com.google.protobuf.ByteString) ref;\n"
     "  }\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_bytes_method.Get());
 
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate set_method = {
     "$deprecation$public Builder set$capitalized_name$(\n"
     "    java.lang.String value) {\n"
     "$null_check$"
@@ -320,35 +334,41 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "  $name$_ = value;\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, set_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate clear_method_start = {
     "$deprecation$public Builder clear$capitalized_name$() {\n"
-    "  $clear_has_field_bit_builder$\n");
+    "  $clear_has_field_bit_builder$\n", '$' };
+  printer->Print(variables_, clear_method_start.Get());
   // The default value is not a simple literal so we want to avoid executing
   // it multiple times.  Instead, get the default out of the default instance.
-  printer->Print(variables_,
-    "  $name$_ = getDefaultInstance().get$capitalized_name$();\n");
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate clear_to_default_instance = {
+    "  $name$_ = getDefaultInstance().get$capitalized_name$();\n", '$' };
+  printer->Print(variables_, clear_to_default_instance.Get());
+  static io::LazyPrinterTemplate clear_method_end = {
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, clear_method_end.Get());
 
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate set_bytes_method_start = {
     "$deprecation$public Builder set$capitalized_name$Bytes(\n"
     "    com.google.protobuf.ByteString value) {\n"
-    "$null_check$");
+    "$null_check$", '$' };
+  printer->Print(variables_, set_bytes_method_start.Get());
   if (CheckUtf8(descriptor_)) {
     printer->Print(variables_,
       "  checkByteStringIsUtf8(value);\n");
   }
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate set_bytes_method_end = {
     "  $set_has_field_bit_builder$\n"
     "  $name$_ = value;\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, set_bytes_method_end.Get());
 }
 
 void ImmutableStringFieldGenerator::
@@ -358,14 +378,17 @@ GenerateFieldBuilderInitializationCode(io::Printer* printer)  const {
 
 void ImmutableStringFieldGenerator::
 GenerateInitializationCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_ = $default$;\n");
+  static io::LazyPrinterTemplate initialization_code = {
+    "$name$_ = $default$;\n", '$' };
+  printer->Print(variables_, initialization_code.Get());
 }
 
 void ImmutableStringFieldGenerator::
 GenerateBuilderClearCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate builder_clear_code = {
     "$name$_ = $default$;\n"
-    "$clear_has_field_bit_builder$\n");
+    "$clear_has_field_bit_builder$\n", '$' };
+  printer->Print(variables_, builder_clear_code.Get());
 }
 
 void ImmutableStringFieldGenerator::
@@ -373,54 +396,61 @@ GenerateMergingCode(io::Printer* printer) const {
   if (SupportFieldPresence(descriptor_->file())) {
     // Allow a slight breach of abstraction here in order to avoid forcing
     // all string fields to Strings when copying fields from a Message.
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate merge_if_has = {
       "if (other.has$capitalized_name$()) {\n"
       "  $set_has_field_bit_builder$\n"
       "  $name$_ = other.$name$_;\n"
       "  $on_changed$\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, merge_if_has.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate merge_if_not_empty = {
       "if (!other.get$capitalized_name$().isEmpty()) {\n"
       "  $name$_ = other.$name$_;\n"
       "  $on_changed$\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, merge_if_not_empty.Get());
   }
 }
 
 void ImmutableStringFieldGenerator::
 GenerateBuildingCode(io::Printer* printer) const {
   if (SupportFieldPresence(descriptor_->file())) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate copy_has_bit = {
       "if ($get_has_field_bit_from_local$) {\n"
       "  $set_has_field_bit_to_local$;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, copy_has_bit.Get());
   }
-  printer->Print(variables_,
-    "result.$name$_ = $name$_;\n");
+  static io::LazyPrinterTemplate copy_value = {
+    "result.$name$_ = $name$_;\n", '$' };
+  printer->Print(variables_, copy_value.Get());
 }
 
 void ImmutableStringFieldGenerator::
 GenerateParsingCode(io::Printer* printer) const {
   if (CheckUtf8(descriptor_)) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate read_utf8_string = {
       "String s = input.readStringRequireUtf8();\n"
       "$set_has_field_bit_message$\n"
-      "$name$_ = s;\n");
+      "$name$_ = s;\n", '$' };
+    printer->Print(variables_, read_utf8_string.Get());
   } else if (!HasDescriptorMethods(descriptor_->file())) {
     // Lite runtime should attempt to reduce allocations by attempting to
     // construct the string directly from the input stream buffer. This avoids
     // spurious intermediary ByteString allocations, cutting overall allocations
     // in half.
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate read_string = {
       "String s = input.readString();\n"
       "$set_has_field_bit_message$\n"
-      "$name$_ = s;\n");
+      "$name$_ = s;\n", '$' };
+    printer->Print(variables_, read_string.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate read_bytes = {
       "com.google.protobuf.ByteString bs = input.readBytes();\n"
       "$set_has_field_bit_message$\n"
-      "$name$_ = bs;\n");
+      "$name$_ = bs;\n", '$' };
+    printer->Print(variables_, read_bytes.Get());
   }
 }
 
@@ -431,34 +461,39 @@ GenerateParsingDoneCode(io::Printer* printer) const {
 
 void ImmutableStringFieldGenerator::
 GenerateSerializationCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialization_code = {
     "if ($is_field_present_message$) {\n"
     "  output.writeBytes($number$, get$capitalized_name$Bytes());\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialization_code.Get());
 }
 
 void ImmutableStringFieldGenerator::
 GenerateSerializedSizeCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialized_size_code = {
     "if ($is_field_present_message$) {\n"
     "  size += com.google.protobuf.CodedOutputStream\n"
     "    .computeBytesSize($number$, get$capitalized_name$Bytes());\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialized_size_code.Get());
 }
 
 void ImmutableStringFieldGenerator::
 GenerateEqualsCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate equals_code = {
     "result = result && get$capitalized_name$()\n"
-    "    .equals(other.get$capitalized_name$());\n");
+    "    .equals(other.get$capitalized_name$());\n", '$' };
+  printer->Print(variables_, equals_code.Get());
 }
 
 void ImmutableStringFieldGenerator::
 GenerateHashCode(io::Printer* printer) const {
-  printer->Print(variables_,
-    "hash = (37 * hash) + $constant_name$;\n");
-  printer->Print(variables_,
-    "hash = (53 * hash) + get$capitalized_name$().hashCode();\n");
+  static io::LazyPrinterTemplate hash_field_number = {
+    "hash = (37 * hash) + $constant_name$;\n", '$' };
+  printer->Print(variables_, hash_field_number.Get());
+  static io::LazyPrinterTemplate hash_value = {
+    "hash = (53 * hash) + get$capitalized_name$().hashCode();\n", '$' };
+  printer->Print(variables_, hash_value.Get());
 }
 
 string ImmutableStringFieldGenerator::GetBoxedType() const {
@@ -488,14 +523,15 @@ GenerateMembers(io::Printer* printer) const {
 
   if (SupportFieldPresence(descriptor_->file())) {
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate has_method = {
     "$deprecation$public boolean has$capitalized_name$() {\n"
     "  return $has_oneof_case_message$;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, has_method.Get());
   }
 
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method_start = {
     "$deprecation$public java.lang.String get$capitalized_name$() {\n"
     "  java.lang.Object ref $default_init$;\n"
     "  if ($has_oneof_case_message$) {\n"
@@ -506,17 +542,20 @@ GenerateMembers(io::Printer* printer) const {
     "  } else {\n"
     "    com.google.protobuf.ByteString bs = \n"
     "        (com.google.protobuf.ByteString) ref;\n"
-    "    java.lang.String s = bs.toStringUtf8();\n");
+    "    java.lang.String s = bs.toStringUtf8();\n", '$' };
+  printer->Print(variables_, get_method_start.Get());
   if (CheckUtf8(descriptor_)) {
-    printer->Print(variables_,
-    "    if ($has_oneof_case_message$) {\n"
-    "      $oneof_name$_ = s;\n"
-    "    }\n");
+    static io::LazyPrinterTemplate cache_string = {
+      "    if ($has_oneof_case_message$) {\n"
+      "      $oneof_name$_ = s;\n"
+      "    }\n", '$' };
+    printer->Print(variables_, cache_string.Get());
   } else {
-    printer->Print(variables_,
-    "    if (bs.isValidUtf8() && ($has_oneof_case_message$)) {\n"
-    "      $oneof_name$_ = s;\n"
-    "    }\n");
+    static io::LazyPrinterTemplate cache_valid_string = {
+      "    if (bs.isValidUtf8() && ($has_oneof_case_message$)) {\n"
+      "      $oneof_name$_ = s;\n"
+      "    }\n", '$' };
+    printer->Print(variables_, cache_valid_string.Get());
   }
   printer->Print(variables_,
     "    return s;\n"
@@ -524,7 +563,7 @@ GenerateMembers(io::Printer* printer) const {
     "}\n");
   WriteFieldDocComment(printer, descriptor_);
 
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_bytes_method = {
     "$deprecation$public com.google.protobuf.ByteString\n"
     "    get$capitalized_name$Bytes() {\n"
     "  java.lang.Object ref $default_init$;\n"
@@ -542,21 +581,23 @@ GenerateMembers(io::Printer* printer) const {
     "  } else {\n"
     "    return (com.google.protobuf.ByteString) ref;\n"
     "  }\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_bytes_method.Get());
 }
 
 void ImmutableStringOneofFieldGenerator::
 GenerateBuilderMembers(io::Printer* printer) const {
   if (SupportFieldPresence(descriptor_->file())) {
     WriteFieldDocComment(printer, descriptor_);
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate has_method = {
       "$deprecation$public boolean has$capitalized_name$() {\n"
       "  return $has_oneof_case_message$;\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, has_method.Get());
   }
 
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method_start = {
     "$deprecation$public java.lang.String get$capitalized_name$() {\n"
     "  java.lang.Object ref $default_init$;\n"
     "  if ($has_oneof_case_message$) {\n"
@@ -566,15 +607,18 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "    com.google.protobuf.ByteString bs =\n"
     "        (com.google.protobuf.ByteString) ref;\n"
     "    java.lang.String s = bs.toStringUtf8();\n"
-    "    if ($has_oneof_case_message$) {\n");
+    "    if ($has_oneof_case_message$) {\n", '$' };
+  printer->Print(variables_, get_method_start.Get());
   if (CheckUtf8(descriptor_)) {
-    printer->Print(variables_,
-      "      $oneof_name$_ = s;\n");
+    static io::LazyPrinterTemplate cache_string = {
+      "      $oneof_name$_ = s;\n", '$' };
+    printer->Print(variables_, cache_string.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate cache_valid_string = {
       "      if (bs.isValidUtf8()) {\n"
       "        $oneof_name$_ = s;\n"
-      "      }\n");
+      "      }\n", '$' };
+    printer->Print(variables_, cache_valid_string.Get());
   }
   printer->Print(variables_,
     "    }\n"
@@ -585,7 +629,7 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "}\n");
 
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_bytes_method = {
     "$deprecation$public com.google.protobuf.ByteString\n"
     "    get$capitalized_name$Bytes() {\n"
     "  java.lang.Object ref $default_init$;\n"
@@ -603,10 +647,11 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "  } else {\n"
     "    return (com.google.protobuf.ByteString) ref;\n"
     "  }\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_bytes_method.Get());
 
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate set_method = {
     "$deprecation$public Builder set$capitalized_name$(\n"
     "    java.lang.String value) {\n"
     "$null_check$"
@@ -614,9 +659,10 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "  $oneof_name$_ = value;\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, set_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate clear_method = {
     "$deprecation$public Builder clear$capitalized_name$() {\n"
     "  if ($has_oneof_case_message$) {\n"
     "    $clear_oneof_case_message$;\n"
@@ -624,82 +670,92 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "    $on_changed$\n"
     "  }\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, clear_method.Get());
 
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate set_bytes_method_start = {
     "$deprecation$public Builder set$capitalized_name$Bytes(\n"
     "    com.google.protobuf.ByteString value) {\n"
-    "$null_check$");
+    "$null_check$", '$' };
+  printer->Print(variables_, set_bytes_method_start.Get());
   if (CheckUtf8(descriptor_)) {
     printer->Print(variables_,
       "  checkByteStringIsUtf8(value);\n");
   }
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate set_bytes_method_end = {
     "  $set_oneof_case_message$;\n"
     "  $oneof_name$_ = value;\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, set_bytes_method_end.Get());
 }
 
 void ImmutableStringOneofFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
   // Allow a slight breach of abstraction here in order to avoid forcing
   // all string fields to Strings when copying fields from a Message.
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate merging_code = {
     "$set_oneof_case_message$;\n"
     "$oneof_name$_ = other.$oneof_name$_;\n"
-    "$on_changed$\n");
+    "$on_changed$\n", '$' };
+  printer->Print(variables_, merging_code.Get());
 }
 
 void ImmutableStringOneofFieldGenerator::
 GenerateBuildingCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate building_code = {
     "if ($has_oneof_case_message$) {\n"
     "  result.$oneof_name$_ = $oneof_name$_;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, building_code.Get());
 }
 
 void ImmutableStringOneofFieldGenerator::
 GenerateParsingCode(io::Printer* printer) const {
   if (CheckUtf8(descriptor_)) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate read_utf8_string = {
       "String s = input.readStringRequireUtf8();\n"
       "$set_oneof_case_message$;\n"
-      "$oneof_name$_ = s;\n");
+      "$oneof_name$_ = s;\n", '$' };
+    printer->Print(variables_, read_utf8_string.Get());
   } else if (!HasDescriptorMethods(descriptor_->file())) {
     // Lite runtime should attempt to reduce allocations by attempting to
     // construct the string directly from the input stream buffer. This avoids
     // spurious intermediary ByteString allocations, cutting overall allocations
     // in half.
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate read_string = {
       "String s = input.readString();\n"
       "$set_oneof_case_message$;\n"
-      "$oneof_name$_ = s;\n");
+      "$oneof_name$_ = s;\n", '$' };
+    printer->Print(variables_, read_string.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate read_bytes = {
       "com.google.protobuf.ByteString bs = input.readBytes();\n"
       "$set_oneof_case_message$;\n"
-      "$oneof_name$_ = bs;\n");
+      "$oneof_name$_ = bs;\n", '$' };
+    printer->Print(variables_, read_bytes.Get());
   }
 }
 
 void ImmutableStringOneofFieldGenerator::
 GenerateSerializationCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialization_code = {
     "if ($has_oneof_case_message$) {\n"
     "  output.writeBytes($number$, get$capitalized_name$Bytes());\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialization_code.Get());
 }
 
 void ImmutableStringOneofFieldGenerator::
 GenerateSerializedSizeCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate serialized_size_code = {
     "if ($has_oneof_case_message$) {\n"
     "  size += com.google.protobuf.CodedOutputStream\n"
     "    .computeBytesSize($number$, get$capitalized_name$Bytes());\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, serialized_size_code.Get());
 }
 
 // ===================================================================
@@ -731,26 +787,31 @@ int RepeatedImmutableStringFieldGenerator::GetNumBitsForBuilder() const {
 void RepeatedImmutableStringFieldGenerator::
 GenerateInterfaceMembers(io::Printer* printer) const {
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_list_declaration = {
     "$deprecation$com.google.protobuf.ProtocolStringList\n"
-    "    get$capitalized_name$List();\n");
+    "    get$capitalized_name$List();\n", '$' };
+  printer->Print(variables_, get_list_declaration.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
-    "$deprecation$int get$capitalized_name$Count();\n");
+  static io::LazyPrinterTemplate get_count_declaration = {
+    "$deprecation$int get$capitalized_name$Count();\n", '$' };
+  printer->Print(variables_, get_count_declaration.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
-    "$deprecation$java.lang.String get$capitalized_name$(int index);\n");
+  static io::LazyPrinterTemplate get_declaration = {
+    "$deprecation$java.lang.String get$capitalized_name$(int index);\n", '$' };
+  printer->Print(variables_, get_declaration.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_bytes_declaration = {
     "$deprecation$com.google.protobuf.ByteString\n"
-    "    get$capitalized_name$Bytes(int index);\n");
+    "    get$capitalized_name$Bytes(int index);\n", '$' };
+  printer->Print(variables_, get_bytes_declaration.Get());
 }
 
 
 void RepeatedImmutableStringFieldGenerator::
 GenerateMembers(io::Printer* printer) const {
-  printer->Print(variables_,
-    "private com.google.protobuf.LazyStringList $name$_;\n");
+  static io::LazyPrinterTemplate field = {
+    "private com.google.protobuf.LazyStringList $name$_;\n", '$' };
+  printer->Print(variables_, field.Get());
   PrintExtraFieldInfo(variables_, printer);
   WriteFieldDocComment(printer, descriptor_);
   printer->Print(variables_,
@@ -759,26 +820,30 @@ GenerateMembers(io::Printer* printer) const {
     "  return $name$_;\n"   // note:  unmodifiable list
     "}\n");
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_count_method = {
     "$deprecation$public int get$capitalized_name$Count() {\n"
     "  return $name$_.size();\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_count_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method = {
     "$deprecation$public java.lang.String get$capitalized_name$(int index) {\n"
     "  return $name$_.get(index);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_bytes_method = {
     "$deprecation$public com.google.protobuf.ByteString\n"
     "    get$capitalized_name$Bytes(int index) {\n"
     "  return $name$_.getByteString(index);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_bytes_method.Get());
 
   if (descriptor_->options().packed() &&
       HasGeneratedMethods(descriptor_->containing_type())) {
-    printer->Print(variables_,
-      "private int $name$MemoizedSerializedSize = -1;\n");
+    static io::LazyPrinterTemplate memoized_size_field = {
+      "private int $name$MemoizedSerializedSize = -1;\n", '$' };
+    printer->Print(variables_, memoized_size_field.Get());
   }
 }
 
@@ -793,45 +858,52 @@ GenerateBuilderMembers(io::Printer* printer) const {
   // memory allocations. Note, immutable is a strong guarantee here -- not
   // just that the list cannot be modified via the reference but that the
   // list can never be modified.
-  printer->Print(variables_,
-    "private com.google.protobuf.LazyStringList $name$_ = $empty_list$;\n");
+  static io::LazyPrinterTemplate field = {
+    "private com.google.protobuf.LazyStringList $name$_ = $empty_list$;\n",
+    '$' };
+  printer->Print(variables_, field.Get());
 
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate ensure_is_mutable_method = {
     "private void ensure$capitalized_name$IsMutable() {\n"
     "  if (!$get_mutable_bit_builder$) {\n"
     "    $name$_ = new com.google.protobuf.LazyStringArrayList($name$_);\n"
     "    $set_mutable_bit_builder$;\n"
     "   }\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, ensure_is_mutable_method.Get());
 
     // Note:  We return an unmodifiable list because otherwise the caller
     //   could hold on to the returned list and modify it after the message
     //   has been built, thus mutating the message which is supposed to be
     //   immutable.
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_list_method = {
     "$deprecation$public com.google.protobuf.ProtocolStringList\n"
     "    get$capitalized_name$List() {\n"
     "  return $name$_.getUnmodifiableView();\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_list_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_count_method = {
     "$deprecation$public int get$capitalized_name$Count() {\n"
     "  return $name$_.size();\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_count_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_method = {
     "$deprecation$public java.lang.String get$capitalized_name$(int index) {\n"
     "  return $name$_.get(index);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate get_bytes_method = {
     "$deprecation$public com.google.protobuf.ByteString\n"
     "    get$capitalized_name$Bytes(int index) {\n"
     "  return $name$_.getByteString(index);\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, get_bytes_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate set_method = {
     "$deprecation$public Builder set$capitalized_name$(\n"
     "    int index, java.lang.String value) {\n"
     "$null_check$"
@@ -839,9 +911,10 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "  $name$_.set(index, value);\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, set_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate add_method = {
     "$deprecation$public Builder add$capitalized_name$(\n"
     "    java.lang.String value) {\n"
     "$null_check$"
@@ -849,9 +922,10 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "  $name$_.add(value);\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, add_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate add_all_method = {
     "$deprecation$public Builder addAll$capitalized_name$(\n"
     "    java.lang.Iterable<java.lang.String> values) {\n"
     "  ensure$capitalized_name$IsMutable();\n"
@@ -859,31 +933,35 @@ GenerateBuilderMembers(io::Printer* printer) const {
     "      values, $name$_);\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, add_all_method.Get());
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate clear_method = {
     "$deprecation$public Builder clear$capitalized_name$() {\n"
     "  $name$_ = $empty_list$;\n"
     "  $clear_mutable_bit_builder$;\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, clear_method.Get());
 
   WriteFieldDocComment(printer, descriptor_);
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate add_bytes_method_start = {
     "$deprecation$public Builder add$capitalized_name$Bytes(\n"
     "    com.google.protobuf.ByteString value) {\n"
-    "$null_check$");
+    "$null_check$", '$' };
+  printer->Print(variables_, add_bytes_method_start.Get());
   if (CheckUtf8(descriptor_)) {
     printer->Print(variables_,
       "  checkByteStringIsUtf8(value);\n");
   }
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate ensure_is_mutable_declaration = {
     "  ensure$capitalized_name$IsMutable();\n"
     "  $name$_.add(value);\n"
     "  $on_changed$\n"
     "  return this;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, ensure_is_mutable_declaration.Get());
 }
 
 void RepeatedImmutableStringFieldGenerator::
@@ -893,14 +971,17 @@ GenerateFieldBuilderInitializationCode(io::Printer* printer)  const {
 
 void RepeatedImmutableStringFieldGenerator::
 GenerateInitializationCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_ = $empty_list$;\n");
+  static io::LazyPrinterTemplate initialization_code = {
+    "$name$_ = $empty_list$;\n", '$' };
+  printer->Print(variables_, initialization_code.Get());
 }
 
 void RepeatedImmutableStringFieldGenerator::
 GenerateBuilderClearCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate builder_clear_code = {
     "$name$_ = $empty_list$;\n"
-    "$clear_mutable_bit_builder$;\n");
+    "$clear_mutable_bit_builder$;\n", '$' };
+  printer->Print(variables_, builder_clear_code.Get());
 }
 
 void RepeatedImmutableStringFieldGenerator::
@@ -910,7 +991,7 @@ GenerateMergingCode(io::Printer* printer) const {
   //      don't allocate a new array if we already have an immutable one.
   //   2. If the other list is non-empty and our current list is empty, we can
   //      reuse the other list which is guaranteed to be immutable.
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate merging_code = {
     "if (!other.$name$_.isEmpty()) {\n"
     "  if ($name$_.isEmpty()) {\n"
     "    $name$_ = other.$name$_;\n"
@@ -920,7 +1001,8 @@ GenerateMergingCode(io::Printer* printer) const {
     "    $name$_.addAll(other.$name$_);\n"
     "  }\n"
     "  $on_changed$\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, merging_code.Get());
 }
 
 void RepeatedImmutableStringFieldGenerator::
@@ -928,12 +1010,13 @@ GenerateBuildingCode(io::Printer* printer) const {
   // The code below ensures that the result has an immutable list. If our
   // list is immutable, we can just reuse it. If not, we make it immutable.
 
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate building_code = {
     "if ($get_mutable_bit_builder$) {\n"
     "  $name$_ = $name$_.getUnmodifiableView();\n"
     "  $clear_mutable_bit_builder$;\n"
     "}\n"
-    "result.$name$_ = $name$_;\n");
+    "result.$name$_ = $name$_;\n", '$' };
+  printer->Print(variables_, building_code.Get());
 }
 
 void RepeatedImmutableStringFieldGenerator::
@@ -952,30 +1035,34 @@ GenerateParsingCode(io::Printer* printer) const {
     printer->Print(variables_,
     "com.google.protobuf.ByteString bs = input.readBytes();\n");
   }
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate ensure_mutable = {
     "if (!$get_mutable_bit_parser$) {\n"
     "  $name$_ = new com.google.protobuf.LazyStringArrayList();\n"
     "  $set_mutable_bit_parser$;\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, ensure_mutable.Get());
   if (CheckUtf8(descriptor_) || !HasDescriptorMethods(descriptor_->file())) {
-    printer->Print(variables_,
-      "$name$_.add(s);\n");
+    static io::LazyPrinterTemplate add_string = {
+      "$name$_.add(s);\n", '$' };
+    printer->Print(variables_, add_string.Get());
   } else {
-    printer->Print(variables_,
-      "$name$_.add(bs);\n");
+    static io::LazyPrinterTemplate add_bytes = {
+      "$name$_.add(bs);\n", '$' };
+    printer->Print(variables_, add_bytes.Get());
   }
 }
 
 void RepeatedImmutableStringFieldGenerator::
 GenerateParsingCodeFromPacked(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate read_packed_start = {
     "int length = input.readRawVarint32();\n"
     "int limit = input.pushLimit(length);\n"
     "if (!$get_mutable_bit_parser$ && input.getBytesUntilLimit() > 0) {\n"
     "  $name$_ = new com.google.protobuf.LazyStringArrayList();\n"
     "  $set_mutable_bit_parser$;\n"
     "}\n"
-    "while (input.getBytesUntilLimit() > 0) {\n");
+    "while (input.getBytesUntilLimit() > 0) {\n", '$' };
+  printer->Print(variables_, read_packed_start.Get());
   if (CheckUtf8(descriptor_)) {
     printer->Print(variables_,
       "  String s = input.readStringRequireUtf8();\n");
@@ -983,8 +1070,9 @@ GenerateParsingCodeFromPacked(io::Printer* printer) const {
     printer->Print(variables_,
       "  String s = input.readString();\n");
   }
-  printer->Print(variables_,
-    "  $name$.add(s);\n");
+  static io::LazyPrinterTemplate add_string = {
+    "  $name$.add(s);\n", '$' };
+  printer->Print(variables_, add_string.Get());
   printer->Print(variables_,
     "}\n"
     "input.popLimit(limit);\n");
@@ -992,28 +1080,31 @@ GenerateParsingCodeFromPacked(io::Printer* printer) const {
 
 void RepeatedImmutableStringFieldGenerator::
 GenerateParsingDoneCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate parsing_done_code = {
     "if ($get_mutable_bit_parser$) {\n"
     "  $name$_ = $name$_.getUnmodifiableView();\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, parsing_done_code.Get());
 }
 
 void RepeatedImmutableStringFieldGenerator::
 GenerateSerializationCode(io::Printer* printer) const {
   if (descriptor_->options().packed()) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate write_packed = {
       "if (get$capitalized_name$List().size() > 0) {\n"
       "  output.writeRawVarint32($tag$);\n"
       "  output.writeRawVarint32($name$MemoizedSerializedSize);\n"
       "}\n"
       "for (int i = 0; i < $name$_.size(); i++) {\n"
       "  output.write$capitalized_type$NoTag($name$_.get(i));\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, write_packed.Get());
   } else {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate write_unpacked = {
       "for (int i = 0; i < $name$_.size(); i++) {\n"
       "  output.writeBytes($number$, $name$_.getByteString(i));\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, write_unpacked.Get());
   }
 }
 
@@ -1024,31 +1115,35 @@ GenerateSerializedSizeCode(io::Printer* printer) const {
     "  int dataSize = 0;\n");
   printer->Indent();
 
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate data_size = {
     "for (int i = 0; i < $name$_.size(); i++) {\n"
     "  dataSize += com.google.protobuf.CodedOutputStream\n"
     "    .computeBytesSizeNoTag($name$_.getByteString(i));\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, data_size.Get());
 
   printer->Print(
       "size += dataSize;\n");
 
   if (descriptor_->options().packed()) {
-    printer->Print(variables_,
+    static io::LazyPrinterTemplate packed_tag_size = {
       "if (!get$capitalized_name$List().isEmpty()) {\n"
       "  size += $tag_size$;\n"
       "  size += com.google.protobuf.CodedOutputStream\n"
       "      .computeInt32SizeNoTag(dataSize);\n"
-      "}\n");
+      "}\n", '$' };
+    printer->Print(variables_, packed_tag_size.Get());
   } else {
-    printer->Print(variables_,
-      "size += $tag_size$ * get$capitalized_name$List().size();\n");
+    static io::LazyPrinterTemplate unpacked_tag_size = {
+      "size += $tag_size$ * get$capitalized_name$List().size();\n", '$' };
+    printer->Print(variables_, unpacked_tag_size.Get());
   }
 
   // cache the data size for packed fields.
   if (descriptor_->options().packed()) {
-    printer->Print(variables_,
-      "$name$MemoizedSerializedSize = dataSize;\n");
+    static io::LazyPrinterTemplate memoize_data_size = {
+      "$name$MemoizedSerializedSize = dataSize;\n", '$' };
+    printer->Print(variables_, memoize_data_size.Get());
   }
 
   printer->Outdent();
@@ -1057,18 +1152,20 @@ GenerateSerializedSizeCode(io::Printer* printer) const {
 
 void RepeatedImmutableStringFieldGenerator::
 GenerateEqualsCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate equals_code = {
     "result = result && get$capitalized_name$List()\n"
-    "    .equals(other.get$capitalized_name$List());\n");
+    "    .equals(other.get$capitalized_name$List());\n", '$' };
+  printer->Print(variables_, equals_code.Get());
 }
 
 void RepeatedImmutableStringFieldGenerator::
 GenerateHashCode(io::Printer* printer) const {
-  printer->Print(variables_,
+  static io::LazyPrinterTemplate hash_code = {
     "if (get$capitalized_name$Count() > 0) {\n"
     "  hash = (37 * hash) + $constant_name$;\n"
     "  hash = (53 * hash) + get$capitalized_name$List().hashCode();\n"
-    "}\n");
+    "}\n", '$' };
+  printer->Print(variables_, hash_code.Get());
 }
 
 string RepeatedImmutableStringFieldGenerator::GetBoxedType() const {
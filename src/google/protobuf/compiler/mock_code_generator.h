@@ -95,6 +95,7 @@ class MockCodeGenerator : public CodeGenerator {
                         const string& parameter,
                         GeneratorContext* context,
                         string* error) const;
+  virtual bool IsThreadSafe() const { return true; }
 
  private:
   string name_;
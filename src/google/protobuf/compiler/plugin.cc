@@ -33,6 +33,7 @@
 #include <google/protobuf/compiler/plugin.h>
 
 #include <iostream>
+#include <map>
 #include <set>
 
 #ifdef _WIN32
@@ -45,6 +46,14 @@
 #define STDOUT_FILENO 1
 #endif
 #else
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include <unistd.h>
 #endif
 
@@ -52,7 +61,10 @@
 #include <google/protobuf/compiler/plugin.pb.h>
 #include <google/protobuf/compiler/code_generator.h>
 #include <google/protobuf/descriptor.h>
+#include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/stubs/strutil.h>
+#include <google/protobuf/stubs/map_util.h>
 
 
 namespace google {
@@ -92,11 +104,314 @@ class GeneratorResponseContext : public GeneratorContext {
   const vector<const FileDescriptor*>& parsed_files_;
 };
 
+// Runs |generator| on the files |request| asks for, which must be in |pool|,
+// putting its output or error in *response.  Returns false and sets *error if
+// |pool| lacks one of the files.
+static bool GenerateCode(const CodeGeneratorRequest& request,
+                         const DescriptorPool& pool,
+                         const CodeGenerator* generator,
+                         CodeGeneratorResponse* response, string* error) {
+  vector<const FileDescriptor*> parsed_files;
+  for (int i = 0; i < request.file_to_generate_size(); i++) {
+    parsed_files.push_back(pool.FindFileByName(request.file_to_generate(i)));
+    if (parsed_files.back() == NULL) {
+      *error = "protoc asked plugin to generate a file but did not provide a "
+               "descriptor for the file: " + request.file_to_generate(i);
+      return false;
+    }
+  }
+
+  GeneratorResponseContext context(response, parsed_files);
+
+  for (int i = 0; i < parsed_files.size(); i++) {
+    const FileDescriptor* file = parsed_files[i];
+
+    string error;
+    bool succeeded = generator->Generate(
+        file, request.parameter(), &context, &error);
+
+    if (!succeeded && error.empty()) {
+      error = "Code generator returned false but provided no error "
+              "description.";
+    }
+    if (!error.empty()) {
+      response->set_error(file->name() + ": " + error);
+      break;
+    }
+  }
+
+  return true;
+}
+
+#ifndef _WIN32
+
+// If |arg| is "--shared_memory_fd=N", sets *fd to N and returns true.
+static bool ParseSharedMemoryFlag(const char* arg, int* fd) {
+  static const char kFlag[] = "--shared_memory_fd=";
+  if (strncmp(arg, kFlag, sizeof(kFlag) - 1) != 0) return false;
+  char* end;
+  long value = strtol(arg + sizeof(kFlag) - 1, &end, 10);
+  if (*end != '\0' || value <= STDERR_FILENO || value > kint32max) {
+    return false;
+  }
+  *fd = value;
+  return true;
+}
+
+// Reads the request from the shared memory file |fd| once protoc has closed
+// our stdin.
+static bool ReadRequestFromSharedMemory(int fd,
+                                        CodeGeneratorRequest* request) {
+  char buffer[64];
+  int n;
+  do {
+    n = read(STDIN_FILENO, buffer, sizeof(buffer));
+  } while (n > 0 || (n < 0 && errno == EINTR));
+  if (n < 0) return false;
+
+  struct stat info;
+  if (fstat(fd, &info) == -1 || info.st_size > kint32max) return false;
+  int size = info.st_size;
+  if (size == 0) return request->ParseFromArray(NULL, 0);
+
+  void* data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) return false;
+  bool parsed = request->ParseFromArray(data, size);
+  munmap(data, size);
+  return parsed;
+}
+
+// Replaces the request in the shared memory file |fd| with |response|, then
+// tells protoc it is there by writing the acknowledgment byte to stdout.  The
+// byte must match kSharedMemoryAck in subprocess.cc.
+static bool WriteResponseToSharedMemory(const CodeGeneratorResponse& response,
+                                        int fd) {
+  int size = response.ByteSize();
+  if (ftruncate(fd, size) == -1) return false;
+  if (size > 0) {
+    void* data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) return false;
+    response.SerializeWithCachedSizesToArray(reinterpret_cast<uint8*>(data));
+    if (munmap(data, size) != 0) return false;
+  }
+
+  static const char kAck = 'R';
+  int n;
+  do {
+    n = write(STDOUT_FILENO, &kAck, 1);
+  } while (n < 0 && errno == EINTR);
+  return n == 1;
+}
+
+// Collects the errors from building the files of one request.
+class BuildErrorCollector : public DescriptorPool::ErrorCollector {
+ public:
+  explicit BuildErrorCollector(string* errors) : errors_(errors) {}
+  virtual ~BuildErrorCollector() {}
+
+  // implements ErrorCollector ----------------------------------------
+  virtual void AddError(const string& filename, const string& element_name,
+                        const Message* descriptor, ErrorLocation location,
+                        const string& message) {
+    if (!errors_->empty()) errors_->append("\n");
+    errors_->append(filename + ": " + element_name + ": " + message);
+  }
+
+ private:
+  string* errors_;
+};
+
+// Serves the requests of many protoc runs over a Unix domain socket.  The
+// files they describe accumulate in one DescriptorPool, so that each request
+// only builds the files that earlier ones did not have.
+class PluginServer {
+ public:
+  PluginServer(const char* program, const CodeGenerator* generator)
+      : program_(program), generator_(generator),
+        pool_(new DescriptorPool) {}
+
+  // Listens on |socket_path| and serves requests until killed.  Returns only
+  // if setting up the socket fails.
+  int Run(const string& socket_path);
+
+ private:
+  // Reads one request from |connection| and writes the response.
+  void Serve(int connection);
+
+  // Makes pool_ hold every file in |request|, starting a new pool if one of
+  // them differs from the file of the same name already there, or if they
+  // fail to build alongside the files kept from earlier requests.
+  bool AddFiles(const CodeGeneratorRequest& request, string* error);
+
+  // Builds the files in |request| that pool_ does not have yet.
+  // |serialized| holds each of them as serialized for files_.
+  bool BuildFiles(const CodeGeneratorRequest& request,
+                  const vector<string>& serialized, string* error);
+
+  const char* program_;
+  const CodeGenerator* generator_;
+  google::protobuf::scoped_ptr<DescriptorPool> pool_;
+
+  // The serialized FileDescriptorProto of each file in pool_, by name.
+  map<string, string> files_;
+};
+
+// Fills in *address for |path|.  Returns false if the path is too long.
+static bool MakeSocketAddress(const string& path, struct sockaddr_un* address) {
+  memset(address, 0, sizeof(*address));
+  address->sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address->sun_path)) return false;
+  memcpy(address->sun_path, path.data(), path.size());
+  return true;
+}
+
+int PluginServer::Run(const string& socket_path) {
+  // A protoc that goes away mid-request must not kill us.
+  signal(SIGPIPE, SIG_IGN);
+
+  // Bind to a temporary name and rename the socket into place once it is
+  // listening, so that protoc never finds it unready, and a socket left by a
+  // server that was killed is replaced.
+  string temp_path = socket_path + "." + SimpleItoa(getpid());
+  struct sockaddr_un address;
+  struct sockaddr_un temp_address;
+  if (!MakeSocketAddress(socket_path, &address) ||
+      !MakeSocketAddress(temp_path, &temp_address)) {
+    std::cerr << program_ << ": Socket path is too long: " << socket_path
+              << std::endl;
+    return 1;
+  }
+
+  int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (probe != -1 &&
+      connect(probe, reinterpret_cast<struct sockaddr*>(&address),
+              sizeof(address)) == 0) {
+    std::cerr << program_ << ": A server is already listening on "
+              << socket_path << std::endl;
+    close(probe);
+    return 1;
+  }
+  if (probe != -1) close(probe);
+
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(temp_path.c_str());
+  if (listener == -1 ||
+      bind(listener, reinterpret_cast<struct sockaddr*>(&temp_address),
+           sizeof(temp_address)) == -1 ||
+      listen(listener, SOMAXCONN) == -1 ||
+      rename(temp_path.c_str(), socket_path.c_str()) == -1) {
+    std::cerr << program_ << ": " << socket_path << ": " << strerror(errno)
+              << std::endl;
+    unlink(temp_path.c_str());
+    return 1;
+  }
+
+  while (true) {
+    int connection = accept(listener, NULL, NULL);
+    if (connection == -1) {
+      if (errno == EINTR || errno == ECONNABORTED) continue;
+      std::cerr << program_ << ": accept: " << strerror(errno) << std::endl;
+      close(listener);
+      return 1;
+    }
+    Serve(connection);
+    close(connection);
+  }
+}
+
+void PluginServer::Serve(int connection) {
+  // protoc shuts down its side of the connection after the request.
+  CodeGeneratorRequest request;
+  CodeGeneratorResponse response;
+  string error;
+  if (!request.ParseFromFileDescriptor(connection)) {
+    response.set_error("protoc sent unparseable request to plugin.");
+  } else if (!AddFiles(request, &error) ||
+             !GenerateCode(request, *pool_, generator_, &response, &error)) {
+    response.Clear();
+    response.set_error(error);
+  }
+
+  // The response is prefixed with its size, so that protoc can tell it from
+  // one cut short by the server dying.
+  io::FileOutputStream output(connection);
+  bool written;
+  {
+    io::CodedOutputStream coded_output(&output);
+    coded_output.WriteVarint32(response.ByteSize());
+    response.SerializeWithCachedSizes(&coded_output);
+    written = !coded_output.HadError();
+  }
+  if (!output.Flush() || !written) {
+    std::cerr << program_ << ": Error writing response: "
+              << strerror(output.GetErrno()) << std::endl;
+  }
+}
+
+bool PluginServer::AddFiles(const CodeGeneratorRequest& request,
+                            string* error) {
+  vector<string> serialized(request.proto_file_size());
+  for (int i = 0; i < request.proto_file_size(); i++) {
+    request.proto_file(i).SerializeToString(&serialized[i]);
+    const string* known = FindOrNull(files_, request.proto_file(i).name());
+    if (known != NULL && *known != serialized[i]) {
+      // The file has changed since we built it.  Descriptors can't be
+      // replaced, so start over.
+      pool_.reset(new DescriptorPool);
+      files_.clear();
+    }
+  }
+
+  bool fresh_pool = files_.empty();
+  if (BuildFiles(request, serialized, error)) return true;
+  if (fresh_pool) return false;
+
+  // Files kept from earlier requests may conflict with this one, for example
+  // if a message moved from one file to another, or another project uses the
+  // server too.  Start over so that only this request's files count.
+  error->clear();
+  pool_.reset(new DescriptorPool);
+  files_.clear();
+  return BuildFiles(request, serialized, error);
+}
+
+bool PluginServer::BuildFiles(const CodeGeneratorRequest& request,
+                              const vector<string>& serialized,
+                              string* error) {
+  BuildErrorCollector error_collector(error);
+  for (int i = 0; i < request.proto_file_size(); i++) {
+    const FileDescriptorProto& file = request.proto_file(i);
+    if (files_.count(file.name()) > 0) continue;
+    if (pool_->BuildFileCollectingErrors(file, &error_collector) == NULL) {
+      return false;
+    }
+    files_[file.name()] = serialized[i];
+  }
+  return true;
+}
+
+#endif  // !_WIN32
+
 int PluginMain(int argc, char* argv[], const CodeGenerator* generator) {
+  // The descriptor of the shared memory file protoc passes messages through,
+  // or -1 if it uses stdin and stdout.
+  int shared_memory_fd = -1;
 
   if (argc > 1) {
-    std::cerr << argv[0] << ": Unknown option: " << argv[1] << std::endl;
-    return 1;
+    bool known_option = false;
+#ifndef _WIN32
+    static const char kServerFlag[] = "--server=";
+    if (argc == 2 && HasPrefixString(argv[1], kServerFlag)) {
+      PluginServer server(argv[0], generator);
+      return server.Run(argv[1] + sizeof(kServerFlag) - 1);
+    }
+    known_option =
+        argc == 2 && ParseSharedMemoryFlag(argv[1], &shared_memory_fd);
+#endif
+    if (!known_option) {
+      std::cerr << argv[0] << ": Unknown option: " << argv[1] << std::endl;
+      return 1;
+    }
   }
 
 #ifdef _WIN32
@@ -105,7 +420,17 @@ int PluginMain(int argc, char* argv[], const CodeGenerator* generator) {
 #endif
 
   CodeGeneratorRequest request;
-  if (!request.ParseFromFileDescriptor(STDIN_FILENO)) {
+  bool parsed;
+#ifndef _WIN32
+  if (shared_memory_fd != -1) {
+    parsed = ReadRequestFromSharedMemory(shared_memory_fd, &request);
+  } else {
+    parsed = request.ParseFromFileDescriptor(STDIN_FILENO);
+  }
+#else
+  parsed = request.ParseFromFileDescriptor(STDIN_FILENO);
+#endif
+  if (!parsed) {
     std::cerr << argv[0] << ": protoc sent unparseable request to plugin."
               << std::endl;
     return 1;
@@ -120,36 +445,23 @@ int PluginMain(int argc, char* argv[], const CodeGenerator* generator) {
     }
   }
 
-  vector<const FileDescriptor*> parsed_files;
-  for (int i = 0; i < request.file_to_generate_size(); i++) {
-    parsed_files.push_back(pool.FindFileByName(request.file_to_generate(i)));
-    if (parsed_files.back() == NULL) {
-      std::cerr << argv[0] << ": protoc asked plugin to generate a file but "
-                              "did not provide a descriptor for the file: "
-                << request.file_to_generate(i) << std::endl;
-      return 1;
-    }
-  }
-
   CodeGeneratorResponse response;
-  GeneratorResponseContext context(&response, parsed_files);
-
-  for (int i = 0; i < parsed_files.size(); i++) {
-    const FileDescriptor* file = parsed_files[i];
-
-    string error;
-    bool succeeded = generator->Generate(
-        file, request.parameter(), &context, &error);
+  string error;
+  if (!GenerateCode(request, pool, generator, &response, &error)) {
+    std::cerr << argv[0] << ": " << error << std::endl;
+    return 1;
+  }
 
-    if (!succeeded && error.empty()) {
-      error = "Code generator returned false but provided no error "
-              "description.";
-    }
-    if (!error.empty()) {
-      response.set_error(file->name() + ": " + error);
-      break;
+#ifndef _WIN32
+  if (shared_memory_fd != -1) {
+    if (!WriteResponseToSharedMemory(response, shared_memory_fd)) {
+      std::cerr << argv[0] << ": Error writing to shared memory: "
+                << strerror(errno) << std::endl;
+      return 1;
     }
+    return 0;
   }
+#endif
 
   if (!response.SerializeToFileDescriptor(STDOUT_FILENO)) {
     std::cerr << argv[0] << ": Error writing to stdout." << std::endl;
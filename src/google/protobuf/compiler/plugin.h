@@ -51,6 +51,34 @@
 //     protoc --plugin=protoc-gen-NAME=path/to/mybinary --NAME_out=OUT_DIR
 //   On Windows, make sure to include the .exe suffix:
 //     protoc --plugin=protoc-gen-NAME=path/to/mybinary.exe --NAME_out=OUT_DIR
+//
+// protoc normally sends the plugin a CodeGeneratorRequest on stdin and reads
+// a CodeGeneratorResponse from its stdout.  If "shared_memory" is one of the
+// comma-separated parameters given to the plugin, as in
+//   protoc --NAME_out=shared_memory,OTHER_PARAMS:OUT_DIR
+// protoc instead starts the plugin with the argument "--shared_memory_fd=N"
+// and passes the messages through a shared memory file open as descriptor N:
+// the request is there once protoc closes the plugin's stdin, and the plugin
+// replaces it with the response, then writes the single byte 'R' to its
+// stdout to say so, before exiting.  This saves copying large messages
+// through pipes.  If the plugin writes anything else to its stdout, protoc
+// reports that it does not support shared memory.  protoc leaves
+// "shared_memory" out of the request's parameter.  PluginMain() handles both
+// transports; on Windows, protoc always uses pipes.
+//
+// To save starting a plugin for every protoc run, a plugin built on
+// PluginMain() can also run as a server:
+//   path/to/mybinary --server=SOCKET_PATH &
+//   protoc --plugin_server=protoc-gen-NAME=SOCKET_PATH --NAME_out=OUT_DIR
+// The server listens on the Unix domain socket SOCKET_PATH.  For each request,
+// protoc connects, writes the CodeGeneratorRequest and shuts down its side of
+// the connection, then reads the CodeGeneratorResponse, which the server
+// prefixes with its size as a varint.  A server that cannot parse the request
+// answers with a response whose error is set.  The server keeps the
+// descriptors of the files it has been sent and only builds those that are new
+// to it, starting afresh if a file changes or the new files conflict with the
+// ones it kept.  It serves one request at a time and runs until killed.
+// Servers are not supported on Windows.
 
 #ifndef GOOGLE_PROTOBUF_COMPILER_PLUGIN_H__
 #define GOOGLE_PROTOBUF_COMPILER_PLUGIN_H__
@@ -341,7 +341,7 @@ void CodeGeneratorRequest::SerializeWithCachedSizes(
     this->file_to_generate(i).data(), this->file_to_generate(i).length(),
     ::google::protobuf::internal::WireFormat::SERIALIZE,
     "google.protobuf.compiler.CodeGeneratorRequest.file_to_generate");
-    ::google::protobuf::internal::WireFormatLite::WriteString(
+    ::google::protobuf::internal::WireFormatLite::WriteStringMaybeAliased(
       1, this->file_to_generate(i), output);
   }
 
@@ -700,17 +700,17 @@ void Generator::PrintDescriptor(const Descriptor& message_descriptor) const {
   printer_->Print("],\n");
   printer_->Print("oneofs=[\n");
   printer_->Indent();
+  const io::PrinterTemplate oneof_descriptor_decl(
+      "_descriptor.OneofDescriptor(\n"
+      "  name='$name$', full_name='$full_name$',\n"
+      "  index=$index$, containing_type=None, fields=[]),\n", '$');
   for (int i = 0; i < message_descriptor.oneof_decl_count(); ++i) {
     const OneofDescriptor* desc = message_descriptor.oneof_decl(i);
     map<string, string> m;
     m["name"] = desc->name();
     m["full_name"] = desc->full_name();
     m["index"] = SimpleItoa(desc->index());
-    printer_->Print(
-        m,
-        "_descriptor.OneofDescriptor(\n"
-        "  name='$name$', full_name='$full_name$',\n"
-        "  index=$index$, containing_type=None, fields=[]),\n");
+    printer_->Print(m, oneof_descriptor_decl);
   }
   printer_->Outdent();
   printer_->Print("],\n");
@@ -886,12 +886,16 @@ void Generator::FixForeignFieldsInField(const Descriptor* containing_type,
   const Descriptor* foreign_message_type = field.message_type();
   if (foreign_message_type) {
     m["foreign_type"] = ModuleLevelDescriptorName(*foreign_message_type);
-    printer_->Print(m, "$field_ref$.message_type = $foreign_type$\n");
+    static io::LazyPrinterTemplate fix_message_type = {
+        "$field_ref$.message_type = $foreign_type$\n", '$' };
+    printer_->Print(m, fix_message_type.Get());
   }
   const EnumDescriptor* enum_type = field.enum_type();
   if (enum_type) {
     m["enum_type"] = ModuleLevelDescriptorName(*enum_type);
-    printer_->Print(m, "$field_ref$.enum_type = $enum_type$\n");
+    static io::LazyPrinterTemplate fix_enum_type = {
+        "$field_ref$.enum_type = $enum_type$\n", '$' };
+    printer_->Print(m, fix_enum_type.Get());
   }
 }
 
@@ -1018,12 +1022,12 @@ void Generator::PrintEnumValueDescriptor(
   m["index"] = SimpleItoa(descriptor.index());
   m["number"] = SimpleItoa(descriptor.number());
   m["options"] = OptionsValue("EnumValueOptions", options_string);
-  printer_->Print(
-      m,
+  static io::LazyPrinterTemplate enum_value_descriptor_decl = {
       "_descriptor.EnumValueDescriptor(\n"
       "  name='$name$', index=$index$, number=$number$,\n"
       "  options=$options$,\n"
-      "  type=None)");
+      "  type=None)", '$' };
+  printer_->Print(m, enum_value_descriptor_decl.Get());
 }
 
 // Returns a Python expression that calls descriptor._ParseOptions using
@@ -1061,15 +1065,15 @@ void Generator::PrintFieldDescriptor(
   // We always set message_type and enum_type to None at this point, and then
   // these fields in correctly after all referenced descriptors have been
   // defined and/or imported (see FixForeignFieldsInDescriptors()).
-  const char field_descriptor_decl[] =
+  static io::LazyPrinterTemplate field_descriptor_decl = {
     "_descriptor.FieldDescriptor(\n"
     "  name='$name$', full_name='$full_name$', index=$index$,\n"
     "  number=$number$, type=$type$, cpp_type=$cpp_type$, label=$label$,\n"
     "  has_default_value=$has_default_value$, default_value=$default_value$,\n"
     "  message_type=None, enum_type=None, containing_type=None,\n"
     "  is_extension=$is_extension$, extension_scope=None,\n"
-    "  options=$options$)";
-  printer_->Print(m, field_descriptor_decl);
+    "  options=$options$)", '$' };
+  printer_->Print(m, field_descriptor_decl.Get());
 }
 
 // Helper for Print{Fields,Extensions}InDescriptor().
@@ -37,13 +37,18 @@
 
 #ifndef _WIN32
 #include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
 #include <sys/select.h>
+#include <sys/stat.h>
 #include <sys/wait.h>
 #include <signal.h>
 #endif
 
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/message.h>
+#include <google/protobuf/stubs/once.h>
 #include <google/protobuf/stubs/substitute.h>
 
 namespace google {
@@ -143,6 +148,11 @@ void Subprocess::Start(const string& program, SearchMode search_mode) {
   free(name_copy);
 }
 
+void Subprocess::StartWithSharedMemory(const string& program,
+                                       SearchMode search_mode) {
+  Start(program, search_mode);
+}
+
 bool Subprocess::Communicate(const Message& input, Message* output,
                              string* error) {
   if (process_start_error_ != ERROR_SUCCESS) {
@@ -275,8 +285,131 @@ string Subprocess::Win32ErrorMessage(DWORD error_code) {
 
 #else  // _WIN32
 
+namespace {
+
+// The descriptor under which a subprocess started by
+// StartWithSharedMemory() finds the shared memory file.
+const int kSharedMemoryFd = 3;
+
+// What such a subprocess writes to its stdout once its response is in the
+// shared memory file; see WriteResponseToSharedMemory() in plugin.cc.  A
+// program that ignores --shared_memory_fd writes a whole response instead,
+// or nothing if the response is empty, and no valid message is this byte.
+const char kSharedMemoryAck[] = "R";
+
+// The "sighandler_t" typedef is GNU-specific, so define our own.
+typedef void SignalHandler(int);
+
+// Guards the creation of descriptors and fork() in StartProcess(), so that
+// all descriptors are close-on-exec before another thread can fork, and the
+// disabling of SIGPIPE in Communicate().
+Mutex* subprocess_mutex_ = NULL;
+GOOGLE_PROTOBUF_DECLARE_ONCE(subprocess_mutex_init_);
+
+// The number of Communicate() calls running, and the SIGPIPE handler to
+// restore when there are none.  Under subprocess_mutex_.
+int communicating_ = 0;
+SignalHandler* old_pipe_handler_ = NULL;
+
+void DeleteSubprocessMutex() {
+  delete subprocess_mutex_;
+  subprocess_mutex_ = NULL;
+}
+
+void InitSubprocessMutex() {
+  subprocess_mutex_ = new Mutex;
+  internal::OnShutdown(&DeleteSubprocessMutex);
+}
+
+Mutex* SubprocessMutex() {
+  GoogleOnceInit(&subprocess_mutex_init_, &InitSubprocessMutex);
+  return subprocess_mutex_;
+}
+
+void SetCloseOnExec(int fd) {
+  GOOGLE_CHECK(fcntl(fd, F_SETFD, FD_CLOEXEC) != -1)
+      << "fcntl: " << strerror(errno);
+}
+
+// Returns a new, empty, close-on-exec file for sharing memory with a
+// subprocess, or -1 if none could be created.  Must be called under
+// subprocess_mutex_.
+int CreateSharedMemoryFile() {
+  int fd;
+#ifdef MFD_CLOEXEC
+  fd = memfd_create("protoc", MFD_CLOEXEC);
+  if (fd != -1) return fd;
+#endif
+
+  // Fall back to an unlinked temporary file, which is as good where the
+  // temporary directory is in memory.
+  const char* tmpdir = getenv("TMPDIR");
+  string path = tmpdir != NULL && *tmpdir != '\0' ? tmpdir : "/tmp";
+  path += "/protoc-XXXXXX";
+  char* name = strdup(path.c_str());
+  fd = mkstemp(name);
+  if (fd != -1) {
+    unlink(name);
+    SetCloseOnExec(fd);
+  }
+  free(name);
+  return fd;
+}
+
+// Replaces the contents of the shared memory file |fd| with |message|.
+bool WriteToSharedMemory(const Message& message, int fd, string* error) {
+  int size = message.ByteSize();
+  if (ftruncate(fd, size) == -1) {
+    *error = string("ftruncate: ") + strerror(errno);
+    return false;
+  }
+  if (size == 0) return true;
+
+  void* data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    *error = string("mmap: ") + strerror(errno);
+    return false;
+  }
+  message.SerializeWithCachedSizesToArray(reinterpret_cast<uint8*>(data));
+  munmap(data, size);
+  return true;
+}
+
+// Parses the contents of the shared memory file |fd| into *message.
+bool ReadFromSharedMemory(int fd, Message* message, string* error) {
+  struct stat info;
+  if (fstat(fd, &info) == -1) {
+    *error = string("fstat: ") + strerror(errno);
+    return false;
+  }
+  if (info.st_size > kint32max) {
+    *error = "Plugin output is too large.";
+    return false;
+  }
+  int size = info.st_size;
+
+  void* data = NULL;
+  if (size > 0) {
+    data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+      *error = string("mmap: ") + strerror(errno);
+      return false;
+    }
+  }
+  bool parsed = message->ParseFromArray(data, size);
+  if (!parsed) {
+    *error = "Plugin output is unparseable: " +
+             CEscape(string(reinterpret_cast<const char*>(data), size));
+  }
+  if (size > 0) munmap(data, size);
+  return parsed;
+}
+
+}  // namespace
+
 Subprocess::Subprocess()
-    : child_pid_(-1), child_stdin_(-1), child_stdout_(-1) {}
+    : child_pid_(-1), child_stdin_(-1), child_stdout_(-1),
+      shared_memory_(-1) {}
 
 Subprocess::~Subprocess() {
   if (child_stdin_ != -1) {
@@ -285,33 +418,59 @@ Subprocess::~Subprocess() {
   if (child_stdout_ != -1) {
     close(child_stdout_);
   }
+  if (shared_memory_ != -1) {
+    close(shared_memory_);
+  }
 }
 
 void Subprocess::Start(const string& program, SearchMode search_mode) {
-  // Note that we assume that there are no other threads, thus we don't have to
-  // do crazy stuff like using socket pairs or avoiding libc locks.
+  StartProcess(program, search_mode, false);
+}
+
+void Subprocess::StartWithSharedMemory(const string& program,
+                                       SearchMode search_mode) {
+  StartProcess(program, search_mode, true);
+}
+
+void Subprocess::StartProcess(const string& program, SearchMode search_mode,
+                              bool shared_memory) {
+  // Other threads may be starting subprocesses too.  Every descriptor we
+  // create is close-on-exec, so that their children don't inherit it, and the
+  // child only makes async-signal-safe calls between fork() and exec().
 
   // [0] is read end, [1] is write end.
   int stdin_pipe[2];
   int stdout_pipe[2];
 
+  char* argv[3] = { strdup(program.c_str()), NULL, NULL };
+
+  MutexLock lock(SubprocessMutex());
+
   GOOGLE_CHECK(pipe(stdin_pipe) != -1);
   GOOGLE_CHECK(pipe(stdout_pipe) != -1);
-
-  char* argv[2] = { strdup(program.c_str()), NULL };
+  SetCloseOnExec(stdin_pipe[0]);
+  SetCloseOnExec(stdin_pipe[1]);
+  SetCloseOnExec(stdout_pipe[0]);
+  SetCloseOnExec(stdout_pipe[1]);
+
+  if (shared_memory) {
+    shared_memory_ = CreateSharedMemoryFile();
+    if (shared_memory_ != -1) {
+      argv[1] = strdup(strings::Substitute(
+          "--shared_memory_fd=$0", kSharedMemoryFd).c_str());
+    }
+  }
 
   child_pid_ = fork();
   if (child_pid_ == -1) {
     GOOGLE_LOG(FATAL) << "fork: " << strerror(errno);
   } else if (child_pid_ == 0) {
-    // We are the child.
+    // We are the child.  The copies dup2() makes are not close-on-exec.
     dup2(stdin_pipe[0], STDIN_FILENO);
     dup2(stdout_pipe[1], STDOUT_FILENO);
-
-    close(stdin_pipe[0]);
-    close(stdin_pipe[1]);
-    close(stdout_pipe[0]);
-    close(stdout_pipe[1]);
+    if (shared_memory_ != -1) {
+      dup2(shared_memory_, kSharedMemoryFd);
+    }
 
     switch (search_mode) {
       case SEARCH_PATH:
@@ -335,6 +494,7 @@ void Subprocess::Start(const string& program, SearchMode search_mode) {
     _exit(1);
   } else {
     free(argv[0]);
+    free(argv[1]);
 
     close(stdin_pipe[0]);
     close(stdout_pipe[1]);
@@ -349,14 +509,25 @@ bool Subprocess::Communicate(const Message& input, Message* output,
 
   GOOGLE_CHECK_NE(child_stdin_, -1) << "Must call Start() first.";
 
-  // The "sighandler_t" typedef is GNU-specific, so define our own.
-  typedef void SignalHandler(int);
-
   // Make sure SIGPIPE is disabled so that if the child dies it doesn't kill us.
-  SignalHandler* old_pipe_handler = signal(SIGPIPE, SIG_IGN);
+  {
+    MutexLock lock(SubprocessMutex());
+    if (communicating_++ == 0) {
+      old_pipe_handler_ = signal(SIGPIPE, SIG_IGN);
+    }
+  }
 
-  string input_data = input.SerializeAsString();
+  // With shared memory, the input goes in the shared memory file and closing
+  // the child's stdin tells it that the input is ready.  If that fails, we
+  // still let the child run to completion before reporting the error.
+  string input_data;
   string output_data;
+  string shared_memory_error;
+  if (shared_memory_ != -1) {
+    WriteToSharedMemory(input, shared_memory_, &shared_memory_error);
+  } else {
+    input_data = input.SerializeAsString();
+  }
 
   int input_pos = 0;
   int max_fd = max(child_stdin_, child_stdout_);
@@ -429,7 +600,12 @@ bool Subprocess::Communicate(const Message& input, Message* output,
   }
 
   // Restore SIGPIPE handling.
-  signal(SIGPIPE, old_pipe_handler);
+  {
+    MutexLock lock(SubprocessMutex());
+    if (--communicating_ == 0) {
+      signal(SIGPIPE, old_pipe_handler_);
+    }
+  }
 
   if (WIFEXITED(status)) {
     if (WEXITSTATUS(status) != 0) {
@@ -448,6 +624,20 @@ bool Subprocess::Communicate(const Message& input, Message* output,
     return false;
   }
 
+  if (shared_memory_ != -1) {
+    if (!shared_memory_error.empty()) {
+      *error = shared_memory_error;
+      return false;
+    }
+    if (output_data != kSharedMemoryAck) {
+      // The file still holds our request.
+      *error = "Plugin does not support shared_memory; it ignored "
+               "--shared_memory_fd and wrote its output to stdout.";
+      return false;
+    }
+    return ReadFromSharedMemory(shared_memory_, output, error);
+  }
+
   if (!output->ParseFromString(output_data)) {
     *error = "Plugin output is unparseable: " + CEscape(output_data);
     return false;
@@ -53,6 +53,9 @@ class Message;
 namespace compiler {
 
 // Utility class for launching sub-processes.
+//
+// Except on Windows, several threads may each start and communicate with
+// their own Subprocess at the same time.
 class LIBPROTOC_EXPORT Subprocess {
  public:
   Subprocess();
@@ -67,6 +70,13 @@ class LIBPROTOC_EXPORT Subprocess {
   // arguments as protoc plugins don't have any.
   void Start(const string& program, SearchMode search_mode);
 
+  // Like Start(), but Communicate() passes the messages through a shared
+  // memory file rather than the pipes, which avoids copying them through the
+  // kernel.  The program is given the file as descriptor 3 and the argument
+  // "--shared_memory_fd=3"; see plugin.h.  Where shared memory files are not
+  // available this is the same as Start(), and the program gets no argument.
+  void StartWithSharedMemory(const string& program, SearchMode search_mode);
+
   // Serialize the input message and pipe it to the subprocess's stdin, then
   // close the pipe.  Meanwhile, read from the subprocess's stdout and parse
   // the data into *output.  All this is done carefully to avoid deadlocks.
@@ -91,6 +101,9 @@ class LIBPROTOC_EXPORT Subprocess {
   HANDLE child_stdout_;
 
 #else  // _WIN32
+  void StartProcess(const string& program, SearchMode search_mode,
+                    bool shared_memory);
+
   pid_t child_pid_;
 
   // The file descriptors for our end of the child's pipes.  We close each and
@@ -98,6 +111,9 @@ class LIBPROTOC_EXPORT Subprocess {
   int child_stdin_;
   int child_stdout_;
 
+  // Our descriptor for the shared memory file, or -1 if there is none.
+  int shared_memory_;
+
 #endif  // !_WIN32
 };
 
@@ -498,12 +498,28 @@ class DescriptorPool::Tables {
   // Allocate a FileDescriptorTables object.
   FileDescriptorTables* AllocateFileTables();
 
+  // -----------------------------------------------------------------
+  // Memory accounting.
+
+  // Returns an estimate of the number of bytes used by everything allocated
+  // through this object, including the lookup tables themselves.
+  int64 SpaceUsed() const;
+
  private:
   vector<string*> strings_;    // All strings in the pool.
   vector<Message*> messages_;  // All messages in the pool.
   vector<FileDescriptorTables*> file_tables_;  // All file tables in the pool.
   vector<void*> allocations_;  // All other memory allocated in the pool.
 
+  // Descriptors, arrays and strings are small and numerous, and are never
+  // freed individually, so AllocateBytes() carves them out of larger blocks
+  // rather than calling operator new for each one.  block_pos_ points at the
+  // unused tail of the most recently allocated block, which is
+  // block_remaining_ bytes long.
+  char* block_pos_;
+  int block_remaining_;
+  int64 allocated_bytes_;  // Sum of the sizes of allocations_.
+
   SymbolsByNameMap      symbols_by_name_;
   FilesByNameMap        files_by_name_;
   ExtensionsGroupedByDescriptorMap extensions_;
@@ -514,6 +530,9 @@ class DescriptorPool::Tables {
         messages_before_checkpoint(tables->messages_.size()),
         file_tables_before_checkpoint(tables->file_tables_.size()),
         allocations_before_checkpoint(tables->allocations_.size()),
+        block_pos_before_checkpoint(tables->block_pos_),
+        block_remaining_before_checkpoint(tables->block_remaining_),
+        allocated_bytes_before_checkpoint(tables->allocated_bytes_),
         pending_symbols_before_checkpoint(
             tables->symbols_after_checkpoint_.size()),
         pending_files_before_checkpoint(
@@ -525,6 +544,9 @@ class DescriptorPool::Tables {
     int messages_before_checkpoint;
     int file_tables_before_checkpoint;
     int allocations_before_checkpoint;
+    char* block_pos_before_checkpoint;
+    int block_remaining_before_checkpoint;
+    int64 allocated_bytes_before_checkpoint;
     int pending_symbols_before_checkpoint;
     int pending_files_before_checkpoint;
     int pending_extensions_before_checkpoint;
@@ -567,13 +589,17 @@ class FileDescriptorTables {
                                        const string& name,
                                        const Symbol::Type type) const;
 
-  // These return NULL if not found.
+  // These return NULL if not found.  The lowercase- and camelcase-name
+  // lookups take the file the tables belong to, since the tables backing them
+  // are built from it on first use.
   inline const FieldDescriptor* FindFieldByNumber(
     const Descriptor* parent, int number) const;
   inline const FieldDescriptor* FindFieldByLowercaseName(
-    const void* parent, const string& lowercase_name) const;
+    const FileDescriptor* file, const void* parent,
+    const string& lowercase_name) const;
   inline const FieldDescriptor* FindFieldByCamelcaseName(
-    const void* parent, const string& camelcase_name) const;
+    const FileDescriptor* file, const void* parent,
+    const string& camelcase_name) const;
   inline const EnumValueDescriptor* FindEnumValueByNumber(
     const EnumDescriptor* parent, int number) const;
   // This creates a new EnumValueDescriptor if not found, in a thread-safe way.
@@ -592,9 +618,11 @@ class FileDescriptorTables {
   bool AddFieldByNumber(const FieldDescriptor* field);
   bool AddEnumValueByNumber(const EnumValueDescriptor* value);
 
-  // Adds the field to the lowercase_name and camelcase_name maps.  Never
-  // fails because we allow duplicates; the first field by the name wins.
-  void AddFieldByStylizedNames(const FieldDescriptor* field);
+  // Populates p->first->fields_by_lowercase_name_ and
+  // p->first->fields_by_camelcase_name_ from the fields and extensions of
+  // p->second.  Unusual signature dictated by GoogleOnceDynamic.
+  static void BuildFieldsByStylizedNames(
+      pair<const FileDescriptorTables*, const FileDescriptor*>* p);
 
   // Populates p->first->locations_by_path_ from p->second.
   // Unusual signature dictated by GoogleOnceDynamic.
@@ -608,16 +636,27 @@ class FileDescriptorTables {
   const SourceCodeInfo_Location* GetSourceLocation(
       const vector<int>& path, const SourceCodeInfo* info) const;
 
+  // Returns an estimate of the number of bytes used by these tables.
+  int64 SpaceUsed() const;
+
  private:
+  // Adds the field to the lowercase_name and camelcase_name maps.  Never
+  // fails because we allow duplicates; the first field by the name wins.
+  void AddFieldByStylizedNames(const FieldDescriptor* field) const;
+  void AddFieldsByStylizedNames(const Descriptor* message) const;
+
   SymbolsByParentMap    symbols_by_parent_;
-  FieldsByNameMap       fields_by_lowercase_name_;
-  FieldsByNameMap       fields_by_camelcase_name_;
   FieldsByNumberMap     fields_by_number_;       // Not including extensions.
   EnumValuesByNumberMap enum_values_by_number_;
   mutable EnumValuesByNumberMap unknown_enum_values_by_number_
       GOOGLE_GUARDED_BY(unknown_enum_values_mu_);
 
-  // Populated on first request to save space, hence constness games.
+  // Populated on first request to save space, hence constness games.  Few
+  // programs ever look fields up by their lowercase or camelcase names, so
+  // there is no point in paying for these tables up front.
+  mutable GoogleOnceDynamic fields_by_stylized_names_once_;
+  mutable FieldsByNameMap fields_by_lowercase_name_;
+  mutable FieldsByNameMap fields_by_camelcase_name_;
   mutable GoogleOnceDynamic locations_by_path_once_;
   mutable LocationsByPathMap locations_by_path_;
 
@@ -631,6 +670,9 @@ DescriptorPool::Tables::Tables()
     : known_bad_files_(3),
       known_bad_symbols_(3),
       extensions_loaded_from_db_(3),
+      block_pos_(NULL),
+      block_remaining_(0),
+      allocated_bytes_(0),
       symbols_by_name_(3),
       files_by_name_(3) {}
 
@@ -638,23 +680,26 @@ DescriptorPool::Tables::Tables()
 DescriptorPool::Tables::~Tables() {
   GOOGLE_DCHECK(checkpoints_.empty());
   // Note that the deletion order is important, since the destructors of some
-  // messages may refer to objects in allocations_.
+  // messages may refer to objects in allocations_, and the strings themselves
+  // live in allocations_.
   STLDeleteElements(&messages_);
+  for (int i = 0; i < strings_.size(); i++) {
+    strings_[i]->~string();
+  }
   for (int i = 0; i < allocations_.size(); i++) {
     operator delete(allocations_[i]);
   }
-  STLDeleteElements(&strings_);
   STLDeleteElements(&file_tables_);
 }
 
 FileDescriptorTables::FileDescriptorTables()
     // Initialize all the hash tables to start out with a small # of buckets
     : symbols_by_parent_(3),
-      fields_by_lowercase_name_(3),
-      fields_by_camelcase_name_(3),
       fields_by_number_(3),
       enum_values_by_number_(3),
-      unknown_enum_values_by_number_(3) {
+      unknown_enum_values_by_number_(3),
+      fields_by_lowercase_name_(3),
+      fields_by_camelcase_name_(3) {
 }
 
 FileDescriptorTables::~FileDescriptorTables() {}
@@ -703,11 +748,14 @@ void DescriptorPool::Tables::RollbackToLastCheckpoint() {
   extensions_after_checkpoint_.resize(
       checkpoint.pending_extensions_before_checkpoint);
 
-  STLDeleteContainerPointers(
-      strings_.begin() + checkpoint.strings_before_checkpoint, strings_.end());
   STLDeleteContainerPointers(
       messages_.begin() + checkpoint.messages_before_checkpoint,
       messages_.end());
+  for (int i = checkpoint.strings_before_checkpoint;
+       i < strings_.size();
+       i++) {
+    strings_[i]->~string();
+  }
   STLDeleteContainerPointers(
       file_tables_.begin() + checkpoint.file_tables_before_checkpoint,
       file_tables_.end());
@@ -721,6 +769,12 @@ void DescriptorPool::Tables::RollbackToLastCheckpoint() {
   messages_.resize(checkpoint.messages_before_checkpoint);
   file_tables_.resize(checkpoint.file_tables_before_checkpoint);
   allocations_.resize(checkpoint.allocations_before_checkpoint);
+  // Any block allocated since the checkpoint is gone now, but the block that
+  // was current at the time of the checkpoint is not, so we can just resume
+  // carving from where it left off.
+  block_pos_ = checkpoint.block_pos_before_checkpoint;
+  block_remaining_ = checkpoint.block_remaining_before_checkpoint;
+  allocated_bytes_ = checkpoint.allocated_bytes_before_checkpoint;
   checkpoints_.pop_back();
 }
 
@@ -787,13 +841,23 @@ inline const FieldDescriptor* FileDescriptorTables::FindFieldByNumber(
 }
 
 inline const FieldDescriptor* FileDescriptorTables::FindFieldByLowercaseName(
-    const void* parent, const string& lowercase_name) const {
+    const FileDescriptor* file, const void* parent,
+    const string& lowercase_name) const {
+  pair<const FileDescriptorTables*, const FileDescriptor*> p(
+      std::make_pair(this, file));
+  fields_by_stylized_names_once_.Init(
+      &FileDescriptorTables::BuildFieldsByStylizedNames, &p);
   return FindPtrOrNull(fields_by_lowercase_name_,
                        PointerStringPair(parent, lowercase_name.c_str()));
 }
 
 inline const FieldDescriptor* FileDescriptorTables::FindFieldByCamelcaseName(
-    const void* parent, const string& camelcase_name) const {
+    const FileDescriptor* file, const void* parent,
+    const string& camelcase_name) const {
+  pair<const FileDescriptorTables*, const FileDescriptor*> p(
+      std::make_pair(this, file));
+  fields_by_stylized_names_once_.Init(
+      &FileDescriptorTables::BuildFieldsByStylizedNames, &p);
   return FindPtrOrNull(fields_by_camelcase_name_,
                        PointerStringPair(parent, camelcase_name.c_str()));
 }
@@ -898,7 +962,7 @@ bool DescriptorPool::Tables::AddFile(const FileDescriptor* file) {
 }
 
 void FileDescriptorTables::AddFieldByStylizedNames(
-    const FieldDescriptor* field) {
+    const FieldDescriptor* field) const {
   const void* parent;
   if (field->is_extension()) {
     if (field->extension_scope() == NULL) {
@@ -917,6 +981,32 @@ void FileDescriptorTables::AddFieldByStylizedNames(
   InsertIfNotPresent(&fields_by_camelcase_name_, camelcase_key, field);
 }
 
+void FileDescriptorTables::AddFieldsByStylizedNames(
+    const Descriptor* message) const {
+  // Visit fields in the same order DescriptorBuilder::CrossLinkMessage()
+  // does, so that the same field wins when two names collide.
+  for (int i = 0; i < message->nested_type_count(); i++) {
+    AddFieldsByStylizedNames(message->nested_type(i));
+  }
+  for (int i = 0; i < message->field_count(); i++) {
+    AddFieldByStylizedNames(message->field(i));
+  }
+  for (int i = 0; i < message->extension_count(); i++) {
+    AddFieldByStylizedNames(message->extension(i));
+  }
+}
+
+void FileDescriptorTables::BuildFieldsByStylizedNames(
+    pair<const FileDescriptorTables*, const FileDescriptor*>* p) {
+  const FileDescriptor* file = p->second;
+  for (int i = 0; i < file->message_type_count(); i++) {
+    p->first->AddFieldsByStylizedNames(file->message_type(i));
+  }
+  for (int i = 0; i < file->extension_count(); i++) {
+    p->first->AddFieldByStylizedNames(file->extension(i));
+  }
+}
+
 bool FileDescriptorTables::AddFieldByNumber(const FieldDescriptor* field) {
   DescriptorIntPair key(field->containing_type(), field->number());
   return InsertIfNotPresent(&fields_by_number_, key, field);
@@ -951,7 +1041,7 @@ Type* DescriptorPool::Tables::AllocateArray(int count) {
 }
 
 string* DescriptorPool::Tables::AllocateString(const string& value) {
-  string* result = new string(value);
+  string* result = new(AllocateBytes(sizeof(string))) string(value);
   strings_.push_back(result);
   return result;
 }
@@ -969,18 +1059,86 @@ FileDescriptorTables* DescriptorPool::Tables::AllocateFileTables() {
   return result;
 }
 
+namespace {
+
+// Size of the blocks AllocateBytes() carves small allocations out of.
+// Requests larger than kMaxBlockAllocation get an allocation of their own, so
+// that a large array never wastes the tail of a partially-used block.
+const int kAllocationBlockSize = 4096;
+const int kMaxBlockAllocation = kAllocationBlockSize / 4;
+
+// Everything stored in the pool (pointers, int64 and double default values,
+// strings) is fine with 8-byte alignment.
+const int kAllocationAlignment = 8;
+
+// Rough per-entry cost of a node-based container, on top of the entry itself.
+template <typename Container>
+int64 ContainerSpaceUsed(const Container& container) {
+  return static_cast<int64>(container.size()) *
+      (sizeof(typename Container::value_type) + 2 * sizeof(void*));
+}
+
+template <typename T>
+int64 VectorSpaceUsed(const vector<T>& v) {
+  return static_cast<int64>(v.capacity()) * sizeof(T);
+}
+
+}  // namespace
+
 void* DescriptorPool::Tables::AllocateBytes(int size) {
-  // TODO(kenton):  Would it be worthwhile to implement this in some more
-  // sophisticated way?  Probably not for the open source release, but for
-  // internal use we could easily plug in one of our existing memory pool
-  // allocators...
   if (size == 0) return NULL;
 
-  void* result = operator new(size);
-  allocations_.push_back(result);
+  size = (size + kAllocationAlignment - 1) & ~(kAllocationAlignment - 1);
+  if (size > kMaxBlockAllocation) {
+    void* result = operator new(size);
+    allocations_.push_back(result);
+    allocated_bytes_ += size;
+    return result;
+  }
+
+  if (size > block_remaining_) {
+    block_pos_ = reinterpret_cast<char*>(operator new(kAllocationBlockSize));
+    block_remaining_ = kAllocationBlockSize;
+    allocations_.push_back(block_pos_);
+    allocated_bytes_ += kAllocationBlockSize;
+  }
+
+  void* result = block_pos_;
+  block_pos_ += size;
+  block_remaining_ -= size;
   return result;
 }
 
+int64 DescriptorPool::Tables::SpaceUsed() const {
+  int64 total = sizeof(*this) + allocated_bytes_;
+
+  for (int i = 0; i < strings_.size(); i++) {
+    // The string objects themselves were counted in allocated_bytes_.
+    total += internal::StringSpaceUsedExcludingSelf(*strings_[i]);
+  }
+  for (int i = 0; i < messages_.size(); i++) {
+    total += messages_[i]->SpaceUsed();
+  }
+  for (int i = 0; i < file_tables_.size(); i++) {
+    total += file_tables_[i]->SpaceUsed();
+  }
+
+  total += ContainerSpaceUsed(symbols_by_name_);
+  total += ContainerSpaceUsed(files_by_name_);
+  total += ContainerSpaceUsed(extensions_);
+  total += ContainerSpaceUsed(known_bad_files_);
+  total += ContainerSpaceUsed(known_bad_symbols_);
+  total += ContainerSpaceUsed(extensions_loaded_from_db_);
+  total += VectorSpaceUsed(strings_);
+  total += VectorSpaceUsed(messages_);
+  total += VectorSpaceUsed(file_tables_);
+  total += VectorSpaceUsed(allocations_);
+  total += VectorSpaceUsed(symbols_after_checkpoint_);
+  total += VectorSpaceUsed(files_after_checkpoint_);
+  total += VectorSpaceUsed(extensions_after_checkpoint_);
+  return total;
+}
+
 void FileDescriptorTables::BuildLocationsByPath(
     pair<const FileDescriptorTables*, const SourceCodeInfo*>* p) {
   for (int i = 0, len = p->second->location_size(); i < len; ++i) {
@@ -997,6 +1155,21 @@ const SourceCodeInfo_Location* FileDescriptorTables::GetSourceLocation(
   return FindPtrOrNull(locations_by_path_, Join(path, ","));
 }
 
+int64 FileDescriptorTables::SpaceUsed() const {
+  int64 total = sizeof(*this);
+  total += ContainerSpaceUsed(symbols_by_parent_);
+  total += ContainerSpaceUsed(fields_by_number_);
+  total += ContainerSpaceUsed(enum_values_by_number_);
+  {
+    ReaderMutexLock l(&unknown_enum_values_mu_);
+    total += ContainerSpaceUsed(unknown_enum_values_by_number_);
+  }
+  total += ContainerSpaceUsed(fields_by_lowercase_name_);
+  total += ContainerSpaceUsed(fields_by_camelcase_name_);
+  total += ContainerSpaceUsed(locations_by_path_);
+  return total;
+}
+
 // ===================================================================
 // DescriptorPool
 
@@ -1058,6 +1231,11 @@ bool DescriptorPool::InternalIsFileLoaded(const string& filename) const {
   return tables_->FindFile(filename) != NULL;
 }
 
+int64 DescriptorPool::SpaceUsed() const {
+  MutexLockMaybe lock(mutex_);
+  return sizeof(*this) + tables_->SpaceUsed();
+}
+
 // generated_pool ====================================================
 
 namespace {
@@ -1295,7 +1473,7 @@ Descriptor::FindFieldByNumber(int key) const {
 const FieldDescriptor*
 Descriptor::FindFieldByLowercaseName(const string& key) const {
   const FieldDescriptor* result =
-    file()->tables_->FindFieldByLowercaseName(this, key);
+    file()->tables_->FindFieldByLowercaseName(file(), this, key);
   if (result == NULL || result->is_extension()) {
     return NULL;
   } else {
@@ -1306,7 +1484,7 @@ Descriptor::FindFieldByLowercaseName(const string& key) const {
 const FieldDescriptor*
 Descriptor::FindFieldByCamelcaseName(const string& key) const {
   const FieldDescriptor* result =
-    file()->tables_->FindFieldByCamelcaseName(this, key);
+    file()->tables_->FindFieldByCamelcaseName(file(), this, key);
   if (result == NULL || result->is_extension()) {
     return NULL;
   } else {
@@ -1350,7 +1528,7 @@ Descriptor::FindExtensionByName(const string& key) const {
 const FieldDescriptor*
 Descriptor::FindExtensionByLowercaseName(const string& key) const {
   const FieldDescriptor* result =
-    file()->tables_->FindFieldByLowercaseName(this, key);
+    file()->tables_->FindFieldByLowercaseName(file(), this, key);
   if (result == NULL || !result->is_extension()) {
     return NULL;
   } else {
@@ -1361,7 +1539,7 @@ Descriptor::FindExtensionByLowercaseName(const string& key) const {
 const FieldDescriptor*
 Descriptor::FindExtensionByCamelcaseName(const string& key) const {
   const FieldDescriptor* result =
-    file()->tables_->FindFieldByCamelcaseName(this, key);
+    file()->tables_->FindFieldByCamelcaseName(file(), this, key);
   if (result == NULL || !result->is_extension()) {
     return NULL;
   } else {
@@ -1487,7 +1665,8 @@ FileDescriptor::FindExtensionByName(const string& key) const {
 
 const FieldDescriptor*
 FileDescriptor::FindExtensionByLowercaseName(const string& key) const {
-  const FieldDescriptor* result = tables_->FindFieldByLowercaseName(this, key);
+  const FieldDescriptor* result =
+      tables_->FindFieldByLowercaseName(this, this, key);
   if (result == NULL || !result->is_extension()) {
     return NULL;
   } else {
@@ -1497,7 +1676,8 @@ FileDescriptor::FindExtensionByLowercaseName(const string& key) const {
 
 const FieldDescriptor*
 FileDescriptor::FindExtensionByCamelcaseName(const string& key) const {
-  const FieldDescriptor* result = tables_->FindFieldByCamelcaseName(this, key);
+  const FieldDescriptor* result =
+      tables_->FindFieldByCamelcaseName(this, this, key);
   if (result == NULL || !result->is_extension()) {
     return NULL;
   } else {
@@ -3993,12 +4173,14 @@ void DescriptorBuilder::BuildFieldOrExtension(const FieldDescriptorProto& proto,
     result->lowercase_name_ = tables_->AllocateString(lowercase_name);
   }
 
-  // Don't bother with the above optimization for camel-case names since
-  // .proto files that follow the guide shouldn't be using names in this
-  // format, so the optimization wouldn't help much.
-  result->camelcase_name_ =
-      tables_->AllocateString(ToCamelCase(proto.name(),
-                                          /* lower_first = */ true));
+  // Single-word names (which are very common) are their own camel-case
+  // names, so the same trick applies here.
+  string camelcase_name(ToCamelCase(proto.name(), /* lower_first = */ true));
+  if (camelcase_name == proto.name()) {
+    result->camelcase_name_ = result->name_;
+  } else {
+    result->camelcase_name_ = tables_->AllocateString(camelcase_name);
+  }
 
   // Some compilers do not allow static_cast directly between two enum types,
   // so we must cast to int first.
@@ -4744,9 +4926,6 @@ void DescriptorBuilder::CrossLinkField(
       }
     }
   }
-
-  // Add the field to the lowercase-name and camelcase-name tables.
-  file_tables_->AddFieldByStylizedNames(field);
 }
 
 void DescriptorBuilder::CrossLinkEnum(
@@ -1413,6 +1413,16 @@ class LIBPROTOBUF_EXPORT DescriptorPool {
   // DescriptorPool will report a import not found error.
   void EnforceWeakDependencies(bool enforce) { enforce_weak_ = enforce; }
 
+  // Memory usage ----------------------------------------------------
+
+  // Computes (an estimate of) the total number of bytes currently used by
+  // this pool: the descriptors themselves, their names and options, and the
+  // tables used to look them up.  Descriptors in the underlay and data held
+  // by the fallback database are not included.  This is intended for
+  // diagnostics; it must not be called while other threads are looking up
+  // descriptors in the pool.
+  int64 SpaceUsed() const;
+
   // Internal stuff --------------------------------------------------
   // These methods MUST NOT be called from outside the proto2 library.
   // These methods may contain hidden pitfalls and may be removed in a
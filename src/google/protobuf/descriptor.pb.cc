@@ -1418,7 +1418,7 @@ void FileDescriptorProto::SerializeWithCachedSizes(
     this->dependency(i).data(), this->dependency(i).length(),
     ::google::protobuf::internal::WireFormat::SERIALIZE,
     "google.protobuf.FileDescriptorProto.dependency");
-    ::google::protobuf::internal::WireFormatLite::WriteString(
+    ::google::protobuf::internal::WireFormatLite::WriteStringMaybeAliased(
       3, this->dependency(i), output);
   }
 
@@ -12358,7 +12358,7 @@ void SourceCodeInfo_Location::SerializeWithCachedSizes(
     this->leading_detached_comments(i).data(), this->leading_detached_comments(i).length(),
     ::google::protobuf::internal::WireFormat::SERIALIZE,
     "google.protobuf.SourceCodeInfo.Location.leading_detached_comments");
-    ::google::protobuf::internal::WireFormatLite::WriteString(
+    ::google::protobuf::internal::WireFormatLite::WriteStringMaybeAliased(
       6, this->leading_detached_comments(i), output);
   }
 
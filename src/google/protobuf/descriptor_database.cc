@@ -34,6 +34,20 @@
 
 #include <google/protobuf/descriptor_database.h>
 
+#include <errno.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#ifdef _MSC_VER
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+#include <algorithm>
 #include <set>
 
 #include <google/protobuf/descriptor.pb.h>
@@ -45,6 +59,39 @@
 namespace google {
 namespace protobuf {
 
+#ifndef O_BINARY
+#ifdef _O_BINARY
+#define O_BINARY _O_BINARY
+#else
+#define O_BINARY 0     // If this isn't defined, the platform doesn't need it.
+#endif
+#endif
+
+namespace {
+
+// Returns true if sub_symbol names super_symbol itself or a symbol nested
+// inside it.
+bool IsSubSymbolOf(const string& sub_symbol, const string& super_symbol) {
+  return sub_symbol == super_symbol ||
+         (HasPrefixString(super_symbol, sub_symbol) &&
+             super_symbol[sub_symbol.size()] == '.');
+}
+
+bool IsValidSymbolName(const string& name) {
+  for (int i = 0; i < name.size(); i++) {
+    // I don't trust ctype.h due to locales.  :(
+    if (name[i] != '.' && name[i] != '_' &&
+        (name[i] < '0' || name[i] > '9') &&
+        (name[i] < 'A' || name[i] > 'Z') &&
+        (name[i] < 'a' || name[i] > 'z')) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
 DescriptorDatabase::~DescriptorDatabase() {}
 
 // ===================================================================
@@ -225,24 +272,13 @@ SimpleDescriptorDatabase::DescriptorIndex<Value>::FindLastLessOrEqual(
 template <typename Value>
 bool SimpleDescriptorDatabase::DescriptorIndex<Value>::IsSubSymbol(
     const string& sub_symbol, const string& super_symbol) {
-  return sub_symbol == super_symbol ||
-         (HasPrefixString(super_symbol, sub_symbol) &&
-             super_symbol[sub_symbol.size()] == '.');
+  return IsSubSymbolOf(sub_symbol, super_symbol);
 }
 
 template <typename Value>
 bool SimpleDescriptorDatabase::DescriptorIndex<Value>::ValidateSymbolName(
     const string& name) {
-  for (int i = 0; i < name.size(); i++) {
-    // I don't trust ctype.h due to locales.  :(
-    if (name[i] != '.' && name[i] != '_' &&
-        (name[i] < '0' || name[i] > '9') &&
-        (name[i] < 'A' || name[i] > 'Z') &&
-        (name[i] < 'a' || name[i] > 'z')) {
-      return false;
-    }
-  }
-  return true;
+  return IsValidSymbolName(name);
 }
 
 // -------------------------------------------------------------------
@@ -298,7 +334,545 @@ bool SimpleDescriptorDatabase::MaybeCopy(const FileDescriptorProto* file,
 
 // -------------------------------------------------------------------
 
-EncodedDescriptorDatabase::EncodedDescriptorDatabase() {}
+namespace {
+
+// The parts of an encoded FileDescriptorProto which the
+// EncodedDescriptorDatabase index needs.
+struct FileIndexInfo {
+  string name;
+  string package;
+  vector<string> top_level_names;           // Messages, enums, services,
+                                            // and extensions.
+  vector<pair<string, int> > extensions;    // (extendee, number) of every
+                                            // extension with a fully-
+                                            // qualified extendee.
+};
+
+typedef internal::WireFormatLite WFL;
+
+bool IsLengthDelimited(uint32 tag) {
+  return WFL::GetTagWireType(tag) == WFL::WIRETYPE_LENGTH_DELIMITED;
+}
+
+// Reads a length-delimited string.
+bool ScanString(io::CodedInputStream* input, string* value) {
+  return WFL::ReadString(input, value);
+}
+
+// Each of the Scan*() functions below reads the fields of one message,
+// skipping everything the index does not need.  ScanSubmessage() takes care
+// of the length prefix and recursion limit for them.
+
+template <typename Arg1, typename Arg2>
+bool ScanSubmessage(io::CodedInputStream* input,
+                    bool (*scan)(io::CodedInputStream*, Arg1, Arg2),
+                    Arg1 arg1, Arg2 arg2) {
+  uint32 length;
+  if (!input->ReadVarint32(&length)) return false;
+  if (!input->IncrementRecursionDepth()) return false;
+  io::CodedInputStream::Limit limit = input->PushLimit(length);
+  bool result = scan(input, arg1, arg2) && input->ConsumedEntireMessage();
+  input->PopLimit(limit);
+  input->DecrementRecursionDepth();
+  return result;
+}
+
+// EnumDescriptorProto or ServiceDescriptorProto.
+bool ScanNamedMessage(io::CodedInputStream* input, string* name) {
+  while (true) {
+    uint32 tag = input->ReadTag();
+    if (tag == 0) return true;
+    if (WFL::GetTagFieldNumber(tag) == 1 && IsLengthDelimited(tag)) {
+      if (!ScanString(input, name)) return false;
+    } else if (!WFL::SkipField(input, tag)) {
+      return false;
+    }
+  }
+}
+
+// Adapts ScanNamedMessage() to ScanSubmessage().
+bool ScanNamed(io::CodedInputStream* input, string* name, void* /* unused */) {
+  return ScanNamedMessage(input, name);
+}
+
+// FieldDescriptorProto.  Records the field in info->extensions if it is an
+// extension of a fully-qualified type.
+bool ScanField(io::CodedInputStream* input, FileIndexInfo* info,
+               string* name) {
+  string extendee;
+  uint32 number = 0;
+  while (true) {
+    uint32 tag = input->ReadTag();
+    if (tag == 0) break;
+    int field_number = WFL::GetTagFieldNumber(tag);
+    if (field_number == 1 && IsLengthDelimited(tag)) {
+      if (!ScanString(input, name)) return false;
+    } else if (field_number == 2 && IsLengthDelimited(tag)) {
+      if (!ScanString(input, &extendee)) return false;
+    } else if (field_number == 3 &&
+               WFL::GetTagWireType(tag) == WFL::WIRETYPE_VARINT) {
+      if (!input->ReadVarint32(&number)) return false;
+    } else if (!WFL::SkipField(input, tag)) {
+      return false;
+    }
+  }
+
+  if (!extendee.empty() && extendee[0] == '.') {
+    info->extensions.push_back(
+        std::make_pair(extendee.substr(1), static_cast<int>(number)));
+  }
+  return true;
+}
+
+// DescriptorProto.  Only the extensions nested inside it are indexed.
+bool ScanMessageType(io::CodedInputStream* input, FileIndexInfo* info,
+                     string* name) {
+  string unused_name;
+  while (true) {
+    uint32 tag = input->ReadTag();
+    if (tag == 0) return true;
+    int field_number = WFL::GetTagFieldNumber(tag);
+    if (!IsLengthDelimited(tag)) {
+      if (!WFL::SkipField(input, tag)) return false;
+    } else if (field_number == 1) {
+      if (!ScanString(input, name)) return false;
+    } else if (field_number == 3) {
+      if (!ScanSubmessage(input, &ScanMessageType, info, &unused_name)) {
+        return false;
+      }
+    } else if (field_number == 6) {
+      if (!ScanSubmessage(input, &ScanField, info, &unused_name)) {
+        return false;
+      }
+    } else if (!WFL::SkipField(input, tag)) {
+      return false;
+    }
+  }
+}
+
+// FileDescriptorProto.
+bool ScanFile(const void* encoded_file, int size, FileIndexInfo* info) {
+  io::CodedInputStream input(reinterpret_cast<const uint8*>(encoded_file),
+                             size);
+  while (true) {
+    uint32 tag = input.ReadTag();
+    if (tag == 0) return input.ConsumedEntireMessage();
+    int field_number = WFL::GetTagFieldNumber(tag);
+    if (!IsLengthDelimited(tag)) {
+      if (!WFL::SkipField(&input, tag)) return false;
+      continue;
+    }
+
+    bool success;
+    string name;
+    switch (field_number) {
+      case 1:  // name
+        success = ScanString(&input, &info->name);
+        break;
+      case 2:  // package
+        success = ScanString(&input, &info->package);
+        break;
+      case 4:  // message_type
+        success = ScanSubmessage(&input, &ScanMessageType, info, &name);
+        info->top_level_names.push_back(name);
+        break;
+      case 5:  // enum_type
+      case 6:  // service
+        success = ScanSubmessage(&input, &ScanNamed, &name,
+                                 static_cast<void*>(NULL));
+        info->top_level_names.push_back(name);
+        break;
+      case 7:  // extension
+        success = ScanSubmessage(&input, &ScanField, info, &name);
+        info->top_level_names.push_back(name);
+        break;
+      default:
+        success = WFL::SkipField(&input, tag);
+        break;
+    }
+    if (!success) return false;
+  }
+}
+
+}  // namespace
+
+// An index mapping file names, symbol names, and extension numbers to the
+// encoded files that define them, with the same semantics as
+// SimpleDescriptorDatabase::DescriptorIndex (see the comments there for the
+// symbol lookup algorithm).
+//
+// All names are stored back to back in a single string, and the index itself
+// consists of sorted arrays of small fixed-size entries referring to them.
+// This uses much less memory than maps of strings, and binary searching an
+// array is cache-friendly.  Inserting into the middle of an array is slow,
+// though, so new entries first go into std::sets of pending entries, which
+// are merged into the arrays in one pass the next time something is looked
+// up.  Conflicts are checked against both at insertion time.  The merge
+// happens under a mutex, so that lookups may be made from several threads at
+// once like with the other databases.
+class EncodedDescriptorDatabase::DescriptorIndex {
+ public:
+  DescriptorIndex()
+      : by_name_pending_(NameEntryLess(&names_)),
+        by_symbol_pending_(NameEntryLess(&names_)),
+        by_extension_pending_(ExtensionEntryLess(&names_)) {}
+
+  bool AddFile(const FileIndexInfo& info, pair<const void*, int> value);
+
+  pair<const void*, int> FindFile(const string& filename);
+  pair<const void*, int> FindSymbol(const string& name);
+  pair<const void*, int> FindExtension(const string& containing_type,
+                                       int field_number);
+  bool FindAllExtensionNumbers(const string& containing_type,
+                               vector<int>* output);
+
+  // Like FindSymbol() but returns the name of the file.
+  bool FindNameOfFileContainingSymbol(const string& name, string* output);
+
+ private:
+  struct FileEntry {
+    pair<const void*, int> value;
+    int name_offset;
+    int name_size;
+  };
+
+  // An entry in the by-file-name or by-symbol index.
+  struct NameEntry {
+    int name_offset;
+    int name_size;
+    int file_index;
+  };
+
+  struct ExtensionEntry {
+    int extendee_offset;
+    int extendee_size;
+    int number;
+    int file_index;
+  };
+
+  // Compares entries (or an entry and a string being searched for) by name.
+  // Holds a pointer to names_ rather than a copy of it.
+  class NameEntryLess {
+   public:
+    explicit NameEntryLess(const string* names) : names_(names) {}
+    bool operator()(const NameEntry& a, const NameEntry& b) const {
+      return Compare(a.name_offset, a.name_size,
+                     names_->data() + b.name_offset, b.name_size) < 0;
+    }
+    bool operator()(const NameEntry& a, const string& b) const {
+      return Compare(a.name_offset, a.name_size, b.data(), b.size()) < 0;
+    }
+    bool operator()(const string& a, const NameEntry& b) const {
+      return Compare(b.name_offset, b.name_size, a.data(), a.size()) > 0;
+    }
+    // Like a.compare(b), where a is a substring of names_.
+    int Compare(int a_offset, int a_size, const char* b, int b_size) const {
+      int result = memcmp(names_->data() + a_offset, b,
+                          std::min(a_size, b_size));
+      return result != 0 ? result : a_size - b_size;
+    }
+    const char* Data(int offset) const { return names_->data() + offset; }
+
+   private:
+    const string* names_;
+  };
+
+  // Orders extensions by extendee name, then number.
+  class ExtensionEntryLess {
+   public:
+    explicit ExtensionEntryLess(const string* names) : name_less_(names) {}
+    bool operator()(const ExtensionEntry& a, const ExtensionEntry& b) const {
+      int result = name_less_.Compare(a.extendee_offset, a.extendee_size,
+                                      name_less_.Data(b.extendee_offset),
+                                      b.extendee_size);
+      return result != 0 ? result < 0 : a.number < b.number;
+    }
+    bool operator()(const ExtensionEntry& a,
+                    const pair<string, int>& b) const {
+      int result = name_less_.Compare(a.extendee_offset, a.extendee_size,
+                                      b.first.data(), b.first.size());
+      return result != 0 ? result < 0 : a.number < b.second;
+    }
+    bool operator()(const pair<string, int>& a,
+                    const ExtensionEntry& b) const {
+      int result = name_less_.Compare(b.extendee_offset, b.extendee_size,
+                                      a.first.data(), a.first.size());
+      return result != 0 ? result > 0 : a.second < b.number;
+    }
+
+   private:
+    NameEntryLess name_less_;
+  };
+
+  typedef set<NameEntry, NameEntryLess> NameEntrySet;
+  typedef set<ExtensionEntry, ExtensionEntryLess> ExtensionEntrySet;
+
+  // Appends value to names_ and returns its offset.
+  int AddName(const string& value);
+  // Returns the substring of names_ at the given position.
+  string GetName(int offset, int size) const {
+    return names_.substr(offset, size);
+  }
+  bool NameEquals(int offset, int size, const string& value) const {
+    return size == value.size() &&
+           memcmp(names_.data() + offset, value.data(), size) == 0;
+  }
+
+  bool AddSymbol(const string& name, int file_index);
+  bool AddExtension(const pair<string, int>& extension, int file_index);
+
+  // Checks whether the given new symbol conflicts with an existing one in
+  // the sorted range [begin, end), where iter is the upper bound of the new
+  // symbol in that range; see SimpleDescriptorDatabase::DescriptorIndex::
+  // AddSymbol().
+  template <typename Iterator>
+  bool CheckSymbolConflict(const string& name, Iterator iter,
+                           Iterator begin, Iterator end);
+
+  // Merges all pending entries into the sorted arrays.  Must be called with
+  // mutex_ held, which must then be held for as long as the arrays are read.
+  void EnsureFlat();
+
+  // Returns the index of the file defining the given symbol, or -1.
+  int FindSymbolFileIndex(const string& name);
+
+  string names_;
+  vector<FileEntry> files_;
+
+  vector<NameEntry> by_name_;
+  vector<NameEntry> by_symbol_;
+  vector<ExtensionEntry> by_extension_;
+  NameEntrySet by_name_pending_;
+  NameEntrySet by_symbol_pending_;
+  ExtensionEntrySet by_extension_pending_;
+
+  // Guards the lookups against each other's EnsureFlat().
+  Mutex mutex_;
+};
+
+int EncodedDescriptorDatabase::DescriptorIndex::AddName(const string& value) {
+  int offset = names_.size();
+  names_.append(value);
+  return offset;
+}
+
+bool EncodedDescriptorDatabase::DescriptorIndex::AddFile(
+    const FileIndexInfo& info, pair<const void*, int> value) {
+  int file_index = files_.size();
+  FileEntry file_entry;
+  file_entry.value = value;
+  file_entry.name_offset = AddName(info.name);
+  file_entry.name_size = info.name.size();
+
+  NameEntry name_entry;
+  name_entry.name_offset = file_entry.name_offset;
+  name_entry.name_size = file_entry.name_size;
+  name_entry.file_index = file_index;
+
+  NameEntryLess less(&names_);
+  if (std::binary_search(by_name_.begin(), by_name_.end(), info.name, less) ||
+      !by_name_pending_.insert(name_entry).second) {
+    GOOGLE_LOG(ERROR) << "File already exists in database: " << info.name;
+    names_.resize(file_entry.name_offset);
+    return false;
+  }
+  files_.push_back(file_entry);
+
+  string path = info.package;
+  if (!path.empty()) path += '.';
+
+  for (int i = 0; i < info.top_level_names.size(); i++) {
+    if (!AddSymbol(path + info.top_level_names[i], file_index)) return false;
+  }
+  for (int i = 0; i < info.extensions.size(); i++) {
+    if (!AddExtension(info.extensions[i], file_index)) return false;
+  }
+
+  return true;
+}
+
+template <typename Iterator>
+bool EncodedDescriptorDatabase::DescriptorIndex::CheckSymbolConflict(
+    const string& name, Iterator iter, Iterator begin, Iterator end) {
+  // The last symbol less than or equal to the new one must not be a
+  // super-symbol of it, and the symbol after that must not be a sub-symbol
+  // of it.
+  if (iter != begin) {
+    Iterator previous = iter;
+    --previous;
+    string existing = GetName(previous->name_offset, previous->name_size);
+    if (IsSubSymbolOf(existing, name)) {
+      GOOGLE_LOG(ERROR) << "Symbol name \"" << name << "\" conflicts with the "
+                    "existing symbol \"" << existing << "\".";
+      return false;
+    }
+  }
+  if (iter != end) {
+    string existing = GetName(iter->name_offset, iter->name_size);
+    if (IsSubSymbolOf(name, existing)) {
+      GOOGLE_LOG(ERROR) << "Symbol name \"" << name << "\" conflicts with the "
+                    "existing symbol \"" << existing << "\".";
+      return false;
+    }
+  }
+  return true;
+}
+
+bool EncodedDescriptorDatabase::DescriptorIndex::AddSymbol(
+    const string& name, int file_index) {
+  if (!IsValidSymbolName(name)) {
+    GOOGLE_LOG(ERROR) << "Invalid symbol name: " << name;
+    return false;
+  }
+
+  NameEntry entry;
+  entry.name_offset = AddName(name);
+  entry.name_size = name.size();
+  entry.file_index = file_index;
+
+  vector<NameEntry>::iterator flat_iter = std::upper_bound(
+      by_symbol_.begin(), by_symbol_.end(), entry, NameEntryLess(&names_));
+  if (!CheckSymbolConflict(name, flat_iter,
+                           by_symbol_.begin(), by_symbol_.end()) ||
+      !CheckSymbolConflict(name, by_symbol_pending_.upper_bound(entry),
+                           by_symbol_pending_.begin(),
+                           by_symbol_pending_.end())) {
+    names_.resize(entry.name_offset);
+    return false;
+  }
+
+  by_symbol_pending_.insert(entry);
+  return true;
+}
+
+bool EncodedDescriptorDatabase::DescriptorIndex::AddExtension(
+    const pair<string, int>& extension, int file_index) {
+  ExtensionEntry entry;
+  entry.extendee_offset = AddName(extension.first);
+  entry.extendee_size = extension.first.size();
+  entry.number = extension.second;
+  entry.file_index = file_index;
+
+  if (std::binary_search(by_extension_.begin(), by_extension_.end(),
+                         extension, ExtensionEntryLess(&names_)) ||
+      !by_extension_pending_.insert(entry).second) {
+    GOOGLE_LOG(ERROR) << "Extension conflicts with extension already in database: "
+                  "extend ." << extension.first << " { "
+               << extension.second << " }";
+    names_.resize(entry.extendee_offset);
+    return false;
+  }
+  return true;
+}
+
+void EncodedDescriptorDatabase::DescriptorIndex::EnsureFlat() {
+  if (!by_name_pending_.empty()) {
+    int old_size = by_name_.size();
+    by_name_.insert(by_name_.end(),
+                    by_name_pending_.begin(), by_name_pending_.end());
+    std::inplace_merge(by_name_.begin(), by_name_.begin() + old_size,
+                       by_name_.end(), NameEntryLess(&names_));
+    by_name_pending_.clear();
+  }
+  if (!by_symbol_pending_.empty()) {
+    int old_size = by_symbol_.size();
+    by_symbol_.insert(by_symbol_.end(),
+                      by_symbol_pending_.begin(), by_symbol_pending_.end());
+    std::inplace_merge(by_symbol_.begin(), by_symbol_.begin() + old_size,
+                       by_symbol_.end(), NameEntryLess(&names_));
+    by_symbol_pending_.clear();
+  }
+  if (!by_extension_pending_.empty()) {
+    int old_size = by_extension_.size();
+    by_extension_.insert(by_extension_.end(),
+                         by_extension_pending_.begin(),
+                         by_extension_pending_.end());
+    std::inplace_merge(by_extension_.begin(), by_extension_.begin() + old_size,
+                       by_extension_.end(), ExtensionEntryLess(&names_));
+    by_extension_pending_.clear();
+  }
+}
+
+pair<const void*, int> EncodedDescriptorDatabase::DescriptorIndex::FindFile(
+    const string& filename) {
+  MutexLock lock(&mutex_);
+  EnsureFlat();
+  vector<NameEntry>::const_iterator iter = std::lower_bound(
+      by_name_.begin(), by_name_.end(), filename, NameEntryLess(&names_));
+  if (iter == by_name_.end() ||
+      !NameEquals(iter->name_offset, iter->name_size, filename)) {
+    return pair<const void*, int>();
+  }
+  return files_[iter->file_index].value;
+}
+
+int EncodedDescriptorDatabase::DescriptorIndex::FindSymbolFileIndex(
+    const string& name) {
+  MutexLock lock(&mutex_);
+  EnsureFlat();
+  vector<NameEntry>::const_iterator iter = std::upper_bound(
+      by_symbol_.begin(), by_symbol_.end(), name, NameEntryLess(&names_));
+  if (iter == by_symbol_.begin()) return -1;
+  --iter;
+  return IsSubSymbolOf(GetName(iter->name_offset, iter->name_size), name) ?
+         iter->file_index : -1;
+}
+
+pair<const void*, int> EncodedDescriptorDatabase::DescriptorIndex::FindSymbol(
+    const string& name) {
+  int file_index = FindSymbolFileIndex(name);
+  return file_index < 0 ? pair<const void*, int>() : files_[file_index].value;
+}
+
+bool
+EncodedDescriptorDatabase::DescriptorIndex::FindNameOfFileContainingSymbol(
+    const string& name, string* output) {
+  int file_index = FindSymbolFileIndex(name);
+  if (file_index < 0) return false;
+  *output = GetName(files_[file_index].name_offset,
+                    files_[file_index].name_size);
+  return true;
+}
+
+pair<const void*, int>
+EncodedDescriptorDatabase::DescriptorIndex::FindExtension(
+    const string& containing_type, int field_number) {
+  MutexLock lock(&mutex_);
+  EnsureFlat();
+  pair<string, int> key(containing_type, field_number);
+  ExtensionEntryLess less(&names_);
+  vector<ExtensionEntry>::const_iterator iter = std::lower_bound(
+      by_extension_.begin(), by_extension_.end(), key, less);
+  if (iter == by_extension_.end() || less(key, *iter)) {
+    return pair<const void*, int>();
+  }
+  return files_[iter->file_index].value;
+}
+
+bool EncodedDescriptorDatabase::DescriptorIndex::FindAllExtensionNumbers(
+    const string& containing_type, vector<int>* output) {
+  MutexLock lock(&mutex_);
+  EnsureFlat();
+  vector<ExtensionEntry>::const_iterator iter = std::lower_bound(
+      by_extension_.begin(), by_extension_.end(),
+      std::make_pair(containing_type, 0), ExtensionEntryLess(&names_));
+  bool success = false;
+
+  for (; iter != by_extension_.end() &&
+         NameEquals(iter->extendee_offset, iter->extendee_size,
+                    containing_type);
+       ++iter) {
+    output->push_back(iter->number);
+    success = true;
+  }
+
+  return success;
+}
+
+// -------------------------------------------------------------------
+
+EncodedDescriptorDatabase::EncodedDescriptorDatabase()
+  : index_(new DescriptorIndex) {}
 EncodedDescriptorDatabase::~EncodedDescriptorDatabase() {
   for (int i = 0; i < files_to_delete_.size(); i++) {
     operator delete(files_to_delete_[i]);
@@ -307,9 +881,9 @@ EncodedDescriptorDatabase::~EncodedDescriptorDatabase() {
 
 bool EncodedDescriptorDatabase::Add(
     const void* encoded_file_descriptor, int size) {
-  FileDescriptorProto file;
-  if (file.ParseFromArray(encoded_file_descriptor, size)) {
-    return index_.AddFile(file, std::make_pair(encoded_file_descriptor, size));
+  FileIndexInfo info;
+  if (ScanFile(encoded_file_descriptor, size, &info)) {
+    return index_->AddFile(info, std::make_pair(encoded_file_descriptor, size));
   } else {
     GOOGLE_LOG(ERROR) << "Invalid file descriptor data passed to "
                   "EncodedDescriptorDatabase::Add().";
@@ -328,56 +902,33 @@ bool EncodedDescriptorDatabase::AddCopy(
 bool EncodedDescriptorDatabase::FindFileByName(
     const string& filename,
     FileDescriptorProto* output) {
-  return MaybeParse(index_.FindFile(filename), output);
+  return MaybeParse(index_->FindFile(filename), output);
 }
 
 bool EncodedDescriptorDatabase::FindFileContainingSymbol(
     const string& symbol_name,
     FileDescriptorProto* output) {
-  return MaybeParse(index_.FindSymbol(symbol_name), output);
+  return MaybeParse(index_->FindSymbol(symbol_name), output);
 }
 
 bool EncodedDescriptorDatabase::FindNameOfFileContainingSymbol(
     const string& symbol_name,
     string* output) {
-  pair<const void*, int> encoded_file = index_.FindSymbol(symbol_name);
-  if (encoded_file.first == NULL) return false;
-
-  // Optimization:  The name should be the first field in the encoded message.
-  //   Try to just read it directly.
-  io::CodedInputStream input(reinterpret_cast<const uint8*>(encoded_file.first),
-                             encoded_file.second);
-
-  const uint32 kNameTag = internal::WireFormatLite::MakeTag(
-      FileDescriptorProto::kNameFieldNumber,
-      internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
-
-  if (input.ReadTag() == kNameTag) {
-    // Success!
-    return internal::WireFormatLite::ReadString(&input, output);
-  } else {
-    // Slow path.  Parse whole message.
-    FileDescriptorProto file_proto;
-    if (!file_proto.ParseFromArray(encoded_file.first, encoded_file.second)) {
-      return false;
-    }
-    *output = file_proto.name();
-    return true;
-  }
+  return index_->FindNameOfFileContainingSymbol(symbol_name, output);
 }
 
 bool EncodedDescriptorDatabase::FindFileContainingExtension(
     const string& containing_type,
     int field_number,
     FileDescriptorProto* output) {
-  return MaybeParse(index_.FindExtension(containing_type, field_number),
+  return MaybeParse(index_->FindExtension(containing_type, field_number),
                     output);
 }
 
 bool EncodedDescriptorDatabase::FindAllExtensionNumbers(
     const string& extendee_type,
     vector<int>* output) {
-  return index_.FindAllExtensionNumbers(extendee_type, output);
+  return index_->FindAllExtensionNumbers(extendee_type, output);
 }
 
 bool EncodedDescriptorDatabase::MaybeParse(
@@ -389,6 +940,440 @@ bool EncodedDescriptorDatabase::MaybeParse(
 
 // ===================================================================
 
+namespace {
+
+// Layout of a descriptor image.  Every word is a little-endian uint32, and
+// every "range" is a pair of words giving the offset of some bytes from the
+// start of the image followed by their length.
+//
+//   header:           kImageMagic, kImageVersion, total image size,
+//                     file count, offset of file table,
+//                     symbol count, offset of symbol table,
+//                     extension count, offset of extension table
+//   file table:       (name range, encoded FileDescriptorProto range),
+//                     sorted by name
+//   symbol table:     (symbol name range, file index), sorted by name
+//   extension table:  (extendee name range, field number, file index),
+//                     sorted by extendee name then number
+//   data:             the names and encoded files referenced by the above
+//
+// The symbol table has exactly the contents of a DescriptorIndex's by_symbol_
+// map, so it obeys the same no-sub-symbols invariant and can be searched with
+// the same prefix lookup algorithm.
+const uint32 kImageMagic = 0x49444250;  // "PBDI"
+const uint32 kImageVersion = 1;
+const int kImageHeaderSize = 9 * 4;
+const int kFileEntrySize = 4 * 4;
+const int kSymbolEntrySize = 3 * 4;
+const int kExtensionEntrySize = 4 * 4;
+
+inline uint32 ReadImageWord(const uint8* position) {
+  uint32 value;
+  io::CodedInputStream::ReadLittleEndian32FromArray(position, &value);
+  return value;
+}
+
+inline void WriteImageWord(uint32 value, string* output, int position) {
+  io::CodedOutputStream::WriteLittleEndian32ToArray(
+      value, reinterpret_cast<uint8*>(string_as_array(output)) + position);
+}
+
+// Compares the given bytes to key the way string::compare() would.
+int CompareImageString(const uint8* data, int size, const string& key) {
+  int result = memcmp(data, key.data(), std::min<int>(size, key.size()));
+  if (result != 0) return result;
+  return size - static_cast<int>(key.size());
+}
+
+// Appends bytes to the data area of an image being built and returns the
+// (offset, size) pair to record for them.
+pair<uint32, uint32> AppendImageData(const string& bytes, string* output) {
+  pair<uint32, uint32> range(output->size(), bytes.size());
+  output->append(bytes);
+  return range;
+}
+
+// Releases an image loaded by DescriptorImageDatabase::InitFromFile().
+void ReleaseMappedImage(void* image, int size) {
+#ifdef _WIN32
+  operator delete(image);
+#else
+  munmap(image, size);
+#endif
+}
+
+}  // namespace
+
+DescriptorImageDatabase::DescriptorImageDatabase()
+  : image_(NULL),
+    size_(0),
+    file_count_(0),
+    file_table_(NULL),
+    symbol_count_(0),
+    symbol_table_(NULL),
+    extension_count_(0),
+    extension_table_(NULL),
+    mapped_image_(NULL),
+    mapped_size_(0) {}
+
+DescriptorImageDatabase::~DescriptorImageDatabase() {
+  if (mapped_image_ != NULL) {
+    ReleaseMappedImage(mapped_image_, mapped_size_);
+  }
+}
+
+bool DescriptorImageDatabase::Init(const void* image, int size) {
+  GOOGLE_CHECK(image_ == NULL) << "DescriptorImageDatabase::Init() called twice.";
+
+  const uint8* data = reinterpret_cast<const uint8*>(image);
+  if (size < kImageHeaderSize ||
+      ReadImageWord(data) != kImageMagic) {
+    GOOGLE_LOG(ERROR) << "Not a descriptor image.";
+    return false;
+  }
+  if (ReadImageWord(data + 4) != kImageVersion) {
+    GOOGLE_LOG(ERROR) << "Unsupported descriptor image version: "
+               << ReadImageWord(data + 4);
+    return false;
+  }
+  if (ReadImageWord(data + 8) != size) {
+    GOOGLE_LOG(ERROR) << "Descriptor image is truncated.";
+    return false;
+  }
+
+  // Make sure each table lies within the image, so that lookups only have to
+  // check the ranges stored in the entries they visit.
+  const uint8* tables[3];
+  int counts[3];
+  const int entry_sizes[3] =
+      { kFileEntrySize, kSymbolEntrySize, kExtensionEntrySize };
+  for (int i = 0; i < 3; i++) {
+    uint32 count = ReadImageWord(data + 12 + i * 8);
+    uint32 offset = ReadImageWord(data + 16 + i * 8);
+    if (offset > size || count > (size - offset) / entry_sizes[i]) {
+      GOOGLE_LOG(ERROR) << "Descriptor image is corrupt.";
+      return false;
+    }
+    tables[i] = data + offset;
+    counts[i] = count;
+  }
+
+  image_ = data;
+  size_ = size;
+  file_table_ = tables[0];
+  file_count_ = counts[0];
+  symbol_table_ = tables[1];
+  symbol_count_ = counts[1];
+  extension_table_ = tables[2];
+  extension_count_ = counts[2];
+  return true;
+}
+
+bool DescriptorImageDatabase::InitFromFile(const string& filename) {
+  GOOGLE_CHECK(image_ == NULL && mapped_image_ == NULL)
+      << "DescriptorImageDatabase::InitFromFile() called twice.";
+
+  int fd;
+  do {
+    fd = open(filename.c_str(), O_RDONLY | O_BINARY);
+  } while (fd < 0 && errno == EINTR);
+  if (fd < 0) {
+    GOOGLE_LOG(ERROR) << filename << ": " << strerror(errno);
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) < 0 || info.st_size > kint32max) {
+    GOOGLE_LOG(ERROR) << filename << ": Cannot determine size, or too large.";
+    close(fd);
+    return false;
+  }
+  int size = info.st_size;
+
+#ifdef _WIN32
+  // No mmap(); just read the whole thing.
+  void* image = operator new(size);
+  int bytes_read = 0;
+  while (bytes_read < size) {
+    int result = read(fd, reinterpret_cast<char*>(image) + bytes_read,
+                      size - bytes_read);
+    if (result <= 0) {
+      GOOGLE_LOG(ERROR) << filename << ": " << strerror(errno);
+      operator delete(image);
+      close(fd);
+      return false;
+    }
+    bytes_read += result;
+  }
+#else
+  void* image = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  if (image == MAP_FAILED) {
+    GOOGLE_LOG(ERROR) << filename << ": " << strerror(errno);
+    close(fd);
+    return false;
+  }
+#endif
+  close(fd);
+
+  if (!Init(image, size)) {
+    ReleaseMappedImage(image, size);
+    return false;
+  }
+  mapped_image_ = image;
+  mapped_size_ = size;
+  return true;
+}
+
+bool DescriptorImageDatabase::BuildImage(
+    const vector<const FileDescriptorProto*>& files, string* output) {
+  // Let a DescriptorIndex check for conflicts and sort everything for us.
+  SimpleDescriptorDatabase::DescriptorIndex<int> index;
+  for (int i = 0; i < files.size(); i++) {
+    if (!index.AddFile(*files[i], i)) return false;
+  }
+
+  const map<string, int>& by_name = index.by_name();
+  const map<string, int>& by_symbol = index.by_symbol();
+  const map<pair<string, int>, int>& by_extension = index.by_extension();
+
+  // The file table is sorted by name, so file indexes in the other tables
+  // refer to positions in that order rather than in the order given.
+  vector<int> table_position(files.size());
+  int position = 0;
+  for (map<string, int>::const_iterator it = by_name.begin();
+       it != by_name.end(); ++it) {
+    table_position[it->second] = position++;
+  }
+
+  const int file_table_offset = kImageHeaderSize;
+  const int symbol_table_offset =
+      file_table_offset + by_name.size() * kFileEntrySize;
+  const int extension_table_offset =
+      symbol_table_offset + by_symbol.size() * kSymbolEntrySize;
+  const int data_offset =
+      extension_table_offset + by_extension.size() * kExtensionEntrySize;
+
+  output->clear();
+  output->resize(data_offset);
+
+  WriteImageWord(kImageMagic, output, 0);
+  WriteImageWord(kImageVersion, output, 4);
+  WriteImageWord(by_name.size(), output, 12);
+  WriteImageWord(file_table_offset, output, 16);
+  WriteImageWord(by_symbol.size(), output, 20);
+  WriteImageWord(symbol_table_offset, output, 24);
+  WriteImageWord(by_extension.size(), output, 28);
+  WriteImageWord(extension_table_offset, output, 32);
+
+  position = file_table_offset;
+  for (map<string, int>::const_iterator it = by_name.begin();
+       it != by_name.end(); ++it) {
+    pair<uint32, uint32> name = AppendImageData(it->first, output);
+    pair<uint32, uint32> data =
+        AppendImageData(files[it->second]->SerializeAsString(), output);
+    WriteImageWord(name.first, output, position);
+    WriteImageWord(name.second, output, position + 4);
+    WriteImageWord(data.first, output, position + 8);
+    WriteImageWord(data.second, output, position + 12);
+    position += kFileEntrySize;
+  }
+
+  for (map<string, int>::const_iterator it = by_symbol.begin();
+       it != by_symbol.end(); ++it) {
+    pair<uint32, uint32> name = AppendImageData(it->first, output);
+    WriteImageWord(name.first, output, position);
+    WriteImageWord(name.second, output, position + 4);
+    WriteImageWord(table_position[it->second], output, position + 8);
+    position += kSymbolEntrySize;
+  }
+
+  for (map<pair<string, int>, int>::const_iterator it = by_extension.begin();
+       it != by_extension.end(); ++it) {
+    pair<uint32, uint32> name = AppendImageData(it->first.first, output);
+    WriteImageWord(name.first, output, position);
+    WriteImageWord(name.second, output, position + 4);
+    WriteImageWord(it->first.second, output, position + 8);
+    WriteImageWord(table_position[it->second], output, position + 12);
+    position += kExtensionEntrySize;
+  }
+
+  WriteImageWord(output->size(), output, 8);
+  return true;
+}
+
+bool DescriptorImageDatabase::ReadRange(const uint8* position,
+                                        const uint8** data, int* size) const {
+  uint32 offset = ReadImageWord(position);
+  uint32 length = ReadImageWord(position + 4);
+  if (offset > size_ || length > size_ - offset) return false;
+  *data = image_ + offset;
+  *size = length;
+  return true;
+}
+
+int DescriptorImageDatabase::FindSymbolIndex(
+    const string& symbol_name) const {
+  // Find the last symbol which sorts less than or equal to symbol_name; see
+  // the comments on SimpleDescriptorDatabase::DescriptorIndex for why that is
+  // the only candidate.
+  int low = 0;
+  int high = symbol_count_;
+  while (low < high) {
+    int middle = low + (high - low) / 2;
+    const uint8* name;
+    int name_size;
+    if (!ReadRange(symbol_table_ + middle * kSymbolEntrySize,
+                   &name, &name_size)) {
+      return -1;
+    }
+    if (CompareImageString(name, name_size, symbol_name) <= 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  if (low == 0) return -1;
+
+  const uint8* entry = symbol_table_ + (low - 1) * kSymbolEntrySize;
+  const uint8* name;
+  int name_size;
+  if (!ReadRange(entry, &name, &name_size)) return -1;
+
+  // Is the found symbol equal to, or a parent of, symbol_name?
+  if (name_size > symbol_name.size() ||
+      memcmp(name, symbol_name.data(), name_size) != 0 ||
+      (name_size < symbol_name.size() && symbol_name[name_size] != '.')) {
+    return -1;
+  }
+  return ReadImageWord(entry + 8);
+}
+
+int DescriptorImageDatabase::FindExtensionIndex(
+    const string& containing_type, int field_number) const {
+  int low = 0;
+  int high = extension_count_;
+  while (low < high) {
+    int middle = low + (high - low) / 2;
+    const uint8* entry = extension_table_ + middle * kExtensionEntrySize;
+    const uint8* name;
+    int name_size;
+    if (!ReadRange(entry, &name, &name_size)) return -1;
+    int result = CompareImageString(name, name_size, containing_type);
+    if (result == 0) {
+      int number = static_cast<int32>(ReadImageWord(entry + 8));
+      if (number == field_number) return ReadImageWord(entry + 12);
+      result = number < field_number ? -1 : 1;
+    }
+    if (result < 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return -1;
+}
+
+bool DescriptorImageDatabase::MaybeParse(int file_index,
+                                         FileDescriptorProto* output) const {
+  if (file_index < 0 || file_index >= file_count_) return false;
+  const uint8* data;
+  int size;
+  if (!ReadRange(file_table_ + file_index * kFileEntrySize + 8,
+                 &data, &size)) {
+    return false;
+  }
+  return output->ParseFromArray(data, size);
+}
+
+bool DescriptorImageDatabase::FindFileByName(
+    const string& filename,
+    FileDescriptorProto* output) {
+  int low = 0;
+  int high = file_count_;
+  while (low < high) {
+    int middle = low + (high - low) / 2;
+    const uint8* name;
+    int name_size;
+    if (!ReadRange(file_table_ + middle * kFileEntrySize, &name, &name_size)) {
+      return false;
+    }
+    int result = CompareImageString(name, name_size, filename);
+    if (result == 0) return MaybeParse(middle, output);
+    if (result < 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return false;
+}
+
+bool DescriptorImageDatabase::FindFileContainingSymbol(
+    const string& symbol_name,
+    FileDescriptorProto* output) {
+  return MaybeParse(FindSymbolIndex(symbol_name), output);
+}
+
+bool DescriptorImageDatabase::FindNameOfFileContainingSymbol(
+    const string& symbol_name,
+    string* output) {
+  int file_index = FindSymbolIndex(symbol_name);
+  if (file_index < 0 || file_index >= file_count_) return false;
+  const uint8* name;
+  int name_size;
+  if (!ReadRange(file_table_ + file_index * kFileEntrySize,
+                 &name, &name_size)) {
+    return false;
+  }
+  output->assign(reinterpret_cast<const char*>(name), name_size);
+  return true;
+}
+
+bool DescriptorImageDatabase::FindFileContainingExtension(
+    const string& containing_type,
+    int field_number,
+    FileDescriptorProto* output) {
+  return MaybeParse(FindExtensionIndex(containing_type, field_number), output);
+}
+
+bool DescriptorImageDatabase::FindAllExtensionNumbers(
+    const string& extendee_type,
+    vector<int>* output) {
+  // Find the first extension of extendee_type, then walk forward.
+  int low = 0;
+  int high = extension_count_;
+  while (low < high) {
+    int middle = low + (high - low) / 2;
+    const uint8* name;
+    int name_size;
+    if (!ReadRange(extension_table_ + middle * kExtensionEntrySize,
+                   &name, &name_size)) {
+      return false;
+    }
+    if (CompareImageString(name, name_size, extendee_type) < 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+
+  bool success = false;
+  for (; low < extension_count_; low++) {
+    const uint8* entry = extension_table_ + low * kExtensionEntrySize;
+    const uint8* name;
+    int name_size;
+    if (!ReadRange(entry, &name, &name_size) ||
+        CompareImageString(name, name_size, extendee_type) != 0) {
+      break;
+    }
+    output->push_back(static_cast<int32>(ReadImageWord(entry + 8)));
+    success = true;
+  }
+  return success;
+}
+
+// ===================================================================
+
 DescriptorPoolDatabase::DescriptorPoolDatabase(const DescriptorPool& pool)
   : pool_(pool) {}
 DescriptorPoolDatabase::~DescriptorPoolDatabase() {}
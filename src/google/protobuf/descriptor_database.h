@@ -51,6 +51,7 @@ namespace protobuf {
 class DescriptorDatabase;
 class SimpleDescriptorDatabase;
 class EncodedDescriptorDatabase;
+class DescriptorImageDatabase;
 class DescriptorPoolDatabase;
 class MergedDescriptorDatabase;
 
@@ -154,7 +155,7 @@ class LIBPROTOBUF_EXPORT SimpleDescriptorDatabase : public DescriptorDatabase {
 
  private:
   // So that it can use DescriptorIndex.
-  friend class EncodedDescriptorDatabase;
+  friend class DescriptorImageDatabase;
 
   // An index mapping file names, symbol names, and extension numbers to
   // some sort of values.
@@ -177,6 +178,13 @@ class LIBPROTOBUF_EXPORT SimpleDescriptorDatabase : public DescriptorDatabase {
     bool FindAllExtensionNumbers(const string& containing_type,
                                  vector<int>* output);
 
+    // The raw contents of the index, in sorted order.
+    const map<string, Value>& by_name() const { return by_name_; }
+    const map<string, Value>& by_symbol() const { return by_symbol_; }
+    const map<pair<string, int>, Value>& by_extension() const {
+      return by_extension_;
+    }
+
    private:
     map<string, Value> by_name_;
     map<string, Value> by_symbol_;
@@ -262,6 +270,14 @@ class LIBPROTOBUF_EXPORT SimpleDescriptorDatabase : public DescriptorDatabase {
 
 // Very similar to SimpleDescriptorDatabase, but stores all the descriptors
 // as raw bytes and generally tries to use as little memory as possible.
+// Add() only decodes the names and numbers it needs for its index rather than
+// the whole FileDescriptorProto, and the index is kept in sorted arrays rather
+// than maps, so none of the lookups need to decode anything except the file
+// that is finally returned.
+//
+// Newly-added entries are merged into the sorted arrays by the next lookup.
+// The merge is internally locked, so as with SimpleDescriptorDatabase, the
+// Find*() methods may be called concurrently from several threads.
 //
 // The same caveats regarding FindFileContainingExtension() apply as with
 // SimpleDescriptorDatabase.
@@ -298,7 +314,10 @@ class LIBPROTOBUF_EXPORT EncodedDescriptorDatabase : public DescriptorDatabase {
                                vector<int>* output);
 
  private:
-  SimpleDescriptorDatabase::DescriptorIndex<pair<const void*, int> > index_;
+  // Defined in the .cc file.
+  class DescriptorIndex;
+
+  scoped_ptr<DescriptorIndex> index_;
   vector<void*> files_to_delete_;
 
   // If encoded_file.first is non-NULL, parse the data into *output and return
@@ -309,6 +328,96 @@ class LIBPROTOBUF_EXPORT EncodedDescriptorDatabase : public DescriptorDatabase {
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(EncodedDescriptorDatabase);
 };
 
+// A DescriptorDatabase which reads a "descriptor image":  a single block of
+// bytes containing a set of encoded FileDescriptorProtos together with
+// pre-sorted indexes of their file names, symbols, and extensions.  Images are
+// written by BuildImage() or by protoc's --descriptor_image_out flag.
+//
+// Unlike EncodedDescriptorDatabase, opening an image does not parse anything
+// or allocate any memory:  lookups binary-search the indexes in place, and a
+// file is only decoded when it is actually requested.  When the image is
+// mapped from disk with InitFromFile(), all processes that map the same file
+// share its pages.  Typical usage:
+//
+//   DescriptorImageDatabase database;
+//   if (!database.InitFromFile("all_protos.pbimage")) { ... }
+//   DescriptorPool pool(&database);
+//   const Descriptor* type = pool.FindMessageTypeByName("foo.Bar");
+//
+// The same caveats regarding FindFileContainingExtension() apply as with
+// SimpleDescriptorDatabase.
+class LIBPROTOBUF_EXPORT DescriptorImageDatabase : public DescriptorDatabase {
+ public:
+  DescriptorImageDatabase();
+  ~DescriptorImageDatabase();
+
+  // Uses the image stored in the given bytes.  The database does not make a
+  // copy of the bytes, nor does it take ownership; it's up to the caller to
+  // make sure the bytes remain valid for the life of the database.  Returns
+  // false and logs an error if the bytes do not start with a valid image
+  // header.  Only the header is checked up front; a corrupt entry found later
+  // simply makes the lookup that hit it fail.  Must be called at most once.
+  bool Init(const void* image, int size);
+
+  // Like Init(), but maps the named file into memory (or, on platforms without
+  // mmap(), reads it).  The mapping is released when the database is
+  // destroyed, or right away if the file is not a valid image.  Must be
+  // called at most once, and not together with Init().
+  bool InitFromFile(const string& filename);
+
+  // Writes an image containing the given files to *output, replacing its
+  // contents.  Returns false and logs an error if two of the files conflict,
+  // using the same rules as SimpleDescriptorDatabase::Add().
+  static bool BuildImage(const vector<const FileDescriptorProto*>& files,
+                         string* output);
+
+  // Like FindFileContainingSymbol but returns only the name of the file.
+  bool FindNameOfFileContainingSymbol(const string& symbol_name,
+                                      string* output);
+
+  // implements DescriptorDatabase -----------------------------------
+  bool FindFileByName(const string& filename,
+                      FileDescriptorProto* output);
+  bool FindFileContainingSymbol(const string& symbol_name,
+                                FileDescriptorProto* output);
+  bool FindFileContainingExtension(const string& containing_type,
+                                   int field_number,
+                                   FileDescriptorProto* output);
+  bool FindAllExtensionNumbers(const string& extendee_type,
+                               vector<int>* output);
+
+ private:
+  const uint8* image_;
+  int size_;
+
+  // The header fields, as read by Init().
+  int file_count_;
+  const uint8* file_table_;
+  int symbol_count_;
+  const uint8* symbol_table_;
+  int extension_count_;
+  const uint8* extension_table_;
+
+  // Set by InitFromFile() so that the destructor can release the image.
+  void* mapped_image_;
+  int mapped_size_;
+
+  // Reads the string or byte range that starts at the given position of the
+  // image.  The position points at an (offset, size) pair.  Returns false if
+  // the range does not fit in the image.
+  bool ReadRange(const uint8* position, const uint8** data, int* size) const;
+
+  // Index of the file containing the given symbol or extension, or -1.
+  int FindSymbolIndex(const string& symbol_name) const;
+  int FindExtensionIndex(const string& containing_type, int field_number) const;
+
+  // If file_index is a valid file, parse its data into *output and return
+  // true, otherwise return false.
+  bool MaybeParse(int file_index, FileDescriptorProto* output) const;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(DescriptorImageDatabase);
+};
+
 // A DescriptorDatabase that fetches files from a given pool.
 class LIBPROTOBUF_EXPORT DescriptorPoolDatabase : public DescriptorDatabase {
  public:
@@ -35,6 +35,9 @@
 // This file makes extensive use of RFC 3092.  :)
 
 #include <algorithm>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
 
 #include <google/protobuf/descriptor_database.h>
 #include <google/protobuf/descriptor.h>
@@ -43,6 +46,8 @@
 #include <google/protobuf/stubs/strutil.h>
 
 #include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/stl_util.h>
+#include <google/protobuf/testing/file.h>
 #include <google/protobuf/testing/googletest.h>
 #include <gtest/gtest.h>
 
@@ -131,6 +136,64 @@ class EncodedDescriptorDatabaseTestCase : public DescriptorDatabaseTestCase {
   EncodedDescriptorDatabase database_;
 };
 
+// Specialization for DescriptorImageDatabase.  Images can't be modified, so
+// each call to AddToDatabase() builds a new image of all the files added so
+// far, and the database handed to the tests forwards to the latest one.
+class DescriptorImageDatabaseTestCase : public DescriptorDatabaseTestCase,
+                                        public DescriptorDatabase {
+ public:
+  static DescriptorDatabaseTestCase* New() {
+    return new DescriptorImageDatabaseTestCase;
+  }
+
+  virtual ~DescriptorImageDatabaseTestCase() {
+    STLDeleteElements(&files_);
+  }
+
+  virtual DescriptorDatabase* GetDatabase() {
+    return this;
+  }
+  virtual bool AddToDatabase(const FileDescriptorProto& file) {
+    files_.push_back(new FileDescriptorProto(file));
+    string image;
+    if (!DescriptorImageDatabase::BuildImage(
+            vector<const FileDescriptorProto*>(files_.begin(), files_.end()),
+            &image)) {
+      delete files_.back();
+      files_.pop_back();
+      return false;
+    }
+    image_.swap(image);
+    database_.reset(new DescriptorImageDatabase);
+    return database_->Init(image_.data(), image_.size());
+  }
+
+  // implements DescriptorDatabase -----------------------------------
+  bool FindFileByName(const string& filename,
+                      FileDescriptorProto* output) {
+    return database_->FindFileByName(filename, output);
+  }
+  bool FindFileContainingSymbol(const string& symbol_name,
+                                FileDescriptorProto* output) {
+    return database_->FindFileContainingSymbol(symbol_name, output);
+  }
+  bool FindFileContainingExtension(const string& containing_type,
+                                   int field_number,
+                                   FileDescriptorProto* output) {
+    return database_->FindFileContainingExtension(containing_type,
+                                                  field_number, output);
+  }
+  bool FindAllExtensionNumbers(const string& extendee_type,
+                               vector<int>* output) {
+    return database_->FindAllExtensionNumbers(extendee_type, output);
+  }
+
+ private:
+  vector<FileDescriptorProto*> files_;
+  string image_;
+  scoped_ptr<DescriptorImageDatabase> database_;
+};
+
 // Specialization for DescriptorPoolDatabase.
 class DescriptorPoolDatabaseTestCase : public DescriptorDatabaseTestCase {
  public:
@@ -477,6 +540,8 @@ INSTANTIATE_TEST_CASE_P(MemoryConserving, DescriptorDatabaseTest,
     testing::Values(&EncodedDescriptorDatabaseTestCase::New));
 INSTANTIATE_TEST_CASE_P(Pool, DescriptorDatabaseTest,
     testing::Values(&DescriptorPoolDatabaseTestCase::New));
+INSTANTIATE_TEST_CASE_P(Image, DescriptorDatabaseTest,
+    testing::Values(&DescriptorImageDatabaseTestCase::New));
 
 #endif  // GTEST_HAS_PARAM_TEST
 
@@ -490,10 +555,9 @@ TEST(EncodedDescriptorDatabaseExtraTest, FindNameOfFileContainingSymbol) {
   file2b.set_package("bar");
   file2b.add_message_type()->set_name("Bar");
 
-  // Normal serialization allows our optimization to kick in.
   string data1 = file1.SerializeAsString();
 
-  // Force out-of-order serialization to test slow path.
+  // Force out-of-order serialization, with the package after the messages.
   string data2 = file2b.SerializeAsString() + file2a.SerializeAsString();
 
   // Create EncodedDescriptorDatabase containing both files.
@@ -514,6 +578,217 @@ TEST(EncodedDescriptorDatabaseExtraTest, FindNameOfFileContainingSymbol) {
   EXPECT_FALSE(db.FindNameOfFileContainingSymbol("baz.Baz", &filename));
 }
 
+TEST(EncodedDescriptorDatabaseExtraTest, InterleavedAddAndFind) {
+  // Lookups merge newly-added files into the index; make sure that files
+  // added afterwards are still found and checked for conflicts against both
+  // the merged and the not-yet-merged ones.
+  EncodedDescriptorDatabase db;
+  FileDescriptorProto file, output;
+
+  for (int i = 0; i < 10; i++) {
+    file.Clear();
+    file.set_name(StrCat("file", i, ".proto"));
+    file.set_package(StrCat("pkg", i % 3));
+    file.add_message_type()->set_name(StrCat("Msg", i));
+    FieldDescriptorProto* extension = file.add_extension();
+    extension->set_name(StrCat("ext", i));
+    extension->set_extendee(".Extendee");
+    extension->set_number(100 - i);
+    string data = file.SerializeAsString();
+    ASSERT_TRUE(db.AddCopy(data.data(), data.size()));
+
+    if (i % 2 == 0) {
+      EXPECT_TRUE(db.FindFileByName(file.name(), &output));
+      EXPECT_EQ(file.name(), output.name());
+    }
+  }
+
+  for (int i = 0; i < 10; i++) {
+    string name = StrCat("file", i, ".proto");
+    string filename;
+    EXPECT_TRUE(db.FindNameOfFileContainingSymbol(
+        StrCat("pkg", i % 3, ".Msg", i, ".Nested"), &filename));
+    EXPECT_EQ(name, filename);
+    EXPECT_TRUE(db.FindNameOfFileContainingSymbol(
+        StrCat("pkg", i % 3, ".ext", i), &filename));
+    EXPECT_EQ(name, filename);
+    EXPECT_TRUE(db.FindFileContainingExtension("Extendee", 100 - i, &output));
+    EXPECT_EQ(name, output.name());
+  }
+
+  vector<int> numbers;
+  EXPECT_TRUE(db.FindAllExtensionNumbers("Extendee", &numbers));
+  ASSERT_EQ(10, numbers.size());
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(91 + i, numbers[i]);
+  }
+
+  // Conflicts with a symbol which has been merged into the index...
+  file.Clear();
+  file.set_name("conflict1.proto");
+  file.set_package("pkg0.Msg0");
+  file.add_enum_type()->set_name("Enum");
+  string data = file.SerializeAsString();
+  {
+    ScopedMemoryLog log;
+    EXPECT_FALSE(db.AddCopy(data.data(), data.size()));
+  }
+
+  // ...and with one which has not.
+  file.Clear();
+  file.set_name("new.proto");
+  file.add_service()->set_name("Service");
+  data = file.SerializeAsString();
+  EXPECT_TRUE(db.AddCopy(data.data(), data.size()));
+
+  file.Clear();
+  file.set_name("conflict2.proto");
+  file.add_message_type()->set_name("Service");
+  data = file.SerializeAsString();
+  {
+    ScopedMemoryLog log;
+    EXPECT_FALSE(db.AddCopy(data.data(), data.size()));
+  }
+  EXPECT_TRUE(db.FindFileContainingSymbol("Service", &output));
+  EXPECT_EQ("new.proto", output.name());
+}
+
+#ifndef _WIN32
+
+// Looks up every file in the database given to it.
+void* FindAllFiles(void* arg) {
+  EncodedDescriptorDatabase* db =
+      reinterpret_cast<EncodedDescriptorDatabase*>(arg);
+  FileDescriptorProto output;
+  for (int i = 0; i < 100; i++) {
+    string filename;
+    if (!db->FindNameOfFileContainingSymbol(StrCat("pkg.Msg", i), &filename) ||
+        !db->FindFileByName(filename, &output)) {
+      return arg;
+    }
+  }
+  return NULL;
+}
+
+TEST(EncodedDescriptorDatabaseExtraTest, ConcurrentFind) {
+  // The first lookups merge the pending entries; threads racing to do so
+  // must all see a consistent index.
+  EncodedDescriptorDatabase db;
+  for (int i = 0; i < 100; i++) {
+    FileDescriptorProto file;
+    file.set_name(StrCat("file", i, ".proto"));
+    file.set_package("pkg");
+    file.add_message_type()->set_name(StrCat("Msg", i));
+    string data = file.SerializeAsString();
+    ASSERT_TRUE(db.AddCopy(data.data(), data.size()));
+  }
+
+  pthread_t threads[4];
+  for (int i = 0; i < GOOGLE_ARRAYSIZE(threads); i++) {
+    ASSERT_EQ(0, pthread_create(&threads[i], NULL, &FindAllFiles, &db));
+  }
+  for (int i = 0; i < GOOGLE_ARRAYSIZE(threads); i++) {
+    void* result;
+    pthread_join(threads[i], &result);
+    EXPECT_TRUE(result == NULL);
+  }
+}
+
+#endif  // !_WIN32
+
+TEST(DescriptorImageDatabaseExtraTest, FindNameOfFileContainingSymbol) {
+  FileDescriptorProto file1, file2;
+  file1.set_name("foo.proto");
+  file1.set_package("foo");
+  file1.add_message_type()->set_name("Foo");
+  file2.set_name("bar.proto");
+  file2.set_package("bar");
+  file2.add_message_type()->set_name("Bar");
+
+  vector<const FileDescriptorProto*> files;
+  files.push_back(&file1);
+  files.push_back(&file2);
+  string image;
+  ASSERT_TRUE(DescriptorImageDatabase::BuildImage(files, &image));
+
+  DescriptorImageDatabase db;
+  ASSERT_TRUE(db.Init(image.data(), image.size()));
+
+  string filename;
+  EXPECT_TRUE(db.FindNameOfFileContainingSymbol("foo.Foo", &filename));
+  EXPECT_EQ("foo.proto", filename);
+  EXPECT_TRUE(db.FindNameOfFileContainingSymbol("foo.Foo.Blah", &filename));
+  EXPECT_EQ("foo.proto", filename);
+  EXPECT_TRUE(db.FindNameOfFileContainingSymbol("bar.Bar", &filename));
+  EXPECT_EQ("bar.proto", filename);
+  EXPECT_FALSE(db.FindNameOfFileContainingSymbol("foo", &filename));
+  EXPECT_FALSE(db.FindNameOfFileContainingSymbol("bar", &filename));
+  EXPECT_FALSE(db.FindNameOfFileContainingSymbol("baz.Baz", &filename));
+}
+
+TEST(DescriptorImageDatabaseExtraTest, InitFromFile) {
+  FileDescriptorProto file_proto;
+  FileDescriptorProto::descriptor()->file()->CopyTo(&file_proto);
+  vector<const FileDescriptorProto*> files;
+  files.push_back(&file_proto);
+  string image;
+  ASSERT_TRUE(DescriptorImageDatabase::BuildImage(files, &image));
+
+  string filename = TestTempDir() + "/descriptor.pbimage";
+  GOOGLE_CHECK_OK(File::SetContents(filename, image, true));
+
+  DescriptorImageDatabase db;
+  ASSERT_TRUE(db.InitFromFile(filename));
+
+  // A pool built on top of the image should be able to find everything.
+  DescriptorPool pool(&db);
+  const Descriptor* type =
+      pool.FindMessageTypeByName("google.protobuf.FileDescriptorProto");
+  ASSERT_TRUE(type != NULL);
+  EXPECT_EQ(FileDescriptorProto::descriptor()->DebugString(),
+            type->DebugString());
+}
+
+TEST(DescriptorImageDatabaseExtraTest, RejectsBadImages) {
+  FileDescriptorProto file_proto;
+  file_proto.set_name("foo.proto");
+  vector<const FileDescriptorProto*> files;
+  files.push_back(&file_proto);
+  string image;
+  ASSERT_TRUE(DescriptorImageDatabase::BuildImage(files, &image));
+
+  {
+    DescriptorImageDatabase db;
+    EXPECT_FALSE(db.Init(image.data(), image.size() - 1));
+  }
+  {
+    string bad_image = image;
+    bad_image[0] = 'X';
+    DescriptorImageDatabase db;
+    EXPECT_FALSE(db.Init(bad_image.data(), bad_image.size()));
+  }
+  {
+    DescriptorImageDatabase db;
+    EXPECT_FALSE(db.Init("", 0));
+  }
+  {
+    DescriptorImageDatabase db;
+    EXPECT_FALSE(db.InitFromFile(TestTempDir() + "/no_such_file"));
+  }
+  {
+    // A failed InitFromFile() releases the file, so it may be retried.
+    string bad_filename = TestTempDir() + "/bad.pbimage";
+    string good_filename = TestTempDir() + "/good.pbimage";
+    GOOGLE_CHECK_OK(File::SetContents(bad_filename, "not an image", true));
+    GOOGLE_CHECK_OK(File::SetContents(good_filename, image, true));
+    DescriptorImageDatabase db;
+    EXPECT_FALSE(db.InitFromFile(bad_filename));
+    EXPECT_TRUE(db.InitFromFile(good_filename));
+    FileDescriptorProto output;
+    EXPECT_TRUE(db.FindFileByName("foo.proto", &output));
+  }
+}
+
 // ===================================================================
 
 class MergedDescriptorDatabaseTest : public testing::Test {
@@ -2114,6 +2114,35 @@ TEST_F(MiscTest, FieldOptions) {
   EXPECT_EQ(FieldOptions::CORD, bar->options().ctype());
 }
 
+TEST_F(MiscTest, SpaceUsed) {
+  FileDescriptorProto file_proto;
+  file_proto.set_name("foo.proto");
+  DescriptorProto* message_proto = AddMessage(&file_proto, "TestMessage");
+  AddField(message_proto, "foo", 1,
+           FieldDescriptorProto::LABEL_OPTIONAL,
+           FieldDescriptorProto::TYPE_INT32);
+
+  DescriptorPool pool;
+  int64 empty_size = pool.SpaceUsed();
+  EXPECT_GT(empty_size, 0);
+
+  ASSERT_TRUE(pool.BuildFile(file_proto) != NULL);
+  int64 small_size = pool.SpaceUsed();
+  EXPECT_GT(small_size, empty_size);
+
+  // A much larger file should take up correspondingly more space.
+  FileDescriptorProto large_file_proto;
+  large_file_proto.set_name("large.proto");
+  message_proto = AddMessage(&large_file_proto, "LargeMessage");
+  for (int i = 1; i <= 1000; i++) {
+    AddField(message_proto, strings::Substitute("field_$0", i), i,
+             FieldDescriptorProto::LABEL_OPTIONAL,
+             FieldDescriptorProto::TYPE_INT32);
+  }
+  ASSERT_TRUE(pool.BuildFile(large_file_proto) != NULL);
+  EXPECT_GT(pool.SpaceUsed() - small_size, 1000 * sizeof(FieldDescriptor));
+}
+
 // ===================================================================
 enum DescriptorPoolMode {
   NO_DATABASE,
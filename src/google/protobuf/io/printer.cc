@@ -35,6 +35,7 @@
 #include <google/protobuf/io/printer.h>
 #include <google/protobuf/io/zero_copy_stream.h>
 #include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/stl_util.h>
 
 namespace google {
 namespace protobuf {
@@ -57,6 +58,12 @@ Printer::~Printer() {
 }
 
 void Printer::Print(const map<string, string>& variables, const char* text) {
+  DoPrint(text, &variables, 0, NULL, NULL);
+}
+
+void Printer::DoPrint(const char* text, const map<string, string>* variables,
+                      int count, const char* const names[],
+                      const string* const values[]) {
   int size = strlen(text);
   int pos = 0;  // The number of bytes we've written so far.
 
@@ -85,18 +92,32 @@ void Printer::Print(const map<string, string>& variables, const char* text) {
         end = text + pos;
       }
       int endpos = end - text;
+      int name_size = endpos - pos;
 
-      string varname(text + pos, endpos - pos);
-      if (varname.empty()) {
+      if (name_size == 0) {
         // Two delimiters in a row reduce to a literal delimiter character.
         WriteRaw(&variable_delimiter_, 1);
       } else {
         // Replace with the variable's value.
-        map<string, string>::const_iterator iter = variables.find(varname);
-        if (iter == variables.end()) {
-          GOOGLE_LOG(DFATAL) << " Undefined variable: " << varname;
+        const string* value = NULL;
+        if (variables != NULL) {
+          map<string, string>::const_iterator iter =
+              variables->find(string(text + pos, name_size));
+          if (iter != variables->end()) value = &iter->second;
         } else {
-          WriteRaw(iter->second.data(), iter->second.size());
+          for (int j = 0; j < count; j++) {
+            if (strncmp(names[j], text + pos, name_size) == 0 &&
+                names[j][name_size] == '\0') {
+              value = values[j];
+              break;
+            }
+          }
+        }
+        if (value == NULL) {
+          GOOGLE_LOG(DFATAL) << " Undefined variable: "
+                             << string(text + pos, name_size);
+        } else {
+          WriteRaw(value->data(), value->size());
         }
       }
 
@@ -111,35 +132,31 @@ void Printer::Print(const map<string, string>& variables, const char* text) {
 }
 
 void Printer::Print(const char* text) {
-  static map<string, string> empty;
-  Print(empty, text);
+  DoPrint(text, NULL, 0, NULL, NULL);
 }
 
 void Printer::Print(const char* text,
                     const char* variable, const string& value) {
-  map<string, string> vars;
-  vars[variable] = value;
-  Print(vars, text);
+  const char* names[] = { variable };
+  const string* values[] = { &value };
+  DoPrint(text, NULL, 1, names, values);
 }
 
 void Printer::Print(const char* text,
                     const char* variable1, const string& value1,
                     const char* variable2, const string& value2) {
-  map<string, string> vars;
-  vars[variable1] = value1;
-  vars[variable2] = value2;
-  Print(vars, text);
+  const char* names[] = { variable1, variable2 };
+  const string* values[] = { &value1, &value2 };
+  DoPrint(text, NULL, 2, names, values);
 }
 
 void Printer::Print(const char* text,
                     const char* variable1, const string& value1,
                     const char* variable2, const string& value2,
                     const char* variable3, const string& value3) {
-  map<string, string> vars;
-  vars[variable1] = value1;
-  vars[variable2] = value2;
-  vars[variable3] = value3;
-  Print(vars, text);
+  const char* names[] = { variable1, variable2, variable3 };
+  const string* values[] = { &value1, &value2, &value3 };
+  DoPrint(text, NULL, 3, names, values);
 }
 
 void Printer::Print(const char* text,
@@ -147,12 +164,81 @@ void Printer::Print(const char* text,
                     const char* variable2, const string& value2,
                     const char* variable3, const string& value3,
                     const char* variable4, const string& value4) {
-  map<string, string> vars;
-  vars[variable1] = value1;
-  vars[variable2] = value2;
-  vars[variable3] = value3;
-  vars[variable4] = value4;
-  Print(vars, text);
+  const char* names[] = { variable1, variable2, variable3, variable4 };
+  const string* values[] = { &value1, &value2, &value3, &value4 };
+  DoPrint(text, NULL, 4, names, values);
+}
+
+void Printer::Print(const PrinterTemplate& tmpl,
+                    const string* const values[]) {
+  GOOGLE_DCHECK_EQ(variable_delimiter_, tmpl.variable_delimiter_);
+  const char* text = tmpl.text_.data();
+  for (int i = 0; i < tmpl.segments_.size(); i++) {
+    const PrinterTemplate::Segment& segment = tmpl.segments_[i];
+    if (segment.variable < 0) {
+      WriteRaw(text + segment.start, segment.size);
+      if (segment.ends_line) at_start_of_line_ = true;
+    } else {
+      const string* value = values[segment.variable];
+      WriteRaw(value->data(), value->size());
+    }
+  }
+}
+
+void Printer::Print(const map<string, string>& variables,
+                    const PrinterTemplate& tmpl) {
+  vector<const string*> values(tmpl.variable_count());
+  for (int i = 0; i < values.size(); i++) {
+    map<string, string>::const_iterator iter =
+        variables.find(tmpl.variable_name(i));
+    if (iter == variables.end()) {
+      GOOGLE_LOG(DFATAL) << " Undefined variable: " << tmpl.variable_name(i);
+      return;
+    }
+    values[i] = &iter->second;
+  }
+  Print(tmpl, values.empty() ? NULL : &values[0]);
+}
+
+void Printer::Print(const PrinterTemplate& tmpl,
+                    const char* variable, const string& value) {
+  const char* names[] = { variable };
+  const string* values[] = { &value };
+  PrintTemplateWithPairs(tmpl, 1, names, values);
+}
+
+void Printer::Print(const PrinterTemplate& tmpl,
+                    const char* variable1, const string& value1,
+                    const char* variable2, const string& value2) {
+  const char* names[] = { variable1, variable2 };
+  const string* values[] = { &value1, &value2 };
+  PrintTemplateWithPairs(tmpl, 2, names, values);
+}
+
+void Printer::PrintTemplateWithPairs(const PrinterTemplate& tmpl, int count,
+                                     const char* const names[],
+                                     const string* const values[]) {
+  // The overloads taking name/value pairs accept at most two variables, so
+  // a fixed-size array is enough.
+  const string* bound[2];
+  if (tmpl.variable_count() > count) {
+    GOOGLE_LOG(DFATAL) << " Template uses more variables than were given.";
+    return;
+  }
+  for (int i = 0; i < tmpl.variable_count(); i++) {
+    bound[i] = NULL;
+    for (int j = 0; j < count; j++) {
+      if (tmpl.variable_name(i) == names[j]) {
+        bound[i] = values[j];
+        break;
+      }
+    }
+    if (bound[i] == NULL) {
+      GOOGLE_LOG(DFATAL) << " Undefined variable: " << tmpl.variable_name(i);
+      return;
+    }
+  }
+  Print(tmpl, bound);
 }
 
 void Printer::Indent() {
@@ -206,6 +292,109 @@ void Printer::WriteRaw(const char* data, int size) {
   buffer_size_ -= size;
 }
 
+// ===================================================================
+
+PrinterTemplate::PrinterTemplate(const char* text, char variable_delimiter)
+  : variable_delimiter_(variable_delimiter),
+    text_(text) {
+  int size = text_.size();
+  int pos = 0;  // Start of the literal text not yet added to segments_.
+
+  for (int i = 0; i < size; i++) {
+    if (text_[i] == '\n') {
+      Segment literal = { -1, pos, i - pos + 1, true };
+      segments_.push_back(literal);
+      pos = i + 1;
+    } else if (text_[i] == variable_delimiter_) {
+      if (i > pos) {
+        Segment literal = { -1, pos, i - pos, false };
+        segments_.push_back(literal);
+      }
+      pos = i + 1;
+
+      // Find closing delimiter.
+      string::size_type end = text_.find(variable_delimiter_, pos);
+      if (end == string::npos) {
+        GOOGLE_LOG(DFATAL) << " Unclosed variable name.";
+        end = pos;
+      }
+      int endpos = end;
+
+      if (endpos == pos) {
+        // Two delimiters in a row reduce to a literal delimiter character.
+        Segment literal = { -1, i, 1, false };
+        segments_.push_back(literal);
+      } else {
+        string name = text_.substr(pos, endpos - pos);
+        int index = FindVariable(name.c_str());
+        if (index < 0) {
+          index = variable_names_.size();
+          variable_names_.push_back(name);
+        }
+        Segment variable = { index, pos, endpos - pos, false };
+        segments_.push_back(variable);
+      }
+
+      // Advance past this variable.
+      i = endpos;
+      pos = endpos + 1;
+    }
+  }
+
+  if (size > pos) {
+    Segment literal = { -1, pos, size - pos, false };
+    segments_.push_back(literal);
+  }
+}
+
+PrinterTemplate::~PrinterTemplate() {}
+
+int PrinterTemplate::FindVariable(const char* name) const {
+  for (int i = 0; i < variable_names_.size(); i++) {
+    if (variable_names_[i] == name) return i;
+  }
+  return -1;
+}
+
+// ===================================================================
+
+namespace {
+
+// The templates parsed by LazyPrinterTemplate::Get(), to be deleted at
+// shutdown.  Under lazy_templates_mutex_.
+vector<const PrinterTemplate*>* lazy_templates_ = NULL;
+Mutex* lazy_templates_mutex_ = NULL;
+GOOGLE_PROTOBUF_DECLARE_ONCE(lazy_templates_init_);
+
+void DeleteLazyTemplates() {
+  STLDeleteElements(lazy_templates_);
+  delete lazy_templates_;
+  lazy_templates_ = NULL;
+  delete lazy_templates_mutex_;
+  lazy_templates_mutex_ = NULL;
+}
+
+void InitLazyTemplates() {
+  lazy_templates_ = new vector<const PrinterTemplate*>;
+  lazy_templates_mutex_ = new Mutex;
+  internal::OnShutdown(&DeleteLazyTemplates);
+}
+
+}  // namespace
+
+const PrinterTemplate& LazyPrinterTemplate::Get() {
+  GoogleOnceInit(&once, &LazyPrinterTemplate::Parse, this);
+  return *parsed;
+}
+
+void LazyPrinterTemplate::Parse(LazyPrinterTemplate* lazy) {
+  lazy->parsed = new PrinterTemplate(lazy->text, lazy->variable_delimiter);
+
+  GoogleOnceInit(&lazy_templates_init_, &InitLazyTemplates);
+  MutexLock lock(lazy_templates_mutex_);
+  lazy_templates_->push_back(lazy->parsed);
+}
+
 }  // namespace io
 }  // namespace protobuf
 }  // namespace google
@@ -39,13 +39,16 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/once.h>
 
 namespace google {
 namespace protobuf {
 namespace io {
 
 class ZeroCopyOutputStream;     // zero_copy_stream.h
+class PrinterTemplate;
 
 // This simple utility class assists in code generation.  It basically
 // allows the caller to define a set of variables and then output some
@@ -94,6 +97,24 @@ class LIBPROTOBUF_EXPORT Printer {
   // TODO(kenton):  Overloaded versions with more variables?  Three seems
   //   to be enough.
 
+  // Print a template which was parsed ahead of time.  values[i] is the value
+  // of the variable tmpl.variable_name(i).  This skips both the scan for
+  // delimiters and the variable lookups, so it is the fastest way to print
+  // the same text many times, e.g. once per field.  The template must have
+  // been created with this printer's delimiter.
+  void Print(const PrinterTemplate& tmpl, const string* const values[]);
+  // Like the first Print(), except the text is a precompiled template.  Each
+  // variable of the template is looked up once rather than once per use.
+  void Print(const map<string, string>& variables,
+             const PrinterTemplate& tmpl);
+  // Like the above, except the substitutions are given as parameters.
+  void Print(const PrinterTemplate& tmpl,
+             const char* variable, const string& value);
+  // Like the above, except the substitutions are given as parameters.
+  void Print(const PrinterTemplate& tmpl,
+             const char* variable1, const string& value1,
+             const char* variable2, const string& value2);
+
   // Indent text by two spaces.  After calling Indent(), two spaces will be
   // inserted at the beginning of each line of text.  Indent() may be called
   // multiple times to produce deeper indents.
@@ -121,6 +142,19 @@ class LIBPROTOBUF_EXPORT Printer {
   bool failed() const { return failed_; }
 
  private:
+  // Implements the Print() overloads which take plain text.  Variables are
+  // looked up in "variables" if it is non-NULL, and otherwise among the
+  // "count" name/value pairs given by "names" and "values".
+  void DoPrint(const char* text, const map<string, string>* variables,
+               int count, const char* const names[],
+               const string* const values[]);
+
+  // Looks up all variables of "tmpl" among the given name/value pairs and
+  // prints it.
+  void PrintTemplateWithPairs(const PrinterTemplate& tmpl, int count,
+                              const char* const names[],
+                              const string* const values[]);
+
   const char variable_delimiter_;
 
   ZeroCopyOutputStream* const output_;
@@ -134,6 +168,81 @@ class LIBPROTOBUF_EXPORT Printer {
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(Printer);
 };
 
+// Text for Printer::Print() which has been split into literal text and
+// variable references once, so that it can be printed repeatedly without
+// being parsed again.  Example usage:
+//
+//   PrinterTemplate tmpl("$type$ $name$;\n", '$');
+//   for (int i = 0; i < fields.size(); i++) {
+//     printer.Print(tmpl, "type", fields[i].type, "name", fields[i].name);
+//   }
+//
+// The text is copied, so it need not outlive the template.
+class LIBPROTOBUF_EXPORT PrinterTemplate {
+ public:
+  PrinterTemplate(const char* text, char variable_delimiter);
+  ~PrinterTemplate();
+
+  // The distinct variables used by the template, numbered in order of first
+  // appearance.  These are the indices used by Printer::Print().
+  int variable_count() const { return variable_names_.size(); }
+  const string& variable_name(int index) const {
+    return variable_names_[index];
+  }
+
+  // Returns the index of the named variable, or -1 if the template does not
+  // use it.
+  int FindVariable(const char* name) const;
+
+ private:
+  friend class Printer;
+
+  // A piece of literal text (variable < 0) or a variable reference.  Literal
+  // pieces never contain a newline except as their last character, in which
+  // case ends_line is true.
+  struct Segment {
+    int variable;
+    int start;
+    int size;
+    bool ends_line;
+  };
+
+  const char variable_delimiter_;
+  string text_;
+  vector<Segment> segments_;
+  vector<string> variable_names_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(PrinterTemplate);
+};
+
+// A PrinterTemplate which is parsed the first time it is used.  It is a plain
+// struct so that a function-level static instance is initialized at compile
+// time, and so is safe to share between threads, which a static
+// PrinterTemplate is not with every compiler.  This lets code which prints
+// the same text once per call, e.g. once per field, parse it only once per
+// process while keeping the text where it is printed:
+//
+//   static LazyPrinterTemplate tmpl = { "$type$ $name$;\n", '$' };
+//   printer->Print(variables, tmpl.Get());
+//
+// The parsed template is deleted by ShutdownProtobufLibrary(), after which
+// Get() must not be called.
+struct LIBPROTOBUF_EXPORT LazyPrinterTemplate {
+  // Returns the template, parsing it if this is the first call.
+  const PrinterTemplate& Get();
+
+  // Given by the initializer.  The text must outlive this struct.
+  const char* text;
+  char variable_delimiter;
+
+  // Left zero by the initializer, and set by the first call to Get().
+  ProtobufOnceType once;
+  const PrinterTemplate* parsed;
+
+ private:
+  static void Parse(LazyPrinterTemplate* lazy);
+};
+
 }  // namespace io
 }  // namespace protobuf
 
@@ -168,6 +168,80 @@ TEST(Printer, InlineVariableSubstitution) {
                buffer);
 }
 
+TEST(Printer, TemplateSubstitution) {
+  char buffer[8192];
+
+  for (int block_size = 1; block_size < 512; block_size *= 2) {
+    ArrayOutputStream output(buffer, sizeof(buffer), block_size);
+
+    {
+      Printer printer(&output, '$');
+      PrinterTemplate tmpl("$type$ $name$;  // $name$ costs $$1\n", '$');
+      ASSERT_EQ(2, tmpl.variable_count());
+      EXPECT_EQ("type", tmpl.variable_name(0));
+      EXPECT_EQ("name", tmpl.variable_name(1));
+      EXPECT_EQ(1, tmpl.FindVariable("name"));
+      EXPECT_EQ(-1, tmpl.FindVariable("nosuchvar"));
+
+      string type = "int";
+      string name = "foo";
+      const string* values[] = { &type, &name };
+      printer.Print(tmpl, values);
+
+      printer.Indent();
+      printer.Print(tmpl, "name", "bar", "type", "string");
+      printer.Outdent();
+
+      map<string, string> vars;
+      vars["type"] = "bool";
+      vars["name"] = "baz";
+      vars["unused"] = "unused";
+      printer.Print(vars, tmpl);
+
+      PrinterTemplate no_newline("$foo$", '$');
+      printer.Print(no_newline, "foo", "end");
+
+      EXPECT_FALSE(printer.failed());
+    }
+
+    buffer[output.ByteCount()] = '\0';
+
+    EXPECT_STREQ("int foo;  // foo costs $1\n"
+                 "  string bar;  // bar costs $1\n"
+                 "bool baz;  // baz costs $1\n"
+                 "end",
+                 buffer);
+  }
+}
+
+TEST(Printer, LazyTemplate) {
+  char buffer[8192];
+  ArrayOutputStream output(buffer, sizeof(buffer));
+
+  {
+    Printer printer(&output, '$');
+    map<string, string> vars;
+    for (int i = 0; i < 2; i++) {
+      static LazyPrinterTemplate tmpl = { "$name$ = $value$;\n", '$' };
+      const PrinterTemplate& parsed = tmpl.Get();
+      EXPECT_EQ(&parsed, &tmpl.Get());
+      EXPECT_EQ(2, parsed.variable_count());
+
+      vars["name"] = i == 0 ? "foo" : "bar";
+      vars["value"] = i == 0 ? "0" : "1";
+      printer.Print(vars, parsed);
+    }
+
+    EXPECT_FALSE(printer.failed());
+  }
+
+  buffer[output.ByteCount()] = '\0';
+
+  EXPECT_STREQ("foo = 0;\n"
+               "bar = 1;\n",
+               buffer);
+}
+
 TEST(Printer, Indenting) {
   char buffer[8192];
 
@@ -230,6 +304,11 @@ TEST(Printer, Death) {
   EXPECT_DEBUG_DEATH(printer.Print("$nosuchvar$"), "Undefined variable");
   EXPECT_DEBUG_DEATH(printer.Print("$unclosed"), "Unclosed variable name");
   EXPECT_DEBUG_DEATH(printer.Outdent(), "without matching Indent");
+
+  PrinterTemplate tmpl("$foo$ $bar$", '$');
+  EXPECT_DEBUG_DEATH(printer.Print(tmpl, "foo", "x"), "more variables");
+  EXPECT_DEBUG_DEATH(printer.Print(tmpl, "foo", "x", "baz", "y"),
+                     "Undefined variable");
 }
 #endif  // PROTOBUF_HAS_DEATH_TEST
 
@@ -28,13 +28,17 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+
 #include <google/protobuf/io/strtod.h>
 
+#include <errno.h>
 #include <cstdio>
 #include <cstring>
 #include <string>
+#include <vector>
 
 #include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/once.h>
 
 namespace google {
 namespace protobuf {
@@ -42,7 +46,21 @@ namespace io {
 
 // ----------------------------------------------------------------------
 // NoLocaleStrtod()
-//   This code will make you cry.
+//   Plain decimal numbers -- the only kind .proto files and the text
+//   format produce -- are converted here without looking at the C
+//   locale at all:
+//
+//   * Up to 19 significant digits are accumulated into a uint64 and
+//     multiplied by a 128-bit approximation of the power of ten, as in
+//     "Number Parsing at a Gigabyte per Second" by Daniel Lemire
+//     (the Eisel-Lemire algorithm).  This produces the correctly
+//     rounded double for nearly all inputs and reliably detects the
+//     rare cases where the approximation is not good enough.
+//   * Those cases, subnormals, and inputs with more than 19 significant
+//     digits are handled with exact big integer arithmetic.
+//
+//   Anything else strtod() accepts (hexadecimal floats, "inf", "nan")
+//   is passed through to the C library as before.
 // ----------------------------------------------------------------------
 
 namespace {
@@ -71,9 +89,10 @@ string LocalizeRadix(const char* input, const char* radix_pos) {
   return result;
 }
 
-}  // namespace
-
-double NoLocaleStrtod(const char* text, char** original_endptr) {
+// Parses text with the C library, working around the current locale's
+// radix character.  Only used for the forms ParseDecimal() does not
+// handle.
+double LibcStrtod(const char* text, char** original_endptr) {
   // We cannot simply set the locale to "C" temporarily with setlocale()
   // as this is not thread-safe.  Instead, we try to parse in the current
   // locale first.  If parsing stops at a '.' character, then this is a
@@ -108,6 +127,519 @@ double NoLocaleStrtod(const char* text, char** original_endptr) {
   return result;
 }
 
+inline bool IsDigit(char c) {
+  return '0' <= c && c <= '9';
+}
+
+inline bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' ||
+         c == '\r';
+}
+
+// The Eisel-Lemire table covers 10^kMinPow10 through 10^kMaxPow10.  Any
+// 19-digit mantissa times a power of ten outside that range is certain to
+// underflow to zero or overflow to infinity.
+const int kMinPow10 = -348;
+const int kMaxPow10 = 347;
+
+// The top 128 bits of 10^e, rounded down, and floor(log2(10^e)).
+struct Pow10Entry {
+  uint64 high;
+  uint64 low;
+  int binary_exponent;
+};
+
+Pow10Entry pow10_table[kMaxPow10 - kMinPow10 + 1];
+
+GOOGLE_PROTOBUF_DECLARE_ONCE(pow10_table_once);
+
+// An arbitrary-precision unsigned integer, stored little-endian in base
+// 2^32.  Only the handful of operations that table construction and the
+// slow path need are provided.
+class BigUnsigned {
+ public:
+  explicit BigUnsigned(uint32 value) : limbs_(1, value) {}
+
+  void MultiplyAdd(uint32 factor, uint32 addend) {
+    uint64 carry = addend;
+    for (int i = 0; i < limbs_.size(); i++) {
+      uint64 product = static_cast<uint64>(limbs_[i]) * factor + carry;
+      limbs_[i] = static_cast<uint32>(product);
+      carry = product >> 32;
+    }
+    if (carry != 0) limbs_.push_back(static_cast<uint32>(carry));
+  }
+
+  void Divide(uint32 divisor) {
+    uint64 remainder = 0;
+    for (int i = limbs_.size() - 1; i >= 0; i--) {
+      uint64 dividend = (remainder << 32) | limbs_[i];
+      limbs_[i] = static_cast<uint32>(dividend / divisor);
+      remainder = dividend % divisor;
+    }
+    Trim();
+  }
+
+  void ShiftLeft(int bits) {
+    if (bits <= 0) return;
+    limbs_.insert(limbs_.begin(), bits / 32, 0);
+    bits %= 32;
+    if (bits == 0) return;
+    uint32 carry = 0;
+    for (int i = 0; i < limbs_.size(); i++) {
+      uint32 next_carry = limbs_[i] >> (32 - bits);
+      limbs_[i] = (limbs_[i] << bits) | carry;
+      carry = next_carry;
+    }
+    if (carry != 0) limbs_.push_back(carry);
+  }
+
+  // *this -= other.  Requires *this >= other.
+  void Subtract(const BigUnsigned& other) {
+    int64 borrow = 0;
+    for (int i = 0; i < limbs_.size(); i++) {
+      int64 difference = static_cast<int64>(limbs_[i]) - borrow -
+          (i < other.limbs_.size() ? other.limbs_[i] : 0);
+      borrow = difference < 0 ? 1 : 0;
+      limbs_[i] = static_cast<uint32>(difference);
+    }
+    GOOGLE_DCHECK_EQ(borrow, 0);
+    Trim();
+  }
+
+  int Compare(const BigUnsigned& other) const {
+    if (limbs_.size() != other.limbs_.size()) {
+      return limbs_.size() < other.limbs_.size() ? -1 : 1;
+    }
+    for (int i = limbs_.size() - 1; i >= 0; i--) {
+      if (limbs_[i] != other.limbs_[i]) {
+        return limbs_[i] < other.limbs_[i] ? -1 : 1;
+      }
+    }
+    return 0;
+  }
+
+  bool IsZero() const { return limbs_.size() == 1 && limbs_[0] == 0; }
+
+  int BitLength() const {
+    int bits = (limbs_.size() - 1) * 32;
+    for (uint32 top = limbs_.back(); top != 0; top >>= 1) ++bits;
+    return bits;
+  }
+
+  bool Bit(int index) const {
+    if (index < 0 || index >= limbs_.size() * 32) return false;
+    return (limbs_[index / 32] >> (index % 32)) & 1;
+  }
+
+  // Returns bits [shift, shift + 64).
+  uint64 Bits64(int shift) const {
+    uint64 result = 0;
+    for (int i = 63; i >= 0; i--) {
+      result = (result << 1) | (Bit(shift + i) ? 1 : 0);
+    }
+    return result;
+  }
+
+  // Returns true if any of the bits below index are set.
+  bool AnyBitsBelow(int index) const {
+    for (int i = 0; i < limbs_.size() && i * 32 < index; i++) {
+      uint32 limb = limbs_[i];
+      if ((i + 1) * 32 > index) limb &= (1u << (index % 32)) - 1;
+      if (limb != 0) return true;
+    }
+    return false;
+  }
+
+ private:
+  void Trim() {
+    while (limbs_.size() > 1 && limbs_.back() == 0) limbs_.pop_back();
+  }
+
+  vector<uint32> limbs_;
+};
+
+void InitPow10Table() {
+  BigUnsigned power(1);
+  for (int e = 0; e <= kMaxPow10; e++) {
+    Pow10Entry* entry = &pow10_table[e - kMinPow10];
+    int bits = power.BitLength();
+    entry->high = power.Bits64(bits - 64);
+    entry->low = power.Bits64(bits - 128);
+    entry->binary_exponent = bits - 1;
+    power.MultiplyAdd(10, 0);
+  }
+
+  // floor(2^kShift / 10^k) keeps well over 128 significant bits all the
+  // way down to 10^kMinPow10, and dividing it by ten again is still the
+  // exact floor of the next entry.
+  const int kShift = 1400;
+  BigUnsigned inverse(1);
+  inverse.ShiftLeft(kShift);
+  for (int e = -1; e >= kMinPow10; e--) {
+    inverse.Divide(10);
+    Pow10Entry* entry = &pow10_table[e - kMinPow10];
+    int bits = inverse.BitLength();
+    entry->high = inverse.Bits64(bits - 64);
+    entry->low = inverse.Bits64(bits - 128);
+    entry->binary_exponent = bits - 1 - kShift;
+  }
+}
+
+// Returns the low 64 bits of a * b and stores the high 64 bits in *high.
+inline uint64 Multiply128(uint64 a, uint64 b, uint64* high) {
+  uint64 a_lo = a & 0xffffffffu;
+  uint64 a_hi = a >> 32;
+  uint64 b_lo = b & 0xffffffffu;
+  uint64 b_hi = b >> 32;
+
+  uint64 lo_lo = a_lo * b_lo;
+  uint64 lo_hi = a_lo * b_hi;
+  uint64 hi_lo = a_hi * b_lo;
+  uint64 hi_hi = a_hi * b_hi;
+
+  uint64 middle = (lo_lo >> 32) + (lo_hi & 0xffffffffu) +
+                  (hi_lo & 0xffffffffu);
+  *high = hi_hi + (lo_hi >> 32) + (hi_lo >> 32) + (middle >> 32);
+  return (middle << 32) | (lo_lo & 0xffffffffu);
+}
+
+inline int CountLeadingZeros64(uint64 value) {
+  int count = 0;
+  if ((value >> 32) == 0) { count += 32; value <<= 32; }
+  if ((value >> 48) == 0) { count += 16; value <<= 16; }
+  if ((value >> 56) == 0) { count += 8;  value <<= 8;  }
+  if ((value >> 60) == 0) { count += 4;  value <<= 4;  }
+  if ((value >> 62) == 0) { count += 2;  value <<= 2;  }
+  if ((value >> 63) == 0) { count += 1; }
+  return count;
+}
+
+inline double BitsToDouble(uint64 bits) {
+  double result;
+  memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+// Computes mantissa * 10^exponent, correctly rounded, into *bits.  Returns
+// false if the result could not be determined exactly this way, including
+// whenever it would be subnormal, zero or infinite.  mantissa must be
+// non-zero.
+bool EiselLemire(uint64 mantissa, int exponent, uint64* bits) {
+  if (exponent < kMinPow10 || exponent > kMaxPow10) return false;
+  const Pow10Entry& pow10 = pow10_table[exponent - kMinPow10];
+
+  const int leading_zeros = CountLeadingZeros64(mantissa);
+  mantissa <<= leading_zeros;
+  int binary_exponent = pow10.binary_exponent + 64 + 1023 - leading_zeros;
+
+  // The top 64 bits of the 128-bit product are enough unless the 55 bits
+  // we need are followed by all ones, in which case the lower half of the
+  // power of ten could still carry into them.
+  uint64 x_high;
+  uint64 x_low = Multiply128(mantissa, pow10.high, &x_high);
+  if ((x_high & 0x1ff) == 0x1ff && x_low + mantissa < mantissa) {
+    uint64 y_high;
+    uint64 y_low = Multiply128(mantissa, pow10.low, &y_high);
+    uint64 merged_high = x_high;
+    uint64 merged_low = x_low + y_high;
+    if (merged_low < x_low) ++merged_high;
+    if ((merged_high & 0x1ff) == 0x1ff && merged_low + 1 == 0 &&
+        y_low + mantissa < mantissa) {
+      return false;
+    }
+    x_high = merged_high;
+    x_low = merged_low;
+  }
+
+  // Shift down to 54 bits: 53 for the result plus one for rounding.
+  const int msb = static_cast<int>(x_high >> 63);
+  uint64 result = x_high >> (msb + 9);
+  binary_exponent -= 1 ^ msb;
+
+  // An exact halfway case might be a truncation artifact.
+  if (x_low == 0 && (x_high & 0x1ff) == 0 && (result & 3) == 1) {
+    return false;
+  }
+
+  result += result & 1;
+  result >>= 1;
+  if ((result >> 53) != 0) {
+    result >>= 1;
+    ++binary_exponent;
+  }
+
+  if (binary_exponent <= 0 || binary_exponent >= 0x7ff) return false;
+  *bits = (static_cast<uint64>(binary_exponent) << 52) |
+          (result & ((GOOGLE_ULONGLONG(1) << 52) - 1));
+  return true;
+}
+
+// Beyond this many significant digits, only whether the rest are all zero
+// matters: the decimal expansion of a halfway point between two doubles
+// never has more than 767 significant digits.
+const int kMaxSignificantDigits = 800;
+
+// Exactly converts the number spelled by the digits in [begin, end), which
+// start with a non-zero digit and may contain a '.', times 10^exponent.
+// in_fraction says whether begin is already past the '.'.  Handles every
+// case EiselLemire() gives up on.  Sets *out_of_range when strtod() would
+// set ERANGE: the result is infinite, or it is inexact and, rounded to 53
+// bits with an unbounded exponent, below the smallest normal double.
+uint64 SlowDecimalToDouble(const char* begin, const char* end,
+                           bool in_fraction, int exponent,
+                           bool* out_of_range) {
+  *out_of_range = false;
+  BigUnsigned value(0);
+  int digits = 0;
+  bool truncated = false;
+  for (const char* p = begin; p < end; p++) {
+    if (*p == '.') {
+      in_fraction = true;
+    } else if (digits < kMaxSignificantDigits) {
+      value.MultiplyAdd(10, *p - '0');
+      ++digits;
+      if (in_fraction) --exponent;
+    } else {
+      if (!in_fraction) ++exponent;
+      if (*p != '0') truncated = true;
+    }
+  }
+  if (truncated) {
+    // Stand in for the dropped digits with a single non-zero one.
+    value.MultiplyAdd(10, 1);
+    ++digits;
+    --exponent;
+  }
+
+  // Values with a leading digit below 10^-343 round to zero, values of
+  // 10^310 and up to infinity.
+  if (exponent + digits < -342 || exponent + digits > 310) {
+    *out_of_range = true;
+    return exponent + digits < -342 ? 0 : GOOGLE_ULONGLONG(0x7ff) << 52;
+  }
+
+  // Find 64 significant bits of the value, whether any bits below those
+  // are set, and the binary exponent of the lowest of the 64.
+  uint64 top;
+  bool sticky;
+  int binary_exponent;
+  if (exponent >= 0) {
+    for (int i = 0; i < exponent; i++) value.MultiplyAdd(10, 0);
+    int bits = value.BitLength();
+    top = value.Bits64(bits - 64);
+    sticky = value.AnyBitsBelow(bits - 64);
+    binary_exponent = bits - 64;
+  } else {
+    // value / 10^-exponent, by long division after scaling the numerator
+    // so that the quotient has at least 64 bits.
+    BigUnsigned divisor(1);
+    for (int i = 0; i < -exponent; i++) divisor.MultiplyAdd(10, 0);
+    int shift = divisor.BitLength() - value.BitLength() + 64;
+    if (shift < 0) shift = 0;
+    value.ShiftLeft(shift);
+
+    BigUnsigned remainder(0);
+    BigUnsigned quotient(0);
+    for (int i = value.BitLength() - 1; i >= 0; i--) {
+      remainder.ShiftLeft(1);
+      if (value.Bit(i)) remainder.MultiplyAdd(1, 1);
+      quotient.ShiftLeft(1);
+      if (remainder.Compare(divisor) >= 0) {
+        remainder.Subtract(divisor);
+        quotient.MultiplyAdd(1, 1);
+      }
+    }
+    int bits = quotient.BitLength();
+    top = quotient.Bits64(bits - 64);
+    sticky = quotient.AnyBitsBelow(bits - 64) || !remainder.IsZero();
+    binary_exponent = bits - 64 - shift;
+  }
+
+  // top * 2^binary_exponent, with top's highest bit set.  Keep 53 bits
+  // for a normal result, fewer for a subnormal one, and round half to
+  // even.
+  int biased_exponent = binary_exponent + 63 + 1023;
+  // Like glibc, a result is only tiny if it is still below the smallest
+  // normal number after rounding to the full 53 bits.
+  bool tiny = biased_exponent < 0;
+  if (biased_exponent == 0) {
+    tiny = (top >> 11) != (GOOGLE_ULONGLONG(1) << 53) - 1 ||
+           (top & 0x7ff) < 0x400;
+  }
+  int drop = 11;
+  if (biased_exponent <= 0) drop += 1 - biased_exponent;
+  if (drop > 64) {
+    *out_of_range = true;
+    return 0;
+  }
+
+  uint64 result = drop == 64 ? 0 : top >> drop;
+  uint64 rest = drop == 64 ? top : top & ((GOOGLE_ULONGLONG(1) << drop) - 1);
+  uint64 half = GOOGLE_ULONGLONG(1) << (drop - 1);
+  if (rest > half || (rest == half && (sticky || (result & 1) != 0))) {
+    ++result;
+  }
+  if (tiny && (rest != 0 || sticky)) *out_of_range = true;
+
+  uint64 bits;
+  if (biased_exponent <= 0) {
+    // A carry out of the subnormal range lands exactly on the smallest
+    // normal number's encoding.
+    bits = result;
+  } else {
+    // result includes the implicit leading bit, which adds one to the
+    // exponent field; a carry out of the mantissa adds another.
+    bits = (static_cast<uint64>(biased_exponent - 1) << 52) + result;
+  }
+  if ((bits >> 52) >= 0x7ff) {
+    *out_of_range = true;
+    bits = GOOGLE_ULONGLONG(0x7ff) << 52;
+  }
+  return bits;
+}
+
+// Parses a decimal floating-point number at text, after any sign.  Returns
+// false, without touching the outputs, if text does not start with one.
+// Sets errno to ERANGE like glibc's strtod() if a non-zero number overflows,
+// or underflows to zero or an inexact subnormal.
+bool ParseDecimal(const char* text, double* result, const char** endptr) {
+  const char* p = text;
+
+  // Leading zeros carry no information.
+  bool any_digits = false;
+  while (*p == '0') {
+    ++p;
+    any_digits = true;
+  }
+
+  // Accumulate up to 19 significant digits; note where they start so the
+  // slow path can read them all again.
+  const char* significant_begin = p;
+  bool begins_in_fraction = false;
+  uint64 mantissa = 0;
+  int num_digits = 0;
+  int exponent = 0;
+  int leading_fraction_zeros = 0;
+  bool truncated = false;
+  for (; IsDigit(*p); p++) {
+    any_digits = true;
+    if (num_digits < 19) {
+      mantissa = mantissa * 10 + (*p - '0');
+      ++num_digits;
+    } else {
+      ++exponent;
+      if (*p != '0') truncated = true;
+    }
+  }
+  if (*p == '.') {
+    const char* fraction = p + 1;
+    if (IsDigit(*fraction) || any_digits) {
+      p = fraction;
+      if (num_digits == 0) {
+        // Still in leading zeros.
+        while (*p == '0') {
+          ++p;
+          ++leading_fraction_zeros;
+          any_digits = true;
+        }
+        significant_begin = p;
+        begins_in_fraction = true;
+      }
+      for (; IsDigit(*p); p++) {
+        any_digits = true;
+        if (num_digits < 19) {
+          mantissa = mantissa * 10 + (*p - '0');
+          ++num_digits;
+          --exponent;
+        } else if (*p != '0') {
+          truncated = true;
+        }
+      }
+    }
+  }
+  if (!any_digits) return false;
+  const char* significant_end = p;
+
+  // An exponent only counts if it has at least one digit.
+  int explicit_exponent = 0;
+  if (*p == 'e' || *p == 'E') {
+    const char* q = p + 1;
+    bool negative_exponent = false;
+    if (*q == '+' || *q == '-') {
+      negative_exponent = *q == '-';
+      ++q;
+    }
+    if (IsDigit(*q)) {
+      // Anything beyond this makes the result zero or infinity anyway; the
+      // cap just keeps the arithmetic from overflowing.
+      for (; IsDigit(*q); q++) {
+        if (explicit_exponent < 100000) {
+          explicit_exponent = explicit_exponent * 10 + (*q - '0');
+        }
+      }
+      if (negative_exponent) explicit_exponent = -explicit_exponent;
+      p = q;
+    }
+  }
+  *endptr = p;
+  exponent += explicit_exponent - leading_fraction_zeros;
+
+  if (mantissa == 0) {
+    *result = 0.0;
+    return true;
+  }
+
+  uint64 bits;
+  uint64 upper_bits;
+  bool fast = EiselLemire(mantissa, exponent, &bits);
+  if (fast && truncated) {
+    // The true value lies strictly between mantissa and mantissa + 1 (in
+    // units of the last digit kept).  If both ends round to the same
+    // double, so does the value.
+    fast = EiselLemire(mantissa + 1, exponent, &upper_bits) &&
+           upper_bits == bits;
+  }
+  if (!fast) {
+    bool out_of_range;
+    bits = SlowDecimalToDouble(significant_begin, significant_end,
+                               begins_in_fraction,
+                               explicit_exponent - leading_fraction_zeros,
+                               &out_of_range);
+    if (out_of_range) errno = ERANGE;
+  }
+  *result = BitsToDouble(bits);
+  return true;
+}
+
+}  // namespace
+
+double NoLocaleStrtod(const char* text, char** original_endptr) {
+  GoogleOnceInit(&pow10_table_once, &InitPow10Table);
+
+  const char* p = text;
+  while (IsSpace(*p)) ++p;
+  bool negative = false;
+  if (*p == '+' || *p == '-') {
+    negative = *p == '-';
+    ++p;
+  }
+
+  // Hexadecimal floats, infinities and NaNs go to the C library.
+  double result;
+  const char* endptr;
+  if ((p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) ||
+      !ParseDecimal(p, &result, &endptr)) {
+    return LibcStrtod(text, original_endptr);
+  }
+
+  if (original_endptr != NULL) {
+    // const_cast is necessary to match the strtod() interface.
+    *original_endptr = const_cast<char*>(endptr);
+  }
+  return negative ? -result : result;
+}
+
 }  // namespace io
 }  // namespace protobuf
 }  // namespace google
@@ -29,8 +29,8 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 // A locale-independent version of strtod(), used to parse floating
-// point default values in .proto files, where the decimal separator
-// is always a dot.
+// point default values in .proto files and floats in the text format,
+// where the decimal separator is always a dot.
 
 #ifndef GOOGLE_PROTOBUF_IO_STRTOD_H__
 #define GOOGLE_PROTOBUF_IO_STRTOD_H__
@@ -40,7 +40,11 @@ namespace protobuf {
 namespace io {
 
 // A locale-independent version of the standard strtod(), which always
-// uses a dot as the decimal separator.
+// uses a dot as the decimal separator.  Decimal numbers are converted
+// without calling the C library and without allocating, and the result
+// is always the correctly rounded double.  Like glibc's strtod(), errno is
+// set to ERANGE when the result overflows to infinity, or underflows to
+// zero or to a subnormal number that is not exact.
 double NoLocaleStrtod(const char* str, char** endptr);
 
 }  // namespace io
@@ -0,0 +1,238 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <google/protobuf/io/strtod.h>
+
+#include <errno.h>
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits>
+#include <string>
+
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace io {
+namespace {
+
+// Parses text, expects it to be consumed up to the given number of bytes,
+// and returns the value.
+double Parse(const char* text, int expected_length) {
+  char* end;
+  double result = NoLocaleStrtod(text, &end);
+  EXPECT_EQ(expected_length, end - text) << text;
+  return result;
+}
+
+// Compares bit patterns, so that 0.0 and -0.0 are told apart.
+void ExpectSameDouble(double expected, double actual, const string& text) {
+  EXPECT_EQ(0, memcmp(&expected, &actual, sizeof(double)))
+      << text << ": expected " << expected << ", got " << actual;
+}
+
+TEST(NoLocaleStrtodTest, Basic) {
+  EXPECT_EQ(1.5, Parse("1.5", 3));
+  EXPECT_EQ(-1.5, Parse("-1.5", 4));
+  EXPECT_EQ(1.5, Parse("+1.5", 4));
+  EXPECT_EQ(0.25, Parse("  .25", 5));
+  EXPECT_EQ(1.0, Parse("1.", 2));
+  EXPECT_EQ(100.0, Parse("1e2", 3));
+  EXPECT_EQ(0.01, Parse("1E-2", 4));
+  EXPECT_EQ(123.0, Parse("0000123", 7));
+  EXPECT_EQ(0.000123, Parse("0.000123", 8));
+  EXPECT_EQ(1.0, Parse("1e", 1));
+  EXPECT_EQ(1.0, Parse("1e+", 1));
+  EXPECT_EQ(1.5, Parse("1.5f", 3));
+  EXPECT_EQ(2.0, Parse("2abc", 1));
+  ExpectSameDouble(0.0, Parse("0", 1), "0");
+  ExpectSameDouble(-0.0, Parse("-0.0", 4), "-0.0");
+}
+
+TEST(NoLocaleStrtodTest, NotANumber) {
+  EXPECT_EQ(0.0, Parse("", 0));
+  EXPECT_EQ(0.0, Parse(".", 0));
+  EXPECT_EQ(0.0, Parse("-", 0));
+  EXPECT_EQ(0.0, Parse("e5", 0));
+  EXPECT_EQ(0.0, Parse("abc", 0));
+}
+
+TEST(NoLocaleStrtodTest, LibcForms) {
+  EXPECT_EQ(numeric_limits<double>::infinity(), Parse("inf", 3));
+  EXPECT_EQ(-numeric_limits<double>::infinity(), Parse("-infinity", 9));
+  double nan = Parse("nan", 3);
+  EXPECT_NE(nan, nan);
+  EXPECT_EQ(16.0, Parse("0x10", 4));
+}
+
+TEST(NoLocaleStrtodTest, Extremes) {
+  EXPECT_EQ(numeric_limits<double>::max(),
+            Parse("1.7976931348623157e308", 22));
+  EXPECT_EQ(numeric_limits<double>::min(),
+            Parse("2.2250738585072014e-308", 23));
+  EXPECT_EQ(numeric_limits<double>::denorm_min(), Parse("5e-324", 6));
+  EXPECT_EQ(numeric_limits<double>::denorm_min(),
+            Parse("2.4703282292062328e-324", 23));
+  EXPECT_EQ(0.0, Parse("2.4703282292062327e-324", 23));
+
+  errno = 0;
+  EXPECT_EQ(numeric_limits<double>::infinity(), Parse("1e309", 5));
+  EXPECT_EQ(ERANGE, errno);
+  errno = 0;
+  EXPECT_EQ(0.0, Parse("1e-400", 6));
+  EXPECT_EQ(ERANGE, errno);
+  EXPECT_EQ(0.0, Parse("1e-99999999999999999999", 23));
+  EXPECT_EQ(numeric_limits<double>::infinity(),
+            Parse("1e+99999999999999999999", 23));
+}
+
+TEST(NoLocaleStrtodTest, UnderflowSetsErrno) {
+  // Inexact subnormals underflow, as in glibc.
+  errno = 0;
+  EXPECT_EQ(numeric_limits<double>::denorm_min(), Parse("5e-324", 6));
+  EXPECT_EQ(ERANGE, errno);
+  errno = 0;
+  Parse("1e-320", 6);
+  EXPECT_EQ(ERANGE, errno);
+
+  // Below the smallest normal number, but rounding to it at full precision.
+  errno = 0;
+  EXPECT_EQ(numeric_limits<double>::min(),
+            Parse("2.2250738585072013e-308", 23));
+  EXPECT_EQ(0, errno);
+  // Rounding to it only at the reduced precision of subnormals.
+  errno = 0;
+  EXPECT_EQ(numeric_limits<double>::min(),
+            Parse("2.2250738585072012e-308", 23));
+  EXPECT_EQ(ERANGE, errno);
+
+  // Normal numbers and exact subnormals do not.
+  errno = 0;
+  EXPECT_EQ(numeric_limits<double>::min(),
+            Parse("2.2250738585072014e-308", 23));
+  EXPECT_EQ(0.5, Parse("0.5", 3));
+  EXPECT_EQ(0, errno);
+  // 2^-1074, written out in full.
+  string exact = "0." + string(323, '0') +
+      "4940656458412465441765687928682213723650598026143247644255856825006755"
+      "0727020875186529983636163599237979656469544571773092665671035593979639"
+      "8774796010781878126300713190311404527845817167848982103688718636056998"
+      "7307230500063874091535649843873124733972731696151400317153853980741262"
+      "3856559117102665855668676818703956031062493194527159149245532930545654"
+      "4401127480129709999541931989409080416563324524757147869014726780159355"
+      "2386115501348035264934720193790268107107491703332226844753335720832431"
+      "9360923828934583680601060115061698097530783422773183292479049825247307"
+      "7637592724787465608477820373446969953364701797267771758512566055119913"
+      "1504891101451037862738167250955837389733598993664809941164205702637090"
+      "279242767544565229087538682506419718265533447265625";
+  errno = 0;
+  EXPECT_EQ(numeric_limits<double>::denorm_min(),
+            Parse(exact.c_str(), exact.size()));
+  EXPECT_EQ(0, errno);
+}
+
+TEST(NoLocaleStrtodTest, HalfwayCases) {
+  // 2^53 + 1 is exactly halfway between two doubles and rounds to even,
+  // unless any later digit is non-zero.
+  EXPECT_EQ(9007199254740992.0, Parse("9007199254740993", 16));
+  EXPECT_EQ(9007199254740994.0,
+            Parse("9007199254740993.000000000000000000000000001", 44));
+  EXPECT_EQ(9007199254740996.0, Parse("9007199254740995", 16));
+
+  // The same for a long mantissa that has to be truncated.
+  string text = "9007199254740993";
+  text.append(1000, '0');
+  text += "1e-1001";
+  EXPECT_EQ(9007199254740994.0, Parse(text.c_str(), text.size()));
+}
+
+TEST(NoLocaleStrtodTest, MatchesLibc) {
+  // glibc's strtod() is correctly rounded; compare against it on random
+  // inputs of every length, including exactly printed doubles.
+  char* old_locale = setlocale(LC_NUMERIC, NULL);
+  ASSERT_TRUE(old_locale != NULL);
+  string saved_locale = old_locale;
+  setlocale(LC_NUMERIC, "C");
+
+  uint64 state = 42;
+  for (int i = 0; i < 50000; i++) {
+    state = state * GOOGLE_ULONGLONG(6364136223846793005) +
+            GOOGLE_ULONGLONG(1442695040888963407);
+    char text[64];
+    if (i % 2 == 0) {
+      double value;
+      memcpy(&value, &state, sizeof(value));
+      if (value != value || value - value != 0) continue;
+      snprintf(text, sizeof(text), "%.*g", 1 + static_cast<int>(i % 20),
+               value);
+    } else {
+      int num_digits = 1 + static_cast<int>((state >> 8) % 40);
+      uint64 digits_state = state;
+      for (int j = 0; j < num_digits; j++) {
+        digits_state = digits_state * GOOGLE_ULONGLONG(6364136223846793005) +
+                       GOOGLE_ULONGLONG(1442695040888963407);
+        text[j] = '0' + static_cast<int>((digits_state >> 33) % 10);
+      }
+      snprintf(text + num_digits, sizeof(text) - num_digits, "e%d",
+               static_cast<int>((state >> 40) % 700) - 360);
+    }
+    ExpectSameDouble(strtod(text, NULL), NoLocaleStrtod(text, NULL), text);
+  }
+
+  setlocale(LC_NUMERIC, saved_locale.c_str());
+}
+
+TEST(NoLocaleStrtodTest, ImmuneToLocales) {
+  char* old_locale = setlocale(LC_NUMERIC, NULL);
+  ASSERT_TRUE(old_locale != NULL);
+  string saved_locale = old_locale;
+
+  if (setlocale(LC_NUMERIC, "es_ES") == NULL &&
+      setlocale(LC_NUMERIC, "es_ES.utf8") == NULL) {
+    // Some systems may not have the desired locale available.
+    GOOGLE_LOG(WARNING)
+      << "Couldn't set locale to es_ES.  Skipping this test.";
+  } else {
+    EXPECT_EQ(1.5, Parse("1.5", 3));
+    EXPECT_EQ(1.25e10, Parse("1.25e10", 7));
+  }
+
+  setlocale(LC_NUMERIC, saved_locale.c_str());
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
@@ -142,6 +142,12 @@ CHARACTER_CLASS(Alphanumeric, ('a' <= c && c <= 'z') ||
                               ('0' <= c && c <= '9') ||
                               (c == '_'));
 
+// Characters which may appear in the body of a line comment, and in a line of
+// a block comment up to the next character that might end it.
+CHARACTER_CLASS(LineCommentChar, c != '\0' && c != '\n');
+CHARACTER_CLASS(BlockCommentChar, c != '\0' && c != '\n' &&
+                                  c != '*' && c != '/');
+
 CHARACTER_CLASS(Escape, c == 'a' || c == 'b' || c == 'f' || c == 'n' ||
                         c == 'r' || c == 't' || c == 'v' || c == '\\' ||
                         c == '?' || c == '\'' || c == '\"');
@@ -296,7 +302,16 @@ inline void Tokenizer::StartToken() {
 }
 
 inline void Tokenizer::EndToken() {
-  StopRecording();
+  if (current_.text.empty()) {
+    // The token lies within one buffer, as most do, so Refresh() has not
+    // recorded any of it yet.  Assigning the text in one step is cheaper
+    // than appending it to the cleared string.
+    current_.text.assign(buffer_ + record_start_, buffer_pos_ - record_start_);
+    record_target_ = NULL;
+    record_start_ = -1;
+  } else {
+    StopRecording();
+  }
   current_.end_column = column_;
 }
 
@@ -330,6 +345,20 @@ inline bool Tokenizer::TryConsume(char c) {
 template<typename CharacterClass>
 inline void Tokenizer::ConsumeZeroOrMore() {
   while (CharacterClass::InClass(current_char_)) {
+    if (current_char_ != '\n' && current_char_ != '\t') {
+      // Everything but '\n' and '\t' just advances the column by one, so skip
+      // over a run of such characters within the current buffer in one step
+      // and let NextChar() consume only the last of them.  Recording is not
+      // affected since it only looks at buffer_pos_.
+      int run_end = buffer_pos_ + 1;
+      while (run_end < buffer_size_ &&
+             buffer_[run_end] != '\n' && buffer_[run_end] != '\t' &&
+             CharacterClass::InClass(buffer_[run_end])) {
+        ++run_end;
+      }
+      column_ += run_end - 1 - buffer_pos_;
+      buffer_pos_ = run_end - 1;
+    }
     NextChar();
   }
 }
@@ -339,9 +368,7 @@ inline void Tokenizer::ConsumeOneOrMore(const char* error) {
   if (!CharacterClass::InClass(current_char_)) {
     AddError(error);
   } else {
-    do {
-      NextChar();
-    } while (CharacterClass::InClass(current_char_));
+    ConsumeZeroOrMore<CharacterClass>();
   }
 }
 
@@ -476,9 +503,7 @@ Tokenizer::TokenType Tokenizer::ConsumeNumber(bool started_with_zero,
 void Tokenizer::ConsumeLineComment(string* content) {
   if (content != NULL) RecordTo(content);
 
-  while (current_char_ != '\0' && current_char_ != '\n') {
-    NextChar();
-  }
+  ConsumeZeroOrMore<LineCommentChar>();
   TryConsume('\n');
 
   if (content != NULL) StopRecording();
@@ -491,12 +516,7 @@ void Tokenizer::ConsumeBlockComment(string* content) {
   if (content != NULL) RecordTo(content);
 
   while (true) {
-    while (current_char_ != '\0' &&
-           current_char_ != '*' &&
-           current_char_ != '/' &&
-           current_char_ != '\n') {
-      NextChar();
-    }
+    ConsumeZeroOrMore<BlockCommentChar>();
 
     if (TryConsume('\n')) {
       if (content != NULL) StopRecording();
@@ -559,7 +579,13 @@ Tokenizer::NextCommentStatus Tokenizer::TryConsumeCommentStart() {
 // -------------------------------------------------------------------
 
 bool Tokenizer::Next() {
-  previous_ = current_;
+  // current_ is about to be overwritten, so hand its text over to previous_
+  // rather than copying it.  Every path below resets current_.text.
+  previous_.type = current_.type;
+  previous_.text.swap(current_.text);
+  previous_.line = current_.line;
+  previous_.column = current_.column;
+  previous_.end_column = current_.end_column;
 
   while (!read_error_) {
     ConsumeZeroOrMore<Whitespace>();
@@ -992,6 +992,41 @@ TEST_1D(TokenizerTest, BackUpOnDestruction, kBlockSizes) {
   EXPECT_EQ(strlen("foo"), input.ByteCount());
 }
 
+TEST_1D(TokenizerTest, LongTokens, kBlockSizes) {
+  // Runs of characters longer than any block, mixed with tabs and comments,
+  // must come out with the same text and columns as when read one by one.
+  string identifier(100, 'a');
+  string number(50, '7');
+  string text = identifier + "\t" + number + "  // a comment\twith a tab\n" +
+                "\t/* block\t" + identifier + " */ " + identifier;
+  TestInputStream input(text.data(), text.size(), kBlockSizes_case);
+  TestErrorCollector error_collector;
+  Tokenizer tokenizer(&input, &error_collector);
+
+  ASSERT_TRUE(tokenizer.Next());
+  EXPECT_EQ(identifier, tokenizer.current().text);
+  EXPECT_EQ(0, tokenizer.current().column);
+  EXPECT_EQ(100, tokenizer.current().end_column);
+
+  ASSERT_TRUE(tokenizer.Next());
+  EXPECT_EQ(number, tokenizer.current().text);
+  EXPECT_EQ(Tokenizer::TYPE_INTEGER, tokenizer.current().type);
+  EXPECT_EQ(104, tokenizer.current().column);
+  EXPECT_EQ(154, tokenizer.current().end_column);
+  EXPECT_EQ(identifier, tokenizer.previous().text);
+
+  ASSERT_TRUE(tokenizer.Next());
+  EXPECT_EQ(identifier, tokenizer.current().text);
+  EXPECT_EQ(1, tokenizer.current().line);
+  EXPECT_EQ(128, tokenizer.current().column);
+  EXPECT_EQ(number, tokenizer.previous().text);
+
+  EXPECT_FALSE(tokenizer.Next());
+  EXPECT_EQ(identifier, tokenizer.previous().text);
+  EXPECT_TRUE(tokenizer.current().text.empty());
+  EXPECT_TRUE(error_collector.text_.empty());
+}
+
 
 }  // namespace
 }  // namespace io
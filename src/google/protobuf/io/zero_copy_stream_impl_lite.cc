@@ -197,6 +197,111 @@ int64 StringOutputStream::ByteCount() const {
 
 // ===================================================================
 
+IovecOutputStream::IovecOutputStream(int min_alias_size, int block_size)
+  : min_alias_size_(min_alias_size),
+    block_size_(block_size),
+    next_block_(0),
+    position_(NULL),
+    block_end_(NULL),
+    byte_count_(0),
+    last_returned_size_(0) {
+  GOOGLE_CHECK_GT(min_alias_size_, 0);
+  GOOGLE_CHECK_GT(block_size_, 0);
+}
+
+IovecOutputStream::~IovecOutputStream() {
+  for (int i = 0; i < blocks_.size(); i++) {
+    delete [] blocks_[i];
+  }
+}
+
+void IovecOutputStream::Clear() {
+  next_block_ = 0;
+  position_ = NULL;
+  block_end_ = NULL;
+  segments_.clear();
+  byte_count_ = 0;
+  last_returned_size_ = 0;
+}
+
+bool IovecOutputStream::Next(void** data, int* size) {
+  if (position_ == block_end_) {
+    if (next_block_ == blocks_.size()) {
+      blocks_.push_back(new uint8[block_size_]);
+    }
+    position_ = blocks_[next_block_++];
+    block_end_ = position_ + block_size_;
+  }
+
+  last_returned_size_ = min(min_alias_size_,
+                            static_cast<int>(block_end_ - position_));
+  *data = position_;
+  *size = last_returned_size_;
+  AddSegment(position_, last_returned_size_);
+  position_ += last_returned_size_;
+  return true;
+}
+
+void IovecOutputStream::BackUp(int count) {
+  GOOGLE_CHECK_GT(last_returned_size_, 0)
+      << "BackUp() can only be called after a successful Next().";
+  GOOGLE_CHECK_LE(count, last_returned_size_);
+  GOOGLE_CHECK_GE(count, 0);
+  // The chunk returned by Next() is at the end of the last segment.
+  position_ -= count;
+  byte_count_ -= count;
+  Segment* last = &segments_.back();
+  last->size -= count;
+  if (last->size == 0) {
+    segments_.pop_back();
+  }
+  last_returned_size_ = 0;  // Don't let caller back up further.
+}
+
+int64 IovecOutputStream::ByteCount() const {
+  return byte_count_;
+}
+
+bool IovecOutputStream::WriteAliasedRaw(const void* data, int size) {
+  last_returned_size_ = 0;  // Don't let caller back up.
+  if (size >= min_alias_size_) {
+    AddSegment(data, size);
+    return true;
+  }
+
+  // Too small to be worth a segment of its own; copy it to scratch space.
+  const uint8* in = reinterpret_cast<const uint8*>(data);
+  while (size > 0) {
+    void* out;
+    int out_size;
+    Next(&out, &out_size);
+    if (out_size > size) {
+      BackUp(out_size - size);
+      out_size = size;
+    }
+    memcpy(out, in, out_size);
+    in += out_size;
+    size -= out_size;
+  }
+  last_returned_size_ = 0;
+  return true;
+}
+
+void IovecOutputStream::AddSegment(const void* data, int size) {
+  byte_count_ += size;
+  if (!segments_.empty()) {
+    Segment* last = &segments_.back();
+    if (reinterpret_cast<const uint8*>(last->data) + last->size == data) {
+      last->size += size;
+      return;
+    }
+  }
+  Segment segment = { data, size };
+  segments_.push_back(segment);
+}
+
+// ===================================================================
+
 CopyingInputStream::~CopyingInputStream() {}
 
 int CopyingInputStream::Skip(int count) {
@@ -46,6 +46,7 @@
 
 #include <string>
 #include <iosfwd>
+#include <vector>
 #include <google/protobuf/io/zero_copy_stream.h>
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/stubs/stl_util.h>
@@ -157,6 +158,72 @@ class LIBPROTOBUF_EXPORT StringOutputStream : public ZeroCopyOutputStream {
 
 // ===================================================================
 
+// A ZeroCopyOutputStream which gathers its output into a list of segments
+// for scatter-gather I/O, such as writev() or a DMA engine's descriptor
+// list, instead of one contiguous buffer.  Small writes are copied into
+// scratch blocks owned by the stream, and adjacent copies share a segment.
+// Chunks of at least min_alias_size bytes passed to WriteAliasedRaw() get
+// a segment of their own which points at the caller's memory.
+//
+// Use it with CodedOutputStream::EnableAliasing(), or simply call
+// MessageLite::SerializeToIovecs(), so that large string and bytes fields
+// are referenced in place.  The segments are valid until the stream is
+// cleared or destroyed, and only while the aliased data is unchanged.
+class LIBPROTOBUF_EXPORT IovecOutputStream : public ZeroCopyOutputStream {
+ public:
+  // One contiguous run of the output.
+  struct Segment {
+    const void* data;
+    int size;
+  };
+
+  static const int kDefaultMinAliasSize = 512;
+  static const int kDefaultBlockSize = 8192;
+
+  // Next() returns at most min_alias_size bytes at a time, so that a
+  // CodedOutputStream passes every chunk at least that large on to
+  // WriteAliasedRaw() rather than copying it.  Scratch space is allocated
+  // block_size bytes at a time.
+  explicit IovecOutputStream(int min_alias_size = kDefaultMinAliasSize,
+                             int block_size = kDefaultBlockSize);
+  ~IovecOutputStream();
+
+  // The output so far, in order.
+  const vector<Segment>& segments() const { return segments_; }
+
+  // Discards the output so far, keeping the scratch blocks for reuse.
+  void Clear();
+
+  // implements ZeroCopyOutputStream ---------------------------------
+  bool Next(void** data, int* size);
+  void BackUp(int count);
+  int64 ByteCount() const;
+  bool WriteAliasedRaw(const void* data, int size);
+  bool AllowsAliasing() const { return true; }
+
+ private:
+  // Appends |size| bytes at |data| to the output, extending the last
+  // segment if they follow it in memory.
+  void AddSegment(const void* data, int size);
+
+  const int min_alias_size_;
+  const int block_size_;
+
+  vector<uint8*> blocks_;  // Scratch blocks, each block_size_ bytes.
+  int next_block_;         // Index in blocks_ of the next block to use.
+  uint8* position_;        // Free space in the current block.
+  uint8* block_end_;
+
+  vector<Segment> segments_;
+  int64 byte_count_;
+  int last_returned_size_;  // How many bytes we returned last time Next()
+                            // was called (used for error checking only).
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(IovecOutputStream);
+};
+
+// ===================================================================
+
 // A generic traditional input stream interface.
 //
 // Lots of traditional input streams (e.g. file descriptors, C stdio
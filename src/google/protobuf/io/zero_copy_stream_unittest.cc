@@ -710,6 +710,68 @@ TEST_F(IoTest, StringIo) {
   }
 }
 
+// Concatenates the segments of an IovecOutputStream.
+string JoinSegments(const IovecOutputStream& output) {
+  string result;
+  for (int i = 0; i < output.segments().size(); i++) {
+    const IovecOutputStream::Segment& segment = output.segments()[i];
+    EXPECT_GT(segment.size, 0);
+    result.append(reinterpret_cast<const char*>(segment.data), segment.size);
+  }
+  return result;
+}
+
+TEST_F(IoTest, IovecIo) {
+  for (int i = 1; i < kBlockSizeCount; i++) {
+    for (int j = 1; j < kBlockSizeCount; j++) {
+      IovecOutputStream output(kBlockSizes[i], kBlockSizes[j]);
+      int size = WriteStuff(&output);
+      string str = JoinSegments(output);
+      EXPECT_EQ(size, str.size());
+
+      ArrayInputStream input(str.data(), str.size());
+      ReadStuff(&input);
+    }
+  }
+}
+
+TEST_F(IoTest, IovecIoAliasing) {
+  const string small(10, 'a');
+  const string large(1000, 'b');
+
+  IovecOutputStream output(100);
+  EXPECT_TRUE(output.AllowsAliasing());
+  {
+    CodedOutputStream coded_output(&output);
+    coded_output.EnableAliasing(true);
+    coded_output.WriteVarint32(small.size());
+    coded_output.WriteRawMaybeAliased(small.data(), small.size());
+    coded_output.WriteVarint32(large.size());
+    coded_output.WriteRawMaybeAliased(large.data(), large.size());
+    coded_output.WriteVarint32(small.size());
+    coded_output.WriteRawMaybeAliased(small.data(), small.size());
+  }
+
+  // The small chunks and their sizes are copied, the large one is not.
+  ASSERT_EQ(3, output.segments().size());
+  EXPECT_EQ(13, output.segments()[0].size);
+  EXPECT_EQ(large.data(), output.segments()[1].data);
+  EXPECT_EQ(large.size(), output.segments()[1].size);
+  EXPECT_EQ(11, output.segments()[2].size);
+  EXPECT_EQ(1024, output.ByteCount());
+  EXPECT_TRUE("\x0a" + small + "\xe8\x07" + large + "\x0a" + small ==
+              JoinSegments(output));
+
+  // Clearing the stream discards the output but reuses its scratch space.
+  const void* scratch = output.segments()[0].data;
+  output.Clear();
+  EXPECT_EQ(0, output.ByteCount());
+  EXPECT_TRUE(output.segments().empty());
+  WriteString(&output, small);
+  ASSERT_EQ(1, output.segments().size());
+  EXPECT_EQ(scratch, output.segments()[0].data);
+}
+
 
 // To test files, we create a temporary file, write, read, truncate, repeat.
 TEST_F(IoTest, FileIo) {
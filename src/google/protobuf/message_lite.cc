@@ -285,6 +285,18 @@ bool MessageLite::SerializePartialToZeroCopyStream(
   return SerializePartialToCodedStream(&encoder);
 }
 
+bool MessageLite::SerializeToIovecs(io::IovecOutputStream* output) const {
+  GOOGLE_DCHECK(IsInitialized()) << InitializationErrorMessage("serialize", *this);
+  return SerializePartialToIovecs(output);
+}
+
+bool MessageLite::SerializePartialToIovecs(
+    io::IovecOutputStream* output) const {
+  io::CodedOutputStream encoder(output);
+  encoder.EnableAliasing(true);
+  return SerializePartialToCodedStream(&encoder);
+}
+
 bool MessageLite::AppendToString(string* output) const {
   GOOGLE_DCHECK(IsInitialized()) << InitializationErrorMessage("serialize", *this);
   return AppendPartialToString(output);
@@ -48,6 +48,7 @@ namespace protobuf {
 namespace io {
   class CodedInputStream;
   class CodedOutputStream;
+  class IovecOutputStream;
   class ZeroCopyInputStream;
   class ZeroCopyOutputStream;
 }
@@ -218,6 +219,13 @@ class LIBPROTOBUF_EXPORT MessageLite {
   bool SerializeToArray(void* data, int size) const;
   // Like SerializeToArray(), but allows missing required fields.
   bool SerializePartialToArray(void* data, int size) const;
+  // Write the message to the given stream's list of segments for
+  // scatter-gather I/O.  Large string and bytes fields are not copied: their
+  // segments point into the message, so it must not be modified or destroyed
+  // while the segments are in use.  All required fields must be set.
+  bool SerializeToIovecs(io::IovecOutputStream* output) const;
+  // Like SerializeToIovecs(), but allows missing required fields.
+  bool SerializePartialToIovecs(io::IovecOutputStream* output) const;
 
   // Make a string encoding the message. Is equivalent to calling
   // SerializeToString() on a string and using that.  Returns the empty
@@ -51,6 +51,7 @@
 #include <google/protobuf/descriptor.pb.h>
 #include <google/protobuf/unittest.pb.h>
 #include <google/protobuf/test_util.h>
+#include <google/protobuf/wire_format.h>
 
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/testing/googletest.h>
@@ -96,6 +97,49 @@ TEST(MessageTest, SerializeHelpers) {
 
 }
 
+TEST(MessageTest, SerializeToIovecs) {
+  protobuf_unittest::TestAllTypes message;
+  TestUtil::SetAllFields(&message);
+  message.set_optional_bytes(string(1000, 'x'));
+  message.set_repeated_string(1, string(2000, 'y'));
+
+  io::IovecOutputStream output;
+  EXPECT_TRUE(message.SerializeToIovecs(&output));
+  EXPECT_EQ(message.ByteSize(), output.ByteCount());
+
+  string joined;
+  int aliased = 0;
+  for (int i = 0; i < output.segments().size(); i++) {
+    const io::IovecOutputStream::Segment& segment = output.segments()[i];
+    joined.append(reinterpret_cast<const char*>(segment.data), segment.size);
+    if (segment.data == message.optional_bytes().data()) {
+      EXPECT_EQ(1000, segment.size);
+      ++aliased;
+    } else if (segment.data == message.repeated_string(1).data()) {
+      EXPECT_EQ(2000, segment.size);
+      ++aliased;
+    }
+  }
+  // Only the large fields are referenced in place.
+  EXPECT_EQ(2, aliased);
+  EXPECT_EQ(5, output.segments().size());
+  EXPECT_TRUE(joined == message.SerializeAsString());
+
+  // Reflection-based serialization aliases the same fields.
+  io::IovecOutputStream reflection_output;
+  {
+    io::CodedOutputStream coded_output(&reflection_output);
+    coded_output.EnableAliasing(true);
+    internal::WireFormat::SerializeWithCachedSizes(
+        message, message.GetCachedSize(), &coded_output);
+  }
+  EXPECT_EQ(5, reflection_output.segments().size());
+  EXPECT_EQ(message.optional_bytes().data(),
+            reflection_output.segments()[1].data);
+  EXPECT_EQ(message.repeated_string(1).data(),
+            reflection_output.segments()[3].data);
+}
+
 TEST(MessageTest, SerializeToBrokenOstream) {
   ofstream out;
   protobuf_unittest::TestAllTypes message;
@@ -38,6 +38,7 @@
 #include <google/protobuf/reflection_ops.h>
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/repeated_field.h>
 #include <google/protobuf/unknown_field_set.h>
 #include <google/protobuf/stubs/strutil.h>
 
@@ -45,6 +46,49 @@ namespace google {
 namespace protobuf {
 namespace internal {
 
+namespace {
+
+// Appends the contents of a repeated primitive or string field in "from" to
+// the same field in "to", where both messages use the given Reflection and
+// therefore the same in-memory layout.  This merges the underlying
+// RepeatedFields directly (a single memcpy for primitive types) rather than
+// making two virtual reflection calls per element.  Returns false, having
+// done nothing, if the field is of some other type.
+bool MergeRepeatedFieldInBulk(const Reflection* reflection,
+                              const Message& from, Message* to,
+                              const FieldDescriptor* field) {
+  switch (field->cpp_type()) {
+#define HANDLE_TYPE(CPPTYPE, TYPE)                                       \
+    case FieldDescriptor::CPPTYPE_##CPPTYPE:                             \
+      reflection->MutableRepeatedField<TYPE>(to, field)->MergeFrom(      \
+          reflection->GetRepeatedField<TYPE>(from, field));              \
+      return true;
+
+    HANDLE_TYPE(INT32 , int32 );
+    HANDLE_TYPE(INT64 , int64 );
+    HANDLE_TYPE(UINT32, uint32);
+    HANDLE_TYPE(UINT64, uint64);
+    HANDLE_TYPE(FLOAT , float );
+    HANDLE_TYPE(DOUBLE, double);
+    HANDLE_TYPE(BOOL  , bool  );
+#undef HANDLE_TYPE
+
+    case FieldDescriptor::CPPTYPE_STRING:
+      // Other ctypes are not necessarily stored as RepeatedPtrField<string>.
+      if (field->options().ctype() != FieldOptions::STRING) return false;
+      reflection->MutableRepeatedPtrField<string>(to, field)->MergeFrom(
+          reflection->GetRepeatedPtrField<string>(from, field));
+      return true;
+
+    default:
+      // Enums are range-checked element by element, and sub-messages must be
+      // merged recursively.
+      return false;
+  }
+}
+
+}  // namespace
+
 void ReflectionOps::Copy(const Message& from, Message* to) {
   if (&from == to) return;
   Clear(to);
@@ -62,13 +106,21 @@ void ReflectionOps::Merge(const Message& from, Message* to) {
 
   const Reflection* from_reflection = from.GetReflection();
   const Reflection* to_reflection = to->GetReflection();
+  // Messages sharing a Reflection object have the same layout, so repeated
+  // fields can be merged without going through the per-element accessors.
+  bool same_layout = from_reflection == to_reflection;
 
   vector<const FieldDescriptor*> fields;
   from_reflection->ListFields(from, &fields);
+  string scratch;
   for (int i = 0; i < fields.size(); i++) {
     const FieldDescriptor* field = fields[i];
 
     if (field->is_repeated()) {
+      if (same_layout &&
+          MergeRepeatedFieldInBulk(from_reflection, from, to, field)) {
+        continue;
+      }
       int count = from_reflection->FieldSize(from, field);
       for (int j = 0; j < count; j++) {
         switch (field->cpp_type()) {
@@ -110,10 +162,16 @@ void ReflectionOps::Merge(const Message& from, Message* to) {
         HANDLE_TYPE(FLOAT , Float );
         HANDLE_TYPE(DOUBLE, Double);
         HANDLE_TYPE(BOOL  , Bool  );
-        HANDLE_TYPE(STRING, String);
         HANDLE_TYPE(ENUM  , Enum  );
 #undef HANDLE_TYPE
 
+        case FieldDescriptor::CPPTYPE_STRING:
+          // Avoid copying the string twice when GetString() would return
+          // a copy of it.
+          to_reflection->SetString(to, field,
+            from_reflection->GetStringReference(from, field, &scratch));
+          break;
+
         case FieldDescriptor::CPPTYPE_MESSAGE:
           to_reflection->MutableMessage(to, field)->MergeFrom(
             from_reflection->GetMessage(from, field));
@@ -34,6 +34,7 @@
 
 #include <google/protobuf/reflection_ops.h>
 #include <google/protobuf/descriptor.h>
+#include <google/protobuf/dynamic_message.h>
 #include <google/protobuf/unittest.pb.h>
 #include <google/protobuf/test_util.h>
 
@@ -117,6 +118,30 @@ TEST(ReflectionOpsTest, Merge) {
   TestUtil::ExpectAllFieldsSet(message);
 }
 
+TEST(ReflectionOpsTest, MergeDynamic) {
+  // Two DynamicMessages of the same type share a Reflection, so repeated
+  // fields are merged in bulk.  Check that the result matches merging the
+  // equivalent generated messages.
+  DynamicMessageFactory factory;
+  const Message* prototype =
+      factory.GetPrototype(unittest::TestAllTypes::descriptor());
+  scoped_ptr<Message> message(prototype->New());
+  scoped_ptr<Message> message2(prototype->New());
+
+  TestUtil::ReflectionTester reflection_tester(
+      unittest::TestAllTypes::descriptor());
+  reflection_tester.SetAllFieldsViaReflection(message.get());
+  reflection_tester.SetAllFieldsViaReflection(message2.get());
+  ReflectionOps::Merge(*message2, message.get());
+
+  unittest::TestAllTypes expected, expected2;
+  TestUtil::SetAllFields(&expected);
+  TestUtil::SetAllFields(&expected2);
+  expected.MergeFrom(expected2);
+
+  EXPECT_EQ(expected.SerializeAsString(), message->SerializeAsString());
+}
+
 TEST(ReflectionOpsTest, MergeExtensions) {
   // Note:  Copy is implemented in terms of Merge() so technically the Copy
   //   test already tested most of this.
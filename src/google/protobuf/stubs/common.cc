@@ -41,7 +41,9 @@
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN  // We only need minimal includes
 #include <windows.h>
-#define snprintf _snprintf    // see comment in strutil.cc
+// MSVC has only _snprintf, not snprintf.  MinGW has both, but its snprintf
+// prints %g wrongly for some values, so use _snprintf there too.
+#define snprintf _snprintf
 #elif defined(HAVE_PTHREAD)
 #include <pthread.h>
 #else
@@ -3,6 +3,24 @@
 
 #include <google/protobuf/stubs/common.h>
 
+#include <string.h>
+
+// On x86 we also have a validator that checks 16 bytes at a time with
+// SSSE3 byte shuffles.  It is compiled in whenever the compiler can target
+// SSSE3 from a single function and picked at startup if the CPU has it.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+    ((__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 8)) || \
+     defined(__clang__))
+#define GOOGLE_PROTOBUF_UTF8_SSSE3 1
+#define GOOGLE_PROTOBUF_SSSE3_FUNCTION __attribute__((target("ssse3")))
+#include <tmmintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define GOOGLE_PROTOBUF_UTF8_SSSE3 1
+#define GOOGLE_PROTOBUF_SSSE3_FUNCTION
+#include <intrin.h>
+#include <tmmintrin.h>
+#endif
+
 namespace google {
 namespace protobuf {
 namespace internal {
@@ -503,6 +521,175 @@ int UTF8GenericScanFastAscii(const UTF8ScanObj* st,
   return exit_reason;
 }
 
+#ifdef GOOGLE_PROTOBUF_UTF8_SSSE3
+
+// The vectorized validator follows "Validating UTF-8 In Less Than One
+// Instruction Per Byte" by John Keiser and Daniel Lemire.  Every error in a
+// UTF-8 string shows up in the high nibble of some byte together with the
+// whole of the byte before it, so three 16-entry table lookups (pshufb),
+// ANDed together, flag each class of error at once:
+//   byte 1 high nibble, byte 1 low nibble, byte 2 high nibble.
+// The only errors this misses are missing or extra continuation bytes
+// two or three positions after a lead byte, which are checked separately.
+// It accepts exactly what utf8acceptnonsurrogates_obj accepts.
+namespace {
+
+// Error classes.  Each is a bit that all three lookups must agree on.
+const int kTooShort = 1 << 0;      // Lead byte without a continuation.
+const int kTooLong = 1 << 1;       // ASCII followed by a continuation.
+const int kOverlong3 = 1 << 2;     // 11100000 100_____
+const int kTooLarge = 1 << 3;      // Above U+10FFFF.
+const int kSurrogate = 1 << 4;     // 11101101 101_____
+const int kOverlong2 = 1 << 5;     // 1100000_ 10______
+const int kTooLarge1000 = 1 << 6;  // Above U+10FFFF, 1000____ case.
+const int kOverlong4 = 1 << 6;     // 11110000 1000____
+const int kTwoConts = 1 << 7;      // Continuation after a continuation.
+const int kCarry = kTooShort | kTooLong | kTwoConts;
+
+GOOGLE_PROTOBUF_SSSE3_FUNCTION
+inline __m128i ShiftRight4(__m128i v) {
+  return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0f));
+}
+
+// Folds one 16-byte block into *error.  *previous holds the previous block
+// and *previous_incomplete flags lead bytes at its end that still need
+// continuation bytes.
+GOOGLE_PROTOBUF_SSSE3_FUNCTION
+inline void CheckUTF8Block(__m128i input, __m128i* previous,
+                           __m128i* previous_incomplete, __m128i* error) {
+  if (_mm_movemask_epi8(input) == 0) {
+    // All ASCII: only a sequence left open by the previous block can fail.
+    *error = _mm_or_si128(*error, *previous_incomplete);
+    *previous = input;
+    *previous_incomplete = _mm_setzero_si128();
+    return;
+  }
+
+  const __m128i prev1 = _mm_alignr_epi8(input, *previous, 15);
+  const __m128i byte_1_high = _mm_shuffle_epi8(_mm_setr_epi8(
+      // 0_______ ________  ASCII in byte 1
+      kTooLong, kTooLong, kTooLong, kTooLong,
+      kTooLong, kTooLong, kTooLong, kTooLong,
+      // 10______ ________  continuation in byte 1
+      kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+      // 1100____ ________  two-byte lead
+      kTooShort | kOverlong2,
+      // 1101____ ________  two-byte lead
+      kTooShort,
+      // 1110____ ________  three-byte lead
+      kTooShort | kOverlong3 | kSurrogate,
+      // 1111____ ________  four-byte lead
+      kTooShort | kTooLarge | kTooLarge1000 | kOverlong4),
+      ShiftRight4(prev1));
+  const __m128i byte_1_low = _mm_shuffle_epi8(_mm_setr_epi8(
+      // ____0000 ________
+      kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+      // ____0001 ________
+      kCarry | kOverlong2,
+      // ____001_ ________
+      kCarry,
+      kCarry,
+      // ____0100 ________
+      kCarry | kTooLarge,
+      // ____0101 ________
+      kCarry | kTooLarge | kTooLarge1000,
+      // ____011_ ________
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      // ____1___ ________
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      // ____1101 ________
+      kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000),
+      _mm_and_si128(prev1, _mm_set1_epi8(0x0f)));
+  const __m128i byte_2_high = _mm_shuffle_epi8(_mm_setr_epi8(
+      // ________ 0_______  ASCII in byte 2
+      kTooShort, kTooShort, kTooShort, kTooShort,
+      kTooShort, kTooShort, kTooShort, kTooShort,
+      // ________ 1000____
+      kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 |
+          kOverlong4,
+      // ________ 1001____
+      kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge,
+      // ________ 101_____
+      kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+      kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+      // ________ 11______  lead byte in byte 2
+      kTooShort, kTooShort, kTooShort, kTooShort),
+      ShiftRight4(input));
+  const __m128i special_cases =
+      _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+  // Bytes two or three after a three- or four-byte lead must be
+  // continuations, and those are exactly the places where a continuation
+  // is not flagged as kTwoConts above.
+  const __m128i prev2 = _mm_alignr_epi8(input, *previous, 14);
+  const __m128i prev3 = _mm_alignr_epi8(input, *previous, 13);
+  const __m128i is_third_byte =
+      _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xe0 - 0x80)));
+  const __m128i is_fourth_byte =
+      _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xf0 - 0x80)));
+  const __m128i must_be_continuation = _mm_and_si128(
+      _mm_or_si128(is_third_byte, is_fourth_byte),
+      _mm_set1_epi8(static_cast<char>(0x80)));
+  *error = _mm_or_si128(*error,
+                        _mm_xor_si128(must_be_continuation, special_cases));
+
+  // A lead byte in the last three positions may need bytes from the next
+  // block.
+  *previous_incomplete = _mm_subs_epu8(input, _mm_setr_epi8(
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      static_cast<char>(0xf0 - 1), static_cast<char>(0xe0 - 1),
+      static_cast<char>(0xc0 - 1)));
+  *previous = input;
+}
+
+GOOGLE_PROTOBUF_SSSE3_FUNCTION
+bool IsStructurallyValidUTF8SSSE3(const char* buf, int len) {
+  __m128i previous = _mm_setzero_si128();
+  __m128i previous_incomplete = _mm_setzero_si128();
+  __m128i error = _mm_setzero_si128();
+
+  int i = 0;
+  for (; i + 16 <= len; i += 16) {
+    CheckUTF8Block(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + i)),
+        &previous, &previous_incomplete, &error);
+  }
+  if (i < len) {
+    // Pad the tail with NULs, which are valid ASCII.
+    char tail[16];
+    memset(tail, 0, sizeof(tail));
+    memcpy(tail, buf + i, len - i);
+    CheckUTF8Block(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tail)),
+                   &previous, &previous_incomplete, &error);
+  }
+  error = _mm_or_si128(error, previous_incomplete);
+
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) ==
+         0xffff;
+}
+
+bool CpuHasSSSE3() {
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  return (info[2] & (1 << 9)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+}  // namespace
+
+#endif  // GOOGLE_PROTOBUF_UTF8_SSSE3
+
 // Hack:  On some compilers the static tables are initialized at startup.
 //   We can't use them until they are initialized.  However, some Protocol
 //   Buffer parsing happens at static init time and may try to validate
@@ -512,9 +699,15 @@ int UTF8GenericScanFastAscii(const UTF8ScanObj* st,
 namespace {
 
 bool module_initialized_ = false;
+#ifdef GOOGLE_PROTOBUF_UTF8_SSSE3
+bool use_ssse3_ = false;
+#endif
 
 struct InitDetector {
   InitDetector() {
+#ifdef GOOGLE_PROTOBUF_UTF8_SSSE3
+    use_ssse3_ = CpuHasSSSE3();
+#endif
     module_initialized_ = true;
   }
 };
@@ -524,7 +717,14 @@ InitDetector init_detector;
 
 bool IsStructurallyValidUTF8(const char* buf, int len) {
   if (!module_initialized_) return true;
-  
+
+#ifdef GOOGLE_PROTOBUF_UTF8_SSSE3
+  // Short strings are faster to check a byte at a time.
+  if (use_ssse3_ && len >= 16) {
+    return IsStructurallyValidUTF8SSSE3(buf, len);
+  }
+#endif
+
   int bytes_consumed = 0;
   UTF8GenericScanFastAscii(&utf8acceptnonsurrogates_obj,
                            buf, len, &bytes_consumed);
@@ -2,8 +2,11 @@
 // Author: xpeng@google.com (Peter Peng)
 
 #include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/strutil.h>
 #include <gtest/gtest.h>
 
+#include <string>
+
 namespace google {
 namespace protobuf {
 namespace internal {
@@ -34,6 +37,75 @@ TEST(StructurallyValidTest, InvalidUTF8String) {
   }
 }
 
+// A direct transcription of the well-formed byte sequences table in
+// section 3.9 of the Unicode standard, for comparison.
+bool ReferenceIsValidUTF8(const string& str) {
+  const uint8* p = reinterpret_cast<const uint8*>(str.data());
+  const uint8* end = p + str.size();
+  while (p < end) {
+    uint8 lead = *p++;
+    int continuations;
+    uint8 low = 0x80;
+    uint8 high = 0xbf;
+    if (lead < 0x80) {
+      continue;
+    } else if (lead >= 0xc2 && lead <= 0xdf) {
+      continuations = 1;
+    } else if (lead >= 0xe0 && lead <= 0xef) {
+      continuations = 2;
+      if (lead == 0xe0) low = 0xa0;
+      if (lead == 0xed) high = 0x9f;
+    } else if (lead >= 0xf0 && lead <= 0xf4) {
+      continuations = 3;
+      if (lead == 0xf0) low = 0x90;
+      if (lead == 0xf4) high = 0x8f;
+    } else {
+      return false;
+    }
+    for (int i = 0; i < continuations; i++) {
+      if (p == end || *p < low || *p > high) return false;
+      ++p;
+      low = 0x80;
+      high = 0xbf;
+    }
+  }
+  return true;
+}
+
+TEST(StructurallyValidTest, MatchesReference) {
+  // Random strings built mostly from bytes near the interesting
+  // boundaries, at lengths on both sides of the 16-byte block size and
+  // with multi-byte characters straddling block boundaries.
+  static const uint8 kBytes[] = {
+    0x00, 0x41, 0x7f, 0x80, 0x8f, 0x90, 0x9f, 0xa0, 0xbf, 0xc0, 0xc1, 0xc2,
+    0xdf, 0xe0, 0xe1, 0xec, 0xed, 0xee, 0xef, 0xf0, 0xf1, 0xf3, 0xf4, 0xf5,
+    0xff,
+  };
+  static const char* const kValidPieces[] = {
+    "a", "\xc2\x80", "\xdf\xbf", "\xe0\xa0\x80", "\xed\x9f\xbf",
+    "\xef\xbf\xbf", "\xf0\x90\x80\x80", "\xf4\x8f\xbf\xbf",
+  };
+
+  uint32 state = 1;
+  for (int i = 0; i < 200000; i++) {
+    string str;
+    state = state * 1103515245 + 12345;
+    int length = (state >> 16) % 70;
+    while (str.size() < length) {
+      state = state * 1103515245 + 12345;
+      int choice = (state >> 16) % 100;
+      if (choice < 70) {
+        str += kValidPieces[(state >> 8) % GOOGLE_ARRAYSIZE(kValidPieces)];
+      } else {
+        str += static_cast<char>(kBytes[(state >> 8) % sizeof(kBytes)]);
+      }
+    }
+    EXPECT_EQ(ReferenceIsValidUTF8(str),
+              IsStructurallyValidUTF8(str.data(), str.size()))
+        << CEscape(str);
+  }
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace protobuf
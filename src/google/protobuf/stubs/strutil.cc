@@ -31,6 +31,7 @@
 // from google3/strings/strutil.cc
 
 #include <google/protobuf/stubs/strutil.h>
+#include <google/protobuf/stubs/once.h>
 #include <errno.h>
 #include <float.h>    // FLT_DIG and DBL_DIG
 #include <limits>
@@ -38,18 +39,10 @@
 #include <stdio.h>
 #include <iterator>
 
-#ifdef _WIN32
-// MSVC has only _snprintf, not snprintf.
-//
-// MinGW has both snprintf and _snprintf, but they appear to be different
-// functions.  The former is buggy.  When invoked like so:
-//   char buffer[32];
-//   snprintf(buffer, 32, "%.*g\n", FLT_DIG, 1.23e10f);
-// it prints "1.23000e+10".  This is plainly wrong:  %g should never print
-// trailing zeros after the decimal point.  For some reason this bug only
-// occurs with some input values, not all.  In any case, _snprintf does the
-// right thing, so we use it.
-#define snprintf _snprintf
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GOOGLE_PROTOBUF_STRUTIL_SSE2 1
+#include <emmintrin.h>
 #endif
 
 namespace google {
@@ -335,13 +328,14 @@ int UnescapeCEscapeSequences(const char* source, char* dest,
   char* d = dest;
   const char* p = source;
 
-  // Small optimization for case where source = dest and there's no escaping
-  while ( p == d && *p != '\0' && *p != '\\' )
-    p++, d++;
-
   while (*p != '\0') {
     if (*p != '\\') {
-      *d++ = *p++;
+      // Move the whole run up to the next backslash at once.  strcspn() with
+      // a single reject character is a vectorized strchrnul() in most libcs.
+      const int run = strcspn(p, "\\");
+      if (p != d) memmove(d, p, run);
+      p += run;
+      d += run;
     } else {
       switch ( *++p ) {                    // skip past the '\\'
         case '\0':
@@ -491,49 +485,123 @@ string UnescapeCEscapeString(const string& src) {
 //
 //    Currently only \n, \r, \t, ", ', \ and !isprint() chars are escaped.
 // ----------------------------------------------------------------------
+// Number of bytes CEscapeInternal() writes for each input byte: 1 for bytes
+// copied verbatim, 2 for \n-style escapes, 4 for octal/hex escapes.
+static const char c_escaped_len[256] = {
+  4, 4, 4, 4, 4, 4, 4, 4, 4, 2, 2, 4, 4, 2, 4, 4,  // \t, \n, \r
+  4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+  1, 1, 2, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1,  // ", '
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 1, 1, 1,  // '\\'
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 4,  // DEL
+  4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+  4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+  4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+  4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+  4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+  4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+  4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+  4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+};
+
+// Returns the end of the run of bytes starting at "src" which CEscape copies
+// unchanged.  Text is overwhelmingly made of such bytes, so we look at
+// sixteen of them at a time where SSE2 is available.
+static const char* SkipUnescapedRun(const char* src, const char* src_end,
+                                    bool utf8_safe) {
+#ifdef GOOGLE_PROTOBUF_STRUTIL_SSE2
+  const __m128i space_minus_one = _mm_set1_epi8(0x1F);
+  const __m128i del = _mm_set1_epi8(0x7F);
+  const __m128i double_quote = _mm_set1_epi8('\"');
+  const __m128i single_quote = _mm_set1_epi8('\'');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  while (src_end - src >= 16) {
+    const __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    // The comparisons are signed, so bytes >= 0x80 are not printable here.
+    __m128i plain = _mm_and_si128(_mm_cmpgt_epi8(bytes, space_minus_one),
+                                  _mm_cmplt_epi8(bytes, del));
+    if (utf8_safe) {
+      plain = _mm_or_si128(plain,
+                           _mm_cmplt_epi8(bytes, _mm_setzero_si128()));
+    }
+    const __m128i quoted =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, double_quote),
+                                  _mm_cmpeq_epi8(bytes, single_quote)),
+                     _mm_cmpeq_epi8(bytes, backslash));
+    if (_mm_movemask_epi8(_mm_andnot_si128(quoted, plain)) != 0xFFFF) {
+      break;  // The scalar loop below finds the exact position.
+    }
+    src += 16;
+  }
+#endif
+  for (; src < src_end; src++) {
+    const uint8 c = static_cast<uint8>(*src);
+    if (c_escaped_len[c] != 1 && !(utf8_safe && c >= 0x80)) break;
+  }
+  return src;
+}
+
+// Writes the four byte octal (\ooo) or hex (\xhh) escape for "c".
+static inline char* AppendNumericEscape(uint8 c, bool use_hex, char* dest) {
+  static const char kHexDigits[] = "0123456789abcdef";
+  *dest++ = '\\';
+  if (use_hex) {
+    *dest++ = 'x';
+    *dest++ = kHexDigits[c >> 4];
+    *dest++ = kHexDigits[c & 0xF];
+  } else {
+    *dest++ = '0' + (c >> 6);
+    *dest++ = '0' + ((c >> 3) & 7);
+    *dest++ = '0' + (c & 7);
+  }
+  return dest;
+}
+
 int CEscapeInternal(const char* src, int src_len, char* dest,
                     int dest_len, bool use_hex, bool utf8_safe) {
   const char* src_end = src + src_len;
-  int used = 0;
-  bool last_hex_escape = false; // true if last output char was \xNN
-
-  for (; src < src_end; src++) {
-    if (dest_len - used < 2)   // Need space for two letter escape
-      return -1;
-
-    bool is_hex_escape = false;
-    switch (*src) {
-      case '\n': dest[used++] = '\\'; dest[used++] = 'n';  break;
-      case '\r': dest[used++] = '\\'; dest[used++] = 'r';  break;
-      case '\t': dest[used++] = '\\'; dest[used++] = 't';  break;
-      case '\"': dest[used++] = '\\'; dest[used++] = '\"'; break;
-      case '\'': dest[used++] = '\\'; dest[used++] = '\''; break;
-      case '\\': dest[used++] = '\\'; dest[used++] = '\\'; break;
+  char* out = dest;
+  char* out_end = dest + dest_len;
+
+  while (true) {
+    // Copy everything up to the next byte that needs escaping in one go.
+    const char* run_end = SkipUnescapedRun(src, src_end, utf8_safe);
+    if (out_end - out < run_end - src) return -1;
+    memcpy(out, src, run_end - src);
+    out += run_end - src;
+    src = run_end;
+    if (src == src_end) break;
+
+    const uint8 c = static_cast<uint8>(*src++);
+    if (out_end - out < c_escaped_len[c]) return -1;
+    switch (c) {
+      case '\n': *out++ = '\\'; *out++ = 'n';  break;
+      case '\r': *out++ = '\\'; *out++ = 'r';  break;
+      case '\t': *out++ = '\\'; *out++ = 't';  break;
+      case '\"': *out++ = '\\'; *out++ = '\"'; break;
+      case '\'': *out++ = '\\'; *out++ = '\''; break;
+      case '\\': *out++ = '\\'; *out++ = '\\'; break;
       default:
+        out = AppendNumericEscape(c, use_hex, out);
         // Note that if we emit \xNN and the src character after that is a hex
         // digit then that digit must be escaped too to prevent it being
         // interpreted as part of the character code by C.
-        if ((!utf8_safe || static_cast<uint8>(*src) < 0x80) &&
-            (!isprint(*src) ||
-             (last_hex_escape && isxdigit(*src)))) {
-          if (dest_len - used < 4) // need space for 4 letter escape
-            return -1;
-          sprintf(dest + used, (use_hex ? "\\x%02x" : "\\%03o"),
-                  static_cast<uint8>(*src));
-          is_hex_escape = use_hex;
-          used += 4;
-        } else {
-          dest[used++] = *src; break;
+        while (use_hex && src < src_end && isxdigit(*src)) {
+          if (out_end - out < 4) return -1;
+          out = AppendNumericEscape(static_cast<uint8>(*src++), true, out);
         }
+        break;
     }
-    last_hex_escape = is_hex_escape;
   }
 
-  if (dest_len - used < 1)   // make sure that there is room for \0
+  if (out_end - out < 1)   // make sure that there is room for \0
     return -1;
 
-  dest[used] = '\0';   // doesn't count towards return value though
-  return used;
+  *out = '\0';   // doesn't count towards return value though
+  return out - dest;
 }
 
 int CEscapeString(const char* src, int src_len, char* dest, int dest_len) {
@@ -1123,81 +1191,369 @@ string SimpleItoa(unsigned long long i) {
 //    It turns out there is no precision value that does the right thing
 //    for all numbers.
 //
-//    Our strategy is to first try printing with a precision that is never
-//    over-precise, then parse the result with strtod() to see if it
-//    matches.  If not, we print again with a precision that will always
-//    give a precise result, but may use more digits than necessary.
-//
-//    An arguably better strategy would be to use the algorithm described
-//    in "How to Print Floating-Point Numbers Accurately" by Steele &
-//    White, e.g. as implemented by David M. Gay's dtoa().  It turns out,
-//    however, that the following implementation is about as fast as
-//    DMG's code.  Furthermore, DMG's code locks mutexes, which means it
-//    will not scale well on multi-core machines.  DMG's code is slightly
-//    more accurate (in that it will never use more digits than
-//    necessary), but this is probably irrelevant for most users.
+//    We used to print with a precision that is never over-precise, parse
+//    the result with strtod() to see if it matched, and print again with
+//    a precision that is always precise if not.  That costs one or two
+//    snprintf() calls plus a strtod() per value, all of which consult the
+//    C locale, and still produces more digits than necessary for about
+//    half of all doubles.
 //
-//    Rob Pike and Ken Thompson also have an implementation of dtoa() in
-//    third_party/fmt/fltfmt.cc.  Their implementation is similar to this
-//    one in that it makes guesses and then uses strtod() to check them.
-//    Their implementation is faster because they use their own code to
-//    generate the digits in the first place rather than use snprintf(),
-//    thus avoiding format string parsing overhead.  However, this makes
-//    it considerably more complicated than the following implementation,
-//    and it is embedded in a larger library.  If speed turns out to be
-//    an issue, we could re-implement this in terms of their
-//    implementation.
+//    Instead we now generate the digits ourselves using the algorithm
+//    from "Ryu: Fast Float-to-String Conversion" by Ulf Adams (PLDI 2018).
+//    Given the interval of real numbers that round to the binary value,
+//    it finds the shortest decimal in that interval (the closest one if
+//    there are several) using only 64-bit integer arithmetic against a
+//    table of powers of five.  The output is laid out exactly the way
+//    "%.15g" (or "%.17g" when more than 15 digits are needed) lays it
+//    out, so any value that used to print with 15 significant digits or
+//    fewer prints identically; the rest print in fewer digits than
+//    before.  The same code handles floats with FLT_DIG in place of
+//    DBL_DIG.
 // ----------------------------------------------------------------------
 
-string SimpleDtoa(double value) {
-  char buffer[kDoubleToBufferSize];
-  return DoubleToBuffer(value, buffer);
+namespace {
+
+// The power-of-five tables keep this many significant bits of each entry.
+const int kPow5BitCount = 125;
+const int kPow5InvBitCount = 125;
+
+// 5^325 is the largest power needed for the smallest subnormal double and
+// 5^-291 the smallest inverse needed for the largest double.
+const int kPow5TableSize = 326;
+const int kPow5InvTableSize = 292;
+
+// pow5_split[i] holds 5^i scaled to exactly kPow5BitCount bits and
+// pow5_inv_split[i] holds 2^(Pow5Bits(i) - 1 + kPow5InvBitCount) / 5^i,
+// rounded up.  Both are stored as { low 64 bits, high 64 bits }.
+uint64 pow5_split[kPow5TableSize][2];
+uint64 pow5_inv_split[kPow5InvTableSize][2];
+
+GOOGLE_PROTOBUF_DECLARE_ONCE(pow5_tables_once);
+
+// Returns the number of bits in 5^e, i.e. ceil(log2(5^e)) for e > 0.
+inline int Pow5Bits(int e) {
+  return static_cast<int>((static_cast<uint32>(e) * 1217359) >> 19) + 1;
 }
 
-string SimpleFtoa(float value) {
-  char buffer[kFloatToBufferSize];
-  return FloatToBuffer(value, buffer);
+// Returns floor(log10(2^e)).
+inline int Log10Pow2(int e) {
+  return static_cast<int>((static_cast<uint32>(e) * 78913) >> 18);
 }
 
-static inline bool IsValidFloatChar(char c) {
-  return ('0' <= c && c <= '9') ||
-         c == 'e' || c == 'E' ||
-         c == '+' || c == '-';
+// Returns floor(log10(5^e)).
+inline int Log10Pow5(int e) {
+  return static_cast<int>((static_cast<uint32>(e) * 732923) >> 20);
 }
 
-void DelocalizeRadix(char* buffer) {
-  // Fast check:  if the buffer has a normal decimal point, assume no
-  // translation is needed.
-  if (strchr(buffer, '.') != NULL) return;
+// The tables are built with a little-endian base-2^32 big integer at
+// startup rather than spelled out in the source.
+void MultiplyBigInt(vector<uint32>* n, uint32 factor) {
+  uint64 carry = 0;
+  for (int i = 0; i < n->size(); i++) {
+    uint64 product = static_cast<uint64>((*n)[i]) * factor + carry;
+    (*n)[i] = static_cast<uint32>(product);
+    carry = product >> 32;
+  }
+  if (carry != 0) n->push_back(static_cast<uint32>(carry));
+}
 
-  // Find the first unknown character.
-  while (IsValidFloatChar(*buffer)) ++buffer;
+void DivideBigInt(vector<uint32>* n, uint32 divisor) {
+  uint64 remainder = 0;
+  for (int i = n->size() - 1; i >= 0; i--) {
+    uint64 dividend = (remainder << 32) | (*n)[i];
+    (*n)[i] = static_cast<uint32>(dividend / divisor);
+    remainder = dividend % divisor;
+  }
+  while (n->size() > 1 && n->back() == 0) n->pop_back();
+}
 
-  if (*buffer == '\0') {
-    // No radix character found.
-    return;
+// Stores bits [shift, shift + 128) of n into result.
+void ExtractBigIntBits(const vector<uint32>& n, int shift, uint64 result[2]) {
+  result[0] = result[1] = 0;
+  for (int bit = 0; bit < 128; bit++) {
+    int source = bit + shift;
+    if (source < 0 || source >= n.size() * 32) continue;
+    if ((n[source / 32] >> (source % 32)) & 1) {
+      result[bit / 64] |= GOOGLE_ULONGLONG(1) << (bit % 64);
+    }
+  }
+}
+
+void InitPow5Tables() {
+  vector<uint32> pow5(1, 1);
+  for (int i = 0; i < kPow5TableSize; i++) {
+    ExtractBigIntBits(pow5, Pow5Bits(i) - kPow5BitCount, pow5_split[i]);
+    MultiplyBigInt(&pow5, 5);
   }
 
-  // We are now pointing at the locale-specific radix character.  Replace it
-  // with '.'.
-  *buffer = '.';
-  ++buffer;
-
-  if (!IsValidFloatChar(*buffer) && *buffer != '\0') {
-    // It appears the radix was a multi-byte character.  We need to remove the
-    // extra bytes.
-    char* target = buffer;
-    do { ++buffer; } while (!IsValidFloatChar(*buffer) && *buffer != '\0');
-    memmove(target, buffer, strlen(buffer) + 1);
+  for (int i = 0; i < kPow5InvTableSize; i++) {
+    int bits = Pow5Bits(i) - 1 + kPow5InvBitCount;
+    vector<uint32> n(bits / 32 + 1, 0);
+    n.back() = static_cast<uint32>(1) << (bits % 32);
+    for (int j = 0; j < i; j++) {
+      DivideBigInt(&n, 5);
+    }
+    ExtractBigIntBits(n, 0, pow5_inv_split[i]);
+    if (++pow5_inv_split[i][0] == 0) ++pow5_inv_split[i][1];
   }
 }
 
+// Returns the low 64 bits of a * b and stores the high 64 bits in *high.
+inline uint64 Multiply128(uint64 a, uint64 b, uint64* high) {
+  uint64 a_lo = a & 0xffffffffu;
+  uint64 a_hi = a >> 32;
+  uint64 b_lo = b & 0xffffffffu;
+  uint64 b_hi = b >> 32;
+
+  uint64 lo_lo = a_lo * b_lo;
+  uint64 lo_hi = a_lo * b_hi;
+  uint64 hi_lo = a_hi * b_lo;
+  uint64 hi_hi = a_hi * b_hi;
+
+  uint64 middle = (lo_lo >> 32) + (lo_hi & 0xffffffffu) +
+                  (hi_lo & 0xffffffffu);
+  *high = hi_hi + (lo_hi >> 32) + (hi_lo >> 32) + (middle >> 32);
+  return (middle << 32) | (lo_lo & 0xffffffffu);
+}
+
+// Returns floor(m * multiplier / 2^shift) where multiplier is a 128-bit
+// table entry.  shift is always in [64, 128).
+inline uint64 MultiplyShift(uint64 m, const uint64 multiplier[2], int shift) {
+  uint64 high0;
+  Multiply128(m, multiplier[0], &high0);
+  uint64 high1;
+  uint64 low1 = Multiply128(m, multiplier[1], &high1);
+  uint64 sum = high0 + low1;
+  if (sum < high0) ++high1;
+
+  shift -= 64;
+  GOOGLE_DCHECK(shift >= 0 && shift < 64);
+  if (shift == 0) return sum;
+  return (high1 << (64 - shift)) | (sum >> shift);
+}
+
+inline int Pow5Factor(uint64 value) {
+  int count = 0;
+  while (value % 5 == 0) {
+    value /= 5;
+    ++count;
+  }
+  return count;
+}
+
+inline bool IsMultipleOfPow5(uint64 value, int p) {
+  return Pow5Factor(value) >= p;
+}
+
+inline bool IsMultipleOfPow2(uint64 value, int p) {
+  return (value & ((GOOGLE_ULONGLONG(1) << p) - 1)) == 0;
+}
+
+// Computes the shortest decimal digits * 10^exponent that reads back as
+// the (non-zero, finite) IEEE-754 value with the given raw mantissa and
+// biased exponent fields.  Used for both doubles and floats.
+void ShortestDecimal(uint64 ieee_mantissa, int ieee_exponent,
+                     int mantissa_bits, int exponent_bias,
+                     uint64* digits, int* exponent) {
+  int e2;
+  uint64 m2;
+  if (ieee_exponent == 0) {
+    // Subnormal.
+    e2 = 1 - exponent_bias - mantissa_bits - 2;
+    m2 = ieee_mantissa;
+  } else {
+    e2 = ieee_exponent - exponent_bias - mantissa_bits - 2;
+    m2 = (GOOGLE_ULONGLONG(1) << mantissa_bits) | ieee_mantissa;
+  }
+  // Round-half-even means the interval boundaries are themselves part of
+  // the interval when the mantissa is even.
+  const bool accept_bounds = (m2 & 1) == 0;
+
+  // The value and the halfway points to its neighbors are mv, mp and mm,
+  // all times 2^e2.  The lower neighbor is closer when we are on a power
+  // of two, since the exponent just dropped.
+  const uint64 mv = 4 * m2;
+  const uint64 mm_shift = (ieee_mantissa != 0 || ieee_exponent <= 1) ? 1 : 0;
+  const uint64 mp = mv + 2;
+  const uint64 mm = mv - 1 - mm_shift;
+
+  // Scale all three by a power of ten so that enough digits are left in
+  // front of the decimal point.
+  uint64 vr, vp, vm;
+  int e10;
+  bool vm_is_trailing_zeros = false;
+  bool vr_is_trailing_zeros = false;
+  if (e2 >= 0) {
+    const int q = Log10Pow2(e2) - (e2 > 3 ? 1 : 0);
+    e10 = q;
+    const int k = kPow5InvBitCount + Pow5Bits(q) - 1;
+    const int i = -e2 + q + k;
+    vr = MultiplyShift(mv, pow5_inv_split[q], i);
+    vp = MultiplyShift(mp, pow5_inv_split[q], i);
+    vm = MultiplyShift(mm, pow5_inv_split[q], i);
+    if (q <= 21) {
+      // Only one of mp, mv and mm can be a multiple of 5, if any.
+      if (mv % 5 == 0) {
+        vr_is_trailing_zeros = IsMultipleOfPow5(mv, q);
+      } else if (accept_bounds) {
+        vm_is_trailing_zeros = IsMultipleOfPow5(mm, q);
+      } else {
+        vp -= IsMultipleOfPow5(mp, q) ? 1 : 0;
+      }
+    }
+  } else {
+    const int q = Log10Pow5(-e2) - (-e2 > 1 ? 1 : 0);
+    e10 = q + e2;
+    const int i = -e2 - q;
+    const int k = Pow5Bits(i) - kPow5BitCount;
+    const int j = q - k;
+    vr = MultiplyShift(mv, pow5_split[i], j);
+    vp = MultiplyShift(mp, pow5_split[i], j);
+    vm = MultiplyShift(mm, pow5_split[i], j);
+    if (q <= 1) {
+      // mv has at least two trailing zero bits, so vr is exact.
+      vr_is_trailing_zeros = true;
+      if (accept_bounds) {
+        vm_is_trailing_zeros = mm_shift == 1;
+      } else {
+        --vp;
+      }
+    } else if (q < 63) {
+      vr_is_trailing_zeros = IsMultipleOfPow2(mv, q);
+    }
+  }
+
+  // Drop digits while the interval still contains a shorter number.
+  int removed = 0;
+  int last_removed_digit = 0;
+  uint64 output;
+  if (vm_is_trailing_zeros || vr_is_trailing_zeros) {
+    // Rare case: we have to track exact ties.
+    while (vp / 10 > vm / 10) {
+      vm_is_trailing_zeros &= vm % 10 == 0;
+      vr_is_trailing_zeros &= last_removed_digit == 0;
+      last_removed_digit = static_cast<int>(vr % 10);
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+    if (vm_is_trailing_zeros) {
+      while (vm % 10 == 0) {
+        vr_is_trailing_zeros &= last_removed_digit == 0;
+        last_removed_digit = static_cast<int>(vr % 10);
+        vr /= 10;
+        vp /= 10;
+        vm /= 10;
+        ++removed;
+      }
+    }
+    if (vr_is_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0) {
+      // Exactly halfway; round to even.
+      last_removed_digit = 4;
+    }
+    output = vr;
+    if ((vr == vm && (!accept_bounds || !vm_is_trailing_zeros)) ||
+        last_removed_digit >= 5) {
+      ++output;
+    }
+  } else {
+    bool round_up = false;
+    while (vp / 10 > vm / 10) {
+      round_up = vr % 10 >= 5;
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+    output = vr;
+    if (vr == vm || round_up) ++output;
+  }
+
+  *digits = output;
+  *exponent = e10 + removed;
+}
+
+// Writes (negative ? -1 : 1) * digits * 10^exponent to buffer the way
+// printf("%.<precision>g") would, and returns buffer.  precision is
+// type_digits if the number fits in that many digits, type_digits + 2
+// otherwise, matching what the old snprintf()-based code chose.
+char* FormatDecimal(bool negative, uint64 digits, int exponent,
+                    int type_digits, char* buffer) {
+  char digit_buffer[kFastToBufferSize];
+  char* end = FastUInt64ToBufferLeft(digits, digit_buffer);
+  while (end - digit_buffer > 1 && end[-1] == '0') {
+    --end;
+    ++exponent;
+  }
+  const int num_digits = end - digit_buffer;
+  const int precision =
+      num_digits <= type_digits ? type_digits : type_digits + 2;
+  // Exponent of the leading digit.
+  const int scientific_exponent = exponent + num_digits - 1;
+
+  char* out = buffer;
+  if (negative) *out++ = '-';
+
+  if (scientific_exponent < -4 || scientific_exponent >= precision) {
+    *out++ = digit_buffer[0];
+    if (num_digits > 1) {
+      *out++ = '.';
+      memcpy(out, digit_buffer + 1, num_digits - 1);
+      out += num_digits - 1;
+    }
+    *out++ = 'e';
+    int e = scientific_exponent;
+    if (e < 0) {
+      *out++ = '-';
+      e = -e;
+    } else {
+      *out++ = '+';
+    }
+    if (e < 10) *out++ = '0';
+    out = FastUInt32ToBufferLeft(e, out);
+  } else if (scientific_exponent < 0) {
+    *out++ = '0';
+    *out++ = '.';
+    for (int i = -1; i > scientific_exponent; i--) *out++ = '0';
+    memcpy(out, digit_buffer, num_digits);
+    out += num_digits;
+    *out = '\0';
+  } else if (num_digits <= scientific_exponent + 1) {
+    memcpy(out, digit_buffer, num_digits);
+    out += num_digits;
+    for (int i = num_digits; i <= scientific_exponent; i++) *out++ = '0';
+    *out = '\0';
+  } else {
+    const int integer_digits = scientific_exponent + 1;
+    memcpy(out, digit_buffer, integer_digits);
+    out += integer_digits;
+    *out++ = '.';
+    memcpy(out, digit_buffer + integer_digits, num_digits - integer_digits);
+    out += num_digits - integer_digits;
+    *out = '\0';
+  }
+
+  return buffer;
+}
+
+}  // namespace
+
+string SimpleDtoa(double value) {
+  char buffer[kDoubleToBufferSize];
+  return DoubleToBuffer(value, buffer);
+}
+
+string SimpleFtoa(float value) {
+  char buffer[kFloatToBufferSize];
+  return FloatToBuffer(value, buffer);
+}
+
 char* DoubleToBuffer(double value, char* buffer) {
   // DBL_DIG is 15 for IEEE-754 doubles, which are used on almost all
-  // platforms these days.  Just in case some system exists where DBL_DIG
-  // is significantly larger -- and risks overflowing our buffer -- we have
-  // this assert.
-  GOOGLE_COMPILE_ASSERT(DBL_DIG < 20, DBL_DIG_is_too_big);
+  // platforms these days.  The bit twiddling below relies on that layout.
+  GOOGLE_COMPILE_ASSERT(DBL_DIG == 15 && sizeof(double) == sizeof(uint64),
+                        double_is_not_ieee754);
 
   if (value == numeric_limits<double>::infinity()) {
     strcpy(buffer, "inf");
@@ -1210,49 +1566,30 @@ char* DoubleToBuffer(double value, char* buffer) {
     return buffer;
   }
 
-  int snprintf_result =
-    snprintf(buffer, kDoubleToBufferSize, "%.*g", DBL_DIG, value);
-
-  // The snprintf should never overflow because the buffer is significantly
-  // larger than the precision we asked for.
-  GOOGLE_DCHECK(snprintf_result > 0 && snprintf_result < kDoubleToBufferSize);
-
-  // We need to make parsed_value volatile in order to force the compiler to
-  // write it out to the stack.  Otherwise, it may keep the value in a
-  // register, and if it does that, it may keep it as a long double instead
-  // of a double.  This long double may have extra bits that make it compare
-  // unequal to "value" even though it would be exactly equal if it were
-  // truncated to a double.
-  volatile double parsed_value = strtod(buffer, NULL);
-  if (parsed_value != value) {
-    int snprintf_result =
-      snprintf(buffer, kDoubleToBufferSize, "%.*g", DBL_DIG+2, value);
-
-    // Should never overflow; see above.
-    GOOGLE_DCHECK(snprintf_result > 0 && snprintf_result < kDoubleToBufferSize);
+  uint64 bits;
+  memcpy(&bits, &value, sizeof(bits));
+  const bool negative = (bits >> 63) != 0;
+  const uint64 ieee_mantissa = bits & ((GOOGLE_ULONGLONG(1) << 52) - 1);
+  const int ieee_exponent = static_cast<int>((bits >> 52) & 0x7ff);
+
+  if (ieee_mantissa == 0 && ieee_exponent == 0) {
+    strcpy(buffer, negative ? "-0" : "0");
+    return buffer;
   }
 
-  DelocalizeRadix(buffer);
-  return buffer;
-}
+  GoogleOnceInit(&pow5_tables_once, &InitPow5Tables);
 
-bool safe_strtof(const char* str, float* value) {
-  char* endptr;
-  errno = 0;  // errno only gets set on errors
-#if defined(_WIN32) || defined (__hpux)  // has no strtof()
-  *value = strtod(str, &endptr);
-#else
-  *value = strtof(str, &endptr);
-#endif
-  return *str != 0 && *endptr == 0 && errno == 0;
+  uint64 digits;
+  int exponent;
+  ShortestDecimal(ieee_mantissa, ieee_exponent, 52, 1023, &digits, &exponent);
+  return FormatDecimal(negative, digits, exponent, DBL_DIG, buffer);
 }
 
 char* FloatToBuffer(float value, char* buffer) {
   // FLT_DIG is 6 for IEEE-754 floats, which are used on almost all
-  // platforms these days.  Just in case some system exists where FLT_DIG
-  // is significantly larger -- and risks overflowing our buffer -- we have
-  // this assert.
-  GOOGLE_COMPILE_ASSERT(FLT_DIG < 10, FLT_DIG_is_too_big);
+  // platforms these days.  The bit twiddling below relies on that layout.
+  GOOGLE_COMPILE_ASSERT(FLT_DIG == 6 && sizeof(float) == sizeof(uint32),
+                        float_is_not_ieee754);
 
   if (value == numeric_limits<double>::infinity()) {
     strcpy(buffer, "inf");
@@ -1265,24 +1602,23 @@ char* FloatToBuffer(float value, char* buffer) {
     return buffer;
   }
 
-  int snprintf_result =
-    snprintf(buffer, kFloatToBufferSize, "%.*g", FLT_DIG, value);
-
-  // The snprintf should never overflow because the buffer is significantly
-  // larger than the precision we asked for.
-  GOOGLE_DCHECK(snprintf_result > 0 && snprintf_result < kFloatToBufferSize);
-
-  float parsed_value;
-  if (!safe_strtof(buffer, &parsed_value) || parsed_value != value) {
-    int snprintf_result =
-      snprintf(buffer, kFloatToBufferSize, "%.*g", FLT_DIG+2, value);
+  uint32 bits;
+  memcpy(&bits, &value, sizeof(bits));
+  const bool negative = (bits >> 31) != 0;
+  const uint32 ieee_mantissa = bits & ((1u << 23) - 1);
+  const int ieee_exponent = static_cast<int>((bits >> 23) & 0xff);
 
-    // Should never overflow; see above.
-    GOOGLE_DCHECK(snprintf_result > 0 && snprintf_result < kFloatToBufferSize);
+  if (ieee_mantissa == 0 && ieee_exponent == 0) {
+    strcpy(buffer, negative ? "-0" : "0");
+    return buffer;
   }
 
-  DelocalizeRadix(buffer);
-  return buffer;
+  GoogleOnceInit(&pow5_tables_once, &InitPow5Tables);
+
+  uint64 digits;
+  int exponent;
+  ShortestDecimal(ieee_mantissa, ieee_exponent, 23, 127, &digits, &exponent);
+  return FormatDecimal(negative, digits, exponent, FLT_DIG, buffer);
 }
 
 string ToHex(uint64 num) {
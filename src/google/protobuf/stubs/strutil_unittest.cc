@@ -35,6 +35,11 @@
 #include <google/protobuf/testing/googletest.h>
 #include <gtest/gtest.h>
 #include <locale.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits>
 
 namespace google {
 namespace protobuf {
@@ -68,6 +73,142 @@ TEST(StringUtilityTest, ImmuneToLocales) {
   setlocale(LC_NUMERIC, old_locale.c_str());
 }
 
+TEST(StringUtilityTest, SimpleDtoaShortest) {
+  EXPECT_EQ("0", SimpleDtoa(0.0));
+  EXPECT_EQ("-0", SimpleDtoa(-0.0));
+  EXPECT_EQ("0.1", SimpleDtoa(0.1));
+  EXPECT_EQ("0.3", SimpleDtoa(0.3));
+  EXPECT_EQ("0.30000000000000004", SimpleDtoa(0.1 + 0.2));
+  EXPECT_EQ("-1.5", SimpleDtoa(-1.5));
+  EXPECT_EQ("100", SimpleDtoa(100.0));
+  EXPECT_EQ("123456789012345", SimpleDtoa(123456789012345.0));
+  EXPECT_EQ("1e+15", SimpleDtoa(1e15));
+  EXPECT_EQ("1e+300", SimpleDtoa(1e300));
+  EXPECT_EQ("0.0001", SimpleDtoa(1e-4));
+  EXPECT_EQ("1e-05", SimpleDtoa(1e-5));
+  EXPECT_EQ("1.7976931348623157e+308",
+            SimpleDtoa(numeric_limits<double>::max()));
+  EXPECT_EQ("2.2250738585072014e-308",
+            SimpleDtoa(numeric_limits<double>::min()));
+  EXPECT_EQ("5e-324", SimpleDtoa(numeric_limits<double>::denorm_min()));
+  EXPECT_EQ("inf", SimpleDtoa(numeric_limits<double>::infinity()));
+  EXPECT_EQ("-inf", SimpleDtoa(-numeric_limits<double>::infinity()));
+  EXPECT_EQ("nan", SimpleDtoa(numeric_limits<double>::quiet_NaN()));
+}
+
+TEST(StringUtilityTest, SimpleFtoaShortest) {
+  EXPECT_EQ("0", SimpleFtoa(0.0f));
+  EXPECT_EQ("0.1", SimpleFtoa(0.1f));
+  EXPECT_EQ("1.1", SimpleFtoa(1.1f));
+  EXPECT_EQ("16777216", SimpleFtoa(16777216.0f));
+  EXPECT_EQ("1e+10", SimpleFtoa(1e10f));
+  EXPECT_EQ("3.4028235e+38", SimpleFtoa(numeric_limits<float>::max()));
+  EXPECT_EQ("1e-45", SimpleFtoa(numeric_limits<float>::denorm_min()));
+  EXPECT_EQ("inf", SimpleFtoa(numeric_limits<float>::infinity()));
+}
+
+TEST(StringUtilityTest, DoubleRoundTrip) {
+  // Check that random bit patterns survive a trip through SimpleDtoa() and
+  // strtod(), and that they never need more digits than "%.17g" would use.
+  uint64 state = 12345;
+  for (int i = 0; i < 100000; i++) {
+    state = state * GOOGLE_ULONGLONG(6364136223846793005) +
+            GOOGLE_ULONGLONG(1442695040888963407);
+    double value;
+    memcpy(&value, &state, sizeof(value));
+    if (value != value) continue;
+
+    string text = SimpleDtoa(value);
+    EXPECT_EQ(value, strtod(text.c_str(), NULL)) << text;
+    EXPECT_LT(text.size(), kDoubleToBufferSize);
+
+    // A normal double with a 15-digit representation must print exactly
+    // as "%.15g" prints it.
+    char expected[kDoubleToBufferSize];
+    snprintf(expected, sizeof(expected), "%.15g", value);
+    if (fabs(value) >= numeric_limits<double>::min() &&
+        strtod(expected, NULL) == value) {
+      EXPECT_EQ(expected, text);
+    }
+  }
+}
+
+TEST(StringUtilityTest, FloatRoundTrip) {
+  uint32 state = 12345;
+  for (int i = 0; i < 100000; i++) {
+    state = state * 1664525u + 1013904223u;
+    float value;
+    memcpy(&value, &state, sizeof(value));
+    if (value != value) continue;
+
+    string text = SimpleFtoa(value);
+    EXPECT_EQ(value, strtof(text.c_str(), NULL)) << text;
+    EXPECT_LT(text.size(), kFloatToBufferSize);
+  }
+}
+
+TEST(StringUtilityTest, CEscape) {
+  EXPECT_EQ("", CEscape(""));
+  EXPECT_EQ("abc", CEscape("abc"));
+  EXPECT_EQ("\\n\\r\\t\\\"\\'\\\\", CEscape("\n\r\t\"\'\\"));
+  EXPECT_EQ("\\000\\001\\177\\200\\377", CEscape(string("\0\1\177\200\377", 5)));
+  EXPECT_EQ("\\303\\251", CEscape("\303\251"));
+  EXPECT_EQ("\303\251\\001", strings::Utf8SafeCEscape("\303\251\1"));
+  // A hex digit after a hex escape must be escaped too, but not after a
+  // two-character escape.
+  EXPECT_EQ("\\x01\\x61\\x62g", strings::CHexEscape("\1abg"));
+  EXPECT_EQ("\\na", strings::CHexEscape("\na"));
+
+  // Escapes at every position of runs longer than one vector.
+  const string plain = "The quick brown fox jumps over the lazy dog!";
+  for (size_t i = 0; i <= plain.size(); i++) {
+    string input = plain;
+    input.insert(i, "\"");
+    string expected = plain;
+    expected.insert(i, "\\\"");
+    EXPECT_EQ(expected, CEscape(input));
+  }
+}
+
+TEST(StringUtilityTest, CEscapeStringBufferSize) {
+  char buffer[8];
+  EXPECT_EQ(7, CEscapeString("\n\1a", 3, buffer, 8));
+  EXPECT_STREQ("\\n\\001a", buffer);
+  EXPECT_EQ(-1, CEscapeString("\n\1a", 3, buffer, 7));
+  EXPECT_EQ(-1, CEscapeString("abcdefgh", 8, buffer, 8));
+}
+
+TEST(StringUtilityTest, UnescapeCEscapeSequences) {
+  EXPECT_EQ("\n\r\t\"\'\\?\a\b\f\v",
+            UnescapeCEscapeString("\\n\\r\\t\\\"\\'\\\\\\?\\a\\b\\f\\v"));
+  EXPECT_EQ(string("\0\1\10A", 4), UnescapeCEscapeString("\\0\\1\\010\\101"));
+  EXPECT_EQ("\x12\xab", UnescapeCEscapeString("\\x12\\xAb"));
+  EXPECT_EQ("plain text with no escapes",
+            UnescapeCEscapeString("plain text with no escapes"));
+
+  // Unescaping in place.
+  char buffer[] = "abc\\ndef\\tghi";
+  EXPECT_EQ(11, UnescapeCEscapeSequences(buffer, buffer));
+  EXPECT_STREQ("abc\ndef\tghi", buffer);
+}
+
+TEST(StringUtilityTest, CEscapeRoundTrip) {
+  uint32 state = 12345;
+  for (int i = 0; i < 1000; i++) {
+    string input;
+    int length = i % 100;
+    for (int j = 0; j < length; j++) {
+      state = state * 1664525u + 1013904223u;
+      // Mostly printable characters, like real text.
+      int c = state >> 24;
+      input.push_back(c < 224 ? ' ' + (c % 95) : c);
+    }
+    EXPECT_EQ(input, UnescapeCEscapeString(CEscape(input)));
+    EXPECT_EQ(input, UnescapeCEscapeString(strings::CHexEscape(input)));
+    EXPECT_EQ(input, UnescapeCEscapeString(strings::Utf8SafeCEscape(input)));
+  }
+}
+
 }  // anonymous namespace
 }  // namespace protobuf
 }  // namespace google
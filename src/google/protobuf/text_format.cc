@@ -1088,6 +1088,45 @@ class TextFormat::Printer::TextGenerator {
     Write(text + pos, size - pos);
   }
 
+  // Print the given value escaped as CEscape() would, or as
+  // strings::Utf8SafeCEscape() would if utf8_safe is true, without building
+  // an escaped copy of it first.
+  void PrintEscaped(const string& value, bool utf8_safe) {
+    const char* data = value.data();
+    int size = value.size();
+    int pos = 0;  // The number of bytes we've written so far.
+
+    for (int i = 0; i < size; i++) {
+      uint8 c = static_cast<uint8>(data[i]);
+      char escape[4];
+      int escape_size = 2;
+      escape[0] = '\\';
+      switch (c) {
+        case '\n': escape[1] = 'n';  break;
+        case '\r': escape[1] = 'r';  break;
+        case '\t': escape[1] = 't';  break;
+        case '\"': escape[1] = '\"'; break;
+        case '\'': escape[1] = '\''; break;
+        case '\\': escape[1] = '\\'; break;
+        default:
+          // Printable ASCII, as isprint() defines it in the "C" locale.
+          if ((c >= 0x20 && c < 0x7f) || (utf8_safe && c >= 0x80)) continue;
+          escape[1] = '0' + (c >> 6);
+          escape[2] = '0' + ((c >> 3) & 7);
+          escape[3] = '0' + (c & 7);
+          escape_size = 4;
+          break;
+      }
+
+      // None of this contains newlines, so it can bypass Print().
+      Write(data + pos, i - pos);
+      Write(escape, escape_size);
+      pos = i + 1;
+    }
+
+    Write(data + pos, size - pos);
+  }
+
   // True if any write to the underlying stream failed.  (We don't just
   // crash in this case because this is an I/O failure, not a programming
   // error.)
@@ -1319,6 +1358,20 @@ string TextFormat::FieldValuePrinter::PrintMessageEnd(
 }
 
 namespace {
+
+// Like the Fast*ToBufferLeft() functions, these return a pointer to the end
+// of the text they write, for use by PrintFieldValue().
+char* FloatToBufferEnd(float value, char* buffer) {
+  return buffer + strlen(FloatToBuffer(value, buffer));
+}
+char* DoubleToBufferEnd(double value, char* buffer) {
+  return buffer + strlen(DoubleToBuffer(value, buffer));
+}
+char* BoolToBufferEnd(bool value, char* buffer) {
+  strcpy(buffer, value ? "true" : "false");
+  return buffer + (value ? 4 : 5);
+}
+
 // Our own specialization: for UTF8 escaped strings.
 class FieldValuePrinterUtf8Escaping : public TextFormat::FieldValuePrinter {
  public:
@@ -1338,7 +1391,9 @@ TextFormat::Printer::Printer()
     use_field_number_(false),
     use_short_repeated_primitives_(false),
     hide_unknown_fields_(false),
-    print_message_fields_in_index_order_(false) {
+    print_message_fields_in_index_order_(false),
+    default_printer_is_built_in_(false),
+    use_utf8_string_escaping_(false) {
   SetUseUtf8StringEscaping(false);
 }
 
@@ -1350,11 +1405,27 @@ void TextFormat::Printer::SetUseUtf8StringEscaping(bool as_utf8) {
   SetDefaultFieldValuePrinter(as_utf8
                               ? new FieldValuePrinterUtf8Escaping()
                               : new FieldValuePrinter());
+  default_printer_is_built_in_ = true;
+  use_utf8_string_escaping_ = as_utf8;
 }
 
 void TextFormat::Printer::SetDefaultFieldValuePrinter(
     const FieldValuePrinter* printer) {
   default_field_value_printer_.reset(printer);
+  default_printer_is_built_in_ = false;
+}
+
+const TextFormat::FieldValuePrinter* TextFormat::Printer::GetCustomPrinter(
+    const FieldDescriptor* field) const {
+  const FieldValuePrinter* printer = default_field_value_printer_.get();
+  if (!custom_printers_.empty()) {
+    printer = FindWithDefault(custom_printers_, field, printer);
+  }
+  if (printer == default_field_value_printer_.get() &&
+      default_printer_is_built_in_) {
+    return NULL;
+  }
+  return printer;
 }
 
 bool TextFormat::Printer::RegisterFieldValuePrinter(
@@ -1472,21 +1543,28 @@ void TextFormat::Printer::PrintField(const Message& message,
     PrintFieldName(message, reflection, field, generator);
 
     if (field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
-      const FieldValuePrinter* printer = FindWithDefault(
-          custom_printers_, field, default_field_value_printer_.get());
+      const FieldValuePrinter* printer = GetCustomPrinter(field);
       const Message& sub_message =
               field->is_repeated()
               ? reflection->GetRepeatedMessage(message, field, j)
               : reflection->GetMessage(message, field);
-      generator.Print(
-          printer->PrintMessageStart(
-              sub_message, field_index, count, single_line_mode_));
+      if (printer == NULL) {
+        generator.Print(single_line_mode_ ? " { " : " {\n");
+      } else {
+        generator.Print(
+            printer->PrintMessageStart(
+                sub_message, field_index, count, single_line_mode_));
+      }
       generator.Indent();
       Print(sub_message, generator);
       generator.Outdent();
-      generator.Print(
-          printer->PrintMessageEnd(
-              sub_message, field_index, count, single_line_mode_));
+      if (printer == NULL) {
+        generator.Print(single_line_mode_ ? "} " : "}\n");
+      } else {
+        generator.Print(
+            printer->PrintMessageEnd(
+                sub_message, field_index, count, single_line_mode_));
+      }
     } else {
       generator.Print(": ");
       // Write the field value.
@@ -1532,9 +1610,31 @@ void TextFormat::Printer::PrintFieldName(const Message& message,
     return;
   }
 
-  const FieldValuePrinter* printer = FindWithDefault(
-      custom_printers_, field, default_field_value_printer_.get());
-  generator.Print(printer->PrintFieldName(message, reflection, field));
+  const FieldValuePrinter* printer = GetCustomPrinter(field);
+  if (printer != NULL) {
+    generator.Print(printer->PrintFieldName(message, reflection, field));
+    return;
+  }
+
+  // Same as FieldValuePrinter::PrintFieldName().
+  if (field->is_extension()) {
+    generator.Print("[");
+    // We special-case MessageSet elements for compatibility with proto1.
+    if (field->containing_type()->options().message_set_wire_format()
+        && field->type() == FieldDescriptor::TYPE_MESSAGE
+        && field->is_optional()
+        && field->extension_scope() == field->message_type()) {
+      generator.Print(field->message_type()->full_name());
+    } else {
+      generator.Print(field->full_name());
+    }
+    generator.Print("]");
+  } else if (field->type() == FieldDescriptor::TYPE_GROUP) {
+    // Groups must be serialized with their original capitalization.
+    generator.Print(field->message_type()->name());
+  } else {
+    generator.Print(field->name());
+  }
 }
 
 void TextFormat::Printer::PrintFieldValue(
@@ -1546,25 +1646,31 @@ void TextFormat::Printer::PrintFieldValue(
   GOOGLE_DCHECK(field->is_repeated() || (index == -1))
       << "Index must be -1 for non-repeated fields";
 
-  const FieldValuePrinter* printer
-      = FindWithDefault(custom_printers_, field,
-                        default_field_value_printer_.get());
+  const FieldValuePrinter* printer = GetCustomPrinter(field);
+  // Scratch space for numbers printed without a FieldValuePrinter.
+  char buffer[kFastToBufferSize];
 
   switch (field->cpp_type()) {
-#define OUTPUT_FIELD(CPPTYPE, METHOD)                                   \
-    case FieldDescriptor::CPPTYPE_##CPPTYPE:                            \
-      generator.Print(printer->Print##METHOD(field->is_repeated()       \
-               ? reflection->GetRepeated##METHOD(message, field, index) \
-               : reflection->Get##METHOD(message, field)));             \
-        break
-
-    OUTPUT_FIELD( INT32,  Int32);
-    OUTPUT_FIELD( INT64,  Int64);
-    OUTPUT_FIELD(UINT32, UInt32);
-    OUTPUT_FIELD(UINT64, UInt64);
-    OUTPUT_FIELD( FLOAT,  Float);
-    OUTPUT_FIELD(DOUBLE, Double);
-    OUTPUT_FIELD(  BOOL,   Bool);
+#define OUTPUT_FIELD(CPPTYPE, METHOD, TYPE, TO_BUFFER)                  \
+    case FieldDescriptor::CPPTYPE_##CPPTYPE: {                          \
+      const TYPE value = field->is_repeated()                           \
+          ? reflection->GetRepeated##METHOD(message, field, index)      \
+          : reflection->Get##METHOD(message, field);                    \
+      if (printer == NULL) {                                            \
+        generator.Print(buffer, TO_BUFFER(value, buffer) - buffer);     \
+      } else {                                                          \
+        generator.Print(printer->Print##METHOD(value));                 \
+      }                                                                 \
+      break;                                                            \
+    }
+
+    OUTPUT_FIELD( INT32,  Int32,  int32,  FastInt32ToBufferLeft);
+    OUTPUT_FIELD( INT64,  Int64,  int64,  FastInt64ToBufferLeft);
+    OUTPUT_FIELD(UINT32, UInt32, uint32, FastUInt32ToBufferLeft);
+    OUTPUT_FIELD(UINT64, UInt64, uint64, FastUInt64ToBufferLeft);
+    OUTPUT_FIELD( FLOAT,  Float,  float,       FloatToBufferEnd);
+    OUTPUT_FIELD(DOUBLE, Double, double,      DoubleToBufferEnd);
+    OUTPUT_FIELD(  BOOL,   Bool,   bool,        BoolToBufferEnd);
 #undef OUTPUT_FIELD
 
     case FieldDescriptor::CPPTYPE_STRING: {
@@ -1573,7 +1679,13 @@ void TextFormat::Printer::PrintFieldValue(
           ? reflection->GetRepeatedStringReference(
               message, field, index, &scratch)
           : reflection->GetStringReference(message, field, &scratch);
-      if (field->type() == FieldDescriptor::TYPE_STRING) {
+      if (printer == NULL) {
+        generator.Print("\"");
+        generator.PrintEscaped(value,
+            use_utf8_string_escaping_ &&
+            field->type() == FieldDescriptor::TYPE_STRING);
+        generator.Print("\"");
+      } else if (field->type() == FieldDescriptor::TYPE_STRING) {
         generator.Print(printer->PrintString(value));
       } else {
         GOOGLE_DCHECK_EQ(field->type(), FieldDescriptor::TYPE_BYTES);
@@ -1588,7 +1700,14 @@ void TextFormat::Printer::PrintFieldValue(
           : reflection->GetEnumValue(message, field);
       const EnumValueDescriptor* enum_desc =
           field->enum_type()->FindValueByNumber(enum_value);
-      if (enum_desc != NULL) {
+      if (printer == NULL) {
+        if (enum_desc != NULL) {
+          generator.Print(enum_desc->name());
+        } else {
+          generator.Print(
+              buffer, FastInt32ToBufferLeft(enum_value, buffer) - buffer);
+        }
+      } else if (enum_desc != NULL) {
         generator.Print(printer->PrintEnum(enum_value, enum_desc->name()));
       } else {
         // Ordinarily, enum_desc should not be null, because proto2 has the
@@ -245,6 +245,13 @@ class LIBPROTOBUF_EXPORT TextFormat {
                         const FieldDescriptor* field,
                         TextGenerator& generator) const;
 
+    // Returns the FieldValuePrinter to use for the given field, or NULL if
+    // it is one of the built-in ones set by SetUseUtf8StringEscaping().  The
+    // built-in printers' output is written straight to the TextGenerator
+    // instead, which avoids building a temporary string for every value.
+    const FieldValuePrinter* GetCustomPrinter(
+        const FieldDescriptor* field) const;
+
     // Outputs a textual representation of the value of the field supplied on
     // the message supplied or the default value if not set.
     void PrintFieldValue(const Message& message,
@@ -272,6 +279,10 @@ class LIBPROTOBUF_EXPORT TextFormat {
     bool print_message_fields_in_index_order_;
 
     google::protobuf::scoped_ptr<const FieldValuePrinter> default_field_value_printer_;
+    // True if default_field_value_printer_ was set by
+    // SetUseUtf8StringEscaping() rather than SetDefaultFieldValuePrinter().
+    bool default_printer_is_built_in_;
+    bool use_utf8_string_escaping_;
     typedef map<const FieldDescriptor*,
                 const FieldValuePrinter*> CustomPrinterMap;
     CustomPrinterMap custom_printers_;
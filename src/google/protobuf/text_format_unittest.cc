@@ -413,6 +413,49 @@ TEST_F(TextFormatTest, DefaultCustomFieldPrinter) {
   EXPECT_EQ("optional_uint32: 42u\nrepeated_uint32: [1u, 2u, 3u]\n", text);
 }
 
+// Does the same as the printer set by SetUseUtf8StringEscaping(true).
+class Utf8FieldValuePrinter : public TextFormat::FieldValuePrinter {
+ public:
+  virtual string PrintString(const string& val) const {
+    return StrCat("\"", strings::Utf8SafeCEscape(val), "\"");
+  }
+  virtual string PrintBytes(const string& val) const {
+    return FieldValuePrinter::PrintString(val);
+  }
+};
+
+TEST_F(TextFormatTest, BuiltInPrinterMatchesFieldValuePrinter) {
+  // The built-in printers write values directly rather than calling the
+  // FieldValuePrinter methods; make sure the output is the same.
+  string all_bytes;
+  for (int i = 0; i < 256; i++) {
+    all_bytes.push_back(static_cast<char>(i));
+  }
+  TestUtil::SetAllFields(&proto_);
+  proto_.set_optional_string(all_bytes + "\350\260\267\346\255\214");
+  proto_.set_optional_bytes(all_bytes);
+  proto_.add_repeated_float(-1.5e-30f);
+  proto_.add_repeated_double(1e300);
+
+  for (int utf8 = 0; utf8 < 2; utf8++) {
+    for (int single_line = 0; single_line < 2; single_line++) {
+      TextFormat::Printer built_in_printer;
+      built_in_printer.SetUseUtf8StringEscaping(utf8);
+      built_in_printer.SetSingleLineMode(single_line);
+
+      TextFormat::Printer custom_printer;
+      custom_printer.SetDefaultFieldValuePrinter(
+          utf8 ? new Utf8FieldValuePrinter : new TextFormat::FieldValuePrinter);
+      custom_printer.SetSingleLineMode(single_line);
+
+      string expected, actual;
+      EXPECT_TRUE(custom_printer.PrintToString(proto_, &expected));
+      EXPECT_TRUE(built_in_printer.PrintToString(proto_, &actual));
+      EXPECT_EQ(expected, actual);
+    }
+  }
+}
+
 class CustomInt32FieldValuePrinter : public TextFormat::FieldValuePrinter {
  public:
   virtual string PrintInt32(int32 val) const {
@@ -1190,6 +1233,40 @@ TEST_F(TextFormatParserTest, ParseFieldValueFromString) {
 }
 
 
+TEST_F(TextFormatParserTest, ParseFieldsInAnyOrder) {
+  // The parser guesses which field comes next from the previous one; make
+  // sure the guess never changes the result.
+  protobuf_unittest::TestAllTypes message;
+  EXPECT_TRUE(TextFormat::MergeFromString(
+      "optional_int64: 2\n"
+      "optional_int32: 1\n"
+      "repeated_int32: 3\n"
+      "optional_int32: 4\n"
+      "repeated_int32: 5\n"
+      "repeated_int32: 6\n"
+      "RepeatedGroup { a: 7 }\n"
+      "RepeatedGroup { a: 8 }\n"
+      "repeated_nested_message { bb: 9 }\n"
+      "repeated_nested_message { bb: 10 }\n"
+      "optional_uint32: 11\n",
+      &message));
+
+  EXPECT_EQ(4, message.optional_int32());
+  EXPECT_EQ(2, message.optional_int64());
+  EXPECT_EQ(11, message.optional_uint32());
+  ASSERT_EQ(3, message.repeated_int32_size());
+  EXPECT_EQ(3, message.repeated_int32(0));
+  EXPECT_EQ(6, message.repeated_int32(2));
+  ASSERT_EQ(2, message.repeatedgroup_size());
+  EXPECT_EQ(8, message.repeatedgroup(1).a());
+  ASSERT_EQ(2, message.repeated_nested_message_size());
+  EXPECT_EQ(10, message.repeated_nested_message(1).bb());
+
+  // A group's field name only matches via its type name.
+  EXPECT_FALSE(TextFormat::MergeFromString(
+      "RepeatedGroup { a: 1 } repeatedgroup { a: 2 }", &message));
+}
+
 TEST_F(TextFormatParserTest, InvalidToken) {
   ExpectFailure("optional_bool: true\n-5\n", "Expected identifier.",
                 2, 1);
@@ -0,0 +1,840 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/util/message_differencer.h>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/stl_util.h>
+#include <google/protobuf/stubs/strutil.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+namespace google {
+namespace protobuf {
+namespace util {
+
+namespace {
+
+// Returns true if the given message is an instance of a generated class,
+// whose serialization is cheap compared to walking the fields through
+// reflection.
+bool IsGeneratedMessage(const Message& message) {
+  const Descriptor* descriptor = message.GetDescriptor();
+  if (descriptor->file()->pool() != DescriptorPool::generated_pool()) {
+    return false;
+  }
+  const Message* prototype =
+      MessageFactory::generated_factory()->GetPrototype(descriptor);
+  return prototype != NULL &&
+         prototype->GetReflection() == message.GetReflection();
+}
+
+// NaN is the only value which is not equal to itself.
+template <typename T>
+bool IsNaN(T value) {
+  return value != value;
+}
+
+bool ContainsNaN(const Message& message);
+
+// Returns true if the given float, double, or message field of the message
+// holds NaN.
+bool FieldContainsNaN(const Message& message, const FieldDescriptor* field) {
+  const Reflection* reflection = message.GetReflection();
+  if (!field->is_repeated()) {
+    if (!reflection->HasField(message, field)) return false;
+    switch (field->cpp_type()) {
+      case FieldDescriptor::CPPTYPE_FLOAT:
+        return IsNaN(reflection->GetFloat(message, field));
+      case FieldDescriptor::CPPTYPE_DOUBLE:
+        return IsNaN(reflection->GetDouble(message, field));
+      default:
+        return ContainsNaN(reflection->GetMessage(message, field));
+    }
+  }
+  int count = reflection->FieldSize(message, field);
+  for (int i = 0; i < count; i++) {
+    bool nan;
+    switch (field->cpp_type()) {
+      case FieldDescriptor::CPPTYPE_FLOAT:
+        nan = IsNaN(reflection->GetRepeatedFloat(message, field, i));
+        break;
+      case FieldDescriptor::CPPTYPE_DOUBLE:
+        nan = IsNaN(reflection->GetRepeatedDouble(message, field, i));
+        break;
+      default:
+        nan = ContainsNaN(reflection->GetRepeatedMessage(message, field, i));
+        break;
+    }
+    if (nan) return true;
+  }
+  return false;
+}
+
+// Returns true if the field may hold NaN itself or in a sub-message.
+bool MayContainNaN(const FieldDescriptor* field) {
+  return field->cpp_type() == FieldDescriptor::CPPTYPE_FLOAT ||
+         field->cpp_type() == FieldDescriptor::CPPTYPE_DOUBLE ||
+         field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE;
+}
+
+// Returns true if a float or double field anywhere in the message, including
+// its extensions and sub-messages, holds NaN.
+bool ContainsNaN(const Message& message) {
+  // Look the fields up directly instead of listing every field that is set,
+  // since most of them can't hold NaN.
+  const Descriptor* descriptor = message.GetDescriptor();
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    const FieldDescriptor* field = descriptor->field(i);
+    if (MayContainNaN(field) && FieldContainsNaN(message, field)) return true;
+  }
+  if (descriptor->extension_range_count() > 0) {
+    vector<const FieldDescriptor*> fields;
+    message.GetReflection()->ListFields(message, &fields);
+    for (int i = 0; i < fields.size(); i++) {
+      const FieldDescriptor* field = fields[i];
+      if (field->is_extension() && MayContainNaN(field) &&
+          FieldContainsNaN(message, field)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Compares everything but the contents of groups.
+bool UnknownFieldValuesEqual(const UnknownField& field1,
+                             const UnknownField& field2) {
+  if (field1.type() != field2.type()) return false;
+  switch (field1.type()) {
+    case UnknownField::TYPE_VARINT:
+      return field1.varint() == field2.varint();
+    case UnknownField::TYPE_FIXED32:
+      return field1.fixed32() == field2.fixed32();
+    case UnknownField::TYPE_FIXED64:
+      return field1.fixed64() == field2.fixed64();
+    case UnknownField::TYPE_LENGTH_DELIMITED:
+      return field1.length_delimited() == field2.length_delimited();
+    case UnknownField::TYPE_GROUP:
+      return true;
+  }
+  return false;
+}
+
+// Returns the (number, index) pairs of the given fields, sorted by number
+// but otherwise in their original order.
+void SortUnknownFields(const UnknownFieldSet& unknown_fields,
+                       vector<pair<int, int> >* output) {
+  output->reserve(unknown_fields.field_count());
+  for (int i = 0; i < unknown_fields.field_count(); i++) {
+    output->push_back(std::make_pair(unknown_fields.field(i).number(), i));
+  }
+  std::sort(output->begin(), output->end());
+}
+
+}  // namespace
+
+MessageDifferencer::Reporter::Reporter() {}
+MessageDifferencer::Reporter::~Reporter() {}
+
+// ===================================================================
+
+MessageDifferencer::StreamReporter::StreamReporter(
+    io::ZeroCopyOutputStream* output)
+  : printer_(output, '$') {
+  text_printer_.SetSingleLineMode(true);
+}
+
+MessageDifferencer::StreamReporter::~StreamReporter() {}
+
+void MessageDifferencer::StreamReporter::ReportAdded(
+    const Message& message1, const Message& message2,
+    const vector<SpecificField>& field_path) {
+  printer_.Print("added: ");
+  PrintPath(field_path);
+  printer_.Print(": ");
+  PrintValue(message2, field_path, false);
+  printer_.Print("\n");
+}
+
+void MessageDifferencer::StreamReporter::ReportDeleted(
+    const Message& message1, const Message& message2,
+    const vector<SpecificField>& field_path) {
+  printer_.Print("deleted: ");
+  PrintPath(field_path);
+  printer_.Print(": ");
+  PrintValue(message1, field_path, true);
+  printer_.Print("\n");
+}
+
+void MessageDifferencer::StreamReporter::ReportModified(
+    const Message& message1, const Message& message2,
+    const vector<SpecificField>& field_path) {
+  printer_.Print("modified: ");
+  PrintPath(field_path);
+  printer_.Print(": ");
+  PrintValue(message1, field_path, true);
+  printer_.Print(" -> ");
+  PrintValue(message2, field_path, false);
+  printer_.Print("\n");
+}
+
+void MessageDifferencer::StreamReporter::PrintPath(
+    const vector<SpecificField>& field_path) {
+  for (int i = 0; i < field_path.size(); i++) {
+    if (i > 0) printer_.Print(".");
+
+    const SpecificField& specific_field = field_path[i];
+    const FieldDescriptor* field = specific_field.field;
+    if (field == NULL) {
+      printer_.PrintRaw(SimpleItoa(specific_field.unknown_field_number));
+    } else if (field->is_extension()) {
+      printer_.PrintRaw("(" + field->full_name() + ")");
+    } else {
+      printer_.PrintRaw(field->name());
+    }
+
+    if (field == NULL || field->is_repeated()) {
+      int index = specific_field.index;
+      int new_index = specific_field.new_index;
+      if (index >= 0 && new_index >= 0 && index != new_index) {
+        printer_.PrintRaw(StrCat("[", index, "->", new_index, "]"));
+      } else {
+        printer_.PrintRaw(StrCat("[", index >= 0 ? index : new_index, "]"));
+      }
+    }
+  }
+}
+
+void MessageDifferencer::StreamReporter::PrintValue(
+    const Message& message, const vector<SpecificField>& field_path,
+    bool left_side) {
+  // Find the message containing the field.  Unknown fields carry pointers to
+  // their containing sets instead.
+  const Message* parent = &message;
+  for (int i = 0; i + 1 < field_path.size(); i++) {
+    const FieldDescriptor* field = field_path[i].field;
+    if (field == NULL) break;
+    const Reflection* reflection = parent->GetReflection();
+    if (field->is_repeated()) {
+      parent = &reflection->GetRepeatedMessage(*parent, field,
+          left_side ? field_path[i].index : field_path[i].new_index);
+    } else {
+      parent = &reflection->GetMessage(*parent, field);
+    }
+  }
+
+  const SpecificField& specific_field = field_path.back();
+  const FieldDescriptor* field = specific_field.field;
+  if (field == NULL) {
+    const UnknownField& unknown_field = left_side ?
+        specific_field.unknown_field_set1->field(
+            specific_field.unknown_field_index1) :
+        specific_field.unknown_field_set2->field(
+            specific_field.unknown_field_index2);
+    char buffer[kFastToBufferSize];
+    string output;
+    switch (unknown_field.type()) {
+      case UnknownField::TYPE_VARINT:
+        printer_.PrintRaw(SimpleItoa(unknown_field.varint()));
+        break;
+      case UnknownField::TYPE_FIXED32:
+        printer_.PrintRaw("0x");
+        printer_.PrintRaw(FastHex32ToBuffer(unknown_field.fixed32(), buffer));
+        break;
+      case UnknownField::TYPE_FIXED64:
+        printer_.PrintRaw("0x");
+        printer_.PrintRaw(FastHex64ToBuffer(unknown_field.fixed64(), buffer));
+        break;
+      case UnknownField::TYPE_LENGTH_DELIMITED:
+        printer_.PrintRaw(
+            "\"" + CEscape(unknown_field.length_delimited()) + "\"");
+        break;
+      case UnknownField::TYPE_GROUP:
+        text_printer_.PrintUnknownFieldsToString(unknown_field.group(),
+                                                 &output);
+        printer_.PrintRaw("{ " + output + "}");
+        break;
+    }
+    return;
+  }
+
+  int index = -1;
+  if (field->is_repeated()) {
+    index = left_side ? specific_field.index : specific_field.new_index;
+  }
+  string output;
+  text_printer_.PrintFieldValueToString(*parent, field, index, &output);
+  if (field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
+    // In single-line mode, the contents end with a space.
+    printer_.PrintRaw("{ " + output + "}");
+  } else {
+    printer_.PrintRaw(output);
+  }
+}
+
+// ===================================================================
+
+bool MessageDifferencer::Equals(const Message& message1,
+                                const Message& message2) {
+  MessageDifferencer differencer;
+  return differencer.Compare(message1, message2);
+}
+
+MessageDifferencer::MessageDifferencer()
+  : repeated_field_comparison_(AS_LIST),
+    reporter_(NULL),
+    report_string_(NULL) {}
+
+MessageDifferencer::~MessageDifferencer() {}
+
+void MessageDifferencer::TreatAsList(const FieldDescriptor* field) {
+  GOOGLE_CHECK(field->is_repeated()) << "Field must be repeated: "
+                              << field->full_name();
+  set_fields_.erase(field);
+  map_keys_.erase(field);
+  list_fields_.insert(field);
+}
+
+void MessageDifferencer::TreatAsSet(const FieldDescriptor* field) {
+  GOOGLE_CHECK(field->is_repeated()) << "Field must be repeated: "
+                              << field->full_name();
+  list_fields_.erase(field);
+  map_keys_.erase(field);
+  set_fields_.insert(field);
+}
+
+void MessageDifferencer::TreatAsMap(const FieldDescriptor* field,
+                                    const FieldDescriptor* key) {
+  GOOGLE_CHECK(field->is_repeated() &&
+        field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE)
+      << "Field must be a repeated message field: " << field->full_name();
+  GOOGLE_CHECK(!key->is_repeated() &&
+        key->containing_type() == field->message_type())
+      << key->full_name() << " must be a singular field of "
+      << field->message_type()->full_name();
+  list_fields_.erase(field);
+  set_fields_.erase(field);
+  map_keys_[field] = key;
+}
+
+void MessageDifferencer::ReportDifferencesTo(Reporter* reporter) {
+  reporter_ = reporter;
+  report_string_ = NULL;
+}
+
+void MessageDifferencer::ReportDifferencesToString(string* output) {
+  reporter_ = NULL;
+  report_string_ = output;
+}
+
+const FieldDescriptor* MessageDifferencer::GetMapKey(
+    const FieldDescriptor* field) const {
+  map<const FieldDescriptor*, const FieldDescriptor*>::const_iterator iter =
+      map_keys_.find(field);
+  if (iter != map_keys_.end()) return iter->second;
+  if (field->is_map() && list_fields_.count(field) == 0) {
+    return field->message_type()->FindFieldByNumber(1);
+  }
+  return NULL;
+}
+
+bool MessageDifferencer::IsTreatedAsSet(const FieldDescriptor* field) const {
+  if (set_fields_.count(field) > 0) return true;
+  return repeated_field_comparison_ == AS_SET &&
+         list_fields_.count(field) == 0;
+}
+
+bool MessageDifferencer::Compare(const Message& message1,
+                                 const Message& message2) {
+  const Descriptor* descriptor = message1.GetDescriptor();
+  if (message2.GetDescriptor() != descriptor) {
+    GOOGLE_LOG(DFATAL) << "Tried to compare messages of different types "
+                << "(" << descriptor->full_name()
+                << " and " << message2.GetDescriptor()->full_name() << ")";
+    return false;
+  }
+
+  Context context;
+  context.message1 = &message1;
+  context.message2 = &message2;
+  context.reporter = reporter_;
+
+  // Declared in this order so that the reporter, which flushes its output
+  // when destroyed, goes before the stream.
+  scoped_ptr<io::StringOutputStream> output_stream;
+  scoped_ptr<StreamReporter> string_reporter;
+  if (report_string_ != NULL) {
+    output_stream.reset(new io::StringOutputStream(report_string_));
+    string_reporter.reset(new StreamReporter(output_stream.get()));
+    context.reporter = string_reporter.get();
+  }
+
+  // When all we need is a yes-or-no answer, generated messages can often be
+  // compared through their serializations, which is several times faster
+  // than reflection.  Equal messages always have the same encoded size:
+  // values compare equal only if they encode identically, and every
+  // comparison mode matches up elements one to one.  Identical encodings
+  // mean equal messages under every comparison mode, except that NaN never
+  // equals itself.  Different encodings prove nothing, though, since map
+  // entries, elements compared as sets, and -0.0 versus 0.0 can differ in
+  // the bytes but not in value, so those fall through to reflection.
+  if (context.reporter == NULL &&
+      IsGeneratedMessage(message1) && IsGeneratedMessage(message2)) {
+    int size = message1.ByteSize();
+    if (size != message2.ByteSize()) return false;
+    string data1;
+    string data2;
+    data1.resize(size);
+    data2.resize(size);
+    if (size > 0) {
+      message1.SerializeWithCachedSizesToArray(
+          reinterpret_cast<uint8*>(string_as_array(&data1)));
+      message2.SerializeWithCachedSizesToArray(
+          reinterpret_cast<uint8*>(string_as_array(&data2)));
+    }
+    if (data1 == data2 && !ContainsNaN(message1)) return true;
+  }
+
+  vector<SpecificField> field_path;
+  return CompareMessage(context, message1, message2, &field_path);
+}
+
+bool MessageDifferencer::CompareMessage(
+    const Context& context,
+    const Message& message1, const Message& message2,
+    vector<SpecificField>* field_path) {
+  const Reflection* reflection1 = message1.GetReflection();
+  const Reflection* reflection2 = message2.GetReflection();
+
+  // ListFields() sorts the fields by number, so we can walk both lists
+  // together.
+  vector<const FieldDescriptor*> fields1;
+  vector<const FieldDescriptor*> fields2;
+  reflection1->ListFields(message1, &fields1);
+  reflection2->ListFields(message2, &fields2);
+
+  bool equal = true;
+  int i = 0;
+  int j = 0;
+  while (i < fields1.size() || j < fields2.size()) {
+    const FieldDescriptor* field1 = i < fields1.size() ? fields1[i] : NULL;
+    const FieldDescriptor* field2 = j < fields2.size() ? fields2[j] : NULL;
+
+    if (field2 == NULL ||
+        (field1 != NULL && field1->number() < field2->number())) {
+      // Only set in message1.
+      if (context.reporter == NULL) return false;
+      ReportWholeField(context, message1, field1, false, field_path);
+      equal = false;
+      ++i;
+      continue;
+    }
+    if (field1 == NULL || field2->number() < field1->number()) {
+      // Only set in message2.
+      if (context.reporter == NULL) return false;
+      ReportWholeField(context, message2, field2, true, field_path);
+      equal = false;
+      ++j;
+      continue;
+    }
+
+    bool field_equal;
+    if (field1->is_repeated()) {
+      field_equal = CompareRepeatedField(context, message1, message2, field1,
+                                         field_path);
+    } else {
+      SpecificField specific_field;
+      specific_field.field = field1;
+      field_path->push_back(specific_field);
+      field_equal = CompareFieldValue(context, message1, message2, field1,
+                                      -1, -1, field_path);
+      field_path->pop_back();
+    }
+    if (!field_equal) {
+      if (context.reporter == NULL) return false;
+      equal = false;
+    }
+    ++i;
+    ++j;
+  }
+
+  if (!CompareUnknownFields(context,
+                            reflection1->GetUnknownFields(message1),
+                            reflection2->GetUnknownFields(message2),
+                            field_path)) {
+    equal = false;
+  }
+
+  return equal;
+}
+
+bool MessageDifferencer::CompareRepeatedField(
+    const Context& context,
+    const Message& message1, const Message& message2,
+    const FieldDescriptor* field,
+    vector<SpecificField>* field_path) {
+  int count1 = message1.GetReflection()->FieldSize(message1, field);
+  int count2 = message2.GetReflection()->FieldSize(message2, field);
+  const FieldDescriptor* key = GetMapKey(field);
+
+  SpecificField specific_field;
+  specific_field.field = field;
+  bool equal = true;
+
+  if (key == NULL && !IsTreatedAsSet(field)) {
+    // Compare as lists.
+    if (count1 != count2 && context.reporter == NULL) return false;
+    int common_count = std::min(count1, count2);
+    for (int i = 0; i < common_count; i++) {
+      specific_field.index = i;
+      specific_field.new_index = i;
+      field_path->push_back(specific_field);
+      bool element_equal = CompareFieldValue(context, message1, message2,
+                                             field, i, i, field_path);
+      field_path->pop_back();
+      if (!element_equal) {
+        if (context.reporter == NULL) return false;
+        equal = false;
+      }
+    }
+    for (int i = common_count; i < count1; i++) {
+      specific_field.index = i;
+      specific_field.new_index = -1;
+      field_path->push_back(specific_field);
+      context.reporter->ReportDeleted(*context.message1, *context.message2,
+                                      *field_path);
+      field_path->pop_back();
+      equal = false;
+    }
+    for (int i = common_count; i < count2; i++) {
+      specific_field.index = -1;
+      specific_field.new_index = i;
+      field_path->push_back(specific_field);
+      context.reporter->ReportAdded(*context.message1, *context.message2,
+                                    *field_path);
+      field_path->pop_back();
+      equal = false;
+    }
+    return equal;
+  }
+
+  // Compare as a set or map:  match up each element of message1 with an
+  // unmatched element of message2 which is equal to it or has the same key.
+  if (count1 != count2 && context.reporter == NULL) return false;
+  vector<int> match1(count1, -1);
+  vector<bool> matched2(count2, false);
+  for (int i = 0; i < count1; i++) {
+    // Try the element in the same position first, so that fields which are
+    // already in the same order take linear time.
+    if (i < count2 && !matched2[i] &&
+        ElementsMatch(message1, message2, field, i, i, key)) {
+      match1[i] = i;
+      matched2[i] = true;
+      continue;
+    }
+    for (int j = 0; j < count2; j++) {
+      if (!matched2[j] &&
+          ElementsMatch(message1, message2, field, i, j, key)) {
+        match1[i] = j;
+        matched2[j] = true;
+        break;
+      }
+    }
+    if (match1[i] < 0 && context.reporter == NULL) return false;
+  }
+
+  for (int i = 0; i < count1; i++) {
+    specific_field.index = i;
+    specific_field.new_index = match1[i];
+    field_path->push_back(specific_field);
+    if (match1[i] < 0) {
+      context.reporter->ReportDeleted(*context.message1, *context.message2,
+                                      *field_path);
+      equal = false;
+    } else if (key != NULL &&
+               !CompareFieldValue(context, message1, message2, field,
+                                  i, match1[i], field_path)) {
+      equal = false;
+    }
+    field_path->pop_back();
+    if (!equal && context.reporter == NULL) return false;
+  }
+  for (int j = 0; j < count2; j++) {
+    if (matched2[j]) continue;
+    specific_field.index = -1;
+    specific_field.new_index = j;
+    field_path->push_back(specific_field);
+    context.reporter->ReportAdded(*context.message1, *context.message2,
+                                  *field_path);
+    field_path->pop_back();
+    equal = false;
+  }
+
+  return equal;
+}
+
+bool MessageDifferencer::CompareFieldValue(
+    const Context& context,
+    const Message& message1, const Message& message2,
+    const FieldDescriptor* field, int index1, int index2,
+    vector<SpecificField>* field_path) {
+  const Reflection* reflection1 = message1.GetReflection();
+  const Reflection* reflection2 = message2.GetReflection();
+
+  bool equal;
+  switch (field->cpp_type()) {
+#define COMPARE_VALUE(CPPTYPE, METHOD)                                   \
+    case FieldDescriptor::CPPTYPE_##CPPTYPE:                             \
+      if (index1 < 0) {                                                  \
+        equal = reflection1->Get##METHOD(message1, field) ==             \
+                reflection2->Get##METHOD(message2, field);               \
+      } else {                                                           \
+        equal = reflection1->GetRepeated##METHOD(message1, field,        \
+                                                 index1) ==              \
+                reflection2->GetRepeated##METHOD(message2, field,        \
+                                                 index2);                \
+      }                                                                  \
+      break;
+
+    COMPARE_VALUE(INT32 , Int32 );
+    COMPARE_VALUE(INT64 , Int64 );
+    COMPARE_VALUE(UINT32, UInt32);
+    COMPARE_VALUE(UINT64, UInt64);
+    COMPARE_VALUE(FLOAT , Float );
+    COMPARE_VALUE(DOUBLE, Double);
+    COMPARE_VALUE(BOOL  , Bool  );
+#undef COMPARE_VALUE
+
+    case FieldDescriptor::CPPTYPE_ENUM:
+      // Compare numbers, since values unknown to the descriptor may not have
+      // unique EnumValueDescriptors.
+      if (index1 < 0) {
+        equal = reflection1->GetEnum(message1, field)->number() ==
+                reflection2->GetEnum(message2, field)->number();
+      } else {
+        equal = reflection1->GetRepeatedEnum(message1, field, index1)
+                    ->number() ==
+                reflection2->GetRepeatedEnum(message2, field, index2)
+                    ->number();
+      }
+      break;
+
+    case FieldDescriptor::CPPTYPE_STRING: {
+      string scratch1;
+      string scratch2;
+      if (index1 < 0) {
+        equal = reflection1->GetStringReference(message1, field, &scratch1) ==
+                reflection2->GetStringReference(message2, field, &scratch2);
+      } else {
+        equal = reflection1->GetRepeatedStringReference(
+                    message1, field, index1, &scratch1) ==
+                reflection2->GetRepeatedStringReference(
+                    message2, field, index2, &scratch2);
+      }
+      break;
+    }
+
+    case FieldDescriptor::CPPTYPE_MESSAGE:
+      // Differences inside the sub-messages are reported individually.
+      if (index1 < 0) {
+        return CompareMessage(context,
+                              reflection1->GetMessage(message1, field),
+                              reflection2->GetMessage(message2, field),
+                              field_path);
+      } else {
+        return CompareMessage(
+            context,
+            reflection1->GetRepeatedMessage(message1, field, index1),
+            reflection2->GetRepeatedMessage(message2, field, index2),
+            field_path);
+      }
+
+    default:
+      GOOGLE_LOG(DFATAL) << "Unknown cpp_type: " << field->cpp_type();
+      return false;
+  }
+
+  if (!equal && context.reporter != NULL) {
+    context.reporter->ReportModified(*context.message1, *context.message2,
+                                     *field_path);
+  }
+  return equal;
+}
+
+bool MessageDifferencer::ElementsMatch(
+    const Message& message1, const Message& message2,
+    const FieldDescriptor* field, int index1, int index2,
+    const FieldDescriptor* key) {
+  Context context;
+  context.message1 = &message1;
+  context.message2 = &message2;
+  context.reporter = NULL;
+  vector<SpecificField> unused_field_path;
+
+  if (key == NULL) {
+    return CompareFieldValue(context, message1, message2, field,
+                             index1, index2, &unused_field_path);
+  } else {
+    return CompareFieldValue(
+        context,
+        message1.GetReflection()->GetRepeatedMessage(message1, field, index1),
+        message2.GetReflection()->GetRepeatedMessage(message2, field, index2),
+        key, -1, -1, &unused_field_path);
+  }
+}
+
+void MessageDifferencer::ReportWholeField(
+    const Context& context, const Message& message,
+    const FieldDescriptor* field, bool added,
+    vector<SpecificField>* field_path) {
+  SpecificField specific_field;
+  specific_field.field = field;
+  int count = 1;
+  if (field->is_repeated()) {
+    count = message.GetReflection()->FieldSize(message, field);
+  }
+
+  for (int i = 0; i < count; i++) {
+    if (field->is_repeated()) {
+      if (added) {
+        specific_field.new_index = i;
+      } else {
+        specific_field.index = i;
+      }
+    }
+    field_path->push_back(specific_field);
+    if (added) {
+      context.reporter->ReportAdded(*context.message1, *context.message2,
+                                    *field_path);
+    } else {
+      context.reporter->ReportDeleted(*context.message1, *context.message2,
+                                      *field_path);
+    }
+    field_path->pop_back();
+  }
+}
+
+bool MessageDifferencer::CompareUnknownFields(
+    const Context& context,
+    const UnknownFieldSet& unknown_fields1,
+    const UnknownFieldSet& unknown_fields2,
+    vector<SpecificField>* field_path) {
+  if (unknown_fields1.empty() && unknown_fields2.empty()) return true;
+
+  // Fields with different numbers may appear in any order, but those with
+  // the same number are compared as lists.
+  vector<pair<int, int> > fields1;
+  vector<pair<int, int> > fields2;
+  SortUnknownFields(unknown_fields1, &fields1);
+  SortUnknownFields(unknown_fields2, &fields2);
+
+  SpecificField specific_field;
+  specific_field.unknown_field_set1 = &unknown_fields1;
+  specific_field.unknown_field_set2 = &unknown_fields2;
+
+  bool equal = true;
+  int i = 0;
+  int j = 0;
+  while (i < fields1.size() || j < fields2.size()) {
+    // Find the fields with the next lowest number in each set.
+    int number = std::numeric_limits<int>::max();
+    if (i < fields1.size()) number = fields1[i].first;
+    if (j < fields2.size()) number = std::min(number, fields2[j].first);
+    int end1 = i;
+    while (end1 < fields1.size() && fields1[end1].first == number) ++end1;
+    int end2 = j;
+    while (end2 < fields2.size() && fields2[end2].first == number) ++end2;
+    int count1 = end1 - i;
+    int count2 = end2 - j;
+    if (count1 != count2 && context.reporter == NULL) return false;
+
+    specific_field.unknown_field_number = number;
+    for (int k = 0; k < std::max(count1, count2); k++) {
+      const UnknownField* field1 = NULL;
+      const UnknownField* field2 = NULL;
+      specific_field.index = -1;
+      specific_field.new_index = -1;
+      specific_field.unknown_field_index1 = -1;
+      specific_field.unknown_field_index2 = -1;
+      if (k < count1) {
+        specific_field.index = k;
+        specific_field.unknown_field_index1 = fields1[i + k].second;
+        field1 = &unknown_fields1.field(fields1[i + k].second);
+        specific_field.unknown_field_type = field1->type();
+      }
+      if (k < count2) {
+        specific_field.new_index = k;
+        specific_field.unknown_field_index2 = fields2[j + k].second;
+        field2 = &unknown_fields2.field(fields2[j + k].second);
+        specific_field.unknown_field_type = field2->type();
+      }
+
+      bool field_equal = true;
+      field_path->push_back(specific_field);
+      if (field2 == NULL) {
+        context.reporter->ReportDeleted(*context.message1, *context.message2,
+                                        *field_path);
+        field_equal = false;
+      } else if (field1 == NULL) {
+        context.reporter->ReportAdded(*context.message1, *context.message2,
+                                      *field_path);
+        field_equal = false;
+      } else if (!UnknownFieldValuesEqual(*field1, *field2)) {
+        if (context.reporter != NULL) {
+          context.reporter->ReportModified(*context.message1,
+                                           *context.message2, *field_path);
+        }
+        field_equal = false;
+      } else if (field1->type() == UnknownField::TYPE_GROUP) {
+        field_equal = CompareUnknownFields(context, field1->group(),
+                                           field2->group(), field_path);
+      }
+      field_path->pop_back();
+
+      if (!field_equal) {
+        if (context.reporter == NULL) return false;
+        equal = false;
+      }
+    }
+
+    i = end1;
+    j = end2;
+  }
+
+  return equal;
+}
+
+}  // namespace util
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,281 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file defines MessageDifferencer, which compares two Messages of the
+// same type field by field using reflection, and optionally reports the
+// differences it finds.  Unlike comparing serialized messages, this does not
+// depend on the order in which map entries or unordered repeated fields
+// happen to have been added.
+
+#ifndef GOOGLE_PROTOBUF_UTIL_MESSAGE_DIFFERENCER_H__
+#define GOOGLE_PROTOBUF_UTIL_MESSAGE_DIFFERENCER_H__
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/text_format.h>
+#include <google/protobuf/unknown_field_set.h>
+#include <google/protobuf/io/printer.h>
+
+namespace google {
+namespace protobuf {
+
+namespace io {
+class ZeroCopyOutputStream;     // zero_copy_stream.h
+}
+
+namespace util {
+
+// Compares two messages of the same type.
+//
+// By default, two messages are equal if they have the same fields set (or,
+// for fields without presence, the same non-default fields), all those
+// fields have equal values, and they have the same unknown fields.  Repeated
+// fields are compared as lists, except for map fields, whose entries are
+// matched up by key regardless of their order.  Floating-point values are
+// compared with ==, so NaN is never equal to anything.
+//
+// Usage:
+//   if (!MessageDifferencer::Equals(message1, message2)) { ... }
+//
+// or, to find out what differs:
+//   MessageDifferencer differencer;
+//   differencer.TreatAsSet(Foo::descriptor()->FindFieldByName("tags"));
+//   string report;
+//   differencer.ReportDifferencesToString(&report);
+//   if (!differencer.Compare(message1, message2)) { ... }
+class LIBPROTOBUF_EXPORT MessageDifferencer {
+ public:
+  // Shorthand for MessageDifferencer().Compare(message1, message2).  Returns
+  // as soon as a difference is found.
+  static bool Equals(const Message& message1, const Message& message2);
+
+  // Identifies one step in the path from the top-level messages to a
+  // difference: a field, or an element of a repeated field, of the message
+  // identified by the previous steps.
+  struct SpecificField {
+    SpecificField()
+        : field(NULL), index(-1), new_index(-1), unknown_field_number(-1),
+          unknown_field_type(UnknownField::TYPE_VARINT),
+          unknown_field_set1(NULL), unknown_field_set2(NULL),
+          unknown_field_index1(-1), unknown_field_index2(-1) {}
+
+    // The field, or NULL if this is an unknown field.
+    const FieldDescriptor* field;
+
+    // For repeated fields (and unknown fields, counting only those with the
+    // same number), the index of the element in message1 and message2
+    // respectively.  When repeated fields are compared as lists these are
+    // the same; otherwise they may differ.  index is -1 for an element which
+    // was added in message2, and new_index is -1 for one deleted from
+    // message1.  Both are -1 for singular fields.
+    int index;
+    int new_index;
+
+    // For unknown fields: the field number and wire type, and the sets
+    // containing them together with the position of the field in each (or -1
+    // if it is not in that set).
+    int unknown_field_number;
+    UnknownField::Type unknown_field_type;
+    const UnknownFieldSet* unknown_field_set1;
+    const UnknownFieldSet* unknown_field_set2;
+    int unknown_field_index1;
+    int unknown_field_index2;
+  };
+
+  // Receives the differences found by Compare().  field_path leads from the
+  // top-level messages to the field (or element) which differs, which is the
+  // last entry.  Sub-messages which differ are reported as the individual
+  // fields that differ within them, unless the whole sub-message was added or
+  // deleted.
+  class LIBPROTOBUF_EXPORT Reporter {
+   public:
+    Reporter();
+    virtual ~Reporter();
+
+    // A field or element present only in message2.
+    virtual void ReportAdded(const Message& message1, const Message& message2,
+                             const vector<SpecificField>& field_path) = 0;
+
+    // A field or element present only in message1.
+    virtual void ReportDeleted(const Message& message1, const Message& message2,
+                               const vector<SpecificField>& field_path) = 0;
+
+    // A field or element present in both with different values.
+    virtual void ReportModified(const Message& message1,
+                                const Message& message2,
+                                const vector<SpecificField>& field_path) = 0;
+
+   private:
+    GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(Reporter);
+  };
+
+  // A Reporter which writes one line of text per difference, e.g.:
+  //   added: repeated_int32[2]: 5
+  //   deleted: optional_nested_message.bb: 1
+  //   modified: map_string_string[1->0].value: "a" -> "b"
+  class LIBPROTOBUF_EXPORT StreamReporter : public Reporter {
+   public:
+    explicit StreamReporter(io::ZeroCopyOutputStream* output);
+    virtual ~StreamReporter();
+
+    // implements Reporter ------------------------------------------
+    virtual void ReportAdded(const Message& message1, const Message& message2,
+                             const vector<SpecificField>& field_path);
+    virtual void ReportDeleted(const Message& message1, const Message& message2,
+                               const vector<SpecificField>& field_path);
+    virtual void ReportModified(const Message& message1,
+                                const Message& message2,
+                                const vector<SpecificField>& field_path);
+
+   private:
+    // Prints the path, in a form like "foo.bar[2].(my.extension)".
+    void PrintPath(const vector<SpecificField>& field_path);
+    // Prints the value at the end of the path in the given message, which is
+    // message1 or message2 as indicated by left_side.
+    void PrintValue(const Message& message,
+                    const vector<SpecificField>& field_path, bool left_side);
+
+    io::Printer printer_;
+    TextFormat::Printer text_printer_;
+
+    GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(StreamReporter);
+  };
+
+  // How to compare repeated fields which have not been configured
+  // individually with TreatAsList(), TreatAsSet(), or TreatAsMap().
+  enum RepeatedFieldComparison {
+    AS_LIST,  // Element i of one must equal element i of the other.
+    AS_SET,   // Each element of one must equal a distinct element of the
+              // other, in any order.  Map fields are still compared as maps.
+  };
+
+  MessageDifferencer();
+  ~MessageDifferencer();
+
+  void set_repeated_field_comparison(RepeatedFieldComparison comparison) {
+    repeated_field_comparison_ = comparison;
+  }
+
+  // Compares the given repeated field as a list (even if it is a map field)
+  // or as a set, overriding set_repeated_field_comparison().
+  void TreatAsList(const FieldDescriptor* field);
+  void TreatAsSet(const FieldDescriptor* field);
+
+  // Compares the elements of the given repeated message field as map
+  // entries identified by the value of the given sub-field, key, which must
+  // be a singular field of field's message type.  Entries with equal keys
+  // are matched up and their remaining differences reported as modifications.
+  void TreatAsMap(const FieldDescriptor* field, const FieldDescriptor* key);
+
+  // Reports differences found by subsequent Compare() calls to the given
+  // Reporter, which must outlive them.  Without a reporter, Compare() stops
+  // at the first difference.  Pass NULL to stop reporting.
+  void ReportDifferencesTo(Reporter* reporter);
+
+  // Like ReportDifferencesTo(), but appends the differences to the given
+  // string using a StreamReporter.
+  void ReportDifferencesToString(string* output);
+
+  // Returns true if the two messages are equal.  Both must have the same
+  // Descriptor.  When there is no reporter and both are generated messages,
+  // their serializations are compared first, so this updates their cached
+  // sizes just as serializing them would.
+  bool Compare(const Message& message1, const Message& message2);
+
+ private:
+  // The top-level messages and reporter for the Compare() call in progress.
+  struct Context {
+    const Message* message1;
+    const Message* message2;
+    Reporter* reporter;
+  };
+
+  // Each of these returns true if the given messages, fields, or elements
+  // are equal, and reports the differences, if any, to context->reporter.
+  // field_path identifies the messages being compared; anything pushed onto
+  // it is popped off again before returning.
+  bool CompareMessage(const Context& context,
+                      const Message& message1, const Message& message2,
+                      vector<SpecificField>* field_path);
+  bool CompareRepeatedField(const Context& context,
+                            const Message& message1, const Message& message2,
+                            const FieldDescriptor* field,
+                            vector<SpecificField>* field_path);
+  // Compares a singular field (index1 and index2 are -1) or one element of
+  // a repeated field in each message.  field_path must already end with the
+  // SpecificField for the field; a difference in a scalar value is reported
+  // there.
+  bool CompareFieldValue(const Context& context,
+                         const Message& message1, const Message& message2,
+                         const FieldDescriptor* field, int index1, int index2,
+                         vector<SpecificField>* field_path);
+  bool CompareUnknownFields(const Context& context,
+                            const UnknownFieldSet& unknown_fields1,
+                            const UnknownFieldSet& unknown_fields2,
+                            vector<SpecificField>* field_path);
+
+  // Returns true if the given elements of a repeated field, or their keys if
+  // key is not NULL, are equal, without reporting anything.
+  bool ElementsMatch(const Message& message1, const Message& message2,
+                     const FieldDescriptor* field, int index1, int index2,
+                     const FieldDescriptor* key);
+
+  // Reports every element of the given field (or the field itself if it is
+  // singular) as added or deleted.
+  void ReportWholeField(const Context& context, const Message& message,
+                        const FieldDescriptor* field, bool added,
+                        vector<SpecificField>* field_path);
+
+  // Returns the key to compare the given repeated field by, or NULL if it is
+  // not compared as a map.
+  const FieldDescriptor* GetMapKey(const FieldDescriptor* field) const;
+  bool IsTreatedAsSet(const FieldDescriptor* field) const;
+
+  RepeatedFieldComparison repeated_field_comparison_;
+  set<const FieldDescriptor*> list_fields_;
+  set<const FieldDescriptor*> set_fields_;
+  map<const FieldDescriptor*, const FieldDescriptor*> map_keys_;
+
+  Reporter* reporter_;
+  string* report_string_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(MessageDifferencer);
+};
+
+}  // namespace util
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_UTIL_MESSAGE_DIFFERENCER_H__
@@ -0,0 +1,292 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/util/message_differencer.h>
+
+#include <limits>
+#include <string>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/map_unittest.pb.h>
+#include <google/protobuf/test_util.h>
+#include <google/protobuf/unittest.pb.h>
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/strutil.h>
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace util {
+namespace {
+
+const FieldDescriptor* GetField(const Descriptor* descriptor,
+                                const string& name) {
+  const FieldDescriptor* field = descriptor->FindFieldByName(name);
+  GOOGLE_CHECK(field != NULL) << name;
+  return field;
+}
+
+TEST(MessageDifferencerTest, EqualMessages) {
+  unittest::TestAllTypes message1, message2;
+  TestUtil::SetAllFields(&message1);
+  TestUtil::SetAllFields(&message2);
+  EXPECT_TRUE(MessageDifferencer::Equals(message1, message2));
+
+  unittest::TestAllExtensions extensions1, extensions2;
+  TestUtil::SetAllExtensions(&extensions1);
+  TestUtil::SetAllExtensions(&extensions2);
+  EXPECT_TRUE(MessageDifferencer::Equals(extensions1, extensions2));
+
+  unittest::TestAllTypes empty1, empty2;
+  EXPECT_TRUE(MessageDifferencer::Equals(empty1, empty2));
+}
+
+TEST(MessageDifferencerTest, DifferentMessages) {
+  unittest::TestAllTypes message1, message2;
+  TestUtil::SetAllFields(&message1);
+  TestUtil::SetAllFields(&message2);
+
+  // Same size, different value.
+  message2.set_optional_int32(message1.optional_int32() + 1);
+  EXPECT_FALSE(MessageDifferencer::Equals(message1, message2));
+
+  // Set in one only, even though the value is the default.
+  message2.set_optional_int32(message1.optional_int32());
+  message1.clear_default_int32();
+  message2.set_default_int32(message1.default_int32());
+  EXPECT_FALSE(MessageDifferencer::Equals(message1, message2));
+  EXPECT_FALSE(MessageDifferencer::Equals(message2, message1));
+
+  // Deep inside a sub-message.
+  message1.set_default_int32(message2.default_int32());
+  EXPECT_TRUE(MessageDifferencer::Equals(message1, message2));
+  message2.mutable_repeated_nested_message(1)->set_bb(12345);
+  EXPECT_FALSE(MessageDifferencer::Equals(message1, message2));
+}
+
+TEST(MessageDifferencerTest, SerializedComparison) {
+  // Equals() first compares generated messages' serializations.  Identical
+  // bytes must still not make NaN equal, and different bytes must not hide
+  // values that are equal.
+  unittest::TestAllTypes message1, message2;
+  message1.set_optional_double(std::numeric_limits<double>::quiet_NaN());
+  message2.set_optional_double(std::numeric_limits<double>::quiet_NaN());
+  EXPECT_FALSE(MessageDifferencer::Equals(message1, message2));
+
+  message1.set_optional_double(0.0);
+  message2.set_optional_double(-0.0);
+  EXPECT_TRUE(MessageDifferencer::Equals(message1, message2));
+
+  message1.add_repeated_float(1);
+  message1.add_repeated_float(std::numeric_limits<float>::quiet_NaN());
+  message2.add_repeated_float(1);
+  message2.add_repeated_float(std::numeric_limits<float>::quiet_NaN());
+  EXPECT_FALSE(MessageDifferencer::Equals(message1, message2));
+
+  message1.mutable_repeated_float()->Clear();
+  message2.mutable_repeated_float()->Clear();
+  message1.add_repeated_int32(1);
+  message1.add_repeated_int32(2);
+  message2.add_repeated_int32(2);
+  message2.add_repeated_int32(1);
+  MessageDifferencer differencer;
+  EXPECT_FALSE(differencer.Compare(message1, message2));
+  differencer.set_repeated_field_comparison(MessageDifferencer::AS_SET);
+  EXPECT_TRUE(differencer.Compare(message1, message2));
+}
+
+TEST(MessageDifferencerTest, DynamicMessages) {
+  // Dynamic messages are compared through reflection just like generated
+  // ones.
+  DynamicMessageFactory factory;
+  const Message* prototype =
+      factory.GetPrototype(unittest::TestAllTypes::descriptor());
+  scoped_ptr<Message> message1(prototype->New());
+  scoped_ptr<Message> message2(prototype->New());
+
+  TestUtil::ReflectionTester reflection_tester(
+      unittest::TestAllTypes::descriptor());
+  reflection_tester.SetAllFieldsViaReflection(message1.get());
+  reflection_tester.SetAllFieldsViaReflection(message2.get());
+  EXPECT_TRUE(MessageDifferencer::Equals(*message1, *message2));
+
+  reflection_tester.ModifyRepeatedFieldsViaReflection(message2.get());
+  EXPECT_FALSE(MessageDifferencer::Equals(*message1, *message2));
+}
+
+TEST(MessageDifferencerTest, ReportDifferences) {
+  unittest::TestAllTypes message1, message2;
+  message1.set_optional_int32(1);
+  message2.set_optional_int32(2);
+  message1.set_optional_string("foo");
+  message2.mutable_optional_nested_message()->set_bb(3);
+  message1.add_repeated_int32(4);
+  message2.add_repeated_int32(4);
+  message2.add_repeated_int32(5);
+  message1.add_repeated_nested_message()->set_bb(6);
+  message2.add_repeated_nested_message()->set_bb(7);
+
+  MessageDifferencer differencer;
+  string report;
+  differencer.ReportDifferencesToString(&report);
+  EXPECT_FALSE(differencer.Compare(message1, message2));
+  EXPECT_EQ(
+      "modified: optional_int32: 1 -> 2\n"
+      "deleted: optional_string: \"foo\"\n"
+      "added: optional_nested_message: { bb: 3 }\n"
+      "added: repeated_int32[1]: 5\n"
+      "modified: repeated_nested_message[0].bb: 6 -> 7\n",
+      report);
+
+  report.clear();
+  EXPECT_TRUE(differencer.Compare(message1, message1));
+  EXPECT_EQ("", report);
+}
+
+TEST(MessageDifferencerTest, ReportExtensionDifferences) {
+  unittest::TestAllExtensions message1, message2;
+  message1.SetExtension(unittest::optional_int32_extension, 1);
+  message2.SetExtension(unittest::optional_int32_extension, 2);
+
+  MessageDifferencer differencer;
+  string report;
+  differencer.ReportDifferencesToString(&report);
+  EXPECT_FALSE(differencer.Compare(message1, message2));
+  EXPECT_EQ("modified: (protobuf_unittest.optional_int32_extension): "
+            "1 -> 2\n", report);
+}
+
+TEST(MessageDifferencerTest, TreatAsSet) {
+  unittest::TestAllTypes message1, message2;
+  message1.add_repeated_int32(1);
+  message1.add_repeated_int32(2);
+  message1.add_repeated_int32(2);
+  message2.add_repeated_int32(2);
+  message2.add_repeated_int32(1);
+  message2.add_repeated_int32(2);
+
+  MessageDifferencer differencer;
+  EXPECT_FALSE(differencer.Compare(message1, message2));
+
+  const FieldDescriptor* field =
+      GetField(unittest::TestAllTypes::descriptor(), "repeated_int32");
+  differencer.TreatAsSet(field);
+  EXPECT_TRUE(differencer.Compare(message1, message2));
+
+  // Each element must match a distinct element of the other message.
+  message2.set_repeated_int32(2, 1);
+  string report;
+  differencer.ReportDifferencesToString(&report);
+  EXPECT_FALSE(differencer.Compare(message1, message2));
+  EXPECT_EQ("deleted: repeated_int32[2]: 2\n"
+            "added: repeated_int32[2]: 1\n", report);
+
+  differencer.TreatAsList(field);
+  differencer.set_repeated_field_comparison(MessageDifferencer::AS_SET);
+  EXPECT_FALSE(differencer.Compare(message1, message2));
+  message2.set_repeated_int32(2, 2);
+  EXPECT_FALSE(differencer.Compare(message1, message2));
+  differencer.set_repeated_field_comparison(MessageDifferencer::AS_LIST);
+  EXPECT_FALSE(differencer.Compare(message1, message2));
+}
+
+TEST(MessageDifferencerTest, TreatAsMap) {
+  unittest::TestAllTypes message1, message2;
+  message1.add_repeated_nested_message()->set_bb(1);
+  message1.add_repeated_nested_message()->set_bb(2);
+  message2.add_repeated_nested_message()->set_bb(2);
+  message2.add_repeated_nested_message()->set_bb(3);
+  message1.mutable_repeated_nested_message(1)->set_bb(2);
+
+  const Descriptor* descriptor = unittest::TestAllTypes::descriptor();
+  const FieldDescriptor* field =
+      GetField(descriptor, "repeated_nested_message");
+  const FieldDescriptor* key =
+      GetField(unittest::TestAllTypes::NestedMessage::descriptor(), "bb");
+
+  MessageDifferencer differencer;
+  differencer.TreatAsMap(field, key);
+  string report;
+  differencer.ReportDifferencesToString(&report);
+  EXPECT_FALSE(differencer.Compare(message1, message2));
+  EXPECT_EQ("deleted: repeated_nested_message[0]: { bb: 1 }\n"
+            "added: repeated_nested_message[1]: { bb: 3 }\n", report);
+
+  message1.mutable_repeated_nested_message(0)->set_bb(3);
+  EXPECT_TRUE(differencer.Compare(message1, message2));
+}
+
+TEST(MessageDifferencerTest, MapFields) {
+  // Map entries are matched up by key whatever order they come in.
+  unittest::TestMap message1, message2;
+  for (int i = 0; i < 100; i++) {
+    (*message1.mutable_map_int32_int32())[i] = i;
+    (*message2.mutable_map_int32_int32())[99 - i] = 99 - i;
+  }
+  (*message1.mutable_map_string_string())["a"] = "b";
+  (*message2.mutable_map_string_string())["a"] = "b";
+  EXPECT_TRUE(MessageDifferencer::Equals(message1, message2));
+
+  (*message2.mutable_map_string_string())["a"] = "c";
+  MessageDifferencer differencer;
+  string report;
+  differencer.ReportDifferencesToString(&report);
+  EXPECT_FALSE(differencer.Compare(message1, message2));
+  EXPECT_EQ("modified: map_string_string[0].value: \"b\" -> \"c\"\n", report);
+}
+
+TEST(MessageDifferencerTest, UnknownFields) {
+  unittest::TestEmptyMessage message1, message2;
+  message1.mutable_unknown_fields()->AddVarint(1, 2);
+  message1.mutable_unknown_fields()->AddFixed32(3, 4);
+  message2.mutable_unknown_fields()->AddFixed32(3, 4);
+  message2.mutable_unknown_fields()->AddVarint(1, 2);
+  EXPECT_TRUE(MessageDifferencer::Equals(message1, message2));
+
+  message2.mutable_unknown_fields()->AddVarint(1, 5);
+  message2.mutable_unknown_fields()->mutable_field(0)->set_fixed32(6);
+  UnknownFieldSet* group = message1.mutable_unknown_fields()->AddGroup(7);
+  group->AddLengthDelimited(8, "foo");
+
+  MessageDifferencer differencer;
+  string report;
+  differencer.ReportDifferencesToString(&report);
+  EXPECT_FALSE(differencer.Compare(message1, message2));
+  EXPECT_EQ("added: 1[1]: 5\n"
+            "modified: 3[0]: 0x00000004 -> 0x00000006\n"
+            "deleted: 7[0]: { 8: \"foo\" }\n", report);
+}
+
+}  // namespace
+}  // namespace util
+}  // namespace protobuf
+}  // namespace google
@@ -909,7 +909,14 @@ void WireFormat::SerializeFieldWithCachedSizes(
           message_reflection->GetStringReference(message, field, &scratch);
         VerifyUTF8StringNamedField(value.data(), value.length(), SERIALIZE,
                                    field->name().c_str());
-        WireFormatLite::WriteString(field->number(), value, output);
+        // scratch dies with this block, so only the message's own string may
+        // be aliased.
+        if (&value == &scratch) {
+          WireFormatLite::WriteString(field->number(), value, output);
+        } else {
+          WireFormatLite::WriteStringMaybeAliased(field->number(), value,
+                                                  output);
+        }
         break;
       }
 
@@ -919,7 +926,12 @@ void WireFormat::SerializeFieldWithCachedSizes(
           message_reflection->GetRepeatedStringReference(
             message, field, j, &scratch) :
           message_reflection->GetStringReference(message, field, &scratch);
-        WireFormatLite::WriteBytes(field->number(), value, output);
+        if (&value == &scratch) {
+          WireFormatLite::WriteBytes(field->number(), value, output);
+        } else {
+          WireFormatLite::WriteBytesMaybeAliased(field->number(), value,
+                                                 output);
+        }
         break;
       }
     }
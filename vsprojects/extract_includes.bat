@@ -3,6 +3,7 @@ md include\google
 md include\google\protobuf
 md include\google\protobuf\stubs
 md include\google\protobuf\io
+md include\google\protobuf\util
 md include\google\protobuf\compiler
 md include\google\protobuf\compiler\cpp
 md include\google\protobuf\compiler\java
@@ -41,6 +42,7 @@ copy ..\src\google\protobuf\io\tokenizer.h include\google\protobuf\io\tokenizer.
 copy ..\src\google\protobuf\io\zero_copy_stream.h include\google\protobuf\io\zero_copy_stream.h
 copy ..\src\google\protobuf\io\zero_copy_stream_impl.h include\google\protobuf\io\zero_copy_stream_impl.h
 copy ..\src\google\protobuf\io\zero_copy_stream_impl_lite.h include\google\protobuf\io\zero_copy_stream_impl_lite.h
+copy ..\src\google\protobuf\util\message_differencer.h include\google\protobuf\util\message_differencer.h
 copy ..\src\google\protobuf\map_entry.h include\google\protobuf\map_entry.h
 copy ..\src\google\protobuf\map_entry_lite.h include\google\protobuf\map_entry_lite.h
 copy ..\src\google\protobuf\map_field.h include\google\protobuf\map_field.h